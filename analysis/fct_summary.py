@@ -0,0 +1,230 @@
+#!/usr/bin/python3
+"""
+Reader / merger of the online FCT summary written by the simulator
+(FCT_SUMMARY_FILE, see src/point-to-point/model/fct-aggregator.h).
+
+Usage:
+    python3 fct_summary.py run1_out_fct_summary.txt [run2_out_fct_summary.txt ...] [-o merged.txt]
+
+Summaries of parallel runs (same REL_ERR / WINDOW / SIZE_BINS) are merged
+exactly: counts and sums are added, sketch buckets are added per index.
+"""
+
+import argparse
+import math
+import sys
+
+ZERO_IDX = -2147483648
+
+lb_modes = {
+    0: "fecmp",
+    2: "drill",
+    3: "conga",
+    6: "letflow",
+    9: "conweave",
+    20: "caver",
+    12: 'hula',
+    10: 'dv',
+    21: 'noshare',
+}
+
+
+class Sketch:
+    """log-bucketed sketch, same bucket layout as ns3::QuantileSketch"""
+
+    def __init__(self, rel_err):
+        self.gamma = (1 + rel_err) / (1 - rel_err)
+        self.count = 0
+        self.bins = dict()  # idx -> count
+
+    def merge(self, other):
+        for idx, cnt in other.bins.items():
+            self.bins[idx] = self.bins.get(idx, 0) + cnt
+        self.count += other.count
+
+    def value(self, idx):
+        if idx == ZERO_IDX:
+            return 0.0
+        return 2 * self.gamma ** idx / (self.gamma + 1)
+
+    def quantile(self, q):
+        # same rank convention as plot_fct.py get_pctl(): a[int(n * q)]
+        if self.count == 0:
+            return 0.0
+        rank = min(int(self.count * q), self.count - 1)
+        seen = 0
+        for idx in sorted(self.bins):
+            seen += self.bins[idx]
+            if seen > rank:
+                return self.value(idx)
+        return self.value(max(self.bins))
+
+
+def parse_sketch(tokens, pos, rel_err):
+    sk = Sketch(rel_err)
+    n = int(tokens[pos])
+    pos += 1
+    for _ in range(n):
+        idx, cnt = int(tokens[pos]), int(tokens[pos + 1])
+        sk.bins[idx] = sk.bins.get(idx, 0) + cnt
+        sk.count += cnt
+        pos += 2
+    return sk, pos
+
+
+class Cell:
+    def __init__(self, rel_err):
+        self.count = 0
+        self.sum_slowdown = 0.0
+        self.sum_fct = 0.0
+        self.max_size = 0
+        self.slowdown = Sketch(rel_err)
+        self.fct = Sketch(rel_err)
+
+    def merge(self, other):
+        self.count += other.count
+        self.sum_slowdown += other.sum_slowdown
+        self.sum_fct += other.sum_fct
+        self.max_size = max(self.max_size, other.max_size)
+        self.slowdown.merge(other.slowdown)
+        self.fct.merge(other.fct)
+
+
+class Summary:
+    def __init__(self):
+        self.cc_mode = None
+        self.rel_err = None
+        self.window = None  # (startNs, windowNs)
+        self.size_bins = None
+        self.cells = dict()  # (lb, window, bin) -> Cell
+
+    @staticmethod
+    def load(filename):
+        s = Summary()
+        with open(filename, "r") as f:
+            for line in f:
+                tokens = line.split()
+                if len(tokens) == 0 or tokens[0].startswith("#"):
+                    continue
+                if tokens[0] == "CC_MODE":
+                    s.cc_mode = int(tokens[1])
+                elif tokens[0] == "REL_ERR":
+                    s.rel_err = float(tokens[1])
+                elif tokens[0] == "WINDOW":
+                    s.window = (int(tokens[1]), int(tokens[2]))
+                elif tokens[0] == "SIZE_BINS":
+                    s.size_bins = [int(x) for x in tokens[2:2 + int(tokens[1])]]
+                elif tokens[0] == "CELL":
+                    c = Cell(s.rel_err)
+                    key = (int(tokens[1]), int(tokens[2]), int(tokens[3]))
+                    c.count = int(tokens[4])
+                    c.sum_slowdown = float(tokens[5])
+                    c.sum_fct = float(tokens[6])
+                    c.max_size = int(tokens[7])
+                    assert tokens[8] == "SD"
+                    c.slowdown, pos = parse_sketch(tokens, 9, s.rel_err)
+                    assert tokens[pos] == "FCT"
+                    c.fct, pos = parse_sketch(tokens, pos + 1, s.rel_err)
+                    s.cells[key] = c
+        return s
+
+    def merge(self, other):
+        if self.rel_err is None:
+            self.cc_mode, self.rel_err = other.cc_mode, other.rel_err
+            self.window, self.size_bins = other.window, other.size_bins
+        if (other.rel_err, other.window, other.size_bins) != (self.rel_err, self.window, self.size_bins):
+            raise Exception("cannot merge summaries with different REL_ERR/WINDOW/SIZE_BINS")
+        for key, c in other.cells.items():
+            if key not in self.cells:
+                self.cells[key] = Cell(self.rel_err)
+            self.cells[key].merge(c)
+
+    def write(self, filename):
+        def sketch_str(sk):
+            items = sorted(sk.bins.items())
+            return " %d" % len(items) + "".join(" %d %d" % (i, n) for i, n in items)
+
+        with open(filename, "w") as f:
+            f.write("# fct summary v1 (analysis/fct_summary.py)\n")
+            f.write("CC_MODE %d\n" % self.cc_mode)
+            f.write("REL_ERR %g\n" % self.rel_err)
+            f.write("WINDOW %d %d\n" % self.window)
+            f.write("SIZE_BINS %d %s\n" % (len(self.size_bins), " ".join(str(e) for e in self.size_bins)))
+            for key in sorted(self.cells):
+                c = self.cells[key]
+                f.write("CELL %d %d %d %d %.6f %.1f %d SD%s FCT%s\n" % (
+                    key[0], key[1], key[2], c.count, c.sum_slowdown, c.sum_fct, c.max_size,
+                    sketch_str(c.slowdown), sketch_str(c.fct)))
+
+    def window_range(self, w):
+        start, width = self.window
+        if width == 0:
+            return (0, float("inf"))
+        return (start + w * width, start + (w + 1) * width)
+
+    def by_size(self, lb=None, time_start=0, time_end=float("inf")):
+        """merge cells over windows whose flows started in [time_start, time_end), keyed by size bin"""
+        res = dict()
+        for (l, w, b), c in self.cells.items():
+            if lb is not None and l != lb:
+                continue
+            w_begin, w_end = self.window_range(w)
+            if w_end <= time_start or w_begin >= time_end:
+                continue
+            if b not in res:
+                res[b] = Cell(self.rel_err)
+            res[b].merge(c)
+        return res
+
+
+def load(filenames):
+    if isinstance(filenames, str):
+        filenames = [filenames]
+    merged = Summary()
+    for filename in filenames:
+        merged.merge(Summary.load(filename))
+    return merged
+
+
+def get_steps_from_summary(filenames, time_start=0, time_end=float("inf")):
+    """same output as plot_fct.get_steps_from_raw(), one point per non-empty size bin"""
+    cells = load(filenames).by_size(None, time_start, time_end)
+    if len(cells) == 0:
+        raise Exception(f'no flows in {filenames}')
+    result = {"avg": [], "p99": [], "size": []}
+    for b in sorted(cells):
+        c = cells[b]
+        result["avg"].append(c.sum_slowdown / c.count)
+        result["p99"].append(c.slowdown.quantile(0.99))
+        result["size"].append(c.max_size)
+    return result
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Print / merge online FCT summaries')
+    parser.add_argument('files', nargs='+', help="FCT_SUMMARY_FILE outputs (same config)")
+    parser.add_argument('-o', dest='output', action='store', default='', help="write the merged summary")
+    parser.add_argument('-sT', dest='time_start', type=int, default=0, help="only windows after T (ns)")
+    parser.add_argument('-fT', dest='time_end', type=int, default=10000000000, help="only windows before T (ns)")
+    args = parser.parse_args()
+
+    s = load(args.files)
+    if args.output:
+        s.write(args.output)
+
+    for lb in sorted(set(k[0] for k in s.cells)):
+        cells = s.by_size(lb, args.time_start, args.time_end)
+        print("LB {} ({})  relErr={}".format(lb, lb_modes.get(lb, "?"), s.rel_err))
+        print("{:>10} {:>10} {:>8} {:>8} {:>8} {:>8} {:>8}".format(
+            "<Size", "Count", "Avg", "50%", "95%", "99%", "99.9%"))
+        for b in sorted(cells):
+            c = cells[b]
+            upper = s.size_bins[b + 1] if b + 1 < len(s.size_bins) else math.inf
+            print("{:>10} {:>10} {:>8.3f} {:>8.3f} {:>8.3f} {:>8.3f} {:>8.3f}".format(
+                upper, c.count, c.sum_slowdown / c.count, c.slowdown.quantile(0.5),
+                c.slowdown.quantile(0.95), c.slowdown.quantile(0.99), c.slowdown.quantile(0.999)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
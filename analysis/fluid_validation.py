@@ -0,0 +1,98 @@
+#!/usr/bin/python3
+"""
+Validation of the hybrid fluid/packet mode (FLUID_MIN_SIZE, see
+src/point-to-point/model/fluid-model.h) against a full packet-level run of
+the same flows: the foreground flows (smaller than the threshold) are packets
+in both runs, their slowdown (FCT / standalone FCT) is compared per size bin.
+The background flows are compared too, from the fluid FCT file of the hybrid
+run (the FCT file columns plus a 9th, the base RTT that the fluid FCT
+includes on top of the fluid transfer time). Both runs need the same flow input and ECMP_SEED, so that the 4-tuples
+and the ECMP paths match.
+
+Usage:
+    python3 run.py --lb fecmp --ecmp_seed 7 --topo fat_k4_100G_OS2 ...                           # -> id A
+    python3 run.py --lb fecmp --ecmp_seed 7 --topo fat_k4_100G_OS2 --fluid_min_size 1000000 ...  # -> id B
+    python3 analysis/fluid_validation.py mix/output/A mix/output/B --min_size 1000000
+"""
+
+import argparse
+import os
+import sys
+
+SIZE_BINS = (10000, 100000, 1000000, 10000000)
+
+
+def load_fct(filename):
+    """(src, dst, sport, dport) -> (size, slowdown); extra columns (fluid file: base RTT) are ignored"""
+    flows = {}
+    with open(filename) as f:
+        for line in f:
+            v = line.split()
+            if len(v) < 8:
+                continue
+            size, fct, standalone = int(v[4]), int(v[6]), int(v[7])
+            flows[(int(v[0]), int(v[1]), int(v[2]), int(v[3]))] = (size, max(fct / standalone, 1.0))
+    return flows
+
+
+def percentile(values, p):
+    values = sorted(values)
+    return values[min(len(values) - 1, int(len(values) * p / 100.0))]
+
+
+def bin_name(lo, hi):
+    return "[{}, {})".format(lo, hi if hi is not None else "inf")
+
+
+def compare(title, ref, test, min_size, max_size):
+    """prints slowdown percentiles of the flows of both runs, per size bin"""
+    keys = [k for k in ref if k in test and min_size <= ref[k][0] < max_size]
+    print("{}: {} flows matched".format(title, len(keys)))
+    print("{:>22} {:>6} {:>26} {:>26} {:>20}".format(
+        "size bin", "flows", "packet p50/p95/p99", "hybrid p50/p95/p99", "rel. err p50/p99"))
+    edges = [min_size] + [b for b in SIZE_BINS if min_size < b < max_size] + [max_size]
+    worst = 0.0
+    for lo, hi in zip(edges[:-1], edges[1:]):
+        sel = [k for k in keys if lo <= ref[k][0] < hi]
+        if not sel:
+            continue
+        a = [ref[k][1] for k in sel]
+        b = [test[k][1] for k in sel]
+        pa = [percentile(a, p) for p in (50, 95, 99)]
+        pb = [percentile(b, p) for p in (50, 95, 99)]
+        err = [abs(pb[i] - pa[i]) / pa[i] for i in (0, 2)]
+        worst = max(worst, max(err))
+        print("{:>22} {:6d} {:>26} {:>26} {:>20}".format(
+            bin_name(lo, hi if hi != float("inf") else None), len(sel),
+            "/".join("{:.2f}".format(x) for x in pa), "/".join("{:.2f}".format(x) for x in pb),
+            "/".join("{:.1%}".format(x) for x in err)))
+    return worst
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Compare a hybrid fluid/packet run with a packet-level run')
+    parser.add_argument('packet_dir', help="output directory of the packet-level run")
+    parser.add_argument('hybrid_dir', help="output directory of the hybrid run")
+    parser.add_argument('--min_size', type=int, required=True, help="FLUID_MIN_SIZE of the hybrid run")
+    parser.add_argument('--tolerance', type=float, default=0.1,
+                        help="max relative error of the foreground p50/p99 slowdown (default: 0.1)")
+    args = parser.parse_args()
+
+    id_a = os.path.basename(os.path.normpath(args.packet_dir))
+    id_b = os.path.basename(os.path.normpath(args.hybrid_dir))
+    packet = load_fct(os.path.join(args.packet_dir, id_a + "_out_fct.txt"))
+    hybrid = load_fct(os.path.join(args.hybrid_dir, id_b + "_out_fct.txt"))
+    fluid_file = os.path.join(args.hybrid_dir, id_b + "_out_fluid_fct.txt")
+    fluid = load_fct(fluid_file) if os.path.isfile(fluid_file) else {}
+
+    worst = compare("foreground (packet-level in both runs)", packet, hybrid, 0, args.min_size)
+    print()
+    compare("background (fluid in the hybrid run)", packet, fluid, args.min_size, float("inf"))
+    print()
+    ok = worst <= args.tolerance
+    print("foreground worst relative error {:.1%} -> {}".format(worst, "PASS" if ok else "FAIL"))
+    return 0 if ok else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
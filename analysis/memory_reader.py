@@ -0,0 +1,78 @@
+#!/usr/bin/python3
+"""
+Reader of the memory accounting samples written by the simulator (MEM_MON_FILE,
+see src/point-to-point/model/memory-accounting.h).
+
+Every sample is one "timeNs subsystem entries bytes" line per subsystem plus a
+"timeNs rss 0 bytes" line; "#" lines are the final (or budget-exceeded) report.
+Prints the peak of every subsystem, the time of the peak and its share of the
+accounted bytes at that time, and the peak RSS.
+
+Usage:
+    python3 run.py --mem_mon_interval 100 ...   (or --mem_budget_mb 4096)
+    python3 analysis/memory_reader.py mix/output/{id}/{id}_out_mem.txt [--subsystem rdma.qp]
+"""
+
+import argparse
+import sys
+from collections import defaultdict
+
+
+def load(filename):
+    """time_ns -> subsystem -> (entries, bytes); samples of several ranks are summed"""
+    samples = defaultdict(lambda: defaultdict(lambda: [0, 0]))
+    with open(filename) as f:
+        for line in f:
+            if line.startswith("#"):
+                continue
+            v = line.split()
+            if len(v) != 4:
+                continue
+            u = samples[int(v[0])][v[1]]
+            u[0] += int(v[2])
+            u[1] += int(v[3])
+    return samples
+
+
+def mb(b):
+    return "{:.1f}".format(b / 1048576.0)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Peak memory per subsystem from the memory accounting samples')
+    parser.add_argument('file', help="MEM_MON_FILE of a run")
+    parser.add_argument('--subsystem', default=None, help="print the time series of this subsystem")
+    args = parser.parse_args()
+
+    samples = load(args.file)
+    if not samples:
+        print("no samples in {}".format(args.file))
+        return 1
+    if args.subsystem is not None:
+        for t in sorted(samples):
+            if args.subsystem in samples[t]:
+                entries, nbytes = samples[t][args.subsystem]
+                print("{:14d} {:12d} {:>10} MB".format(t, entries, mb(nbytes)))
+        return 0
+
+    peak = {}  # subsystem -> (bytes, entries, time, share)
+    for t, usage in samples.items():
+        total = max(sum(u[1] for s, u in usage.items() if s != "rss"), 1)
+        for s, (entries, nbytes) in usage.items():
+            if s == "rss":
+                continue
+            if s not in peak or nbytes > peak[s][0]:
+                peak[s] = (nbytes, entries, t, nbytes / total)
+    print("{} samples, {} - {} ns".format(len(samples), min(samples), max(samples)))
+    print("{:32} {:>12} {:>10} {:>14} {:>7}".format("subsystem", "entries", "peak MB", "at ns", "share"))
+    for s, (nbytes, entries, t, share) in sorted(peak.items(), key=lambda x: -x[1][0]):
+        print("{:32} {:12d} {:>10} {:14d} {:6.1%}".format(s, entries, mb(nbytes), t, share))
+    rss = [(usage["rss"][1], t) for t, usage in samples.items() if "rss" in usage]
+    if rss:
+        top = max(rss)
+        print("peak rss {} MB at {} ns".format(mb(top[0]), top[1]))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
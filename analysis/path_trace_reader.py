@@ -0,0 +1,119 @@
+#!/usr/bin/python3
+"""
+Reader of the binary per-flow path trace written by the simulator
+(PATH_TRACE_FILE, see src/point-to-point/model/path-tracer.h).
+
+Every switch records (flow, flowlet, port, time) only when the egress port of a
+flow changes there; a path is rebuilt by walking from the source ToR along the
+latest port of every switch.
+
+Usage:
+    python3 path_trace_reader.py mix/output/{id}/{id}_out_path_trace.bin [--flow 12]
+"""
+
+import argparse
+import struct
+import sys
+from collections import defaultdict
+
+
+class PathTrace:
+    def __init__(self):
+        self.peers = {}                  # switch -> [peer node id per port]
+        self.events = defaultdict(list)  # flow -> [(time_ns, switch, port, flowlet)], time ordered
+
+    @staticmethod
+    def load(filename):
+        t = PathTrace()
+        with open(filename, "rb") as f:
+            data = f.read()
+        pos = 0
+
+        def read(fmt):
+            nonlocal pos
+            vals = struct.unpack_from("<" + fmt, data, pos)
+            pos += struct.calcsize("<" + fmt)
+            return vals
+
+        magic = data[:4]
+        pos = 4
+        if magic != b"PTRC":
+            raise Exception(f'{filename} is not a path trace file')
+        (version,) = read("I")
+        if version != 1:
+            raise Exception(f'unsupported path trace version {version}')
+        (n_switches,) = read("I")
+        for _ in range(n_switches):
+            node, n_ports = read("II")
+            t.peers[node] = list(read("%dI" % n_ports))
+            (n,) = read("Q")
+            flows = read("%dI" % n)
+            flowlets = read("%dI" % n)
+            ports = read("%dH" % n)
+            times = read("%dQ" % n)
+            for i in range(n):
+                t.events[flows[i]].append((times[i], node, ports[i], flowlets[i]))
+        for ev in t.events.values():
+            ev.sort()
+        return t
+
+    def walk(self, src, ports):
+        """switch ids from `src` following the current port of every switch,
+        None while the packets have not reached the destination host yet"""
+        path = [src]
+        node = src
+        while node in ports:
+            peer = self.peers[node][ports[node]]
+            if peer not in self.peers:
+                return path  # the destination host
+            if peer in path:
+                return None  # stale state of an older path
+            path.append(peer)
+            node = peer
+        return None
+
+    def flowlet_paths(self, flow):
+        """[(time_ns, flowlet, [switch ids])], one entry every time the path of `flow` changed"""
+        ev = self.events.get(flow, [])
+        if not ev:
+            return []
+        src = ev[0][1]  # the first switch a flow goes through is its source ToR
+        ports = {}
+        out = []
+        for time_ns, node, port, flowlet in ev:
+            ports[node] = port
+            path = self.walk(src, ports)
+            if path is None or (out and out[-1][2] == path):
+                continue
+            out.append((time_ns, flowlet, path))
+        return out
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Rebuild per-flowlet paths from the binary path trace')
+    parser.add_argument('file', help="PATH_TRACE_FILE of a run")
+    parser.add_argument('--flow', type=int, default=None, help="print the paths of this flow")
+    args = parser.parse_args()
+
+    t = PathTrace.load(args.file)
+    if args.flow is not None:
+        for time_ns, flowlet, path in t.flowlet_paths(args.flow):
+            print("{:14d} flowlet {:4d} {}".format(time_ns, flowlet, "-".join(map(str, path))))
+        return 0
+
+    n_records = sum(len(ev) for ev in t.events.values())
+    flowlets, distinct = [], []
+    for flow in t.events:
+        paths = t.flowlet_paths(flow)
+        flowlets.append(max(p[1] for p in paths) + 1 if paths else 0)
+        distinct.append(len(set(tuple(p[2]) for p in paths)))
+    n = max(len(flowlets), 1)
+    print("switches {} flows {} path changes {}".format(len(t.peers), len(t.events), n_records))
+    print("flowlets per flow: mean {:.2f} max {}".format(sum(flowlets) / n, max(flowlets, default=0)))
+    print("distinct paths per flow: mean {:.2f} max {}, flows on >1 path {}".format(
+        sum(distinct) / n, max(distinct, default=0), sum(1 for d in distinct if d > 1)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
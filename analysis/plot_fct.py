@@ -10,6 +10,7 @@ import matplotlib.pyplot as plt
 import matplotlib.ticker as tick
 import math
 from cycler import cycler
+from fct_summary import get_steps_from_summary
 
 
 from datetime import datetime
@@ -217,6 +218,7 @@ def main():
     parser.add_argument('-fT', dest='time_limit_end', action='store', type=int, default=10000000000, help="only consider flows that finish before T, default=10000000000 ns")
     parser.add_argument('-id', dest='index_limit', action='store', type=str, default='', help="only consider specific experiment results")
     parser.add_argument('-lb', dest='lb_limit', action='store', type=str, default='all', help="only consider specific lb results")
+    parser.add_argument('-summary', dest='use_summary', action='store_true', help="read {id}_out_fct_summary.txt (per size bin) instead of {id}_out_fct.txt")
     
     args = parser.parse_args()
     time_start = args.time_limit_begin
@@ -337,9 +339,14 @@ def main():
 
                 if lb_mode == tgt_lbmode:
                     # plotting
-                    fct_slowdown = output_dir + "/{id}/{id}_out_fct.txt".format(id=config_id)
                     try:
-                        result = get_steps_from_raw(fct_slowdown, int(time_start), int(time_end), STEP)
+                        if args.use_summary:
+                            fct_summary = output_dir + "/{id}/{id}_out_fct_summary.txt".format(id=config_id)
+                            result = get_steps_from_summary(fct_summary, int(time_start), int(time_end))
+                            xvals = [STEP * (i + 1) for i in range(len(result["avg"]))]
+                        else:
+                            fct_slowdown = output_dir + "/{id}/{id}_out_fct.txt".format(id=config_id)
+                            result = get_steps_from_raw(fct_slowdown, int(time_start), int(time_end), STEP)
                     except Exception as e:
                         print(e.args[0])
                         continue
@@ -401,9 +408,14 @@ def main():
 
                 if lb_mode == tgt_lbmode:
                     # plotting
-                    fct_slowdown = output_dir + "/{id}/{id}_out_fct.txt".format(id=config_id)
                     try:
-                        result = get_steps_from_raw(fct_slowdown, int(time_start), int(time_end), STEP)
+                        if args.use_summary:
+                            fct_summary = output_dir + "/{id}/{id}_out_fct_summary.txt".format(id=config_id)
+                            result = get_steps_from_summary(fct_summary, int(time_start), int(time_end))
+                            xvals = [STEP * (i + 1) for i in range(len(result["avg"]))]
+                        else:
+                            fct_slowdown = output_dir + "/{id}/{id}_out_fct.txt".format(id=config_id)
+                            result = get_steps_from_raw(fct_slowdown, int(time_start), int(time_end), STEP)
                     except Exception as e:
                         print(e.args[0])
                         continue
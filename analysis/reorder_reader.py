@@ -0,0 +1,97 @@
+#!/usr/bin/python3
+"""
+Reader of the binary reordering analytics written by the simulator
+(REORDER_ANALYTICS_FILE, see src/point-to-point/model/reorder-analytics.h).
+
+Usage:
+    python3 reorder_reader.py mix/output/{id}/{id}_out_reorder.bin [--top 10]
+"""
+
+import argparse
+import struct
+import sys
+
+
+class Reorder:
+    def __init__(self):
+        self.distance_hist = []    # log2 bytes, per out-of-order arrival
+        self.buffer_hist = []      # log2 bytes, per episode
+        self.episode_ns_hist = []  # log2 ns, per episode
+        self.flows = []            # dict(flow, packets, ooo_bytes, episode_ns, ooo_packets,
+                                   #      episodes, max_distance, max_buffer, path_switches)
+
+    @staticmethod
+    def load(filename):
+        r = Reorder()
+        with open(filename, "rb") as f:
+            data = f.read()
+        pos = 0
+
+        def read(fmt):
+            nonlocal pos
+            vals = struct.unpack_from("<" + fmt, data, pos)
+            pos += struct.calcsize("<" + fmt)
+            return vals
+
+        magic = data[:4]
+        pos = 4
+        if magic != b"RORD":
+            raise Exception(f'{filename} is not a reordering analytics file')
+        (version,) = read("I")
+        if version != 1:
+            raise Exception(f'unsupported reordering analytics version {version}')
+        n_bins, n_flows = read("II")
+        r.distance_hist = list(read("%dQ" % n_bins))
+        r.buffer_hist = list(read("%dQ" % n_bins))
+        r.episode_ns_hist = list(read("%dQ" % n_bins))
+        for _ in range(n_flows):
+            (flow, packets, ooo_bytes, episode_ns, ooo_packets, episodes, max_distance, max_buffer,
+             path_switches) = read("iQQQIIIII")
+            r.flows.append(dict(flow=flow, packets=packets, ooo_bytes=ooo_bytes,
+                                episode_ns=episode_ns, ooo_packets=ooo_packets, episodes=episodes,
+                                max_distance=max_distance, max_buffer=max_buffer,
+                                path_switches=path_switches))
+        return r
+
+
+def hist_quantile(hist, q):
+    """upper edge of the log2 bin holding quantile q; bin 0 is the value 0"""
+    total = sum(hist)
+    if total == 0:
+        return 0
+    rank = min(int(total * q), total - 1)
+    seen = 0
+    for b, cnt in enumerate(hist):
+        seen += cnt
+        if seen > rank:
+            return 0 if b == 0 else (1 << b) - 1
+    return (1 << (len(hist) - 1)) - 1
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Summarize the binary reordering analytics')
+    parser.add_argument('file', help="REORDER_ANALYTICS_FILE of a run")
+    parser.add_argument('--top', type=int, default=10, help="flows with the largest reorder buffer")
+    args = parser.parse_args()
+
+    r = Reorder.load(args.file)
+    reordered = [f for f in r.flows if f["episodes"] > 0]
+    print("flows {} reordered {} ({:.2f}%)".format(
+        len(r.flows), len(reordered), 100.0 * len(reordered) / max(len(r.flows), 1)))
+    for name, hist in (("distance(B)", r.distance_hist), ("buffer(B)", r.buffer_hist),
+                       ("episode(ns)", r.episode_ns_hist)):
+        print("{:12s} n {:8d} p50 <={} p99 <={} p99.9 <={}".format(
+            name, sum(hist), hist_quantile(hist, 0.5), hist_quantile(hist, 0.99),
+            hist_quantile(hist, 0.999)))
+    switched = [f for f in r.flows if f["path_switches"] > 0]
+    print("flows with path switches {}, of which reordered {}".format(
+        len(switched), sum(1 for f in switched if f["episodes"] > 0)))
+    print("flow  packets  oooPackets  episodes  maxDistance  maxBuffer  pathSwitches")
+    for f in sorted(r.flows, key=lambda f: -f["max_buffer"])[:args.top]:
+        print("{flow:5d} {packets:8d} {ooo_packets:11d} {episodes:9d} {max_distance:12d} "
+              "{max_buffer:10d} {path_switches:13d}".format(**f))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,110 @@
+#!/usr/bin/python3
+"""
+Reader of the binary link telemetry written by the simulator
+(LINK_TELEMETRY_FILE, see src/point-to-point/model/link-telemetry.h).
+
+Usage:
+    python3 telemetry_reader.py mix/output/{id}/{id}_out_link_telemetry.bin
+"""
+
+import argparse
+import struct
+import sys
+
+
+class Telemetry:
+    def __init__(self):
+        self.start_ns = 0
+        self.sample_ns = 0
+        self.downsample = 0
+        self.n_points = 0
+        self.links = []  # dict(node, port, peer, tor, bitrate, max_queue, queue_hist, util[])
+        self.tors = []   # dict(tor, n_uplinks, max_mean[], cv[])
+
+    @property
+    def resolution_ns(self):
+        return self.sample_ns * self.downsample
+
+    def times(self):
+        """end time (ns) of every series point"""
+        return [self.start_ns + (i + 1) * self.resolution_ns for i in range(self.n_points)]
+
+    @staticmethod
+    def load(filename):
+        t = Telemetry()
+        with open(filename, "rb") as f:
+            data = f.read()
+        pos = 0
+
+        def read(fmt):
+            nonlocal pos
+            vals = struct.unpack_from("<" + fmt, data, pos)
+            pos += struct.calcsize("<" + fmt)
+            return vals
+
+        magic = data[:4]
+        pos = 4
+        if magic != b"LTEL":
+            raise Exception(f'{filename} is not a link telemetry file')
+        (version,) = read("I")
+        if version != 1:
+            raise Exception(f'unsupported telemetry version {version}')
+        t.start_ns, t.sample_ns, t.downsample, t.n_points, n_links, n_bins = read("QQIIII")
+        for _ in range(n_links):
+            node, port, peer, tor, bitrate, max_queue = read("IIIIQI")
+            hist = list(read("%dQ" % n_bins))
+            util = [u / 10000.0 for u in read("%dH" % t.n_points)]
+            t.links.append(dict(node=node, port=port, peer=peer, tor=tor, bitrate=bitrate,
+                                max_queue=max_queue, queue_hist=hist, util=util))
+        (n_tors,) = read("I")
+        for _ in range(n_tors):
+            tor, n_uplinks = read("II")
+            max_mean = list(read("%df" % t.n_points))
+            cv = list(read("%df" % t.n_points))
+            t.tors.append(dict(tor=tor, n_uplinks=n_uplinks, max_mean=max_mean, cv=cv))
+        return t
+
+
+def hist_quantile(hist, q):
+    """upper edge (bytes) of the log2 bin holding quantile q; bin 0 is an empty queue"""
+    total = sum(hist)
+    if total == 0:
+        return 0
+    rank = min(int(total * q), total - 1)
+    seen = 0
+    for b, cnt in enumerate(hist):
+        seen += cnt
+        if seen > rank:
+            return 0 if b == 0 else (1 << b) - 1
+    return (1 << (len(hist) - 1)) - 1
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Print link telemetry summary')
+    parser.add_argument('file', help="LINK_TELEMETRY_FILE output")
+    args = parser.parse_args()
+
+    t = Telemetry.load(args.file)
+    print("start {} ns, resolution {} ns, {} points, {} links".format(
+        t.start_ns, t.resolution_ns, t.n_points, len(t.links)))
+
+    print("\n{:>6} {:>8} {:>10} {:>10} {:>10}".format("ToR", "uplinks", "max/mean", "CV", "maxCV"))
+    for tor in t.tors:
+        n = max(len(tor["cv"]), 1)
+        print("{:>6} {:>8} {:>10.3f} {:>10.3f} {:>10.3f}".format(
+            tor["tor"], tor["n_uplinks"], sum(tor["max_mean"]) / n, sum(tor["cv"]) / n,
+            max(tor["cv"]) if tor["cv"] else 0))
+
+    print("\n{:>6} {:>5} {:>6} {:>8} {:>8} {:>10} {:>10}".format(
+        "node", "port", "peer", "avgUtil", "maxUtil", "p99Queue", "maxQueue"))
+    for link in t.links:
+        n = max(len(link["util"]), 1)
+        print("{:>6} {:>5} {:>6} {:>8.3f} {:>8.3f} {:>10} {:>10}".format(
+            link["node"], link["port"], link["peer"], sum(link["util"]) / n,
+            max(link["util"]) if link["util"] else 0, hist_quantile(link["queue_hist"], 0.99),
+            link["max_queue"]))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
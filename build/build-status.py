@@ -0,0 +1,8 @@
+#! /usr/bin/env python
+
+# Programs that are runnable.
+ns3_runnable_programs = ['build/scratch/ns3.19-network-load-balance-optimized', 'build/scratch/subdir/ns3.19-subdir-optimized', 'build/scratch/ns3.19-scratch-simulator-optimized']
+
+# Scripts that are runnable.
+ns3_runnable_scripts = []
+
@@ -0,0 +1,173 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CAVER-LB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ns3/callback.h"
+#include "ns3/fct-aggregator.h"
+
+namespace ns3 {
+
+/**
+ * @brief Dependency-driven collective communication traffic (ring/tree all-reduce,
+ * all-gather, reduce-scatter, all-to-all) over groups of hosts.
+ * 每个 job 被展开成若干 step，rank 在某个 step 的发送流和接收流全部完成后才进入下一个
+ * step（真实集合通信的依赖关系），而不是按时间戳独立发流。依赖只在 rank 级别维护：
+ * 每个 rank 只记当前 step 和未完成的收/发计数，提前到达的接收按 (rank, step) 暂存，
+ * 流直接通过 launcher 回调建 QP（不创建 Application），所以上千个 rank 也只占 O(rank) 内存。
+ * 流完成由 qp_finish 调用 OnFlowComplete 通知。结束时写出每个 job 的完成时间（JCT）
+ * 以及每个 step 的流完成时间分布尾部。
+ *
+ * 各算法的 step（n 个 rank，S 为每个 rank 的数据量）：
+ * - RING_ALLREDUCE: 2(n-1) 步，rank r 发给 r+1，收自 r-1，每步 S/n
+ * - ALLGATHER / REDUCE_SCATTER: n-1 步，同上的环
+ * - ALLTOALL: n-1 步（pairwise），第 s 步 r 发给 r+s，收自 r-s，每对 S/n
+ * - TREE_ALLREDUCE: 二叉树（rank 0 为根），先逐层 reduce 到根再逐层 broadcast，
+ *   共 2*depth 步，每条流 S
+ */
+class CollectiveEngine {
+   public:
+    enum Type : uint32_t {
+        RING_ALLREDUCE = 0,
+        TREE_ALLREDUCE,
+        ALLGATHER,
+        REDUCE_SCATTER,
+        ALLTOALL,
+        NUM_TYPES
+    };
+    enum : uint32_t { NO_PEER = 0xffffffff };
+
+    /**
+     * @brief starts one flow and returns (sport << 16 | dport) of its QP;
+     * arguments: src host, dst host, pg, bytes
+     */
+    typedef Callback<uint32_t, uint32_t, uint32_t, uint32_t, uint64_t> Launcher;
+
+    CollectiveEngine();
+
+    void SetLauncher(Launcher launcher) { m_launcher = launcher; }
+    void SetRelErr(double relErr) { m_relErr = relErr; }
+
+    /**
+     * @brief job file, one job per line ('#' starts a comment):
+     *   <type> <start time (s)> <bytes per rank> <pg> <host> [<host> ...]
+     * type: ring_allreduce | tree_allreduce | allgather | reduce_scatter | alltoall,
+     * a host may be given as a range "a-b" (inclusive)
+     */
+    bool Load(const std::string& filename);
+    /* schedules the start of every job; call before Simulator::Run */
+    void Start();
+
+    /* from qp_finish; returns false if the QP is not a collective flow */
+    bool OnFlowComplete(uint32_t src, uint16_t sport, uint16_t dport);
+
+    /**
+     * @brief text summary:
+     *   JOB <id> <type> <nRanks> <bytes> <nSteps> <startNs> <endNs> <jctNs>
+     *   STEP <id> <step> <nFlows> <firstStartNs> <lastEndNs> <p50FctNs> <p99FctNs> <maxFctNs>
+     * unfinished jobs have endNs = jctNs = 0
+     */
+    bool Write(const char* filename) const;
+
+    uint32_t GetNumJobs() const { return m_jobs.size(); }
+    uint64_t GetTotalFlows() const { return m_totalFlows; }
+    uint32_t GetNumFinishedJobs() const { return m_finishedJobs; }
+
+    static const char* TypeName(uint32_t type);
+
+   private:
+    struct RankState {
+        uint32_t step;
+        uint32_t pendingSends;
+        uint32_t pendingRecvs;
+    };
+    struct StepStats {
+        uint64_t nFlows;
+        uint64_t firstStartNs;
+        uint64_t lastEndNs;
+        uint64_t maxFctNs;
+        QuantileSketch fct;
+        explicit StepStats(double relErr)
+            : nFlows(0), firstStartNs(UINT64_MAX), lastEndNs(0), maxFctNs(0), fct(relErr) {}
+    };
+    struct Job {
+        uint32_t type;
+        uint64_t startNs;
+        uint64_t bytes;
+        uint32_t pg;
+        uint32_t nSteps;
+        uint32_t depth;  // tree only
+        uint64_t endNs;
+        uint32_t ranksDone;
+        std::vector<uint32_t> hosts;
+        std::vector<RankState> ranks;
+        std::vector<StepStats> steps;
+        std::unordered_map<uint64_t, uint32_t> early;  // (rank, step) -> recvs completed ahead
+    };
+    struct InFlight {
+        uint32_t job;
+        uint32_t step;
+        uint32_t srcRank;
+        uint32_t dstRank;
+        uint64_t startNs;
+        uint64_t endNs;
+    };
+
+    /* sends (at most 2 peers) and expected receives of `rank` in `step` */
+    void Peers(const Job& job, uint32_t rank, uint32_t step, uint32_t* sendTo, uint32_t* nSend,
+               uint32_t* nRecv) const;
+    uint64_t FlowBytes(const Job& job) const;
+    uint64_t CountFlows(const Job& job) const;
+
+    void StartJob(uint32_t jobId);
+    /* enters the current step of `rank` and moves on through every step that needs no flow */
+    void EnterStep(uint32_t jobId, uint32_t rank);
+    void Launch(uint32_t jobId, uint32_t step, uint32_t srcRank, uint32_t dstRank);
+    void HandleCompletion(InFlight f);
+
+    static uint64_t FlowKey(uint32_t src, uint16_t sport, uint16_t dport) {
+        return ((uint64_t)src << 32) | ((uint32_t)sport << 16) | dport;
+    }
+    static uint64_t RankStepKey(uint32_t rank, uint32_t step) {
+        return ((uint64_t)rank << 32) | step;
+    }
+
+    Launcher m_launcher;
+    double m_relErr;
+    uint64_t m_totalFlows;
+    uint32_t m_finishedJobs;
+    std::vector<Job> m_jobs;
+    std::unordered_map<uint64_t, InFlight> m_inFlight;
+};
+
+}  // namespace ns3
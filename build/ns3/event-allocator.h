@@ -0,0 +1,75 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef EVENT_ALLOCATOR_H
+#define EVENT_ALLOCATOR_H
+
+#include <stdint.h>
+#include <cstddef>
+
+namespace ns3 {
+
+/**
+ * \ingroup events
+ * \brief size-classed free-list allocator backing EventImpl::operator new
+ *
+ * Every Simulator::Schedule creates one EventImpl subclass (see MakeEvent),
+ * which used to be a separate heap allocation. Event objects are small
+ * (a vtable, the reference count, the member-function pointer, the object
+ * and a few arguments), so they are carved out of chunks in size classes
+ * of GRANULE bytes up to MAX_SIZE bytes and put back on a free list when
+ * the last reference goes away, whether the event ran or was cancelled.
+ * Larger events fall back to the global operator new.
+ *
+ * Free lists are per thread, so the common single-threaded case takes no
+ * lock. A block released by another thread (e.g., the realtime simulator's
+ * ScheduleWithContext) simply joins that thread's free list. Chunks are
+ * never returned to the system; the pool is bounded by the peak number of
+ * live events.
+ */
+class EventAllocator
+{
+public:
+  enum
+  {
+    GRANULE = 16,
+    MAX_SIZE = 256,
+    N_CLASSES = MAX_SIZE / GRANULE,
+    BLOCKS_PER_CHUNK = 256
+  };
+
+  /** \brief allocation counters of the calling thread */
+  struct Stats
+  {
+    uint64_t allocations;  //!< total Allocate calls
+    uint64_t recycled;     //!< served from a free list
+    uint64_t chunks;       //!< chunks obtained from the system
+    uint64_t unpooled;     //!< larger than MAX_SIZE, served by operator new
+  };
+
+  static void *Allocate (std::size_t size);
+  static void Deallocate (void *p, std::size_t size);
+
+  /**
+   * \returns the counters of the calling thread. The number of system
+   * allocations is chunks + unpooled; without the pool it would have
+   * been allocations.
+   */
+  static Stats GetStats (void);
+};
+
+} // namespace ns3
+
+#endif /* EVENT_ALLOCATOR_H */
@@ -0,0 +1,182 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CAVER-LB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdint.h>
+
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#include "ns3/callback.h"
+#include "ns3/deadline-timer.h"
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+
+namespace ns3 {
+
+class Node;
+class QbbNetDevice;
+class SwitchNode;
+
+/**
+ * @brief Fluid flows: flows as max-min fair rates instead of packets.
+ * 流体流不生成包，而是沿一条路径（默认 flow ECMP，与 DoLbFlowECMP 同一个哈希；也可选
+ * 最少流的出端口，或在子类里重写 ChoosePort）成为一个速率分配。每次流到达/离开时做
+ * max-min 公平分配（progressive filling，链路容量取 C * m_capacityFactor）。分配是增量的：
+ * max-min 只在共享链路的流构成的连通分量内相互影响，只对到达/离开的流所在的分量重新
+ * 注水，速率没变的流不动；剩余字节在速率改变时才结算，完成时刻放在 DeadlineTimer 里。
+ * 每次到达/离开的代价与它所在分量的大小（流数 x 路径长度）成正比，而不是与总流数成正比；
+ * 但负载越高分量越大：fat_k4_100G_OS2、50% 负载（AliStorage）时分量约 60 条流，100 万条
+ * 流的流级估算约 50 s（12.2 万条约 5 s），不是几秒。SetIncremental(false) 每次重新注水所有
+ * 的流，作为增量分配的参照（测试用）。
+ * 两种用法：
+ * - 独立的流级估算（SetStandalone）：所有流都是流体，容量取满，不和包交互，用来快速筛选
+ * - 混合模式：大于阈值的背景流是流体（容量留出余量），前景流仍是包。前景流不参与分配
+ *   （短流不是贪婪流，按贪婪流计入会压低流体流的速率并制造不存在的瓶颈），它们用流体流
+ *   剩下的带宽：
+ *   - 出端口 SetFluidRate：数据包用流体流剩下的带宽，但至少和一条流的公平份额一样多
+ *     （n 条流体流时 C / (n + 1)，拥塞控制下流体流会让出带宽）；控制包仍是严格优先级
+ *   - 每个 tick 把流体字节计入交换机的发送计数和负载均衡模块的 DRE（AddFluidTx）
+ *   - 每个 tick 按 Little 定律给出流体在队列里的虚拟占用（SetFluidBacklog）：流体与包经历
+ *     同样的排队时延 Q_pkt / (C - f)（f 为施加到端口上的流体速率），占用 f * Q_pkt / (C - f)
+ *     按各入端口的流体速率分摊；它只计入 ECN 标记、PFC 的判断和队列长度，不再额外延迟包：
+ *     包的排队时延只来自 SetFluidRate 的限速（按 C - f 服务，已经包含了排在前面的流体字节），
+ *     同一条流的包始终按 FIFO 出队，不会乱序
+ *   流体流本身不响应 PFC/ECN。
+ */
+class FluidModel {
+   public:
+    struct Finished {
+        uint32_t flowId;
+        uint32_t src;  // node ids
+        uint32_t dst;
+        uint16_t sport;
+        uint16_t dport;
+        uint64_t bytes;
+        uint64_t startNs;
+        uint64_t fctNs;
+    };
+    typedef Callback<void, const Finished&> FinishCallback;
+    enum PathPolicy { PATH_ECMP = 0, PATH_LEAST_FLOWS = 1 };
+
+    FluidModel();
+    virtual ~FluidModel() {}
+
+    void SetFinishCallback(FinishCallback cb) { m_finish = cb; }
+    void SetTick(Time tick) { m_tick = tick; }
+    void SetCapacityFactor(double f) { m_capacityFactor = f; }
+    void SetPathPolicy(PathPolicy p) { m_pathPolicy = p; }
+    /* flow-level estimation only: no tick, the ports and switches never see the fluid */
+    void SetStandalone(bool standalone) { m_standalone = standalone; }
+    /* false: every reallocation refills all the flows, not just the touched components */
+    void SetIncremental(bool incremental) { m_incremental = incremental; }
+
+    /* a fluid flow starts now between hosts src and dst, it is carried until it completes */
+    void AddFlow(uint32_t flowId, Ptr<Node> src, Ptr<Node> dst, uint32_t sip, uint32_t dip,
+                 uint16_t sport, uint16_t dport, uint32_t pg, uint64_t bytes);
+
+    uint64_t GetNumFluidFlows() const { return m_nFluidFlows; }
+    uint64_t GetNumFinished() const { return m_nFinished; }
+    /* rate changes of the flows, summed over all the reallocations */
+    uint64_t GetNumRateUpdates() const { return m_nRateUpdates; }
+
+   protected:
+    /* egress port of the flow at switch sw (dip must be routable there) */
+    virtual int ChoosePort(Ptr<SwitchNode> sw, uint32_t sip, uint32_t dip, uint16_t sport,
+                           uint16_t dport);
+
+   private:
+    struct Flow;
+    typedef std::pair<double, uint32_t> Share;  // fair share of a link, link
+    struct Link {
+        Ptr<QbbNetDevice> dev;
+        SwitchNode* sw;    // NULL for a host NIC
+        uint32_t port;
+        double capacity;   // bps available to the allocation
+        double fluidRate;  // bps of the fluid flows
+        double fluidBytes;  // sent by the fluid flows since the last tick
+        uint64_t lastNs;    // fluidBytes is accounted up to here
+        std::map<std::pair<uint32_t, uint32_t>, double> fluidIn;  // (inPort, qIndex) -> bps
+        std::vector<Flow*> flows;  // crossing the link
+        uint64_t mark;             // epoch of the last reallocation that walked the link
+        double residual;           // progressive filling
+        uint32_t unfixed;
+    };
+    struct Flow {
+        uint32_t id;
+        uint32_t src, dst;
+        uint16_t sport, dport;
+        uint32_t pg;
+        uint64_t bytes;
+        double remaining;  // bytes, at lastNs
+        double rate;       // bps
+        double newRate;    // progressive filling, -1 while not fixed
+        uint64_t startNs;
+        uint64_t lastNs;
+        uint64_t mark;
+        std::vector<uint32_t> links;
+        std::vector<uint32_t> inPorts;  // ingress port at the head of links[i] (0 at the host)
+        std::vector<uint32_t> slots;    // index of the flow in m_links[links[i]].flows
+    };
+
+    uint32_t GetLink(Ptr<Node> node, Ptr<QbbNetDevice> dev);
+    /* the egress links of the flow from src to dst, following ChoosePort */
+    bool Route(Flow& f, Ptr<Node> src, Ptr<Node> dst, uint32_t sip, uint32_t dip);
+    void Attach(Flow* f);
+    void Detach(Flow* f);
+    void Touch(uint32_t link);  // the allocation around the link must be recomputed
+    void AccountLink(Link& link, uint64_t now);
+    void Reallocate();  // max-min over the components of the touched links, applies the rates
+    void Complete(uint32_t flowId);
+    void Tick();
+
+    FinishCallback m_finish;
+    Time m_tick;
+    double m_capacityFactor;
+    PathPolicy m_pathPolicy;
+    bool m_standalone;
+    bool m_incremental;
+    uint64_t m_nFluidFlows;  // active (m_flows.size())
+    uint64_t m_nFinished;
+    uint64_t m_nRateUpdates;
+    uint64_t m_epoch;
+    DeadlineTimer m_completion;  // flow id -> completion time at the current rate
+    EventId m_reallocEvent;
+    EventId m_tickEvent;
+    std::vector<uint32_t> m_touched;  // links, until the next reallocation
+    std::vector<uint32_t> m_walkLinks;  // scratch of Reallocate
+    std::vector<Flow*> m_walkFlows;
+    std::vector<Share> m_heap;
+    std::vector<Link> m_links;
+    std::unordered_map<uint64_t, uint32_t> m_linkIndex;  // (node, ifIndex) -> m_links
+    std::unordered_map<uint32_t, Flow> m_flows;          // active, by flow id
+    std::map<uint64_t, uint32_t> m_backlog;  // (link, inPort, qIndex) -> bytes set at the last tick
+};
+
+}  // namespace ns3
@@ -0,0 +1,169 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2025 CAVER-LB
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <arpa/inet.h>
+
+#include <map>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+#include "ns3/address.h"
+#include "ns3/callback.h"
+#include "ns3/event-id.h"
+#include "ns3/load-balancer.h"
+#include "ns3/net-device.h"
+#include "ns3/object.h"
+#include "ns3/packet.h"
+#include "ns3/ptr.h"
+#include "ns3/settings.h"
+#include "ns3/simulator.h"
+#include "ns3/tag.h"
+
+namespace ns3 {
+/**
+ * @brief Conga object is created for each ToR Switch
+ */
+class HulaRouting : public LoadBalancer {
+    friend class SwitchMmu;
+    friend class SwitchNode;
+
+   public:
+    HulaRouting();
+    /* static */
+    static TypeId GetTypeId(void);
+    static uint64_t GetQpKey(uint32_t dip, uint16_t sport, uint16_t dport, uint16_t pg);              // same as in rdma_hw.cc
+    static uint32_t nFlowletTimeout;
+    static std::vector<HulaRouting*> hulaModules;
+    static bool probeBatching;                          // one timer event generates probes of all switches
+    static std::vector<HulaRouting*> probeBatchModules; // activated switches, in activation order
+    static EventId probeBatchEvent;
+    static void GenerateProbeBatch();
+
+    /* main function */
+    void RouteInput(Ptr<Packet> p, CustomHeader ch);
+    virtual bool Ingress(Ptr<Packet> p, CustomHeader& ch);  // takes every packet: RouteInput
+    virtual void OnSend(Ptr<Packet> p, uint32_t outDev);    // updateLink
+    virtual void OnFluidTx(uint32_t outDev, uint64_t bytes);  // updateLink with the fluid bytes
+    virtual void ReportMemory(MemoryAccounting::Report& report);  // flowlet table
+    virtual bool ReceiveControl(uint32_t ifIndex, Ptr<Packet> p, CustomHeader& ch);  // processProbe
+    void processProbe(uint32_t inDev, Ptr<Packet> p, CustomHeader ch);
+    void updateLink(uint32_t dev, uint32_t packetSize);
+    void active(int time);
+
+    /* SET functions */
+    void SetSwitchInfo(bool isToR, uint32_t switch_id);
+    void SetLinkCapacity(uint32_t outPort, uint64_t bitRate);
+    void SetConstants(Time keepAliveThresh,
+                            Time probeTransmitInterval,
+                            Time flowletTimeout,
+                            Time probeGenerationInterval,
+                            Time tau);
+
+    // topological info (should be initialized in the beginning)
+    /*-----CALLBACK------*/
+    void DoSwitchSend(Ptr<Packet> p, CustomHeader& ch, uint32_t outDev,
+                      uint32_t qIndex);  // TxToR and Agg/CoreSw
+    void DoSwitchSendToDev(Ptr<Packet> p, CustomHeader& ch);  // only at RxToR
+    void DoSwitchSendHulaProbe(uint32_t dev, uint32_t torID, uint8_t minUtil);
+    typedef Callback<void, uint32_t, uint32_t, uint8_t> SwitchSendHulaProbeCallback;
+    void SetSwitchSendHulaProbeCallback(SwitchSendHulaProbeCallback switchSendHulaProbeCallback);
+    /*-----------*/
+    
+    std::unordered_set<uint32_t> upLayerDevs;          
+    std::unordered_set<uint32_t> downLayerDevs;
+
+    void Print();
+
+   private:
+    // callback
+    SwitchSendHulaProbeCallback m_switchSendHulaProbeCallback;
+
+    struct NextHopItem {
+        uint32_t    nextHopDev;       //下一跳
+        uint8_t     pathUtil;          //链路利用率
+        bool        valid;             //是否已经收到过该ToR的探针
+        Time        lastUpdateTime;   //上次更新时间
+        Time        lastProbeSendTime;
+        NextHopItem() :
+            nextHopDev(0), 
+            pathUtil(255), 
+            valid(false),
+            lastUpdateTime(Seconds(0)),
+            lastProbeSendTime(Seconds(-1)) {}
+    };
+
+    struct LinkInfo {
+        uint64_t maxBitRate;
+        uint64_t curUtil;
+        Time lastUpdateTime;
+        LinkInfo() : maxBitRate(0), curUtil(0), lastUpdateTime(Seconds(0)) {}
+    };
+
+    struct FlowletInfo {
+        Time activeTime;       // to check creating a new flowlet
+        Time createTime;    // start time of new flowlet
+        uint32_t nextHopDev;    // current pathId
+        uint32_t nPackets;     // for debugging
+        FlowletInfo() = default;
+        FlowletInfo(Time now, uint32_t nextHopDev) : 
+            activeTime(now), createTime(now), nextHopDev(nextHopDev), nPackets(1) {};
+    };
+
+    std::vector<NextHopItem> target2nextHop;  //target ToRID->nextHop (dense, indexed by ToR's nodeID)
+    std::unordered_map<uint32_t, FlowletInfo> flowletTable;  // flowId -> Flowlet (at SrcToR)
+    std::vector<LinkInfo> devInfo;           //dev->linkInfo (dense, indexed by port)
+    Time lastFlowletAgingTime;   //上次清除flowlet表中过期项的时间
+    EventId sendProbeEvent;
+
+    //常量
+    // hula constants
+    Time keepAliveThresh;        //探针老化时间
+    Time probeTransmitInterval;  //转发探针的时间窗口
+    Time flowletInterval;        //flowlet的区分间隔 (e.g., 100us)
+    Time probeGenerationInterval;//探针的生成间隔
+    Time tau;                    //计算链路利用率使用，至少是探针的生成间隔的两倍
+
+    void generateProbe();
+    void sendProbes();
+    void clearInvalidFlowletItem();
+    NextHopItem& GetNextHopItem(uint32_t torID);
+    LinkInfo& GetLinkInfo(uint32_t dev);
+
+   public:
+    bool m_isToR;          // is ToR (leaf)
+    uint32_t m_switch_id;  // switch's nodeID
+    //运行过程记录
+    int probeSendNum = 0;       //接收到的probe数量
+    int probeReceiveNum = 0;    //发送的probe数量
+    int probeAgedNum = 0;       //被老化的probe数量
+    int probeUpdateHopNum = 0;  //引起最优路径更新的探针数量
+};
+
+
+}  // namespace ns3
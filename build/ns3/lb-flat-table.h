@@ -0,0 +1,190 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CAVER-LB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <map>
+#include <set>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * @brief Read-only ToR -> {pathId} table frozen into contiguous arrays.
+ * 拓扑建立后路径集合不再变化，因此把 std::map<ToR, std::set<pathId>> 压平成
+ * CSR 形式：slot [m_begin[ord], m_begin[ord+1]) 是某个 ToR 的全部路径，
+ * 顺序与原 std::set 相同（随机下标选路的结果不变）。
+ * 每条路径的动态状态（CE、更新时间等）由使用者按 slot 存放在平行数组里。
+ */
+class FlatPathTable {
+   public:
+    enum : uint32_t { INVALID = 0xffffffff };
+
+    FlatPathTable() : m_frozen(false) {}
+
+    void Freeze(const std::map<uint32_t, std::set<uint32_t> >& table) {
+        m_torOrdinal.clear();
+        m_torIds.clear();
+        m_begin.clear();
+        m_pathIds.clear();
+        for (auto& kv : table) {
+            if (kv.first >= m_torOrdinal.size()) m_torOrdinal.resize(kv.first + 1, INVALID);
+            m_torOrdinal[kv.first] = m_torIds.size();
+            m_torIds.push_back(kv.first);
+            m_begin.push_back(m_pathIds.size());
+            m_pathIds.insert(m_pathIds.end(), kv.second.begin(), kv.second.end());
+        }
+        m_begin.push_back(m_pathIds.size());
+        m_frozen = true;
+    }
+
+    bool IsFrozen() const { return m_frozen; }
+
+    /** @brief dense ordinal of a ToR, or INVALID if there is no path to it */
+    uint32_t GetOrdinal(uint32_t torId) const {
+        return torId < m_torOrdinal.size() ? m_torOrdinal[torId] : INVALID;
+    }
+    uint32_t GetNumToRs() const { return m_torIds.size(); }
+    uint32_t GetToRId(uint32_t ord) const { return m_torIds[ord]; }
+    uint32_t GetNumSlots() const { return m_pathIds.size(); }
+
+    /* slots of a ToR ordinal */
+    uint32_t Begin(uint32_t ord) const { return m_begin[ord]; }
+    uint32_t End(uint32_t ord) const { return m_begin[ord + 1]; }
+    uint32_t Size(uint32_t ord) const { return m_begin[ord + 1] - m_begin[ord]; }
+    uint32_t PathId(uint32_t slot) const { return m_pathIds[slot]; }
+
+    /** @brief slot of (ord, pathId), or INVALID. 每个 ToR 的路径数很少，线性扫描即可 */
+    uint32_t FindSlot(uint32_t ord, uint32_t pathId) const {
+        for (uint32_t s = m_begin[ord]; s < m_begin[ord + 1]; s++) {
+            if (m_pathIds[s] == pathId) return s;
+        }
+        return INVALID;
+    }
+
+   private:
+    bool m_frozen;
+    std::vector<uint32_t> m_torOrdinal;  // ToRId -> ordinal
+    std::vector<uint32_t> m_torIds;      // ordinal -> ToRId
+    std::vector<uint32_t> m_begin;       // ordinal -> first slot (size = nToR + 1)
+    std::vector<uint32_t> m_pathIds;     // slot -> pathId
+};
+
+/**
+ * @brief Open-addressing flowlet table keyed by QpKey.
+ * 线性探测，value 直接存放在槽里（不再 new/delete 每个 flowlet）。
+ * 负载因子保持在 1/2 以下；老化时调用 EraseIf 整表重建，避免墓碑。
+ */
+template <typename V>
+class FlowletHashTable {
+   public:
+    FlowletHashTable() : m_size(0) { Rehash(64); }
+
+    /** @brief pointer to the value, or NULL if the key is absent */
+    V* Find(uint64_t key) {
+        uint32_t mask = m_keys.size() - 1;
+        for (uint32_t i = Hash(key) & mask;; i = (i + 1) & mask) {
+            if (!m_used[i]) return NULL;
+            if (m_keys[i] == key) return &m_values[i];
+        }
+    }
+
+    /** @brief insert or overwrite; returns the stored value */
+    V* Insert(uint64_t key, const V& value) {
+        if ((m_size + 1) * 2 > m_keys.size()) Rehash(m_keys.size() * 2);
+        uint32_t mask = m_keys.size() - 1;
+        uint32_t i = Hash(key) & mask;
+        while (m_used[i] && m_keys[i] != key) i = (i + 1) & mask;
+        if (!m_used[i]) {
+            m_used[i] = 1;
+            m_keys[i] = key;
+            m_size++;
+        }
+        m_values[i] = value;
+        return &m_values[i];
+    }
+
+    /** @brief drop every entry for which pred(value) is true */
+    template <typename Pred>
+    void EraseIf(Pred pred) {
+        std::vector<uint64_t> keys;
+        std::vector<V> values;
+        keys.reserve(m_size);
+        values.reserve(m_size);
+        for (uint32_t i = 0; i < m_keys.size(); i++) {
+            if (m_used[i] && !pred(m_values[i])) {
+                keys.push_back(m_keys[i]);
+                values.push_back(m_values[i]);
+            }
+        }
+        if (keys.size() == m_size) return;
+        uint32_t cap = 64;
+        while (cap < keys.size() * 4) cap <<= 1;
+        Rehash(cap, false);
+        for (uint32_t i = 0; i < keys.size(); i++) Insert(keys[i], values[i]);
+    }
+
+    uint32_t Size() const { return m_size; }
+    uint64_t GetMemoryBytes() const {
+        return m_keys.capacity() * sizeof(uint64_t) + m_values.capacity() * sizeof(V) + m_used.capacity();
+    }
+    void Clear() { Rehash(64, false); }
+
+   private:
+    static uint32_t Hash(uint64_t key) {
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdULL;
+        key ^= key >> 33;
+        return (uint32_t)key;
+    }
+
+    void Rehash(uint32_t cap, bool keep = true) {
+        std::vector<uint64_t> oldKeys;
+        std::vector<V> oldValues;
+        std::vector<uint8_t> oldUsed;
+        if (keep) {
+            oldKeys.swap(m_keys);
+            oldValues.swap(m_values);
+            oldUsed.swap(m_used);
+        }
+        // fresh vectors rather than assign(), so that EraseIf/Clear also give memory back
+        std::vector<uint64_t>(cap, 0).swap(m_keys);
+        std::vector<V>(cap, V()).swap(m_values);
+        std::vector<uint8_t>(cap, 0).swap(m_used);
+        m_size = 0;
+        for (uint32_t i = 0; i < oldKeys.size(); i++) {
+            if (oldUsed[i]) Insert(oldKeys[i], oldValues[i]);
+        }
+    }
+
+    uint32_t m_size;
+    std::vector<uint64_t> m_keys;
+    std::vector<V> m_values;
+    std::vector<uint8_t> m_used;
+};
+
+}  // namespace ns3
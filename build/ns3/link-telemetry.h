@@ -0,0 +1,105 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CAVER-LB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "ns3/ptr.h"
+
+namespace ns3 {
+
+class SwitchNode;
+class BEgressQueue;
+
+/**
+ * @brief In-simulator link telemetry (replaces the 10us text dumps of uplink/downlink).
+ * 每个采样周期读取一次端口 txBytes 与 BEgressQueue 队列长度：
+ * - 链路利用率按 downsample 个采样点聚合成一个时间序列点（1e-4 为单位存 uint16）
+ * - 队列长度落入 log2 字节直方图（bin 0 为空队列，bin k 为 [2^(k-1), 2^k) 字节）
+ * - 每个 ToR 的上行链路在每个时间序列点上计算 max/mean 与变异系数 CV
+ * 仿真结束时写出一个二进制文件，analysis/telemetry_reader.py 负责解析。
+ */
+class LinkTelemetry {
+   public:
+    enum : uint32_t { NO_TOR = 0xffffffff, QUEUE_BINS = 32 };
+
+    LinkTelemetry();
+
+    /* SET functions (before the first Sample) */
+    void SetStart(uint64_t startNs) { m_startNs = startNs; }
+    void SetInterval(uint64_t sampleNs, uint32_t downsample);
+
+    /**
+     * @brief monitor egress port `port` of `sw`.
+     * uplinkOfToR: ToR id if this port is an uplink of that ToR (imbalance metrics), else NO_TOR
+     */
+    void AddLink(Ptr<SwitchNode> sw, uint32_t port, uint32_t peerId, uint32_t uplinkOfToR);
+
+    /* called every sampleNs */
+    void Sample();
+    bool Write(const char* filename) const;
+
+    uint32_t GetNumLinks() const { return m_links.size(); }
+    uint32_t GetNumPoints() const { return m_nPoints; }
+
+   private:
+    struct Link {
+        Ptr<SwitchNode> sw;
+        Ptr<BEgressQueue> queue;
+        uint32_t nodeId;
+        uint32_t port;
+        uint32_t peerId;
+        uint32_t torId;
+        uint64_t bitRate;
+        uint64_t lastTxBytes;
+        uint32_t maxQueueBytes;
+        uint64_t queueHist[QUEUE_BINS];
+        std::vector<uint16_t> util;  // per series point, 1e-4
+    };
+    struct ToR {
+        uint32_t torId;
+        std::vector<uint32_t> uplinks;  // index into m_links
+        std::vector<float> maxMean;     // per series point
+        std::vector<float> cv;
+    };
+
+    static uint32_t QueueBin(uint32_t bytes);
+    void EmitPoint();
+
+    uint64_t m_startNs;
+    uint64_t m_sampleNs;
+    uint32_t m_downsample;
+    bool m_primed;        // first Sample() only records the txBytes baseline
+    uint32_t m_nSamples;  // samples in the current series point
+    uint32_t m_nPoints;
+    std::vector<Link> m_links;
+    std::vector<ToR> m_tors;
+    std::vector<double> m_pointUtil;  // scratch, per link
+};
+
+}  // namespace ns3
@@ -0,0 +1,138 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CAVER-LB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdint.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ns3/callback.h"
+#include "ns3/custom-header.h"
+#include "ns3/memory-accounting.h"
+#include "ns3/object.h"
+#include "ns3/packet.h"
+
+namespace ns3 {
+
+class Node;
+
+/**
+ * @brief Load-balancer plugin of a SwitchNode.
+ * 每个交换机只创建当前 lb_mode 对应的一个模块，SwitchNode 在转发路径上通过虚函数调用各个钩子，
+ * 不再逐包判断 lb_mode。基类本身就是 flow ECMP：所有钩子都是空操作。
+ * - Ingress:     入口接管（Conga/ConWeave/DV/CAVER/HULA/Noshare 自己决定路径并回调交换机发送）
+ * - SelectPort:  路由表给出多个下一跳时选出端口（DRILL/LetFlow），NO_PORT 表示用 flow ECMP
+ * - OnRouted:    按交换机路由表转发的包（模块未接管的包），用于更新本地 DRE
+ * - OnSend / OnDequeue: 出端口入队前 / 出队时
+ * - ReceiveControl: 模块自己的控制包（HULA probe）
+ * - OnFluidTx:   混合模式下流体（背景）流在出端口上发送的字节，计入模块的链路负载估计（DRE）
+ * - ReportMemory: 模块各张表的条目数和估算字节数（MemoryAccounting 的探针由交换机注册）
+ * 老化、探测等周期性工作仍由各模块自己在 Simulator 上调度。
+ * 模块按名字和 lb_mode 编号注册，配置里的 LB_MODE 两者都可以用。
+ */
+class LoadBalancer : public Object {
+   public:
+    enum : uint32_t { NO_PORT = 0xffffffff };
+
+    typedef Callback<void, Ptr<Packet>, CustomHeader&, uint32_t, uint32_t> SwitchSendCallback;
+    typedef Callback<void, Ptr<Packet>, CustomHeader&> SwitchSendToDevCallback;
+    typedef Ptr<LoadBalancer> (*Factory)(void);
+
+    static TypeId GetTypeId(void);
+    LoadBalancer();
+    virtual ~LoadBalancer();
+
+    void SetNode(Ptr<Node> node);
+    void SetSwitchSendCallback(SwitchSendCallback switchSendCallback);  // set callback
+    void SetSwitchSendToDevCallback(
+        SwitchSendToDevCallback switchSendToDevCallback);  // set callback
+
+    /* true if the module took the packet (it forwards it through the callbacks) */
+    virtual bool Ingress(Ptr<Packet> p, CustomHeader& ch) { return false; }
+    /* egress port for a data packet among nexthops, NO_PORT for flow ECMP */
+    virtual uint32_t SelectPort(Ptr<Packet> p, CustomHeader& ch, const std::vector<int>& nexthops) {
+        return NO_PORT;
+    }
+    /* the packet was routed by the switch's table to outDev */
+    virtual void OnRouted(Ptr<Packet> p, CustomHeader& ch, uint32_t outDev) {}
+    /* the packet is sent to egress port outDev (before admission control) */
+    virtual void OnSend(Ptr<Packet> p, uint32_t outDev) {}
+    /* the packet leaves the egress queue qIndex of port ifIndex */
+    virtual void OnDequeue(uint32_t ifIndex, uint32_t qIndex, Ptr<Packet> p) {}
+    /* hybrid fluid mode: background flows sent `bytes` on egress port outDev */
+    virtual void OnFluidTx(uint32_t outDev, uint64_t bytes) {}
+    /* entries and bytes of the module's tables (called by the switch's memory probe) */
+    virtual void ReportMemory(MemoryAccounting::Report& report) {}
+    /* true if the packet is a control packet of the module and was consumed */
+    virtual bool ReceiveControl(uint32_t ifIndex, Ptr<Packet> p, CustomHeader& ch) { return false; }
+
+    /* registry: the built-in schemes are registered on first use */
+    static void Register(const std::string& name, uint32_t mode, Factory factory);
+    static bool LookupMode(const std::string& name, uint32_t& mode);
+    static std::string GetName(uint32_t mode);
+    static std::string ListModes(void);  // "fecmp (0), drill (2), ..." for error messages
+    static Ptr<LoadBalancer> CreateByMode(uint32_t mode);  // NULL for an unknown mode
+
+    template <typename T>
+    static Ptr<LoadBalancer> Make(void) {
+        return CreateObject<T>();
+    }
+
+   protected:
+    Node* m_node;  // the switch owning this module (not a reference: the switch owns us)
+    SwitchSendCallback m_switchSendCallback;  // bound to SwitchNode::SwitchSend (for Request/UDP)
+    SwitchSendToDevCallback
+        m_switchSendToDevCallback;  // bound to SwitchNode::SendToDevContinue (for Probe, Reply)
+
+   private:
+    struct Entry {
+        std::string name;
+        Factory factory;
+    };
+    static std::map<uint32_t, Entry>& Registry();
+};
+
+/**
+ * @brief DRILL (lb_mode 2): per-packet, the least loaded of the previous best port and
+ * m_candidates random next hops (by egress queue bytes)
+ */
+class DrillLoadBalancer : public LoadBalancer {
+   public:
+    static TypeId GetTypeId(void);
+    DrillLoadBalancer();
+    virtual uint32_t SelectPort(Ptr<Packet> p, CustomHeader& ch, const std::vector<int>& nexthops);
+    virtual void ReportMemory(MemoryAccounting::Report& report);
+
+   private:
+    uint32_t CalculateInterfaceLoad(uint32_t interface);  // Get the load of a interface
+    uint32_t m_candidates;                                // always 2 (power of two)
+    std::map<uint32_t, uint32_t> m_previousBestInterfaceMap;  // <dip, previousBestInterface>
+};
+
+}  // namespace ns3
@@ -0,0 +1,86 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CAVER-LB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <unordered_map>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * @brief PFC pause-propagation tracer.
+ * 每个新的 PAUSE（接收端口的该优先级此前未被 PAUSE）记为树上的一个节点；
+ * 其父节点是发送该 PAUSE 的交换机此刻在同一优先级上仍处于 PAUSE 状态的、
+ * 最近一次被 PAUSE 的出端口所对应的 PAUSE 事件。没有父节点的是拥塞源头（根）。
+ * 同一端口的刷新 PAUSE 只计数，不产生新节点。
+ */
+class PfcTracer {
+   public:
+    enum : uint32_t { NONE = 0xffffffff };
+
+    struct Event {
+        uint32_t parent;  // NONE for a root
+        uint32_t depth;   // 0 for a root
+        uint64_t startNs;
+        uint64_t endNs;  // 0 while still paused at the end of the run
+        uint32_t node;   // node sending the PAUSE
+        uint32_t port;
+        uint32_t peer;  // node being paused
+        uint32_t peerPort;
+        uint32_t qIndex;
+        uint32_t refreshes;
+    };
+
+    static bool enabled;
+
+    /* sender side, for a PAUSE frame (time > 0) */
+    static void OnPauseSent(uint64_t nowNs, uint32_t node, uint32_t port, uint32_t peer,
+                            uint32_t peerPort, uint32_t qIndex);
+    /* receiver side, when (node, port, qIndex) is resumed (RESUME frame or expiry) */
+    static void OnResume(uint64_t nowNs, uint32_t node, uint32_t port, uint32_t qIndex);
+
+    /**
+     * @brief one line per pause event, followed by a per-tree summary:
+     * "EVENT id parent depth startNs endNs node port peer peerPort qIndex refreshes"
+     * "TREE rootId size maxDepth nNodes" (nNodes: distinct paused nodes in the tree)
+     */
+    static void Write(FILE* fout);
+    static const std::vector<Event>& GetEvents() { return m_events; }
+
+   private:
+    static uint64_t Key(uint32_t node, uint32_t port, uint32_t qIndex) {
+        return ((uint64_t)node << 32) | (port << 8) | qIndex;
+    }
+
+    static std::vector<Event> m_events;
+    static std::unordered_map<uint64_t, uint32_t> m_active;  // (node, port, q) -> paused by
+    static std::unordered_map<uint32_t, std::vector<uint32_t> > m_activeByNode;  // node -> events
+};
+
+}  // namespace ns3
@@ -0,0 +1,58 @@
+
+#ifdef NS3_MODULE_COMPILATION
+# error "Do not include ns3 module aggregator headers from other modules; these are meant only for end user scripts."
+#endif
+
+#ifndef NS3_MODULE_POINT_TO_POINT
+    
+
+// Module headers:
+#include "ack-feedback-sampler.h"
+#include "caver-routing.h"
+#include "cdf-flow-generator.h"
+#include "cn-header.h"
+#include "collective-engine.h"
+#include "conga-routing.h"
+#include "conweave-routing.h"
+#include "conweave-voq.h"
+#include "deadline-timer.h"
+#include "dv-routing.h"
+#include "fct-aggregator.h"
+#include "flow-stat-tag.h"
+#include "fluid-model.h"
+#include "hula-header.h"
+#include "hula-routing.h"
+#include "lb-flat-table.h"
+#include "letflow-routing.h"
+#include "link-telemetry.h"
+#include "load-balancer.h"
+#include "memory-accounting.h"
+#include "noshare-routing.h"
+#include "path-codec.h"
+#include "path-tracer.h"
+#include "pause-header.h"
+#include "pfc-state.h"
+#include "pfc-tracer.h"
+#include "point-to-point-channel.h"
+#include "point-to-point-helper.h"
+#include "point-to-point-net-device.h"
+#include "point-to-point-remote-channel.h"
+#include "ppp-header.h"
+#include "qbb-channel.h"
+#include "qbb-header.h"
+#include "qbb-helper.h"
+#include "qbb-net-device.h"
+#include "qbb-remote-channel.h"
+#include "rdma-driver.h"
+#include "rdma-hw.h"
+#include "rdma-queue-pair.h"
+#include "reorder-analytics.h"
+#include "route-tracer.h"
+#include "run-health.h"
+#include "selective-packet-queue.h"
+#include "settings.h"
+#include "sim-setting.h"
+#include "switch-mmu.h"
+#include "switch-node.h"
+#include "trace-format.h"
+#endif
@@ -0,0 +1,129 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation;
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#ifndef QBB_FLOW_PROBE_H
+#define QBB_FLOW_PROBE_H
+
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#include "ns3/flow-probe.h"
+#include "ns3/rdma-flow-classifier.h"
+#include "ns3/histogram.h"
+
+namespace ns3 {
+
+class FlowMonitor;
+class Node;
+class Packet;
+class QbbNetDevice;
+class RdmaQueuePair;
+
+/// \brief Class that monitors RDMA flows at the QbbNetDevices of a Node
+///
+/// One QbbFlowProbe is created per node.  On a NIC the probe reports the
+/// first transmission of a data packet (RdmaQpDequeue) and its reception
+/// (MacRx); on a switch it reports the forwarding of the packet at the
+/// dequeue of the egress port, and additionally records per flow the time
+/// the packet spent in the egress queue (sojourn time) and how much of it
+/// the queue was PAUSEd by PFC.
+///
+/// Only the packets accepted by the RdmaFlowClassifier (data packets of
+/// sampled flows) are tracked; the per-port in-flight table holds just
+/// those, so unsampled flows cost one tag lookup per hop.
+class QbbFlowProbe : public FlowProbe
+{
+
+public:
+  /// \param sojournBinWidth bin width (seconds) of the per-hop sojourn histograms
+  QbbFlowProbe (Ptr<FlowMonitor> monitor, Ptr<RdmaFlowClassifier> classifier, Ptr<Node> node,
+                double sojournBinWidth = 1e-6);
+  virtual ~QbbFlowProbe ();
+
+  /// \brief enumeration of possible reasons why a packet may be dropped
+  enum DropReason
+  {
+    /// Packet dropped because the link of the device is down (queue
+    /// flushed at link down, or received on a down link)
+    DROP_LINK_DOWN = 0,
+
+    DROP_INVALID_REASON,
+  };
+
+  /// per-flow statistics of the egress queues of this (switch) node
+  struct HopStats
+  {
+    HopStats (double binWidth)
+      : sojourn (binWidth), sojournSum (Seconds (0)), pfcBlockedSum (Seconds (0)), packets (0) {}
+
+    /// histogram of the egress queue sojourn time (seconds)
+    Histogram sojourn;
+    Time sojournSum;
+    /// part of sojournSum during which the queue of the packet was PAUSEd
+    Time pfcBlockedSum;
+    uint32_t packets;
+  };
+
+  typedef std::map<FlowId, HopStats> HopStatsContainer;
+
+  const HopStatsContainer& GetHopStats () const;
+
+  virtual void SerializeToXmlStream (std::ostream &os, int indent, uint32_t index) const;
+  virtual void SerializeStats (StatsImage &image) const;
+  virtual bool MergeStats (StatsImage &image);
+
+private:
+
+  struct InFlight
+  {
+    FlowId flowId;
+    Time enqueued;
+    Time pausedAtEnqueue;
+  };
+
+  struct PortRecord
+  {
+    QbbFlowProbe *probe;
+    Ptr<QbbNetDevice> dev;
+    bool remote;  ///< the link leads to another rank of a distributed simulation
+    std::unordered_map<uint64_t, InFlight> inFlight;  ///< packet uid -> enqueue record
+  };
+
+  static void EnqueueLogger (PortRecord *port, Ptr<const Packet> p, uint32_t qIndex);
+  static void DequeueLogger (PortRecord *port, Ptr<const Packet> p, uint32_t qIndex);
+  static void DropLogger (PortRecord *port, Ptr<const Packet> p, uint32_t qIndex);
+  static void QpDequeueLogger (PortRecord *port, Ptr<const Packet> p, Ptr<RdmaQueuePair> qp);
+  void MacRxLogger (Ptr<const Packet> p);
+
+  /// hands a packet leaving for another rank over to the monitor of that rank, in a tag
+  void HandOver (Ptr<const Packet> p, FlowId flowId);
+  /// takes over a packet handed over by another rank
+  void TakeOver (Ptr<const Packet> p, FlowId flowId);
+
+  Ptr<RdmaFlowClassifier> m_classifier;
+  uint32_t m_nodeId;
+  double m_binWidth;
+  bool m_remote;  ///< some link of the node leads to another rank
+  std::vector<PortRecord *> m_ports;
+  HopStatsContainer m_hopStats;
+
+};
+
+
+} // namespace ns3
+
+#endif /* QBB_FLOW_PROBE_H */
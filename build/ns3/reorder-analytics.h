@@ -0,0 +1,105 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CAVER-LB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * @brief Receiver-side reordering analytics (replaces the per-packet "超序" printf).
+ * 以 FlowIDNUMTag 的 id 为流索引，每个 RxQP 一条紧凑记录：
+ * - 乱序到达：seq 大于期望 seq 的数据包，重排距离 = seq - 期望 seq（字节）
+ * - 乱序区间（episode）：从第一个乱序到达开始，到期望 seq 追上区间内收到的最高字节为止；
+ *   区间内 (最高字节 - 期望 seq) 的最大值即支持乱序的接收端所需的重排缓存
+ * - 源 ToR 上该流出端口的变化次数（path switch），用于和乱序区间做相关分析
+ * 距离 / 缓存 / 区间时长各有一个全局 log2 直方图（bin 0 为 0，bin k 为 [2^(k-1), 2^k)）。
+ * 仿真结束时仍未闭合的区间（空洞一直没补上）在结束时刻闭合，计入时长和直方图。
+ * 仿真结束时写出一个二进制文件（analysis/reorder_reader.py 负责解析），
+ * 以及流级别分布的尾部（p50/p90/p99/p99.9/max）。未启用时每个包只多一次分支判断。
+ */
+class ReorderAnalytics {
+   public:
+    enum : uint32_t { BINS = 32, NO_PORT = 0xffffffff };
+
+    struct FlowRecord {
+        uint64_t packets;
+        uint64_t oooBytes;       // bytes of the out-of-order arrivals
+        uint64_t episodeNs;      // total time inside out-of-order episodes
+        uint32_t oooPackets;
+        uint32_t episodes;
+        uint32_t maxDistance;    // bytes
+        uint32_t maxBuffer;      // bytes
+        uint32_t pathSwitches;   // at the source ToR
+        // running state
+        uint32_t lastPort;       // egress port at the source ToR
+        uint32_t holeEnd;        // episode open while expected < holeEnd
+        uint32_t episodeBuffer;  // peak buffer of the open episode
+        uint64_t episodeStartNs;
+    };
+
+    static bool enabled;
+
+    /**
+     * @brief one data packet at the receiver; expectedBefore/After are the receiver's
+     * next expected seq before and after ReceiverCheckSeq
+     */
+    static void OnArrival(int32_t flow, uint32_t seq, uint32_t size, uint32_t expectedBefore,
+                          uint32_t expectedAfter, uint64_t nowNs);
+    /* one data packet leaving the source ToR of its flow through `port` */
+    static void OnSourceToR(int32_t flow, uint32_t port);
+    /* end of the simulation: episodes whose hole never filled end at `nowNs` */
+    static void CloseOpenEpisodes(uint64_t nowNs);
+
+    /**
+     * @brief binary summary:
+     *   char magic[4] = "RORD", u32 version = 1, u32 nBins, u32 nFlows
+     *   u64 distanceHist[nBins], u64 bufferHist[nBins], u64 episodeNsHist[nBins]
+     *   nFlows x { i32 flow, u64 packets, u64 oooBytes, u64 episodeNs, u32 oooPackets,
+     *              u32 episodes, u32 maxDistance, u32 maxBuffer, u32 pathSwitches }
+     * only flows that received at least one packet are written
+     */
+    static bool Write(const char* filename);
+    /* tails of the per-flow distributions and the switch/episode correlation, as text */
+    static void WriteTails(FILE* fout);
+
+    static uint32_t GetNumFlows();
+
+   private:
+    static uint32_t Bin(uint64_t v);
+    static FlowRecord& Get(int32_t flow);
+    static void CloseEpisode(FlowRecord& r, uint64_t nowNs);
+
+    static std::vector<FlowRecord> m_flows;
+    static uint64_t m_distanceHist[BINS];
+    static uint64_t m_bufferHist[BINS];
+    static uint64_t m_episodeNsHist[BINS];
+};
+
+}  // namespace ns3
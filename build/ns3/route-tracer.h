@@ -0,0 +1,117 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CAVER-LB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ns3/custom-header.h"
+#include "ns3/packet.h"
+#include "ns3/ptr.h"
+
+namespace ns3 {
+
+/**
+ * @brief RouteInput trace of one switch, for offline replay (utils/bench-lb-route.cc --trace).
+ * 记录一个交换机上每次进入负载均衡模块（Ingress -> RouteInput）的包：时间、包长、
+ * 包头的前 HEADER_BYTES 字节（回放时重新解析出 CustomHeader）以及所有 packet tag
+ * （CaverUdpTag/CaverAckTag/DVUdpTag/FlowIdTag 等，按 TypeId 名字序列化，回放时用
+ * TypeId 的构造函数还原）。文件头保存回放所需的交换机配置：LB 模式和常量、
+ * ECMP 哈希种子和 CAVER/Noshare 的随机种子（回放时还原，多次回放的选路哈希相同）、邻居 id -> 端口、端口带宽、到每个主机的下一跳端口（初始化各 LB 的按目的表）、
+ * 主机 IP <-> id、本 ToR 下的主机列表，以及全网的 (交换机, 端口) -> 邻居
+ * （CAVER 按路径还原节点序列时要用）。
+ * tag 里的 PathId 是进程内 PathCodec 表的下标，所以新登记的路径也随包流写入，
+ * 回放时按原顺序重新登记，得到相同的 id。
+ * 记录边跑边写（带缓冲），未启用时每个包只多一次比较。
+ */
+class RouteTracer {
+   public:
+    enum : uint32_t { VERSION = 2, HEADER_BYTES = 128, NONE = 0xffffffff };
+
+    /* switch configuration needed to rebuild its load balancer */
+    struct Config {
+        uint32_t lbMode;
+        uint32_t switchId;
+        bool isToR;
+        uint32_t ecmpSeed;  // SwitchNode::SetEcmpSeed
+        uint32_t lbSeed;    // CaverRouting/NoshareRouting::SetRandomSeed, 0 for the other modes
+        std::vector<double> params;  // SetConstants() arguments, times in ns
+        std::map<uint32_t, uint32_t> id2Port;
+        std::map<uint32_t, uint64_t> portRate;
+        std::map<uint32_t, std::vector<uint32_t> > routes;  // host IP -> out ports (nextHop)
+        std::map<uint32_t, uint32_t> hostIp2Id;
+        std::vector<uint32_t> torHosts;  // IPs of the hosts under this switch
+        std::map<uint32_t, std::map<uint32_t, uint32_t> > interfaces;  // Settings::m_nodeInterfaceMap
+    };
+    struct Record {
+        uint64_t timeNs;
+        uint32_t size;
+        std::vector<uint8_t> header;
+        std::vector<std::pair<uint16_t, std::vector<uint8_t> > > tags;  // (tag type, bytes)
+    };
+
+    /* tracing side */
+    static bool Open(const char* filename, const Config& config);
+    static bool IsTraced(uint32_t node) { return node == m_switchId; }
+    static void OnRouteInput(Ptr<const Packet> p, uint64_t nowNs);
+    static void Close();
+    static uint64_t GetNumRecords() { return m_nRecords; }
+
+    /* replay side; Load() also interns the recorded paths, into a PathCodec table still empty */
+    static bool Load(const char* filename, Config& config, std::vector<Record>& records,
+                     std::vector<std::string>& tagNames);
+    /* the packet of `r` with its tags, and its parsed header */
+    static Ptr<Packet> Rebuild(const Record& r, const std::vector<std::string>& tagNames,
+                               CustomHeader& ch);
+
+    /**
+     * file layout:
+     *   char magic[4] = "RTRC", u32 version, u32 lbMode, u32 switchId, u8 isToR,
+     *   u32 ecmpSeed, u32 lbSeed, u32 n, f64 params[n], u32 n, {u32 id, u32 port}[n], u32 n, {u32 port, u64 bps}[n],
+     *   u32 n, {u32 ip, u32 m, u32 port[m]}[n], u32 n, {u32 ip, u32 id}[n], u32 n, u32 torHostIp[n],
+     *   u32 n, {u32 node, u32 m, {u32 port, u32 peer}[m]}[n],
+     *   then a stream of
+     *   u8 0, u16 tagType, u8 len, char name[len]                  (new tag type)
+     *   u8 1, u64 timeNs, u32 size, u16 len, u8 header[len], u8 nTags,
+     *         {u16 tagType, u16 len, u8 bytes[len]}[nTags]           (one packet)
+     *   u8 2, u32 firstId, u32 n, {u16 len, u16 ports[len]}[n]      (new PathCodec paths)
+     */
+
+   private:
+    static uint32_t m_switchId;
+    static FILE* m_file;
+    static uint64_t m_nRecords;
+    static uint32_t m_nPaths;  // PathCodec paths already in the file
+    static std::unordered_map<std::string, uint16_t> m_tagTypes;
+    static std::vector<uint8_t> m_buf;  // scratch
+};
+
+}  // namespace ns3
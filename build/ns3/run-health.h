@@ -0,0 +1,126 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CAVER-LB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "ns3/ptr.h"
+
+namespace ns3 {
+
+class Node;
+class QbbNetDevice;
+class RdmaHw;
+class SwitchMmu;
+
+/**
+ * @brief Run-health monitor: progress status, PFC deadlock and stall detection, run budgets.
+ * 每个采样周期（仿真时间）统计活跃 QP、处于 PAUSE 的端口优先级、已完成流数和接收端按序
+ * 交付的字节数（goodput），并按墙钟至少每秒重写一次状态文件（仿真/墙钟时间比、每秒事件数等）。
+ * PFC 死锁：把"有数据排队、且被 PAUSE 的交换机出端口 (port, q)"作为顶点，连向对端交换机上
+ * 同一优先级同样被 PAUSE、且排着从这条链路进来的字节（SwitchMmu::GetInOutBytes）的出端口，
+ * 不连回来时的交换机；图中的环即循环 PAUSE 依赖。两台交换机互相 PAUSE 而各自排着的是别处
+ * 来的包时不成环。环上所有端口都已连续 PAUSE 超过 deadlockWindow 才认为是死锁。有活跃 QP 但在 stallWindow 内既没有 goodput 也没有流完成，
+ * 认为是停滞。墙钟预算、停滞或死锁时 Sample() 返回原因，由调用者写出诊断信息后中止。
+ */
+class RunHealth {
+   public:
+    enum Verdict { OK = 0, WALL_BUDGET, STALL, DEADLOCK };
+
+    RunHealth();
+
+    /* SET functions (before the first Sample) */
+    void SetStatusFile(const std::string& file) { m_statusFile = file; }
+    void SetStallWindow(uint64_t ns) { m_stallWindowNs = ns; }        // 0: disabled
+    void SetDeadlockWindow(uint64_t ns) { m_deadlockWindowNs = ns; }  // 0: report cycles, never abort
+    void SetWallBudget(double seconds) { m_wallBudget = seconds; }    // 0: disabled
+
+    void AddHost(Ptr<RdmaHw> hw);
+    /* egress port `port` of `node` (switch or host), linked to port `peerPort` of `peer` */
+    void AddPort(Ptr<Node> node, uint32_t port, Ptr<Node> peer, uint32_t peerPort);
+
+    /* called periodically; OK to go on, else the reason to abort */
+    Verdict Sample(uint64_t finishedFlows, uint64_t targetFlows);
+
+    /* rewrites the status file ("key value" lines), with the diagnostic dump if asked */
+    void WriteStatus(const char* state, bool withDump = false);
+    /* status, the PFC cycle (if any) and the longest-paused ports */
+    void WriteDump(FILE* fout) const;
+
+    static const char* GetVerdictName(Verdict v);
+
+   private:
+    struct Port {
+        Ptr<QbbNetDevice> dev;
+        Ptr<SwitchMmu> mmu;  // of the switch, NULL for a host
+        uint32_t node;
+        uint32_t port;
+        uint32_t peer;
+        uint32_t peerPort;
+        bool isSwitch;
+    };
+    typedef std::chrono::steady_clock Clock;
+
+    void WriteState(FILE* fout, const char* state) const;
+    /* (port index << 3 | q) of one cycle of PAUSEs older than minPausedNs, empty if none */
+    std::vector<uint32_t> FindPfcCycle(uint64_t minPausedNs) const;
+
+    std::string m_statusFile;
+    uint64_t m_stallWindowNs;
+    uint64_t m_deadlockWindowNs;
+    double m_wallBudget;
+
+    std::vector<Ptr<RdmaHw> > m_hosts;
+    std::vector<Port> m_ports;
+    std::vector<std::vector<uint32_t> > m_nodePorts;  // node id -> switch port indices
+
+    Clock::time_point m_wallStart;
+    bool m_started;
+    /* last sample */
+    uint64_t m_nowNs;
+    uint64_t m_activeQps;
+    uint32_t m_pausedPorts;
+    uint64_t m_finishedFlows;
+    uint64_t m_targetFlows;
+    uint64_t m_goodputBytes;
+    uint64_t m_lastProgressNs;
+    std::vector<uint32_t> m_cycle;
+    /* rates, over the last status period */
+    double m_wallLast;
+    uint64_t m_simNsLast;
+    uint64_t m_eventsLast;
+    uint64_t m_goodputLast;
+    double m_simWallRatio;
+    double m_eventsPerSec;
+    double m_goodputGbps;
+};
+
+}  // namespace ns3
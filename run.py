@@ -25,6 +25,7 @@ FLOW_FILE config/{flow}.txt
 FLOW_INPUT_FILE mix/output/{id}/{id}_in.txt
 CNP_OUTPUT_FILE mix/output/{id}/{id}_out_cnp.txt
 FCT_OUTPUT_FILE mix/output/{id}/{id}_out_fct.txt
+FCT_SUMMARY_FILE mix/output/{id}/{id}_out_fct_summary.txt
 PFC_OUTPUT_FILE mix/output/{id}/{id}_out_pfc.txt
 QLEN_MON_FILE mix/output/{id}/{id}_out_qlen.txt
 VOQ_MON_FILE mix/output/{id}/{id}_out_voq.txt
@@ -41,6 +42,10 @@ Global_CE_Map_FILE mix/output/{id}/{id}_global_ce_map.txt
 ALL_link_tx_FILE mix/output/{id}/{id}_out_all_link_tx.txt
 CONN_MON_FILE mix/output/{id}/{id}_out_conn.txt
 EST_ERROR_MON_FILE mix/output/{id}/{id}_out_est_error.txt
+LINK_TELEMETRY_FILE mix/output/{id}/{id}_out_link_telemetry.bin
+LINK_TELEMETRY_DOWNSAMPLE 10
+PATH_TRACE_FILE mix/output/{id}/{id}_out_path_trace.bin
+LINK_MON_RAW {link_mon_raw}
 
 PACKET_HEADER_FILE mix/output/{id}/{id}_out_pakcet_header.txt
 
@@ -109,6 +114,7 @@ KMIN_MAP {kmin_map}
 PMAX_MAP {pmax_map}
 LOAD {load}
 RANDOM_SEED {random_seed}
+ECMP_SEED {ecmp_seed}
 TIME {time}
 """
 
@@ -221,6 +227,44 @@ def main():
                         type=int, default=100, help="Caver Tau (default: 100us)")
     parser.add_argument('--caver_useEWMA', dest='caver_useEWMA', action='store',
                         type=int, default=0, help="Use EWMA (default: 1 for True, 0 for False)")
+    parser.add_argument('--link_mon_raw', dest='link_mon_raw', action='store',
+                        type=int, default=0, help="also dump raw per-interval uplink/downlink/conn text files (default: 0, binary telemetry only)")
+    parser.add_argument('--ecmp_seed', dest='ecmp_seed', action='store',
+                        type=int, default=0, help="fixed ECMP hash seed, also of the CAVER/Noshare choice among equally good paths, for reproducible runs (default: 0, random per run)")
+    parser.add_argument('--flow_gen_seed', dest='flow_gen_seed', action='store',
+                        type=int, default=-1, help="generate the flows inside the simulator with this seed, same flows as traffic_gen.py -s (default: -1, pre-generated flow file)")
+    parser.add_argument('--flow_gen_pattern', dest='flow_gen_pattern', action='store', choices=['poisson', 'incast', 'alltoall'],
+                        type=str, default='poisson', help="with --flow_gen_seed: traffic_gen.py (poisson), traffic_gen_incast.py (incast) or traffic_gen_mix.py (alltoall) (default: poisson)")
+    parser.add_argument('--flow_gen_mix', dest='flow_gen_mix', action='store',
+                        type=float, default=0.4, help="with --flow_gen_pattern incast/alltoall: the scripts' -m, ratio of the section traffic (default: 0.4)")
+    parser.add_argument('--flow_gen_podsize', dest='flow_gen_podsize', action='store',
+                        type=int, default=16, help="with --flow_gen_pattern incast/alltoall: the scripts' -p (default: 16)")
+    parser.add_argument('--ack_feedback', dest='ack_feedback', action='store', choices=['all', 'nth', 'budget'],
+                        type=str, default='all', help="CAVER/Noshare/DV: which ACKs carry path feedback, all, every --ack_feedback_param-th per destination, or at most one per --ack_feedback_param ns per destination (default: all)")
+    parser.add_argument('--ack_feedback_param', dest='ack_feedback_param', action='store',
+                        type=int, default=1, help="with --ack_feedback nth/budget: N, or the time budget in ns (default: 1)")
+    parser.add_argument('--collective', dest='collective', action='store',
+                        type=str, default='', help="collective job file (see config/collective_example.txt), run on top of the flows (default: '', none)")
+    parser.add_argument('--fluid_min_size', dest='fluid_min_size', action='store',
+                        type=int, default=0, help="hybrid mode: flows of at least this many bytes are simulated as fluid, their FCTs (base RTT included, also as a 9th column) in *_out_fluid_fct.txt, see analysis/fluid_validation.py (default: 0, all packet-level)")
+    parser.add_argument('--flow_level', dest='flow_level', action='store', choices=['', 'ecmp', 'least_flows'],
+                        type=str, default='', help="flow-level max-min estimation instead of packets, flows on the ECMP path or on the port of fewest flows (default: '', packet-level)")
+    parser.add_argument('--mem_mon_interval', dest='mem_mon_interval', action='store',
+                        type=int, default=0, help="sample the per-subsystem memory every this many us, see analysis/memory_reader.py (default: 0, disabled)")
+    parser.add_argument('--mem_budget_mb', dest='mem_budget_mb', action='store',
+                        type=int, default=0, help="abort with a per-subsystem memory report once the RSS exceeds this many MB (default: 0, no budget)")
+    parser.add_argument('--health_status', dest='health_status', action='store',
+                        type=int, default=0, help="rewrite mix/output/{id}/{id}_status.txt (progress, PFC PAUSEs, the dump of an abort) every wall-clock second (default: 0, disabled)")
+    parser.add_argument('--stall_window', dest='stall_window', action='store',
+                        type=int, default=0, help="abort when no flow makes progress for this many us, with a dump to stderr (and --health_status) (default: 0, disabled)")
+    parser.add_argument('--deadlock_window', dest='deadlock_window', action='store',
+                        type=int, default=0, help="abort on a cycle of PFC PAUSEs lasting this many us (default: 0, disabled)")
+    parser.add_argument('--wall_budget', dest='wall_budget', action='store',
+                        type=float, default=0, help="abort after this many seconds of wall-clock time (default: 0, no budget)")
+    parser.add_argument('--route_trace_switch', dest='route_trace_switch', action='store',
+                        type=int, default=-1, help="record the packets entering the load balancer of this switch (node id) for utils/bench-lb-route.cc --trace (default: -1, disabled)")
+    parser.add_argument('--mpi', dest='mpi', action='store',
+                        type=int, default=1, help="split the topology over this many MPI ranks, needs ./waf configure --enable-mpi (default: 1, sequential)")
 
     args = parser.parse_args()
 
@@ -264,6 +308,9 @@ def main():
     caver_pathChoice_num = args.caver_pathChoice_num
     caver_tau = args.caver_tau
     caver_useEWMA = args.caver_useEWMA
+    link_mon_raw = args.link_mon_raw
+    ecmp_seed = args.ecmp_seed
+    flow_gen_seed = args.flow_gen_seed
 
     # get over-subscription ratio from topoogy name
 
@@ -299,7 +346,10 @@ def main():
         flow = my_flow
 
     # check the file exists
-    if (exists(os.getcwd() + "/config/" + flow + ".txt")):
+    if flow_gen_seed >= 0:
+        print("Flows are generated by the simulator (cdf:{cdf}, seed:{seed}, pattern:{pattern})".format(
+            cdf=cdf, seed=flow_gen_seed, pattern=args.flow_gen_pattern))
+    elif (exists(os.getcwd() + "/config/" + flow + ".txt")):
         print("Input traffic file with load:{load:.2f}, cdf:{cdf}, n_host:{n_host} already exists".format(
             load=hostload, cdf=cdf, n_host=n_host))
     else:  # make the input traffic file
@@ -455,18 +505,59 @@ def main():
                                         caver_dreTime=caver_dreTime, caver_alpha=caver_alpha,
                                         caver_ce_threshold=caver_ce_threshold, caver_patchoiceTimeout=caver_patchoiceTimeout,
                                         caver_pathChoice_num=caver_pathChoice_num, caver_tau=caver_tau,
-                                        caver_useEWMA=caver_useEWMA)
+                                        caver_useEWMA=caver_useEWMA, link_mon_raw=link_mon_raw,
+                                        ecmp_seed=ecmp_seed)
     else:
         print("unknown cc:{}".format(args.cc))
 
+    if flow_gen_seed >= 0:
+        config += "FLOW_GEN_CDF traffic_gen/{cdf}.txt\nFLOW_GEN {n_host} {load} {bw}G {time} {seed}\n".format(
+            cdf=cdf, n_host=n_host, load=hostload / 100.0, bw=args.bw, time=args.simul_time, seed=flow_gen_seed)
+        if args.flow_gen_pattern != 'poisson':
+            # flow_num / flow_interval(_coefficient) of traffic_gen_incast.py / traffic_gen_mix.py
+            section_flows, flow_interval = (200, 0.01) if args.flow_gen_pattern == 'incast' else (300, 0.05)
+            config += "FLOW_GEN_PATTERN {pattern} {mix} {podsize} {flows} {interval}\n".format(
+                pattern=args.flow_gen_pattern, mix=args.flow_gen_mix, podsize=args.flow_gen_podsize,
+                flows=section_flows, interval=flow_interval)
+
+    if args.ack_feedback != 'all':
+        config += "ACK_FEEDBACK_SAMPLING {mode} {param}\n".format(mode=args.ack_feedback, param=args.ack_feedback_param)
+
+    if args.collective:
+        config += "COLLECTIVE_FILE {job}\nCOLLECTIVE_OUTPUT_FILE mix/output/{id}/{id}_out_collective.txt\n".format(
+            job=args.collective, id=config_ID)
+
+    if args.fluid_min_size > 0:
+        config += "FLUID_MIN_SIZE {size}\nFLUID_FCT_OUTPUT_FILE mix/output/{id}/{id}_out_fluid_fct.txt\n".format(
+            size=args.fluid_min_size, id=config_ID)
+
+    if args.flow_level:
+        config += "FLOW_LEVEL 1\nFLOW_LEVEL_PATH {path}\n".format(path=1 if args.flow_level == 'least_flows' else 0)
+
+    if args.health_status:
+        config += "HEALTH_STATUS_FILE mix/output/{id}/{id}_status.txt\n".format(id=config_ID)
+
+    if args.stall_window > 0 or args.deadlock_window > 0 or args.wall_budget > 0:
+        config += "HEALTH_STALL_WINDOW {stall}\nHEALTH_DEADLOCK_WINDOW {deadlock}\nHEALTH_WALL_BUDGET {wall}\n".format(
+            stall=args.stall_window * 1000, deadlock=args.deadlock_window * 1000, wall=args.wall_budget)
+
+    if args.mem_mon_interval > 0 or args.mem_budget_mb > 0:
+        config += "MEM_MON_FILE mix/output/{id}/{id}_out_mem.txt\nMEM_MON_INTERVAL {interval}\nMEM_BUDGET_MB {budget}\n".format(
+            id=config_ID, interval=(args.mem_mon_interval or 1000) * 1000, budget=args.mem_budget_mb)
+
+    if args.route_trace_switch >= 0:
+        config += "ROUTE_TRACE_FILE mix/output/{id}/{id}_out_route_trace.bin\nROUTE_TRACE_SWITCH {sw}\n".format(
+            id=config_ID, sw=args.route_trace_switch)
+
     with open(config_name, "w") as file:
         file.write(config)
 
     # run program
     print("Running simulation...")
     output_log = config_name.replace(".txt", ".log")
-    run_command = "./waf --run 'scratch/network-load-balance {config_name}' > {output_log} 2>&1".format(
-        config_name=config_name, output_log=output_log)
+    command_template = "--command-template='mpirun -np {} %s' ".format(args.mpi) if args.mpi > 1 else ""
+    run_command = "./waf --run 'scratch/network-load-balance {config_name}' {command_template}> {output_log} 2>&1".format(
+        config_name=config_name, command_template=command_template, output_log=output_log)
     with open("./mix/.history", "a") as history:
         history.write(run_command + "\n")
         history.write(
@@ -476,7 +567,7 @@ def main():
         history.write("\n")
 
     print(run_command)
-    os.system(f"./waf --run 'scratch/network-load-balance {config_name}' > {output_log} 2>&1")
+    os.system(run_command)
     #os.system(f"./waf --run 'scratch/network-load-balance' --command-template='gdb --args %s {config_name}'\n")
 
     ####################################################
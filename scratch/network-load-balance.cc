@@ -34,8 +34,18 @@
 
 #include "ns3/applications-module.h"
 #include "ns3/broadcom-node.h"
+#include "ns3/ack-feedback-sampler.h"
+#include "ns3/caver-routing.h"
+#include "ns3/cdf-flow-generator.h"
+#include "ns3/collective-engine.h"
+#include "ns3/fluid-model.h"
+#include "ns3/memory-accounting.h"
+#include "ns3/run-health.h"
 #include "ns3/conga-routing.h"
+#include "ns3/conweave-routing.h"
 #include "ns3/conweave-voq.h"
+#include "ns3/dv-routing.h"
+#include "ns3/fct-aggregator.h"
 #include "ns3/hula-routing.h"
 #include "ns3/core-module.h"
 #include "ns3/error-model.h"
@@ -43,17 +53,31 @@
 #include "ns3/internet-module.h"
 #include "ns3/ipv4-static-routing-helper.h"
 #include "ns3/letflow-routing.h"
+#include "ns3/link-telemetry.h"
+#include "ns3/load-balancer.h"
+#include "ns3/noshare-routing.h"
+#include "ns3/path-tracer.h"
+#include "ns3/route-tracer.h"
+#include "ns3/pfc-tracer.h"
 #include "ns3/packet.h"
+#include "ns3/path-codec.h"
 #include "ns3/point-to-point-helper.h"
 #include "ns3/qbb-helper.h"
 #include "ns3/qbb-net-device.h"
 #include "ns3/rdma-hw.h"
+#include "ns3/reorder-analytics.h"
 #include "ns3/settings.h"
 #include "ns3/core-module.h"
 #include "ns3/network-module.h"
 #include "ns3/internet-module.h"
 #include "ns3/applications-module.h"
 #include "ns3/flow-monitor-module.h"
+#include "ns3/mpi-interface.h"
+
+#ifdef NS3_MPI
+#include <mpi.h>
+#endif
+#include <random>
 
 using namespace ns3;
 using namespace std;
@@ -120,6 +144,7 @@ Time hula_probeTransmitInterval = MicroSeconds(hula_probeGenerationInterval.GetM
 Time hula_flowletInterval = MicroSeconds(100);       //flowlet的区分间隔 (e.g., 100us)
 //计算链路利用率使用，至少是探针的生成间隔的两倍,这里暂时设置为三倍
 Time hula_tau = MicroSeconds(hula_probeGenerationInterval.GetMicroSeconds() * 3);      
+bool hula_probeBatching = false;  //所有交换机的探针由同一个定时事件生成
 
 /*------------------------ simulation variables -----------------------------*/
 uint64_t one_hop_delay = 1000;  // nanoseconds
@@ -156,14 +181,54 @@ FILE *bps_tx_output = NULL;
 FILE *conn_output = NULL;
 FILE *global_CE_map_output =NULL;
 FILE *all_links_output = NULL;
-FILE *flow_distribution = NULL;
 FILE *packetId2FlowId = NULL;
 FILE *ideal_ce = NULL;
 
 std::string data_rate, link_delay, topology_file, flow_file;
 std::string flow_input_file = "flow.txt";
+std::string flow_gen_cdf = "";  // native flow generator (empty: read FLOW_FILE)
+uint32_t flow_gen_nhost = 0, flow_gen_seed = 0;
+double flow_gen_load = 0, flow_gen_bw = 0, flow_gen_time = 0;
+CdfFlowGenerator::Pattern flow_gen_pattern = CdfFlowGenerator::POISSON;
+double flow_gen_mix = 0, flow_gen_interval = 0;
+uint32_t flow_gen_podsize = 1, flow_gen_section_flows = 0;
+CdfFlowGenerator flow_gen;
 std::string fct_output_file = "fct.txt";
+std::string fct_summary_file = "";      // online FCT summary (empty: disabled)
+bool fct_raw_output = true;             // per-flow lines in fct_output_file
+uint64_t fct_summary_window = 0;        // ns, 0: whole run as one window
+double fct_summary_rel_err = 0.01;
+std::vector<uint64_t> fct_size_bins;    // empty: FctAggregator::DefaultSizeBins()
+FctAggregator fct_aggregator;
 std::string pfc_output_file = "pfc.txt";
+std::string pfc_trace_file = "";  // PAUSE propagation trees (empty: disabled)
+std::string reorder_file = "";  // reordering analytics summary (empty: disabled)
+std::string path_trace_file = "";  // per-flow path changes (empty: disabled)
+std::string route_trace_file = "";  // RouteInput trace of one switch (empty: disabled)
+uint32_t route_trace_switch = 0;    // node id of the traced switch
+std::string collective_file = "";         // collective jobs (empty: disabled)
+std::string collective_output_file = "";  // JCT / per-step summary of the collective jobs
+CollectiveEngine collective_engine;
+uint32_t collective_flow_cnt = 0;  // collective flows get the ids flow_num, flow_num + 1, ...
+uint32_t fluid_min_size = 0;  // hybrid mode: flows of at least this many bytes are fluid (0: disabled)
+std::string fluid_fct_output_file = "";  // FCT of the fluid flows: FCT_OUTPUT_FILE columns + base RTT
+uint32_t fluid_tick_ns = 1000;  // fluid bytes/backlog are pushed to the switches every tick
+uint32_t flow_level = 0;  // flow-level estimation: every flow is fluid (max-min rates), no packets
+uint32_t flow_level_path = 0;  // path of the flow-level flows: 0 flow ECMP, 1 fewest flows
+FluidModel fluid_model;
+FILE *fluid_fct_output = NULL;
+std::string mem_mon_file = "";        // per-subsystem memory samples (empty: disabled)
+uint64_t mem_mon_interval = 1000000;  // ns
+uint64_t mem_budget_mb = 0;           // abort with a memory report above this RSS (0: disabled)
+FILE *mem_mon_output = NULL;
+std::string health_status_file = "";  // run status, rewritten every wall second (empty: disabled)
+uint64_t health_interval = 100000;    // ns
+uint64_t health_stall_window = 0;     // ns, abort when no goodput for this long (0: disabled)
+uint64_t health_deadlock_window = 0;  // ns, abort on a PFC cycle paused this long (0: disabled)
+double health_wall_budget = 0;        // s, abort after this much wall-clock time (0: disabled)
+RunHealth run_health;
+std::string qbb_flow_mon_file = "";  // RDMA FlowMonitor XML (empty: disabled)
+uint32_t qbb_flow_mon_sampling = 1;  // monitor one flow out of N
 std::string cnp_output_file = "cnp.txt";
 std::string qlen_mon_file = "qlen.txt";
 std::string voq_mon_file = "voq.txt";
@@ -178,6 +243,10 @@ std::string conn_mon_file = "conn.txt";
 std::string est_error_output_file = "est_error.txt";
 std::string global_CE_map_mon_file = "global_ce_map.txt";
 std::string all_links_mon_file = "all_links.txt";
+std::string link_telemetry_file = "";     // binary link telemetry (empty: disabled)
+uint32_t link_telemetry_downsample = 10;  // series resolution = SW_MONITORING_INTERVAL * this
+bool link_mon_raw = true;                 // raw 10us uplink/downlink/conn text dumps
+LinkTelemetry link_telemetry;
 //TODO:my code to add a file to store the packet header
 std::string m_packetHeaderFile = "pakcet_header.txt";
 
@@ -212,6 +281,25 @@ uint32_t buffer_size = 0;  // 0 to set buffer size automatically
 double load = 10.0;
 int enable_irn = 0;
 int random_seed = 1;  // change this randomly if you want random expt
+uint32_t ecmp_seed = 0;  // 0: every switch draws its own ECMP hash and CAVER/Noshare seeds (differ between runs)
+
+// MPI (mpirun -np N): every rank builds the whole topology, simulates the nodes of its system id
+uint32_t mpi_rank = 0, mpi_size = 1;
+std::vector<std::string> rank_outputs;  // text outputs written per rank, concatenated by rank 0
+std::mt19937 flow_tor_rng;              // dst ToR of bonded hosts, drawn identically on all ranks
+
+bool IsLocalNode(Ptr<Node> node) { return node->GetSystemId() == mpi_rank; }
+
+/* the file of this rank ("<file>.rank<r>" when distributed) */
+std::string RankFile(const std::string &file) {
+    return mpi_size > 1 ? file + ".rank" + std::to_string(mpi_rank) : file;
+}
+
+/* text output with one record per line: per rank while running, merged by MergeRankOutputs() */
+FILE *OpenRankOutput(const std::string &file) {
+    if (mpi_size > 1) rank_outputs.push_back(file);
+    return fopen(RankFile(file).c_str(), "w");
+}
 
 uint64_t maxRtt, maxBdp;
 
@@ -266,7 +354,6 @@ uint32_t flow_num;
 //my log
 bool SrcDstToR_log = false;
 bool Path_id_log = false;
-bool Path_Table_log = false;
 std::map<uint32_t, std::map<uint32_t, std::vector<uint32_t>>> ConvertAndStore(const std::map<Ptr<Node>, std::map<Ptr<Node>, std::vector<Ptr<Node>>>>& nextHop){
     std::map<uint32_t, std::map<uint32_t, std::vector<uint32_t>>> m_nextHop;
     for (const auto& outerPair : nextHop) {
@@ -323,8 +410,18 @@ std::map<uint32_t, std::map<uint32_t, uint32_t>> CreateNbr2Interface(const std::
  */
 void ReadFlowInput() {
     if (flow_input.idx < flow_num) {
-        flowf >> flow_input.src >> flow_input.dst >> flow_input.pg >> flow_input.maxPacketCount >>
-            flow_input.start_time;
+        if (!flow_gen_cdf.empty()) {
+            CdfFlowGenerator::Flow flow;
+            flow_gen.Next(flow);
+            flow_input.src = flow.src;
+            flow_input.dst = flow.dst;
+            flow_input.pg = 3;
+            flow_input.maxPacketCount = flow.size;
+            flow_input.start_time = flow.startNs / 1e9;  // same double as the "%.9f" of the file
+        } else {
+            flowf >> flow_input.src >> flow_input.dst >> flow_input.pg >>
+                flow_input.maxPacketCount >> flow_input.start_time;
+        }
         assert(n.Get(flow_input.src)->GetNodeType() == 0 &&
                n.Get(flow_input.dst)->GetNodeType() == 0);
     } else {
@@ -335,6 +432,83 @@ void ReadFlowInput() {
     }
 }
 
+/**
+ * @brief Allocates the ports of a new flow and registers it in the Settings tables
+ * (LB source/destination ToR, flow id lookups, length).
+ */
+void RegisterFlow(uint32_t flowId, uint32_t src, uint32_t dst, uint32_t target_len,
+                  uint32_t &sport, uint32_t &dport) {
+    // src port
+    sport = portNumber[src];  // get a new port number
+    portNumber[src] = portNumber[src] + 1;
+
+    // dst port
+    dport = dportNumber[dst];
+    dportNumber[dst] = dportNumber[dst] + 1;
+
+    if (lb_mode == 9 || lb_mode == 12 || lb_mode == 3 || lb_mode == 6){
+        //std::cout << "Flow read" << std::endl;
+        auto it = SrcId2CurSrcToR.find(src);
+        if (it != SrcId2CurSrcToR.end()){
+            uint32_t SrcToR = Settings::hostId2ToRlist[src][it->second];
+            uint32_t DstToR;
+            SrcId2CurSrcToR[src] = (SrcToR + 1) % Settings::hostId2ToRlist[src].size();
+            //判断src是否能两跳到达dst
+            auto dst_it = std::find(Settings::TorSwitch_nodelist[SrcToR].begin(), Settings::TorSwitch_nodelist[SrcToR].end(), Settings::hostId2IpMap[dst]);
+            if (SrcDstToR_log){
+                std::cout << "TorSwitch_nodelist info:" << "flow id:" << flowId << std::endl;
+                for (size_t i = 0; i < Settings::TorSwitch_nodelist[SrcToR].size(); ++i) {
+                    std::cout << Settings::TorSwitch_nodelist[SrcToR][i] << " ";
+                }
+                std::cout << std::endl;
+            }
+            if (dst_it != Settings::TorSwitch_nodelist[SrcToR].end()){
+                //两跳到达
+                DstToR = SrcToR;
+                Settings::flowId2SrcDst[flowId] = std::make_pair(SrcToR, DstToR);
+                uint32_t outPort = nbr2if[n.Get(src)][n.Get(SrcToR)].idx;
+                Settings::flowId2Port2Src[flowId] = outPort;
+            }
+            else{
+                //随机选取一个ToR switch
+                // under MPI rand() is also drawn by the switches of this rank only, so its
+                // sequence differs between ranks; the ToR of a flow must be the same on all
+                int randomIndex = (mpi_size > 1 ? flow_tor_rng() : std::rand()) %
+                                  Settings::hostId2ToRlist[dst].size();
+                DstToR = Settings::hostId2ToRlist[dst][randomIndex];
+                Settings::flowId2SrcDst[flowId] = std::make_pair(SrcToR, DstToR);
+                uint32_t outPort = nbr2if[n.Get(src)][n.Get(SrcToR)].idx;
+                Settings::flowId2Port2Src[flowId] = outPort;
+            }
+            if (SrcDstToR_log){
+                std::cout << "SrcDstToR info: " << " Flow id: "<< flowId<<", Src: " << src << " Dst: " << dst << " SrcToR: " << SrcToR << " DstToR: " << DstToR << 
+                       " sport: " << sport << " dport: " << dport << std::endl;
+                std::cout << "OutPort list:" << std::endl;
+                auto& show_innerMap = nbr2if[n.Get(src)];
+                for (auto& show_innerPair : show_innerMap) {
+                    Ptr<Node> innerKey = show_innerPair.first; // 获取内部 map 的第一个键
+                    Interface value = show_innerPair.second; // 获取内部 map 的值
+
+                    // 输出内部 map 的键值对
+                    std::cout << "OuPort: " << value.idx << " -> " << "id: "  << innerKey->GetId() << std::endl;
+                }
+                std::cout << "OutPort: " << Settings::flowId2Port2Src[flowId] << std::endl;
+                fflush(stdout);
+            }
+        }
+        else{
+            assert(false && "SrcId2CurSrcToR does not contain the src server id");
+        }
+    }
+    fflush(stdout);
+
+    Settings::PacketId2FlowId[std::make_tuple(src, dst, sport, dport)] = flowId;
+    Settings::QPPair_info2FlowId[std::make_tuple(serverAddress[src], serverAddress[dst], static_cast<uint16_t>(sport), static_cast<uint16_t>(dport))] = flowId;
+    Settings::FlowId2SrcId[flowId] = src;
+    //std::cout << "Flow ID: " << flowId << std::endl;
+    Settings::FlowId2Length[flowId] = target_len;
+}
+
 /**
  * Scheduling flows given in /config/L_XX....txt file
  */
@@ -350,78 +524,11 @@ void ScheduleFlowInputs(FILE *infile) {
         pg = flow_input.pg;
         src = flow_input.src;
         dst = flow_input.dst;
-
-
-        // src port
-        sport = portNumber[src];  // get a new port number
-        portNumber[src] = portNumber[src] + 1;
-
-        // dst port
-        dport = dportNumber[dst];
-        dportNumber[dst] = dportNumber[dst] + 1;
-
-        if (lb_mode == 9 || lb_mode == 12 || lb_mode == 3 || lb_mode == 6){
-            //std::cout << "Flow read" << std::endl;
-            auto it = SrcId2CurSrcToR.find(src);
-            if (it != SrcId2CurSrcToR.end()){
-                uint32_t SrcToR = Settings::hostId2ToRlist[src][it->second];
-                uint32_t DstToR;
-                SrcId2CurSrcToR[src] = (SrcToR + 1) % Settings::hostId2ToRlist[src].size();
-                //判断src是否能两跳到达dst
-                auto dst_it = std::find(Settings::TorSwitch_nodelist[SrcToR].begin(), Settings::TorSwitch_nodelist[SrcToR].end(), Settings::hostId2IpMap[dst]);
-                if (SrcDstToR_log){
-                    std::cout << "TorSwitch_nodelist info:" << "flow id:" << flow_input.idx << std::endl;
-                    for (size_t i = 0; i < Settings::TorSwitch_nodelist[SrcToR].size(); ++i) {
-                        std::cout << Settings::TorSwitch_nodelist[SrcToR][i] << " ";
-                    }
-                    std::cout << std::endl;
-                }
-                if (dst_it != Settings::TorSwitch_nodelist[SrcToR].end()){
-                    //两跳到达
-                    DstToR = SrcToR;
-                    Settings::flowId2SrcDst[flow_input.idx] = std::make_pair(SrcToR, DstToR);
-                    uint32_t outPort = nbr2if[n.Get(src)][n.Get(SrcToR)].idx;
-                    Settings::flowId2Port2Src[flow_input.idx] = outPort;
-                }
-                else{
-                    //随机选取一个ToR switch
-                    int randomIndex = std::rand() % Settings::hostId2ToRlist[dst].size();
-                    DstToR = Settings::hostId2ToRlist[dst][randomIndex];
-                    Settings::flowId2SrcDst[flow_input.idx] = std::make_pair(SrcToR, DstToR);
-                    uint32_t outPort = nbr2if[n.Get(src)][n.Get(SrcToR)].idx;
-                    Settings::flowId2Port2Src[flow_input.idx] = outPort;
-                }
-                if (SrcDstToR_log){
-                    std::cout << "SrcDstToR info: " << " Flow id: "<< flow_input.idx<<", Src: " << src << " Dst: " << dst << " SrcToR: " << SrcToR << " DstToR: " << DstToR << 
-                           " sport: " << sport << " dport: " << dport << std::endl;
-                    std::cout << "OutPort list:" << std::endl;
-                    auto& show_innerMap = nbr2if[n.Get(src)];
-                    for (auto& show_innerPair : show_innerMap) {
-                        Ptr<Node> innerKey = show_innerPair.first; // 获取内部 map 的第一个键
-                        Interface value = show_innerPair.second; // 获取内部 map 的值
-
-                        // 输出内部 map 的键值对
-                        std::cout << "OuPort: " << value.idx << " -> " << "id: "  << innerKey->GetId() << std::endl;
-                    }
-                    std::cout << "OutPort: " << Settings::flowId2Port2Src[flow_input.idx] << std::endl;
-                    fflush(stdout);
-                }
-            }
-            else{
-                assert(false && "SrcId2CurSrcToR does not contain the src server id");
-            }
-        }
-        fflush(stdout);
-
-        Settings::PacketId2FlowId[std::make_tuple(src, dst, sport, dport)] = flow_input.idx;
-        Settings::QPPair_info2FlowId[std::make_tuple(serverAddress[src], serverAddress[dst], static_cast<uint16_t>(sport), static_cast<uint16_t>(dport))] = flow_input.idx;
-        Settings::FlowId2SrcId[flow_input.idx] = src;
-        //std::cout << "Flow ID: " << flow_input.idx << std::endl;
         target_len = flow_input.maxPacketCount;  // this is actually not packet-count, but bytes
         if (target_len == 0) {
             target_len = 1;
         }
-        Settings::FlowId2Length[flow_input.idx] = target_len;
+        RegisterFlow(flow_input.idx, src, dst, target_len, sport, dport);
         assert(n.Get(src)->GetNodeType() == 0 && n.Get(dst)->GetNodeType() == 0);
 
         /**
@@ -459,15 +566,25 @@ void ScheduleFlowInputs(FILE *infile) {
             assert(false);
         }
 
+        if (flow_level || (fluid_min_size > 0 && target_len >= fluid_min_size)) {  // fluid flow
+            fluid_model.AddFlow(flow_input.idx, n.Get(src), n.Get(dst), serverAddress[src].Get(),
+                                serverAddress[dst].Get(), sport, dport, pg, target_len);
+            flow_input.idx++;
+            ReadFlowInput();
+            continue;
+        }
+
         RdmaClientHelper clientHelper(
             pg, serverAddress[src], serverAddress[dst], sport, dport, target_len,
             has_win ? (global_t == 1 ? maxBdp : pairBdp[n.Get(src)][n.Get(dst)]) : 0,
             global_t == 1 ? maxRtt : pairRtt[n.Get(src)][n.Get(dst)]);
         clientHelper.SetAttribute("StatFlowID", IntegerValue(flow_input.idx));
 
-        ApplicationContainer appCon = clientHelper.Install(n.Get(src));  // SRC
-        appCon.Start(Seconds(Time(0)));
-        appCon.Stop(Seconds(100.0));
+        if (IsLocalNode(n.Get(src))) {  // every rank registers the flow, the source's rank runs it
+            ApplicationContainer appCon = clientHelper.Install(n.Get(src));  // SRC
+            appCon.Start(Seconds(Time(0)));
+            appCon.Stop(Seconds(100.0));
+        }
 
         flow_input.idx++;
         ReadFlowInput();
@@ -517,7 +634,7 @@ void periodic_monitoring(FILE *fout_voq, FILE *fout_voq_detail, FILE *fout_uplin
             Ptr<Node> node = n.Get(i);
             if (node->GetNodeType() == 1) {
                 Ptr<SwitchNode> snode = DynamicCast<SwitchNode>(node);
-                snode->m_mmu->m_hulaRouting.Print();
+                snode->GetLoadBalancer<HulaRouting>()->Print();
             }
         }
     }
@@ -528,13 +645,13 @@ void periodic_monitoring(FILE *fout_voq, FILE *fout_voq_detail, FILE *fout_uplin
 
         if (lb_mode_val == 9) {  // Conweave
             // monitor VOQ number per switch <time, ToRId, #VOQ, #Pkts>
-            uint32_t nVOQ = swNode->m_mmu->m_conweaveRouting.GetNumVOQ();
-            uint32_t nVolumeVOQ = swNode->m_mmu->m_conweaveRouting.GetVolumeVOQ();
+            uint32_t nVOQ = swNode->GetLoadBalancer<ConWeaveRouting>()->GetNumVOQ();
+            uint32_t nVolumeVOQ = swNode->GetLoadBalancer<ConWeaveRouting>()->GetVolumeVOQ();
             fprintf(fout_voq, "%lu,%u,%u,%u\n", now, tor2If.first, nVOQ, nVolumeVOQ);
 
             // monitor VOQ per destination IP <time, dstip, #VOQ, #Pkts>
             std::unordered_map<uint32_t, std::pair<uint32_t, uint32_t>> dip_to_nvoq_npkt;
-            for (auto voq : swNode->m_mmu->m_conweaveRouting.GetVOQMap()) {
+            for (auto voq : swNode->GetLoadBalancer<ConWeaveRouting>()->GetVOQMap()) {
                 auto &nvoq_npkt = dip_to_nvoq_npkt[voq.second.getDIP()];
                 nvoq_npkt.first += 1;
                 nvoq_npkt.second += voq.second.getQueueSize();
@@ -603,13 +720,13 @@ void m_periodic_monitoring(FILE *fout_voq,FILE *fout_uplink,  FILE *fout_downlin
 
         if (lb_mode_val == 9) {  // Conweave
             // monitor VOQ number per switch <time, ToRId, #VOQ, #Pkts>
-            uint32_t nVOQ = swNode->m_mmu->m_conweaveRouting.GetNumVOQ();
-            uint32_t nVolumeVOQ = swNode->m_mmu->m_conweaveRouting.GetVolumeVOQ();
+            uint32_t nVOQ = swNode->GetLoadBalancer<ConWeaveRouting>()->GetNumVOQ();
+            uint32_t nVolumeVOQ = swNode->GetLoadBalancer<ConWeaveRouting>()->GetVolumeVOQ();
             fprintf(fout_voq, "%lu,%u,%u,%u\n", now, tor2If.first, nVOQ, nVolumeVOQ);
 
             // monitor VOQ per destination IP <time, dstip, #VOQ, #Pkts>
             std::unordered_map<uint32_t, std::pair<uint32_t, uint32_t>> dip_to_nvoq_npkt;
-            for (auto voq : swNode->m_mmu->m_conweaveRouting.GetVOQMap()) {
+            for (auto voq : swNode->GetLoadBalancer<ConWeaveRouting>()->GetVOQMap()) {
                 auto &nvoq_npkt = dip_to_nvoq_npkt[voq.second.getDIP()];
                 nvoq_npkt.first += 1;
                 nvoq_npkt.second += voq.second.getQueueSize();
@@ -740,7 +857,7 @@ void m_all_links_monitoring(FILE *fout){
     uint64_t now = Simulator::Now().GetNanoSeconds();
     for (auto i = nextHop.begin(); i != nextHop.end(); i++) {
         Ptr<Node> node = i->first;
-        if (node->GetNodeType() == 1) {  // is switch
+        if (node->GetNodeType() == 1 && IsLocalNode(node)) {  // is switch
             Ptr<SwitchNode> swNode = DynamicCast<SwitchNode>(node);
             for (const auto &iface : Settings::m_nodeInterfaceMap[swNode->GetId()]) {
                 uint64_t txBytes = swNode->GetTxBytesOutDev(iface.first);
@@ -808,8 +925,72 @@ void m_rx_periodic_monitoring(FILE *fout_uplink_rx,  FILE *fout_downlink_rx, FIL
     return;
 }
 
-void flow_distribution_monitoring(Time start_time, FILE* fout_flow_distribution) {
-    Simulator::Schedule(start_time, &Settings::print_flow_distribution, fout_flow_distribution, MicroSeconds(50));
+/**
+ * @brief Memory accounting sampling; aborts with a per-subsystem report once the RSS exceeds
+ * MEM_BUDGET_MB, instead of being killed by the OOM killer later
+ */
+void memory_monitoring() {
+    MemoryAccounting::Report report;
+    MemoryAccounting::Collect(report);
+    uint64_t rss = MemoryAccounting::GetRss();
+    if (mem_mon_output != NULL) {
+        MemoryAccounting::WriteSample(mem_mon_output, Simulator::Now().GetTimeStep(), report, rss);
+    }
+    if (mem_budget_mb > 0 && rss > (mem_budget_mb << 20)) {
+        std::cerr << "\n*** Memory budget exceeded: RSS " << (rss >> 20) << " MB > MEM_BUDGET_MB "
+                  << mem_budget_mb << ", Time:" << Simulator::Now() << std::endl;
+        MemoryAccounting::WriteReport(stderr, report, rss);
+        if (mem_mon_output != NULL) {
+            MemoryAccounting::WriteReport(mem_mon_output, report, rss);
+            fclose(mem_mon_output);
+        }
+        fflush(NULL);
+#ifdef NS3_MPI
+        if (mpi_size > 1) MPI_Abort(MPI_COMM_WORLD, 1);
+#endif
+        std::_Exit(1);  // no static destructors under a live simulator
+    }
+    if (Simulator::Now() < Seconds(flowgen_stop_time + 0.05)) {
+        // recursive callback
+        Simulator::Schedule(NanoSeconds(mem_mon_interval), &memory_monitoring);
+    }
+}
+
+/**
+ * @brief Run-health sampling; aborts with a diagnostic dump on a PFC deadlock, a stall or the
+ * wall-clock budget
+ */
+void health_monitoring() {
+    RunHealth::Verdict verdict =
+        run_health.Sample(Settings::cnt_finished_flows, flow_num + collective_engine.GetTotalFlows());
+    if (verdict != RunHealth::OK) {
+        std::cerr << "\n*** Run aborted: " << RunHealth::GetVerdictName(verdict)
+                  << ", Time:" << Simulator::Now() << std::endl;
+        if (!health_status_file.empty()) {
+            run_health.WriteStatus(RunHealth::GetVerdictName(verdict), true);
+        }
+        run_health.WriteDump(stderr);
+        fflush(NULL);
+#ifdef NS3_MPI
+        if (mpi_size > 1) MPI_Abort(MPI_COMM_WORLD, 2);
+#endif
+        std::_Exit(2);
+    }
+    if (Simulator::Now() < Seconds(flowgen_stop_time + 0.05)) {
+        // recursive callback
+        Simulator::Schedule(NanoSeconds(health_interval), &health_monitoring);
+    }
+}
+
+/**
+ * @brief Link telemetry sampling (utilization series, queue histograms, ToR uplink imbalance)
+ */
+void link_telemetry_monitoring() {
+    link_telemetry.Sample();
+    if (Simulator::Now() < Seconds(flowgen_stop_time + 0.05)) {
+        // recursive callback
+        Simulator::Schedule(NanoSeconds(switch_mon_interval), &link_telemetry_monitoring);
+    }
 }
 
 
@@ -865,7 +1046,7 @@ void conweave_history_print() {
         if (node->GetNodeType() == 1) {  // switches
             auto swNode = DynamicCast<SwitchNode>(n.Get(ToRId));
             if (swNode->m_isToR) {  // TOR switch
-                uint32_t num_remained_voq = swNode->m_mmu->m_conweaveRouting.GetNumVOQ();
+                uint32_t num_remained_voq = swNode->GetLoadBalancer<ConWeaveRouting>()->GetNumVOQ();
                 if (num_remained_voq > 0) {
                     printf("*******************************\n");
                     printf("*** WARNING - Tor Sw (%lu) - VOQ (num=%u) is not flushed yet!! ***\n",
@@ -886,7 +1067,7 @@ void conweave_history_print() {
 
         std::cout << "\n--------------------------" << std::endl;
         std::cout << "Extracting ConWeave Estimation Error Data..." << std::endl;
-        est_error_output = fopen(est_error_output_file.c_str(), "w");
+        est_error_output = OpenRankOutput(est_error_output_file);
         for (auto x : ConWeaveVOQ::m_flushEstErrorhistory) {
             fprintf(est_error_output, "%d\n", x);
         }
@@ -914,6 +1095,60 @@ void dv_history_print() {
     }
 }
 
+/**
+ * @brief A fluid flow completed: same line as qp_finish, to its own file in the hybrid mode and
+ * to the FCT outputs of qp_finish in the flow-level mode.
+ * The fluid model only has the transfer time, its fct is base RTT + transfer time (with the
+ * headers) like standalone_fct. The hybrid file has one more column, the base RTT added, so that
+ * the transfer time stays available: "src dst sport dport size start fct standalone base_rtt".
+ */
+void fluid_finish(const FluidModel::Finished &f) {
+    uint64_t base_rtt = pairRtt[n.Get(f.src)][n.Get(f.dst)];
+    uint64_t b = pairBw[n.Get(f.src)][n.Get(f.dst)];
+    uint64_t total_bytes = f.bytes + ((f.bytes - 1) / packet_payload_size + 1) *
+                                         (CustomHeader::GetStaticWholeHeaderSize() -
+                                          IntHeader::GetStaticSize());
+    uint64_t standalone_fct = base_rtt + total_bytes * 8000000000lu / b;
+    // the fluid only carries the payload: add the headers and the base RTT, as in standalone_fct
+    uint64_t fct = base_rtt + (uint64_t)((double)f.fctNs * total_bytes / f.bytes);
+    if (flow_level) {
+        if (fct_raw_output) {
+            fprintf(fct_output, "%u %u %u %u %lu %lu %lu %lu\n", f.src, f.dst, f.sport, f.dport,
+                    f.bytes, f.startNs, fct, standalone_fct);
+        }
+        if (!fct_summary_file.empty()) {
+            fct_aggregator.Record(f.bytes, f.startNs, fct, standalone_fct);
+        }
+    } else if (fluid_fct_output != NULL) {
+        fprintf(fluid_fct_output, "%u %u %u %u %lu %lu %lu %lu %lu\n", f.src, f.dst, f.sport,
+                f.dport, f.bytes, f.startNs, fct, standalone_fct, base_rtt);
+    }
+    Settings::cnt_finished_flows++;
+    if (flow_level) collective_engine.OnFlowComplete(f.src, f.sport, f.dport);
+}
+
+/**
+ * @brief Starts one flow of a collective job. The QP is added to the RDMA driver directly,
+ * without an Application, so that large jobs do not create one object per flow/rank.
+ */
+uint32_t LaunchCollectiveFlow(uint32_t src, uint32_t dst, uint32_t pg, uint64_t size) {
+    uint32_t flowId = flow_num + collective_flow_cnt++;
+    uint32_t sport, dport;
+    assert(n.Get(src)->GetNodeType() == 0 && n.Get(dst)->GetNodeType() == 0);
+    RegisterFlow(flowId, src, dst, size, sport, dport);
+    if (flow_level) {
+        fluid_model.AddFlow(flowId, n.Get(src), n.Get(dst), serverAddress[src].Get(),
+                            serverAddress[dst].Get(), sport, dport, pg, size);
+        return (sport << 16) | dport;
+    }
+
+    Ptr<RdmaDriver> rdma = n.Get(src)->GetObject<RdmaDriver>();
+    rdma->AddQueuePair(size, pg, serverAddress[src], serverAddress[dst], sport, dport,
+                       has_win ? (global_t == 1 ? maxBdp : pairBdp[n.Get(src)][n.Get(dst)]) : 0,
+                       global_t == 1 ? maxRtt : pairRtt[n.Get(src)][n.Get(dst)], flowId);
+    return (sport << 16) | dport;
+}
+
 /**
  * @brief When one RDMA is finished, so does (1) QP, (2) RxQP, (3) write it on file fct.txt.
  */
@@ -928,16 +1163,24 @@ void qp_finish(FILE *fout, Ptr<RdmaQueuePair> q) {
                                                        // (with header but no INT)
     uint64_t standalone_fct = base_rtt + total_bytes * 8000000000lu / b;
 
-    // XXX: remove rxQP from the receiver 
+    // XXX: remove rxQP from the receiver (under MPI only when it is simulated by this rank)
     Ptr<Node> dstNode = n.Get(did);
-    Ptr<RdmaDriver> rdma = dstNode->GetObject<RdmaDriver>();
-    rdma->m_rdma->DeleteRxQp(q->sip.Get(), q->sport, q->dport, q->m_pg);
+    if (IsLocalNode(dstNode)) {
+        Ptr<RdmaDriver> rdma = dstNode->GetObject<RdmaDriver>();
+        rdma->m_rdma->DeleteRxQp(q->sip.Get(), q->sport, q->dport, q->m_pg);
+    }
 
     // fprintf(fout, "%lu QP complete\n", Simulator::Now().GetTimeStep());
-    fprintf(fout, "%u %u %u %u %lu %lu %lu %lu\n", Settings::ip_to_node_id(q->sip),
-            Settings::ip_to_node_id(q->dip), q->sport, q->dport, q->m_size,
-            q->startTime.GetTimeStep(), (Simulator::Now() - q->startTime).GetTimeStep(),
-            standalone_fct);
+    if (fct_raw_output) {
+        fprintf(fout, "%u %u %u %u %lu %lu %lu %lu\n", Settings::ip_to_node_id(q->sip),
+                Settings::ip_to_node_id(q->dip), q->sport, q->dport, q->m_size,
+                q->startTime.GetTimeStep(), (Simulator::Now() - q->startTime).GetTimeStep(),
+                standalone_fct);
+    }
+    if (!fct_summary_file.empty()) {
+        fct_aggregator.Record(q->m_size, q->startTime.GetTimeStep(),
+                              (Simulator::Now() - q->startTime).GetTimeStep(), standalone_fct);
+    }
 
     // for debugging
     NS_LOG_DEBUG("%u %u %u %u %lu %lu %lu %lu\n" %
@@ -945,7 +1188,10 @@ void qp_finish(FILE *fout, Ptr<RdmaQueuePair> q) {
                   q->dport, q->m_size, q->startTime.GetTimeStep(),
                   (Simulator::Now() - q->startTime).GetTimeStep(), standalone_fct));
     Settings::cnt_finished_flows++;
-    fflush(fout);
+    if (fct_raw_output) {
+        fflush(fout);
+    }
+    collective_engine.OnFlowComplete(sid, q->sport, q->dport);  // may launch dependent flows
 
     //clean
     static std::queue<std::tuple<Ipv4Address, Ipv4Address, uint16_t, uint16_t>> finishedQpBuffer; //这个buffer存放将要被清理的flow。但是我们不能立即清理，因为在乱序状态下依旧可能有部分包残存在拓扑中
@@ -1008,7 +1254,7 @@ void monitor_buffer(FILE *qlen_output, NodeContainer *n) {
             for (uint32_t j = 1; j < sw->GetNDevices(); j++) {
                 uint32_t size = 0;
                 for (uint32_t k = 0; k < SwitchMmu::qCnt; k++)
-                    size += sw->m_mmu->egress_bytes[j][k];
+                    size += sw->m_mmu->GetusedEgressQSharedBytes(j, k);
                 queue_result[i][j].add(size);
             }
         }
@@ -1036,10 +1282,18 @@ void monitor_buffer(FILE *qlen_output, NodeContainer *n) {
  * This function allows to finish simulation quickly when all messages are sent.
  */
 void stop_simulation_middle() {
-    uint32_t target_flow_num = flow_num - 0;  // can be lower than flownum
-    if (Settings::cnt_finished_flows >= target_flow_num) {
+    uint32_t target_flow_num = flow_num + collective_engine.GetTotalFlows();  // can be lower than flownum
+    uint64_t finished = Settings::cnt_finished_flows;
+#ifdef NS3_MPI
+    if (mpi_size > 1) {
+        // all ranks run this check at the same time, within the same LBTS window: no deadlock
+        uint64_t local = finished;
+        MPI_Allreduce(&local, &finished, 1, MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD);
+    }
+#endif
+    if (finished >= target_flow_num) {
         std::cout << "\n*** Simulator is enforced to be finished, finished so far: "
-                  << Settings::cnt_finished_flows << "/ total: " << target_flow_num
+                  << finished << "/ total: " << target_flow_num
                   << ", Time:" << Simulator::Now() << std::endl;
 
         // schedule conga timeout monitor
@@ -1383,6 +1637,129 @@ uint64_t get_nic_rate(NodeContainer &n) {
     return avg_nic_rate / n_servers;
 }
 
+/**
+ * @brief MPI partition (node id -> rank). The nodes below the top switch layer are split into
+ * their connected components (pods of a fat-tree, racks of a leaf-spine) and consecutive
+ * components go to the same rank; the top layer (cores / spines) is spread round-robin.
+ * Hosts stay with their ToR, so only switch-switch links cross ranks.
+ */
+std::vector<uint32_t> PartitionNodes(const std::vector<uint32_t> &node_type,
+                                     const std::vector<std::pair<uint32_t, uint32_t>> &links,
+                                     uint32_t nRanks) {
+    uint32_t nNodes = node_type.size();
+    std::vector<uint32_t> rank(nNodes, 0);
+    if (nRanks <= 1) return rank;
+
+    // layer = hops from the nearest host
+    std::vector<std::vector<uint32_t>> adj(nNodes);
+    for (auto &l : links) {
+        adj[l.first].push_back(l.second);
+        adj[l.second].push_back(l.first);
+    }
+    std::vector<uint32_t> layer(nNodes, UINT32_MAX);
+    std::queue<uint32_t> q;
+    for (uint32_t i = 0; i < nNodes; i++) {
+        if (node_type[i] == 0) {
+            layer[i] = 0;
+            q.push(i);
+        }
+    }
+    uint32_t top = 0;
+    while (!q.empty()) {
+        uint32_t u = q.front();
+        q.pop();
+        top = std::max(top, layer[u]);
+        for (uint32_t v : adj[u]) {
+            if (layer[v] != UINT32_MAX) continue;
+            layer[v] = layer[u] + 1;
+            q.push(v);
+        }
+    }
+
+    // components below the top layer, numbered by their smallest node id
+    std::vector<uint32_t> comp(nNodes, UINT32_MAX);
+    uint32_t nComp = 0;
+    for (uint32_t i = 0; i < nNodes; i++) {
+        if (comp[i] != UINT32_MAX || layer[i] >= top) continue;
+        comp[i] = nComp;
+        q.push(i);
+        while (!q.empty()) {
+            uint32_t u = q.front();
+            q.pop();
+            for (uint32_t v : adj[u]) {
+                if (comp[v] != UINT32_MAX || layer[v] >= top) continue;
+                comp[v] = nComp;
+                q.push(v);
+            }
+        }
+        nComp++;
+    }
+    uint32_t nTop = 0;
+    for (uint32_t i = 0; i < nNodes; i++) {
+        rank[i] = comp[i] != UINT32_MAX ? (uint64_t)comp[i] * nRanks / nComp : nTop++ % nRanks;
+    }
+    std::cout << "MPI partition: " << nComp << " pods, " << nTop << " top-layer switches over "
+              << nRanks << " ranks" << std::endl;
+    return rank;
+}
+
+/**
+ * @brief Concatenates the per-rank text outputs (rank order) into the configured files.
+ */
+void MergeRankOutputs() {
+#ifdef NS3_MPI
+    if (mpi_size <= 1) return;
+    fflush(NULL);
+    MPI_Barrier(MPI_COMM_WORLD);  // all ranks are done writing
+    if (mpi_rank != 0) return;
+    std::vector<char> buf(1 << 16);
+    for (const std::string &file : rank_outputs) {
+        FILE *out = fopen(file.c_str(), "w");
+        for (uint32_t r = 0; r < mpi_size && out != NULL; r++) {
+            std::string part = file + ".rank" + std::to_string(r);
+            FILE *in = fopen(part.c_str(), "r");
+            if (in == NULL) continue;
+            size_t len;
+            while ((len = fread(buf.data(), 1, buf.size(), in)) > 0) fwrite(buf.data(), 1, len, out);
+            fclose(in);
+            remove(part.c_str());
+        }
+        if (out != NULL) fclose(out);
+    }
+    std::cout << "MPI: merged " << rank_outputs.size() << " per-rank outputs of " << mpi_size
+              << " ranks" << std::endl;
+#endif
+}
+
+/**
+ * @brief Gathers the byte image of every rank on rank 0, in rank order; the other ranks get none.
+ */
+std::vector<std::vector<uint8_t> > GatherOnRank0(const std::vector<uint8_t> &image) {
+    std::vector<std::vector<uint8_t> > images;
+#ifdef NS3_MPI
+    if (mpi_size > 1) {
+        int len = image.size();
+        std::vector<int> lens(mpi_size), offsets(mpi_size, 0);
+        MPI_Gather(&len, 1, MPI_INT, lens.data(), 1, MPI_INT, 0, MPI_COMM_WORLD);
+        std::vector<uint8_t> all(1);
+        if (mpi_rank == 0) {
+            for (uint32_t r = 1; r < mpi_size; r++) offsets[r] = offsets[r - 1] + lens[r - 1];
+            all.resize(offsets[mpi_size - 1] + lens[mpi_size - 1] + 1);
+        }
+        MPI_Gatherv(image.data(), len, MPI_BYTE, all.data(), lens.data(), offsets.data(), MPI_BYTE,
+                    0, MPI_COMM_WORLD);
+        if (mpi_rank == 0) {
+            for (uint32_t r = 0; r < mpi_size; r++) {
+                images.emplace_back(all.begin() + offsets[r], all.begin() + offsets[r] + lens[r]);
+            }
+        }
+        return images;
+    }
+#endif
+    images.push_back(image);
+    return images;
+}
+
 /************************************************************************/
 //                                                                      //
 //                                M A I N                               //
@@ -1394,6 +1771,15 @@ int main(int argc, char *argv[]) {
     clock_t begint, endt;
     begint = clock();
 
+#ifdef NS3_MPI
+    MpiInterface::Enable(&argc, &argv);
+    mpi_rank = MpiInterface::GetSystemId();
+    mpi_size = MpiInterface::GetSize();
+    if (mpi_size > 1) {
+        GlobalValue::Bind("SimulatorImplementationType", StringValue("ns3::DistributedSimulatorImpl"));
+    }
+#endif
+
 //参数配置
 #ifndef PGO_TRAINING
     if (argc > 1)
@@ -1427,10 +1813,18 @@ int main(int argc, char *argv[]) {
                 est_error_output_file = v;
                 std::cerr << "EST_ERROR_MON_FILE\t\t\t" << est_error_output_file << "\n";
             } else if (key.compare("LB_MODE") == 0) {
-                uint32_t v;
+                std::string v;  // name (e.g., caver) or number of the scheme
                 conf >> v;
-                lb_mode = v;
-                std::cerr << "LB_MODE\t\t\t" << lb_mode << "\n";
+                if (!LoadBalancer::LookupMode(v, lb_mode)) {
+                    bool isNumber = !v.empty() && v.size() <= 9 && v.find_first_not_of("0123456789") == std::string::npos;
+                    if (isNumber) lb_mode = std::stoul(v);
+                    if (!isNumber || LoadBalancer::GetName(lb_mode).empty()) {
+                        std::cerr << "Unknown LB_MODE " << v << ", registered: " << LoadBalancer::ListModes()
+                                  << std::endl;
+                        exit(1);
+                    }
+                }
+                std::cerr << "LB_MODE\t\t\t" << lb_mode << " (" << LoadBalancer::GetName(lb_mode) << ")\n";
             } else if (key.compare("SW_MONITORING_INTERVAL") == 0) {
                 uint32_t v;
                 conf >> v;
@@ -1599,6 +1993,35 @@ int main(int argc, char *argv[]) {
                 conf >> v;
                 flow_file = v;
                 std::cerr << "FLOW_FILE\t\t\t" << flow_file << "\n";
+            } else if (key.compare("FLOW_GEN_CDF") == 0) {
+                conf >> flow_gen_cdf;
+                std::cerr << "FLOW_GEN_CDF\t\t\t" << flow_gen_cdf << "\n";
+            } else if (key.compare("FLOW_GEN") == 0) {
+                std::string bw;
+                conf >> flow_gen_nhost >> flow_gen_load >> bw >> flow_gen_time >> flow_gen_seed;
+                // traffic_gen.py::translate_bandwidth
+                double scale = 1;
+                if (!bw.empty() && bw.back() == 'G') scale = 1e9;
+                if (!bw.empty() && bw.back() == 'M') scale = 1e6;
+                if (!bw.empty() && bw.back() == 'K') scale = 1e3;
+                if (scale != 1) bw.pop_back();
+                flow_gen_bw = std::stod(bw) * scale;
+                std::cerr << "FLOW_GEN\t\t\t" << flow_gen_nhost << " " << flow_gen_load << " "
+                          << flow_gen_bw << " " << flow_gen_time << " " << flow_gen_seed << "\n";
+            } else if (key.compare("FLOW_GEN_PATTERN") == 0) {
+                std::string v;
+                conf >> v >> flow_gen_mix >> flow_gen_podsize >> flow_gen_section_flows >>
+                    flow_gen_interval;
+                if (v == "incast") {
+                    flow_gen_pattern = CdfFlowGenerator::INCAST;
+                } else if (v == "alltoall") {
+                    flow_gen_pattern = CdfFlowGenerator::ALLTOALL;
+                } else {
+                    flow_gen_pattern = CdfFlowGenerator::POISSON;
+                }
+                std::cerr << "FLOW_GEN_PATTERN\t\t\t" << v << " " << flow_gen_mix << " "
+                          << flow_gen_podsize << " " << flow_gen_section_flows << " "
+                          << flow_gen_interval << "\n";
             } else if (key.compare("FLOWGEN_START_TIME") == 0) {
                 double v;
                 conf >> v;
@@ -1662,6 +2085,30 @@ int main(int argc, char *argv[]) {
             } else if (key.compare("FCT_OUTPUT_FILE") == 0) {
                 conf >> fct_output_file;
                 std::cerr << "FCT_OUTPUT_FILE\t\t" << fct_output_file << '\n';
+            } else if (key.compare("FCT_RAW_OUTPUT") == 0) {
+                conf >> fct_raw_output;
+                std::cerr << "FCT_RAW_OUTPUT\t\t" << fct_raw_output << '\n';
+            } else if (key.compare("FCT_SUMMARY_FILE") == 0) {
+                conf >> fct_summary_file;
+                std::cerr << "FCT_SUMMARY_FILE\t\t" << fct_summary_file << '\n';
+            } else if (key.compare("FCT_SUMMARY_WINDOW") == 0) {
+                conf >> fct_summary_window;
+                std::cerr << "FCT_SUMMARY_WINDOW\t\t" << fct_summary_window << '\n';
+            } else if (key.compare("FCT_SUMMARY_REL_ERR") == 0) {
+                conf >> fct_summary_rel_err;
+                std::cerr << "FCT_SUMMARY_REL_ERR\t\t" << fct_summary_rel_err << '\n';
+            } else if (key.compare("FCT_SIZE_BINS") == 0) {
+                int n_bins;
+                conf >> n_bins;
+                std::cerr << "FCT_SIZE_BINS\t\t\t";
+                fct_size_bins.clear();
+                for (int i = 0; i < n_bins; i++) {
+                    uint64_t edge;
+                    conf >> edge;
+                    fct_size_bins.push_back(edge);
+                    std::cerr << ' ' << edge;
+                }
+                std::cerr << '\n';
             } else if (key.compare("PACKET_HEADER_FILE") == 0) {
                 conf >> m_packetHeaderFile;
                 std::cerr << "PACKET_HEADER_FILE\t\t" << m_packetHeaderFile << '\n';
@@ -1701,6 +2148,76 @@ int main(int argc, char *argv[]) {
             } else if (key.compare("PFC_OUTPUT_FILE") == 0) {
                 conf >> pfc_output_file;
                 std::cerr << "PFC_OUTPUT_FILE\t\t\t\t" << pfc_output_file << '\n';
+            } else if (key.compare("PFC_TRACE_FILE") == 0) {
+                conf >> pfc_trace_file;
+                PfcTracer::enabled = !pfc_trace_file.empty();
+                std::cerr << "PFC_TRACE_FILE\t\t\t\t" << pfc_trace_file << '\n';
+            } else if (key.compare("REORDER_ANALYTICS_FILE") == 0) {
+                conf >> reorder_file;
+                ReorderAnalytics::enabled = !reorder_file.empty();
+                std::cerr << "REORDER_ANALYTICS_FILE\t\t\t\t" << reorder_file << '\n';
+            } else if (key.compare("PATH_TRACE_FILE") == 0) {
+                conf >> path_trace_file;
+                PathTracer::enabled = !path_trace_file.empty();
+                std::cerr << "PATH_TRACE_FILE\t\t\t\t" << path_trace_file << '\n';
+            } else if (key.compare("ROUTE_TRACE_FILE") == 0) {
+                conf >> route_trace_file;
+                std::cerr << "ROUTE_TRACE_FILE\t\t\t\t" << route_trace_file << '\n';
+            } else if (key.compare("ROUTE_TRACE_SWITCH") == 0) {
+                conf >> route_trace_switch;
+                std::cerr << "ROUTE_TRACE_SWITCH\t\t\t\t" << route_trace_switch << '\n';
+            } else if (key.compare("ACK_FEEDBACK_SAMPLING") == 0) {
+                std::string mode;
+                conf >> mode;
+                if (mode == "all") {
+                    AckFeedbackSampler::mode = AckFeedbackSampler::ALL;
+                } else if (mode == "nth") {
+                    AckFeedbackSampler::mode = AckFeedbackSampler::EVERY_NTH;
+                } else if (mode == "budget") {
+                    AckFeedbackSampler::mode = AckFeedbackSampler::TIME_BUDGET;
+                } else {
+                    std::cerr << "ACK_FEEDBACK_SAMPLING: unknown mode " << mode
+                              << " (all | nth <N> | budget <ns>)" << std::endl;
+                    exit(1);
+                }
+                if (AckFeedbackSampler::mode != AckFeedbackSampler::ALL) {  // only these take a parameter
+                    conf >> AckFeedbackSampler::param;
+                    if (conf.fail()) {
+                        std::cerr << "ACK_FEEDBACK_SAMPLING " << mode << ": missing or invalid parameter"
+                                  << " (all | nth <N> | budget <ns>)" << std::endl;
+                        exit(1);
+                    }
+                    if (AckFeedbackSampler::param == 0) AckFeedbackSampler::param = 1;
+                }
+                std::cerr << "ACK_FEEDBACK_SAMPLING\t\t\t\t" << mode << " "
+                          << AckFeedbackSampler::param << '\n';
+            } else if (key.compare("COLLECTIVE_FILE") == 0) {
+                conf >> collective_file;
+                std::cerr << "COLLECTIVE_FILE\t\t\t\t" << collective_file << '\n';
+            } else if (key.compare("COLLECTIVE_OUTPUT_FILE") == 0) {
+                conf >> collective_output_file;
+                std::cerr << "COLLECTIVE_OUTPUT_FILE\t\t\t\t" << collective_output_file << '\n';
+            } else if (key.compare("FLUID_MIN_SIZE") == 0) {
+                conf >> fluid_min_size;
+                std::cerr << "FLUID_MIN_SIZE\t\t\t\t" << fluid_min_size << '\n';
+            } else if (key.compare("FLUID_FCT_OUTPUT_FILE") == 0) {
+                conf >> fluid_fct_output_file;
+                std::cerr << "FLUID_FCT_OUTPUT_FILE\t\t\t\t" << fluid_fct_output_file << '\n';
+            } else if (key.compare("FLUID_TICK_NS") == 0) {
+                conf >> fluid_tick_ns;
+                std::cerr << "FLUID_TICK_NS\t\t\t\t" << fluid_tick_ns << '\n';
+            } else if (key.compare("FLOW_LEVEL") == 0) {
+                conf >> flow_level;
+                std::cerr << "FLOW_LEVEL\t\t\t\t" << flow_level << '\n';
+            } else if (key.compare("FLOW_LEVEL_PATH") == 0) {
+                conf >> flow_level_path;
+                std::cerr << "FLOW_LEVEL_PATH\t\t\t\t" << flow_level_path << '\n';
+            } else if (key.compare("QBB_FLOW_MON_FILE") == 0) {
+                conf >> qbb_flow_mon_file;
+                std::cerr << "QBB_FLOW_MON_FILE\t\t\t\t" << qbb_flow_mon_file << '\n';
+            } else if (key.compare("QBB_FLOW_MON_SAMPLING") == 0) {
+                conf >> qbb_flow_mon_sampling;
+                std::cerr << "QBB_FLOW_MON_SAMPLING\t\t\t\t" << qbb_flow_mon_sampling << '\n';
             } else if (key.compare("LINK_DOWN") == 0) {
                 conf >> link_down_time >> link_down_A >> link_down_B;
                 std::cerr << "LINK_DOWN\t\t\t\t" << link_down_time << ' ' << link_down_A << ' '
@@ -1753,6 +2270,39 @@ int main(int argc, char *argv[]) {
             } else if (key.compare("VOQ_MON_DETAIL_FILE") == 0) {
                 conf >> voq_mon_detail_file;
                 std::cerr << "VOQ_MON_DETAIL_FILE\t\t\t\t" << voq_mon_detail_file << '\n';
+            } else if (key.compare("LINK_TELEMETRY_FILE") == 0) {
+                conf >> link_telemetry_file;
+                std::cerr << "LINK_TELEMETRY_FILE\t\t\t" << link_telemetry_file << '\n';
+            } else if (key.compare("LINK_TELEMETRY_DOWNSAMPLE") == 0) {
+                conf >> link_telemetry_downsample;
+                std::cerr << "LINK_TELEMETRY_DOWNSAMPLE\t\t" << link_telemetry_downsample << '\n';
+            } else if (key.compare("MEM_MON_FILE") == 0) {
+                conf >> mem_mon_file;
+                std::cerr << "MEM_MON_FILE\t\t\t\t" << mem_mon_file << '\n';
+            } else if (key.compare("MEM_MON_INTERVAL") == 0) {
+                conf >> mem_mon_interval;
+                std::cerr << "MEM_MON_INTERVAL\t\t\t" << mem_mon_interval << '\n';
+            } else if (key.compare("MEM_BUDGET_MB") == 0) {
+                conf >> mem_budget_mb;
+                std::cerr << "MEM_BUDGET_MB\t\t\t\t" << mem_budget_mb << '\n';
+            } else if (key.compare("HEALTH_STATUS_FILE") == 0) {
+                conf >> health_status_file;
+                std::cerr << "HEALTH_STATUS_FILE\t\t\t" << health_status_file << '\n';
+            } else if (key.compare("HEALTH_INTERVAL") == 0) {
+                conf >> health_interval;
+                std::cerr << "HEALTH_INTERVAL\t\t\t\t" << health_interval << '\n';
+            } else if (key.compare("HEALTH_STALL_WINDOW") == 0) {
+                conf >> health_stall_window;
+                std::cerr << "HEALTH_STALL_WINDOW\t\t\t" << health_stall_window << '\n';
+            } else if (key.compare("HEALTH_DEADLOCK_WINDOW") == 0) {
+                conf >> health_deadlock_window;
+                std::cerr << "HEALTH_DEADLOCK_WINDOW\t\t\t" << health_deadlock_window << '\n';
+            } else if (key.compare("HEALTH_WALL_BUDGET") == 0) {
+                conf >> health_wall_budget;
+                std::cerr << "HEALTH_WALL_BUDGET\t\t\t" << health_wall_budget << '\n';
+            } else if (key.compare("LINK_MON_RAW") == 0) {
+                conf >> link_mon_raw;
+                std::cerr << "LINK_MON_RAW\t\t\t\t" << link_mon_raw << '\n';
             } else if (key.compare("UPLINK_MON_FILE") == 0) {
                 conf >> uplink_mon_file;
                 std::cerr << "UPLINK_MON_FILE\t\t\t\t" << uplink_mon_file << '\n';
@@ -1818,11 +2368,19 @@ int main(int argc, char *argv[]) {
                 conf >> v;
                 enable_irn = v;
                 std::cerr << "ENABLE_IRN\t\t" << enable_irn << "\n";
+            } else if (key.compare("HULA_PROBE_BATCHING") == 0) {
+                bool v;
+                conf >> v;
+                hula_probeBatching = v;
+                std::cerr << "HULA_PROBE_BATCHING\t\t" << hula_probeBatching << "\n";
             } else if (key.compare("RANDOM_SEED") == 0) {
                 int v;
                 conf >> v;
                 random_seed = v;
                 std::cerr << "RANDOM_SEED\t\t\t" << random_seed << "\n";
+            } else if (key.compare("ECMP_SEED") == 0) {
+                conf >> ecmp_seed;
+                std::cerr << "ECMP_SEED\t\t\t" << ecmp_seed << "\n";
             }
 
             fflush(stdout);
@@ -1847,6 +2405,7 @@ int main(int argc, char *argv[]) {
      */
     NS_LOG_INFO("Initialize random seed: " << random_seed);
     srand((unsigned)random_seed);
+    flow_tor_rng.seed(random_seed);
     SeedManager::SetSeed(random_seed);
 
     /**
@@ -1858,6 +2417,17 @@ int main(int argc, char *argv[]) {
     Config::SetDefault("ns3::QbbNetDevice::DynamicThreshold", BooleanValue(dynamicth));
     Config::SetDefault("ns3::QbbNetDevice::QbbEnabled", BooleanValue(enable_pfc));
 
+    if (mpi_size > 1 && !collective_file.empty()) {
+        std::cout << "Collective jobs chain flows of different hosts, they cannot run distributed (MPI)."
+                  << std::endl;
+        exit(1);
+    }
+    if (mpi_size > 1 && (fluid_min_size > 0 || flow_level)) {
+        std::cout << "The fluid model allocates rates over the whole topology, it cannot run distributed (MPI)."
+                  << std::endl;
+        exit(1);
+    }
+
     if (cc_mode != 1 && lb_mode == 9) {
         std::cout << "Currently, ConWeave supports only DCQCN congestion control for RDMA. \nIf "
                      "you want to extend, the reordering delay at DstTor must be considered."
@@ -1881,10 +2451,22 @@ int main(int argc, char *argv[]) {
      * @brief open topology config, input-flows config.
      */
     topof.open(topology_file.c_str());
-    flowf.open(flow_file.c_str());
     uint32_t node_num, switch_num, link_num;
     topof >> node_num >> switch_num >> link_num;
-    flowf >> flow_num;
+    if (!flow_gen_cdf.empty()) {  // flows generated on the fly, as traffic_gen*.py would with the seed
+        if (!flow_gen.SetCdf(flow_gen_cdf)) {
+            std::cerr << "Invalid flow size CDF " << flow_gen_cdf << std::endl;
+            exit(1);
+        }
+        flow_gen.SetParams(flow_gen_nhost, flow_gen_load, flow_gen_bw, flow_gen_time, flow_gen_seed);
+        flow_gen.SetPattern(flow_gen_pattern, flow_gen_mix, flow_gen_podsize,
+                            flow_gen_section_flows, flow_gen_interval);
+        flow_num = flow_gen.CountFlows();
+        std::cout << "Flow generator: " << flow_num << " flows from " << flow_gen_cdf << std::endl;
+    } else {
+        flowf.open(flow_file.c_str());
+        flowf >> flow_num;
+    }
 
     /*-------Parameter of Settings-------*/
     Settings::node_num = node_num;
@@ -1902,13 +2484,41 @@ int main(int argc, char *argv[]) {
         topof >> sid;
         node_type[sid] = 1;
     }//switch is 1, server is 0
+    std::vector<uint32_t> system_id(node_num, 0);  // MPI rank of every node
+    if (mpi_size > 1) {  // the partition needs the links: read them ahead
+        std::streampos linkPos = topof.tellg();
+        std::vector<std::pair<uint32_t, uint32_t>> links;
+        for (uint32_t i = 0; i < link_num; i++) {
+            uint32_t src, dst;
+            std::string data_rate, link_delay;
+            double error_rate;
+            topof >> src >> dst >> data_rate >> link_delay >> error_rate;
+            links.push_back(std::make_pair(src, dst));
+        }
+        topof.seekg(linkPos);
+        system_id = PartitionNodes(node_type, links, mpi_size);
+    }
     for (uint32_t i = 0; i < node_num; i++) {
         if (node_type[i] == 0)
-            n.Add(CreateObject<Node>());
+            n.Add(CreateObject<Node>(system_id[i]));
         else {
-            Ptr<SwitchNode> sw = CreateObject<SwitchNode>();
+            Ptr<SwitchNode> sw = CreateObject<SwitchNode>(system_id[i]);
             n.Add(sw);
             sw->SetAttribute("EcnEnabled", BooleanValue(enable_qcn));
+            if (ecmp_seed != 0) sw->SetEcmpSeed(ecmp_seed ^ i);  // reproducible hashing
+            Ptr<LoadBalancer> lb = LoadBalancer::CreateByMode(lb_mode);  // only the active scheme
+            if (lb == NULL) {
+                std::cerr << "Unknown LB_MODE " << lb_mode << ", registered: " << LoadBalancer::ListModes()
+                          << std::endl;
+                return 1;
+            }
+            sw->SetLoadBalancer(lb);
+            if (ecmp_seed != 0) {  // reproducible choice among equally good paths
+                Ptr<CaverRouting> caver = DynamicCast<CaverRouting>(lb);
+                Ptr<NoshareRouting> noshare = DynamicCast<NoshareRouting>(lb);
+                if (caver != NULL) caver->SetRandomSeed(ecmp_seed ^ i);
+                if (noshare != NULL) noshare->SetRandomSeed(ecmp_seed ^ i);
+            }
             //TODO: my code to send the packet head file writer
             FILE* m_packetHeader_output = fopen(m_packetHeaderFile.c_str(), "w");
             sw->setFilePointer(m_packetHeader_output);
@@ -1943,7 +2553,7 @@ int main(int argc, char *argv[]) {
     rem->SetAttribute("ErrorRate", DoubleValue(error_rate_per_link));
     rem->SetAttribute("ErrorUnit", StringValue("ERROR_UNIT_PACKET"));
 
-    pfc_file = fopen(pfc_output_file.c_str(), "w");
+    pfc_file = OpenRankOutput(pfc_output_file);
 
     QbbHelper qbb;
     Ipv4AddressHelper ipv4;
@@ -2050,6 +2660,7 @@ int main(int argc, char *argv[]) {
         if (n.Get(i)->GetNodeType() == 1) {  // is switch
             Ptr<SwitchNode> sw = DynamicCast<SwitchNode>(n.Get(i));
             uint32_t shift = 3;  // by default 1/8
+            sw->ConfigNPort(sw->GetNDevices() - 1);  // per-port state, before ECN / headroom
             for (uint32_t j = 1; j < sw->GetNDevices(); j++) {
                 Ptr<QbbNetDevice> dev = DynamicCast<QbbNetDevice>(sw->GetDevice(j));
                 // set ecn
@@ -2070,7 +2681,6 @@ int main(int argc, char *argv[]) {
                 uint32_t headroom = rate * delay / 8 / 1000000000 * 2 + 2 * sw->m_mmu->MTU;
                 sw->m_mmu->ConfigHdrm(j, headroom);
             }
-            sw->m_mmu->ConfigNPort(sw->GetNDevices() - 1);
             sw->m_mmu->ConfigBufferSize(buffer_size * 1024 *
                                         1024);  // default 0, specify in run.py!!
             sw->m_mmu->node_id = sw->GetId();
@@ -2079,10 +2689,19 @@ int main(int argc, char *argv[]) {
         }
     }
 
-    fct_output = fopen(fct_output_file.c_str(), "w");
-    flow_input_stream = fopen(flow_input_file.c_str(), "w");
+    fct_output = OpenRankOutput(fct_output_file);
+    if (!fct_summary_file.empty()) {
+        fct_aggregator.SetLbMode(lb_mode);
+        fct_aggregator.SetCcMode(cc_mode);
+        fct_aggregator.SetRelErr(fct_summary_rel_err);
+        fct_aggregator.SetWindow((uint64_t)(flowgen_start_time * 1e9), fct_summary_window);
+        if (!fct_size_bins.empty()) {
+            fct_aggregator.SetSizeBins(fct_size_bins);
+        }
+    }
+    flow_input_stream = OpenRankOutput(flow_input_file);
     if (cc_mode == 1) {
-        cnp_output = fopen(cnp_output_file.c_str(), "w");
+        cnp_output = OpenRankOutput(cnp_output_file);
     }
 
     /**
@@ -2189,7 +2808,7 @@ int main(int argc, char *argv[]) {
             rdmaHw->SetAttribute("IrnRtoLow", TimeValue(MicroSeconds(100)));   // 454
             rdmaHw->SetAttribute("IrnBdp", UintegerValue(irn_bdp_lookup));
             // Monitoring CNP Marking frequency of DCQCN
-            if (cc_mode == 1) {
+            if (cc_mode == 1 && IsLocalNode(n.Get(i))) {
                 Simulator::Schedule(NanoSeconds(cnp_mon_start), &cnp_freq_monitoring, cnp_output,
                                     rdmaHw);
             }
@@ -2246,7 +2865,7 @@ int main(int argc, char *argv[]) {
                     ns3::Ptr<ns3::SwitchNode> Srcsw = DynamicCast<SwitchNode>(n.Get(SrcNode->GetId()));
                     Interface interface = innerPair.second;
                     uint32_t port = interface.idx;
-                    Srcsw->m_mmu->m_dvRouting.id2Port[Dstid] = port;
+                    Srcsw->GetLoadBalancer<DVRouting>()->id2Port[Dstid] = port;
                 }
             }
         }
@@ -2266,7 +2885,7 @@ int main(int argc, char *argv[]) {
                     ns3::Ptr<ns3::SwitchNode> Srcsw = DynamicCast<SwitchNode>(n.Get(SrcNode->GetId()));
                     Interface interface = innerPair.second;
                     uint32_t port = interface.idx;
-                    Srcsw->m_mmu->m_caverRouting.id2Port[Dstid] = port;
+                    Srcsw->GetLoadBalancer<CaverRouting>()->id2Port[Dstid] = port;
                 }
             }
         }
@@ -2285,7 +2904,7 @@ int main(int argc, char *argv[]) {
                     ns3::Ptr<ns3::SwitchNode> Srcsw = DynamicCast<SwitchNode>(n.Get(SrcNode->GetId()));
                     Interface interface = innerPair.second;
                     uint32_t port = interface.idx;
-                    Srcsw->m_mmu->m_noshareRouting.id2Port[Dstid] = port;
+                    Srcsw->GetLoadBalancer<NoshareRouting>()->id2Port[Dstid] = port;
                 }
             }
         }
@@ -2348,15 +2967,15 @@ int main(int argc, char *argv[]) {
                 if (node->GetNodeType() == 1){
                     Ptr<SwitchNode> sw = DynamicCast<SwitchNode>(node);
                     printf("Switch %d's BestPathCETable\n", sw->GetId());
-                    sw->m_mmu->m_caverRouting.printBestPathCETable();
+                    sw->GetLoadBalancer<CaverRouting>()->printBestPathCETable();
                     if(sw->m_isToR){
                         printf("ToR switch %d's PathChoiceTable\n", sw->GetId());
-                        sw->m_mmu->m_caverRouting.printPathChoiceTable();
+                        sw->GetLoadBalancer<CaverRouting>()->printPathChoiceTable();
                         printf("ToR switch %d's PathChoiceFlagMap\n", sw->GetId());
-                        sw->m_mmu->m_caverRouting.printPathChoiceFlagMap();
+                        sw->GetLoadBalancer<CaverRouting>()->printPathChoiceFlagMap();
                     } else {
                         printf("Switch %d's ACCPathCETable\n", sw->GetId());
-                        sw->m_mmu->m_caverRouting.printAcceptablePathTable();
+                        sw->GetLoadBalancer<CaverRouting>()->printAcceptablePathTable();
                     }
                 }
             }
@@ -2374,16 +2993,16 @@ int main(int argc, char *argv[]) {
                 if (node->GetNodeType() == 1){
                     Ptr<SwitchNode> sw = DynamicCast<SwitchNode>(node);
                     printf("Switch %d's BestPathCETable\n", sw->GetId());
-                    sw->m_mmu->m_noshareRouting.printBestPathCETable();
+                    sw->GetLoadBalancer<NoshareRouting>()->printBestPathCETable();
                     if(sw->m_isToR){
                         printf("ToR switch %d's PathChoiceTable\n", sw->GetId());
-                        sw->m_mmu->m_noshareRouting.printPathChoiceTable();
+                        sw->GetLoadBalancer<NoshareRouting>()->printPathChoiceTable();
                         printf("ToR switch %d's PathChoiceFlagMap\n", sw->GetId());
-                        sw->m_mmu->m_noshareRouting.printPathChoiceFlagMap();
+                        sw->GetLoadBalancer<NoshareRouting>()->printPathChoiceFlagMap();
                     }
                     else{
                         printf("Switch %d's ACCPathCETable\n", sw->GetId());
-                        sw->m_mmu->m_noshareRouting.printAcceptablePathTable();
+                        sw->GetLoadBalancer<NoshareRouting>()->printAcceptablePathTable();
                     }
                 }
             }
@@ -2418,185 +3037,59 @@ int main(int argc, char *argv[]) {
         } 
     }
     //idxNodeToR: save Tor switch, idxNodeToR[sw->GetId()] = sw;
-    if (lb_mode == 9 || lb_mode == 3 || lb_mode == 6){
+    // distributed: every rank interns the same paths up front, in the same order
+    if (lb_mode == 9 || lb_mode == 3 || lb_mode == 6 || mpi_size > 1){
         //构建pathid
         if (Path_id_log){
             printf("Pathid construct info:");
         }
-        for (auto i = nextHop.begin(); i != nextHop.end(); i++) {  // every node
-            if (i->first->GetNodeType() == 1) {                    // switch
-                Ptr<Node> nodeSrc = i->first; //nodeSrc：源ToR；
-                Ptr<SwitchNode> swSrc = DynamicCast<SwitchNode>(nodeSrc);  // switch
-                uint32_t swSrcId = swSrc->GetId();
-
-                if (swSrc->m_isToR) {
-                    if (Path_id_log){
-                        printf("--- ToR Switch %d\n", swSrcId);
+        // paths of every (src ToR, dst ToR) pair, enumerated once over the switch graph
+        PathSetBuilder pathSets;
+        std::vector<Ptr<SwitchNode>> tors;
+        for (uint32_t i = 0; i < n.GetN(); i++) {
+            if (n.Get(i)->GetNodeType() != 1) continue;
+            Ptr<SwitchNode> sw = DynamicCast<SwitchNode>(n.Get(i));
+            pathSets.AddSwitch(sw->GetId(), sw->m_isToR);
+            if (sw->m_isToR) tors.push_back(sw);
+        }
+        for (auto &sw2if : nbr2if) {
+            if (sw2if.first->GetNodeType() != 1) continue;
+            for (auto &nbr : sw2if.second) {
+                if (nbr.first->GetNodeType() != 1) continue;  // hosts are never transit
+                pathSets.AddLink(sw2if.first->GetId(), nbr.first->GetId(), nbr.second.idx);
+            }
+        }
+        for (Ptr<SwitchNode> swSrc : tors) {
+            uint32_t swSrcId = swSrc->GetId();
+            if (Path_id_log) {
+                printf("--- ToR Switch %d\n", swSrcId);
+            }
+            for (Ptr<SwitchNode> swDst : tors) {
+                uint32_t swDstId = swDst->GetId();
+                if (swDstId == swSrcId) continue;
+                for (uint32_t pathId : pathSets.Build(swSrcId, swDstId)) {
+                    uint32_t nHops = PathCodec::GetLength(pathId);
+                    if (Path_id_log) {
+                        printf("[%u-hop] %u -> %u, path %u, ports", nHops, swSrcId, swDstId, pathId);
+                        for (uint32_t h = 0; h < nHops; h++) printf(" %u", PathCodec::GetPort(pathId, h));
+                        printf("\n");
                     }
-                    auto table1 = i->second;
-                    for (auto j = table1.begin(); j != table1.end(); j++) {
-                        Ptr<Node> dst = j->first;  // j->first: dst node； j->second: nodeSrc 到达 dst node的路径上的下一跳的节点列表
-                        uint32_t dstIP = Settings::hostId2IpMap[dst->GetId()];
-                        uint32_t dstId = dst->GetId();
-                        //判断是否能直接到达：
-                        auto dstfind_it = std::find(Settings::TorSwitch_nodelist[swSrcId].begin(), Settings::TorSwitch_nodelist[swSrcId].end(), dstId);
-                        if (dstfind_it != Settings::TorSwitch_nodelist[swSrcId].end()){
-                            continue;
-                        }
-
-                        if (lb_mode == 3) {
-                            // initialize `m_congaFromLeafTable` and `m_congaToLeafTable`
-                            for (uint32_t dstTorId : Settings::hostId2ToRlist[dstId]) {
-                                swSrc->m_mmu->m_congaRouting
-                                    .m_congaFromLeafTable[dstTorId];  // dynamically will be added in
-                                                                    // conga
-                                swSrc->m_mmu->m_congaRouting.m_congaToLeafTable[dstTorId];
-                                //printf("init:%d, %d\n", swSrcId, dstTorId);
-                            }
-                        }
-
-                        //遍历dstId相连的swDstUId
-                        for (uint32_t swDstId : Settings::hostId2ToRlist[dstId]) {
-                            uint32_t pathId;
-                            uint8_t path_ports[4] = {0, 0, 0, 0};  // interface is always large than 0
-                            vector<Ptr<Node>> nexts1 = j->second; //j->second: nodeSrc 到达 dst node的路径上的下一跳的节点列表
-                            for (auto next1 : nexts1) {
-                                uint32_t outPort1 = nbr2if[nodeSrc][next1].idx;
-                                auto nexts2 = nextHop[next1][dst];
-
-                                bool find = false;
-
-                                for (auto next2 : nexts2) {
-                                    uint32_t outPort2 = nbr2if[next1][next2].idx;
-                                    if (next2->GetId() == swDstId){
-                                        find = true;
-                                        // this destination has 2-hop distance
-                                        if(Path_id_log){
-                                            printf("[IntraPod-2hop] %d (%d)-> %d (%d) -> %d -> %d\n",nodeSrc->GetId(), outPort1, next1->GetId(), outPort2, next2->GetId(), dst->GetId()); 
-                                        }
-                                        path_ports[0] = (uint8_t)outPort1;
-                                        path_ports[1] = (uint8_t)outPort2;
-                                        pathId = *((uint32_t *)path_ports);
-                                        if (lb_mode == 3) {
-                                            swSrc->m_mmu->m_congaRouting.m_congaRoutingTable[swDstId].insert(pathId);
-                                        }
-                                        if (lb_mode == 6) {
-                                            swSrc->m_mmu->m_letflowRouting.m_letflowRoutingTable[swDstId]
-                                                .insert(pathId);
-                                        }
-                                        if (lb_mode == 9) {
-                                            swSrc->m_mmu->m_conweaveRouting.m_ConWeaveRoutingTable[swDstId]
-                                                .insert(pathId);
-                                            swSrc->m_mmu->m_conweaveRouting.m_rxToRId2BaseRTT[swDstId] =
-                                                one_hop_delay * 4;
-                                        }
-                                        continue;
-                                    }
-                                    auto nexts3 = nextHop[next2][dst];
-                                    for (auto next3 : nexts3) {
-                                        uint32_t outPort3 = nbr2if[next2][next3].idx;
-                                        if (next3->GetId() == swDstId){
-                                            find = true;
-                                            // this destination has 2-hop distance
-                                            if(Path_id_log){
-                                                printf("[IntraPod-3hop] %d (%d)-> %d (%d) -> %d (%d) -> %d ->%d\n", nodeSrc->GetId(), outPort1, next1->GetId(), outPort2,next2->GetId(), outPort3, next3->GetId(), dst->GetId());
-                                            }
-                                            path_ports[0] = (uint8_t)outPort1;
-                                            path_ports[1] = (uint8_t)outPort2;
-                                            path_ports[2] = (uint8_t)outPort3;
-                                            pathId = *((uint32_t *)path_ports);
-                                            if (lb_mode == 3) {
-                                                swSrc->m_mmu->m_congaRouting.m_congaRoutingTable[swDstId]
-                                                    .insert(pathId);
-                                            }
-                                            if (lb_mode == 6) {
-                                                swSrc->m_mmu->m_letflowRouting
-                                                    .m_letflowRoutingTable[swDstId]
-                                                    .insert(pathId);
-                                            }
-                                            if (lb_mode == 9) {
-                                                swSrc->m_mmu->m_conweaveRouting.m_ConWeaveRoutingTable[swDstId]
-                                                    .insert(pathId);
-                                                swSrc->m_mmu->m_conweaveRouting.m_rxToRId2BaseRTT[swDstId] =
-                                                    one_hop_delay * 6;
-                                            }
-                                            continue;
-                                        }
-                                        auto nexts4 = nextHop[next3][dst];
-                                        for (auto next4 : nexts4) {
-                                            uint32_t outPort4 = nbr2if[next3][next4].idx;
-                                            if (next4->GetId() == swDstId) {
-                                                // this destination has 4-hop distance
-                                                find = true;
-                                                if(Path_id_log){
-                                                    printf("[IntraPod-4hop] %d (%d)-> %d (%d) -> %d (%d) -> %d (%d) -> %d -> %d\n", nodeSrc->GetId(), outPort1,
-                                                    next1->GetId(), outPort2, next2->GetId(), outPort3,
-                                                    next3->GetId(), outPort4, next4->GetId(),
-                                                    dst->GetId());
-                                                }
-                                                path_ports[0] = (uint8_t)outPort1;
-                                                path_ports[1] = (uint8_t)outPort2;
-                                                path_ports[2] = (uint8_t)outPort3;
-                                                path_ports[3] = (uint8_t)outPort4;
-                                                pathId = *((uint32_t *)path_ports);
-                                                if (lb_mode == 3) {
-                                                    swSrc->m_mmu->m_congaRouting
-                                                        .m_congaRoutingTable[swDstId]
-                                                        .insert(pathId);
-                                                }
-                                                if (lb_mode == 6) {
-                                                    swSrc->m_mmu->m_letflowRouting
-                                                        .m_letflowRoutingTable[swDstId]
-                                                        .insert(pathId);
-                                                }
-                                                if (lb_mode == 9) {
-                                                    swSrc->m_mmu->m_conweaveRouting
-                                                        .m_ConWeaveRoutingTable[swDstId]
-                                                        .insert(pathId);
-                                                    swSrc->m_mmu->m_conweaveRouting
-                                                        .m_rxToRId2BaseRTT[swDstId] = one_hop_delay * 8;
-
-                                                }
-                                            } 
-                                            else if (!DynamicCast<SwitchNode>(next4)->m_isToR) {
-                                                printf("False too large topo: %d (%d)-> %d (%d) -> %d (%d) -> %d (%d) -> %d -> %d\n", nodeSrc->GetId(), outPort1,
-                                                    next1->GetId(), outPort2, next2->GetId(), outPort3,
-                                                    next3->GetId(), outPort4, next4->GetId(),
-                                                    dst->GetId());
-                                                fflush(stdout);
-                                                assert(false);                                   
-                                            }
-                                        }
-                                    }
-                                }
-                            }    
-                        }
+                    if (lb_mode == 3) {
+                        swSrc->GetLoadBalancer<CongaRouting>()->m_congaRoutingTable[swDstId].insert(pathId);
+                    }
+                    if (lb_mode == 6) {
+                        swSrc->GetLoadBalancer<LetflowRouting>()->m_letflowRoutingTable[swDstId].insert(pathId);
+                    }
+                    if (lb_mode == 9) {
+                        swSrc->GetLoadBalancer<ConWeaveRouting>()->m_ConWeaveRoutingTable[swDstId].insert(pathId);
+                        swSrc->GetLoadBalancer<ConWeaveRouting>()->m_rxToRId2BaseRTT[swDstId] =
+                            one_hop_delay * 2 * nHops;
                     }
-                    //std::cout << "Path Table info: << sw: " <<swSrc->GetId() <<"\n";
-                    // if (Path_Table_log){
-                    //     for (const auto& [key, valueSet] : swSrc->m_mmu->m_conweaveRouting.m_ConWeaveRoutingTable) {
-                    //         std::cout << "Path Table info: << sw: " <<swSrc->GetId() <<",Dst ToR: " << key << ",Path num "  << valueSet.size()<< "\n Path: " ;
-                    //         for (const auto& value : valueSet) {
-                    //             for (int temp_c = 0; temp_c < 4; temp_c++) {
-                    //                 std::cout << static_cast<int>(((uint8_t *)&value)[temp_c]) << " ";
-                    //             }
-                    //             std::cout << std::endl;
-                    //         }
-                    //     }
-                    //     for (const auto& [key, value] : swSrc->m_mmu->m_conweaveRouting.m_rxToRId2BaseRTT) {
-                    //         std::cout << "Path Table info: << sw: " <<swSrc->GetId() <<",Dst ToR: " << key <<  "\n Path length: " ;
-                    //         std::cout << value << std::endl;
-                    //         std::cout << std::endl;
-                    //     }
-// 
-// 
-                    // }
-
                 }
             }
         }
 
-        // m_outPort2BitRateMap - only for Conga
+        // outPort -> link bitrate - only for Conga
         for (auto i = nextHop.begin(); i != nextHop.end(); i++) {  // every node
             if (i->first->GetNodeType() == 1) {                    // switch
                 Ptr<Node> node = i->first;
@@ -2608,7 +3101,7 @@ int main(int argc, char *argv[]) {
                     for (auto next : j->second) {
                         uint32_t outPort = nbr2if[node][next].idx;
                         uint64_t bw = nbr2if[node][next].bw;
-                        sw->m_mmu->m_congaRouting.SetLinkCapacity(outPort, bw);
+                        if (lb_mode == 3) sw->GetLoadBalancer<CongaRouting>()->SetLinkCapacity(outPort, bw);
                         // printf("Node: %d, interface: %d, bw: %lu\n", swId, outPort, bw);
                     }
                 }
@@ -2621,22 +3114,22 @@ int main(int argc, char *argv[]) {
                 Ptr<SwitchNode> sw = DynamicCast<SwitchNode>(node);  // switch
                 NS_LOG_INFO("Switch Info - ID:%u, ToR:%d\n" % (sw->GetId(), sw->m_isToR));
                 if (lb_mode == 3) {
-                    sw->m_mmu->m_congaRouting.SetConstants(conga_dreTime, conga_agingTime,
+                    sw->GetLoadBalancer<CongaRouting>()->SetConstants(conga_dreTime, conga_agingTime,
                                                            conga_flowletTimeout, conga_quantizeBit,
                                                            conga_alpha);
-                    sw->m_mmu->m_congaRouting.SetSwitchInfo(sw->m_isToR, sw->GetId());
+                    sw->GetLoadBalancer<CongaRouting>()->SetSwitchInfo(sw->m_isToR, sw->GetId());
                 }
                 if (lb_mode == 6) {
-                    sw->m_mmu->m_letflowRouting.SetConstants(letflow_agingTime,
+                    sw->GetLoadBalancer<LetflowRouting>()->SetConstants(letflow_agingTime,
                                                              letflow_flowletTimeout);
-                    sw->m_mmu->m_letflowRouting.SetSwitchInfo(sw->m_isToR, sw->GetId());
+                    sw->GetLoadBalancer<LetflowRouting>()->SetSwitchInfo(sw->m_isToR, sw->GetId());
                 }
                 if (lb_mode == 9) {
-                    sw->m_mmu->m_conweaveRouting.SetConstants(
+                    sw->GetLoadBalancer<ConWeaveRouting>()->SetConstants(
                         conweave_extraReplyDeadline, conweave_extraVOQFlushTime,
                         conweave_txExpiryTime, conweave_defaultVOQWaitingTime,
                         conweave_pathPauseTime, conweave_pathAwareRerouting);
-                    sw->m_mmu->m_conweaveRouting.SetSwitchInfo(sw->m_isToR, sw->GetId());
+                    sw->GetLoadBalancer<ConWeaveRouting>()->SetSwitchInfo(sw->m_isToR, sw->GetId());
                 }
             }
         }
@@ -2652,10 +3145,10 @@ int main(int argc, char *argv[]) {
                 Ptr<Node> node = i->first;
                 Ptr<SwitchNode> sw = DynamicCast<SwitchNode>(node);  // switch
                 NS_LOG_INFO("Switch Info - ID:%u, ToR:%d\n" % (sw->GetId(), sw->m_isToR));
-                sw->m_mmu->m_dvRouting.SetConstants(dv_dreTime, dv_agingTime,
+                sw->GetLoadBalancer<DVRouting>()->SetConstants(dv_dreTime, dv_agingTime,
                                                            dv_flowletTimeout, dv_quantizeBit,
                                                            dv_alpha);
-                sw->m_mmu->m_dvRouting.SetSwitchInfo(sw->m_isToR, sw->GetId());
+                sw->GetLoadBalancer<DVRouting>()->SetSwitchInfo(sw->m_isToR, sw->GetId());
             }
         }
 
@@ -2674,7 +3167,7 @@ int main(int argc, char *argv[]) {
                     for (auto next : j->second) {
                         uint32_t outPort = nbr2if[node][next].idx;
                         uint64_t bw = nbr2if[node][next].bw;
-                        sw->m_mmu->m_dvRouting.SetLinkCapacity(outPort, bw);
+                        sw->GetLoadBalancer<DVRouting>()->SetLinkCapacity(outPort, bw);
                         //printf("Node: %d, interface: %d, bw: %lu\n", swId, outPort, bw);
                     }
                 }
@@ -2699,10 +3192,10 @@ int main(int argc, char *argv[]) {
                 Ptr<Node> node = i->first;
                 Ptr<SwitchNode> sw = DynamicCast<SwitchNode>(node);  // switch
                 NS_LOG_INFO("Switch Info - ID:%u, ToR:%d\n" % (sw->GetId(), sw->m_isToR));
-                sw->m_mmu->m_caverRouting.SetConstants(caver_dreTime, caver_agingTime,
+                sw->GetLoadBalancer<CaverRouting>()->SetConstants(caver_dreTime, caver_agingTime,
                                                            caver_flowletTimeout, caver_quantizeBit,
                                                            caver_alpha, caver_ce_threshold, caver_patchoiceTimeout, caver_pathChoice_num, caver_tau, caver_useEWMA);
-                sw->m_mmu->m_caverRouting.SetSwitchInfo(sw->m_isToR, sw->GetId());
+                sw->GetLoadBalancer<CaverRouting>()->SetSwitchInfo(sw->m_isToR, sw->GetId());
                 // dive into related
             }
         }
@@ -2722,7 +3215,7 @@ int main(int argc, char *argv[]) {
                     for (auto next : j->second) {
                         uint32_t outPort = nbr2if[node][next].idx;
                         uint64_t bw = nbr2if[node][next].bw;
-                        sw->m_mmu->m_caverRouting.SetLinkCapacity(outPort, bw);
+                        sw->GetLoadBalancer<CaverRouting>()->SetLinkCapacity(outPort, bw);
                         //printf("Node: %d, interface: %d, bw: %lu\n", swId, outPort, bw);
                     }
                 }
@@ -2736,10 +3229,10 @@ if (lb_mode == 21){
                 Ptr<Node> node = i->first;
                 Ptr<SwitchNode> sw = DynamicCast<SwitchNode>(node);  // switch
                 NS_LOG_INFO("Switch Info - ID:%u, ToR:%d\n" % (sw->GetId(), sw->m_isToR));
-                sw->m_mmu->m_noshareRouting.SetConstants(caver_dreTime, caver_agingTime,
+                sw->GetLoadBalancer<NoshareRouting>()->SetConstants(caver_dreTime, caver_agingTime,
                                                            caver_flowletTimeout, caver_quantizeBit,
                                                            caver_alpha, caver_ce_threshold, caver_patchoiceTimeout, caver_pathChoice_num, caver_tau, caver_useEWMA);
-                sw->m_mmu->m_noshareRouting.SetSwitchInfo(sw->m_isToR, sw->GetId());
+                sw->GetLoadBalancer<NoshareRouting>()->SetSwitchInfo(sw->m_isToR, sw->GetId());
             }
         }
 
@@ -2759,7 +3252,7 @@ if (lb_mode == 21){
                     for (auto next : j->second) {
                         uint32_t outPort = nbr2if[node][next].idx;
                         uint64_t bw = nbr2if[node][next].bw;
-                        sw->m_mmu->m_noshareRouting.SetLinkCapacity(outPort, bw);
+                        sw->GetLoadBalancer<NoshareRouting>()->SetLinkCapacity(outPort, bw);
                         //printf("Node: %d, interface: %d, bw: %lu\n", swId, outPort, bw);
                     }
                 }
@@ -2771,25 +3264,27 @@ if (lb_mode == 21){
         std::cout<<"=====Hula Constants=====\n";
         std::cout<<"Hula probe generation interval:"<<hula_probeGenerationInterval<<std::endl;
         std::cout<<"Hula probe transmit interval:"<<hula_probeTransmitInterval<<std::endl;
+        std::cout<<"Hula probe batching:"<<hula_probeBatching<<std::endl;
+        HulaRouting::probeBatching = hula_probeBatching;
         for (auto &pair1 : nbr2if) {
             if (pair1.first->GetNodeType() == 0) { //只考虑交换机
                 continue;
             }
             Ptr<SwitchNode> snode = DynamicCast<SwitchNode>(pair1.first);
-            if (snode->m_isToR) {
-                snode->m_mmu->m_hulaRouting.active(2);
+            if (snode->m_isToR && IsLocalNode(snode)) {  // probes leave only from simulated ToRs
+                snode->GetLoadBalancer<HulaRouting>()->active(2);
             }
             for (auto &pair2 : pair1.second) {
                 Ptr<Node> dnode = pair2.first;
                 Interface &itf = pair2.second;
                 if (snode->GetId() < dnode->GetId()) {
-                    snode->m_mmu->m_hulaRouting.upLayerDevs.insert(itf.idx);
+                    snode->GetLoadBalancer<HulaRouting>()->upLayerDevs.insert(itf.idx);
                     //std::cout<<snode->GetId()<<"上"<<dnode->GetId()<<"itf"<<itf.idx<<std::endl;
                 } else {
-                    snode->m_mmu->m_hulaRouting.downLayerDevs.insert(itf.idx);
+                    snode->GetLoadBalancer<HulaRouting>()->downLayerDevs.insert(itf.idx);
                     //std::cout<<snode->GetId()<<"下"<<dnode->GetId()<<"itf"<<itf.idx<<std::endl;
                 }
-                snode->m_mmu->m_hulaRouting.SetLinkCapacity(itf.idx, itf.bw);
+                snode->GetLoadBalancer<HulaRouting>()->SetLinkCapacity(itf.idx, itf.bw);
             }
         }
         for (auto i = nextHop.begin(); i != nextHop.end(); i++) {  // every node
@@ -2797,14 +3292,14 @@ if (lb_mode == 21){
                 Ptr<Node> node = i->first;
                 Ptr<SwitchNode> sw = DynamicCast<SwitchNode>(node);  // switch
                 NS_LOG_INFO("Switch Info - ID:%u, ToR:%d\n" % (sw->GetId(), sw->m_isToR));
-                sw->m_mmu->m_hulaRouting.SetConstants(
+                sw->GetLoadBalancer<HulaRouting>()->SetConstants(
                     hula_keepAliveThresh,
                     hula_probeTransmitInterval,
                     hula_flowletInterval,
                     hula_probeGenerationInterval,
                     hula_tau
                 );
-                sw->m_mmu->m_hulaRouting.SetSwitchInfo(sw->m_isToR, sw->GetId());
+                sw->GetLoadBalancer<HulaRouting>()->SetSwitchInfo(sw->m_isToR, sw->GetId());
             }
         }
         Simulator::Schedule(Seconds(flowgen_stop_time + simulator_extra_time), hula_history_print);
@@ -2855,11 +3350,34 @@ if (lb_mode == 21){
 
     flow_input.idx = 0;
     port_per_host = new uint16_t[node_num - switch_num];
+    if (fluid_min_size > 0 || flow_level) {
+        if (!fluid_fct_output_file.empty() && !flow_level) {
+            fluid_fct_output = fopen(fluid_fct_output_file.c_str(), "w");
+        }
+        if (flow_level) {  // nothing else on the links: full capacity, no interaction with ports
+            fluid_model.SetStandalone(true);
+            fluid_model.SetCapacityFactor(1.0);
+            fluid_model.SetPathPolicy(flow_level_path == 1 ? FluidModel::PATH_LEAST_FLOWS
+                                                           : FluidModel::PATH_ECMP);
+        }
+        fluid_model.SetTick(NanoSeconds(fluid_tick_ns));
+        fluid_model.SetFinishCallback(MakeCallback(&fluid_finish));
+    }
     if (flow_num > 0) {
         // generate flows
         ReadFlowInput();
         Simulator::Schedule(Seconds(0), &ScheduleFlowInputs, flow_input_stream);
     }
+    if (!collective_file.empty()) {
+        if (!collective_engine.Load(collective_file)) {
+            std::cerr << "Invalid collective job file " << collective_file << std::endl;
+            exit(1);
+        }
+        collective_engine.SetLauncher(MakeCallback(&LaunchCollectiveFlow));
+        collective_engine.Start();
+        std::cout << "Collective engine: " << collective_engine.GetNumJobs() << " jobs, "
+                  << collective_engine.GetTotalFlows() << " flows" << std::endl;
+    }
 
     topof.close();
 
@@ -2869,27 +3387,29 @@ if (lb_mode == 21){
                             &TakeDownLink, n, n.Get(link_down_A), n.Get(link_down_B));
     }
 
-    if (lb_mode == 9) {
-        voq_output = fopen(voq_mon_file.c_str(), "w");                // specific to ConWeave
-        voq_detail_output = fopen(voq_mon_detail_file.c_str(), "w");  // specific to ConWeave
+    if (lb_mode == 9 && link_mon_raw) {
+        voq_output = OpenRankOutput(voq_mon_file);                // specific to ConWeave
+        voq_detail_output = OpenRankOutput(voq_mon_detail_file);  // specific to ConWeave
     }
 
-    uplink_output = fopen(uplink_mon_file.c_str(), "w");  // common
-    downlink_output = fopen(downlink_mon_file.c_str(), "w");
-    uplink_rx_output = fopen(uplink_rx_mon_file.c_str(), "w");
-    downlink_rx_output = fopen(downlink_rx_mon_file.c_str(), "w");
-    flow_rx_output = fopen(flow_mon_file.c_str(), "w");
-    bps_tx_output = fopen(bps_mon_file.c_str(), "w");
-    conn_output = fopen(conn_mon_file.c_str(), "w");      // common
-    global_CE_map_output = fopen(global_CE_map_mon_file.c_str(), "w");
-    all_links_output = fopen(all_links_mon_file.c_str(), "w");
+    if (link_mon_raw) {
+        uplink_output = OpenRankOutput(uplink_mon_file);  // common
+        downlink_output = OpenRankOutput(downlink_mon_file);
+        uplink_rx_output = OpenRankOutput(uplink_rx_mon_file);
+        downlink_rx_output = OpenRankOutput(downlink_rx_mon_file);
+        flow_rx_output = OpenRankOutput(flow_mon_file);
+        conn_output = OpenRankOutput(conn_mon_file);      // common
+    }
+    bps_tx_output = OpenRankOutput(bps_mon_file);
+    global_CE_map_output = OpenRankOutput(global_CE_map_mon_file);
+    all_links_output = OpenRankOutput(all_links_mon_file);
 
     // update torId2UplinkIf, torId2DownlinkIf
     for (size_t ToRId = 0; ToRId < Settings::node_num; ToRId++) {
         Ptr<Node> node = n.Get(ToRId);
         if (node->GetNodeType() == 1) {  // switches
             auto swNode = DynamicCast<SwitchNode>(n.Get(ToRId));
-            if (swNode->m_isToR) {  // TOR switch
+            if (swNode->m_isToR && IsLocalNode(swNode)) {  // TOR switch
                 for (auto &nextNodeIf : nbr2if[node]) {
                     if (nextNodeIf.first->GetNodeType() ==
                         1) {  // nextNode is switch (i.e., uplink)
@@ -2909,14 +3429,121 @@ if (lb_mode == 21){
             }
         }
     }
-    Simulator::Schedule(Seconds(flowgen_start_time), &periodic_monitoring, voq_output,
-                        voq_detail_output, uplink_output, conn_output, &lb_mode);
-    Simulator::Schedule(Seconds(flowgen_start_time), &m_periodic_monitoring, voq_output,
-                        uplink_output, downlink_output, conn_output, &lb_mode);
+    if (link_mon_raw) {
+        Simulator::Schedule(Seconds(flowgen_start_time), &periodic_monitoring, voq_output,
+                            voq_detail_output, uplink_output, conn_output, &lb_mode);
+        Simulator::Schedule(Seconds(flowgen_start_time), &m_periodic_monitoring, voq_output,
+                            uplink_output, downlink_output, conn_output, &lb_mode);
 
-    Simulator::Schedule(Seconds(flowgen_start_time), &m_rx_periodic_monitoring, uplink_rx_output,
-                        downlink_rx_output, flow_rx_output);
-    Simulator::Schedule(Seconds(flowgen_start_time), &m_QP_rate_monitoring, bps_tx_output);
+        Simulator::Schedule(Seconds(flowgen_start_time), &m_rx_periodic_monitoring,
+                            uplink_rx_output, downlink_rx_output, flow_rx_output);
+    }
+
+    // link telemetry: every egress port of every switch, ToR uplinks grouped per ToR
+    if (!link_telemetry_file.empty()) {
+        link_telemetry.SetStart((uint64_t)(flowgen_start_time * 1e9));
+        link_telemetry.SetInterval(switch_mon_interval, link_telemetry_downsample);
+        for (uint32_t i = 0; i < Settings::node_num; i++) {
+            Ptr<Node> node = n.Get(i);
+            if (node->GetNodeType() != 1 || !IsLocalNode(node)) continue;
+            auto swNode = DynamicCast<SwitchNode>(node);
+            for (auto &nextNodeIf : nbr2if[node]) {
+                bool isUplink = swNode->m_isToR && nextNodeIf.first->GetNodeType() == 1;
+                link_telemetry.AddLink(swNode, nextNodeIf.second.idx, nextNodeIf.first->GetId(),
+                                       isUplink ? i : (uint32_t)LinkTelemetry::NO_TOR);
+            }
+        }
+        Simulator::Schedule(Seconds(flowgen_start_time), &link_telemetry_monitoring);
+    }
+    // memory accounting: the switches/NICs/LBs/clients register themselves, the flow maps here
+    if (!mem_mon_file.empty() || mem_budget_mb > 0) {
+        MemoryAccounting::Register(MakeCallback(&Settings::ReportMemory));
+        if (!mem_mon_file.empty()) mem_mon_output = OpenRankOutput(mem_mon_file);
+        Simulator::Schedule(Seconds(flowgen_start_time), &memory_monitoring);
+    }
+    // run health: every port of the local nodes (PAUSE state, PFC cycles), every local NIC (QPs)
+    bool health_enabled = !health_status_file.empty() || health_stall_window > 0 ||
+                          health_deadlock_window > 0 || health_wall_budget > 0;
+    if (health_enabled) {
+        run_health.SetStatusFile(RankFile(health_status_file));
+        run_health.SetStallWindow(health_stall_window);
+        run_health.SetDeadlockWindow(health_deadlock_window);
+        run_health.SetWallBudget(health_wall_budget);
+        for (uint32_t i = 0; i < Settings::node_num; i++) {
+            Ptr<Node> node = n.Get(i);
+            if (!IsLocalNode(node)) continue;
+            if (node->GetNodeType() == 0) {
+                run_health.AddHost(node->GetObject<RdmaDriver>()->m_rdma);
+            }
+            for (auto &nextNodeIf : nbr2if[node]) {
+                run_health.AddPort(node, nextNodeIf.second.idx, nextNodeIf.first,
+                                   nbr2if[nextNodeIf.first][node].idx);
+            }
+        }
+        Simulator::Schedule(Seconds(flowgen_start_time), &health_monitoring);
+    }
+    // path tracing: port -> peer of every switch, so that paths can be walked offline
+    if (PathTracer::enabled) {
+        for (uint32_t i = 0; i < Settings::node_num; i++) {
+            Ptr<Node> node = n.Get(i);
+            if (node->GetNodeType() != 1 || !IsLocalNode(node)) continue;
+            std::vector<uint32_t> peerOfPort(node->GetNDevices(), (uint32_t)-1);
+            for (auto &nextNodeIf : nbr2if[node]) {
+                peerOfPort[nextNodeIf.second.idx] = nextNodeIf.first->GetId();
+            }
+            PathTracer::AddSwitch(i, peerOfPort);
+        }
+    }
+    // RouteInput trace of one switch, replayed offline by utils/bench-lb-route.cc --trace
+    if (!route_trace_file.empty() && route_trace_switch < node_num &&
+        n.Get(route_trace_switch)->GetNodeType() == 1 && IsLocalNode(n.Get(route_trace_switch))) {
+        Ptr<Node> node = n.Get(route_trace_switch);
+        Ptr<SwitchNode> sw = DynamicCast<SwitchNode>(node);
+        RouteTracer::Config config;
+        config.lbMode = lb_mode;
+        config.switchId = route_trace_switch;
+        config.isToR = sw->m_isToR;
+        config.ecmpSeed = sw->GetEcmpSeed();
+        Ptr<CaverRouting> caver = sw->GetLoadBalancer<CaverRouting>();
+        Ptr<NoshareRouting> noshare = sw->GetLoadBalancer<NoshareRouting>();
+        config.lbSeed = caver != NULL ? caver->GetRandomSeed()
+                                      : (noshare != NULL ? noshare->GetRandomSeed() : 0);
+        if (lb_mode == 10) {
+            config.params = {(double)dv_dreTime.GetNanoSeconds(), (double)dv_agingTime.GetNanoSeconds(),
+                             (double)dv_flowletTimeout.GetNanoSeconds(), (double)dv_quantizeBit,
+                             dv_alpha};
+        } else if (lb_mode == 20 || lb_mode == 21) {
+            config.params = {(double)caver_dreTime.GetNanoSeconds(),
+                             (double)caver_agingTime.GetNanoSeconds(),
+                             (double)caver_flowletTimeout.GetNanoSeconds(),
+                             (double)caver_quantizeBit,
+                             caver_alpha,
+                             caver_ce_threshold,
+                             (double)caver_patchoiceTimeout.GetNanoSeconds(),
+                             (double)caver_pathChoice_num,
+                             (double)caver_tau.GetNanoSeconds(),
+                             (double)caver_useEWMA};
+        }
+        for (auto &nextNodeIf : nbr2if[node]) {
+            config.id2Port[nextNodeIf.first->GetId()] = nextNodeIf.second.idx;
+        }
+        for (auto &dstNext : nextHop[node]) {  // the ports SetLinkCapacity() is called for
+            std::vector<uint32_t> &ports = config.routes[Settings::hostId2IpMap[dstNext.first->GetId()]];
+            for (auto next : dstNext.second) {
+                config.portRate[nbr2if[node][next].idx] = nbr2if[node][next].bw;
+                ports.push_back(nbr2if[node][next].idx);
+            }
+        }
+        config.hostIp2Id.insert(Settings::hostIp2IdMap.begin(), Settings::hostIp2IdMap.end());
+        config.torHosts = Settings::TorSwitch_nodelist[route_trace_switch];
+        config.interfaces = Settings::m_nodeInterfaceMap;
+        if (!RouteTracer::Open(RankFile(route_trace_file).c_str(), config)) {
+            std::cerr << "Cannot write route trace " << route_trace_file << std::endl;
+        }
+    }
+    if (!flow_level) {  // no QP in the flow-level mode
+        Simulator::Schedule(Seconds(flowgen_start_time), &m_QP_rate_monitoring, bps_tx_output);
+    }
 
     if (global_ce_log){
         //Settings::read_static_path("config/my_path.txt");
@@ -2926,20 +3553,28 @@ if (lb_mode == 21){
     
     Ptr<FlowMonitor> flowMonitor;
     FlowMonitorHelper flowHelper;
-    flowMonitor = flowHelper.InstallAll();
+    if (!qbb_flow_mon_file.empty()) {
+        flowHelper.GetRdmaClassifier()->SetSamplingRate(qbb_flow_mon_sampling);
+        flowMonitor = flowHelper.InstallQbbAll();
+    } else {
+        flowMonitor = flowHelper.InstallAll();
+    }
     flowMonitor->Start(Seconds(flowgen_start_time));
     flowMonitor->Stop(Seconds(flowgen_stop_time + 10.0));
 
     size_t lastSlashPos = pfc_output_file.find_last_of("/\\");
-    flow_distribution_monitoring(Seconds(flowgen_start_time), fopen((pfc_output_file.substr(0, lastSlashPos + 1) + "flow_distribution.txt").c_str(), "w"));
-    Settings::caverLog = fopen((pfc_output_file.substr(0, lastSlashPos + 1) + "caver_log.txt").c_str(), "w");
-    packetId2FlowId = fopen((pfc_output_file.substr(0, lastSlashPos + 1) + "packetId2FlowId.txt").c_str(), "w");
-    ideal_ce = fopen((pfc_output_file.substr(0, lastSlashPos + 1) + "ideal_ce.txt").c_str(), "w");
+    Settings::caverLog = OpenRankOutput((pfc_output_file.substr(0, lastSlashPos + 1) + "caver_log.txt"));
+    packetId2FlowId = OpenRankOutput((pfc_output_file.substr(0, lastSlashPos + 1) + "packetId2FlowId.txt"));
+    ideal_ce = OpenRankOutput((pfc_output_file.substr(0, lastSlashPos + 1) + "ideal_ce.txt"));
 
     //
     // Now, do the actual simulation.
     //
     std::cout << "------------------------------------------" << std::endl;
+    if (mpi_size > 1) {  // probes rebuild paths hop by hop: ids must already exist on every rank
+        PathCodec::AddSuffixes();
+        PathCodec::Freeze();
+    }
     std::cout << "Running Simulation.\n";
     fflush(stdout);
     NS_LOG_INFO("Run Simulation.");
@@ -2948,6 +3583,118 @@ if (lb_mode == 21){
     Simulator::Stop(Seconds(flowgen_stop_time + 10.0));
     Simulator::Run();
 
+    if (!link_telemetry_file.empty()) {
+        if (!link_telemetry.Write(RankFile(link_telemetry_file).c_str())) {
+            std::cerr << "Cannot write link telemetry " << link_telemetry_file << std::endl;
+        }
+        std::cout << "Link telemetry: " << link_telemetry.GetNumLinks() << " links x "
+                  << link_telemetry.GetNumPoints() << " points -> " << link_telemetry_file
+                  << std::endl;
+    }
+    if (!pfc_trace_file.empty()) {
+        FILE *pfc_trace = fopen(RankFile(pfc_trace_file).c_str(), "w");
+        if (pfc_trace == NULL) {
+            std::cerr << "Cannot write PFC trace " << pfc_trace_file << std::endl;
+        } else {
+            PfcTracer::Write(pfc_trace);
+            fclose(pfc_trace);
+            std::cout << "PFC trace: " << PfcTracer::GetEvents().size() << " pause events -> "
+                      << pfc_trace_file << std::endl;
+        }
+    }
+    if (!reorder_file.empty()) {
+        ReorderAnalytics::CloseOpenEpisodes(Simulator::Now().GetTimeStep());
+        if (!ReorderAnalytics::Write(RankFile(reorder_file).c_str())) {
+            std::cerr << "Cannot write reordering analytics " << reorder_file << std::endl;
+        }
+        std::cout << "Reordering analytics: " << ReorderAnalytics::GetNumFlows() << " flows -> "
+                  << reorder_file << std::endl;
+        ReorderAnalytics::WriteTails(stdout);
+    }
+    if (!path_trace_file.empty()) {
+        if (!PathTracer::Write(RankFile(path_trace_file).c_str())) {
+            std::cerr << "Cannot write path trace " << path_trace_file << std::endl;
+        }
+        std::cout << "Path trace: " << PathTracer::GetNumRecords() << " path changes of "
+                  << PathTracer::GetNumFlows() << " flows -> " << path_trace_file << std::endl;
+    }
+    if (!route_trace_file.empty()) {
+        RouteTracer::Close();
+        std::cout << "Route trace: " << RouteTracer::GetNumRecords() << " packets of switch "
+                  << route_trace_switch << " -> " << route_trace_file << std::endl;
+    }
+    if (lb_mode == 10 || lb_mode == 20 || lb_mode == 21) {  // DV / CAVER / Noshare
+        AckFeedbackSampler::PrintCounters(stdout);
+    }
+    if (!collective_output_file.empty()) {
+        if (!collective_engine.Write(collective_output_file.c_str())) {
+            std::cerr << "Cannot write collective summary " << collective_output_file << std::endl;
+        }
+        std::cout << "Collective engine: " << collective_engine.GetNumFinishedJobs() << "/"
+                  << collective_engine.GetNumJobs() << " jobs finished -> "
+                  << collective_output_file << std::endl;
+    }
+    if (fluid_min_size > 0 || flow_level) {
+        std::cout << "Fluid model: " << fluid_model.GetNumFinished() << " fluid flows finished, "
+                  << fluid_model.GetNumFluidFlows() << " still active, "
+                  << fluid_model.GetNumRateUpdates() << " rate updates" << std::endl;
+        if (fluid_fct_output != NULL) fclose(fluid_fct_output);
+    }
+    if (!health_status_file.empty()) {
+        run_health.WriteStatus("finished");
+    }
+    if (mem_mon_output != NULL) {
+        MemoryAccounting::Report report;
+        MemoryAccounting::Collect(report);
+        uint64_t rss = MemoryAccounting::GetRss();
+        MemoryAccounting::WriteSample(mem_mon_output, Simulator::Now().GetTimeStep(), report, rss);
+        MemoryAccounting::WriteReport(mem_mon_output, report, rss);
+        fclose(mem_mon_output);
+        std::cout << "Memory: peak RSS " << (MemoryAccounting::GetPeakRss() >> 20) << " MB, "
+                  << (report.GetTotalBytes() >> 20) << " MB accounted -> " << mem_mon_file << std::endl;
+    }
+    // one flow monitor file and one FCT summary: rank 0 merges the statistics of all the ranks
+    if (!qbb_flow_mon_file.empty()) {
+        if (mpi_size > 1) {
+            flowMonitor->CheckForLostPackets();
+            StatsImage image;
+            flowMonitor->SerializeStats(image);
+            std::vector<std::vector<uint8_t> > images = GatherOnRank0(image.GetData());
+            for (uint32_t r = 1; r < images.size(); r++) {
+                StatsImage rankImage(images[r].data(), images[r].size());
+                if (!flowMonitor->MergeStats(rankImage)) {
+                    std::cerr << "Cannot merge the flow monitor of rank " << r << std::endl;
+                }
+            }
+        }
+        if (mpi_rank == 0) {
+            flowMonitor->SerializeToXmlFile(qbb_flow_mon_file, true, true);
+            std::cout << "RDMA flow monitor: " << flowMonitor->GetFlowStats().size()
+                      << " flows -> " << qbb_flow_mon_file << std::endl;
+        }
+    }
+    if (!fct_summary_file.empty()) {
+        if (mpi_size > 1) {
+            std::vector<uint8_t> image;
+            fct_aggregator.Save(image);
+            std::vector<std::vector<uint8_t> > images = GatherOnRank0(image);
+            for (uint32_t r = 1; r < images.size(); r++) {
+                if (!fct_aggregator.MergeSaved(images[r].data(), images[r].size())) {
+                    std::cerr << "Cannot merge the FCT summary of rank " << r << std::endl;
+                }
+            }
+        }
+        if (mpi_rank == 0) {
+            if (!fct_aggregator.WriteSummary(fct_summary_file.c_str())) {
+                std::cerr << "Cannot write FCT summary " << fct_summary_file << std::endl;
+            }
+            std::cout << "FCT summary: " << fct_aggregator.GetNumFlows() << " flows -> "
+                      << fct_summary_file << std::endl;
+        }
+    }
+
+    MergeRankOutputs();
+
     //for (const auto& entry : Settings::PacketId2FlowId) {
     //    const auto& tuple_key = entry.first;
     //    uint32_t value = entry.second;
@@ -2965,7 +3712,13 @@ if (lb_mode == 21){
     /*-----------------------------------------------------------------------------*/
     Simulator::Destroy();
     NS_LOG_INFO("Total number of packets: " << RdmaHw::nAllPkts);
+    EventAllocator::Stats evStats = EventAllocator::GetStats();
+    std::cout << "Events: " << evStats.allocations << " (system allocations: "
+              << evStats.chunks + evStats.unpooled << ")" << std::endl;
     NS_LOG_INFO("Done.");
     endt = clock();
     std::cerr << (double)(endt - begint) / CLOCKS_PER_SEC << "\n";
+#ifdef NS3_MPI
+    MpiInterface::Disable();
+#endif
 }
@@ -97,14 +97,27 @@ RdmaClient::GetTypeId (void)
   return tid;
 }
 
+uint32_t RdmaClient::m_nLive = 0;
+
 RdmaClient::RdmaClient ()
 {
   NS_LOG_FUNCTION_NOARGS ();
+  static uint32_t probe = MemoryAccounting::Register (MakeCallback (&RdmaClient::ReportMemory));
+  (void) probe;
+  m_nLive++;
 }
 
 RdmaClient::~RdmaClient ()
 {
   NS_LOG_FUNCTION_NOARGS ();
+  m_nLive--;
+}
+
+void
+RdmaClient::ReportMemory (MemoryAccounting::Report &report)
+{
+  report.Add ("app.rdma_client", m_nLive,
+              (uint64_t) m_nLive * (sizeof (RdmaClient) + MemoryAccounting::MALLOC_OVERHEAD));
 }
 
 void RdmaClient::SetRemote (Ipv4Address ip, uint16_t port)
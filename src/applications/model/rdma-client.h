@@ -28,6 +28,7 @@
 #include "ns3/ptr.h"
 #include "ns3/ipv4-address.h"
 #include <ns3/rdma.h>
+#include "ns3/memory-accounting.h"
 
 namespace ns3 {
 
@@ -64,6 +65,7 @@ protected:
   virtual void DoDispose (void);
 
 private:
+  static void ReportMemory (MemoryAccounting::Report &report);  // live clients ("app.rdma_client")
 
   virtual void StartApplication (void);
   virtual void StopApplication (void);
@@ -76,6 +78,8 @@ private:
   uint32_t m_win; // bound of on-the-fly packets
   uint64_t m_baseRtt; // base Rtt
   int32_t m_flow_id;
+
+  static uint32_t m_nLive;  // clients alive, reported to the memory accounting
 };
 
 } // namespace ns3
@@ -135,7 +135,7 @@ UdpServer::GetReceived(void) const {
 }
 
 void UdpServer::DoDispose(void) {
-    extern std::unordered_map<unsigned, Time> acc_pause_time;
+    extern std::unordered_map<unsigned, Time> acc_nic_pause_time;
     extern std::unordered_map<unsigned, unsigned> acc_timeout_count;
     NS_LOG_FUNCTION(this);
     bool is_completed = m_app_recv_buffer.isComplete(expected_flow_size);
@@ -145,12 +145,14 @@ void UdpServer::DoDispose(void) {
 /** DEBUGGING START **/
 #if (DEBUG_UDP_SERVER == 1)
     if (debug_first_terminate) {
-        fprintf(stdout, "Flow#\tsrc\tdst\tstart\tend\tduration\tsize\tcompleted\tactual#\tpaused\tdelayed%%\tT/O\n");
+        fprintf(stdout, "Flow#\tsrc\tdst\tstart\tend\tduration\tsize\tcompleted\tactual#\tnic_paused\tdelayed%%\tT/O"
+                        "\t(per-hop PFC blocked time: flow monitor only)\n");
         debug_first_terminate = false;
     }
+    // nic_paused: time the flow's priority was PAUSEd on the sender NIC (acc_nic_pause_time)
     double time_paused = 0;
-    if (acc_pause_time.find(incoming_flow_id) != acc_pause_time.end())
-        time_paused = acc_pause_time.find(incoming_flow_id)->second.GetNanoSeconds() / 1000000000.;
+    if (acc_nic_pause_time.find(incoming_flow_id) != acc_nic_pause_time.end())
+        time_paused = acc_nic_pause_time.find(incoming_flow_id)->second.GetNanoSeconds() / 1000000000.;
     unsigned timeout_count = 0;
     if (acc_timeout_count.find(incoming_flow_id) != acc_timeout_count.end())
         timeout_count = acc_timeout_count[incoming_flow_id];
@@ -61,6 +61,7 @@ DefaultSimulatorImpl::DefaultSimulatorImpl ()
   m_uid = 4;
   // before ::Run is entered, the m_currentUid will be zero
   m_currentUid = 0;
+  m_eventCount = 0;
   m_currentTs = 0;
   m_currentContext = 0xffffffff;
   m_unscheduledEvents = 0;
@@ -139,6 +140,7 @@ DefaultSimulatorImpl::ProcessOneEvent (void)
   m_currentTs = next.key.m_ts;
   m_currentContext = next.key.m_context;
   m_currentUid = next.key.m_uid;
+  m_eventCount++;
   next.impl->Invoke ();
   next.impl->Unref ();
 
@@ -309,6 +311,45 @@ DefaultSimulatorImpl::ScheduleNow (EventImpl *event)
   return EventId (event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
 }
 
+EventId
+DefaultSimulatorImpl::Reserve (Time const &time)
+{
+  Time tAbsolute = time + TimeStep (m_currentTs);
+  NS_ASSERT (tAbsolute >= TimeStep (m_currentTs));
+  // consumes a uid exactly like Schedule, so that the events scheduled
+  // afterwards are ordered the same whether or not the slot gets used
+  EventId slot (0, (uint64_t) tAbsolute.GetTimeStep (), GetContext (), m_uid);
+  m_uid++;
+  return slot;
+}
+
+bool
+DefaultSimulatorImpl::CanReserve (void) const
+{
+  return true;
+}
+
+EventId
+DefaultSimulatorImpl::ScheduleReserved (const EventId &slot, EventImpl *event)
+{
+  NS_ASSERT_MSG (!IsPassed (slot), "Simulator::ScheduleReserved: the slot has passed");
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = slot.GetTs ();
+  ev.key.m_context = slot.GetContext ();
+  ev.key.m_uid = slot.GetUid ();
+  m_unscheduledEvents++;
+  m_events->Insert (ev);
+  return EventId (event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
+}
+
+bool
+DefaultSimulatorImpl::IsPassed (const EventId &slot) const
+{
+  return slot.GetTs () < m_currentTs ||
+         (slot.GetTs () == m_currentTs && slot.GetUid () <= m_currentUid);
+}
+
 EventId
 DefaultSimulatorImpl::ScheduleDestroy (EventImpl *event)
 {
@@ -417,6 +458,12 @@ DefaultSimulatorImpl::IsExpired (const EventId &ev) const
     }
 }
 
+uint64_t
+DefaultSimulatorImpl::GetEventCount (void) const
+{
+  return m_eventCount;
+}
+
 Time 
 DefaultSimulatorImpl::GetMaximumSimulationTime (void) const
 {
@@ -0,0 +1,113 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "event-allocator.h"
+#include <new>
+
+namespace ns3 {
+
+namespace {
+
+struct FreeBlock
+{
+  FreeBlock *next;
+};
+
+/*
+ * per-thread cache; plain POD so that __thread needs no constructor.
+ * Kept in one struct: in a shared library each distinct __thread variable
+ * costs a __tls_get_addr call, so callers look the cache up once.
+ */
+struct ThreadCache
+{
+  FreeBlock *freeList[EventAllocator::N_CLASSES];
+  EventAllocator::Stats stats;
+};
+__thread ThreadCache g_cache;
+
+inline uint32_t
+SizeClass (std::size_t size)
+{
+  return (size - 1) / EventAllocator::GRANULE;
+}
+
+FreeBlock *
+Refill (ThreadCache &cache, uint32_t cls)
+{
+  std::size_t blockSize = (cls + 1) * EventAllocator::GRANULE;
+  char *chunk = static_cast<char *> (::operator new (blockSize * EventAllocator::BLOCKS_PER_CHUNK));
+  cache.stats.chunks++;
+  // keep block 0 for the caller, thread the rest onto the free list
+  FreeBlock *head = 0;
+  for (uint32_t i = EventAllocator::BLOCKS_PER_CHUNK - 1; i > 0; i--)
+    {
+      FreeBlock *b = reinterpret_cast<FreeBlock *> (chunk + i * blockSize);
+      b->next = head;
+      head = b;
+    }
+  cache.freeList[cls] = head;
+  return reinterpret_cast<FreeBlock *> (chunk);
+}
+
+} // anonymous namespace
+
+void *
+EventAllocator::Allocate (std::size_t size)
+{
+  ThreadCache &cache = g_cache;
+  cache.stats.allocations++;
+  if (size == 0 || size > MAX_SIZE)
+    {
+      cache.stats.unpooled++;
+      return ::operator new (size);
+    }
+  uint32_t cls = SizeClass (size);
+  FreeBlock *b = cache.freeList[cls];
+  if (b != 0)
+    {
+      cache.freeList[cls] = b->next;
+      cache.stats.recycled++;
+      return b;
+    }
+  return Refill (cache, cls);
+}
+
+void
+EventAllocator::Deallocate (void *p, std::size_t size)
+{
+  if (p == 0)
+    {
+      return;
+    }
+  if (size == 0 || size > MAX_SIZE)
+    {
+      ::operator delete (p);
+      return;
+    }
+  ThreadCache &cache = g_cache;
+  uint32_t cls = SizeClass (size);
+  FreeBlock *b = static_cast<FreeBlock *> (p);
+  b->next = cache.freeList[cls];
+  cache.freeList[cls] = b;
+}
+
+EventAllocator::Stats
+EventAllocator::GetStats (void)
+{
+  return g_cache.stats;
+}
+
+} // namespace ns3
@@ -21,7 +21,9 @@
 #define EVENT_IMPL_H
 
 #include <stdint.h>
+#include <cstddef>
 #include "simple-ref-count.h"
+#include "event-allocator.h"
 
 namespace ns3 {
 
@@ -58,6 +60,20 @@ public:
    */
   bool IsCancelled (void);
 
+  /**
+   * Events are allocated from EventAllocator size classes. The destructor
+   * is virtual, so the deleting destructor of the concrete subclass passes
+   * its own size back to operator delete.
+   */
+  static void *operator new (std::size_t size)
+  {
+    return EventAllocator::Allocate (size);
+  }
+  static void operator delete (void *p, std::size_t size)
+  {
+    EventAllocator::Deallocate (p, size);
+  }
+
 protected:
   virtual void Notify (void) = 0;
 
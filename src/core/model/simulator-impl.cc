@@ -1,5 +1,6 @@
 #include "simulator-impl.h"
 #include "log.h"
+#include "fatal-error.h"
 
 NS_LOG_COMPONENT_DEFINE ("SimulatorImpl");
 
@@ -14,4 +15,31 @@ SimulatorImpl::GetTypeId (void)
   return tid;
 }
 
+EventId
+SimulatorImpl::Reserve (Time const &time)
+{
+  NS_FATAL_ERROR ("event slot reservation is not supported by " << GetInstanceTypeId ().GetName ());
+  return EventId ();
+}
+
+bool
+SimulatorImpl::CanReserve (void) const
+{
+  return false;
+}
+
+EventId
+SimulatorImpl::ScheduleReserved (const EventId &slot, EventImpl *event)
+{
+  NS_FATAL_ERROR ("event slot reservation is not supported by " << GetInstanceTypeId ().GetName ());
+  return EventId ();
+}
+
+bool
+SimulatorImpl::IsPassed (const EventId &slot) const
+{
+  NS_FATAL_ERROR ("event slot reservation is not supported by " << GetInstanceTypeId ().GetName ());
+  return true;
+}
+
 } // namespace ns3
@@ -165,6 +165,11 @@ public:
    * The returned value will always be bigger than or equal to Simulator::Now.
    */
   virtual Time GetMaximumSimulationTime (void) const = 0;
+  /**
+   * \return the number of events executed so far (0 if the implementation
+   *          does not count them)
+   */
+  virtual uint64_t GetEventCount (void) const { return 0; }
   /**
    * \param schedulerFactory a new event scheduler factory
    *
@@ -182,6 +187,32 @@ public:
    * \return the current simulation context
    */
   virtual uint32_t GetContext (void) const = 0;
+  /**
+   * \param time delay until the reserved slot
+   * \return the position (timestamp and uid) in the event order that an
+   *         event scheduled now with this delay would take. Nothing is
+   *         inserted in the event list.
+   *
+   * The default implementation does not support reservations.
+   */
+  virtual EventId Reserve (Time const &time);
+  /**
+   * \return true if Reserve, ScheduleReserved and IsPassed are supported.
+   *         The default implementation returns false.
+   */
+  virtual bool CanReserve (void) const;
+  /**
+   * \param slot a slot returned by Reserve which has not passed yet
+   * \param event the event to schedule in this slot
+   * \return the id of the scheduled event
+   */
+  virtual EventId ScheduleReserved (const EventId &slot, EventImpl *event);
+  /**
+   * \param slot a slot returned by Reserve
+   * \return true if an event scheduled in this slot would already have
+   *         been invoked (or would be the current event)
+   */
+  virtual bool IsPassed (const EventId &slot) const;
 };
 
 } // namespace ns3
@@ -228,6 +228,26 @@ Simulator::DoScheduleDestroy (EventImpl *impl)
 {
   return GetImpl ()->ScheduleDestroy (impl);
 }
+EventId
+Simulator::Reserve (Time const &time)
+{
+  return GetImpl ()->Reserve (time);
+}
+EventId
+Simulator::DoScheduleReserved (const EventId &slot, EventImpl *impl)
+{
+  return GetImpl ()->ScheduleReserved (slot, impl);
+}
+bool
+Simulator::CanReserve (void)
+{
+  return GetImpl ()->CanReserve ();
+}
+bool
+Simulator::IsPassed (const EventId &slot)
+{
+  return GetImpl ()->IsPassed (slot);
+}
 
 
 EventId
@@ -296,6 +316,13 @@ Simulator::GetMaximumSimulationTime (void)
   return GetImpl ()->GetMaximumSimulationTime ();
 }
 
+uint64_t
+Simulator::GetEventCount (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return GetImpl ()->GetEventCount ();
+}
+
 uint32_t
 Simulator::GetContext (void)
 {
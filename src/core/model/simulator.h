@@ -743,6 +743,11 @@ public:
    */
   static Time GetMaximumSimulationTime (void);
 
+  /**
+   * \returns the number of events executed so far
+   */
+  static uint64_t GetEventCount (void);
+
   /**
    * \returns the current simulation context
    */
@@ -789,6 +794,42 @@ public:
    */
   static EventId ScheduleNow (const Ptr<EventImpl> &event);
 
+  /**
+   * \param time delay until the reserved slot
+   * \returns a slot in the event order: the timestamp and uid that an
+   *          event scheduled now with the same delay would get.
+   *
+   * Nothing is scheduled. The slot can later be filled with
+   * ScheduleReserved, as long as it has not passed (see IsPassed). The
+   * resulting event runs exactly where it would have run had it been
+   * scheduled when the slot was reserved, relative to all other events.
+   * This lets a model skip events that usually turn out to be no-ops
+   * without changing the order of the events it does schedule.
+   */
+  static EventId Reserve (Time const &time);
+
+  /**
+   * \returns true if the simulator implementation in use supports Reserve,
+   *          ScheduleReserved and IsPassed (the default one does; the others
+   *          abort on them). Models fall back to plain Schedule otherwise.
+   */
+  static bool CanReserve (void);
+
+  /**
+   * \param slot a slot returned by Reserve
+   * \param mem_ptr member method pointer to invoke
+   * \param obj the object on which to invoke the member method
+   * \returns the id of the scheduled event
+   */
+  template <typename MEM, typename OBJ>
+  static EventId ScheduleReserved (const EventId &slot, MEM mem_ptr, OBJ obj);
+
+  /**
+   * \param slot a slot returned by Reserve
+   * \returns true if the slot is at or before the current event.
+   */
+  static bool IsPassed (const EventId &slot);
+
   /**
    * \returns the system id for this simulator; used for 
    *          MPI or other distributed simulations
@@ -801,6 +842,7 @@ private:
   static EventId DoSchedule (Time const &time, EventImpl *event);
   static EventId DoScheduleNow (EventImpl *event);
   static EventId DoScheduleDestroy (EventImpl *event);
+  static EventId DoScheduleReserved (const EventId &slot, EventImpl *event);
 };
 
 /**
@@ -987,6 +1029,13 @@ Simulator::ScheduleNow (MEM mem_ptr, OBJ obj)
   return DoScheduleNow (MakeEvent (mem_ptr, obj));
 }
 
+template <typename MEM, typename OBJ>
+EventId
+Simulator::ScheduleReserved (const EventId &slot, MEM mem_ptr, OBJ obj)
+{
+  return DoScheduleReserved (slot, MakeEvent (mem_ptr, obj));
+}
+
 
 template <typename MEM, typename OBJ, 
           typename T1>
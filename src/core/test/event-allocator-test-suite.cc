@@ -0,0 +1,241 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/event-allocator.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+#include <stdint.h>
+#include <cstring>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace {
+void Nop (void)
+{
+}
+void NopWide (uint64_t, uint64_t, uint64_t, uint64_t, uint64_t)
+{
+}
+} // anonymous namespace
+
+namespace ns3 {
+
+/**
+ * Blocks of one size class are handed out LIFO from the free list, are aligned
+ * to GRANULE and do not overlap; sizes beyond MAX_SIZE bypass the pool.
+ */
+class EventAllocatorBlockTestCase : public TestCase
+{
+public:
+  EventAllocatorBlockTestCase ();
+  virtual void DoRun (void);
+};
+
+EventAllocatorBlockTestCase::EventAllocatorBlockTestCase ()
+  : TestCase ("Size classes, free-list reuse and unpooled sizes")
+{
+}
+
+void
+EventAllocatorBlockTestCase::DoRun (void)
+{
+  EventAllocator::Stats s0 = EventAllocator::GetStats ();
+
+  // same size class (33..48 bytes): the last block freed is the next one handed out
+  void *p = EventAllocator::Allocate (40);
+  EventAllocator::Deallocate (p, 40);
+  void *q = EventAllocator::Allocate (33);
+  NS_TEST_ASSERT_MSG_EQ (q, p, "block not reused within its size class");
+  void *r = EventAllocator::Allocate (48);
+  NS_TEST_ASSERT_MSG_NE (r, q, "a live block handed out twice");
+  void *other = EventAllocator::Allocate (49);
+  NS_TEST_ASSERT_MSG_NE (other, p, "block reused by another size class");
+  EventAllocator::Deallocate (other, 49);
+  EventAllocator::Deallocate (r, 48);
+  EventAllocator::Deallocate (q, 33);
+  EventAllocator::Deallocate (0, 40);  // no-op
+
+  // several chunks' worth of the largest pooled class, filled with a per-block pattern
+  const uint32_t n = 3 * EventAllocator::BLOCKS_PER_CHUNK + 1;
+  const std::size_t size = EventAllocator::MAX_SIZE;
+  std::vector<unsigned char *> blocks;
+  std::set<void *> distinct;
+  EventAllocator::Stats s1 = EventAllocator::GetStats ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      unsigned char *b = static_cast<unsigned char *> (EventAllocator::Allocate (size));
+      NS_TEST_ASSERT_MSG_EQ (reinterpret_cast<uintptr_t> (b) % EventAllocator::GRANULE, 0,
+                             "block not aligned to GRANULE");
+      std::memset (b, i & 0xff, size);
+      blocks.push_back (b);
+      distinct.insert (b);
+    }
+  NS_TEST_ASSERT_MSG_EQ (distinct.size (), n, "live blocks handed out twice");
+  for (uint32_t i = 0; i < n; i++)
+    {
+      for (std::size_t j = 0; j < size; j++)
+        {
+          if (blocks[i][j] != (i & 0xff))
+            {
+              NS_TEST_ASSERT_MSG_EQ ((uint32_t)blocks[i][j], (i & 0xff), "blocks overlap");
+            }
+        }
+    }
+  EventAllocator::Stats s2 = EventAllocator::GetStats ();
+  NS_TEST_ASSERT_MSG_EQ (s2.allocations - s1.allocations, n, "allocation count");
+  NS_TEST_ASSERT_MSG_LT (s2.chunks - s1.chunks, n / EventAllocator::BLOCKS_PER_CHUNK + 2,
+                         "more chunks than needed");
+  NS_TEST_ASSERT_MSG_EQ (s2.unpooled, s1.unpooled, "pooled size served by operator new");
+
+  // freed and allocated again: all from the free list, no new chunk
+  for (uint32_t i = 0; i < n; i++)
+    {
+      EventAllocator::Deallocate (blocks[i], size);
+    }
+  for (uint32_t i = 0; i < n; i++)
+    {
+      blocks[i] = static_cast<unsigned char *> (EventAllocator::Allocate (size));
+      NS_TEST_ASSERT_MSG_EQ (distinct.count (blocks[i]), 1, "recycled block from outside the pool");
+    }
+  EventAllocator::Stats s3 = EventAllocator::GetStats ();
+  NS_TEST_ASSERT_MSG_EQ (s3.chunks, s2.chunks, "chunk allocated with free blocks available");
+  NS_TEST_ASSERT_MSG_EQ (s3.recycled - s2.recycled, n, "recycled count");
+  for (uint32_t i = 0; i < n; i++)
+    {
+      EventAllocator::Deallocate (blocks[i], size);
+    }
+
+  // larger than MAX_SIZE (and zero): plain operator new
+  void *big = EventAllocator::Allocate (EventAllocator::MAX_SIZE + 1);
+  void *zero = EventAllocator::Allocate (0);
+  EventAllocator::Stats s4 = EventAllocator::GetStats ();
+  NS_TEST_ASSERT_MSG_EQ (s4.unpooled - s3.unpooled, 2, "unpooled count");
+  NS_TEST_ASSERT_MSG_EQ (s4.chunks, s3.chunks, "unpooled size took a chunk");
+  EventAllocator::Deallocate (big, EventAllocator::MAX_SIZE + 1);
+  EventAllocator::Deallocate (zero, 0);
+  NS_TEST_ASSERT_MSG_GT (s4.allocations, s0.allocations, "allocation counter not advancing");
+}
+
+/**
+ * Scheduled events come from the pool and go back to it whether they run or are
+ * cancelled: a second round of the same load takes no new chunk.
+ */
+class EventAllocatorSimulatorTestCase : public TestCase
+{
+public:
+  EventAllocatorSimulatorTestCase ();
+  virtual void DoRun (void);
+
+private:
+  void Round (uint32_t n);
+};
+
+EventAllocatorSimulatorTestCase::EventAllocatorSimulatorTestCase ()
+  : TestCase ("Events are recycled after they run or are cancelled")
+{
+}
+
+void
+EventAllocatorSimulatorTestCase::Round (uint32_t n)
+{
+  std::vector<EventId> cancelled;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Simulator::Schedule (NanoSeconds (i), &Nop);
+      Simulator::Schedule (NanoSeconds (i), &NopWide, i, i, i, i, i);
+      cancelled.push_back (Simulator::Schedule (NanoSeconds (n + i), &Nop));
+    }
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Simulator::Cancel (cancelled[i]);
+    }
+  cancelled.clear ();
+  Simulator::Run ();
+}
+
+void
+EventAllocatorSimulatorTestCase::DoRun (void)
+{
+  const uint32_t n = 2000;
+  EventAllocator::Stats s0 = EventAllocator::GetStats ();
+  Round (n);
+  EventAllocator::Stats s1 = EventAllocator::GetStats ();
+  NS_TEST_ASSERT_MSG_EQ ((s1.allocations - s0.allocations >= 3 * n), true, "events not from the pool");
+  Round (n);
+  EventAllocator::Stats s2 = EventAllocator::GetStats ();
+  NS_TEST_ASSERT_MSG_EQ ((s2.allocations - s1.allocations >= 3 * n), true, "events not from the pool");
+  NS_TEST_ASSERT_MSG_EQ (s2.chunks, s1.chunks, "second round took new chunks");
+  NS_TEST_ASSERT_MSG_EQ ((s2.recycled - s1.recycled >= 3 * n), true, "events not recycled");
+  Simulator::Destroy ();
+}
+
+/**
+ * Free lists and counters are per thread; a block freed by another thread joins
+ * that thread's free list.
+ */
+class EventAllocatorThreadTestCase : public TestCase
+{
+public:
+  EventAllocatorThreadTestCase ();
+  virtual void DoRun (void);
+};
+
+EventAllocatorThreadTestCase::EventAllocatorThreadTestCase ()
+  : TestCase ("Per-thread free lists")
+{
+}
+
+void
+EventAllocatorThreadTestCase::DoRun (void)
+{
+  const std::size_t size = 100;
+  void *fromThread = 0;
+  EventAllocator::Stats threadStats;
+  std::thread t ([&] () {
+    fromThread = EventAllocator::Allocate (size);
+    threadStats = EventAllocator::GetStats ();
+  });
+  t.join ();
+  NS_TEST_ASSERT_MSG_EQ (threadStats.allocations, 1, "counters shared between threads");
+  NS_TEST_ASSERT_MSG_EQ (threadStats.chunks, 1, "free list shared between threads");
+
+  EventAllocator::Stats s0 = EventAllocator::GetStats ();
+  EventAllocator::Deallocate (fromThread, size);
+  void *p = EventAllocator::Allocate (size);
+  NS_TEST_ASSERT_MSG_EQ (p, fromThread, "block freed here not on this thread's free list");
+  EventAllocator::Stats s1 = EventAllocator::GetStats ();
+  NS_TEST_ASSERT_MSG_EQ (s1.recycled - s0.recycled, 1, "recycled count");
+  EventAllocator::Deallocate (p, size);
+}
+
+class EventAllocatorTestSuite : public TestSuite
+{
+public:
+  EventAllocatorTestSuite ();
+};
+
+EventAllocatorTestSuite::EventAllocatorTestSuite ()
+  : TestSuite ("event-allocator", UNIT)
+{
+  AddTestCase (new EventAllocatorBlockTestCase);
+  AddTestCase (new EventAllocatorSimulatorTestCase);
+  AddTestCase (new EventAllocatorThreadTestCase);
+}
+
+static EventAllocatorTestSuite g_eventAllocatorTestSuite;
+
+} // namespace ns3
@@ -23,6 +23,8 @@
 #include "ns3/flow-monitor.h"
 #include "ns3/ipv4-flow-classifier.h"
 #include "ns3/ipv4-flow-probe.h"
+#include "ns3/rdma-flow-classifier.h"
+#include "ns3/qbb-flow-probe.h"
 #include "ns3/ipv4-l3-protocol.h"
 #include "ns3/node.h"
 #include "ns3/node-list.h"
@@ -107,4 +109,35 @@ FlowMonitorHelper::InstallAll ()
 }
 
 
+Ptr<RdmaFlowClassifier>
+FlowMonitorHelper::GetRdmaClassifier ()
+{
+  if (!m_rdmaClassifier)
+    {
+      m_rdmaClassifier = Create<RdmaFlowClassifier> ();
+    }
+  return m_rdmaClassifier;
+}
+
+
+Ptr<FlowMonitor>
+FlowMonitorHelper::InstallQbb (NodeContainer nodes)
+{
+  Ptr<FlowMonitor> monitor = GetMonitor ();
+  Ptr<RdmaFlowClassifier> classifier = GetRdmaClassifier ();
+  monitor->SetFlowClassifier (classifier);
+  for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); ++i)
+    {
+      Create<QbbFlowProbe> (monitor, classifier, *i);
+    }
+  return m_flowMonitor;
+}
+
+Ptr<FlowMonitor>
+FlowMonitorHelper::InstallQbbAll ()
+{
+  return InstallQbb (NodeContainer::GetGlobal ());
+}
+
+
 } // namespace ns3
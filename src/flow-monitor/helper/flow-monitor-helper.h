@@ -30,6 +30,7 @@ namespace ns3 {
 
 class AttributeValue;
 class Ipv4FlowClassifier;
+class RdmaFlowClassifier;
 
 /// \brief Helper to enable IPv4 flow monitoring on a set of Nodes
 class FlowMonitorHelper
@@ -51,6 +52,17 @@ public:
   /// \brief Enable flow monitoring on all nodes
   Ptr<FlowMonitor> InstallAll ();
 
+  /// \brief Enable RDMA flow monitoring on the QbbNetDevices of a set of nodes
+  /// (NICs and switches).  The monitor then classifies with the
+  /// RdmaFlowClassifier; do not mix with the IPv4 Install* methods.
+  Ptr<FlowMonitor> InstallQbb (NodeContainer nodes);
+  /// \brief Enable RDMA flow monitoring on all nodes
+  Ptr<FlowMonitor> InstallQbbAll ();
+
+  /// \brief Retrieve the RdmaFlowClassifier used by the InstallQbb* methods,
+  /// e.g. to set its sampling rate before installing
+  Ptr<RdmaFlowClassifier> GetRdmaClassifier ();
+
   /// \brief Retrieve the FlowMonitor object created by the Install* methods
   Ptr<FlowMonitor> GetMonitor ();
 
@@ -61,6 +73,7 @@ private:
   ObjectFactory m_monitorFactory;
   Ptr<FlowMonitor> m_flowMonitor;
   Ptr<FlowClassifier> m_flowClassifier;
+  Ptr<RdmaFlowClassifier> m_rdmaClassifier;
 };
 
 } // namespace ns3
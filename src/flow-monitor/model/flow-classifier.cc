@@ -38,6 +38,17 @@ FlowClassifier::GetNewFlowId ()
   return ++m_lastNewFlowId;
 }
 
+void
+FlowClassifier::SerializeFlows (StatsImage &image) const
+{
+}
+
+bool
+FlowClassifier::MergeFlows (StatsImage &image)
+{
+  return false;  // flow ids are assigned in the order flows are seen, which differs per rank
+}
+
 
 } // namespace ns3
 
@@ -22,6 +22,7 @@
 #define FLOW_CLASSIFIER_H
 
 #include "ns3/simple-ref-count.h"
+#include "ns3/stats-image.h"
 #include <ostream>
 
 namespace ns3 {
@@ -54,6 +55,14 @@ public:
 
   virtual void SerializeToXmlStream (std::ostream &os, int indent) const = 0;
 
+  /// Write the flows known to this classifier to \p image, to merge them
+  /// into the classifier of another rank of a distributed simulation.
+  /// Only classifiers whose flow ids are the same on every rank support it.
+  virtual void SerializeFlows (StatsImage &image) const;
+  /// Add the flows of an image written by SerializeFlows
+  /// \returns false if the image is malformed or merging is not supported
+  virtual bool MergeFlows (StatsImage &image);
+
 protected:
   FlowId GetNewFlowId ();
 
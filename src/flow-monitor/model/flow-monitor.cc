@@ -272,6 +272,179 @@ FlowMonitor::GetFlowStats () const
   return m_flowStats;
 }
 
+bool
+FlowMonitor::ReleasePacket (FlowId flowId, FlowPacketId packetId, Time &firstSeenTime, uint32_t &timesForwarded)
+{
+  TrackedPacketMap::iterator tracked = m_trackedPackets.find (std::make_pair (flowId, packetId));
+  if (tracked == m_trackedPackets.end ())
+    {
+      return false;
+    }
+  firstSeenTime = tracked->second.firstSeenTime;
+  timesForwarded = tracked->second.timesForwarded;
+  NS_LOG_DEBUG ("ReleasePacket: removing tracked packet (flowId="
+                << flowId << ", packetId=" << packetId << ").");
+  m_trackedPackets.erase (tracked);
+  return true;
+}
+
+void
+FlowMonitor::AdoptPacket (FlowId flowId, FlowPacketId packetId, Time firstSeenTime, uint32_t timesForwarded)
+{
+  if (!m_enabled)
+    {
+      return;
+    }
+  std::pair<TrackedPacketMap::iterator, bool> insert =
+    m_trackedPackets.insert (std::make_pair (std::make_pair (flowId, packetId), TrackedPacket ()));
+  if (!insert.second)
+    {
+      return;  // already seen on this rank, e.g. by the switch it entered
+    }
+  insert.first->second.firstSeenTime = firstSeenTime;
+  insert.first->second.lastSeenTime = Simulator::Now ();
+  insert.first->second.timesForwarded = timesForwarded;
+  GetStatsForFlow (flowId);  // CheckForLostPackets expects the flow to exist
+  NS_LOG_DEBUG ("AdoptPacket: adding tracked packet (flowId=" << flowId << ", packetId=" << packetId
+                                                              << ").");
+}
+
+void
+FlowMonitor::SerializeStats (StatsImage &image) const
+{
+  image.Put<uint32_t> (m_flowStats.size ());
+  for (std::map<FlowId, FlowStats>::const_iterator iter = m_flowStats.begin ();
+       iter != m_flowStats.end (); iter++)
+    {
+      const FlowStats &flow = iter->second;
+      image.Put<uint32_t> (iter->first);
+      image.PutTime (flow.timeFirstTxPacket);
+      image.PutTime (flow.timeFirstRxPacket);
+      image.PutTime (flow.timeLastTxPacket);
+      image.PutTime (flow.timeLastRxPacket);
+      image.PutTime (flow.delaySum);
+      image.PutTime (flow.jitterSum);
+      image.PutTime (flow.lastDelay);
+      image.Put<uint64_t> (flow.txBytes);
+      image.Put<uint64_t> (flow.rxBytes);
+      image.Put<uint32_t> (flow.txPackets);
+      image.Put<uint32_t> (flow.rxPackets);
+      image.Put<uint32_t> (flow.lostPackets);
+      image.Put<uint32_t> (flow.timesForwarded);
+      flow.delayHistogram.Serialize (image);
+      flow.jitterHistogram.Serialize (image);
+      flow.packetSizeHistogram.Serialize (image);
+      flow.flowInterruptionsHistogram.Serialize (image);
+      image.Put<uint32_t> (flow.packetsDropped.size ());
+      for (uint32_t i = 0; i < flow.packetsDropped.size (); i++)
+        {
+          image.Put<uint32_t> (flow.packetsDropped[i]);
+          image.Put<uint64_t> (flow.bytesDropped[i]);
+        }
+    }
+  m_classifier->SerializeFlows (image);
+  image.Put<uint32_t> (m_flowProbes.size ());
+  for (uint32_t i = 0; i < m_flowProbes.size (); i++)
+    {
+      m_flowProbes[i]->SerializeStats (image);
+    }
+}
+
+bool
+FlowMonitor::MergeStats (StatsImage &image)
+{
+  uint32_t nFlows = 0;
+  if (!image.Get (nFlows))
+    {
+      return false;
+    }
+  for (uint32_t n = 0; n < nFlows; n++)
+    {
+      uint32_t flowId = 0;
+      FlowStats other;
+      uint32_t nReasons = 0;
+      if (!image.Get (flowId))
+        {
+          return false;
+        }
+      FlowStats &flow = GetStatsForFlow (flowId);
+      if (!image.GetTime (other.timeFirstTxPacket) || !image.GetTime (other.timeFirstRxPacket)
+          || !image.GetTime (other.timeLastTxPacket) || !image.GetTime (other.timeLastRxPacket)
+          || !image.GetTime (other.delaySum) || !image.GetTime (other.jitterSum)
+          || !image.GetTime (other.lastDelay) || !image.Get (other.txBytes) || !image.Get (other.rxBytes)
+          || !image.Get (other.txPackets) || !image.Get (other.rxPackets)
+          || !image.Get (other.lostPackets) || !image.Get (other.timesForwarded)
+          || !flow.delayHistogram.MergeSerialized (image) || !flow.jitterHistogram.MergeSerialized (image)
+          || !flow.packetSizeHistogram.MergeSerialized (image)
+          || !flow.flowInterruptionsHistogram.MergeSerialized (image) || !image.Get (nReasons))
+        {
+          return false;
+        }
+      // the times of a side are only valid if it saw packets
+      if (other.txPackets > 0)
+        {
+          if (flow.txPackets == 0 || other.timeFirstTxPacket < flow.timeFirstTxPacket)
+            {
+              flow.timeFirstTxPacket = other.timeFirstTxPacket;
+            }
+          if (flow.txPackets == 0 || other.timeLastTxPacket > flow.timeLastTxPacket)
+            {
+              flow.timeLastTxPacket = other.timeLastTxPacket;
+            }
+        }
+      if (other.rxPackets > 0)
+        {
+          if (flow.rxPackets == 0 || other.timeFirstRxPacket < flow.timeFirstRxPacket)
+            {
+              flow.timeFirstRxPacket = other.timeFirstRxPacket;
+            }
+          if (flow.rxPackets == 0 || other.timeLastRxPacket > flow.timeLastRxPacket)
+            {
+              flow.timeLastRxPacket = other.timeLastRxPacket;
+              flow.lastDelay = other.lastDelay;
+            }
+        }
+      flow.delaySum += other.delaySum;
+      flow.jitterSum += other.jitterSum;
+      flow.txBytes += other.txBytes;
+      flow.rxBytes += other.rxBytes;
+      flow.txPackets += other.txPackets;
+      flow.rxPackets += other.rxPackets;
+      flow.lostPackets += other.lostPackets;
+      flow.timesForwarded += other.timesForwarded;
+      if (flow.packetsDropped.size () < nReasons)
+        {
+          flow.packetsDropped.resize (nReasons, 0);
+          flow.bytesDropped.resize (nReasons, 0);
+        }
+      for (uint32_t i = 0; i < nReasons; i++)
+        {
+          uint32_t dropped = 0;
+          uint64_t droppedBytes = 0;
+          if (!image.Get (dropped) || !image.Get (droppedBytes))
+            {
+              return false;
+            }
+          flow.packetsDropped[i] += dropped;
+          flow.bytesDropped[i] += droppedBytes;
+        }
+    }
+
+  uint32_t nProbes = 0;
+  if (!m_classifier->MergeFlows (image) || !image.Get (nProbes) || nProbes != m_flowProbes.size ())
+    {
+      return false;
+    }
+  for (uint32_t i = 0; i < nProbes; i++)
+    {
+      if (!m_flowProbes[i]->MergeStats (image))
+        {
+          return false;
+        }
+    }
+  return image.IsAtEnd ();
+}
+
 
 void
 FlowMonitor::CheckForLostPackets (Time maxDelay)
@@ -29,6 +29,7 @@
 #include "ns3/flow-probe.h"
 #include "ns3/flow-classifier.h"
 #include "ns3/histogram.h"
+#include "ns3/stats-image.h"
 #include "ns3/nstime.h"
 #include "ns3/event-id.h"
 
@@ -183,6 +184,24 @@ public:
   /// Get a list of all FlowProbe's associated with this FlowMonitor
   std::vector< Ptr<FlowProbe> > GetAllProbes () const;
 
+  // --- methods for distributed simulations ---
+  /// Stop tracking a packet that leaves for another rank.  The packet is
+  /// then tracked by the FlowMonitor of that rank (see AdoptPacket).
+  /// \param firstSeenTime receives the time the packet was first seen
+  /// \param timesForwarded receives the number of times it was forwarded
+  /// \returns false if the packet is not tracked
+  bool ReleasePacket (FlowId flowId, FlowPacketId packetId, Time &firstSeenTime, uint32_t &timesForwarded);
+  /// Start tracking a packet released by the FlowMonitor of another rank
+  void AdoptPacket (FlowId flowId, FlowPacketId packetId, Time firstSeenTime, uint32_t timesForwarded);
+  /// Write the flow and probe statistics to \p image, to merge them into
+  /// the FlowMonitor of another rank.  Call CheckForLostPackets() first.
+  void SerializeStats (StatsImage &image) const;
+  /// Add the statistics of an image written by SerializeStats on another
+  /// rank.  The probes must have been installed in the same order on
+  /// every rank, and the classifier must support MergeFlows.
+  /// \returns false if the image is malformed or does not match
+  bool MergeStats (StatsImage &image);
+
   /// Serializes the results to an std::ostream in XML format
   /// \param os the output stream
   /// \param indent number of spaces to use as base indentation level
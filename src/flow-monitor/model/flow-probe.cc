@@ -64,6 +64,67 @@ FlowProbe::GetStats () const
   return m_stats;
 }
 
+void
+FlowProbe::SerializeStats (StatsImage &image) const
+{
+  image.Put<uint32_t> (m_stats.size ());
+  for (Stats::const_iterator iter = m_stats.begin (); iter != m_stats.end (); iter++)
+    {
+      image.Put<uint32_t> (iter->first);
+      image.PutTime (iter->second.delayFromFirstProbeSum);
+      image.Put<uint64_t> (iter->second.bytes);
+      image.Put<uint32_t> (iter->second.packets);
+      image.Put<uint32_t> (iter->second.packetsDropped.size ());
+      for (uint32_t i = 0; i < iter->second.packetsDropped.size (); i++)
+        {
+          image.Put<uint32_t> (iter->second.packetsDropped[i]);
+          image.Put<uint64_t> (iter->second.bytesDropped[i]);
+        }
+    }
+}
+
+bool
+FlowProbe::MergeStats (StatsImage &image)
+{
+  uint32_t nFlows = 0;
+  if (!image.Get (nFlows))
+    {
+      return false;
+    }
+  for (uint32_t n = 0; n < nFlows; n++)
+    {
+      uint32_t flowId = 0, packets = 0, nReasons = 0;
+      uint64_t bytes = 0;
+      Time delaySum;
+      if (!image.Get (flowId) || !image.GetTime (delaySum) || !image.Get (bytes)
+          || !image.Get (packets) || !image.Get (nReasons))
+        {
+          return false;
+        }
+      FlowStats &flow = m_stats[flowId];
+      flow.delayFromFirstProbeSum += delaySum;
+      flow.bytes += bytes;
+      flow.packets += packets;
+      if (flow.packetsDropped.size () < nReasons)
+        {
+          flow.packetsDropped.resize (nReasons, 0);
+          flow.bytesDropped.resize (nReasons, 0);
+        }
+      for (uint32_t i = 0; i < nReasons; i++)
+        {
+          uint32_t dropped = 0;
+          uint64_t droppedBytes = 0;
+          if (!image.Get (dropped) || !image.Get (droppedBytes))
+            {
+              return false;
+            }
+          flow.packetsDropped[i] += dropped;
+          flow.bytesDropped[i] += droppedBytes;
+        }
+    }
+  return true;
+}
+
 void
 FlowProbe::SerializeToXmlStream (std::ostream &os, int indent, uint32_t index) const
 {
@@ -27,6 +27,7 @@
 #include "ns3/simple-ref-count.h"
 #include "ns3/flow-classifier.h"
 #include "ns3/nstime.h"
+#include "ns3/stats-image.h"
 
 namespace ns3 {
 
@@ -76,7 +77,14 @@ public:
   /// from the first probe to this one.
   Stats GetStats () const;
 
-  void SerializeToXmlStream (std::ostream &os, int indent, uint32_t index) const;
+  virtual void SerializeToXmlStream (std::ostream &os, int indent, uint32_t index) const;
+
+  /// Write the statistics of this probe to \p image, to merge them into
+  /// the same probe of another rank of a distributed simulation
+  virtual void SerializeStats (StatsImage &image) const;
+  /// Add the statistics of an image written by SerializeStats
+  /// \returns false if the image is malformed
+  virtual bool MergeStats (StatsImage &image);
 
 protected:
   Ptr<FlowMonitor> m_flowMonitor;
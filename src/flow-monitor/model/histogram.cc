@@ -90,6 +90,42 @@ Histogram::AddValue (double value)
   m_histogram[index]++;
 }
 
+void
+Histogram::Serialize (StatsImage &image) const
+{
+  image.Put<double> (m_binWidth);
+  image.Put<uint32_t> (m_histogram.size ());
+  for (uint32_t i = 0; i < m_histogram.size (); i++)
+    {
+      image.Put<uint32_t> (m_histogram[i]);
+    }
+}
+
+bool
+Histogram::MergeSerialized (StatsImage &image)
+{
+  double binWidth = 0;
+  uint32_t nBins = 0;
+  if (!image.Get (binWidth) || !image.Get (nBins) || binWidth != m_binWidth)
+    {
+      return false;
+    }
+  if (nBins > m_histogram.size ())
+    {
+      m_histogram.resize (nBins, 0);
+    }
+  for (uint32_t i = 0; i < nBins; i++)
+    {
+      uint32_t count = 0;
+      if (!image.Get (count))
+        {
+          return false;
+        }
+      m_histogram[i] += count;
+    }
+  return true;
+}
+
 Histogram::Histogram (double binWidth)
 {
   m_binWidth = binWidth;
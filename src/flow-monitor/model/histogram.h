@@ -25,6 +25,8 @@
 #include <stdint.h>
 #include <ostream>
 
+#include "ns3/stats-image.h"
+
 namespace ns3 {
 
 class Histogram
@@ -46,6 +48,10 @@ public:
   // Method for adding values
   void AddValue (double value);
 
+  // Methods for merging the histograms of the ranks of a distributed simulation
+  void Serialize (StatsImage &image) const;
+  bool MergeSerialized (StatsImage &image);  // adds the bins of an image of the same bin width
+
 
   void SerializeToXmlStream (std::ostream &os, int indent, std::string elementName) const;
 
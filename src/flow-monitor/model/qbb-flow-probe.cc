@@ -0,0 +1,374 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation;
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include "qbb-flow-probe.h"
+#include "flow-monitor.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/qbb-net-device.h"
+#include "ns3/qbb-remote-channel.h"
+#include "ns3/rdma-queue-pair.h"
+#include "ns3/tag.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("QbbFlowProbe");
+
+///////////////////////////////////////////
+// QbbFlowHandoverTag class implementation //
+///////////////////////////////////////////
+
+/// What the FlowMonitor of a rank tracked about a packet that continues in
+/// another rank of a distributed simulation (see FlowMonitor::ReleasePacket)
+class QbbFlowHandoverTag : public Tag
+{
+public:
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer buf) const;
+  virtual void Deserialize (TagBuffer buf);
+  virtual void Print (std::ostream &os) const;
+  QbbFlowHandoverTag ();
+
+  Time firstSeenTime;
+  uint32_t timesForwarded;
+};
+
+NS_OBJECT_ENSURE_REGISTERED (QbbFlowHandoverTag);
+
+TypeId
+QbbFlowHandoverTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::QbbFlowHandoverTag")
+    .SetParent<Tag> ()
+    .AddConstructor<QbbFlowHandoverTag> ()
+  ;
+  return tid;
+}
+TypeId
+QbbFlowHandoverTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+uint32_t
+QbbFlowHandoverTag::GetSerializedSize (void) const
+{
+  return 8 + 4;
+}
+void
+QbbFlowHandoverTag::Serialize (TagBuffer buf) const
+{
+  buf.WriteU64 (firstSeenTime.GetTimeStep ());
+  buf.WriteU32 (timesForwarded);
+}
+void
+QbbFlowHandoverTag::Deserialize (TagBuffer buf)
+{
+  firstSeenTime = TimeStep (buf.ReadU64 ());
+  timesForwarded = buf.ReadU32 ();
+}
+void
+QbbFlowHandoverTag::Print (std::ostream &os) const
+{
+  os << "FirstSeen=" << firstSeenTime << " TimesForwarded=" << timesForwarded;
+}
+QbbFlowHandoverTag::QbbFlowHandoverTag ()
+  : Tag (),
+    timesForwarded (0)
+{
+}
+
+///////////////////////////////////////
+// QbbFlowProbe class implementation //
+///////////////////////////////////////
+
+QbbFlowProbe::QbbFlowProbe (Ptr<FlowMonitor> monitor,
+                            Ptr<RdmaFlowClassifier> classifier,
+                            Ptr<Node> node,
+                            double sojournBinWidth)
+  : FlowProbe (monitor),
+    m_classifier (classifier),
+    m_nodeId (node->GetId ()),
+    m_binWidth (sojournBinWidth),
+    m_remote (false)
+{
+  NS_LOG_FUNCTION (this << node->GetId ());
+
+  bool isSwitch = node->GetNodeType () > 0;
+  for (uint32_t i = 0; i < node->GetNDevices (); i++)
+    {
+      Ptr<QbbNetDevice> dev = DynamicCast<QbbNetDevice> (node->GetDevice (i));
+      if (dev == 0)
+        {
+          continue;
+        }
+      PortRecord *port = new PortRecord;
+      port->probe = this;
+      port->dev = dev;
+      port->remote = DynamicCast<QbbRemoteChannel> (dev->GetChannel ()) != 0;
+      m_remote = m_remote || port->remote;
+      m_ports.push_back (port);
+
+      if (isSwitch)
+        {
+          dev->TraceConnectWithoutContext ("QbbEnqueue", MakeBoundCallback (&QbbFlowProbe::EnqueueLogger, port));
+          dev->TraceConnectWithoutContext ("QbbDequeue", MakeBoundCallback (&QbbFlowProbe::DequeueLogger, port));
+        }
+      else
+        {
+          dev->TraceConnectWithoutContext ("RdmaQpDequeue", MakeBoundCallback (&QbbFlowProbe::QpDequeueLogger, port));
+          dev->TraceConnectWithoutContext ("MacRx",
+                                           MakeCallback (&QbbFlowProbe::MacRxLogger, Ptr<QbbFlowProbe> (this)));
+        }
+      dev->TraceConnectWithoutContext ("QbbDrop", MakeBoundCallback (&QbbFlowProbe::DropLogger, port));
+    }
+}
+
+QbbFlowProbe::~QbbFlowProbe ()
+{
+  for (uint32_t i = 0; i < m_ports.size (); i++)
+    {
+      delete m_ports[i];
+    }
+}
+
+const QbbFlowProbe::HopStatsContainer&
+QbbFlowProbe::GetHopStats () const
+{
+  return m_hopStats;
+}
+
+void
+QbbFlowProbe::QpDequeueLogger (PortRecord *port, Ptr<const Packet> p, Ptr<RdmaQueuePair> qp)
+{
+  FlowId flowId;
+  FlowPacketId packetId;
+  QbbFlowProbe *probe = port->probe;
+  if (probe->m_classifier->Classify (p, &flowId, &packetId))
+    {
+      probe->m_flowMonitor->ReportFirstTx (probe, flowId, packetId, p->GetSize ());
+      if (port->remote)
+        {
+          probe->HandOver (p, flowId);
+        }
+    }
+}
+
+void
+QbbFlowProbe::MacRxLogger (Ptr<const Packet> p)
+{
+  FlowId flowId;
+  FlowPacketId packetId;
+  if (m_classifier->Classify (p, &flowId, &packetId))
+    {
+      if (m_remote)
+        {
+          TakeOver (p, flowId);
+        }
+      m_flowMonitor->ReportLastRx (this, flowId, packetId, p->GetSize ());
+    }
+}
+
+void
+QbbFlowProbe::HandOver (Ptr<const Packet> p, FlowId flowId)
+{
+  QbbFlowHandoverTag tag;
+  if (m_flowMonitor->ReleasePacket (flowId, p->GetUid (), tag.firstSeenTime, tag.timesForwarded))
+    {
+      p->AddPacketTag (tag);  // a packet crossing again carries the latest tag first
+    }
+}
+
+void
+QbbFlowProbe::TakeOver (Ptr<const Packet> p, FlowId flowId)
+{
+  QbbFlowHandoverTag tag;
+  if (p->PeekPacketTag (tag))
+    {
+      m_flowMonitor->AdoptPacket (flowId, p->GetUid (), tag.firstSeenTime, tag.timesForwarded);
+    }
+}
+
+void
+QbbFlowProbe::EnqueueLogger (PortRecord *port, Ptr<const Packet> p, uint32_t qIndex)
+{
+  FlowId flowId;
+  FlowPacketId packetId;
+  if (!port->probe->m_classifier->Classify (p, &flowId, &packetId))
+    {
+      return;
+    }
+  if (port->probe->m_remote)
+    {
+      port->probe->TakeOver (p, flowId);
+    }
+  Time now = Simulator::Now ();
+  InFlight &rec = port->inFlight[p->GetUid ()];
+  rec.flowId = flowId;
+  rec.enqueued = now;
+  rec.pausedAtEnqueue = port->dev->GetPfcState ().GetPausedTime (qIndex, now);
+}
+
+void
+QbbFlowProbe::DequeueLogger (PortRecord *port, Ptr<const Packet> p, uint32_t qIndex)
+{
+  std::unordered_map<uint64_t, InFlight>::iterator it = port->inFlight.find (p->GetUid ());
+  if (it == port->inFlight.end ())
+    {
+      return;  // not a sampled data packet
+    }
+  QbbFlowProbe *probe = port->probe;
+  Time now = Simulator::Now ();
+  FlowId flowId = it->second.flowId;
+  Time sojourn = now - it->second.enqueued;
+  Time blocked = port->dev->GetPfcState ().GetPausedTime (qIndex, now) - it->second.pausedAtEnqueue;
+  port->inFlight.erase (it);
+
+  HopStatsContainer::iterator hs = probe->m_hopStats.find (flowId);
+  if (hs == probe->m_hopStats.end ())
+    {
+      hs = probe->m_hopStats.insert (std::make_pair (flowId, HopStats (probe->m_binWidth))).first;
+    }
+  hs->second.sojourn.AddValue (sojourn.GetSeconds ());
+  hs->second.sojournSum += sojourn;
+  hs->second.pfcBlockedSum += blocked;
+  hs->second.packets++;
+
+  probe->m_flowMonitor->ReportForwarding (probe, flowId, (FlowPacketId) p->GetUid (), p->GetSize ());
+  if (port->remote)
+    {
+      probe->HandOver (p, flowId);
+    }
+}
+
+void
+QbbFlowProbe::DropLogger (PortRecord *port, Ptr<const Packet> p, uint32_t qIndex)
+{
+  FlowId flowId;
+  FlowPacketId packetId;
+  if (!port->probe->m_classifier->Classify (p, &flowId, &packetId))
+    {
+      return;
+    }
+  port->inFlight.erase (p->GetUid ());
+  port->probe->m_flowMonitor->ReportDrop (port->probe, flowId, packetId, p->GetSize (), DROP_LINK_DOWN);
+}
+
+void
+QbbFlowProbe::SerializeStats (StatsImage &image) const
+{
+  FlowProbe::SerializeStats (image);
+  image.Put<uint32_t> (m_hopStats.size ());
+  for (HopStatsContainer::const_iterator hs = m_hopStats.begin (); hs != m_hopStats.end (); hs++)
+    {
+      image.Put<uint32_t> (hs->first);
+      hs->second.sojourn.Serialize (image);
+      image.PutTime (hs->second.sojournSum);
+      image.PutTime (hs->second.pfcBlockedSum);
+      image.Put<uint32_t> (hs->second.packets);
+    }
+}
+
+bool
+QbbFlowProbe::MergeStats (StatsImage &image)
+{
+  uint32_t nFlows = 0;
+  if (!FlowProbe::MergeStats (image) || !image.Get (nFlows))
+    {
+      return false;
+    }
+  for (uint32_t n = 0; n < nFlows; n++)
+    {
+      uint32_t flowId = 0, packets = 0;
+      Time sojournSum, pfcBlockedSum;
+      if (!image.Get (flowId))
+        {
+          return false;
+        }
+      HopStatsContainer::iterator hs = m_hopStats.find (flowId);
+      if (hs == m_hopStats.end ())
+        {
+          hs = m_hopStats.insert (std::make_pair (flowId, HopStats (m_binWidth))).first;
+        }
+      if (!hs->second.sojourn.MergeSerialized (image) || !image.GetTime (sojournSum)
+          || !image.GetTime (pfcBlockedSum) || !image.Get (packets))
+        {
+          return false;
+        }
+      hs->second.sojournSum += sojournSum;
+      hs->second.pfcBlockedSum += pfcBlockedSum;
+      hs->second.packets += packets;
+    }
+  return true;
+}
+
+void
+QbbFlowProbe::SerializeToXmlStream (std::ostream &os, int indent, uint32_t index) const
+{
+  #define INDENT(level) for (int __xpto = 0; __xpto < level; __xpto++) os << ' ';
+
+  INDENT (indent); os << "<FlowProbe index=\"" << index << "\" nodeId=\"" << m_nodeId << "\">\n";
+
+  indent += 2;
+
+  for (Stats::const_iterator iter = m_stats.begin (); iter != m_stats.end (); iter++)
+    {
+      INDENT (indent);
+      os << "<FlowStats "
+         << " flowId=\"" << iter->first << "\""
+         << " packets=\"" << iter->second.packets << "\""
+         << " bytes=\"" << iter->second.bytes << "\""
+         << " delayFromFirstProbeSum=\"" << iter->second.delayFromFirstProbeSum << "\"";
+      HopStatsContainer::const_iterator hs = m_hopStats.find (iter->first);
+      if (hs != m_hopStats.end ())
+        {
+          os << " sojournSum=\"" << hs->second.sojournSum << "\""
+             << " pfcBlockedSum=\"" << hs->second.pfcBlockedSum << "\"";
+        }
+      os << " >\n";
+      indent += 2;
+      for (uint32_t reasonCode = 0; reasonCode < iter->second.packetsDropped.size (); reasonCode++)
+        {
+          INDENT (indent);
+          os << "<packetsDropped reasonCode=\"" << reasonCode << "\""
+             << " number=\"" << iter->second.packetsDropped[reasonCode]
+             << "\" />\n";
+        }
+      for (uint32_t reasonCode = 0; reasonCode < iter->second.bytesDropped.size (); reasonCode++)
+        {
+          INDENT (indent);
+          os << "<bytesDropped reasonCode=\"" << reasonCode << "\""
+             << " bytes=\"" << iter->second.bytesDropped[reasonCode]
+             << "\" />\n";
+        }
+      if (hs != m_hopStats.end ())
+        {
+          hs->second.sojourn.SerializeToXmlStream (os, indent, "sojournHistogram");
+        }
+      indent -= 2;
+      INDENT (indent); os << "</FlowStats>\n";
+    }
+  indent -= 2;
+  INDENT (indent); os << "</FlowProbe>\n";
+
+  #undef INDENT
+}
+
+
+} // namespace ns3
@@ -0,0 +1,160 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation;
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include "rdma-flow-classifier.h"
+#include "ns3/packet.h"
+#include "ns3/custom-header.h"
+#include "ns3/flow-id-num-tag.h"
+#include "ns3/assert.h"
+
+namespace ns3 {
+
+RdmaFlowClassifier::RdmaFlowClassifier ()
+  : m_samplingRate (1)
+{
+}
+
+void
+RdmaFlowClassifier::SetSamplingRate (uint32_t n)
+{
+  m_samplingRate = n > 0 ? n : 1;
+}
+
+uint32_t
+RdmaFlowClassifier::GetSamplingRate (void) const
+{
+  return m_samplingRate;
+}
+
+bool
+RdmaFlowClassifier::Classify (Ptr<const Packet> p, FlowId *out_flowId, FlowPacketId *out_packetId)
+{
+  if (CustomHeader::PeekL3Prot (p) != 0x11)
+    {
+      return false;  // not a data packet
+    }
+  FlowIDNUMTag tag;
+  if (!p->PeekPacketTag (tag))
+    {
+      return false;
+    }
+  int32_t id = tag.GetId ();
+  if (id < 0 || (uint32_t) id % m_samplingRate != 0)
+    {
+      return false;
+    }
+
+  FlowId flowId = (FlowId) id + 1;  // the same on every rank of a distributed simulation
+  std::pair<std::map<FlowId, FlowInfo>::iterator, bool> insert
+    = m_flows.insert (std::pair<FlowId, FlowInfo> (flowId, FlowInfo ()));
+  if (insert.second)
+    {
+      CustomHeader ch (CustomHeader::L2_Header | CustomHeader::L3_Header | CustomHeader::L4_Header);
+      p->PeekHeader (ch);
+      FlowInfo &info = insert.first->second;
+      info.tag = id;
+      info.flowSize = tag.GetFlowSize ();
+      info.sourceAddress = Ipv4Address (ch.sip);
+      info.destinationAddress = Ipv4Address (ch.dip);
+      info.sourcePort = ch.udp.sport;
+      info.destinationPort = ch.udp.dport;
+    }
+
+  *out_flowId = flowId;
+  *out_packetId = p->GetUid ();
+  return true;
+}
+
+RdmaFlowClassifier::FlowInfo
+RdmaFlowClassifier::FindFlow (FlowId flowId) const
+{
+  std::map<FlowId, FlowInfo>::const_iterator iter = m_flows.find (flowId);
+  NS_ASSERT_MSG (iter != m_flows.end (), "could not find the flow " << flowId);
+  return iter->second;
+}
+
+void
+RdmaFlowClassifier::SerializeFlows (StatsImage &image) const
+{
+  image.Put<uint32_t> (m_flows.size ());
+  for (std::map<FlowId, FlowInfo>::const_iterator
+       iter = m_flows.begin (); iter != m_flows.end (); iter++)
+    {
+      image.Put<uint32_t> (iter->first);
+      image.Put<int32_t> (iter->second.tag);
+      image.Put<uint32_t> (iter->second.flowSize);
+      image.Put<uint32_t> (iter->second.sourceAddress.Get ());
+      image.Put<uint32_t> (iter->second.destinationAddress.Get ());
+      image.Put<uint16_t> (iter->second.sourcePort);
+      image.Put<uint16_t> (iter->second.destinationPort);
+    }
+}
+
+bool
+RdmaFlowClassifier::MergeFlows (StatsImage &image)
+{
+  uint32_t nFlows = 0;
+  if (!image.Get (nFlows))
+    {
+      return false;
+    }
+  for (uint32_t n = 0; n < nFlows; n++)
+    {
+      uint32_t flowId = 0, sip = 0, dip = 0;
+      FlowInfo info;
+      if (!image.Get (flowId) || !image.Get (info.tag) || !image.Get (info.flowSize)
+          || !image.Get (sip) || !image.Get (dip)
+          || !image.Get (info.sourcePort) || !image.Get (info.destinationPort))
+        {
+          return false;
+        }
+      info.sourceAddress = Ipv4Address (sip);
+      info.destinationAddress = Ipv4Address (dip);
+      m_flows.insert (std::pair<FlowId, FlowInfo> (flowId, info));
+    }
+  return true;
+}
+
+void
+RdmaFlowClassifier::SerializeToXmlStream (std::ostream &os, int indent) const
+{
+#define INDENT(level) for (int __xpto = 0; __xpto < level; __xpto++) os << ' ';
+
+  INDENT (indent); os << "<RdmaFlowClassifier samplingRate=\"" << m_samplingRate << "\">\n";
+
+  indent += 2;
+  for (std::map<FlowId, FlowInfo>::const_iterator
+       iter = m_flows.begin (); iter != m_flows.end (); iter++)
+    {
+      INDENT (indent);
+      os << "<Flow flowId=\"" << iter->first << "\""
+         << " flowTag=\"" << iter->second.tag << "\""
+         << " flowSize=\"" << iter->second.flowSize << "\""
+         << " sourceAddress=\"" << iter->second.sourceAddress << "\""
+         << " destinationAddress=\"" << iter->second.destinationAddress << "\""
+         << " sourcePort=\"" << iter->second.sourcePort << "\""
+         << " destinationPort=\"" << iter->second.destinationPort << "\""
+         << " />\n";
+    }
+
+  indent -= 2;
+  INDENT (indent); os << "</RdmaFlowClassifier>\n";
+
+#undef INDENT
+}
+
+
+} // namespace ns3
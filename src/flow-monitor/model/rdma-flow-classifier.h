@@ -0,0 +1,86 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation;
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#ifndef RDMA_FLOW_CLASSIFIER_H
+#define RDMA_FLOW_CLASSIFIER_H
+
+#include <stdint.h>
+#include <map>
+
+#include "ns3/ipv4-address.h"
+#include "ns3/flow-classifier.h"
+#include "ns3/ptr.h"
+
+namespace ns3 {
+
+class Packet;
+
+/// Classifies the RDMA data packets of the Qbb devices by their
+/// FlowIDNUMTag, which every QP stamps on its packets. The Qbb/RDMA path
+/// bypasses the IPv4 stack, so Ipv4FlowClassifier never sees them.
+///
+/// Only data packets (UDP) are classified; ACK/NACK/CNP carry the tag of
+/// their flow too, but belong to the reverse direction. The flow id is the
+/// tag plus one, so that it is the same on every rank of a distributed
+/// simulation and the ranks can merge their flows. The packet id is
+/// the packet uid, which stays the same across hops and is new for a
+/// retransmitted packet.
+///
+/// With a sampling rate N > 1 only the flows whose tag is a multiple of N
+/// are monitored; the other packets are rejected before any lookup.
+class RdmaFlowClassifier : public FlowClassifier
+{
+public:
+
+  struct FlowInfo
+  {
+    int32_t tag;        ///< FlowIDNUMTag id
+    uint32_t flowSize;  ///< bytes, from the tag
+    Ipv4Address sourceAddress;
+    Ipv4Address destinationAddress;
+    uint16_t sourcePort;
+    uint16_t destinationPort;
+  };
+
+  RdmaFlowClassifier ();
+
+  /// \brief monitor one flow out of every n (by tag); 1 monitors all flows
+  void SetSamplingRate (uint32_t n);
+  uint32_t GetSamplingRate (void) const;
+
+  /// \brief try to classify a Qbb frame (PPP + IPv4 + L4) into flow-id
+  /// and packet-id
+  /// \return true if the packet is a data packet of a monitored flow
+  bool Classify (Ptr<const Packet> p, FlowId *out_flowId, FlowPacketId *out_packetId);
+
+  /// Searches for the flow information of the given flowId
+  FlowInfo FindFlow (FlowId flowId) const;
+
+  virtual void SerializeToXmlStream (std::ostream &os, int indent) const;
+  virtual void SerializeFlows (StatsImage &image) const;
+  virtual bool MergeFlows (StatsImage &image);
+
+private:
+
+  uint32_t m_samplingRate;
+  std::map<FlowId, FlowInfo> m_flows;
+
+};
+
+
+} // namespace ns3
+
+#endif /* RDMA_FLOW_CLASSIFIER_H */
@@ -0,0 +1,102 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation;
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#ifndef STATS_IMAGE_H
+#define STATS_IMAGE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+/// \brief Flat byte image of monitor statistics.
+///
+/// Moves the FlowMonitor statistics of the ranks of a distributed
+/// simulation to one rank, which merges them (FlowMonitor::SerializeStats,
+/// FlowMonitor::MergeStats). Values are copied in host byte order: all the
+/// ranks run the same binary on the same kind of machine.
+class StatsImage
+{
+public:
+  /// \brief an empty image, to write
+  StatsImage ()
+    : m_read (0),
+      m_end (0)
+  {
+  }
+  /// \brief an image received from another rank, to read
+  StatsImage (const uint8_t *data, uint32_t size)
+    : m_read (data),
+      m_end (data + size)
+  {
+  }
+
+  template <typename T>
+  void Put (T v)
+  {
+    const uint8_t *p = (const uint8_t *) &v;
+    m_buf.insert (m_buf.end (), p, p + sizeof (T));
+  }
+  void PutTime (Time t)
+  {
+    Put<int64_t> (t.GetTimeStep ());
+  }
+
+  /// \returns false, leaving \p v alone, past the end of the image
+  template <typename T>
+  bool Get (T &v)
+  {
+    if (m_end - m_read < (ptrdiff_t) sizeof (T))
+      {
+        m_read = m_end;
+        return false;
+      }
+    memcpy (&v, m_read, sizeof (T));
+    m_read += sizeof (T);
+    return true;
+  }
+  bool GetTime (Time &t)
+  {
+    int64_t step = 0;
+    bool ok = Get (step);
+    t = TimeStep (step);
+    return ok;
+  }
+
+  /// \returns the bytes written
+  const std::vector<uint8_t> &GetData (void) const
+  {
+    return m_buf;
+  }
+  /// \returns whether all the image was read
+  bool IsAtEnd (void) const
+  {
+    return m_read == m_end;
+  }
+
+private:
+  std::vector<uint8_t> m_buf;
+  const uint8_t *m_read;
+  const uint8_t *m_end;
+};
+
+} // namespace ns3
+
+#endif /* STATS_IMAGE_H */
@@ -0,0 +1,300 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation;
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include "ns3/abort.h"
+#include "ns3/flow-id-num-tag.h"
+#include "ns3/flow-monitor.h"
+#include "ns3/flow-probe.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/packet.h"
+#include "ns3/ppp-header.h"
+#include "ns3/rdma-flow-classifier.h"
+#include "ns3/simulator.h"
+#include "ns3/stats-image.h"
+#include "ns3/test.h"
+#include "ns3/udp-header.h"
+
+#include <vector>
+
+namespace ns3 {
+
+namespace {
+
+class TestFlowProbe : public FlowProbe
+{
+public:
+  TestFlowProbe (Ptr<FlowMonitor> monitor)
+    : FlowProbe (monitor)
+  {
+  }
+};
+
+/* the flow monitor of one rank: a sender host, a switch and a receiver host probe */
+struct Rank
+{
+  Rank ()
+  {
+    monitor = CreateObject<FlowMonitor> ();
+    classifier = Create<RdmaFlowClassifier> ();
+    monitor->SetFlowClassifier (classifier);
+    for (uint32_t i = 0; i < 3; i++)
+      {
+        probes.push_back (Create<TestFlowProbe> (monitor));
+      }
+    monitor->StartRightNow ();
+  }
+
+  Ptr<FlowMonitor> monitor;
+  Ptr<RdmaFlowClassifier> classifier;
+  std::vector<Ptr<FlowProbe> > probes;
+};
+
+uint32_t
+PacketSize (uint32_t flow)
+{
+  return 1000 + 10 * flow;
+}
+
+/* a data packet of flow `flow` (FlowIDNUMTag flow - 1, so FlowId flow) as the QPs send it */
+Ptr<Packet>
+BuildData (uint32_t flow)
+{
+  Ptr<Packet> p = Create<Packet> (PacketSize (flow) - 8 - 20 - 2);
+  UdpHeader udp;
+  udp.SetSourcePort (10000 + flow);
+  udp.SetDestinationPort (100);
+  p->AddHeader (udp);
+  Ipv4Header ip;
+  ip.SetSource (Ipv4Address ("11.0.0.1"));
+  ip.SetDestination (Ipv4Address (0x0b000001 + (flow << 8)));
+  ip.SetProtocol (0x11);
+  ip.SetPayloadSize (p->GetSize ());
+  ip.SetTtl (64);
+  p->AddHeader (ip);
+  PppHeader ppp;
+  ppp.SetProtocol (0x0021);
+  p->AddHeader (ppp);
+  FlowIDNUMTag tag;
+  tag.SetId (flow - 1);
+  tag.SetFlowSize (100000 * flow);
+  p->AddPacketTag (tag);
+  return p;
+}
+
+void
+Send (Rank *r, uint32_t flow, uint32_t packetId)
+{
+  FlowId flowId = 0;
+  FlowPacketId unused;
+  bool classified = r->classifier->Classify (BuildData (flow), &flowId, &unused);
+  NS_ABORT_UNLESS (classified && flowId == flow);
+  r->monitor->ReportFirstTx (r->probes[0], flow, packetId, PacketSize (flow));
+}
+
+void
+Forward (Rank *r, uint32_t flow, uint32_t packetId)
+{
+  r->monitor->ReportForwarding (r->probes[1], flow, packetId, PacketSize (flow));
+}
+
+void
+Drop (Rank *r, uint32_t flow, uint32_t packetId)
+{
+  r->monitor->ReportDrop (r->probes[1], flow, packetId, PacketSize (flow), 2);
+}
+
+/* the packet leaves rank `from` over a remote channel (QbbFlowProbe::HandOver) */
+void
+HandOver (Rank *from, Rank *to, uint32_t flow, uint32_t packetId)
+{
+  Time firstSeen;
+  uint32_t timesForwarded = 0;
+  bool released = from->monitor->ReleasePacket (flow, packetId, firstSeen, timesForwarded);
+  NS_ABORT_UNLESS (released);
+  to->monitor->AdoptPacket (flow, packetId, firstSeen, timesForwarded);
+}
+
+void
+Receive (Rank *r, uint32_t flow, uint32_t packetId)
+{
+  r->monitor->ReportLastRx (r->probes[2], flow, packetId, PacketSize (flow));
+}
+
+} // namespace
+
+/**
+ * The statistics of a two-rank run, serialized by each rank and merged into
+ * one monitor, equal those of the same run in one monitor. Flow 1 stays on
+ * rank 0, flow 2 on rank 1, and flow 3 crosses from rank 0 to rank 1 after
+ * the switch. A malformed image is rejected.
+ */
+class FlowMonitorMergeTestCase : public TestCase
+{
+public:
+  FlowMonitorMergeTestCase ();
+  virtual void DoRun (void);
+
+private:
+  void CheckHistogram (Histogram a, Histogram b, const char *what);
+};
+
+FlowMonitorMergeTestCase::FlowMonitorMergeTestCase ()
+  : TestCase ("Merge the statistics of two ranks")
+{
+}
+
+void
+FlowMonitorMergeTestCase::CheckHistogram (Histogram a, Histogram b, const char *what)
+{
+  NS_TEST_EXPECT_MSG_EQ (a.GetNBins (), b.GetNBins (), what << " bins");
+  for (uint32_t i = 0; i < a.GetNBins () && i < b.GetNBins (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (a.GetBinCount (i), b.GetBinCount (i), what << " bin " << i);
+    }
+}
+
+void
+FlowMonitorMergeTestCase::DoRun (void)
+{
+  Rank all, rank0, rank1;
+  for (uint32_t k = 0; k < 6; k++)
+    {
+      for (uint32_t flow = 1; flow <= 3; flow++)
+        {
+          uint32_t id = 100 * flow + k;
+          Rank *src = flow == 2 ? &rank1 : &rank0;
+          Rank *dst = flow == 1 ? &rank0 : &rank1;
+          Time tx = MicroSeconds (10 * k + flow);
+          Time rx = tx + MicroSeconds (3) + NanoSeconds (100 * ((k * flow) % 4));
+          Simulator::Schedule (tx, &Send, &all, flow, id);
+          Simulator::Schedule (tx, &Send, src, flow, id);
+          Simulator::Schedule (tx + MicroSeconds (1), &Forward, &all, flow, id);
+          Simulator::Schedule (tx + MicroSeconds (1), &Forward, src, flow, id);
+          if (flow == 2 && k == 4)
+            {
+              Simulator::Schedule (tx + MicroSeconds (2), &Drop, &all, flow, id);
+              Simulator::Schedule (tx + MicroSeconds (2), &Drop, src, flow, id);
+              continue;
+            }
+          if (src != dst)
+            {
+              Simulator::Schedule (tx + MicroSeconds (2), &HandOver, src, dst, flow, id);
+            }
+          Simulator::Schedule (rx, &Receive, &all, flow, id);
+          Simulator::Schedule (rx, &Receive, dst, flow, id);
+        }
+    }
+  Simulator::Stop (MilliSeconds (1));
+  Simulator::Run ();
+
+  StatsImage image0, image1;
+  rank0.monitor->SerializeStats (image0);
+  rank1.monitor->SerializeStats (image1);
+  Rank merged;
+  StatsImage read0 (&image0.GetData ()[0], image0.GetData ().size ());
+  StatsImage read1 (&image1.GetData ()[0], image1.GetData ().size ());
+  NS_TEST_ASSERT_MSG_EQ (merged.monitor->MergeStats (read0), true, "image of rank 0");
+  NS_TEST_ASSERT_MSG_EQ (merged.monitor->MergeStats (read1), true, "image of rank 1");
+
+  std::map<FlowId, FlowMonitor::FlowStats> want = all.monitor->GetFlowStats ();
+  std::map<FlowId, FlowMonitor::FlowStats> got = merged.monitor->GetFlowStats ();
+  NS_TEST_ASSERT_MSG_EQ (got.size (), 3, "flows");
+  NS_TEST_ASSERT_MSG_EQ (want.size (), 3, "flows in one monitor");
+  for (std::map<FlowId, FlowMonitor::FlowStats>::iterator it = want.begin (); it != want.end (); it++)
+    {
+      const FlowMonitor::FlowStats &a = it->second;
+      FlowMonitor::FlowStats &b = got[it->first];
+      NS_TEST_EXPECT_MSG_EQ (b.timeFirstTxPacket, a.timeFirstTxPacket, "flow " << it->first);
+      NS_TEST_EXPECT_MSG_EQ (b.timeFirstRxPacket, a.timeFirstRxPacket, "flow " << it->first);
+      NS_TEST_EXPECT_MSG_EQ (b.timeLastTxPacket, a.timeLastTxPacket, "flow " << it->first);
+      NS_TEST_EXPECT_MSG_EQ (b.timeLastRxPacket, a.timeLastRxPacket, "flow " << it->first);
+      NS_TEST_EXPECT_MSG_EQ (b.delaySum, a.delaySum, "flow " << it->first);
+      NS_TEST_EXPECT_MSG_EQ (b.jitterSum, a.jitterSum, "flow " << it->first);
+      NS_TEST_EXPECT_MSG_EQ (b.lastDelay, a.lastDelay, "flow " << it->first);
+      NS_TEST_EXPECT_MSG_EQ (b.txBytes, a.txBytes, "flow " << it->first);
+      NS_TEST_EXPECT_MSG_EQ (b.rxBytes, a.rxBytes, "flow " << it->first);
+      NS_TEST_EXPECT_MSG_EQ (b.txPackets, a.txPackets, "flow " << it->first);
+      NS_TEST_EXPECT_MSG_EQ (b.rxPackets, a.rxPackets, "flow " << it->first);
+      NS_TEST_EXPECT_MSG_EQ (b.lostPackets, a.lostPackets, "flow " << it->first);
+      NS_TEST_EXPECT_MSG_EQ (b.timesForwarded, a.timesForwarded, "flow " << it->first);
+      NS_TEST_EXPECT_MSG_EQ ((b.packetsDropped == a.packetsDropped), true, "flow " << it->first);
+      NS_TEST_EXPECT_MSG_EQ ((b.bytesDropped == a.bytesDropped), true, "flow " << it->first);
+      CheckHistogram (a.delayHistogram, b.delayHistogram, "delay");
+      CheckHistogram (a.jitterHistogram, b.jitterHistogram, "jitter");
+      CheckHistogram (a.packetSizeHistogram, b.packetSizeHistogram, "packet size");
+      CheckHistogram (a.flowInterruptionsHistogram, b.flowInterruptionsHistogram, "interruptions");
+
+      RdmaFlowClassifier::FlowInfo fa = all.classifier->FindFlow (it->first);
+      RdmaFlowClassifier::FlowInfo fb = merged.classifier->FindFlow (it->first);
+      NS_TEST_EXPECT_MSG_EQ (fb.tag, fa.tag, "flow " << it->first);
+      NS_TEST_EXPECT_MSG_EQ (fb.flowSize, fa.flowSize, "flow " << it->first);
+      NS_TEST_EXPECT_MSG_EQ (fb.sourceAddress, fa.sourceAddress, "flow " << it->first);
+      NS_TEST_EXPECT_MSG_EQ (fb.destinationAddress, fa.destinationAddress, "flow " << it->first);
+      NS_TEST_EXPECT_MSG_EQ (fb.sourcePort, fa.sourcePort, "flow " << it->first);
+      NS_TEST_EXPECT_MSG_EQ (fb.destinationPort, fa.destinationPort, "flow " << it->first);
+    }
+  NS_TEST_EXPECT_MSG_EQ (want[2].lostPackets, 1, "the dropped packet is counted");
+  NS_TEST_EXPECT_MSG_EQ (want[3].timesForwarded, 6, "flow 3 carries its hops across the ranks");
+
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      FlowProbe::Stats want = all.probes[i]->GetStats ();
+      FlowProbe::Stats got = merged.probes[i]->GetStats ();
+      NS_TEST_EXPECT_MSG_EQ (got.size (), want.size (), "flows of probe " << i);
+      for (FlowProbe::Stats::iterator it = want.begin (); it != want.end (); it++)
+        {
+          const FlowProbe::FlowStats &a = it->second;
+          FlowProbe::FlowStats &b = got[it->first];
+          NS_TEST_EXPECT_MSG_EQ (b.delayFromFirstProbeSum, a.delayFromFirstProbeSum, "probe " << i);
+          NS_TEST_EXPECT_MSG_EQ (b.bytes, a.bytes, "probe " << i);
+          NS_TEST_EXPECT_MSG_EQ (b.packets, a.packets, "probe " << i);
+          NS_TEST_EXPECT_MSG_EQ ((b.packetsDropped == a.packetsDropped), true, "probe " << i);
+          NS_TEST_EXPECT_MSG_EQ ((b.bytesDropped == a.bytesDropped), true, "probe " << i);
+        }
+    }
+
+  // an image merged into an empty monitor serializes to the same bytes
+  Rank copy;
+  StatsImage again (&image0.GetData ()[0], image0.GetData ().size ());
+  NS_TEST_ASSERT_MSG_EQ (copy.monitor->MergeStats (again), true, "image of rank 0 again");
+  StatsImage reserialized;
+  copy.monitor->SerializeStats (reserialized);
+  NS_TEST_EXPECT_MSG_EQ ((reserialized.GetData () == image0.GetData ()), true, "round trip");
+
+  Rank rejected;
+  StatsImage truncated (&image1.GetData ()[0], image1.GetData ().size () - 1);
+  NS_TEST_EXPECT_MSG_EQ (rejected.monitor->MergeStats (truncated), false, "truncated image");
+  Ptr<FlowMonitor> twoProbes = CreateObject<FlowMonitor> ();
+  twoProbes->SetFlowClassifier (Create<RdmaFlowClassifier> ());
+  Create<TestFlowProbe> (twoProbes);
+  Create<TestFlowProbe> (twoProbes);
+  StatsImage mismatch (&image1.GetData ()[0], image1.GetData ().size ());
+  NS_TEST_EXPECT_MSG_EQ (twoProbes->MergeStats (mismatch), false, "different number of probes");
+
+  Simulator::Destroy ();
+}
+
+static class FlowMonitorMergeTestSuite : public TestSuite
+{
+public:
+  FlowMonitorMergeTestSuite ()
+    : TestSuite ("flow-monitor-merge", UNIT)
+  {
+    AddTestCase (new FlowMonitorMergeTestCase ());
+  }
+} g_flowMonitorMergeTestSuite;
+
+} // namespace ns3
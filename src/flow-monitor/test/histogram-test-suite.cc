@@ -69,6 +69,48 @@ HistogramTestCase::DoRun (void)
   }
 }
 
+class HistogramMergeTestCase : public ns3::TestCase {
+public:
+  HistogramMergeTestCase ();
+  virtual void DoRun (void);
+};
+
+HistogramMergeTestCase::HistogramMergeTestCase ()
+  : ns3::TestCase ("Histogram merge across ranks")
+{
+}
+
+void
+HistogramMergeTestCase::DoRun (void)
+{
+  Histogram h0 (1.0), h1 (1.0), all (1.0);
+  for (int i = 0; i < 20; i++)
+    {
+      double v = (i * 7) % 13 + 0.5;
+      (i % 3 == 0 ? h1 : h0).AddValue (v);
+      all.AddValue (v);
+    }
+  h1.AddValue (40.2);  // longer than h0
+  all.AddValue (40.2);
+
+  StatsImage image;
+  h1.Serialize (image);
+  StatsImage received (&image.GetData ()[0], image.GetData ().size ());
+  NS_TEST_ASSERT_MSG_EQ (h0.MergeSerialized (received), true, "same bin width");
+  NS_TEST_EXPECT_MSG_EQ (received.IsAtEnd (), true, "");
+  NS_TEST_ASSERT_MSG_EQ (h0.GetNBins (), all.GetNBins (), "");
+  for (uint32_t i = 0; i < all.GetNBins (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (h0.GetBinCount (i), all.GetBinCount (i), "bin " << i);
+    }
+
+  Histogram other (2.0);
+  StatsImage again (&image.GetData ()[0], image.GetData ().size ());
+  NS_TEST_EXPECT_MSG_EQ (other.MergeSerialized (again), false, "different bin width");
+  StatsImage truncated (&image.GetData ()[0], image.GetData ().size () - 1);
+  NS_TEST_EXPECT_MSG_EQ (all.MergeSerialized (truncated), false, "truncated image");
+}
+
 static class HistogramTestSuite : public TestSuite
 {
 public:
@@ -76,6 +118,7 @@ public:
     : TestSuite ("histogram", UNIT) 
   {
     AddTestCase (new HistogramTestCase ());
+    AddTestCase (new HistogramMergeTestCase ());
   }
 } g_HistogramTestSuite;
 
@@ -1189,6 +1189,45 @@ uint8_t* Buffer::GetBuffer() const{
 	return m_data->m_data + m_start;
 }
 
+uint8_t*
+Buffer::GetWritableBuffer (uint32_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+  NS_ASSERT (CheckInternalState ());
+  NS_ASSERT (size <= GetSize ());
+  if (m_zeroAreaStart - m_start < size)
+    {
+      /* the patched bytes would fall into the zero area: materialize it.
+       * This also leaves us with a private copy of the data.
+       */
+      TransformIntoRealBuffer ();
+    }
+  if (m_data->m_count > 1)
+    {
+      /* shared with another Buffer: detach before writing.
+       * Before: |--*****-------***--|  (shared)
+       * After:  |*****-------***|      (private)
+       */
+      uint32_t internalSize = GetInternalSize ();
+      struct Buffer::Data *newData = Buffer::Create (internalSize);
+      memcpy (newData->m_data, m_data->m_data + m_start, internalSize);
+      m_data->m_count--;
+      m_data = newData;
+
+      m_zeroAreaStart -= m_start;
+      m_zeroAreaEnd -= m_start;
+      m_end -= m_start;
+      m_start = 0;
+
+      m_data->m_dirtyStart = m_start;
+      m_data->m_dirtyEnd = m_end;
+      m_maxZeroAreaStart = std::max (m_maxZeroAreaStart, m_zeroAreaStart);
+    }
+  LOG_INTERNAL_STATE ("writable size=" << size << ", ");
+  NS_ASSERT (CheckInternalState ());
+  return m_data->m_data + m_start;
+}
+
 } // namespace ns3
 
 
@@ -524,6 +524,17 @@ private:
   uint32_t CopyData (uint8_t *buffer, uint32_t size) const;
 
   uint8_t* GetBuffer() const;
+  /**
+   * \brief Get a writable pointer to the start of the buffer for in-place patching.
+   *
+   * If the underlying data is shared with other Buffer instances (copy-on-write),
+   * it is first detached into a private copy. The first \p size bytes are
+   * guaranteed to be real memory (i.e., outside the virtual zero area).
+   *
+   * \param size the number of leading bytes the caller intends to modify
+   * \returns a pointer to the first byte of the buffer data
+   */
+  uint8_t* GetWritableBuffer (uint32_t size);
 
   inline Buffer (Buffer const &o);
   Buffer &operator = (Buffer const &o);
@@ -23,6 +23,8 @@
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
 #include <string.h>
+#include <string>
+#include <vector>
 
 NS_LOG_COMPONENT_DEFINE ("PacketTagList");
 
@@ -118,6 +120,7 @@ PacketTagList::Remove (Tag &tag)
       struct TagData *copy = AllocData ();
       copy->tid = cur->tid;
       copy->count = 1;
+      copy->size = cur->size;
       copy->next = 0;
       memcpy (copy->data, cur->data, PACKET_TAG_MAX_SIZE);
       *prevNext = copy;
@@ -143,8 +146,9 @@ PacketTagList::Add (const Tag &tag) const
   head->next = 0;
   head->tid = tag.GetInstanceTypeId ();
   head->next = m_next;
-  NS_ASSERT (tag.GetSerializedSize () <= PACKET_TAG_MAX_SIZE);
-  tag.Serialize (TagBuffer (head->data, head->data+tag.GetSerializedSize ()));
+  head->size = tag.GetSerializedSize ();
+  NS_ASSERT (head->size <= PACKET_TAG_MAX_SIZE);
+  tag.Serialize (TagBuffer (head->data, head->data+head->size));
 
   const_cast<PacketTagList *> (this)->m_next = head;
 }
@@ -173,5 +177,107 @@ PacketTagList::Head (void) const
   return m_next;
 }
 
+Tag *
+PacketTagList::CreateTag (TypeId tid)
+{
+  NS_ASSERT_MSG (tid.HasConstructor (), "tag " << tid.GetName () << " has no constructor in its TypeId");
+  Callback<ObjectBase *> cb = tid.GetConstructor ();
+  return dynamic_cast<Tag *> (cb ());
+}
+
+uint32_t
+PacketTagList::GetSerializedSize (void) const
+{
+  uint32_t size = 8;  // total size, number of tags
+  for (struct TagData *cur = m_next; cur != 0; cur = cur->next)
+    {
+      size += 8;  // name size, data size
+      size += (cur->tid.GetName ().size () + 3) & (~3);
+      size += (cur->size + 3) & (~3);
+    }
+  return size;
+}
+
+uint32_t
+PacketTagList::Serialize (uint32_t *buffer, uint32_t maxSize) const
+{
+  NS_LOG_FUNCTION (this << buffer << maxSize);
+  uint32_t size = GetSerializedSize ();
+  if (size > maxSize)
+    {
+      return 0;
+    }
+  memset (buffer, 0, size);
+  uint32_t *p = buffer;
+  *p++ = size;
+  uint32_t *count = p++;
+  for (struct TagData *cur = m_next; cur != 0; cur = cur->next)
+    {
+      std::string name = cur->tid.GetName ();
+      uint32_t dataSize = cur->size;
+      *p++ = name.size ();
+      *p++ = dataSize;
+      memcpy (p, name.data (), name.size ());
+      p += (name.size () + 3) / 4;
+      memcpy (p, cur->data, dataSize);
+      p += (dataSize + 3) / 4;
+      (*count)++;
+    }
+  return size;
+}
+
+uint32_t
+PacketTagList::Deserialize (const uint32_t *buffer, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << buffer << size);
+  NS_ASSERT (m_next == 0);
+  if (size < 8 || buffer[0] < 8 || buffer[0] > size)
+    {
+      return 0;
+    }
+  const uint32_t *p = buffer + 2;
+  const uint32_t *end = buffer + buffer[0] / 4;
+  std::vector<Tag *> tags;
+  bool ok = true;
+  for (uint32_t i = 0; ok && i < buffer[1]; i++)
+    {
+      ok = false;
+      if (end - p < 2)
+        {
+          break;
+        }
+      uint32_t nameSize = *p++;
+      uint32_t dataSize = *p++;
+      if (dataSize > PACKET_TAG_MAX_SIZE
+          || (uint32_t)(end - p) < (nameSize + 3) / 4 + (dataSize + 3) / 4)
+        {
+          break;
+        }
+      TypeId tid;
+      if (!TypeId::LookupByNameFailSafe (std::string (reinterpret_cast<const char *> (p), nameSize), &tid))
+        {
+          break;
+        }
+      p += (nameSize + 3) / 4;
+      uint8_t data[PACKET_TAG_MAX_SIZE];
+      memcpy (data, p, dataSize);
+      p += (dataSize + 3) / 4;
+      Tag *tag = CreateTag (tid);
+      tag->Deserialize (TagBuffer (data, data + dataSize));
+      tags.push_back (tag);
+      ok = true;
+    }
+  // Add prepends: add in reverse order to keep the order of the sender
+  for (std::vector<Tag *>::reverse_iterator it = tags.rbegin (); it != tags.rend (); ++it)
+    {
+      if (ok)
+        {
+          Add (**it);
+        }
+      delete *it;
+    }
+  return ok ? buffer[0] : 0;
+}
+
 } // namespace ns3
 
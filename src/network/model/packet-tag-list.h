@@ -44,6 +44,7 @@ public:
     struct TagData *next;
     TypeId tid;
     uint32_t count;
+    uint32_t size;  // bytes of data used by the tag, for Serialize
   };
 
   inline PacketTagList ();
@@ -58,9 +59,31 @@ public:
 
   const struct PacketTagList::TagData *Head (void) const;
 
+  /**
+   * \returns the number of bytes written by Serialize (a multiple of 4)
+   *
+   * Every tag is written with the name of its TypeId: the TypeId uids of
+   * another process (MPI rank) depend on the order the types were first
+   * used there.  The tags must have a constructor in their TypeId.
+   */
+  uint32_t GetSerializedSize (void) const;
+  /**
+   * \param buffer 4-byte aligned output buffer
+   * \param maxSize size of the buffer in bytes
+   * \returns the number of bytes written, zero if the buffer is too small
+   */
+  uint32_t Serialize (uint32_t *buffer, uint32_t maxSize) const;
+  /**
+   * \param buffer data written by Serialize
+   * \param size available bytes in the buffer
+   * \returns the number of bytes read, zero if the data is invalid
+   */
+  uint32_t Deserialize (const uint32_t *buffer, uint32_t size);
+
 private:
 
   bool Remove (TypeId tid);
+  static Tag *CreateTag (TypeId tid);
   struct PacketTagList::TagData *AllocData (void) const;
   void FreeData (struct TagData *data) const;
 
@@ -582,9 +582,8 @@ uint32_t Packet::GetSerializedSize (void) const
       size += 4;
     }
 
-  //Tag size
-  //XXX
-  //size += m_tags.GetSerializedSize ();
+  // packet tags (byte tags are not serialized)
+  size += m_packetTagList.GetSerializedSize ();
 
   // increment total size by size of meta-data 
   // ensuring 4-byte boundary
@@ -656,8 +655,14 @@ Packet::Serialize (uint8_t* buffer, uint32_t maxSize) const
         }
     }
 
-  // Serialize Tags
-  // XXX
+  // Serialize packet tags, the total length is their first word
+  uint32_t tagSize = m_packetTagList.Serialize (p, maxSize - size);
+  if (tagSize == 0)
+    {
+      return 0;
+    }
+  size += tagSize;
+  p += tagSize / 4;
 
   // Serialize Metadata
   uint32_t metaSize = m_metadata.GetSerializedSize ();
@@ -754,10 +759,14 @@ Packet::Deserialize (const uint8_t* buffer, uint32_t size)
       p += ((((nixSize - 4) + 3) & (~3)) / 4);
     }
 
-  // read tags
-  //XXX
-  //uint32_t tagsDeserialized = m_tags.Deserialize (buffer.Begin ());
-  //buffer.RemoveAtStart (tagsDeserialized);
+  // read packet tags
+  uint32_t tagSize = m_packetTagList.Deserialize (p, size);
+  if (tagSize == 0)
+    {
+      return 0;
+    }
+  size -= tagSize;
+  p += tagSize / 4;
 
   // read metadata
   uint32_t metaSize = *p++;
@@ -909,4 +918,11 @@ uint8_t* Packet::GetBuffer() const{
 	return m_buffer.GetBuffer();
 }
 
+uint8_t*
+Packet::GetWritableBuffer (uint32_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+  return m_buffer.GetWritableBuffer (size);
+}
+
 } // namespace ns3
@@ -573,6 +573,17 @@ public:
   Ptr<NixVector> GetNixVector (void) const; 
 
   uint8_t* GetBuffer() const;
+  /**
+   * \brief Get a writable pointer to the packet's serialized bytes.
+   *
+   * Detaches the underlying buffer if it is shared, so that patching
+   * header fields in place never leaks into other copies of this packet.
+   * See CustomHeader for the helpers that use this.
+   *
+   * \param size the number of leading bytes the caller intends to modify
+   * \returns a pointer to the first byte of the packet
+   */
+  uint8_t* GetWritableBuffer (uint32_t size);
 
 private:
   Packet (const Buffer &buffer, const ByteTagList &byteTagList, 
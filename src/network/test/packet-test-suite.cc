@@ -18,8 +18,10 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include "ns3/packet.h"
+#include "ns3/packet-tag-list.h"
 #include "ns3/test.h"
 #include <string>
+#include <vector>
 #include <stdarg.h>
 
 namespace ns3 {
@@ -436,6 +438,98 @@ PacketTest::DoRun (void)
   }
 }
 //-----------------------------------------------------------------------------
+/**
+ * PacketTagList::Serialize/Deserialize (packets crossing MPI ranks) keep
+ * the tags, their order and their bytes, and reject a short buffer or an
+ * unknown tag name.
+ */
+class PacketTagListSerializeTest : public TestCase
+{
+public:
+  PacketTagListSerializeTest ();
+  virtual void DoRun (void);
+private:
+  template <int N>
+  void CheckTag (const PacketTagList &list, const char *file, int line);
+};
+
+PacketTagListSerializeTest::PacketTagListSerializeTest ()
+  : TestCase ("PacketTagList serialization")
+{
+}
+
+template <int N>
+void
+PacketTagListSerializeTest::CheckTag (const PacketTagList &list, const char *file, int line)
+{
+  ATestTag<N> tag;
+  NS_TEST_EXPECT_MSG_EQ_INTERNAL (list.Peek (tag), true, "tag " << N << " missing", file, line);
+  NS_TEST_EXPECT_MSG_EQ_INTERNAL (tag.m_error, false, "tag " << N << " bytes", file, line);
+}
+
+void
+PacketTagListSerializeTest::DoRun (void)
+{
+  PacketTagList list;
+  list.Add (ATestTag<1> ());
+  list.Add (ATestTag<5> ());
+  list.Add (ATestTag<8> ());
+  list.Add (ATestTag<13> ());
+  ATestTag<5> removed;
+  list.Remove (removed);  // Remove copies the other tags
+
+  uint32_t size = 8;
+  for (const struct PacketTagList::TagData *cur = list.Head (); cur != 0; cur = cur->next)
+    {
+      size += 8 + ((cur->tid.GetName ().size () + 3) & (~3)) + ((cur->size + 3) & (~3));
+    }
+  NS_TEST_ASSERT_MSG_EQ (list.GetSerializedSize (), size, "serialized size");
+
+  std::vector<uint32_t> buffer (size / 4 + 1);
+  NS_TEST_EXPECT_MSG_EQ (list.Serialize (&buffer[0], size - 4), 0, "buffer too small");
+  NS_TEST_ASSERT_MSG_EQ (list.Serialize (&buffer[0], size + 4), size, "bytes written");
+
+  PacketTagList copy;
+  NS_TEST_ASSERT_MSG_EQ (copy.Deserialize (&buffer[0], size + 4), size, "bytes read");
+  const struct PacketTagList::TagData *a = list.Head ();
+  const struct PacketTagList::TagData *b = copy.Head ();
+  for (; a != 0 && b != 0; a = a->next, b = b->next)
+    {
+      NS_TEST_EXPECT_MSG_EQ (b->tid, a->tid, "tag order");
+      NS_TEST_EXPECT_MSG_EQ (b->size, a->size, "tag size");
+      NS_TEST_EXPECT_MSG_EQ (memcmp (b->data, a->data, a->size), 0, "tag bytes");
+    }
+  NS_TEST_EXPECT_MSG_EQ ((a == 0 && b == 0), true, "tag count");
+  CheckTag<1> (copy, __FILE__, __LINE__);
+  CheckTag<8> (copy, __FILE__, __LINE__);
+  CheckTag<13> (copy, __FILE__, __LINE__);
+  NS_TEST_EXPECT_MSG_EQ (copy.Peek (removed), false, "removed tag");
+
+  PacketTagList truncated;
+  NS_TEST_EXPECT_MSG_EQ (truncated.Deserialize (&buffer[0], size - 4), 0, "truncated buffer");
+  NS_TEST_EXPECT_MSG_EQ ((truncated.Head () == 0), true, "nothing added from a truncated buffer");
+
+  reinterpret_cast<char *> (&buffer[4])[0] = '#';  // first character of the first tag name
+  PacketTagList unknown;
+  NS_TEST_EXPECT_MSG_EQ (unknown.Deserialize (&buffer[0], size), 0, "unknown tag name");
+  NS_TEST_EXPECT_MSG_EQ ((unknown.Head () == 0), true, "nothing added for an unknown tag name");
+
+  // the packet tags travel with Packet::Serialize
+  Ptr<Packet> p = Create<Packet> (100);
+  p->AddPacketTag (ATestTag<3> ());
+  p->AddPacketTag (ATestTag<20> ());
+  std::vector<uint8_t> bytes (p->GetSerializedSize ());
+  NS_TEST_ASSERT_MSG_EQ (p->Serialize (&bytes[0], bytes.size ()), 1, "packet serialized");
+  Ptr<Packet> q = Create<Packet> (&bytes[0], bytes.size (), true);
+  NS_TEST_EXPECT_MSG_EQ (q->GetSize (), 100, "packet size");
+  ATestTag<3> t3;
+  ATestTag<20> t20;
+  NS_TEST_EXPECT_MSG_EQ (q->PeekPacketTag (t3), true, "packet tag 3");
+  NS_TEST_EXPECT_MSG_EQ (t3.m_error, false, "packet tag 3 bytes");
+  NS_TEST_EXPECT_MSG_EQ (q->PeekPacketTag (t20), true, "packet tag 20");
+  NS_TEST_EXPECT_MSG_EQ (t20.m_error, false, "packet tag 20 bytes");
+}
+//-----------------------------------------------------------------------------
 class PacketTestSuite : public TestSuite
 {
 public:
@@ -446,6 +540,7 @@ PacketTestSuite::PacketTestSuite ()
   : TestSuite ("packet", UNIT)
 {
   AddTestCase (new PacketTest);
+  AddTestCase (new PacketTagListSerializeTest);
 }
 
 static PacketTestSuite g_packetTestSuite;
@@ -25,19 +25,14 @@
 #include "drop-tail-queue.h"
 #include "ns3/double.h"
 #include "ns3/enum.h"
-#include "ns3/flow-id-num-tag.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
 #include "ns3/uinteger.h"
 
-#define MAP_KEY_EXISTS(map, key) (((map).find(key) != (map).end()))
-
 NS_LOG_COMPONENT_DEFINE("BEgressQueue");
 
 namespace ns3 {
 
-std::unordered_map<unsigned, Time> acc_pause_time;  // global
-
 NS_OBJECT_ENSURE_REGISTERED(BEgressQueue);
 
 TypeId BEgressQueue::GetTypeId(void) {
@@ -60,7 +55,11 @@ TypeId BEgressQueue::GetTypeId(void) {
 BEgressQueue::BEgressQueue() : Queue() {
     NS_LOG_FUNCTION_NOARGS();
     m_bytesInQueueTotal = 0;
+    m_fluidBytesTotal = 0;
     m_rrlast = 0;
+    for (uint32_t i = 0; i < qCnt; i++) {
+        m_fluidBytes[i] = 0;
+    }
     for (uint32_t i = 0; i < fCnt; i++) {
         m_bytesInQueue[i] = 0;
         m_queues.push_back(CreateObject<DropTailQueue>());
@@ -87,7 +86,7 @@ bool BEgressQueue::DoEnqueue(Ptr<Packet> p, uint32_t qIndex) {
 }
 
 Ptr<Packet>
-BEgressQueue::DoDequeueRR(bool paused[])  // this is for switch only
+BEgressQueue::DoDequeueRR(uint32_t pausedMask)  // this is for switch only
 {
     NS_LOG_FUNCTION(this);
 
@@ -104,47 +103,19 @@ BEgressQueue::DoDequeueRR(bool paused[])  // this is for switch only
         found = true;
         qIndex = 0;
     } else {
-        if (!found) {
-            for (qIndex = 1; qIndex <= qCnt; qIndex++) {
-                bool cond1 = !paused[(qIndex + m_rrlast) % qCnt];
-                bool cond2 = m_queues[(qIndex + m_rrlast) % qCnt]->GetNPackets() > 0;  // round robin
-
-                if (!cond1 && cond2) {
-                    // Packet could be scheduled by RR, but could not be scheduled because of PAUSE
-                    FlowIDNUMTag fit;
-                    Ptr<Packet> p = ConstCast<Packet, const Packet>(m_queues[(qIndex + m_rrlast) % qCnt]->Peek());
-                    if (p->PeekPacketTag(fit)) {
-                        unsigned flowid = static_cast<unsigned>(fit.GetId());
-                        if (!MAP_KEY_EXISTS(current_pause_time, flowid))
-                            current_pause_time[flowid] = Simulator::Now();
-                    }
-                    // std::cout<<"Warning: BEgressQueue::DoDequeueRR packet could not be scheduled because of PAUSE"<<std::endl;s
-                } else if (cond1 && cond2) {
-                    found = true;
-                    break;
-                }
+        for (qIndex = 1; qIndex <= qCnt; qIndex++) {
+            uint32_t q = (qIndex + m_rrlast) % qCnt;
+            // 被 PAUSE 的优先级直接跳过；PAUSE 时长由 PfcPortState 按优先级统计
+            if (!((pausedMask >> q) & 1) && m_queues[q]->GetNPackets() > 0) {  // round robin
+                found = true;
+                break;
             }
-            qIndex = (qIndex + m_rrlast) % qCnt;
         }
+        qIndex = (qIndex + m_rrlast) % qCnt;
     }
     if (found) {
         Ptr<Packet> p = m_queues[qIndex]->Dequeue();
 
-        // Check if the flow has been blocked by PFC
-        if (p) {
-            FlowIDNUMTag fit;
-            if (p->PeekPacketTag(fit)) {
-                unsigned flowid = static_cast<unsigned>(fit.GetId());
-                if (MAP_KEY_EXISTS(current_pause_time, flowid)) {
-                    Time tdiff = Simulator::Now() - current_pause_time[flowid];
-                    if (!MAP_KEY_EXISTS(acc_pause_time, flowid))
-                        acc_pause_time[flowid] = Seconds(0);
-                    acc_pause_time[flowid] = acc_pause_time[flowid] + tdiff;
-                    current_pause_time.erase(flowid);
-                }
-            }
-        }
-
         m_traceBeqDequeue(p, qIndex);
         m_bytesInQueueTotal -= p->GetSize();
         m_bytesInQueue[qIndex] -= p->GetSize();
@@ -183,9 +154,9 @@ bool BEgressQueue::Enqueue(Ptr<Packet> p, uint32_t qIndex) {
 }
 
 Ptr<Packet>
-BEgressQueue::DequeueRR(bool paused[]) {
+BEgressQueue::DequeueRR(uint32_t pausedMask) {
     NS_LOG_FUNCTION(this);
-    Ptr<Packet> packet = DoDequeueRR(paused);
+    Ptr<Packet> packet = DoDequeueRR(pausedMask);
     if (packet != 0) {
         NS_ASSERT(m_nBytes >= packet->GetSize());
         NS_ASSERT(m_nPackets > 0);
@@ -246,4 +217,15 @@ BEgressQueue::GetLastQueue() {
     return m_qlast;
 }
 
+void
+BEgressQueue::SetFluidBytes(uint32_t qIndex, uint32_t bytes) {
+    m_fluidBytesTotal = m_fluidBytesTotal - m_fluidBytes[qIndex] + bytes;
+    m_fluidBytes[qIndex] = bytes;
+}
+
+uint32_t
+BEgressQueue::GetFluidBytesTotal() const {
+    return m_fluidBytesTotal;
+}
+
 }  // namespace ns3
@@ -39,19 +39,22 @@ namespace ns3 {
 		BEgressQueue();
 		virtual ~BEgressQueue();
 		bool Enqueue(Ptr<Packet> p, uint32_t qIndex);
-		Ptr<Packet> DequeueRR(bool paused[]);
+		Ptr<Packet> DequeueRR(uint32_t pausedMask);  // bit q set: priority q is paused
 		uint32_t GetNBytes(uint32_t qIndex) const;
 		uint32_t GetNBytesTotal() const;
 		uint32_t GetLastQueue();
+		/* hybrid mode: synthetic bytes of fluid flows in queue qIndex (never dequeued) */
+		void SetFluidBytes(uint32_t qIndex, uint32_t bytes);
+		uint32_t GetFluidBytesTotal() const;
+		/* packets and fluid: the occupancy seen by load balancing and INT */
+		uint32_t GetOccupancy() const { return m_bytesInQueueTotal + m_fluidBytesTotal; }
 
 		TracedCallback<Ptr<const Packet>, uint32_t> m_traceBeqEnqueue;
 		TracedCallback<Ptr<const Packet>, uint32_t> m_traceBeqDequeue;
-		
-		std::unordered_map<int32_t, Time> current_pause_time;
 
 	private:
 		bool DoEnqueue(Ptr<Packet> p, uint32_t qIndex);
-		Ptr<Packet> DoDequeueRR(bool paused[]);
+		Ptr<Packet> DoDequeueRR(uint32_t pausedMask);
 		//for compatibility
 		virtual bool DoEnqueue(Ptr<Packet> p);
 		virtual Ptr<Packet> DoDequeue(void);
@@ -59,6 +62,8 @@ namespace ns3 {
 		double m_maxBytes; //total bytes limit
 		uint32_t m_bytesInQueue[fCnt];
 		uint32_t m_bytesInQueueTotal;
+		uint32_t m_fluidBytes[qCnt];
+		uint32_t m_fluidBytesTotal;
 		uint32_t m_rrlast;
 		uint32_t m_qlast;
 		std::vector<Ptr<Queue> > m_queues; // uc queues
@@ -22,6 +22,7 @@
 #include "ns3/abort.h"
 #include "ns3/log.h"
 #include "custom-header.h"
+#include <cstring>
 
 namespace ns3 {
 
@@ -351,5 +352,96 @@ uint32_t CustomHeader::GetStaticWholeHeaderSize(void){
 	return 14 + 20 + GetUdpHeaderSize();
 }
 
+// same byte order as Buffer::Iterator::WriteU32
+static inline void WriteLsbU32 (uint8_t *buf, uint32_t v){
+	buf[0] = v & 0xff;
+	buf[1] = (v >> 8) & 0xff;
+	buf[2] = (v >> 16) & 0xff;
+	buf[3] = (v >> 24) & 0xff;
+}
+
+uint8_t CustomHeader::PeekL3Prot (Ptr<const Packet> p){
+	return p->GetBuffer()[Ipv4ProtOffset];
+}
+
+/*
+ * RFC 1624 incremental update: HC' = ~(~HC + ~m + m') over each 16-bit word
+ * that changed. Offsets of all patched fields are even relative to the start
+ * of the covered header, so the words line up with the checksum's words.
+ * A zero checksum means "not computed" and is left untouched.
+ */
+void CustomHeader::UpdateChecksum (uint8_t *csum, const uint8_t *oldData, const uint8_t *newData, uint32_t len){
+	uint32_t hc = (csum[0] << 8) | csum[1];
+	if (hc == 0)
+		return;
+	uint32_t sum = (~hc) & 0xffff;
+	for (uint32_t j = 0; j + 1 < len; j += 2){
+		uint16_t m = (oldData[j] << 8) | oldData[j + 1];
+		uint16_t m1 = (newData[j] << 8) | newData[j + 1];
+		if (m == m1)
+			continue;
+		sum += (~m & 0xffff) + m1;
+	}
+	while (sum >> 16)
+		sum = (sum & 0xffff) + (sum >> 16);
+	hc = (~sum) & 0xffff;
+	csum[0] = hc >> 8;
+	csum[1] = hc & 0xff;
+}
+
+void CustomHeader::PatchIpv4Ecn (Ptr<Packet> p, uint8_t ecn){
+	uint8_t *buf = p->GetWritableBuffer(L4Offset);
+	uint8_t old[2] = {buf[Ipv4Offset], buf[Ipv4TosOffset]};
+	buf[Ipv4TosOffset] = (buf[Ipv4TosOffset] & 0xfc) | (ecn & 0x3);
+	UpdateChecksum(buf + Ipv4ChecksumOffset, old, buf + Ipv4Offset, 2);
+}
+
+void CustomHeader::PatchUdpSeq (Ptr<Packet> p, uint32_t seq){
+	uint8_t *buf = p->GetWritableBuffer(UdpSeqOffset + 4);
+	uint8_t old[4];
+	memcpy(old, buf + UdpSeqOffset, 4);
+	buf[UdpSeqOffset] = seq >> 24;  // written by WriteHtonU32
+	buf[UdpSeqOffset + 1] = (seq >> 16) & 0xff;
+	buf[UdpSeqOffset + 2] = (seq >> 8) & 0xff;
+	buf[UdpSeqOffset + 3] = seq & 0xff;
+	UpdateChecksum(buf + UdpChecksumOffset, old, buf + UdpSeqOffset, 4);
+}
+
+void CustomHeader::PatchAckSeq (Ptr<Packet> p, uint32_t seq){
+	uint8_t *buf = p->GetWritableBuffer(AckSeqOffset + 4);
+	WriteLsbU32(buf + AckSeqOffset, seq);  // written by WriteU32, no checksum
+}
+
+void CustomHeader::PatchHulaProbe (Ptr<Packet> p, uint32_t torID, uint8_t minUtil){
+	CustomHeader ch;
+	ch.hula.data.torID = torID;
+	ch.hula.data.minUtil = minUtil;
+	uint8_t *buf = p->GetWritableBuffer(L4Offset + 4);
+	WriteLsbU32(buf + L4Offset, ch.hula.u32view);  // written by WriteU32 in HulaHeader
+}
+
+void CustomHeader::PatchPfc (Ptr<Packet> p, uint32_t time, uint32_t qlen, uint8_t qIndex){
+	uint8_t *buf = p->GetWritableBuffer(L4Offset + 9);
+	// written by WriteU32/WriteU8 in PauseHeader, no checksum
+	WriteLsbU32(buf + L4Offset, time);
+	WriteLsbU32(buf + L4Offset + 4, qlen);
+	buf[L4Offset + 8] = qIndex;
+}
+
+void CustomHeader::PushIntHop (Ptr<Packet> p, uint64_t time, uint64_t bytes, uint32_t qlen, uint64_t rate){
+	uint32_t intSize = IntHeader::GetStaticSize();
+	uint8_t *buf = p->GetWritableBuffer(UdpIntOffset + intSize);
+	// Note: IntHeader has no internal padding, so the buffer can be used as IntHeader directly
+	IntHeader *ih = (IntHeader *)&buf[UdpIntOffset];
+	if (buf[UdpChecksumOffset] == 0 && buf[UdpChecksumOffset + 1] == 0){
+		ih->PushHop(time, bytes, qlen, rate);
+		return;
+	}
+	uint8_t old[sizeof(IntHeader)];
+	memcpy(old, ih, intSize);
+	ih->PushHop(time, bytes, qlen, rate);
+	UpdateChecksum(buf + UdpChecksumOffset, old, buf + UdpIntOffset, intSize);
+}
+
 } // namespace ns3
 
@@ -23,6 +23,7 @@
 
 #include "ns3/header.h"
 #include "ns3/int-header.h"
+#include "ns3/packet.h"
 
 namespace ns3 {
 /**
@@ -146,6 +147,33 @@ public:
   static uint32_t GetAckSerializedSize(void);
   static uint32_t GetUdpHeaderSize(void); // include udp, seqTs, INT
   static uint32_t GetStaticWholeHeaderSize(void); // ppp + ip + udp + int
+
+  /*
+   * In-place field patching on a packet that carries a serialized
+   * L2 | L3 | L4 CustomHeader (i.e., a packet in a switch queue).
+   * These avoid the RemoveHeader/AddHeader round trip for fields that
+   * switches rewrite in flight. IPv4/UDP checksums are updated
+   * incrementally (RFC 1624) only when they are non-zero.
+   */
+  static const uint32_t PppSize = 14;
+  static const uint32_t Ipv4Offset = PppSize;
+  static const uint32_t Ipv4TosOffset = Ipv4Offset + 1;
+  static const uint32_t Ipv4ProtOffset = Ipv4Offset + 9;
+  static const uint32_t Ipv4ChecksumOffset = Ipv4Offset + 10;
+  static const uint32_t L4Offset = Ipv4Offset + 20;
+  static const uint32_t UdpChecksumOffset = L4Offset + 6;
+  static const uint32_t UdpSeqOffset = L4Offset + 8;      // SeqTsHeader.seq
+  static const uint32_t UdpIntOffset = L4Offset + 8 + 6;  // udp, SeqTs, INT
+  static const uint32_t AckSeqOffset = L4Offset + 8;      // qbbHeader.seq
+
+  static uint8_t PeekL3Prot (Ptr<const Packet> p);
+  static void PatchIpv4Ecn (Ptr<Packet> p, uint8_t ecn);
+  static void PatchUdpSeq (Ptr<Packet> p, uint32_t seq);
+  static void PatchAckSeq (Ptr<Packet> p, uint32_t seq);
+  static void PushIntHop (Ptr<Packet> p, uint64_t time, uint64_t bytes, uint32_t qlen, uint64_t rate);
+  static void PatchHulaProbe (Ptr<Packet> p, uint32_t torID, uint8_t minUtil);
+  static void PatchPfc (Ptr<Packet> p, uint32_t time, uint32_t qlen, uint8_t qIndex);
+  static void UpdateChecksum (uint8_t *csum, const uint8_t *oldData, const uint8_t *newData, uint32_t len);
 };
 
 } // namespace ns3
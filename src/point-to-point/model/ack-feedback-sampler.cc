@@ -0,0 +1,67 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CAVER-LB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "ns3/ack-feedback-sampler.h"
+
+namespace ns3 {
+
+uint32_t AckFeedbackSampler::mode = AckFeedbackSampler::ALL;
+uint64_t AckFeedbackSampler::param = 1;
+uint64_t AckFeedbackSampler::m_acks = 0;
+uint64_t AckFeedbackSampler::m_feedbackAcks = 0;
+uint64_t AckFeedbackSampler::m_feedbackHops = 0;
+uint64_t AckFeedbackSampler::m_feedbackBytes = 0;
+
+bool AckFeedbackSampler::Sample(uint32_t dst, uint64_t nowNs) {
+    m_acks++;
+    bool sampled = true;
+    if (mode == EVERY_NTH) {
+        uint64_t& cnt = m_state[dst];
+        sampled = cnt % param == 0;  // the first ACK of a pair always carries feedback
+        cnt++;
+    } else if (mode == TIME_BUDGET) {
+        std::unordered_map<uint32_t, uint64_t>::iterator it = m_state.find(dst);
+        if (it == m_state.end()) {
+            m_state[dst] = nowNs + param;
+        } else if (nowNs >= it->second) {
+            it->second = nowNs + param;
+        } else {
+            sampled = false;
+        }
+    }
+    if (sampled) m_feedbackAcks++;
+    return sampled;
+}
+
+void AckFeedbackSampler::PrintCounters(FILE* fout) {
+    fprintf(fout,
+            "ACK feedback: %lu ACKs, %lu with feedback (%.2f%%), %lu switch updates, %lu tag "
+            "bytes\n",
+            m_acks, m_feedbackAcks, m_acks ? 100.0 * m_feedbackAcks / m_acks : 0.0,
+            m_feedbackHops, m_feedbackBytes);
+}
+
+}  // namespace ns3
@@ -0,0 +1,78 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CAVER-LB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <unordered_map>
+
+namespace ns3 {
+
+/**
+ * @brief Sampling of the ACK-carried path feedback of CAVER / Noshare / DV.
+ * ACK 进入网络的第一个 ToR（发送端 ToR）决定这个 ACK 是否携带反馈 tag：
+ * - ALL: 每个 ACK 都带（原行为）
+ * - EVERY_NTH: 每个 (本 ToR, ACK 目的主机) 对，每 N 个 ACK 带一次
+ * - TIME_BUDGET: 每个 (本 ToR, ACK 目的主机) 对，每个时间预算（ns）内最多带一次
+ * 不带 tag 的 ACK 在沿途交换机上直接转发，不做任何表项更新。
+ * 全局计数器统计反馈开销：进入网络的 ACK 数、带反馈的 ACK 数、处理反馈的交换机跳数以及
+ * 反馈 tag 在链路上占用的字节数（每跳一份）。
+ */
+class AckFeedbackSampler {
+   public:
+    enum Mode : uint32_t { ALL = 0, EVERY_NTH = 1, TIME_BUDGET = 2 };
+
+    /* global configuration (ACK_FEEDBACK_SAMPLING) */
+    static uint32_t mode;
+    static uint64_t param;  // N (EVERY_NTH) or budget in ns (TIME_BUDGET)
+    static bool Enabled() { return mode != ALL; }
+
+    /* at the ToR where the ACK enters the fabric: true if it carries feedback to `dst` */
+    bool Sample(uint32_t dst, uint64_t nowNs);
+
+    /* one switch processed (and forwarded) the feedback of an ACK */
+    static void CountHop(uint32_t tagBytes) {
+        m_feedbackHops++;
+        m_feedbackBytes += tagBytes;
+    }
+
+    /* "ACK feedback: ..." one-line summary of the counters */
+    static void PrintCounters(FILE* fout);
+    static uint64_t GetAcks() { return m_acks; }
+    static uint64_t GetFeedbackAcks() { return m_feedbackAcks; }
+
+   private:
+    std::unordered_map<uint32_t, uint64_t> m_state;  // dst -> ACK count / next allowed time (ns)
+
+    static uint64_t m_acks;
+    static uint64_t m_feedbackAcks;
+    static uint64_t m_feedbackHops;
+    static uint64_t m_feedbackBytes;
+};
+
+}  // namespace ns3
@@ -41,6 +41,7 @@
 namespace ns3 {
 
     /*---- CaverUdp-Tag -----*/ 
+    NS_OBJECT_ENSURE_REGISTERED(CaverUdpTag);  // looked up by name when a route trace is replayed
     CaverUdpTag::CaverUdpTag() {}
     CaverUdpTag::~CaverUdpTag() {}
     TypeId CaverUdpTag::GetTypeId(void) {
@@ -82,6 +83,7 @@ namespace ns3 {
     }
 
     /*---- CaverAck-Tag -----*/
+    NS_OBJECT_ENSURE_REGISTERED(CaverAckTag);
     CaverAckTag::CaverAckTag() {}
     CaverAckTag::~CaverAckTag() {}
     TypeId CaverAckTag::GetTypeId(void) {
@@ -104,7 +106,8 @@ namespace ns3 {
     uint32_t CaverAckTag::GetHostId(void) const {return m_host_id;}
     void CaverAckTag::SetHostId(uint32_t host_id) {m_host_id = host_id; }
     uint32_t CaverAckTag::GetSerializedSize(void) const {
-        return sizeof(uint32_t) + sizeof(uint32_t) + sizeof(uint8_t) + sizeof(uint32_t) + sizeof(uint32_t);
+        return sizeof(uint32_t) + sizeof(uint32_t) + sizeof(uint32_t) + sizeof(uint32_t) + sizeof(uint8_t) +
+               sizeof(uint32_t) + sizeof(uint32_t);
     }
     void CaverAckTag::Serialize(TagBuffer i) const {
         i.WriteU32(m_pathId);
@@ -139,6 +142,7 @@ namespace ns3 {
     CaverRouting::CaverRouting() {
         m_isToR = false;
         m_switch_id = (uint32_t)-1;
+        SetRandomSeed(std::random_device()());
 
         // set constants
         m_dreTime = Time(MicroSeconds(200));
@@ -158,18 +162,13 @@ namespace ns3 {
 
     TypeId CaverRouting::GetTypeId(void) {
         static TypeId tid =
-            TypeId("ns3::CaverRouting").SetParent<Object>().AddConstructor<CaverRouting>();
+            TypeId("ns3::CaverRouting").SetParent<LoadBalancer>().AddConstructor<CaverRouting>();
 
         return tid;
     }
 
     uint32_t CaverRouting::GetOutPortFromPath(const uint32_t& path, const uint32_t& hopCount) {
-        std::vector<uint8_t> bytes(4);
-        bytes[0] = (path >> 24) & 0xFF;
-        bytes[1] = (path >> 16) & 0xFF;
-        bytes[2] = (path >> 8) & 0xFF;
-        bytes[3] = path & 0xFF;
-        return bytes[hopCount];
+        return PathCodec::GetPort(path, hopCount);
     }
 
     // void CaverRouting::SetOutPortToPath(uint32_t& path, const uint32_t& hopCount,
@@ -185,13 +184,7 @@ namespace ns3 {
         m_switchSendToDevCallback(p, ch);
     }
 
-    void CaverRouting::SetSwitchSendCallback(SwitchSendCallback switchSendCallback) {
-        m_switchSendCallback = switchSendCallback;
-    }
 
-    void CaverRouting::SetSwitchSendToDevCallback(SwitchSendToDevCallback switchSendToDevCallback) {
-        m_switchSendToDevCallback = switchSendToDevCallback;
-    }
 
     void CaverRouting::SetSwitchInfo(bool isToR, uint32_t switch_id) {
         m_isToR = isToR;
@@ -213,18 +206,27 @@ namespace ns3 {
         }
     }
 
+    void CaverRouting::SetRandomSeed(uint32_t seed) {
+        m_randomSeed = seed;
+        m_rng.seed(seed);
+    }
+
     uint32_t CaverRouting::UpdateLocalDre(Ptr<Packet> p, CustomHeader ch, uint32_t outPort) {
+        return AddLocalDre(outPort, p->GetSize());
+    }
+
+    uint32_t CaverRouting::AddLocalDre(uint32_t outPort, uint32_t bytes) {
         if (useEWMA) {
             uint32_t X = m_DreMap[outPort];
             Time deltaT = Simulator::Now() - m_Port2UpdateTime[outPort];
             double decayFactor = std::max(0.0, (1.0 - deltaT / tau).GetDouble());
-            uint32_t newX = p->GetSize() + X * decayFactor;
+            uint32_t newX = bytes + X * decayFactor;
             m_Port2UpdateTime[outPort] = Simulator::Now();
             m_DreMap[outPort] = newX;
             return newX;
         } else {
             uint32_t X = m_DreMap[outPort];
-            uint32_t newX = X + p->GetSize();
+            uint32_t newX = X + bytes;
             // NS_LOG_FUNCTION("Old X" << X << "New X" << newX << "outPort" << outPort << "Switch" <<
             // m_switch_id << Simulator::Now());
             m_DreMap[outPort] = newX;
@@ -271,13 +273,53 @@ namespace ns3 {
         }
         return quantX;
     }
-    std::vector<uint8_t> CaverRouting::uint32_to_uint8(uint32_t number) {
-        std::vector<uint8_t> bytes(4);
-        bytes[0] = (number >> 24) & 0xFF;
-        bytes[1] = (number >> 16) & 0xFF;
-        bytes[2] = (number >> 8) & 0xFF;
-        bytes[3] = number & 0xFF; // 获取低位字节
-        return bytes;
+    PathCodec::Ports CaverRouting::PathId2Ports(uint32_t pathId) { return PathCodec::GetPorts(pathId); }
+    bool CaverRouting::Ingress(Ptr<Packet> p, CustomHeader& ch) {
+        RouteInput(p, ch);
+        return true;
+    }
+    // 按路由表（ECMP）转发的UDP包也要计入本地Dre
+    void CaverRouting::OnRouted(Ptr<Packet> p, CustomHeader& ch, uint32_t outDev) {
+        if (ch.l3Prot != 0x11) return;
+        UpdateLocalDre(p, ch, outDev);
+        if (DreTable_log) {
+            if (m_isToR)
+                printf("Dre Table: ToR switch %d\n", m_switch_id);
+            else
+                printf("Dre Table: Mid switch %d\n", m_switch_id);
+            for (auto it = m_DreMap.begin(); it != m_DreMap.end(); ++it) {
+                uint32_t ce = it->second;
+                uint32_t localce = QuantizingX(it->first, ce);
+                std::cout << "Port: " << it->first << ", CE: " << it->second << ",localCE: " << localce << std::endl;
+            }
+        }
+    }
+    // 混合模式：流体背景流在出端口上的字节也计入本地Dre
+    void CaverRouting::OnFluidTx(uint32_t outDev, uint64_t bytes) {
+        AddLocalDre(outDev, bytes);
+        if (!m_dreEvent.IsRunning() && !useEWMA) {
+            m_dreEvent = Simulator::Schedule(m_dreTime, &CaverRouting::DreEvent, this);
+        }
+    }
+    void CaverRouting::ReportMemory(MemoryAccounting::Report& report) {
+        const uint64_t o = MemoryAccounting::MALLOC_OVERHEAD;
+        uint64_t bytes = MemoryAccounting::TreeBytes(best_pathCE_Table) + MemoryAccounting::TreeBytes(acceptable_path_table);
+        for (auto& it : best_pathCE_Table) bytes += MemoryAccounting::VectorBytes(it.second._path) + o;
+        for (auto& it : acceptable_path_table) bytes += MemoryAccounting::VectorBytes(it.second._path) + o;
+        report.Add("caver.best_path", best_pathCE_Table.size() + acceptable_path_table.size(), bytes);
+
+        uint64_t paths = 0;
+        bytes = MemoryAccounting::HashBytes(PathChoiceTable) + MemoryAccounting::HashBytes(PathChoiceFlagMap);
+        for (auto& it : PathChoiceTable) {
+            paths += it.second.size();
+            bytes += MemoryAccounting::VectorBytes(it.second) + o;
+            for (auto& pc : it.second) bytes += MemoryAccounting::VectorBytes(pc._path) + o;
+        }
+        report.Add("caver.path_choice", paths, bytes);
+
+        // 表项是指针，Caver_Flowlet 对象另算
+        report.Add("caver.flowlet", m_flowletTable.size(),
+                   MemoryAccounting::TreeBytes(m_flowletTable) + m_flowletTable.size() * (sizeof(Caver_Flowlet) + o));
     }
     void CaverRouting::RouteInput(Ptr<Packet> p, CustomHeader ch){
         // Packet arrival time
@@ -291,15 +333,7 @@ namespace ns3 {
             assert(false && "l3Prot is not 0x11 or 0xFC");
         }
 
-        //This code is used to filter ACK packets with specific sequence numbers to simulate the performance of Caver under different ACK ratios.
-        //if (ch.l3Prot == 0xFC) {
-        //    if (ch.ack.seq % 1000 == 0 && ch.ack.seq % 80000 != 0) { //ch.ack.seq % 1000 != 0 usually means this is the ack of the last packet in the flow
-        //        DoSwitchSendToDev(p, ch);
-        //        return;
-        //    }
-        //    //uint32_t flowid = Settings::PacketId2FlowId[std::make_tuple(Settings::hostIp2IdMap[ch.dip], Settings::hostIp2IdMap[ch.sip], ch.udp.dport, ch.udp.sport)];
-        //    //printf("Ack:%u, FlowId:%u, Length:%u\n", ch.ack.seq, flowid, Settings::FlowId2Length[flowid]);
-        //}
+        // ACK ratio experiments: see AckFeedbackSampler (sampling at the ACK's source ToR)
 
         // Turn on DRE event scheduler if it is not running
         if (!m_dreEvent.IsRunning() && !useEWMA) {
@@ -552,6 +586,18 @@ namespace ns3 {
             if (m_isToR){
                 if (!found)// sender-side
                 {
+                    if (AckFeedbackSampler::Enabled()) {
+                        // an ACK without feedback coming from the fabric is not ours to tag
+                        auto sender = Settings::hostIp2IdMap.find(ch.sip);
+                        if (sender == Settings::hostIp2IdMap.end() || id2Port.find(sender->second) == id2Port.end()) {
+                            DoSwitchSendToDev(p, ch);
+                            return;
+                        }
+                    }
+                    if (!m_ackSampler.Sample(ch.dip, now.GetTimeStep())) {
+                        DoSwitchSendToDev(p, ch);  // sampled out: no feedback on this ACK
+                        return;
+                    }
                     uint32_t sid;
                     if(ToR_Rouding){
                         uint32_t choose_host_ip = Settings::TorSwitch_nodelist[m_switch_id][host_round_index];
@@ -572,6 +618,7 @@ namespace ns3 {
                     ackTag.SetLastSwitchId(m_switch_id);
                     ackTag.SetHostId(sid);
                     p->AddPacketTag(ackTag);
+                    AckFeedbackSampler::CountHop(ackTag.GetSerializedSize());
 
                     if (ACK_log){
                         printf("ACK info: current: Src switch %d \n", m_switch_id);
@@ -637,12 +684,10 @@ namespace ns3 {
                     best_pathCE_Table[host_ip]._updateTime = now;
                     best_pathCE_Table[host_ip]._ce = remoteBestCE;
                     best_pathCE_Table[host_ip]._inPort = inPort;
-                    std::vector<uint8_t> path;
-                    path.push_back((uint8_t(inPort)));
-                    std::vector<uint8_t> fullpath = uint32_to_uint8(ackTag.GetBestPathId());
-                    for (int i = 0; i < ackTag.GetLength(); i++) {
-                        path.push_back(fullpath [i]);
-                    }  
+                    PathCodec::Ports path;
+                    path.push_back((uint16_t(inPort)));
+                    PathCodec::Ports fullpath = PathId2Ports(ackTag.GetBestPathId());
+                    path.insert(path.end(), fullpath.begin(), fullpath.end());
                     best_pathCE_Table[host_ip]._path = path;
                 }
                 if(BestTable_log){
@@ -677,12 +722,10 @@ namespace ns3 {
                 uint32_t flag = PathChoiceFlagMap[host_ip];
                 PathChoiceInfo newPathChoice;
                 if (M_is_usable){
-                    std::vector<uint8_t> path;
-                    path.push_back((uint8_t(inPort)));
-                    std::vector<uint8_t> fullpath = uint32_to_uint8(ackTag.GetMPathId());
-                    for (int i = 0; i < ackTag.GetLength(); i++) {
-                        path.push_back(fullpath [i]);
-                    }  
+                    PathCodec::Ports path;
+                    path.push_back((uint16_t(inPort)));
+                    PathCodec::Ports fullpath = PathId2Ports(ackTag.GetMPathId());
+                    path.insert(path.end(), fullpath.begin(), fullpath.end());
                     newPathChoice._path = path;
                     newPathChoice._updateTime = now;
                     newPathChoice._is_used = false;
@@ -724,17 +767,17 @@ namespace ns3 {
         
                 fprintf(Settings::caverLog, "Time:%ld, Switch:%u, Did:%u, update:%d, M_is_usable:%d, totalBestCe:%u|", 
                     Simulator::Now().GetNanoSeconds(), m_switch_id, host_id, update, M_is_usable, totalBestCE);
-                std::vector<uint8_t> path;
-                path.push_back((uint8_t(inPort)));
-                std::vector<uint8_t> fullpath = uint32_to_uint8(ackTag.GetMPathId());
-                for (int i = 0; i < ackTag.GetLength(); i++) {
-                    path.push_back(fullpath[i]);
-                }                  
+                PathCodec::Ports path;
+                path.push_back((uint16_t(inPort)));
+                PathCodec::Ports fullpath = PathId2Ports(ackTag.GetMPathId());
+                path.insert(path.end(), fullpath.begin(), fullpath.end());
                 auto node_path = getPathNodeIds(path, m_switch_id);
                 for (uint32_t node_id : node_path) {
                     fprintf(Settings::caverLog,"%u ", node_id);
                 }
-                fprintf(Settings::caverLog, "\n");p->RemovePacketTag(ackTag);
+                fprintf(Settings::caverLog, "\n");
+                AckFeedbackSampler::CountHop(0);  // feedback consumed here
+                p->RemovePacketTag(ackTag);
                 
                 DoSwitchSendToDev(p, ch);
                 if(Packet_begin_end_flag){
@@ -744,6 +787,10 @@ namespace ns3 {
             }
             // Agg/Core switch
             // *******************************the best information carried by packet**********************//
+            if (!found && AckFeedbackSampler::Enabled()) {
+                DoSwitchSendToDev(p, ch);  // ACK sampled out at its source ToR
+                return;
+            }
             assert(found && "If not ToR (leaf), CaverTag should be found");
             uint32_t last_swtich = ackTag.GetLastSwitchId();
             uint32_t inPort = id2Port[last_swtich];
@@ -793,12 +840,10 @@ namespace ns3 {
                 best_pathCE_Table[host_ip]._ce = remoteBestCE;
                 best_pathCE_Table[host_ip]._inPort = inPort;
                 currentBestCE = totalBestCE;
-                std::vector<uint8_t> path;
-                path.push_back((uint8_t(inPort)));
-                std::vector<uint8_t> fullpath = uint32_to_uint8(ackTag.GetBestPathId());
-                for (int i = 0; i < ackTag.GetLength(); i++) {
-                    path.push_back(fullpath [i]);
-                }  
+                PathCodec::Ports path;
+                path.push_back((uint16_t(inPort)));
+                PathCodec::Ports fullpath = PathId2Ports(ackTag.GetBestPathId());
+                path.insert(path.end(), fullpath.begin(), fullpath.end());
                 best_pathCE_Table[host_ip]._path = path;
             }
             if(BestTable_log){
@@ -829,18 +874,16 @@ namespace ns3 {
             // *******************************store acceptable path in current acceptabl path table中**********************//
             uint32_t new_avaliable_path_localCE;
             if (M_is_usable){
-                std::vector<uint8_t> path;
-                path.push_back((uint8_t(inPort)));
-                std::vector<uint8_t> fullpath = uint32_to_uint8(ackTag.GetMPathId());
+                PathCodec::Ports path;
+                path.push_back((uint16_t(inPort)));
+                PathCodec::Ports fullpath = PathId2Ports(ackTag.GetMPathId());
                 if(Caver_debug){
                     printf("fullpath : ");
                     showPathVec(fullpath);
                     std::cout.flush();
                 }
                 std::cout.flush(); 
-                for (int i = 0; i < ackTag.GetLength(); i++) {
-                    path.push_back(fullpath[i]);
-                }  
+                path.insert(path.end(), fullpath.begin(), fullpath.end());
                 if(Caver_debug){
                     printf("ACKTAG:length: %d\n", ackTag.GetLength());
                     printf("path : ");
@@ -909,6 +952,7 @@ namespace ns3 {
             ackTag.SetLastSwitchId(m_switch_id);
             ackTag.SetHostId(host_id);
             p->AddPacketTag(ackTag);
+            AckFeedbackSampler::CountHop(ackTag.GetSerializedSize());
             if (ACK_log){
                 printf("Send ACK with CAVER Tag\n");
                 showCaverAck_info(ackTag, ch);
@@ -1063,39 +1107,10 @@ namespace ns3 {
         std::cout << std::endl;
         return choice;
     }
-    uint32_t CaverRouting::Vector2PathId(std::vector<uint8_t> vec) {
-        uint32_t result = 0; 
-        result |= vec[0];
-
-        for (size_t i = 1; i < vec.size(); ++i) {
-            result <<= 8; 
-            result |= vec[i]; 
-        }
-
-        size_t remainingBytes = 4 - vec.size();
-        while (remainingBytes > 0) {
-            result <<= 8; // 左移 8 位
-            --remainingBytes;
-        }
-
-        return result;
-    }
+    uint32_t CaverRouting::Vector2PathId(const PathCodec::Ports& vec) { return PathCodec::Intern(vec); }
     // *******************************Add end**********************//
-    uint32_t CaverRouting::mergePortAndVector(uint8_t port, std::vector<uint8_t> vec) {
-        uint32_t result = port; 
-
-        for (size_t i = 0; i < vec.size(); ++i) {
-            result <<= 8; 
-            result |= vec[i]; 
-        }
-
-        size_t remainingBytes = 3 - vec.size();
-        while (remainingBytes > 0) {
-            result <<= 8; 
-            --remainingBytes;
-        }
-
-        return result;
+    uint32_t CaverRouting::mergePortAndVector(uint32_t port, const PathCodec::Ports& vec) {
+        return PathCodec::Prepend(port, vec);
     }
     void CaverRouting::SetConstants(Time dreTime, Time agingTime, Time flowletTimeout,
                                     uint32_t quantizeBit, double alpha, double ce_threshold, Time patchoiceTimeout, uint32_t pathChoice_num, 
@@ -1286,16 +1301,12 @@ namespace ns3 {
         uint32_t ack_dst_id = Settings::hostIp2IdMap[ch.dip];
         uint32_t flowid = Settings::PacketId2FlowId[std::make_tuple(Settings::hostIp2IdMap[ch.dip], Settings::hostIp2IdMap[ch.sip], ch.udp.dport, ch.udp.sport)];
         printf("ACK of flow id: %d, Ack from host %d to host %d\n", flowid, ack_src_id, ack_dst_id);
-        std::vector<uint8_t> fullMPath = uint32_to_uint8(ackTag.GetMPathId());
-        std::vector<uint8_t> showMPath;
-        for (int i = 0; i < ackTag.GetLength(); i++) {
-            showMPath.push_back(fullMPath[i]);
-        }
-        std::vector<uint8_t> fullBestPath = uint32_to_uint8(ackTag.GetBestPathId());
-        std::vector<uint8_t> showBestPath;
-        for (int i = 0; i < ackTag.GetLength(); i++) {
-            showBestPath.push_back(fullBestPath[i]);
-        }
+        PathCodec::Ports fullMPath = PathId2Ports(ackTag.GetMPathId());
+        PathCodec::Ports showMPath;
+        showMPath.insert(showMPath.end(), fullMPath.begin(), fullMPath.end());
+        PathCodec::Ports fullBestPath = PathId2Ports(ackTag.GetBestPathId());
+        PathCodec::Ports showBestPath;
+        showBestPath.insert(showBestPath.end(), fullBestPath.begin(), fullBestPath.end());
         std::cout << "m_last_switch_id" << ackTag.GetLastSwitchId() << std::endl;
         std::cout << "m_host_id: " << ackTag.GetHostId() << std::endl;
         std::cout << "m_length: " << static_cast<unsigned int>(ackTag.GetLength())<<std::endl;
@@ -1330,7 +1341,7 @@ namespace ns3 {
         std::cout << "SrcRoute: " << (rc.SrcRoute ? "true" : "false") << "\n";
         std::cout << "outPort: " << rc.outPort << "\n";
         if(rc.SrcRoute){
-            std::vector<uint8_t> Path = rc.pathVec;
+            PathCodec::Ports Path = rc.pathVec;
             std::cout << "path_id: ";
             for (int i = 0; i < Path.size(); i++) {
                 std::cout << static_cast<int>(Path[i]) << "->";
@@ -1342,8 +1353,8 @@ namespace ns3 {
         std::cout << "SrcRoute: " << (udpTag.GetSrcRouteEnable() == 1 ? "true" : "false") << "\n";
         std::cout << "hopCount: " << udpTag.GetHopCount() << "\n";
         std::cout << "pathId: " ;
-        std::vector<uint8_t> showpath = uint32_to_uint8(udpTag.GetPathId());
-        for (int i = 0; i < 4; i++) {
+        PathCodec::Ports showpath = PathId2Ports(udpTag.GetPathId());
+        for (int i = 0; i < showpath.size(); i++) {
             std::cout << static_cast<int>(showpath[i]) << "->";
         }
         std::cout << std::endl;
@@ -1366,20 +1377,20 @@ namespace ns3 {
         }
     }
 
-    void CaverRouting::showPathVec(std::vector<uint8_t> path){
+    void CaverRouting::showPathVec(PathCodec::Ports path){
         for (int i = 0; i < path.size(); i++) {
             std::cout << static_cast<int>(path[i]) << "->";
         }
         std::cout << std::endl;
     }
 
-    std::vector<uint32_t> CaverRouting::getPathNodeIds(const std::vector<uint8_t>& pathVec, uint32_t currentNodeId) {
+    std::vector<uint32_t> CaverRouting::getPathNodeIds(const PathCodec::Ports& pathVec, uint32_t currentNodeId) {
         std::vector<uint32_t> nodePath;
         uint32_t currentNode = currentNodeId;
 
         nodePath.push_back(currentNode);
 
-        for (uint8_t outPortId : pathVec) {
+        for (uint16_t outPortId : pathVec) {
             assert(Settings::m_nodeInterfaceMap.find(currentNode) != Settings::m_nodeInterfaceMap.end() &&
                "Current node ID not found in m_nodeInterfaceMap.");
 
@@ -1432,11 +1443,9 @@ namespace ns3 {
                 throw std::runtime_error("List is empty");
             }
 
-            std::random_device rd;
-            std::mt19937 gen(rd());
             std::uniform_int_distribution<> dis(0, myList.size() - 1);
 
-            int randomIndex = dis(gen);
+            int randomIndex = dis(m_rng);
 
             auto it = myList.begin();
             std::advance(it, randomIndex);
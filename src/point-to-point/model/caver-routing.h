@@ -33,13 +33,17 @@
 #include <unordered_map>
 #include <vector>
 #include <list>
+#include <random>
 
+#include "ns3/ack-feedback-sampler.h"
 #include "ns3/address.h"
 #include "ns3/callback.h"
 #include "ns3/event-id.h"
+#include "ns3/load-balancer.h"
 #include "ns3/net-device.h"
 #include "ns3/object.h"
 #include "ns3/packet.h"
+#include "ns3/path-codec.h"
 #include "ns3/ptr.h"
 #include "ns3/settings.h"
 #include "ns3/simulator.h"
@@ -51,14 +55,14 @@ const uint32_t CAVER_NULL = UINT32_MAX;
 
 struct bestCaverInfo{
     uint32_t _ce;
-    std::vector<uint8_t> _path;
+    PathCodec::Ports _path;
     Time _updateTime;
     bool _valid;
     uint32_t _inPort;
 };// Represents the best path entries stored on intermediate switches and tor.
 
 struct PathChoiceInfo{
-    std::vector<uint8_t> _path;
+    PathCodec::Ports _path;
     Time _updateTime;
     bool _is_used;
     // The purpose of the following items is for comparison with the optimal path
@@ -70,7 +74,7 @@ struct CaverRouteChoice{
     uint32_t outPort;
     uint32_t pathid;
     // The purpose of the following two items is for comparison with the optimal path
-    std::vector<uint8_t> pathVec;
+    PathCodec::Ports pathVec;
     uint32_t remoteCE;
 };// Caver source tor path selection result
 
@@ -131,7 +135,7 @@ class CaverAckTag : public Tag{
         uint32_t m_host_id;
 };
 
-class CaverRouting : public Object {
+class CaverRouting : public LoadBalancer {
 
     friend class SwitchMmu;
     friend class SwitchNode;
@@ -148,12 +152,17 @@ class CaverRouting : public Object {
 
     /* main function */
     void RouteInput(Ptr<Packet> p, CustomHeader ch);
+    virtual bool Ingress(Ptr<Packet> p, CustomHeader& ch);  // takes every packet: RouteInput
+    virtual void OnRouted(Ptr<Packet> p, CustomHeader& ch, uint32_t outDev);  // local DRE of table-routed data
     uint32_t UpdateLocalDre(Ptr<Packet> p, CustomHeader ch, uint32_t outPort);
+    uint32_t AddLocalDre(uint32_t outPort, uint32_t bytes);
+    virtual void OnFluidTx(uint32_t outDev, uint64_t bytes);  // fluid bytes into the local DRE
+    virtual void ReportMemory(MemoryAccounting::Report& report);  // path tables, flowlet table
     uint32_t QuantizingX(uint32_t outPort, uint32_t X);  // X is bytes here and we quantizing it to 0 - 2^Q
     virtual void DoDispose();
-    uint32_t mergePortAndVector(uint8_t port, const std::vector<uint8_t> vec);
-    uint32_t Vector2PathId(std::vector<uint8_t> vec);
-    std::vector<uint8_t> uint32_to_uint8(uint32_t number);
+    uint32_t mergePortAndVector(uint32_t port, const PathCodec::Ports& vec);
+    uint32_t Vector2PathId(const PathCodec::Ports& vec);
+    PathCodec::Ports PathId2Ports(uint32_t pathId);
 
     std::map<uint32_t, uint32_t> id2Port;// Maintains a mapping from switch's neighbor id to port id
 
@@ -163,11 +172,6 @@ class CaverRouting : public Object {
     void DoSwitchSend(Ptr<Packet> p, CustomHeader& ch, uint32_t outDev,
                       uint32_t qIndex);  // TxToR and Agg/CoreSw
     void DoSwitchSendToDev(Ptr<Packet> p, CustomHeader& ch);  // only at RxToR
-    typedef Callback<void, Ptr<Packet>, CustomHeader&, uint32_t, uint32_t> SwitchSendCallback;
-    typedef Callback<void, Ptr<Packet>, CustomHeader&> SwitchSendToDevCallback;
-    void SetSwitchSendCallback(SwitchSendCallback switchSendCallback);  // set callback
-    void SetSwitchSendToDevCallback(
-        SwitchSendToDevCallback switchSendToDevCallback);  // set callback
     /*-----------*/
 
     /* SET functions */
@@ -183,6 +187,9 @@ class CaverRouting : public Object {
                       bool useEWMA);
     void SetSwitchInfo(bool isToR, uint32_t switch_id);
     void SetLinkCapacity(uint32_t outPort, uint64_t bitRate);
+    /* seed of the choice among equally good paths (getRandomElement), drawn at construction */
+    void SetRandomSeed(uint32_t seed);
+    uint32_t GetRandomSeed(void) const { return m_randomSeed; }
 
     // periodic events
     EventId m_dreEvent;
@@ -214,11 +221,11 @@ class CaverRouting : public Object {
     void showDreTable();
     void showglobalDreTable();
     void showPortCE(uint32_t port);
-    void showPathVec(std::vector<uint8_t>path);
+    void showPathVec(PathCodec::Ports path);
     void showOptimalvsCaver(CustomHeader ch, CaverRouteChoice caver);
     int getRandomElement(const std::list<int>& myList);
     // Performance monitoring-related functions
-    std::vector<uint32_t> getPathNodeIds(const std::vector<uint8_t>& pathVec, uint32_t currentNodeId);// Convert pathVec to nodeIdVec
+    std::vector<uint32_t> getPathNodeIds(const PathCodec::Ports& pathVec, uint32_t currentNodeId);// Convert pathVec to nodeIdVec
 
     // Performance analysis monitoring log
     bool Dive_optimal_log = false;
@@ -244,12 +251,12 @@ class CaverRouting : public Object {
     uint32_t m_pathChoice_num; // Number of paths stored in each destination of the PathChoiceTable
 
     private:
-        SwitchSendCallback m_switchSendCallback;  // bound to SwitchNode::SwitchSend (for Request/UDP)
-        SwitchSendToDevCallback m_switchSendToDevCallback;  // bound to SwitchNode::SendToDevContinue (for Probe, Reply)
 
         // topology parameters
         bool m_isToR;          // is ToR (leaf)
         uint32_t m_switch_id;  // switch's nodeID      
+        uint32_t m_randomSeed;
+        std::mt19937 m_rng;    // getRandomElement
 
         // dv constants  
         Time m_agingTime;        // dre algorithm (e.g., 10ms)
@@ -270,6 +277,7 @@ class CaverRouting : public Object {
         std::map<uint32_t, uint32_t> m_DreMap;        // outPort -> DRE (at SrcToR)
         std::map<uint64_t, Caver_Flowlet*> m_flowletTable;  // QpKey -> Flowlet (at SrcToR)
 
+        AckFeedbackSampler m_ackSampler;  // ACK feedback sampling (at SrcToR)
         uint32_t host_round_index;
         uint32_t ToR_host_num;
 
@@ -0,0 +1,364 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CAVER-LB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "ns3/cdf-flow-generator.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+namespace ns3 {
+
+/*---------------------------------- PyRandom ----------------------------------*/
+
+void PyRandom::InitGenRand(uint32_t s) {
+    m_mt[0] = s;
+    for (m_mti = 1; m_mti < N; m_mti++) {
+        m_mt[m_mti] = 1812433253u * (m_mt[m_mti - 1] ^ (m_mt[m_mti - 1] >> 30)) + m_mti;
+    }
+}
+
+void PyRandom::InitByArray(const uint32_t* key, uint32_t len) {
+    InitGenRand(19650218u);
+    uint32_t i = 1, j = 0;
+    for (uint32_t k = (N > len ? N : len); k; k--) {
+        m_mt[i] = (m_mt[i] ^ ((m_mt[i - 1] ^ (m_mt[i - 1] >> 30)) * 1664525u)) + key[j] + j;
+        i++;
+        j++;
+        if (i >= N) {
+            m_mt[0] = m_mt[N - 1];
+            i = 1;
+        }
+        if (j >= len) j = 0;
+    }
+    for (uint32_t k = N - 1; k; k--) {
+        m_mt[i] = (m_mt[i] ^ ((m_mt[i - 1] ^ (m_mt[i - 1] >> 30)) * 1566083941u)) - i;
+        i++;
+        if (i >= N) {
+            m_mt[0] = m_mt[N - 1];
+            i = 1;
+        }
+    }
+    m_mt[0] = 0x80000000u;
+}
+
+void PyRandom::Seed(uint64_t seed) {
+    uint32_t key[2] = {(uint32_t)seed, (uint32_t)(seed >> 32)};
+    InitByArray(key, key[1] ? 2 : 1);
+}
+
+uint32_t PyRandom::GenRand() {
+    static const uint32_t mag01[2] = {0x0u, 0x9908b0dfu};
+    const uint32_t UPPER = 0x80000000u, LOWER = 0x7fffffffu;
+    uint32_t y;
+    if (m_mti >= N) {
+        uint32_t kk;
+        for (kk = 0; kk < N - M; kk++) {
+            y = (m_mt[kk] & UPPER) | (m_mt[kk + 1] & LOWER);
+            m_mt[kk] = m_mt[kk + M] ^ (y >> 1) ^ mag01[y & 0x1u];
+        }
+        for (; kk < N - 1; kk++) {
+            y = (m_mt[kk] & UPPER) | (m_mt[kk + 1] & LOWER);
+            m_mt[kk] = m_mt[kk + (M - N)] ^ (y >> 1) ^ mag01[y & 0x1u];
+        }
+        y = (m_mt[N - 1] & UPPER) | (m_mt[0] & LOWER);
+        m_mt[N - 1] = m_mt[M - 1] ^ (y >> 1) ^ mag01[y & 0x1u];
+        m_mti = 0;
+    }
+    y = m_mt[m_mti++];
+    y ^= (y >> 11);
+    y ^= (y << 7) & 0x9d2c5680u;
+    y ^= (y << 15) & 0xefc60000u;
+    y ^= (y >> 18);
+    return y;
+}
+
+double PyRandom::Random() {
+    uint32_t a = GenRand() >> 5, b = GenRand() >> 6;
+    return (a * 67108864.0 + b) * (1.0 / 9007199254740992.0);
+}
+
+uint32_t PyRandom::GetRandBits(uint32_t k) {
+    assert(k >= 1 && k <= 32);
+    return GenRand() >> (32 - k);
+}
+
+int64_t PyRandom::RandInt(int64_t a, int64_t b) {
+    uint64_t n = b - a + 1;
+    assert(a <= b && n <= 0xffffffffu);
+    uint32_t k = 64 - __builtin_clzll(n);  // n.bit_length()
+    uint64_t r = GetRandBits(k);
+    while (r >= n) r = GetRandBits(k);
+    return a + (int64_t)r;
+}
+
+/*---------------------------------- NpRandom ----------------------------------*/
+
+void NpRandom::Seed(uint32_t seed) {
+    InitGenRand(seed);
+    m_mti = N;
+    m_hasGauss = false;
+    m_gauss = 0;
+}
+
+double NpRandom::Normal(double loc, double scale) {
+    if (m_hasGauss) {
+        m_hasGauss = false;
+        return loc + scale * m_gauss;
+    }
+    double f, x1, x2, r2;
+    do {
+        x1 = 2.0 * Random() - 1.0;
+        x2 = 2.0 * Random() - 1.0;
+        r2 = x1 * x1 + x2 * x2;
+    } while (r2 >= 1.0 || r2 == 0.0);
+    f = std::sqrt(-2.0 * std::log(r2) / r2);
+    m_gauss = f * x1;
+    m_hasGauss = true;
+    return loc + scale * (f * x2);
+}
+
+/*------------------------------ CdfFlowGenerator ------------------------------*/
+
+CdfFlowGenerator::CdfFlowGenerator()
+    : m_avg(0),
+      m_nhost(0),
+      m_load(0),
+      m_bandwidth(0),
+      m_endNs(0),
+      m_seed(0),
+      m_pattern(POISSON),
+      m_mix(0),
+      m_podsize(1),
+      m_sectionFlows(0),
+      m_flowIntervalCoef(0),
+      m_avgInterArrival(0),
+      m_avgSectionInterval(0),
+      m_flowInterval(0),
+      m_counted(false),
+      m_dryRun(false),
+      m_pendingSeq(0),
+      m_hostHas(false) {}
+
+bool CdfFlowGenerator::SetCdf(const std::string& filename) {
+    std::ifstream fin(filename.c_str());
+    if (!fin.is_open()) return false;
+    m_cdf.clear();
+    std::string line;
+    while (std::getline(fin, line)) {
+        std::istringstream ss(line);
+        std::string x, y;
+        if (!(ss >> x >> y)) continue;
+        m_cdf.push_back(std::make_pair(strtod(x.c_str(), NULL), strtod(y.c_str(), NULL)));
+    }
+    // CustomRand.testCdf
+    if (m_cdf.size() < 2 || m_cdf.front().second != 0 || m_cdf.back().second != 100) return false;
+    for (size_t i = 1; i < m_cdf.size(); i++) {
+        if (m_cdf[i].second <= m_cdf[i - 1].second || m_cdf[i].first <= m_cdf[i - 1].first)
+            return false;
+    }
+    // CustomRand.getAvg
+    double s = 0, lastX = m_cdf[0].first, lastY = m_cdf[0].second;
+    for (size_t i = 1; i < m_cdf.size(); i++) {
+        double x = m_cdf[i].first, y = m_cdf[i].second;
+        s += (x + lastX) / 2.0 * (y - lastY);
+        lastX = x;
+        lastY = y;
+    }
+    m_avg = s / 100;
+    m_counted = false;
+    return true;
+}
+
+void CdfFlowGenerator::SetParams(uint32_t nhost, double load, double bandwidth, double timeSec,
+                                 uint32_t seed) {
+    assert(nhost >= 2);
+    m_nhost = nhost;
+    m_load = load;
+    m_bandwidth = bandwidth;
+    m_endNs = timeSec * 1e9 + BASE_T;
+    m_seed = seed;
+    m_counted = false;
+}
+
+void CdfFlowGenerator::SetPattern(Pattern pattern, double mix, uint32_t podsize,
+                                  uint32_t sectionFlows, double flowInterval) {
+    m_pattern = pattern;
+    m_mix = pattern == POISSON ? 0 : mix;
+    m_podsize = podsize;
+    m_sectionFlows = sectionFlows;
+    m_flowIntervalCoef = flowInterval;
+    m_counted = false;
+}
+
+double CdfFlowGenerator::CdfRand(PyRandom& rng) const {
+    double y = rng.Random() * 100;
+    for (size_t i = 1; i < m_cdf.size(); i++) {
+        if (y <= m_cdf[i].second) {
+            double x0 = m_cdf[i - 1].first, y0 = m_cdf[i - 1].second;
+            double x1 = m_cdf[i].first, y1 = m_cdf[i].second;
+            return x0 + (x1 - x0) / (y1 - y0) * (y - y0);
+        }
+    }
+    return m_cdf.back().first;  // not reached, y < 100
+}
+
+uint32_t CdfFlowGenerator::FlowSize(PyRandom& rng) const {
+    int64_t size = (int64_t)CdfRand(rng);
+    return size <= 0 ? 1 : (uint32_t)size;
+}
+
+uint64_t CdfFlowGenerator::Poisson(PyRandom& rng, double lam) {
+    return (uint64_t)(-std::log(1 - rng.Random()) * lam);
+}
+
+void CdfFlowGenerator::Reset(const PyRandom& sectionRng) {
+    // the scripts' expressions, in the same evaluation order
+    m_avgInterArrival = 1 / (m_bandwidth * m_load * (1 - m_mix) / 8. / m_avg) * 1000000000;
+    m_rng.Seed(m_seed);
+    m_hosts = Heap();
+    for (uint32_t i = 0; i < m_nhost; i++) {
+        m_hosts.push(Entry(BASE_T + Poisson(m_rng, m_avgInterArrival), i));
+    }
+    m_hostHas = false;
+
+    m_pods = Heap();
+    m_pending = std::priority_queue<Pending, std::vector<Pending>, std::greater<Pending> >();
+    m_pendingSeq = 0;
+    if (HasSections()) {
+        assert(m_nhost % m_podsize == 0);
+        uint32_t nPod = m_nhost / m_podsize;
+        assert(m_pattern != ALLTOALL || nPod >= 2);
+        m_flowInterval = m_avgInterArrival * m_flowIntervalCoef;
+        m_avgSectionInterval = 1 / (m_bandwidth * m_load * m_mix / 8. / m_avg) * 1000000000 *
+                               m_sectionFlows / m_podsize;
+        m_sectionRng = sectionRng;
+        m_np.Seed(m_seed);
+        for (uint32_t i = 0; i < nPod; i++) {
+            m_pods.push(Entry(BASE_T + Poisson(m_sectionRng, m_avgSectionInterval), i));
+        }
+    }
+}
+
+uint64_t CdfFlowGenerator::CountFlows() {
+    // dry run of the background process; the sections continue the random stream after it
+    Reset(m_sectionStart);
+    uint64_t n = 0;
+    Flow flow;
+    while (NextHostFlow(flow)) n++;
+    m_sectionStart = m_rng;
+    if (HasSections()) {
+        Reset(m_sectionStart);
+        m_dryRun = true;
+        while (!m_pods.empty()) n += NextSection();
+        m_dryRun = false;
+    }
+    Reset(m_sectionStart);
+    m_counted = true;
+    return n;
+}
+
+bool CdfFlowGenerator::NextHostFlow(Flow& flow) {
+    while (!m_hosts.empty()) {
+        Entry e = m_hosts.top();
+        uint64_t inter = Poisson(m_rng, m_avgInterArrival);
+        int64_t dst = m_rng.RandInt(0, m_nhost - 1);
+        while (dst == e.second) dst = m_rng.RandInt(0, m_nhost - 1);
+        m_hosts.pop();
+        if (e.first + inter > m_endNs) continue;  // this host is done
+        flow.src = e.second;
+        flow.dst = dst;
+        flow.size = FlowSize(m_rng);
+        flow.startNs = e.first;
+        m_hosts.push(Entry(e.first + inter, e.second));
+        return true;
+    }
+    return false;
+}
+
+uint32_t CdfFlowGenerator::NextSection() {
+    Entry e = m_pods.top();
+    uint32_t pod = e.second, otherPod = pod;
+    uint64_t inter = Poisson(m_sectionRng, m_avgSectionInterval);
+    if (m_pattern == ALLTOALL) {
+        uint32_t nPod = m_nhost / m_podsize;
+        while (otherPod == pod) otherPod = m_sectionRng.RandInt(0, nPod - 1);
+    }
+    m_pods.pop();
+    if (e.first + inter > m_endNs) return 0;
+
+    int64_t n = (int64_t)std::nearbyint(m_np.Normal(m_sectionFlows, 10));  // round half to even
+    uint64_t cur = e.first;
+    for (int64_t i = 0; i < n; i++) {
+        Flow flow;
+        if (m_pattern == INCAST) {  // pod is the destination pod
+            flow.dst = m_sectionRng.RandInt(m_podsize * pod, m_podsize * (pod + 1) - 1);
+            flow.src = m_sectionRng.RandInt(0, m_nhost - 1);
+            while (flow.src == flow.dst) flow.src = m_sectionRng.RandInt(0, m_nhost - 1);
+        } else {  // pod is the source pod
+            flow.src = m_sectionRng.RandInt(m_podsize * pod, m_podsize * (pod + 1) - 1);
+            flow.dst = m_sectionRng.RandInt(m_podsize * otherPod, m_podsize * (otherPod + 1) - 1);
+        }
+        flow.size = FlowSize(m_sectionRng);
+        flow.startNs = cur;
+        if (!m_dryRun) {
+            Pending p = {cur, m_pendingSeq++, flow};
+            m_pending.push(p);
+        }
+        cur += Poisson(m_sectionRng, m_flowInterval);
+    }
+    m_pods.push(Entry(e.first + inter, pod));
+    return n > 0 ? n : 0;
+}
+
+bool CdfFlowGenerator::Next(Flow& flow) {
+    if (!m_counted) CountFlows();
+    if (!m_hostHas) m_hostHas = NextHostFlow(m_hostFlow);
+    // a section starting at P only emits flows at or after P: run the sections until none
+    // can precede the current candidates (ties: background flows first, then generation order)
+    while (!m_pods.empty()) {
+        uint64_t bound = m_hostHas ? m_hostFlow.startNs : UINT64_MAX;
+        if (!m_pending.empty() && m_pending.top().startNs < bound) bound = m_pending.top().startNs;
+        if (m_pods.top().first >= bound) break;
+        NextSection();
+    }
+    if (m_hostHas && (m_pending.empty() || m_hostFlow.startNs <= m_pending.top().startNs)) {
+        flow = m_hostFlow;
+        m_hostHas = false;
+        return true;
+    }
+    if (!m_pending.empty()) {
+        flow = m_pending.top().flow;
+        m_pending.pop();
+        return true;
+    }
+    return false;
+}
+
+}  // namespace ns3
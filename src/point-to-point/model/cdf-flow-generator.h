@@ -0,0 +1,169 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CAVER-LB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * @brief MT19937 with the seeding and the derived draws of CPython's random module
+ * (random.seed(int), random.random(), random.randint()).
+ */
+class PyRandom {
+   public:
+    PyRandom() { Seed(0); }
+
+    void Seed(uint64_t seed);  // random.seed(seed), init_by_array on the 32-bit words
+    uint32_t GenRand();
+    double Random();                      // [0, 1), 53 bits
+    uint32_t GetRandBits(uint32_t k);     // k <= 32
+    int64_t RandInt(int64_t a, int64_t b);  // [a, b], rejection sampling as _randbelow
+
+   protected:
+    enum : uint32_t { N = 624, M = 397 };
+    void InitGenRand(uint32_t s);
+    void InitByArray(const uint32_t* key, uint32_t len);
+
+    uint32_t m_mt[N];
+    uint32_t m_mti;
+};
+
+/**
+ * @brief numpy's legacy RandomState: np.random.seed(int) and np.random.normal()
+ * (polar Box-Muller with the cached second deviate).
+ */
+class NpRandom : public PyRandom {
+   public:
+    NpRandom() : m_hasGauss(false), m_gauss(0) { Seed(0); }
+
+    void Seed(uint32_t seed);  // init_genrand, not init_by_array
+    double Normal(double loc, double scale);
+
+   private:
+    bool m_hasGauss;
+    double m_gauss;
+};
+
+/**
+ * @brief Native flow generator, reproducing traffic_gen/traffic_gen{,_incast,_mix}.py.
+ * 与 Python 脚本使用相同的 seed（-s/--seed）时，生成的流序列（src dst size 开始时间）
+ * 与脚本输出的文件逐条一致：
+ * - 背景流：每个 host 一个泊松到达过程，heap 按 (时间, host) 取最早的 host
+ * - INCAST / ALLTOALL：Python 在背景流全部生成之后才继续同一个 random 流生成 section，
+ *   因此 CountFlows() 先空跑一遍背景流（不保存流），记下此时的 MT 状态作为 section 的随机流
+ * - 输出顺序等价于 Python 的稳定排序：按开始时间，时间相同时背景流在前、其余按生成顺序
+ * 流是按需生成的（Next() 每次一条），内存只与 host / pod 数以及正在进行的 section 有关。
+ */
+class CdfFlowGenerator {
+   public:
+    enum Pattern : uint32_t { POISSON = 0, INCAST = 1, ALLTOALL = 2 };
+
+    struct Flow {
+        uint32_t src, dst;
+        uint32_t size;     // bytes
+        uint64_t startNs;  // absolute, base_t included
+    };
+
+    CdfFlowGenerator();
+
+    /* "<size> <percentile>" per line, percentile from 0 to 100 (CustomRand.testCdf) */
+    bool SetCdf(const std::string& filename);
+    /**
+     * @brief same meaning as the scripts' options: -n -l -b (bps, e.g. 100e9 for 100G)
+     * -t (seconds) -s; POISSON ignores the section parameters
+     */
+    void SetParams(uint32_t nhost, double load, double bandwidth, double timeSec, uint32_t seed);
+    /* mix: -m, podsize: -p, sectionFlows / flowInterval: the scripts' flow_num / flow_interval */
+    void SetPattern(Pattern pattern, double mix, uint32_t podsize, uint32_t sectionFlows,
+                    double flowInterval);
+
+    /* the number of flows (scripts' first line); also resets the generator to the first flow */
+    uint64_t CountFlows();
+    /* the next flow in the output order, false at the end */
+    bool Next(Flow& flow);
+
+    enum : uint64_t { BASE_T = 2000000000 };  // ns, the scripts' base_t
+
+   private:
+    typedef std::pair<uint64_t, uint32_t> Entry;  // (time, host or pod)
+    typedef std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> > Heap;
+
+    struct Pending {
+        uint64_t startNs;
+        uint64_t seq;
+        Flow flow;
+        bool operator>(const Pending& o) const {
+            return startNs != o.startNs ? startNs > o.startNs : seq > o.seq;
+        }
+    };
+
+    double CdfRand(PyRandom& rng) const;
+    uint32_t FlowSize(PyRandom& rng) const;
+    static uint64_t Poisson(PyRandom& rng, double lam);
+
+    void Reset(const PyRandom& sectionRng);
+    bool NextHostFlow(Flow& flow);  // background process
+    uint32_t NextSection();         // one step of the section process, returns the flows emitted
+    bool HasSections() const { return m_pattern != POISSON && m_mix != 0; }
+
+    std::vector<std::pair<double, double> > m_cdf;
+    double m_avg;
+    uint32_t m_nhost;
+    double m_load;
+    double m_bandwidth;
+    double m_endNs;  // time + base_t, as the scripts compare it
+    uint32_t m_seed;
+    Pattern m_pattern;
+    double m_mix;
+    uint32_t m_podsize;
+    uint32_t m_sectionFlows;
+    double m_flowIntervalCoef;
+
+    double m_avgInterArrival;
+    double m_avgSectionInterval;
+    double m_flowInterval;
+
+    PyRandom m_rng;         // background flows
+    PyRandom m_sectionRng;  // sections: continues where the background flows end
+    NpRandom m_np;          // section sizes
+    PyRandom m_sectionStart;
+    bool m_counted;
+    bool m_dryRun;  // CountFlows(): sections are counted, not kept
+    Heap m_hosts;
+    Heap m_pods;
+    std::priority_queue<Pending, std::vector<Pending>, std::greater<Pending> > m_pending;
+    uint64_t m_pendingSeq;
+    bool m_hostHas;
+    Flow m_hostFlow;
+};
+
+}  // namespace ns3
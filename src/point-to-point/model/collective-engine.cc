@@ -0,0 +1,311 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CAVER-LB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "ns3/collective-engine.h"
+
+#include <assert.h>
+
+#include <algorithm>
+#include <fstream>
+#include <set>
+#include <sstream>
+
+#include "ns3/simulator.h"
+
+namespace ns3 {
+
+static const char* const COLLECTIVE_TYPE_NAMES[CollectiveEngine::NUM_TYPES] = {
+    "ring_allreduce", "tree_allreduce", "allgather", "reduce_scatter", "alltoall"};
+
+/* level of `rank` in the binary tree rooted at rank 0 */
+static uint32_t TreeLevel(uint32_t rank) {
+    uint32_t level = 0;
+    for (uint32_t r = rank + 1; r > 1; r >>= 1) level++;
+    return level;
+}
+
+CollectiveEngine::CollectiveEngine() : m_relErr(0.01), m_totalFlows(0), m_finishedJobs(0) {}
+
+const char* CollectiveEngine::TypeName(uint32_t type) {
+    return type < NUM_TYPES ? COLLECTIVE_TYPE_NAMES[type] : "unknown";
+}
+
+bool CollectiveEngine::Load(const std::string& filename) {
+    std::ifstream in(filename.c_str());
+    if (!in.is_open()) return false;
+
+    std::string line;
+    uint32_t lineNo = 0;
+    while (std::getline(in, line)) {
+        lineNo++;
+        size_t hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+        std::istringstream ss(line);
+        std::string typeName;
+        if (!(ss >> typeName)) continue;  // empty line
+
+        Job job;
+        job.type = NUM_TYPES;
+        for (uint32_t t = 0; t < NUM_TYPES; t++) {
+            if (typeName == COLLECTIVE_TYPE_NAMES[t]) job.type = t;
+        }
+        double startSec;
+        if (job.type == NUM_TYPES || !(ss >> startSec >> job.bytes >> job.pg)) {
+            fprintf(stderr, "collective job file %s:%u: cannot parse '%s'\n", filename.c_str(),
+                    lineNo, line.c_str());
+            return false;
+        }
+        job.startNs = (uint64_t)(startSec * 1e9 + 0.5);
+
+        std::string tok;
+        std::set<uint32_t> seen;
+        while (ss >> tok) {
+            uint32_t first, last;
+            size_t dash = tok.find('-');
+            if (dash == std::string::npos) {
+                first = last = std::stoul(tok);
+            } else {
+                first = std::stoul(tok.substr(0, dash));
+                last = std::stoul(tok.substr(dash + 1));
+            }
+            for (uint32_t h = first; h <= last; h++) {
+                if (!seen.insert(h).second) {
+                    fprintf(stderr, "collective job file %s:%u: host %u appears twice\n",
+                            filename.c_str(), lineNo, h);
+                    return false;
+                }
+                job.hosts.push_back(h);
+            }
+        }
+        uint32_t n = job.hosts.size();
+        if (n < 2) {
+            fprintf(stderr, "collective job file %s:%u: a job needs at least 2 hosts\n",
+                    filename.c_str(), lineNo);
+            return false;
+        }
+
+        job.depth = 0;
+        switch (job.type) {
+            case RING_ALLREDUCE:
+                job.nSteps = 2 * (n - 1);
+                break;
+            case TREE_ALLREDUCE:
+                job.depth = TreeLevel(n - 1);
+                job.nSteps = 2 * job.depth;
+                break;
+            default:  // ALLGATHER, REDUCE_SCATTER, ALLTOALL
+                job.nSteps = n - 1;
+                break;
+        }
+        job.endNs = 0;
+        job.ranksDone = 0;
+        job.ranks.resize(n);
+        job.steps.assign(job.nSteps, StepStats(m_relErr));
+        m_totalFlows += CountFlows(job);
+        m_jobs.push_back(job);
+    }
+    return true;
+}
+
+void CollectiveEngine::Peers(const Job& job, uint32_t rank, uint32_t step, uint32_t* sendTo,
+                             uint32_t* nSend, uint32_t* nRecv) const {
+    uint32_t n = job.hosts.size();
+    *nSend = 0;
+    *nRecv = 0;
+    switch (job.type) {
+        case RING_ALLREDUCE:
+        case ALLGATHER:
+        case REDUCE_SCATTER:
+            sendTo[(*nSend)++] = (rank + 1) % n;
+            *nRecv = 1;
+            break;
+        case ALLTOALL:
+            sendTo[(*nSend)++] = (rank + step + 1) % n;
+            *nRecv = 1;
+            break;
+        case TREE_ALLREDUCE: {
+            uint32_t level = TreeLevel(rank);
+            uint32_t nChildren = (2 * rank + 1 < n) + (2 * rank + 2 < n);
+            if (step < job.depth) {  // reduce: level (depth - step) -> its parent
+                if (level == job.depth - step) {
+                    sendTo[(*nSend)++] = (rank - 1) / 2;
+                } else if (level + 1 == job.depth - step) {
+                    *nRecv = nChildren;
+                }
+            } else {  // broadcast: level (step - depth) -> its children
+                if (level == step - job.depth) {
+                    for (uint32_t c = 0; c < nChildren; c++) sendTo[(*nSend)++] = 2 * rank + 1 + c;
+                } else if (level == step - job.depth + 1) {
+                    *nRecv = 1;
+                }
+            }
+            break;
+        }
+        default:
+            assert(false && "unknown collective type");
+    }
+}
+
+uint64_t CollectiveEngine::FlowBytes(const Job& job) const {
+    uint64_t bytes = job.type == TREE_ALLREDUCE ? job.bytes : job.bytes / job.hosts.size();
+    return std::max(bytes, (uint64_t)1);
+}
+
+uint64_t CollectiveEngine::CountFlows(const Job& job) const {
+    uint64_t n = job.hosts.size();
+    return job.type == TREE_ALLREDUCE ? 2 * (n - 1) : n * job.nSteps;
+}
+
+void CollectiveEngine::Start() {
+    for (uint32_t i = 0; i < m_jobs.size(); i++) {
+        Simulator::Schedule(NanoSeconds(m_jobs[i].startNs) - Simulator::Now(),
+                            &CollectiveEngine::StartJob, this, i);
+    }
+}
+
+void CollectiveEngine::StartJob(uint32_t jobId) {
+    Job& job = m_jobs[jobId];
+    for (uint32_t r = 0; r < job.ranks.size(); r++) {
+        job.ranks[r].step = 0;
+        EnterStep(jobId, r);
+    }
+}
+
+void CollectiveEngine::EnterStep(uint32_t jobId, uint32_t rank) {
+    Job& job = m_jobs[jobId];
+    RankState& rs = job.ranks[rank];
+    while (true) {
+        if (rs.step == job.nSteps) {
+            if (++job.ranksDone == job.ranks.size()) {
+                job.endNs = Simulator::Now().GetTimeStep();
+                m_finishedJobs++;
+            }
+            return;
+        }
+        uint32_t sendTo[2], nSend, nRecv;
+        Peers(job, rank, rs.step, sendTo, &nSend, &nRecv);
+        rs.pendingSends = nSend;
+        rs.pendingRecvs = nRecv;
+
+        // receives of this step that completed while the rank was still behind
+        std::unordered_map<uint64_t, uint32_t>::iterator it =
+            job.early.find(RankStepKey(rank, rs.step));
+        if (it != job.early.end()) {
+            assert(it->second <= rs.pendingRecvs);
+            rs.pendingRecvs -= it->second;
+            job.early.erase(it);
+        }
+        for (uint32_t i = 0; i < nSend; i++) Launch(jobId, rs.step, rank, sendTo[i]);
+
+        if (rs.pendingSends > 0 || rs.pendingRecvs > 0) return;
+        rs.step++;
+    }
+}
+
+void CollectiveEngine::Launch(uint32_t jobId, uint32_t step, uint32_t srcRank, uint32_t dstRank) {
+    Job& job = m_jobs[jobId];
+    uint32_t src = job.hosts[srcRank];
+    uint32_t ports = m_launcher(src, job.hosts[dstRank], job.pg, FlowBytes(job));
+
+    InFlight f;
+    f.job = jobId;
+    f.step = step;
+    f.srcRank = srcRank;
+    f.dstRank = dstRank;
+    f.startNs = Simulator::Now().GetTimeStep();
+    f.endNs = 0;
+    m_inFlight[FlowKey(src, ports >> 16, ports & 0xffff)] = f;
+
+    StepStats& st = job.steps[step];
+    st.nFlows++;
+    st.firstStartNs = std::min(st.firstStartNs, f.startNs);
+}
+
+bool CollectiveEngine::OnFlowComplete(uint32_t src, uint16_t sport, uint16_t dport) {
+    std::unordered_map<uint64_t, InFlight>::iterator it = m_inFlight.find(FlowKey(src, sport, dport));
+    if (it == m_inFlight.end()) return false;
+    InFlight f = it->second;
+    f.endNs = Simulator::Now().GetTimeStep();
+    m_inFlight.erase(it);
+    // qp_finish runs inside RdmaHw's ACK processing: start the dependent flows in a new event
+    Simulator::ScheduleNow(&CollectiveEngine::HandleCompletion, this, f);
+    return true;
+}
+
+void CollectiveEngine::HandleCompletion(InFlight f) {
+    Job& job = m_jobs[f.job];
+    StepStats& st = job.steps[f.step];
+    uint64_t fct = f.endNs - f.startNs;
+    st.fct.Add(fct);
+    st.maxFctNs = std::max(st.maxFctNs, fct);
+    st.lastEndNs = std::max(st.lastEndNs, f.endNs);
+
+    RankState& rs = job.ranks[f.srcRank];
+    assert(rs.step == f.step && rs.pendingSends > 0);
+    rs.pendingSends--;
+
+    RankState& rd = job.ranks[f.dstRank];
+    bool dstCurrent = rd.step == f.step;
+    if (dstCurrent) {
+        assert(rd.pendingRecvs > 0);
+        rd.pendingRecvs--;
+    } else {
+        assert(rd.step < f.step);
+        job.early[RankStepKey(f.dstRank, f.step)]++;
+    }
+
+    if (rs.pendingSends == 0 && rs.pendingRecvs == 0) {
+        rs.step++;
+        EnterStep(f.job, f.srcRank);
+    }
+    if (dstCurrent && rd.step == f.step && rd.pendingSends == 0 && rd.pendingRecvs == 0) {
+        rd.step++;
+        EnterStep(f.job, f.dstRank);
+    }
+}
+
+bool CollectiveEngine::Write(const char* filename) const {
+    FILE* fout = fopen(filename, "w");
+    if (fout == NULL) return false;
+    for (uint32_t i = 0; i < m_jobs.size(); i++) {
+        const Job& job = m_jobs[i];
+        fprintf(fout, "JOB %u %s %u %lu %u %lu %lu %lu\n", i, TypeName(job.type),
+                (uint32_t)job.hosts.size(), job.bytes, job.nSteps, job.startNs, job.endNs,
+                job.endNs > 0 ? job.endNs - job.startNs : 0);
+        for (uint32_t s = 0; s < job.nSteps; s++) {
+            const StepStats& st = job.steps[s];
+            bool any = st.fct.Count() > 0;
+            fprintf(fout, "STEP %u %u %lu %lu %lu %lu %lu %lu\n", i, s, st.nFlows,
+                    st.nFlows > 0 ? st.firstStartNs : 0, st.lastEndNs,
+                    any ? (uint64_t)st.fct.Quantile(0.5) : 0,
+                    any ? (uint64_t)st.fct.Quantile(0.99) : 0, st.maxFctNs);
+        }
+    }
+    fclose(fout);
+    return true;
+}
+
+}  // namespace ns3
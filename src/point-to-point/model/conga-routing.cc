@@ -102,7 +102,7 @@ uint64_t CongaRouting::GetQpKey(uint32_t dip, uint16_t sport, uint16_t dport, ui
 
 TypeId CongaRouting::GetTypeId(void) {
     static TypeId tid =
-        TypeId("ns3::CongaRouting").SetParent<Object>().AddConstructor<CongaRouting>();
+        TypeId("ns3::CongaRouting").SetParent<LoadBalancer>().AddConstructor<CongaRouting>();
 
     return tid;
 }
@@ -115,13 +115,7 @@ void CongaRouting::DoSwitchSendToDev(Ptr<Packet> p, CustomHeader& ch) {
     m_switchSendToDevCallback(p, ch);
 }
 
-void CongaRouting::SetSwitchSendCallback(SwitchSendCallback switchSendCallback) {
-    m_switchSendCallback = switchSendCallback;
-}
 
-void CongaRouting::SetSwitchSendToDevCallback(SwitchSendToDevCallback switchSendToDevCallback) {
-    m_switchSendToDevCallback = switchSendToDevCallback;
-}
 
 void CongaRouting::SetSwitchInfo(bool isToR, uint32_t switch_id) {
     m_isToR = isToR;
@@ -129,16 +123,31 @@ void CongaRouting::SetSwitchInfo(bool isToR, uint32_t switch_id) {
 }
 
 void CongaRouting::SetLinkCapacity(uint32_t outPort, uint64_t bitRate) {
-    auto it = m_outPort2BitRateMap.find(outPort);
-    if (it != m_outPort2BitRateMap.end()) {
+    if (outPort >= m_outPortBitRate.size()) {
+        m_outPortBitRate.resize(outPort + 1, 0);
+        m_dre.resize(outPort + 1, 0);
+    }
+    if (m_outPortBitRate[outPort] != 0) {
         // already exists, then check matching
-        NS_ASSERT_MSG(it->second == bitRate,
+        NS_ASSERT_MSG(m_outPortBitRate[outPort] == bitRate,
                       "bitrate already exists, but inconsistent with new input");
     } else {
-        m_outPort2BitRateMap[outPort] = bitRate;
+        m_outPortBitRate[outPort] = bitRate;
     }
 }
 
+void CongaRouting::FreezeTables() {
+    m_pathTable.Freeze(m_congaRoutingTable);
+    m_toLeafCe.assign(m_pathTable.GetNumSlots(), 0);
+    m_toLeafUpdateTime.assign(m_pathTable.GetNumSlots(), Time(0));
+    m_fromLeaf.assign(m_pathTable.GetNumToRs(), std::vector<FeedbackInfo>());
+}
+
+bool CongaRouting::Ingress(Ptr<Packet> p, CustomHeader& ch) {
+    RouteInput(p, ch);
+    return true;
+}
+
 /* CongaRouting's main function */
 void CongaRouting::RouteInput(Ptr<Packet> p, CustomHeader ch) {
     // Packet arrival time
@@ -154,6 +163,10 @@ void CongaRouting::RouteInput(Ptr<Packet> p, CustomHeader ch) {
     }
     assert(ch.l3Prot == 0x11 && "Only supports UDP data packets");
 
+    if (!m_pathTable.IsFrozen()) {
+        FreezeTables();
+    }
+
     // Turn on DRE event scheduler if it is not running
     if (!m_dreEvent.IsRunning()) {
         NS_LOG_FUNCTION("Conga routing restarts dre event scheduling, Switch:" << m_switch_id
@@ -199,17 +212,16 @@ void CongaRouting::RouteInput(Ptr<Packet> p, CustomHeader ch) {
     if (m_isToR) {     // ToR switch
         if (!found) {  // sender-side
             /*---- add piggyback info to CongaTag ----*/
-            auto fbItr = m_congaFromLeafTable.find(dstToRId);
-            NS_ASSERT_MSG(fbItr != m_congaFromLeafTable.end(),
+            uint32_t dstOrd = m_pathTable.GetOrdinal(dstToRId);
+            NS_ASSERT_MSG(dstOrd != FlatPathTable::INVALID,
                           "dstToRId cannot be found in FromLeafTable");
-            auto innerFbItr = (fbItr->second).begin();
-            if (!(fbItr->second).empty()) {
-                std::advance(innerFbItr,
-                             rand() % (fbItr->second).size());  // uniformly-random feedback
+            const std::vector<FeedbackInfo>& fbList = m_fromLeaf[dstOrd];
+            if (!fbList.empty()) {
+                const FeedbackInfo& fb = fbList[rand() % fbList.size()];  // uniformly-random feedback
                 // set values to new CongaTag
-                congaTag.SetHopCount(0);                       // hopCount
-                congaTag.SetFbPathId(innerFbItr->first);       // path
-                congaTag.SetFbMetric(innerFbItr->second._ce);  // ce
+                congaTag.SetHopCount(0);         // hopCount
+                congaTag.SetFbPathId(fb._pathId);  // path
+                congaTag.SetFbMetric(fb._ce);      // ce
             } else {
                 // empty (nothing to feedback) then set a dummy
                 congaTag.SetHopCount(0);           // hopCount
@@ -218,16 +230,11 @@ void CongaRouting::RouteInput(Ptr<Packet> p, CustomHeader ch) {
             }
 
             /*---- choosing outPort ----*/
-            struct Flowlet* flowlet = NULL;
-            auto flowletItr = m_flowletTable.find(qpkey);
+            struct Flowlet* flowlet = m_flowletTable.Find(qpkey);
             uint32_t selectedPath;
 
             // 1) when flowlet already exists
-            if (flowletItr != m_flowletTable.end()) {
-                flowlet = flowletItr->second;
-                assert(flowlet != NULL &&
-                       "Impossible in normal cases - flowlet is not correctly registered");
-
+            if (flowlet != NULL) {
                 if (now - flowlet->_activeTime <= m_flowletTimeout) {  // no timeout
                     // update flowlet info
                     flowlet->_activeTime = now;
@@ -284,12 +291,12 @@ void CongaRouting::RouteInput(Ptr<Packet> p, CustomHeader ch) {
             }
             // 2) flowlet does not exist, e.g., first packet of flow
             selectedPath = GetBestPath(dstToRId, 4);
-            struct Flowlet* newFlowlet = new Flowlet;
-            newFlowlet->_activeTime = now;
-            newFlowlet->_activatedTime = now;
-            newFlowlet->_nPackets = 1;
-            newFlowlet->_PathId = selectedPath;
-            m_flowletTable[qpkey] = newFlowlet;
+            struct Flowlet newFlowlet;
+            newFlowlet._activeTime = now;
+            newFlowlet._activatedTime = now;
+            newFlowlet._nPackets = 1;
+            newFlowlet._PathId = selectedPath;
+            m_flowletTable.Insert(qpkey, newFlowlet);
 
             // update/add CongaTag
             uint32_t outPort = GetOutPortFromPath(selectedPath, 0);
@@ -310,35 +317,33 @@ void CongaRouting::RouteInput(Ptr<Packet> p, CustomHeader ch) {
         }
         /*---- receiver-side ----*/
         // update CongaToLeaf table
-        auto toLeafItr = m_congaToLeafTable.find(srcToRId);
-        assert(toLeafItr != m_congaToLeafTable.end() && "Cannot find srcToRId from ToLeafTable");
-        auto innerToLeafItr = (toLeafItr->second).find(congaTag.GetFbPathId());
+        uint32_t srcOrd = m_pathTable.GetOrdinal(srcToRId);
+        assert(srcOrd != FlatPathTable::INVALID && "Cannot find srcToRId from ToLeafTable");
         if (congaTag.GetFbPathId() != CONGA_NULL &&
-            congaTag.GetFbMetric() != CONGA_NULL) {             // if valid feedback
-            if (innerToLeafItr == (toLeafItr->second).end()) {  // no feedback so far, then create
-                OutpathInfo outpathInfo;
-                outpathInfo._ce = congaTag.GetFbMetric();
-                outpathInfo._updateTime = now;
-                (toLeafItr->second)[congaTag.GetFbPathId()] = outpathInfo;
-            } else {  // update statistics
-                (innerToLeafItr->second)._ce = congaTag.GetFbMetric();
-                (innerToLeafItr->second)._updateTime = now;
+            congaTag.GetFbMetric() != CONGA_NULL) {  // if valid feedback
+            // feedback on a path we never sample has no effect, so it is not stored
+            uint32_t slot = m_pathTable.FindSlot(srcOrd, congaTag.GetFbPathId());
+            if (slot != FlatPathTable::INVALID) {
+                m_toLeafCe[slot] = congaTag.GetFbMetric();
+                m_toLeafUpdateTime[slot] = now;
             }
         }
 
-        // update CongaFromLeaf table
-        auto fromLeafItr = m_congaFromLeafTable.find(srcToRId);
-        assert(fromLeafItr != m_congaFromLeafTable.end() &&
-               "Cannot find srcToRId from FromLeafTable");
-        auto innerfromLeafItr = (fromLeafItr->second).find(congaTag.GetPathId());
-        if (innerfromLeafItr == (fromLeafItr->second).end()) {  // no data sent so far, then create
+        // update CongaFromLeaf table (kept sorted by pathId, same order as std::map)
+        std::vector<FeedbackInfo>& fbList = m_fromLeaf[srcOrd];
+        auto fbItr = fbList.begin();
+        while (fbItr != fbList.end() && fbItr->_pathId < congaTag.GetPathId()) {
+            ++fbItr;
+        }
+        if (fbItr == fbList.end() || fbItr->_pathId != congaTag.GetPathId()) {  // no data sent so far, then create
             FeedbackInfo feedbackInfo;
+            feedbackInfo._pathId = congaTag.GetPathId();
             feedbackInfo._ce = congaTag.GetCe();
             feedbackInfo._updateTime = now;
-            (fromLeafItr->second)[congaTag.GetPathId()] = feedbackInfo;
+            fbList.insert(fbItr, feedbackInfo);
         } else {  // update feedback
-            (innerfromLeafItr->second)._ce = congaTag.GetCe();
-            (innerfromLeafItr->second)._updateTime = now;
+            fbItr->_ce = congaTag.GetCe();
+            fbItr->_updateTime = now;
         }
 
         // remove congaTag from header
@@ -380,44 +385,30 @@ void CongaRouting::RouteInput(Ptr<Packet> p, CustomHeader ch) {
 
 // minimize the maximum link utilization
 uint32_t CongaRouting::GetBestPath(uint32_t dstToRId, uint32_t nSample) {
-    auto pathItr = m_congaRoutingTable.find(dstToRId);
-    assert(pathItr != m_congaRoutingTable.end() && "Cannot find dstToRId from ToLeafTable");
-    std::set<uint32_t>::iterator innerPathItr = pathItr->second.begin();
-    if (pathItr->second.size() >= nSample) {  // exception handling
-        std::advance(innerPathItr, rand() % (pathItr->second.size() - nSample + 1));
+    uint32_t ord = m_pathTable.GetOrdinal(dstToRId);
+    assert(ord != FlatPathTable::INVALID && "Cannot find dstToRId from ToLeafTable");
+    uint32_t slot = m_pathTable.Begin(ord);
+    uint32_t nPath = m_pathTable.Size(ord);
+    if (nPath >= nSample) {  // exception handling
+        slot += rand() % (nPath - nSample + 1);
     } else {
-        nSample = pathItr->second.size();
+        nSample = nPath;
         // std::cout << "WARNING - Conga's number of path sampling is higher than available paths.
         // Enforced to reduce nSample:" << nSample << std::endl;
     }
 
-    // path info for remote congestion, <pathId -> pathInfo>
-    auto pathInfoMap = m_congaToLeafTable[dstToRId];
-
-    // get min-max path
-    std::vector<uint32_t> candidatePaths;
+    // get min-max path over consecutive slots (remote CE of unseen paths is 0)
+    uint32_t candidatePaths[CONGA_MAX_SAMPLE];
+    uint32_t nCandidate = 0;
+    assert(nSample <= CONGA_MAX_SAMPLE && "Too many paths to sample");
     uint32_t minCongestion = CONGA_NULL;
-    for (uint32_t i = 0; i < nSample; i++) {
-        // get info of path
-        uint32_t pathId = *innerPathItr;
-        auto innerPathInfo = pathInfoMap.find(pathId);
-
-        // no info means good
-        uint32_t localCongestion = 0;
-        uint32_t remoteCongestion = 0;
-
+    for (uint32_t i = 0; i < nSample; i++, slot++) {
+        uint32_t pathId = m_pathTable.PathId(slot);
         auto outPort = GetOutPortFromPath(pathId, 0);  // outPort from pathId (TxToR)
 
         // local congestion -> get Port Util and quantize it
-        auto innerDre = m_DreMap.find(outPort);
-        if (innerDre != m_DreMap.end()) {
-            localCongestion = QuantizingX(outPort, innerDre->second);
-        }
-
-        // remote congestion
-        if (innerPathInfo != pathInfoMap.end()) {
-            remoteCongestion = innerPathInfo->second._ce;
-        }
+        uint32_t localCongestion = QuantizingX(outPort, m_dre[outPort]);
+        uint32_t remoteCongestion = m_toLeafCe[slot];
 
         // get maximum of congestion (local, remote)
         uint32_t CurrCongestion = std::max(localCongestion, remoteCongestion);
@@ -425,39 +416,45 @@ uint32_t CongaRouting::GetBestPath(uint32_t dstToRId, uint32_t nSample) {
         // filter the best path
         if (minCongestion > CurrCongestion) {
             minCongestion = CurrCongestion;
-            candidatePaths.clear();
-            candidatePaths.push_back(pathId);  // best
+            nCandidate = 0;
+            candidatePaths[nCandidate++] = pathId;  // best
         } else if (minCongestion == CurrCongestion) {
-            candidatePaths.push_back(pathId);  // equally good
+            candidatePaths[nCandidate++] = pathId;  // equally good
         }
-        std::advance(innerPathItr, 1);
     }
-    assert(candidatePaths.size() > 0 && "candidatePaths has no entry");
-    return candidatePaths[rand() % candidatePaths.size()];  // randomly choose the best path
+    assert(nCandidate > 0 && "candidatePaths has no entry");
+    return candidatePaths[rand() % nCandidate];  // randomly choose the best path
 }
 
 uint32_t CongaRouting::UpdateLocalDre(Ptr<Packet> p, CustomHeader ch, uint32_t outPort) {
-    uint32_t X = m_DreMap[outPort];
-    uint32_t newX = X + p->GetSize();
+    return AddLocalDre(outPort, p->GetSize());
+}
+
+uint32_t CongaRouting::AddLocalDre(uint32_t outPort, uint32_t bytes) {
+    assert(outPort < m_dre.size() && "Cannot find bitrate of interface");
+    uint32_t newX = m_dre[outPort] + bytes;
     // NS_LOG_FUNCTION("Old X" << X << "New X" << newX << "outPort" << outPort << "Switch" <<
     // m_switch_id << Simulator::Now());
-    m_DreMap[outPort] = newX;
+    m_dre[outPort] = newX;
     return newX;
 }
 
-uint32_t CongaRouting::GetOutPortFromPath(const uint32_t& path, const uint32_t& hopCount) {
-    return ((uint8_t*)&path)[hopCount];
+void CongaRouting::OnFluidTx(uint32_t outDev, uint64_t bytes) {
+    if (outDev >= m_dre.size()) return;  // host-facing port without a bitrate entry
+    AddLocalDre(outDev, bytes);
+    if (!m_dreEvent.IsRunning()) {
+        m_dreEvent = Simulator::Schedule(m_dreTime, &CongaRouting::DreEvent, this);
+    }
 }
 
-void CongaRouting::SetOutPortToPath(uint32_t& path, const uint32_t& hopCount,
-                                    const uint32_t& outPort) {
-    ((uint8_t*)&path)[hopCount] = outPort;
+uint32_t CongaRouting::GetOutPortFromPath(const uint32_t& path, const uint32_t& hopCount) {
+    return PathCodec::GetPort(path, hopCount);
 }
 
 uint32_t CongaRouting::QuantizingX(uint32_t outPort, uint32_t X) {
-    auto it = m_outPort2BitRateMap.find(outPort);
-    assert(it != m_outPort2BitRateMap.end() && "Cannot find bitrate of interface");
-    uint64_t bitRate = it->second;
+    assert(outPort < m_outPortBitRate.size() && m_outPortBitRate[outPort] != 0 &&
+           "Cannot find bitrate of interface");
+    uint64_t bitRate = m_outPortBitRate[outPort];
     double ratio = static_cast<double>(X * 8) / (bitRate * m_dreTime.GetSeconds() / m_alpha);
     uint32_t quantX = static_cast<uint32_t>(ratio * std::pow(2, m_quantizeBit));
     if (quantX > 3) {
@@ -476,18 +473,14 @@ void CongaRouting::SetConstants(Time dreTime, Time agingTime, Time flowletTimeou
 }
 
 void CongaRouting::DoDispose() {
-    for (auto i : m_flowletTable) {
-        delete (i.second);
-    }
+    m_flowletTable.Clear();
     m_dreEvent.Cancel();
     m_agingEvent.Cancel();
 }
 
 void CongaRouting::DreEvent() {
-    std::map<uint32_t, uint32_t>::iterator itr = m_DreMap.begin();
-    for (; itr != m_DreMap.end(); ++itr) {
-        uint32_t newX = itr->second * (1 - m_alpha);
-        itr->second = newX;
+    for (uint32_t i = 0; i < m_dre.size(); i++) {
+        m_dre[i] = m_dre[i] * (1 - m_alpha);
     }
     NS_LOG_FUNCTION(Simulator::Now());
     m_dreEvent = Simulator::Schedule(m_dreTime, &CongaRouting::DreEvent, this);
@@ -495,40 +488,39 @@ void CongaRouting::DreEvent() {
 
 void CongaRouting::AgingEvent() {
     auto now = Simulator::Now();
-    auto itr = m_congaToLeafTable.begin();  // always non-empty
-    for (; itr != m_congaToLeafTable.end(); ++itr) {
-        auto innerItr = (itr->second).begin();
-        for (; innerItr != (itr->second).end(); ++innerItr) {
-            if (now - (innerItr->second)._updateTime > m_agingTime) {
-                (innerItr->second)._ce = 0;
-            }
+    for (uint32_t slot = 0; slot < m_toLeafCe.size(); slot++) {
+        if (now - m_toLeafUpdateTime[slot] > m_agingTime) {
+            m_toLeafCe[slot] = 0;
         }
     }
 
-    auto itr2 = m_congaFromLeafTable.begin();
-    while (itr2 != m_congaFromLeafTable.end()) {
-        auto innerItr2 = (itr2->second).begin();
-        while (innerItr2 != (itr2->second).end()) {
-            if (now - (innerItr2->second)._updateTime > m_agingTime) {
-                innerItr2 = (itr2->second).erase(innerItr2);
+    for (auto& fbList : m_fromLeaf) {
+        auto innerItr2 = fbList.begin();
+        while (innerItr2 != fbList.end()) {
+            if (now - innerItr2->_updateTime > m_agingTime) {
+                innerItr2 = fbList.erase(innerItr2);
             } else {
                 ++innerItr2;
             }
         }
-        ++itr2;
     }
 
-    auto itr3 = m_flowletTable.begin();
-    while (itr3 != m_flowletTable.end()) {
-        if (now - ((itr3->second)->_activeTime) > m_agingTime) {
-            // delete(itr3->second); // delete pointer
-            itr3 = m_flowletTable.erase(itr3);
-        } else {
-            ++itr3;
-        }
-    }
+    Time agingTime = m_agingTime;
+    m_flowletTable.EraseIf(
+        [now, agingTime](const Flowlet& f) { return now - f._activeTime > agingTime; });
     NS_LOG_FUNCTION(Simulator::Now());
     m_agingEvent = Simulator::Schedule(m_agingTime, &CongaRouting::AgingEvent, this);
 }
 
+void CongaRouting::ReportMemory(MemoryAccounting::Report& report) {
+    report.Add("conga.flowlet", m_flowletTable.Size(), m_flowletTable.GetMemoryBytes());
+    uint64_t feedback = 0, bytes = MemoryAccounting::VectorBytes(m_fromLeaf);
+    for (auto& v : m_fromLeaf) {
+        feedback += v.size();
+        bytes += MemoryAccounting::VectorBytes(v);
+    }
+    report.Add("conga.feedback", feedback, bytes + MemoryAccounting::VectorBytes(m_toLeafCe) +
+                                               MemoryAccounting::VectorBytes(m_toLeafUpdateTime));
+}
+
 }  // namespace ns3
@@ -31,7 +31,10 @@
 #include "ns3/address.h"
 #include "ns3/callback.h"
 #include "ns3/event-id.h"
+#include "ns3/lb-flat-table.h"
+#include "ns3/load-balancer.h"
 #include "ns3/net-device.h"
+#include "ns3/path-codec.h"
 #include "ns3/object.h"
 #include "ns3/packet.h"
 #include "ns3/ptr.h"
@@ -42,13 +45,10 @@
 namespace ns3 {
 
 const uint32_t CONGA_NULL = UINT32_MAX;
+const uint32_t CONGA_MAX_SAMPLE = 16;  // upper bound of nSample in GetBestPath
 
 struct FeedbackInfo {
-    uint32_t _ce;
-    Time _updateTime;
-};
-
-struct OutpathInfo {
+    uint32_t _pathId;
     uint32_t _ce;
     Time _updateTime;
 };
@@ -86,28 +86,28 @@ class CongaTag : public Tag {
 /**
  * @brief Conga object is created for each ToR Switch
  */
-class CongaRouting : public Object {
+class CongaRouting : public LoadBalancer {
     friend class SwitchMmu;
     friend class SwitchNode;
 
    public:
     CongaRouting();
 
-    /** path <-> outPort **/
-    // uint8_t pathp[4] = {uint8_t[port0], uint8_t[port1], uint8_t[port2], uint8_t[port3]}
-    // uint32_t path = *((uint32_t*) pathp);
-    // (uint8_t*)&path[0] -> port0
+    /** path <-> outPort: pathId of PathCodec (variable length) **/
 
     /* static */
     static TypeId GetTypeId(void);
     static uint64_t GetQpKey(uint32_t dip, uint16_t sport, uint16_t dport, uint16_t pg);              // same as in rdma_hw.cc
     static uint32_t GetOutPortFromPath(const uint32_t& path, const uint32_t& hopCount);               // decode outPort from path, given a hop's order
-    static void SetOutPortToPath(uint32_t& path, const uint32_t& hopCount, const uint32_t& outPort);  // encode outPort to path
     static uint32_t nFlowletTimeout;                                                                  // number of flowlet's timeout
 
     /* main function */
     void RouteInput(Ptr<Packet> p, CustomHeader ch);
+    virtual bool Ingress(Ptr<Packet> p, CustomHeader& ch);  // takes every packet: RouteInput
     uint32_t UpdateLocalDre(Ptr<Packet> p, CustomHeader ch, uint32_t outPort);
+    uint32_t AddLocalDre(uint32_t outPort, uint32_t bytes);
+    virtual void OnFluidTx(uint32_t outDev, uint64_t bytes);  // fluid bytes into the local DRE
+    virtual void ReportMemory(MemoryAccounting::Report& report);  // flowlet table
     uint32_t QuantizingX(uint32_t outPort, uint32_t X);  // X is bytes here and we quantizing it to 0 - 2^Q
     uint32_t GetBestPath(uint32_t dstTorId, uint32_t nSample);
     virtual void DoDispose();
@@ -124,28 +124,15 @@ class CongaRouting : public Object {
     void AgingEvent();
  
     // topological info (should be initialized in the beginning)
-    std::map<uint32_t, std::set<uint32_t> > m_congaRoutingTable;                 // routing table (ToRId -> pathId) (stable)
-    std::map<uint32_t, std::map<uint32_t, FeedbackInfo> > m_congaFromLeafTable;  // ToRId -> <pathId -> FeedbackInfo> (aged)
-    std::map<uint32_t, std::map<uint32_t, OutpathInfo> > m_congaToLeafTable;     // ToRId -> <pathId -> OutpathInfo> (aged)
-    std::map<uint32_t, uint64_t> m_outPort2BitRateMap;                           // outPort -> link bitrate (bps) (stable)
+    std::map<uint32_t, std::set<uint32_t> > m_congaRoutingTable;  // routing table (ToRId -> pathId) (stable, setup only)
 
     /*-----CALLBACK------*/
     void DoSwitchSend(Ptr<Packet> p, CustomHeader& ch, uint32_t outDev,
                       uint32_t qIndex);  // TxToR and Agg/CoreSw
     void DoSwitchSendToDev(Ptr<Packet> p, CustomHeader& ch);  // only at RxToR
-    typedef Callback<void, Ptr<Packet>, CustomHeader&, uint32_t, uint32_t> SwitchSendCallback;
-    typedef Callback<void, Ptr<Packet>, CustomHeader&> SwitchSendToDevCallback;
-    void SetSwitchSendCallback(SwitchSendCallback switchSendCallback);  // set callback
-    void SetSwitchSendToDevCallback(
-        SwitchSendToDevCallback switchSendToDevCallback);  // set callback
     /*-----------*/
     
    private:
-    // callback
-    SwitchSendCallback m_switchSendCallback;  // bound to SwitchNode::SwitchSend (for Request/UDP)
-    SwitchSendToDevCallback
-        m_switchSendToDevCallback;  // bound to SwitchNode::SendToDevContinue (for Probe, Reply)
-
     // topology parameters
     bool m_isToR;          // is ToR (leaf)
     uint32_t m_switch_id;  // switch's nodeID
@@ -157,9 +144,17 @@ class CongaRouting : public Object {
     uint32_t m_quantizeBit;  // quantizing (2**X) param (e.g., X=3)
     double m_alpha;          // dre algorithm (e.g., 0.2)
 
+    // flat tables, built from m_congaRoutingTable on the first packet
+    void FreezeTables();
+    FlatPathTable m_pathTable;                           // ToRId -> slots of pathIds
+    std::vector<uint32_t> m_toLeafCe;                    // slot -> remote CE (aged to 0)
+    std::vector<Time> m_toLeafUpdateTime;                // slot -> last feedback time
+    std::vector<std::vector<FeedbackInfo> > m_fromLeaf;  // ToR ordinal -> FeedbackInfo sorted by pathId (aged)
+    std::vector<uint64_t> m_outPortBitRate;              // outPort -> link bitrate (bps) (stable)
+
     // local
-    std::map<uint32_t, uint32_t> m_DreMap;        // outPort -> DRE (at SrcToR)
-    std::map<uint64_t, Flowlet*> m_flowletTable;  // QpKey -> Flowlet (at SrcToR)
+    std::vector<uint32_t> m_dre;                  // outPort -> DRE (at SrcToR)
+    FlowletHashTable<Flowlet> m_flowletTable;     // QpKey -> Flowlet (at SrcToR)
 };
 
 }  // namespace ns3
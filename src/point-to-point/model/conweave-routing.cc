@@ -216,23 +216,19 @@ ConWeaveRouting::ConWeaveRouting() {
     m_pathAwareRerouting = true;                  // enable path-aware rerouting
     m_agingTime = MilliSeconds(2);                // 2ms
     m_conweavePathTable.resize(65536);            // initialize table size
+    m_voqFlushTimer.SetExpireCallback(MakeCallback(&ConWeaveRouting::VOQFlushExpired, this));
 }
 
 ConWeaveRouting::~ConWeaveRouting() {}
 void ConWeaveRouting::DoDispose() { m_agingEvent.Cancel(); }
 TypeId ConWeaveRouting::GetTypeId(void) {
     static TypeId tid =
-        TypeId("ns3::ConWeaveRouting").SetParent<Object>().AddConstructor<ConWeaveRouting>();
+        TypeId("ns3::ConWeaveRouting").SetParent<LoadBalancer>().AddConstructor<ConWeaveRouting>();
     return tid;
 }
 
-uint32_t ConWeaveRouting::GetOutPortFromPath(const uint32_t &path, const uint32_t &hopCount) {
-    return ((uint8_t *)&path)[hopCount];
-}
-
-void ConWeaveRouting::SetOutPortToPath(uint32_t &path, const uint32_t &hopCount,
-                                       const uint32_t &outPort) {
-    ((uint8_t *)&path)[hopCount] = outPort;
+uint32_t ConWeaveRouting::GetOutPortFromPath(const uint32_t& path, const uint32_t& hopCount) {
+    return PathCodec::GetPort(path, hopCount);
 }
 
 uint64_t ConWeaveRouting::GetFlowKey(uint32_t ip1, uint32_t ip2, uint16_t port1, uint16_t port2) {
@@ -344,7 +340,7 @@ void ConWeaveRouting::SendReply(Ptr<Packet> p, CustomHeader &ch, uint32_t flagRe
         std::cout << "Reply info: " << Settings::hostIp2IdMap[ch.dip] << " -> " << Settings::hostIp2IdMap[ch.sip] <<" current ToR:" << m_switch_id << " Dst ToR:" << dstToRId;
         std::cout << " flow_id:" << flow_id << std::endl;
         std::cout <<" path:";
-        for (uint32_t i = 0; i < 4; i++){
+        for (uint32_t i = 0; i < PathCodec::GetLength(PathId); i++){
             std::cout << GetOutPortFromPath(PathId, i) << " ";
         }
         std:: cout << std::endl;
@@ -447,6 +443,11 @@ void ConWeaveRouting::SendNotify(Ptr<Packet> p, CustomHeader &ch, uint32_t pathI
     return;
 }
 
+bool ConWeaveRouting::Ingress(Ptr<Packet> p, CustomHeader& ch) {
+    RouteInput(p, ch);
+    return true;
+}
+
 /** MAIN: Every SLB packet is hijacked to this function at switches */
 void ConWeaveRouting::RouteInput(Ptr<Packet> p, CustomHeader &ch) {
     // Packet arrival time
@@ -1032,9 +1033,18 @@ void ConWeaveRouting::RouteInput(Ptr<Packet> p, CustomHeader &ch) {
                                 (rx_md.timeExpectedToFlush > now.GetNanoSeconds())
                                     ? (rx_md.timeExpectedToFlush - now.GetNanoSeconds())
                                     : 0;
+                            uint32_t flushKey;
+                            if (m_freeVoqFlushKeys.empty()) {
+                                flushKey = m_voqFlushKey2Flowkey.size();
+                                m_voqFlushKey2Flowkey.push_back(rx_md.pkt_flowkey);
+                            } else {
+                                flushKey = m_freeVoqFlushKeys.back();
+                                m_freeVoqFlushKeys.pop_back();
+                                m_voqFlushKey2Flowkey[flushKey] = rx_md.pkt_flowkey;
+                            }
                             voq.Set(rx_md.pkt_flowkey, ch.dip,
-                                    NanoSeconds(rx_md.timeExpectedToFlush),
-                                    m_extraVOQFlushTime); /* new deadline */
+                                    NanoSeconds(rx_md.timeExpectedToFlush), m_extraVOQFlushTime,
+                                    &m_voqFlushTimer, flushKey); /* new deadline */
                             voq.m_deleteCallback = MakeCallback(&ConWeaveRouting::DeleteVOQ, this);
                             voq.m_CallbackByVOQFlush =
                                 MakeCallback(&ConWeaveRouting::CallbackByVOQFlush, this);
@@ -1270,7 +1280,19 @@ void ConWeaveRouting::DoSwitchSendToDev(Ptr<Packet> p, CustomHeader &ch) {
 }
 
 // used for callback in VOQ
-void ConWeaveRouting::DeleteVOQ(uint64_t flowkey) { m_voqMap.erase(flowkey); }
+void ConWeaveRouting::DeleteVOQ(uint64_t flowkey) {
+    auto voq = m_voqMap.find(flowkey);
+    if (voq == m_voqMap.end()) return;
+    m_voqFlushTimer.Cancel(voq->second.m_flushKey);
+    m_freeVoqFlushKeys.push_back(voq->second.m_flushKey);
+    m_voqMap.erase(voq);
+}
+
+void ConWeaveRouting::VOQFlushExpired(uint32_t key) {
+    auto voq = m_voqMap.find(m_voqFlushKey2Flowkey[key]);
+    assert(voq != m_voqMap.end());  // sanity check
+    voq->second.EnforceFlushAll();
+}
 
 void ConWeaveRouting::CallbackByVOQFlush(uint64_t flowkey, uint32_t voqSize) {
     SLB_LOG(
@@ -1287,13 +1309,7 @@ void ConWeaveRouting::CallbackByVOQFlush(uint64_t flowkey, uint32_t voqSize) {
     rxEntry._phase = 1;
 }
 
-void ConWeaveRouting::SetSwitchSendCallback(SwitchSendCallback switchSendCallback) {
-    m_switchSendCallback = switchSendCallback;
-}
 
-void ConWeaveRouting::SetSwitchSendToDevCallback(SwitchSendToDevCallback switchSendToDevCallback) {
-    m_switchSendToDevCallback = switchSendToDevCallback;
-}
 
 uint32_t ConWeaveRouting::GetVolumeVOQ() {
     uint32_t nTotalPkts = 0;
@@ -1327,4 +1343,18 @@ void ConWeaveRouting::AgingEvent() {
     m_agingEvent = Simulator::Schedule(m_agingTime, &ConWeaveRouting::AgingEvent, this);
 }
 
+void ConWeaveRouting::ReportMemory(MemoryAccounting::Report& report) {
+    const uint64_t o = MemoryAccounting::MALLOC_OVERHEAD;
+    report.Add("conweave.tx", m_conweaveTxTable.size(), MemoryAccounting::TreeBytes(m_conweaveTxTable));
+    report.Add("conweave.rx", m_conweaveRxTable.size(), MemoryAccounting::TreeBytes(m_conweaveRxTable));
+    // a VOQ's deque holds at least one 512-byte block and its map; queued packets are Ptr'd
+    uint64_t packets = 0;
+    for (auto& it : m_voqMap) packets += it.second.m_FIFO.size();
+    report.Add("conweave.voq", m_voqMap.size(),
+               MemoryAccounting::HashBytes(m_voqMap) + m_voqMap.size() * (512 + 64 + 2 * o) +
+                   m_voqFlushTimer.GetMemoryBytes() + MemoryAccounting::VectorBytes(m_voqFlushKey2Flowkey) +
+                   MemoryAccounting::VectorBytes(m_freeVoqFlushKeys));
+    report.Add("conweave.voq_packets", packets, packets * (sizeof(Packet) + 2 * o));
+}
+
 }  // namespace ns3
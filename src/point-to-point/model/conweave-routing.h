@@ -31,8 +31,11 @@
 #include "ns3/address.h"
 #include "ns3/callback.h"
 #include "ns3/conweave-voq.h"
+#include "ns3/deadline-timer.h"
 #include "ns3/event-id.h"
+#include "ns3/load-balancer.h"
 #include "ns3/net-device.h"
+#include "ns3/path-codec.h"
 #include "ns3/object.h"
 #include "ns3/packet.h"
 #include "ns3/ptr.h"
@@ -294,13 +297,10 @@ class ConWeaveNotifyTag : public Tag {
 
 /**
  * @brief ConWeave object is created for each ToR Switch
- * -- path <-> outPort transformation --
- * uint8_t pathp[4] = {uint8_t[port0], uint8_t[port1], uint8_t[port2], uint8_t[port3]}
- * uint32_t path = *((uint32_t*) pathp);
- * (uint8_t*)&path[0] -> port0
+ * -- path <-> outPort: pathId of PathCodec (variable length) --
  */
 
-class ConWeaveRouting : public Object {
+class ConWeaveRouting : public LoadBalancer {
     friend class SwitchMmu;
     friend class SwitchNode;
 
@@ -319,8 +319,6 @@ class ConWeaveRouting : public Object {
     static uint32_t GetOutPortFromPath(
         const uint32_t& path,
         const uint32_t& hopCount);  // decode outPort from path, given a hop's order
-    static void SetOutPortToPath(uint32_t& path, const uint32_t& hopCount,
-                                 const uint32_t& outPort);  // encode outPort to path
 
     /* key */
     static uint64_t GetFlowKey(uint32_t ip1, uint32_t ip2, uint16_t port1,
@@ -334,8 +332,11 @@ class ConWeaveRouting : public Object {
     void SendReply(Ptr<Packet> p, CustomHeader& ch, uint32_t flagReply, uint32_t pkt_epoch);
     void SendNotify(Ptr<Packet> p, CustomHeader& ch, uint32_t pathId);
     void RouteInput(Ptr<Packet> p, CustomHeader& ch);  // core function
+    virtual bool Ingress(Ptr<Packet> p, CustomHeader& ch);  // takes every packet: RouteInput
+    virtual void ReportMemory(MemoryAccounting::Report& report);  // Tx/Rx tables, VOQs
 
     void DeleteVOQ(uint64_t flowkey);  // used for callback when reorder queue is flushed
+    void VOQFlushExpired(uint32_t key);  // flush deadline of a VOQ reached
     EventId m_agingEvent;
     void AgingEvent();  // aging Tx/RxTableEntry (for cleaning and improve NS-3 simulation)
 
@@ -351,11 +352,6 @@ class ConWeaveRouting : public Object {
 
     void CallbackByVOQFlush(uint64_t flowkey, uint32_t voqSize);  // used for callback in VOQ
 
-    typedef Callback<void, Ptr<Packet>, CustomHeader&, uint32_t, uint32_t> SwitchSendCallback;
-    typedef Callback<void, Ptr<Packet>, CustomHeader&> SwitchSendToDevCallback;
-    void SetSwitchSendCallback(SwitchSendCallback switchSendCallback);  // set callback
-    void SetSwitchSendToDevCallback(
-        SwitchSendToDevCallback switchSendToDevCallback);  // set callback
 
     /* topological info (should be initialized in the beginning) */
     std::map<uint32_t, std::set<uint32_t> >
@@ -376,11 +372,6 @@ class ConWeaveRouting : public Object {
     static std::vector<uint32_t> m_historyVOQSize;  // history of VOQ size
 
    private:
-    // callback
-    SwitchSendCallback m_switchSendCallback;  // bound to SwitchNode::SwitchSend (for Request/UDP)
-    SwitchSendToDevCallback
-        m_switchSendToDevCallback;  // bound to SwitchNode::SendToDevContinue (for Probe, Reply)
-
     // topology parameters
     bool m_isToR;          // is ToR (leaf)
     uint32_t m_switch_id;  // switch's nodeID
@@ -400,6 +391,10 @@ class ConWeaveRouting : public Object {
 
     // VOQ (voq.m_deleteCallback = MakeCallback(&ConWeaveRouting::deleteVoq, this); )
     std::unordered_map<uint64_t, ConWeaveVOQ> m_voqMap;  // flowkey -> FIFO Queue
+    // flush deadlines of all VOQs of this switch behind one simulator event
+    DeadlineTimer m_voqFlushTimer;
+    std::vector<uint64_t> m_voqFlushKey2Flowkey;  // DeadlineTimer key -> flowkey
+    std::vector<uint32_t> m_freeVoqFlushKeys;
 
     static uint64_t debug_time;
 };
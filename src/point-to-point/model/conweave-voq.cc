@@ -31,15 +31,18 @@ NS_LOG_COMPONENT_DEFINE("ConWeaveVOQ");
 
 namespace ns3 {
 
-ConWeaveVOQ::ConWeaveVOQ() {}
+ConWeaveVOQ::ConWeaveVOQ() : m_flushTimer(NULL), m_flushKey(DeadlineTimer::NONE) {}
 ConWeaveVOQ::~ConWeaveVOQ() {}
 
 std::vector<int> ConWeaveVOQ::m_flushEstErrorhistory; // instantiate static variable
 
-void ConWeaveVOQ::Set(uint64_t flowkey, uint32_t dip, Time timeToFlush, Time extraVOQFlushTime) {
+void ConWeaveVOQ::Set(uint64_t flowkey, uint32_t dip, Time timeToFlush, Time extraVOQFlushTime,
+                      DeadlineTimer* flushTimer, uint32_t flushKey) {
     m_flowkey = flowkey;
     m_dip = dip;
     m_extraVOQFlushTime = extraVOQFlushTime;
+    m_flushTimer = flushTimer;
+    m_flushKey = flushKey;
     RescheduleFlush(timeToFlush);
 }
 
@@ -70,7 +73,7 @@ void ConWeaveVOQ::EnforceFlushAll() {
                     CustomHeader::L4_Header);
     pkt->PeekHeader(ch);
     //printf("[%ld]Flush voq for Flow:%u in switch:%u, the first packet seq=%u\n", Simulator::Now().GetNanoSeconds(), flow_id, switch_id, ch.udp.seq);
-    m_checkFlushEvent.Cancel();               // cancel the next schedule
+    m_flushTimer->Cancel(m_flushKey);         // cancel the next schedule
     FlushAllImmediately();                    // flush VOQ immediately
 }
 
@@ -79,9 +82,9 @@ void ConWeaveVOQ::EnforceFlushAll() {
  * @param timeToFlush relative time to flush from NOW
  */
 void ConWeaveVOQ::RescheduleFlush(Time timeToFlush) {
-    if (m_checkFlushEvent.IsRunning()) {  // if already exists, reschedule it
+    if (m_flushTimer->IsPending(m_flushKey)) {  // if already exists, reschedule it
 
-        uint64_t prevEst = m_checkFlushEvent.GetTs();
+        uint64_t prevEst = m_flushTimer->GetDeadline(m_flushKey).GetTimeStep();
         if (timeToFlush.GetNanoSeconds() == 1) {
             // std::cout << (int(prevEst - Simulator::Now().GetNanoSeconds()) -
             //               m_extraVOQFlushTime.GetNanoSeconds())
@@ -89,10 +92,8 @@ void ConWeaveVOQ::RescheduleFlush(Time timeToFlush) {
             m_flushEstErrorhistory.push_back(int(prevEst - Simulator::Now().GetNanoSeconds()) -
                                              m_extraVOQFlushTime.GetNanoSeconds());
         }
-
-        m_checkFlushEvent.Cancel();
     }
-    m_checkFlushEvent = Simulator::Schedule(timeToFlush, &ConWeaveVOQ::EnforceFlushAll, this);
+    m_flushTimer->Schedule(m_flushKey, Simulator::Now() + timeToFlush);  // moved in place
 }
 
 bool ConWeaveVOQ::CheckEmpty() { return m_FIFO.empty(); }
@@ -29,7 +29,7 @@
 #include "ns3/address.h"
 #include "ns3/callback.h"
 #include "ns3/custom-header.h"
-#include "ns3/event-id.h"
+#include "ns3/deadline-timer.h"
 #include "ns3/log.h"
 #include "ns3/net-device.h"
 #include "ns3/object.h"
@@ -43,6 +43,7 @@ namespace ns3 {
 /**
  * @brief Virtual Output Queue, implemented in FIFO
  * One additional feature - Timer for flushing and destroying by itself.
+ * The flush deadline is an entry of the switch's DeadlineTimer (ConWeaveRouting::m_voqFlushTimer).
  */
 class ConWeaveVOQ {
     friend class ConWeaveRouting;
@@ -52,7 +53,8 @@ class ConWeaveVOQ {
     ~ConWeaveVOQ();
 
     // functions
-    void Set(uint64_t flowkey, uint32_t dip, Time timeToFlush, Time extraVOQFlushTime);  // setup
+    void Set(uint64_t flowkey, uint32_t dip, Time timeToFlush, Time extraVOQFlushTime,
+             DeadlineTimer* flushTimer, uint32_t flushKey);  // setup
     void Enqueue(Ptr<Packet> pkt);           // enqueue pkt FIFO
     void FlushAllImmediately();              // flush all immediately (for scheduling)
     void EnforceFlushAll();                  // enforce to flush the queue by timeout (makes OoO)
@@ -70,8 +72,8 @@ class ConWeaveVOQ {
     uint64_t m_flowkey;               // flowkey (voqMap's key)
     uint32_t m_dip;                   // destination ip (for monitoring)
     std::queue<Ptr<Packet> > m_FIFO;  // per-flow FIFO queue
-    EventId m_checkFlushEvent;  // check flush schedule is on-going (will be false once the queue
-                                // starts flushing)
+    DeadlineTimer* m_flushTimer;  // check flush schedule is on-going (m_flushKey is pending
+    uint32_t m_flushKey;          // until the queue starts flushing)
     Time m_extraVOQFlushTime; // extra flush time (for network uncertainty) -- for debugging
 
     // callback
@@ -0,0 +1,175 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CAVER-LB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#include "ns3/deadline-timer.h"
+
+#include "ns3/assert.h"
+#include "ns3/simulator.h"
+
+namespace ns3 {
+
+DeadlineTimer::DeadlineTimer()
+    : m_seq(0), m_reserve(false), m_expiring(false), m_eventAt(0), m_eventSeq(0) {}
+
+DeadlineTimer::~DeadlineTimer() { Simulator::Cancel(m_event); }
+
+void DeadlineTimer::Schedule(uint32_t key, Time at) { Schedule(key, at, Simulator::Now()); }
+
+void DeadlineTimer::Schedule(uint32_t key, Time at, Time armedAt) {
+    NS_ASSERT_MSG(at >= Simulator::Now(), "deadline in the past");
+    if (key >= m_pos.size()) m_pos.resize(key + 1, NONE);
+    // asked here rather than at construction, which may precede the choice of simulator
+    m_reserve = Simulator::CanReserve();
+    Entry e = {at.GetTimeStep(), armedAt.GetTimeStep(), m_seq++, key, 0};
+    if (m_reserve) {
+        // the uid an event scheduled now would get
+        EventId slot = Simulator::Reserve(at - Simulator::Now());
+        e.seq = slot.GetUid();
+        e.context = slot.GetContext();
+    }
+    uint32_t i = m_pos[key];
+    if (i == NONE) {
+        m_heap.push_back(e);
+        m_pos[key] = m_heap.size() - 1;
+        SiftUp(m_heap.size() - 1);
+    } else if (Earlier(e, m_heap[i])) {
+        m_heap[i] = e;
+        SiftUp(i);
+    } else {
+        m_heap[i] = e;
+        SiftDown(i);
+    }
+    Rearm();
+}
+
+void DeadlineTimer::Cancel(uint32_t key) {
+    if (!IsPending(key)) return;
+    Remove(m_pos[key]);
+    // the shared event is left in place: firing with nothing due just re-arms it
+}
+
+Time DeadlineTimer::GetDeadline(uint32_t key) const {
+    NS_ASSERT(IsPending(key));
+    return TimeStep(m_heap[m_pos[key]].at);
+}
+
+void DeadlineTimer::ExpireDue(uint32_t first, uint32_t n, Time armedAt) {
+    int64_t now = Simulator::Now().GetTimeStep();
+    int64_t before = armedAt.GetTimeStep();
+    while (true) {
+        uint32_t due = NONE;
+        for (uint32_t key = first; key < first + n; key++) {
+            if (!IsPending(key)) continue;
+            const Entry& e = m_heap[m_pos[key]];
+            if (e.at > now || (e.at == now && e.armedAt > before)) continue;
+            if (due == NONE || Earlier(m_heap[m_pos[key]], m_heap[m_pos[due]])) due = key;
+        }
+        if (due == NONE) return;
+        Remove(m_pos[due]);
+        m_expire(due);
+    }
+}
+
+void DeadlineTimer::Place(uint32_t i, const Entry& e) {
+    m_heap[i] = e;
+    m_pos[e.key] = i;
+}
+
+void DeadlineTimer::SiftUp(uint32_t i) {
+    Entry e = m_heap[i];
+    while (i > 0) {
+        uint32_t parent = (i - 1) / 2;
+        if (!Earlier(e, m_heap[parent])) break;
+        Place(i, m_heap[parent]);
+        i = parent;
+    }
+    Place(i, e);
+}
+
+void DeadlineTimer::SiftDown(uint32_t i) {
+    Entry e = m_heap[i];
+    uint32_t n = m_heap.size();
+    while (true) {
+        uint32_t child = 2 * i + 1;
+        if (child >= n) break;
+        if (child + 1 < n && Earlier(m_heap[child + 1], m_heap[child])) child++;
+        if (!Earlier(m_heap[child], e)) break;
+        Place(i, m_heap[child]);
+        i = child;
+    }
+    Place(i, e);
+}
+
+void DeadlineTimer::Remove(uint32_t i) {
+    m_pos[m_heap[i].key] = NONE;
+    Entry last = m_heap.back();
+    m_heap.pop_back();
+    if (i == m_heap.size()) return;
+    m_heap[i] = last;
+    m_pos[last.key] = i;
+    if (i > 0 && Earlier(last, m_heap[(i - 1) / 2]))
+        SiftUp(i);
+    else
+        SiftDown(i);
+}
+
+void DeadlineTimer::Rearm() {
+    if (m_heap.empty() || m_expiring) return;
+    const Entry& top = m_heap[0];
+    // an event that runs no later than the top's slot fires first and re-arms then
+    bool early = m_eventAt < top.at ||
+                 (m_eventAt == top.at && (!m_reserve || m_eventSeq <= top.seq));
+    if (m_event.IsRunning() && early) return;
+    if (m_reserve) {
+        // a removed slot can be inserted again, a cancelled one cannot
+        if (m_event.IsRunning()) Simulator::Remove(m_event);
+        EventId slot(0, top.at, top.context, top.seq);
+        if (Simulator::IsPassed(slot))  // it was queued behind a deadline since cancelled
+            m_event = Simulator::ScheduleNow(&DeadlineTimer::Expire, this);
+        else
+            m_event = Simulator::ScheduleReserved(slot, &DeadlineTimer::Expire, this);
+    } else {
+        Simulator::Cancel(m_event);
+        m_event = Simulator::Schedule(TimeStep(top.at) - Simulator::Now(), &DeadlineTimer::Expire,
+                                      this);
+    }
+    m_eventAt = m_event.GetTs();
+    m_eventSeq = m_event.GetUid();
+}
+
+void DeadlineTimer::Expire() {
+    m_expiring = true;
+    while (!m_heap.empty() && Before(m_heap[0])) {
+        uint32_t key = m_heap[0].key;
+        Remove(0);
+        m_expire(key);  // may (re)arm or cancel any key
+    }
+    m_expiring = false;
+    Rearm();
+}
+
+}  // namespace ns3
@@ -0,0 +1,110 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CAVER-LB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#pragma once
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "ns3/callback.h"
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+/**
+ * @brief Keyed deadlines in an indexed min-heap behind one simulator event.
+ * 每个 key（由使用者编号，如 QP 槽位 * 定时器种类）至多一个截止时间，改期是堆内原地调整，
+ * 不再为每次 Cancel/Schedule 往全局调度器里插事件（被取消的事件要留到到期才被清掉）。
+ * 只有最早截止时间提前时才重排那一个真实事件；推后时等事件触发再按新堆顶续上。
+ * 同一时刻到期的按 (armedAt, 入堆顺序) 出堆，与原来各自 Schedule 时的事件 uid 顺序一致。
+ * 模拟器支持时（Simulator::CanReserve），每次入堆都用 Simulator::Reserve 占一个 uid，
+ * 共享事件就插在堆顶那个 uid 上，所以和其它同一时刻的事件之间的先后也和原来一样。
+ */
+class DeadlineTimer {
+   public:
+    typedef Callback<void, uint32_t> ExpireCallback;  // key of the expired deadline
+    enum : uint32_t { NONE = UINT32_MAX };
+
+    DeadlineTimer();
+    ~DeadlineTimer();
+
+    void SetExpireCallback(ExpireCallback cb) { m_expire = cb; }
+    /* (re)arm `key` at absolute time `at`; `armedAt` is when the equivalent event would have
+     * been scheduled and only breaks ties between deadlines of the same time */
+    void Schedule(uint32_t key, Time at, Time armedAt);
+    void Schedule(uint32_t key, Time at);
+    void Cancel(uint32_t key);
+    bool IsPending(uint32_t key) const { return key < m_pos.size() && m_pos[key] != NONE; }
+    Time GetDeadline(uint32_t key) const;
+    /* fires now, in deadline order, the reached deadlines among keys [first, first + n) that
+     * were armed no later than `armedAt` (the current event's), instead of waiting for the
+     * shared event */
+    void ExpireDue(uint32_t first, uint32_t n, Time armedAt);
+    uint32_t GetSize() const { return m_heap.size(); }
+    uint64_t GetMemoryBytes() const {
+        return m_heap.capacity() * sizeof(Entry) + m_pos.capacity() * sizeof(uint32_t);
+    }
+
+   private:
+    struct Entry {
+        int64_t at;
+        int64_t armedAt;
+        uint64_t seq;  // uid of the reserved slot, or insertion order without reservations
+        uint32_t key;
+        uint32_t context;  // of the reserved slot
+    };
+    static bool Earlier(const Entry& a, const Entry& b) {
+        if (a.at != b.at) return a.at < b.at;
+        if (a.armedAt != b.armedAt) return a.armedAt < b.armedAt;
+        return a.seq < b.seq;
+    }
+    void Place(uint32_t i, const Entry& e);
+    void SiftUp(uint32_t i);
+    void SiftDown(uint32_t i);
+    void Remove(uint32_t i);
+    /* whether the slot of `e` comes no later than m_event (then it is due when m_event runs) */
+    bool Before(const Entry& e) const {
+        if (e.at != m_eventAt) return e.at < m_eventAt;
+        return !m_reserve || e.seq <= m_eventSeq;
+    }
+    void Rearm();
+    void Expire();
+
+    std::vector<Entry> m_heap;
+    std::vector<uint32_t> m_pos;  // key -> index in m_heap, NONE if not armed
+    uint64_t m_seq;
+    bool m_reserve;    // Simulator::CanReserve()
+    bool m_expiring;   // inside Expire(), which re-arms once done
+    EventId m_event;
+    int64_t m_eventAt;     // time step of m_event
+    uint64_t m_eventSeq;   // uid of m_event
+    ExpireCallback m_expire;
+};
+
+}  // namespace ns3
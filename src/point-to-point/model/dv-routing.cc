@@ -36,6 +36,7 @@
 namespace ns3 {
     std::vector<DVRouting*> DVRouting::dvModules;
     /*---- DVUdp-Tag -----*/
+    NS_OBJECT_ENSURE_REGISTERED(DVUdpTag);  // looked up by name when a route trace is replayed
     DVUdpTag::DVUdpTag() {}
     DVUdpTag::~DVUdpTag() {}
     TypeId DVUdpTag::GetTypeId(void) {
@@ -77,6 +78,7 @@ namespace ns3 {
     }
 
     /*---- DVAck-Tag -----*/
+    NS_OBJECT_ENSURE_REGISTERED(DVAckTag);
     DVAckTag::DVAckTag() {}
     DVAckTag::~DVAckTag() {}
     TypeId DVAckTag::GetTypeId(void) {
@@ -141,18 +143,13 @@ namespace ns3 {
 
     TypeId DVRouting::GetTypeId(void) {
         static TypeId tid =
-            TypeId("ns3::DVRouting").SetParent<Object>().AddConstructor<DVRouting>();
+            TypeId("ns3::DVRouting").SetParent<LoadBalancer>().AddConstructor<DVRouting>();
 
         return tid;
     }
 
     uint32_t DVRouting::GetOutPortFromPath(const uint32_t& path, const uint32_t& hopCount) {
-        std::vector<uint8_t> bytes(4);
-        bytes[0] = (path >> 24) & 0xFF; // 获取高位字节
-        bytes[1] = (path >> 16) & 0xFF;
-        bytes[2] = (path >> 8) & 0xFF;
-        bytes[3] = path & 0xFF; // 获取低位字节
-        return bytes[hopCount];
+        return PathCodec::GetPort(path, hopCount);
     }
 
     // void DVRouting::SetOutPortToPath(uint32_t& path, const uint32_t& hopCount,
@@ -168,13 +165,7 @@ namespace ns3 {
         m_switchSendToDevCallback(p, ch);
     }
 
-    void DVRouting::SetSwitchSendCallback(SwitchSendCallback switchSendCallback) {
-        m_switchSendCallback = switchSendCallback;
-    }
 
-    void DVRouting::SetSwitchSendToDevCallback(SwitchSendToDevCallback switchSendToDevCallback) {
-        m_switchSendToDevCallback = switchSendToDevCallback;
-    }
 
     void DVRouting::SetSwitchInfo(bool isToR, uint32_t switch_id) {
         m_isToR = isToR;
@@ -186,38 +177,46 @@ namespace ns3 {
     }
 
     void DVRouting::SetLinkCapacity(uint32_t outPort, uint64_t bitRate) {
-        auto it = m_outPort2BitRateMap.find(outPort);
-        if (it != m_outPort2BitRateMap.end()) {
+        if (outPort >= m_outPortBitRate.size()) {
+            m_outPortBitRate.resize(outPort + 1, 0);
+            m_dre.resize(outPort + 1, 0);
+        }
+        if (m_outPortBitRate[outPort] != 0) {
             // already exists, then check matching
-            NS_ASSERT_MSG(it->second == bitRate,
+            NS_ASSERT_MSG(m_outPortBitRate[outPort] == bitRate,
                         "bitrate already exists, but inconsistent with new input");
         } else {
-            m_outPort2BitRateMap[outPort] = bitRate;
+            m_outPortBitRate[outPort] = bitRate;
         }
     }
 
     uint32_t DVRouting::UpdateLocalDre(Ptr<Packet> p, CustomHeader ch, uint32_t outPort) {
-        uint32_t X = m_DreMap[outPort];
-        uint32_t newX = X + p->GetSize();
+        return AddLocalDre(outPort, p->GetSize());
+    }
+
+    uint32_t DVRouting::AddLocalDre(uint32_t outPort, uint32_t bytes) {
+        assert(outPort < m_dre.size() && "Cannot find bitrate of interface");
+        uint32_t newX = m_dre[outPort] + bytes;
         // NS_LOG_FUNCTION("Old X" << X << "New X" << newX << "outPort" << outPort << "Switch" <<
         // m_switch_id << Simulator::Now());
-        m_DreMap[outPort] = newX;
+        m_dre[outPort] = newX;
         return newX;
     }
 
     uint32_t DVRouting::QuantizingX(uint32_t outPort, uint32_t X) {
-        auto it = m_outPort2BitRateMap.find(outPort);
-        if (it == m_outPort2BitRateMap.end()){
+        if (outPort >= m_outPortBitRate.size() || m_outPortBitRate[outPort] == 0){
             if (Error_log){
-                for (auto it = m_outPort2BitRateMap.begin(); it != m_outPort2BitRateMap.end(); ++it) {
-                    std::cout << "Port: " << it->first << ", Rate: " << it->second << std::endl;
+                for (uint32_t port = 0; port < m_outPortBitRate.size(); port++) {
+                    if (m_outPortBitRate[port] != 0) {
+                        std::cout << "Port: " << port << ", Rate: " << m_outPortBitRate[port] << std::endl;
+                    }
                 }
                 std::cout<< "Error wrong port: Port:" << outPort << ", switch: " << m_switch_id <<  std::endl;
             }
-            assert(it != m_outPort2BitRateMap.end() && "Cannot find bitrate of interface" );
+            assert(false && "Cannot find bitrate of interface" );
 
         }
-        uint64_t bitRate = it->second;
+        uint64_t bitRate = m_outPortBitRate[outPort];
         double ratio = static_cast<double>(X * 8) / (bitRate * m_dreTime.GetSeconds() / m_alpha);
         uint32_t quantX = static_cast<uint32_t>(ratio * std::pow(2, m_quantizeBit));
         if (quantX > 3) {
@@ -225,13 +224,76 @@ namespace ns3 {
         }
         return quantX;
     }
-    std::vector<uint8_t> DVRouting::uint32_to_uint8(uint32_t number) {
-        std::vector<uint8_t> bytes(4);
-        bytes[0] = (number >> 24) & 0xFF; // 获取高位字节
-        bytes[1] = (number >> 16) & 0xFF;
-        bytes[2] = (number >> 8) & 0xFF;
-        bytes[3] = number & 0xFF; // 获取低位字节
-        return bytes;
+    singleDVInfo& DVRouting::PathCEEntry(uint32_t hostId) {
+        if (hostId >= PathCE_Table.size()) {
+            PathCE_Table.resize(hostId + 1);
+        }
+        return PathCE_Table[hostId];
+    }
+
+    DVInfo& DVRouting::PathCEPortEntry(uint32_t hostId, uint32_t port) {
+        if (hostId >= PathCE_port_Table.size()) {
+            PathCE_port_Table.resize(hostId + 1);
+        }
+        std::vector<DVInfo>& portRow = PathCE_port_Table[hostId];
+        if (port >= portRow.size()) {
+            portRow.resize(port + 1);
+        }
+        return portRow[port];
+    }
+
+    void DVRouting::PrintDreTable() {
+        for (uint32_t port = 0; port < m_dre.size(); ++port) {
+            if (m_outPortBitRate[port] == 0) {
+                continue;
+            }
+            uint32_t localce = QuantizingX(port, m_dre[port]);
+            std::cout << "Port: " << port << ", CE: " << m_dre[port] << ",localCE: " << localce << std::endl;
+        }
+    }
+
+    PathCodec::Ports DVRouting::PathId2Ports(uint32_t pathId) { return PathCodec::GetPorts(pathId); }
+    bool DVRouting::Ingress(Ptr<Packet> p, CustomHeader& ch) {
+        RouteInput(p, ch);
+        return true;
+    }
+    // 按路由表（ECMP）转发的UDP包也要计入本地Dre
+    void DVRouting::OnRouted(Ptr<Packet> p, CustomHeader& ch, uint32_t outDev) {
+        if (ch.l3Prot != 0x11) return;
+        UpdateLocalDre(p, ch, outDev);
+        if (DreTable_log) {
+            if (m_isToR)
+                printf("Dre Table: ToR switch %d\n", m_switch_id);
+            else
+                printf("Dre Table: Mid switch %d\n", m_switch_id);
+            PrintDreTable();
+        }
+    }
+    // 混合模式：流体背景流在出端口上的字节也计入本地Dre
+    void DVRouting::OnFluidTx(uint32_t outDev, uint64_t bytes) {
+        if (outDev >= m_dre.size()) return;
+        AddLocalDre(outDev, bytes);
+        if (!m_dreEvent.IsRunning()) {
+            m_dreEvent = Simulator::Schedule(m_dreTime, &DVRouting::DreEvent, this);
+        }
+    }
+    void DVRouting::ReportMemory(MemoryAccounting::Report& report) {
+        const uint64_t o = MemoryAccounting::MALLOC_OVERHEAD;
+        uint64_t entries = 0, bytes = MemoryAccounting::TreeBytes(m_DVTable);
+        for (auto& node : m_DVTable) {
+            entries += node.second.size();
+            bytes += MemoryAccounting::TreeBytes(node.second);
+            for (auto& it : node.second) bytes += MemoryAccounting::VectorBytes(it.second._path) + o;
+        }
+        bytes += MemoryAccounting::VectorBytes(PathCE_Table) + MemoryAccounting::VectorBytes(PathCE_port_Table);
+        for (auto& info : PathCE_Table) bytes += MemoryAccounting::VectorBytes(info._path) + o;
+        for (auto& ports : PathCE_port_Table) {
+            entries += ports.size();
+            bytes += MemoryAccounting::VectorBytes(ports) + o;
+            for (auto& info : ports) bytes += MemoryAccounting::VectorBytes(info._path) + o;
+        }
+        report.Add("dv.table", entries + PathCE_Table.size(), bytes);
+        report.Add("dv.flowlet", m_flowletTable.Size(), m_flowletTable.GetMemoryBytes());
     }
     void DVRouting::RouteInput(Ptr<Packet> p, CustomHeader ch){
         // Packet arrival time
@@ -262,7 +324,7 @@ namespace ns3 {
         if (m_isToR){
             uint32_t dip = ch.dip;
             uint32_t sip = ch.sip;
-            std::vector<uint32_t> server_vector = Settings::TorSwitch_nodelist[m_switch_id];
+            const std::vector<uint32_t>& server_vector = Settings::TorSwitch_nodelist[m_switch_id];
             auto src_iter = std::find(server_vector.begin(), server_vector.end(), dip);
             auto dst_iter = std::find(server_vector.begin(), server_vector.end(), sip);
             if (src_iter != server_vector.end() && dst_iter != server_vector.end()) {
@@ -281,11 +343,9 @@ namespace ns3 {
             if(m_isToR){ // ToR switch
                 if (!found) {// sender-side
                     /*---- choosing outPort ----*/
-                    struct DV_Flowlet* flowlet = NULL;
-                    auto flowletItr = m_flowletTable.find(qpkey);
-                    if (flowletItr != m_flowletTable.end()){
+                    struct DV_Flowlet* flowlet = m_flowletTable.Find(qpkey);
+                    if (flowlet != NULL){
                         // 1) when flowlet already exists   
-                        flowlet = flowletItr->second;
                         flowlet->_nPackets++;
                         uint32_t outPort;
                         uint32_t pathid;
@@ -360,12 +420,12 @@ namespace ns3 {
                     else{
                         m_choice = GetBestPath(dip, ch);
                     }
-                    struct DV_Flowlet* newFlowlet = new DV_Flowlet;
-                    newFlowlet->_nPackets = 1;
-                    newFlowlet->_SrcRoute_ENABLE = m_choice.SrcRoute;
-                    newFlowlet->_outPort = m_choice.outPort;
-                    newFlowlet->_PathId = m_choice.pathid;
-                    m_flowletTable[qpkey] = newFlowlet;
+                    struct DV_Flowlet newFlowlet;
+                    newFlowlet._nPackets = 1;
+                    newFlowlet._SrcRoute_ENABLE = m_choice.SrcRoute;
+                    newFlowlet._outPort = m_choice.outPort;
+                    newFlowlet._PathId = m_choice.pathid;
+                    m_flowletTable.Insert(qpkey, newFlowlet);
                     udpTag.SetSrcRouteEnable(m_choice.SrcRoute);
                     udpTag.SetPathId(m_choice.pathid);
                     udpTag.SetHopCount(0);
@@ -395,16 +455,7 @@ namespace ns3 {
                         uint32_t X = UpdateLocalDre(p, ch, m_choice.outPort);  // update local DRE
                         if (DreTable_log){
                             printf("Dre Table: Src switch %d\n", m_switch_id);
-                            for (auto it = m_DreMap.begin(); it != m_DreMap.end(); ++it) {
-                                uint32_t ce = it->second;
-                                if (Error_log){
-                                    if (it->first == 0){
-                                        std::cout << "Error: Port 0 should not be used" << std::endl;
-                                    }
-                                }
-                                uint32_t localce = QuantizingX(it->first, ce);
-                                std::cout << "Port: " << it->first << ", CE: " << it->second << ",localCE: " << localce << std::endl;
-                            }
+                            PrintDreTable();
                         }
                         if (Nodepass_log){
                             std::cout << "ToR switch: " << m_switch_id << " UDP packet: " << PARSE_FIVE_TUPLE(ch) << " outPort: " << m_choice.outPort <<" new flowlet" <<std::endl;
@@ -454,19 +505,15 @@ namespace ns3 {
                 if (Route_log){
                     std::cout << "Source route:" << std::endl;
                     std::cout << "outPort: " << outPort << ", hopCount: " << hopCount <<  ",path id:" << pathid <<", path: ";
-                    std::vector<uint8_t> showpath = uint32_to_uint8(pathid);
-                    for (int i = 0; i < 4; i++) {
+                    PathCodec::Ports showpath = PathId2Ports(pathid);
+                    for (int i = 0; i < showpath.size(); i++) {
                         std::cout << static_cast<int>(showpath[i]) << "->";
                     }
                     std::cout << std::endl;
                 }
                 if (DreTable_log){
                     printf("Dre Table: Mid switch %d\n", m_switch_id);
-                    for (auto it = m_DreMap.begin(); it != m_DreMap.end(); ++it) {
-                            uint32_t ce = it->second;
-                            uint32_t localce = QuantizingX(it->first, ce);
-                            std::cout << "Port: " << it->first << ", CE: " << it->second << ",localCE: " << localce << std::endl;
-                    }
+                    PrintDreTable();
                 }
                 return;
             }
@@ -486,6 +533,18 @@ namespace ns3 {
             if (m_isToR){
                 if (!found)// sender-side
                 {
+                    if (AckFeedbackSampler::Enabled()) {
+                        // an ACK without feedback coming from the fabric is not ours to tag
+                        auto sender = Settings::hostIp2IdMap.find(ch.sip);
+                        if (sender == Settings::hostIp2IdMap.end() || id2Port.find(sender->second) == id2Port.end()) {
+                            DoSwitchSendToDev(p, ch);
+                            return;
+                        }
+                    }
+                    if (!m_ackSampler.Sample(ch.dip, now.GetTimeStep())) {
+                        DoSwitchSendToDev(p, ch);  // sampled out: no feedback on this ACK
+                        return;
+                    }
                     // *******************************Add begin**********************//
                     uint32_t sid;
                     if(ToR_Rouding){
@@ -497,7 +556,7 @@ namespace ns3 {
                         sid = Settings::hostIp2IdMap[ch.sip];
                     }
                     uint32_t port = id2Port[sid];
-                    uint32_t ce = m_DreMap[port];
+                    uint32_t ce = m_dre[port];
                     uint32_t localce = QuantizingX(port, ce);
                     ackTag.SetCE(localce);
                     ackTag.SetLength(0);
@@ -505,6 +564,7 @@ namespace ns3 {
                     ackTag.SetPathId(0);
                     ackTag.SetHostId(sid);
                     p->AddPacketTag(ackTag);
+                    AckFeedbackSampler::CountHop(ackTag.GetSerializedSize());
                     if (ACK_log){
                         uint32_t ack_src_id = Settings::hostIp2IdMap[ch.sip];
                         uint32_t ack_dst_id = Settings::hostIp2IdMap[ch.dip];
@@ -514,11 +574,7 @@ namespace ns3 {
                         //显示一下本地的Dre表
                         if (DreTable_log){
                             printf("Dre Table: Src switch %d\n", m_switch_id);
-                            for (auto it = m_DreMap.begin(); it != m_DreMap.end(); ++it) {
-                                    uint32_t ce = it->second;
-                                    uint32_t localce = QuantizingX(it->first, ce);
-                                    std::cout << "Port: " << it->first << ", CE: " << it->second << ",localCE: " << localce << std::endl;
-                            }
+                            PrintDreTable();
                         }
                     }
                     DoSwitchSendToDev(p, ch);
@@ -534,7 +590,7 @@ namespace ns3 {
                     //     uint32_t localce = 0;
                     //     auto ceitr = m_DreMap.find(src_port);
                     //     if (ceitr != m_DreMap.end()) {
-                    //         uint32_t ce = m_DreMap[src_port];
+                    //         uint32_t ce = m_dre[src_port];
                     //         localce =  QuantizingX(src_port, ce);
                     //     }
                     //     std::cout << "dst ToR generate local ack: " << "port: " << src_port << ", ce: " << localce << std::endl;
@@ -572,57 +628,53 @@ namespace ns3 {
                 uint32_t last_swtich = ackTag.GetLastSwitchId();
                 uint32_t inPort = id2Port[last_swtich];
                 uint32_t remoteCE = ackTag.GetCE();
-                uint32_t ce = m_DreMap[inPort];
+                uint32_t ce = m_dre[inPort];
                 uint32_t localCE = QuantizingX(inPort, ce);
                 uint32_t totalCE = std::max(localCE, remoteCE);
                 uint32_t host_id = ackTag.GetHostId();
                 uint32_t host_ip = Settings::hostId2IpMap[host_id];
                 if (multi_PathSet){
-                    std::vector<uint8_t> path;
-                    std::vector<uint8_t> fullpath = uint32_to_uint8(ackTag.GetPathId());
-                    for (int i = 0; i < ackTag.GetLength(); i++) {
-                        path.push_back(fullpath [i]);
-                    }
-                    PathCE_port_Table[host_ip][inPort]._ce = ackTag.GetCE();
-                    PathCE_port_Table[host_ip][inPort]._path = path;
-                    PathCE_port_Table[host_ip][inPort]._valid = true;
-                    PathCE_port_Table[host_ip][inPort]._updateTime = now;
+                    PathCodec::Ports path;
+                    PathCodec::Ports fullpath = PathId2Ports(ackTag.GetPathId());
+                    path.insert(path.end(), fullpath.begin(), fullpath.end());
+                    PathCEPortEntry(host_id, inPort)._ce = ackTag.GetCE();
+                    PathCEPortEntry(host_id, inPort)._path = path;
+                    PathCEPortEntry(host_id, inPort)._valid = true;
+                    PathCEPortEntry(host_id, inPort)._updateTime = now;
                 }
                 else{
                     uint32_t currentCE = 0;
                     bool update = false;
-                    if (PathCE_Table[host_ip]._valid == false){
+                    if (PathCEEntry(host_id)._valid == false){
                         update = true;
                     }
                     else {
-                            uint32_t table_portCE = QuantizingX(PathCE_Table[host_ip]._inPort, m_DreMap[PathCE_Table[host_ip]._inPort]);
-                            currentCE = std::max(table_portCE, PathCE_Table[host_ip]._ce);
-                            if(currentCE >= totalCE or PathCE_Table[host_ip]._path[0] == inPort){
+                            uint32_t table_portCE = QuantizingX(PathCEEntry(host_id)._inPort, m_dre[PathCEEntry(host_id)._inPort]);
+                            currentCE = std::max(table_portCE, PathCEEntry(host_id)._ce);
+                            if(currentCE >= totalCE or PathCEEntry(host_id)._path[0] == inPort){
                                 update = true;
                             }
                     }
                     if (ACK_log){
                         std::cout << "before update PathCE table: " << std::endl;
-                        std::cout << "_valid: " << PathCE_Table[host_ip]._valid << std::endl; 
+                        std::cout << "_valid: " << PathCEEntry(host_id)._valid << std::endl; 
                         // uint32_t outPort = (uint32_t) PathCE_Table[ch.sip]._path[0];
-                        std::cout  << PathCE_Table[host_ip]._valid << " _ce: " << PathCE_Table[host_ip]._ce << " _path: ";
-                        for (int i = 0; i < PathCE_Table[host_ip]._path.size(); i++) {
-                            std::cout << static_cast<int>(PathCE_Table[host_ip]._path[i]) << "->";
+                        std::cout  << PathCEEntry(host_id)._valid << " _ce: " << PathCEEntry(host_id)._ce << " _path: ";
+                        for (int i = 0; i < PathCEEntry(host_id)._path.size(); i++) {
+                            std::cout << static_cast<int>(PathCEEntry(host_id)._path[i]) << "->";
                         }
                         std::cout << std::endl;
                     }
                     if(update){
-                        PathCE_Table[host_ip]._valid = true;
-                        PathCE_Table[host_ip]._updateTime = now;
-                        PathCE_Table[host_ip]._ce = remoteCE;
-                        PathCE_Table[host_ip]._inPort = inPort;
-                        std::vector<uint8_t> path;
-                        path.push_back((uint8_t(inPort)));
-                        std::vector<uint8_t> fullpath = uint32_to_uint8(ackTag.GetPathId());
-                        for (int i = 0; i < ackTag.GetLength(); i++) {
-                            path.push_back(fullpath [i]);
-                        }  
-                        PathCE_Table[host_ip]._path = path;
+                        PathCEEntry(host_id)._valid = true;
+                        PathCEEntry(host_id)._updateTime = now;
+                        PathCEEntry(host_id)._ce = remoteCE;
+                        PathCEEntry(host_id)._inPort = inPort;
+                        PathCodec::Ports path;
+                        path.push_back((uint16_t(inPort)));
+                        PathCodec::Ports fullpath = PathId2Ports(ackTag.GetPathId());
+                        path.insert(path.end(), fullpath.begin(), fullpath.end());
+                        PathCEEntry(host_id)._path = path;
                     }
                     if (ACK_log){
                         //更新前的表项，以及待判断的中间数据：
@@ -634,12 +686,10 @@ namespace ns3 {
                         printf("receive ack packet info: from switch: %d, host_id %d, host_ip %d, SrcIp: %d, currentCE %d, localCE %d, totalCE %d, inPort %d, packet CE: %d, update: %d\n",last_swtich,  host_id, host_ip, ch.sip, currentCE, localCE, totalCE, inPort, ackTag.GetCE(), intupdate);
                         std::cout << "receive ack path id: " << ackTag.GetPathId() << std::endl;
                         std::cout << "receive ack packet path: ";
-                        std::vector<uint8_t> show_path;
-                        show_path.push_back((uint8_t(inPort)));
-                        std::vector<uint8_t> fullpath = uint32_to_uint8(ackTag.GetPathId());
-                        for (int i = 0; i < ackTag.GetLength(); i++) {
-                        show_path.push_back(fullpath[i]);
-                        }  
+                        PathCodec::Ports show_path;
+                        show_path.push_back((uint16_t(inPort)));
+                        PathCodec::Ports fullpath = PathId2Ports(ackTag.GetPathId());
+                        show_path.insert(show_path.end(), fullpath.begin(), fullpath.end());
                         for (int i = 0; i < show_path.size(); i++) {
                             std::cout << static_cast<int>(show_path[i]) << "->";
                         }
@@ -647,13 +697,14 @@ namespace ns3 {
                         std::cout << "PathCE table: " << std::endl;
                         std::cout << "_valid: ";
                         // uint32_t outPort = (uint32_t) PathCE_Table[ch.sip]._path[0];
-                        std::cout  << PathCE_Table[host_ip]._valid << " _ce: " << PathCE_Table[host_ip]._ce << " _path: "<<std::endl;
-                        for (int i = 0; i < PathCE_Table[host_ip]._path.size(); i++) {
-                            std::cout << static_cast<int>(PathCE_Table[host_ip]._path[i]) << "->";
+                        std::cout  << PathCEEntry(host_id)._valid << " _ce: " << PathCEEntry(host_id)._ce << " _path: "<<std::endl;
+                        for (int i = 0; i < PathCEEntry(host_id)._path.size(); i++) {
+                            std::cout << static_cast<int>(PathCEEntry(host_id)._path[i]) << "->";
                         }
                         std::cout << std::endl;
                     }
                 }
+                AckFeedbackSampler::CountHop(0);  // feedback consumed here
                 p->RemovePacketTag(ackTag);
                 DoSwitchSendToDev(p, ch);
                 return;
@@ -666,9 +717,9 @@ namespace ns3 {
                 //     printf("receive ack packet info: from switch: %d, host_id %d, host_ip %d, SrcIp: %d, currentCE %d, localCE %d, totalCE %d, inPort %d, packet CE: %d, \n",last_swtich,  host_id, host_ip, ch.sip, currentCE, localCE, totalCE, inPort, ackTag.GetCE());
                 //     std::cout << "receive ack path id: " << ackTag.GetPathId() << std::endl;
                 //     std::cout << "receive ack packet path: ";
-                //     std::vector<uint8_t> show_path;
-                //     show_path.push_back((uint8_t(inPort)));
-                //     std::vector<uint8_t> fullpath = uint32_to_uint8(ackTag.GetPathId());
+                //     PathCodec::Ports show_path;
+                //     show_path.push_back((uint16_t(inPort)));
+                //     PathCodec::Ports fullpath = PathId2Ports(ackTag.GetPathId());
                 //     for (int i = 0; i < ackTag.GetLength(); i++) {
                 //     show_path.push_back(fullpath[i]);
                 //     }  
@@ -679,9 +730,9 @@ namespace ns3 {
                 //     std::cout << "PathCE table: " << std::endl;
                 //     std::cout << "_valid: ";
                 //     // uint32_t outPort = (uint32_t) PathCE_Table[ch.sip]._path[0];
-                //     std::cout  << PathCE_Table[host_ip]._valid << " _ce: " << PathCE_Table[host_ip]._ce << " _path: "<<std::endl;
-                //     for (int i = 0; i < PathCE_Table[host_ip]._path.size(); i++) {
-                //         std::cout << static_cast<int>(PathCE_Table[host_ip]._path[i]) << "->";
+                //     std::cout  << PathCEEntry(host_id)._valid << " _ce: " << PathCEEntry(host_id)._ce << " _path: "<<std::endl;
+                //     for (int i = 0; i < PathCEEntry(host_id)._path.size(); i++) {
+                //         std::cout << static_cast<int>(PathCEEntry(host_id)._path[i]) << "->";
                 //     }
                 //     std::cout << std::endl;
                 // }
@@ -690,8 +741,8 @@ namespace ns3 {
                 // //更新本地的CE表
                 // uint32_t last_swtich = ackTag.GetLastSwitchId();
                 // uint32_t inPort = id2Port[last_swtich];
-                // std::vector<uint8_t> path;
-                // std::vector<uint8_t> fullpath = uint32_to_uint8(ackTag.GetPathId());
+                // PathCodec::Ports path;
+                // PathCodec::Ports fullpath = PathId2Ports(ackTag.GetPathId());
                 // for (int i = 0; i < ackTag.GetLength(); i++) {
                 //     path.push_back(fullpath [i]);
                 // }       
@@ -755,68 +806,68 @@ namespace ns3 {
             }
             // *******************************Add begin**********************//
             // Agg/Core switch
+            if (!found && AckFeedbackSampler::Enabled()) {
+                DoSwitchSendToDev(p, ch);  // ACK sampled out at its source ToR
+                return;
+            }
             assert(found && "If not ToR (leaf), DVTag should be found");
             uint32_t last_swtich = ackTag.GetLastSwitchId();
             uint32_t inPort = id2Port[last_swtich];
             uint32_t remoteCE = ackTag.GetCE();
-            uint32_t ce = m_DreMap[inPort];
+            uint32_t ce = m_dre[inPort];
             uint32_t localCE = QuantizingX(inPort, ce);
             uint32_t totalCE = std::max(localCE, remoteCE);
             uint32_t host_id = ackTag.GetHostId();
             uint32_t host_ip = Settings::hostId2IpMap[host_id];
             if (multi_PathSet){
-                std::vector<uint8_t> path;
-                std::vector<uint8_t> fullpath = uint32_to_uint8(ackTag.GetPathId());
-                for (int i = 0; i < ackTag.GetLength(); i++) {
-                    path.push_back(fullpath[i]);
-                }
-                PathCE_port_Table[host_ip][inPort]._ce = ackTag.GetCE();
-                PathCE_port_Table[host_ip][inPort]._path = path;
-                PathCE_port_Table[host_ip][inPort]._valid = true;
-                PathCE_port_Table[host_ip][inPort]._updateTime = now;
-                CEChoice m_choice = GetKnownBestPath(host_ip);
+                PathCodec::Ports path;
+                PathCodec::Ports fullpath = PathId2Ports(ackTag.GetPathId());
+                path.insert(path.end(), fullpath.begin(), fullpath.end());
+                PathCEPortEntry(host_id, inPort)._ce = ackTag.GetCE();
+                PathCEPortEntry(host_id, inPort)._path = path;
+                PathCEPortEntry(host_id, inPort)._valid = true;
+                PathCEPortEntry(host_id, inPort)._updateTime = now;
+                CEChoice m_choice = GetKnownBestPath(host_id);
                 ackTag.SetPathId(m_choice._path);
                 ackTag.SetCE(m_choice._ce);
             }
             else{
                 uint32_t currentCE = 0;
-                if (PathCE_Table[host_ip]._valid){
-                    uint32_t table_portCE = QuantizingX(PathCE_Table[host_ip]._inPort, m_DreMap[PathCE_Table[host_ip]._inPort]);
-                    currentCE = std::max(table_portCE, PathCE_Table[host_ip]._ce);
+                if (PathCEEntry(host_id)._valid){
+                    uint32_t table_portCE = QuantizingX(PathCEEntry(host_id)._inPort, m_dre[PathCEEntry(host_id)._inPort]);
+                    currentCE = std::max(table_portCE, PathCEEntry(host_id)._ce);
                 }
                 bool update = false;
-                if (PathCE_Table[host_ip]._valid == false){
+                if (PathCEEntry(host_id)._valid == false){
                     update = true;
                 }
                 else {
-                    if(currentCE >= totalCE or PathCE_Table[host_ip]._path[0] == inPort){
+                    if(currentCE >= totalCE or PathCEEntry(host_id)._path[0] == inPort){
                         update = true;
                     }
                 }
                 if (ACK_log){
                     std::cout << "before update PathCE table: " << std::endl;
-                    std::cout << "_valid: " << PathCE_Table[host_ip]._valid << std::endl; 
+                    std::cout << "_valid: " << PathCEEntry(host_id)._valid << std::endl; 
                     // uint32_t outPort = (uint32_t) PathCE_Table[ch.sip]._path[0];
-                    std::cout  << PathCE_Table[host_ip]._valid << " _ce: " << PathCE_Table[host_ip]._ce << " _path: ";
-                    for (int i = 0; i < PathCE_Table[host_ip]._path.size(); i++) {
-                        std::cout << static_cast<int>(PathCE_Table[host_ip]._path[i]) << "->";
+                    std::cout  << PathCEEntry(host_id)._valid << " _ce: " << PathCEEntry(host_id)._ce << " _path: ";
+                    for (int i = 0; i < PathCEEntry(host_id)._path.size(); i++) {
+                        std::cout << static_cast<int>(PathCEEntry(host_id)._path[i]) << "->";
                     }
                     std::cout << std::endl;
                 }
                 if (update){
                     pathUpdateTimes++;
-                    PathCE_Table[host_ip]._valid = true;
-                    PathCE_Table[host_ip]._updateTime= now;
-                    PathCE_Table[host_ip]._ce = remoteCE;
-                    PathCE_Table[host_ip]._inPort = inPort;
+                    PathCEEntry(host_id)._valid = true;
+                    PathCEEntry(host_id)._updateTime= now;
+                    PathCEEntry(host_id)._ce = remoteCE;
+                    PathCEEntry(host_id)._inPort = inPort;
                     currentCE = totalCE;
-                    std::vector<uint8_t> path;
-                    path.push_back((uint8_t(inPort)));
-                    std::vector<uint8_t> fullpath = uint32_to_uint8(ackTag.GetPathId());
-                    for (int i = 0; i < ackTag.GetLength(); i++) {
-                        path.push_back(fullpath [i]);
-                    }  
-                    PathCE_Table[host_ip]._path = path;
+                    PathCodec::Ports path;
+                    path.push_back((uint16_t(inPort)));
+                    PathCodec::Ports fullpath = PathId2Ports(ackTag.GetPathId());
+                    path.insert(path.end(), fullpath.begin(), fullpath.end());
+                    PathCEEntry(host_id)._path = path;
                 }
 
                 if (ACK_log){
@@ -829,27 +880,25 @@ namespace ns3 {
                     printf("receive ack packet info: from switch: %d, host_id %d, host_ip %d, SrcIp: %d, currentCE %d, localCE %d, totalCE %d, inPort %d, packet CE: %d, update: %d\n",last_swtich,  host_id, host_ip, ch.sip, currentCE, localCE, totalCE, inPort, ackTag.GetCE(), intupdate);
                     std::cout << "receive ack path id: " << ackTag.GetPathId() << std::endl;
                     std::cout << "receive ack packet path: ";
-                    std::vector<uint8_t> show_path;
-                    show_path.push_back((uint8_t(inPort)));
-                    std::vector<uint8_t> fullpath = uint32_to_uint8(ackTag.GetPathId());
-                    for (int i = 0; i < ackTag.GetLength(); i++) {
-                    show_path.push_back(fullpath[i]);
-                    }  
+                    PathCodec::Ports show_path;
+                    show_path.push_back((uint16_t(inPort)));
+                    PathCodec::Ports fullpath = PathId2Ports(ackTag.GetPathId());
+                    show_path.insert(show_path.end(), fullpath.begin(), fullpath.end());
                     for (int i = 0; i < show_path.size(); i++) {
                         std::cout << static_cast<int>(show_path[i]) << "->";
                     }
                     std::cout << std::endl;
                     std::cout << "after update PathCE table: " << std::endl;
-                    std::cout << "_valid: " << PathCE_Table[host_ip]._valid << std::endl; 
+                    std::cout << "_valid: " << PathCEEntry(host_id)._valid << std::endl; 
                     // uint32_t outPort = (uint32_t) PathCE_Table[ch.sip]._path[0];
-                    std::cout  << PathCE_Table[host_ip]._valid << " _ce: " << PathCE_Table[host_ip]._ce << " _path: ";
-                    for (int i = 0; i < PathCE_Table[host_ip]._path.size(); i++) {
-                        std::cout << static_cast<int>(PathCE_Table[host_ip]._path[i]) << "->";
+                    std::cout  << PathCEEntry(host_id)._valid << " _ce: " << PathCEEntry(host_id)._ce << " _path: ";
+                    for (int i = 0; i < PathCEEntry(host_id)._path.size(); i++) {
+                        std::cout << static_cast<int>(PathCEEntry(host_id)._path[i]) << "->";
                     }
                     std::cout << std::endl;
                 }
 
-                uint32_t newPathid = Vector2PathId(PathCE_Table[host_ip]._path);
+                uint32_t newPathid = Vector2PathId(PathCEEntry(host_id)._path);
                 ackTag.SetPathId(newPathid);
                 ackTag.SetCE(currentCE);
             }
@@ -858,6 +907,7 @@ namespace ns3 {
             ackTag.SetLastSwitchId(m_switch_id);
             ackTag.SetLength(ackTag.GetLength() + 1);
             p->AddPacketTag(ackTag);
+            AckFeedbackSampler::CountHop(ackTag.GetSerializedSize());
             DoSwitchSendToDev(p, ch);
             return;
 
@@ -868,8 +918,8 @@ namespace ns3 {
             // //更新本地的CE表
             // uint32_t last_swtich = ackTag.GetLastSwitchId();
             // uint32_t inPort = id2Port[last_swtich];
-            // std::vector<uint8_t> path;
-            // std::vector<uint8_t> fullpath = uint32_to_uint8(ackTag.GetPathId());
+            // PathCodec::Ports path;
+            // PathCodec::Ports fullpath = PathId2Ports(ackTag.GetPathId());
             //     for (int i = 0; i < ackTag.GetLength(); i++) {
             //         path.push_back(fullpath [i]);
             //     }       
@@ -930,8 +980,8 @@ namespace ns3 {
 
             // if (ACK_log){
             //     //显示Ack包中携带的信息
-            //     std::vector<uint8_t> show_path;
-            //     std::vector<uint8_t> fullpath = uint32_to_uint8(m_choice._path);
+            //     PathCodec::Ports show_path;
+            //     PathCodec::Ports fullpath = PathId2Ports(m_choice._path);
             //     for (int i = 0; i < ackTag.GetLength() + 1; i++) {
             //         show_path.push_back(fullpath[i]);
             //     }       
@@ -954,23 +1004,19 @@ namespace ns3 {
             // *******************************Delete end**********************//
         }
     }
-    CEChoice DVRouting::GetKnownBestPath(uint32_t dip){
-        auto pathItr = PathCE_port_Table.find(dip);
+    CEChoice DVRouting::GetKnownBestPath(uint32_t hostId){
+        const std::vector<DVInfo>& portRow = PathCE_port_Table[hostId];
         std::vector<CEChoice> candidateRoutes;
         uint32_t minCongestion = DV_NULL;
-        for (auto it = pathItr->second.begin(); it != pathItr->second.end(); ++it) {
-            // printf("GetKnownBestPath: id:%d, port:%d\n", m_switch_id, it->first);
-            uint32_t port = it->first;
-            DVInfo info  = it->second;
-            auto innerDre = m_DreMap.find(port);
-            uint32_t localCongestion = 0;
-            uint32_t remoteCongestion = 0;
-            std::vector<uint8_t> path;
-            if (innerDre != m_DreMap.end()) {
-
-                localCongestion = QuantizingX(port, innerDre->second);
-                // std::cout <<"GetKnownBestPath:, "<< "swtichid" <<  m_switch_id << "local congestion: " << port << " ," <<localCongestion << std::endl;
+        for (uint32_t port = 0; port < portRow.size(); ++port) {
+            // printf("GetKnownBestPath: id:%d, port:%d\n", m_switch_id, port);
+            const DVInfo& info = portRow[port];
+            if (!info._valid) {
+                continue;  // 无效表项不会成为候选
             }
+            uint32_t localCongestion = QuantizingX(port, m_dre[port]);
+            uint32_t remoteCongestion = 0;
+            PathCodec::Ports path;
             if (info._valid) {
                 remoteCongestion = info._ce;
                 path = info._path;
@@ -983,8 +1029,7 @@ namespace ns3 {
                     candidateRoutes.clear();
                     CEChoice choice;
                     choice._ce = CurrCongestion;
-                    uint8_t port_8 = port & 0xFF;
-                    choice._path = mergePortAndVector(port_8, path);
+                    choice._path = mergePortAndVector(port, path);
                     // std::cout << "GetKnownBestPath: " << "port: " << port << "CE path: " << choice._path << std::endl;
                     choice._port = port;
                     candidateRoutes.push_back(choice);
@@ -993,8 +1038,7 @@ namespace ns3 {
                 if (info._valid) {
                     CEChoice choice;
                     choice._ce = CurrCongestion;
-                    uint8_t port_8 = port & 0xFF;
-                    choice._path = mergePortAndVector(port_8, path);
+                    choice._path = mergePortAndVector(port, path);
                     // std::cout << "GetKnownBestPath: " << "port: " << port << "CE path: " << choice._path << std::endl;
                     choice._port = port;
                     candidateRoutes.push_back(choice);
@@ -1006,13 +1050,13 @@ namespace ns3 {
     }
 // *******************************Add begin**********************//
     RouteChoice DVRouting::GetBestPath(uint32_t dip, CustomHeader ch){
-        auto pathItr = PathCE_Table.find(dip);
-        assert(pathItr != PathCE_Table.end() && "Cannot find dip from PathCE_Table");
+        uint32_t hostId = Settings::ip_to_node_id(Ipv4Address(dip));
+        assert(hostId < PathCE_Table.size() && "Cannot find dip from PathCE_Table");
         if (Route_log){
             uint32_t flowid = Settings::PacketId2FlowId[std::make_tuple(Settings::hostIp2IdMap[ch.sip], Settings::hostIp2IdMap[ch.dip], ch.udp.sport, ch.udp.dport)];
             printf("Route info: SrcToR flow id %d, switch %d\n", flowid, m_switch_id);
         }
-        auto pathCE_entry = PathCE_Table[dip];
+        const singleDVInfo& pathCE_entry = PathCE_Table[hostId];
         RouteChoice choice;
         if(pathCE_entry._valid){
             choice.SrcRoute = true;
@@ -1038,20 +1082,22 @@ namespace ns3 {
 
 // *******************************Delete begin**********************//
     RouteChoice DVRouting::GetBestPath_PathCE_port_table(uint32_t dip, CustomHeader ch){
-        auto pathItr = PathCE_port_Table.find(dip);
-        assert(pathItr != PathCE_port_Table.end() && "Cannot find dip from m_DVTable");
+        uint32_t hostId = Settings::ip_to_node_id(Ipv4Address(dip));
+        assert(hostId < PathCE_port_Table.size() && "Cannot find dip from m_DVTable");
 
         if (Route_log){
             uint32_t flowid = Settings::PacketId2FlowId[std::make_tuple(Settings::hostIp2IdMap[ch.sip], Settings::hostIp2IdMap[ch.dip], ch.udp.sport, ch.udp.dport)];
             printf("Route info: flow id %d, switch %d\n", flowid, m_switch_id);
         }
-        auto pathInfoMap = PathCE_port_Table[dip];
+        const std::vector<DVInfo>& portRow = PathCE_port_Table[hostId];
 
         std::vector<RouteChoice> candidateRoutes;
         uint32_t minCongestion = DV_NULL;
-        for (auto it = pathItr->second.begin(); it != pathItr->second.end(); ++it) {
-
-            uint32_t port = it->first;
+        for (uint32_t port = 0; port < portRow.size(); ++port) {
+            // 无效表项的 CE 视为 DV_NULL，不可能成为候选，直接跳过
+            if (!portRow[port]._valid) {
+                continue;
+            }
             // std::cout <<"Path select: " << std::endl;
             // std::cout << "port: " << port;        
             if (Route_log){
@@ -1059,27 +1105,19 @@ namespace ns3 {
             }
             uint32_t localCongestion = 0;
             uint32_t remoteCongestion = 0;
-            std::vector<uint8_t> path;
+            PathCodec::Ports path;
             bool valid = false;
 
-            auto innerDre = m_DreMap.find(port);
-            if (innerDre != m_DreMap.end()) {
-                localCongestion = QuantizingX(port, innerDre->second);
-                if (Route_log){
-                    std::cout << "Dre_map find: localCe: " << localCongestion << " ,";
-                }
-            }
-            else{
-                if (Route_log){
-                    std::cout << "Dre_map not find ,";
-                }
+            localCongestion = QuantizingX(port, m_dre[port]);
+            if (Route_log){
+                std::cout << "Dre_map find: localCe: " << localCongestion << " ,";
             }
 
-            auto Pathinfo = pathInfoMap.find(port);
-            if (Pathinfo != pathInfoMap.end()) {
-                if (Pathinfo->second._valid) {
-                    remoteCongestion = Pathinfo->second._ce;
-                    path = Pathinfo->second._path;
+            {
+                const DVInfo& Pathinfo = portRow[port];
+                if (Pathinfo._valid) {
+                    remoteCongestion = Pathinfo._ce;
+                    path = Pathinfo._path;
                     valid = true;
                     if (Route_log){
                         std::cout << "remote congestion valid: " << remoteCongestion << ", path: ";
@@ -1105,8 +1143,7 @@ namespace ns3 {
                     RouteChoice choice;
                     choice.SrcRoute = true;
                     choice.outPort = port;
-                    uint8_t port_8 = port & 0xFF;
-                    uint32_t pathid = mergePortAndVector(port_8, path);
+                    uint32_t pathid = mergePortAndVector(port, path);
                     choice.pathid = pathid;
                     candidateRoutes.push_back(choice);
                 }
@@ -1116,8 +1153,7 @@ namespace ns3 {
                     //path id is the best path
                     choice.SrcRoute = true;
                     choice.outPort = port;
-                    uint8_t port_8 = port & 0xFF;
-                    uint32_t pathid = mergePortAndVector(port_8, path);
+                    uint32_t pathid = mergePortAndVector(port, path);
                     choice.pathid = pathid;
                     candidateRoutes.push_back(choice);
                 }
@@ -1135,9 +1171,9 @@ namespace ns3 {
         }
         // 在这里可以检查一下每个路径的拥塞情况，以及最后获得的candidateRoutes
         if (Route_log){
-            std::vector<uint8_t> showpath = uint32_to_uint8(finalChoice.pathid);
+            PathCodec::Ports showpath = PathId2Ports(finalChoice.pathid);
             std::cout << "Final choice: port: " << finalChoice.outPort << ", pathid: " << finalChoice.pathid << ", path: ";
-            for (int i = 0; i < 4; i++) {
+            for (int i = 0; i < showpath.size(); i++) {
                 std::cout << static_cast<int>(showpath[i]) << "->";
             }
             std::cout << "bool SrcRoute: " << finalChoice.SrcRoute << std::endl;
@@ -1146,43 +1182,10 @@ namespace ns3 {
     }
     // *******************************Delete end**********************//
     // *******************************Add begin**********************//
-    uint32_t DVRouting::Vector2PathId(std::vector<uint8_t> vec) {
-        uint32_t result = 0; // 先将 port 存入结果中
-        result |= vec[0];
-
-        // 将 vector 中的元素逐个存入结果中
-        for (size_t i = 1; i < vec.size(); ++i) {
-            result <<= 8; // 左移 8 位，腾出一个字节的空间
-            result |= vec[i]; // 将 vector 中的元素放入结果中
-        }
-
-        // 如果 vector 的大小不足 4 个字节，补充 0
-        size_t remainingBytes = 4 - vec.size();
-        while (remainingBytes > 0) {
-            result <<= 8; // 左移 8 位
-            --remainingBytes;
-        }
-
-        return result;
-    }
+    uint32_t DVRouting::Vector2PathId(const PathCodec::Ports& vec) { return PathCodec::Intern(vec); }
     // *******************************Add end**********************//
-    uint32_t DVRouting::mergePortAndVector(uint8_t port, std::vector<uint8_t> vec) {
-        uint32_t result = port; // 先将 port 存入结果中
-
-        // 将 vector 中的元素逐个存入结果中
-        for (size_t i = 0; i < vec.size(); ++i) {
-            result <<= 8; // 左移 8 位，腾出一个字节的空间
-            result |= vec[i]; // 将 vector 中的元素放入结果中
-        }
-
-        // 如果 vector 的大小不足 4 个字节，补充 0
-        size_t remainingBytes = 3 - vec.size();
-        while (remainingBytes > 0) {
-            result <<= 8; // 左移 8 位
-            --remainingBytes;
-        }
-
-        return result;
+    uint32_t DVRouting::mergePortAndVector(uint32_t port, const PathCodec::Ports& vec) {
+        return PathCodec::Prepend(port, vec);
     }
     void DVRouting::SetConstants(Time dreTime, Time agingTime, Time flowletTimeout,
                                     uint32_t quantizeBit, double alpha) {
@@ -1194,29 +1197,24 @@ namespace ns3 {
     }
 
     void DVRouting::DoDispose() {
-        for (auto i : m_flowletTable) {
-            delete (i.second);
-        }
+        m_flowletTable.Clear();
         m_dreEvent.Cancel();
         m_agingEvent.Cancel();
     }
 
     void DVRouting::DreEvent() {
-        std::map<uint32_t, uint32_t>::iterator itr = m_DreMap.begin();
         auto now = Simulator::Now();
         if (Dre_decrease_log){
             std::cout << "Dre decrease info: switch: " << m_switch_id << ", time: " << now << std::endl;
-        }
-        for (; itr != m_DreMap.end(); ++itr) {
-            if (Dre_decrease_log){
-                std::cout << "Dre decrease: port: " << itr->first << ", old X: " << itr->second << ", old localCe:"<< QuantizingX(itr->first, itr->second) <<std::endl;
-            }
-            uint32_t newX = itr->second * (1 - m_alpha);
-            itr->second = newX;
-            if (Dre_decrease_log){
-                std::cout << "Dre decrease: port: " << itr->first << ", new X: " << itr->second << ", new localCe:"<< QuantizingX(itr->first, itr->second) <<std::endl;
+            for (uint32_t port = 0; port < m_dre.size(); ++port) {
+                if (m_outPortBitRate[port] == 0) continue;
+                std::cout << "Dre decrease: port: " << port << ", old X: " << m_dre[port] << ", old localCe:"<< QuantizingX(port, m_dre[port]) <<std::endl;
+                std::cout << "Dre decrease: port: " << port << ", new X: " << (uint32_t)(m_dre[port] * (1 - m_alpha)) << ", new localCe:"<< QuantizingX(port, m_dre[port] * (1 - m_alpha)) <<std::endl;
             }
         }
+        for (uint32_t port = 0; port < m_dre.size(); ++port) {
+            m_dre[port] = m_dre[port] * (1 - m_alpha);
+        }
         NS_LOG_FUNCTION(Simulator::Now());
         m_dreEvent = Simulator::Schedule(m_dreTime, &DVRouting::DreEvent, this);
     }
@@ -1239,21 +1237,17 @@ namespace ns3 {
         // *******************************Delete end**********************//
         // *******************************Add begin**********************//
         auto now = Simulator::Now();
-        auto itr = PathCE_Table.begin();
-        for (; itr != PathCE_Table.end(); ++itr){
-            singleDVInfo info = itr->second;
+        for (auto& info : PathCE_Table){
             if(now - info._updateTime > m_agingTime){
-                (itr->second)._ce = 0;
-                (itr->second)._valid = false;
+                info._ce = 0;
+                info._valid = false;
             }
         }
-        auto p_itr = PathCE_port_Table.begin();  // always non-empty
-        for (; p_itr != PathCE_port_Table.end(); ++p_itr) {
-            auto innerpItr = (p_itr->second).begin();
-            for (; innerpItr != (p_itr->second).end(); ++innerpItr) {
-                if (now - (innerpItr->second)._updateTime > m_agingTime) {
-                    (innerpItr->second)._ce = 0;
-                    (innerpItr->second)._valid = false;
+        for (auto& portRow : PathCE_port_Table) {
+            for (auto& info : portRow) {
+                if (now - info._updateTime > m_agingTime) {
+                    info._ce = 0;
+                    info._valid = false;
                 }
             }
         }
@@ -9,12 +9,16 @@
 #include <unordered_map>
 #include <vector>
 
+#include "ns3/ack-feedback-sampler.h"
 #include "ns3/address.h"
 #include "ns3/callback.h"
 #include "ns3/event-id.h"
+#include "ns3/lb-flat-table.h"
+#include "ns3/load-balancer.h"
 #include "ns3/net-device.h"
 #include "ns3/object.h"
 #include "ns3/packet.h"
+#include "ns3/path-codec.h"
 #include "ns3/ptr.h"
 #include "ns3/settings.h"
 #include "ns3/simulator.h"
@@ -26,13 +30,13 @@ const uint32_t DV_NULL = UINT32_MAX;
 
 struct DVInfo {
     uint32_t _ce;
-    std::vector<uint8_t> _path;
+    PathCodec::Ports _path;
     Time _updateTime;
     bool _valid;
 };
 struct singleDVInfo{
     uint32_t _ce;
-    std::vector<uint8_t> _path;
+    PathCodec::Ports _path;
     Time _updateTime;
     bool _valid;
     uint32_t _inPort;
@@ -89,7 +93,7 @@ class DVAckTag : public Tag{
         uint32_t m_host_id;
 };
 
-class DVRouting : public Object {
+class DVRouting : public LoadBalancer {
 
     friend class SwitchMmu;
     friend class SwitchNode;
@@ -106,17 +110,22 @@ class DVRouting : public Object {
 
     /* main function */
     void RouteInput(Ptr<Packet> p, CustomHeader ch);
+    virtual bool Ingress(Ptr<Packet> p, CustomHeader& ch);  // takes every packet: RouteInput
+    virtual void OnRouted(Ptr<Packet> p, CustomHeader& ch, uint32_t outDev);  // local DRE of table-routed data
     uint32_t UpdateLocalDre(Ptr<Packet> p, CustomHeader ch, uint32_t outPort);
+    uint32_t AddLocalDre(uint32_t outPort, uint32_t bytes);
+    virtual void OnFluidTx(uint32_t outDev, uint64_t bytes);  // fluid bytes into the local DRE
+    virtual void ReportMemory(MemoryAccounting::Report& report);  // path tables, flowlet table
     uint32_t QuantizingX(uint32_t outPort, uint32_t X);  // X is bytes here and we quantizing it to 0 - 2^Q
     virtual void DoDispose();
     RouteChoice GetBestPath(uint32_t dip, CustomHeader ch); 
-    CEChoice GetKnownBestPath(uint32_t dip);
-    uint32_t mergePortAndVector(uint8_t port, const std::vector<uint8_t> vec);
+    CEChoice GetKnownBestPath(uint32_t hostId);
+    uint32_t mergePortAndVector(uint32_t port, const PathCodec::Ports& vec);
     // *******************************Add begin**********************//
     RouteChoice GetBestPath_PathCE_port_table(uint32_t dip, CustomHeader ch);
-    uint32_t Vector2PathId(std::vector<uint8_t> vec);
+    uint32_t Vector2PathId(const PathCodec::Ports& vec);
     // *******************************Add end**********************//
-    std::vector<uint8_t> uint32_to_uint8(uint32_t number);
+    PathCodec::Ports PathId2Ports(uint32_t pathId);
 
     std::map<uint32_t, uint32_t> id2Port;//维护一个交换机的邻居id到端口的id的映射
 
@@ -124,11 +133,6 @@ class DVRouting : public Object {
     void DoSwitchSend(Ptr<Packet> p, CustomHeader& ch, uint32_t outDev,
                       uint32_t qIndex);  // TxToR and Agg/CoreSw
     void DoSwitchSendToDev(Ptr<Packet> p, CustomHeader& ch);  // only at RxToR
-    typedef Callback<void, Ptr<Packet>, CustomHeader&, uint32_t, uint32_t> SwitchSendCallback;
-    typedef Callback<void, Ptr<Packet>, CustomHeader&> SwitchSendToDevCallback;
-    void SetSwitchSendCallback(SwitchSendCallback switchSendCallback);  // set callback
-    void SetSwitchSendToDevCallback(
-        SwitchSendToDevCallback switchSendToDevCallback);  // set callback
     /*-----------*/
 
     /* SET functions */
@@ -142,11 +146,15 @@ class DVRouting : public Object {
     void DreEvent();
     void AgingEvent();
     // topological info (should be initialized in the beginning)
-    std::map<uint32_t, uint64_t> m_outPort2BitRateMap;       
+    std::vector<uint64_t> m_outPortBitRate;  // outPort -> link bitrate (bps), 0 if not a link
     std::map<uint32_t, std::map<uint32_t, DVInfo> > m_DVTable;  // (node ip, port)-> DVInfo
     // *******************************Add begin**********************//
-    std::map<uint32_t, singleDVInfo> PathCE_Table;
-    std::map<uint32_t, std::map<uint32_t, DVInfo>> PathCE_port_Table;
+    // 按主机 nodeId 稠密索引（Settings::ip_to_node_id），端口维度同样稠密，_valid 标记有效表项
+    std::vector<singleDVInfo> PathCE_Table;                 // hostId -> singleDVInfo
+    std::vector<std::vector<DVInfo> > PathCE_port_Table;    // hostId -> port -> DVInfo
+    singleDVInfo& PathCEEntry(uint32_t hostId);                // grows the table on demand
+    DVInfo& PathCEPortEntry(uint32_t hostId, uint32_t port);  // grows the table on demand
+    void PrintDreTable();
     // *******************************Add end**********************//
 
     //log
@@ -167,8 +175,6 @@ class DVRouting : public Object {
     bool m_isToR;          // is ToR (leaf)
     uint32_t m_switch_id;  // switch's nodeID  
     private:
-        SwitchSendCallback m_switchSendCallback;  // bound to SwitchNode::SwitchSend (for Request/UDP)
-        SwitchSendToDevCallback m_switchSendToDevCallback;  // bound to SwitchNode::SendToDevContinue (for Probe, Reply)
     
 
         // dv constants  
@@ -180,9 +186,10 @@ class DVRouting : public Object {
         double m_alpha;          // dre algorithm (e.g., 0.2)
 
         // local
-        std::map<uint32_t, uint32_t> m_DreMap;        // outPort -> DRE (at SrcToR)
-        std::map<uint64_t, DV_Flowlet*> m_flowletTable;  // QpKey -> Flowlet (at SrcToR)
+        std::vector<uint32_t> m_dre;                     // outPort -> DRE (at SrcToR)
+        FlowletHashTable<DV_Flowlet> m_flowletTable;     // QpKey -> Flowlet (at SrcToR)
 
+        AckFeedbackSampler m_ackSampler;  // ACK feedback sampling (at SrcToR)
         uint32_t host_round_index;
         uint32_t ToR_host_num;
 
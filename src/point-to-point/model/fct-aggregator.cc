@@ -0,0 +1,339 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CAVER-LB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "ns3/fct-aggregator.h"
+
+#include <assert.h>
+#include <stddef.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace ns3 {
+
+/*---------------------------- QuantileSketch ----------------------------*/
+
+static const int32_t SKETCH_ZERO_IDX = INT32_MIN;
+
+/* binary images are in host byte order: all ranks run the same binary */
+template <typename T>
+static void Put(std::vector<uint8_t>& buf, T v) {
+    const uint8_t* b = (const uint8_t*)&v;
+    buf.insert(buf.end(), b, b + sizeof(T));
+}
+
+template <typename T>
+static bool Get(const uint8_t*& p, const uint8_t* end, T& v) {
+    if (end - p < (ptrdiff_t)sizeof(T)) {
+        return false;
+    }
+    memcpy(&v, p, sizeof(T));
+    p += sizeof(T);
+    return true;
+}
+
+QuantileSketch::QuantileSketch(double relErr)
+    : m_relErr(relErr), m_count(0), m_zeroCount(0), m_offset(0) {
+    assert(relErr > 0 && relErr < 1 && "relative error must be in (0, 1)");
+    m_gamma = (1 + relErr) / (1 - relErr);
+    m_logGamma = std::log(m_gamma);
+}
+
+int32_t QuantileSketch::Index(double v) const {
+    return (int32_t)std::ceil(std::log(v) / m_logGamma);
+}
+
+double QuantileSketch::Value(int32_t idx) const {
+    // midpoint (in relative terms) of (gamma^(idx-1), gamma^idx]
+    return 2 * std::pow(m_gamma, idx) / (m_gamma + 1);
+}
+
+void QuantileSketch::Add(double v, uint64_t cnt) {
+    if (v <= 0) {
+        m_count += cnt;
+        m_zeroCount += cnt;
+        return;
+    }
+    AddIndex(Index(v), cnt);
+}
+
+void QuantileSketch::AddIndex(int32_t idx, uint64_t cnt) {
+    m_count += cnt;
+    if (m_bins.empty()) {
+        m_offset = idx;
+        m_bins.push_back(0);
+    } else if (idx < m_offset) {
+        m_bins.insert(m_bins.begin(), m_offset - idx, 0);
+        m_offset = idx;
+    } else if (idx >= m_offset + (int32_t)m_bins.size()) {
+        m_bins.resize(idx - m_offset + 1, 0);
+    }
+    m_bins[idx - m_offset] += cnt;
+}
+
+void QuantileSketch::Merge(const QuantileSketch& other) {
+    assert(other.m_relErr == m_relErr && "cannot merge sketches of different accuracy");
+    m_zeroCount += other.m_zeroCount;
+    m_count += other.m_zeroCount;
+    for (uint32_t i = 0; i < other.m_bins.size(); i++) {
+        if (other.m_bins[i]) {
+            AddIndex(other.m_offset + i, other.m_bins[i]);
+        }
+    }
+}
+
+double QuantileSketch::Quantile(double q) const {
+    if (m_count == 0) {
+        return 0;
+    }
+    // same rank convention as analysis/plot_fct.py get_pctl(): a[int(n * q)]
+    uint64_t rank = std::min((uint64_t)(m_count * q), m_count - 1);
+    if (rank < m_zeroCount) {
+        return 0;
+    }
+    uint64_t seen = m_zeroCount;
+    for (uint32_t i = 0; i < m_bins.size(); i++) {
+        seen += m_bins[i];
+        if (seen > rank) {
+            return Value(m_offset + i);
+        }
+    }
+    return Value(m_offset + m_bins.size() - 1);
+}
+
+void QuantileSketch::Write(FILE* fout) const {
+    uint32_t nonEmpty = (m_zeroCount > 0);
+    for (auto c : m_bins) {
+        nonEmpty += (c > 0);
+    }
+    fprintf(fout, " %u", nonEmpty);
+    if (m_zeroCount > 0) {
+        fprintf(fout, " %d %lu", SKETCH_ZERO_IDX, m_zeroCount);
+    }
+    for (uint32_t i = 0; i < m_bins.size(); i++) {
+        if (m_bins[i]) {
+            fprintf(fout, " %d %lu", m_offset + (int32_t)i, m_bins[i]);
+        }
+    }
+}
+
+void QuantileSketch::Save(std::vector<uint8_t>& buf) const {
+    Put(buf, m_relErr);
+    Put(buf, m_count);
+    Put(buf, m_zeroCount);
+    Put(buf, m_offset);
+    Put(buf, (uint32_t)m_bins.size());
+    for (auto c : m_bins) {
+        Put(buf, c);
+    }
+}
+
+bool QuantileSketch::Load(const uint8_t*& p, const uint8_t* end) {
+    double relErr;
+    uint32_t nBins;
+    if (!Get(p, end, relErr) || relErr != m_relErr || !Get(p, end, m_count) ||
+        !Get(p, end, m_zeroCount) || !Get(p, end, m_offset) || !Get(p, end, nBins) ||
+        (uint64_t)(end - p) < (uint64_t)nBins * sizeof(uint64_t)) {
+        return false;
+    }
+    m_bins.resize(nBins);
+    for (uint32_t i = 0; i < nBins; i++) {
+        Get(p, end, m_bins[i]);
+    }
+    return true;
+}
+
+/*---------------------------- FctAggregator ----------------------------*/
+
+FctAggregator::FctAggregator()
+    : m_lbMode(0), m_ccMode(0), m_relErr(0.01), m_startNs(0), m_windowNs(0), m_nFlows(0) {
+    m_sizeBins = DefaultSizeBins();
+}
+
+std::vector<uint64_t> FctAggregator::DefaultSizeBins() {
+    // 1-2-5 steps from 1KB to 20MB
+    std::vector<uint64_t> edges(1, 0);
+    for (uint64_t decade = 1000; decade <= 10000000; decade *= 10) {
+        edges.push_back(decade);
+        edges.push_back(decade * 2);
+        edges.push_back(decade * 5);
+    }
+    return edges;
+}
+
+void FctAggregator::SetWindow(uint64_t startNs, uint64_t windowNs) {
+    m_startNs = startNs;
+    m_windowNs = windowNs;
+}
+
+void FctAggregator::SetSizeBins(const std::vector<uint64_t>& edges) {
+    assert(!edges.empty() && edges[0] == 0 && std::is_sorted(edges.begin(), edges.end()));
+    m_sizeBins = edges;
+}
+
+uint32_t FctAggregator::GetSizeBin(uint64_t size) const {
+    return std::upper_bound(m_sizeBins.begin(), m_sizeBins.end(), size) - m_sizeBins.begin() - 1;
+}
+
+void FctAggregator::Record(uint64_t size, uint64_t startNs, uint64_t fctNs,
+                           uint64_t standaloneFctNs) {
+    uint32_t window = 0;
+    if (m_windowNs > 0 && startNs > m_startNs) {
+        window = (startNs - m_startNs) / m_windowNs;
+    }
+    CellKey key = std::make_tuple(m_lbMode, window, GetSizeBin(size));
+    auto it = m_cells.find(key);
+    if (it == m_cells.end()) {
+        it = m_cells.insert(std::make_pair(key, Cell(m_relErr))).first;
+    }
+    Cell& cell = it->second;
+
+    double slowdown = (double)fctNs / standaloneFctNs;
+    if (slowdown < 1) {
+        slowdown = 1;  // same clamp as plot_fct.py
+    }
+    cell.count++;
+    cell.sumSlowdown += slowdown;
+    cell.sumFct += fctNs;
+    cell.maxSize = std::max(cell.maxSize, size);
+    cell.slowdown.Add(slowdown);
+    cell.fct.Add(fctNs);
+    m_nFlows++;
+}
+
+void FctAggregator::Merge(const FctAggregator& other) {
+    assert(other.m_sizeBins == m_sizeBins && other.m_relErr == m_relErr &&
+           other.m_windowNs == m_windowNs && other.m_startNs == m_startNs);
+    for (auto& kv : other.m_cells) {
+        auto it = m_cells.find(kv.first);
+        if (it == m_cells.end()) {
+            m_cells.insert(kv);
+            continue;
+        }
+        Cell& cell = it->second;
+        cell.count += kv.second.count;
+        cell.sumSlowdown += kv.second.sumSlowdown;
+        cell.sumFct += kv.second.sumFct;
+        cell.maxSize = std::max(cell.maxSize, kv.second.maxSize);
+        cell.slowdown.Merge(kv.second.slowdown);
+        cell.fct.Merge(kv.second.fct);
+    }
+    m_nFlows += other.m_nFlows;
+}
+
+void FctAggregator::Save(std::vector<uint8_t>& buf) const {
+    Put(buf, m_lbMode);
+    Put(buf, m_ccMode);
+    Put(buf, m_relErr);
+    Put(buf, m_startNs);
+    Put(buf, m_windowNs);
+    Put(buf, m_nFlows);
+    Put(buf, (uint32_t)m_sizeBins.size());
+    for (auto e : m_sizeBins) {
+        Put(buf, e);
+    }
+    Put(buf, (uint32_t)m_cells.size());
+    for (auto& kv : m_cells) {
+        const Cell& cell = kv.second;
+        Put(buf, std::get<0>(kv.first));
+        Put(buf, std::get<1>(kv.first));
+        Put(buf, std::get<2>(kv.first));
+        Put(buf, cell.count);
+        Put(buf, cell.sumSlowdown);
+        Put(buf, cell.sumFct);
+        Put(buf, cell.maxSize);
+        cell.slowdown.Save(buf);
+        cell.fct.Save(buf);
+    }
+}
+
+bool FctAggregator::MergeSaved(const uint8_t* data, size_t size) {
+    const uint8_t* p = data;
+    const uint8_t* end = data + size;
+    FctAggregator other;
+    uint32_t nBins, nCells;
+    if (!Get(p, end, other.m_lbMode) || !Get(p, end, other.m_ccMode) ||
+        !Get(p, end, other.m_relErr) || !Get(p, end, other.m_startNs) ||
+        !Get(p, end, other.m_windowNs) || !Get(p, end, other.m_nFlows) || !Get(p, end, nBins) ||
+        (uint64_t)(end - p) < (uint64_t)nBins * sizeof(uint64_t)) {
+        return false;
+    }
+    other.m_sizeBins.resize(nBins);
+    for (uint32_t i = 0; i < nBins; i++) {
+        Get(p, end, other.m_sizeBins[i]);
+    }
+    if (other.m_sizeBins != m_sizeBins || other.m_relErr != m_relErr ||
+        other.m_windowNs != m_windowNs || other.m_startNs != m_startNs || !Get(p, end, nCells)) {
+        return false;
+    }
+    for (uint32_t i = 0; i < nCells; i++) {
+        uint32_t lb, window, bin;
+        Cell cell(m_relErr);
+        if (!Get(p, end, lb) || !Get(p, end, window) || !Get(p, end, bin) ||
+            !Get(p, end, cell.count) || !Get(p, end, cell.sumSlowdown) ||
+            !Get(p, end, cell.sumFct) || !Get(p, end, cell.maxSize) ||
+            !cell.slowdown.Load(p, end) || !cell.fct.Load(p, end)) {
+            return false;
+        }
+        other.m_cells.insert(std::make_pair(std::make_tuple(lb, window, bin), cell));
+    }
+    if (p != end) {
+        return false;
+    }
+    Merge(other);
+    return true;
+}
+
+bool FctAggregator::WriteSummary(const char* filename) const {
+    FILE* fout = fopen(filename, "w");
+    if (fout == NULL) {
+        return false;
+    }
+    fprintf(fout, "# fct summary v1 (analysis/fct_summary.py)\n");
+    fprintf(fout, "CC_MODE %u\n", m_ccMode);
+    fprintf(fout, "REL_ERR %g\n", m_relErr);
+    fprintf(fout, "WINDOW %lu %lu\n", m_startNs, m_windowNs);
+    fprintf(fout, "SIZE_BINS %lu", (uint64_t)m_sizeBins.size());
+    for (auto e : m_sizeBins) {
+        fprintf(fout, " %lu", e);
+    }
+    fprintf(fout, "\n");
+    // CELL <lb> <window> <bin> <count> <sumSlowdown> <sumFct> <maxSize> SD <sketch> FCT <sketch>
+    for (auto& kv : m_cells) {
+        const Cell& cell = kv.second;
+        fprintf(fout, "CELL %u %u %u %lu %.6f %.1f %lu SD", std::get<0>(kv.first),
+                std::get<1>(kv.first), std::get<2>(kv.first), cell.count, cell.sumSlowdown,
+                cell.sumFct, cell.maxSize);
+        cell.slowdown.Write(fout);
+        fprintf(fout, " FCT");
+        cell.fct.Write(fout);
+        fprintf(fout, "\n");
+    }
+    fclose(fout);
+    return true;
+}
+
+}  // namespace ns3
@@ -0,0 +1,126 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CAVER-LB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <map>
+#include <tuple>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * @brief Mergeable quantile sketch with bounded relative error.
+ * 对数分桶（DDSketch 的做法）：值 v 落在桶 ceil(log_gamma(v))，gamma = (1+a)/(1-a)，
+ * 任意分位数的相对误差不超过 a。两个参数相同的 sketch 逐桶相加即可合并，结果与
+ * 把两组样本放进同一个 sketch 完全一致，因此并行仿真的结果可以直接合并。
+ */
+class QuantileSketch {
+   public:
+    explicit QuantileSketch(double relErr = 0.01);
+
+    void Add(double v, uint64_t cnt = 1);
+    void Merge(const QuantileSketch& other);  // requires the same relErr
+    double Quantile(double q) const;          // q in [0, 1]
+    uint64_t Count() const { return m_count; }
+    double GetRelErr() const { return m_relErr; }
+
+    /* " <nNonEmpty> <idx> <cnt> ...", idx INT32_MIN is the zero bucket */
+    void Write(FILE* fout) const;
+    /* binary image, to move a sketch to another MPI rank; Load() fails on a malformed image */
+    void Save(std::vector<uint8_t>& buf) const;
+    bool Load(const uint8_t*& p, const uint8_t* end);
+
+   private:
+    int32_t Index(double v) const;
+    void AddIndex(int32_t idx, uint64_t cnt);
+    double Value(int32_t idx) const;
+
+    double m_relErr;
+    double m_gamma;
+    double m_logGamma;
+    uint64_t m_count;
+    uint64_t m_zeroCount;          // v <= 0
+    int32_t m_offset;              // bucket index of m_bins[0]
+    std::vector<uint64_t> m_bins;  // dense buckets [m_offset, m_offset + size)
+};
+
+/**
+ * @brief Online FCT / slowdown aggregation, replaces post-processing of fct.txt.
+ * 每条完成的流按 (LB mode, 时间窗口, 流大小区间) 归入一个 cell，cell 内保存计数、
+ * 累加值以及 slowdown / 绝对 FCT 两个 QuantileSketch。仿真结束时写出一个很小的
+ * 文本摘要（analysis/fct_summary.py 读取与合并）。
+ */
+class FctAggregator {
+   public:
+    FctAggregator();
+
+    /* SET functions (before the first Record) */
+    void SetLbMode(uint32_t lbMode) { m_lbMode = lbMode; }
+    void SetCcMode(uint32_t ccMode) { m_ccMode = ccMode; }
+    void SetRelErr(double relErr) { m_relErr = relErr; }
+    void SetWindow(uint64_t startNs, uint64_t windowNs);  // windowNs = 0: one window
+    void SetSizeBins(const std::vector<uint64_t>& edges);  // ascending lower edges, edges[0] = 0
+    static std::vector<uint64_t> DefaultSizeBins();
+
+    /* one finished flow; the window is chosen by the flow's start time */
+    void Record(uint64_t size, uint64_t startNs, uint64_t fctNs, uint64_t standaloneFctNs);
+    void Merge(const FctAggregator& other);
+    bool WriteSummary(const char* filename) const;
+    /* binary image of the cells, to merge the aggregators of all MPI ranks into one summary;
+     * MergeSaved() fails on a malformed image or one of a different configuration */
+    void Save(std::vector<uint8_t>& buf) const;
+    bool MergeSaved(const uint8_t* data, size_t size);
+    uint64_t GetNumFlows() const { return m_nFlows; }
+
+   private:
+    struct Cell {
+        uint64_t count;
+        double sumSlowdown;
+        double sumFct;
+        uint64_t maxSize;
+        QuantileSketch slowdown;
+        QuantileSketch fct;
+        explicit Cell(double relErr)
+            : count(0), sumSlowdown(0), sumFct(0), maxSize(0), slowdown(relErr), fct(relErr) {}
+    };
+    typedef std::tuple<uint32_t, uint32_t, uint32_t> CellKey;  // (lbMode, window, sizeBin)
+
+    uint32_t GetSizeBin(uint64_t size) const;
+
+    uint32_t m_lbMode;
+    uint32_t m_ccMode;
+    double m_relErr;
+    uint64_t m_startNs;
+    uint64_t m_windowNs;
+    uint64_t m_nFlows;
+    std::vector<uint64_t> m_sizeBins;
+    std::map<CellKey, Cell> m_cells;
+};
+
+}  // namespace ns3
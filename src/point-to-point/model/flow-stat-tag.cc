@@ -6,6 +6,8 @@
 #include "flow-stat-tag.h"
 
 namespace ns3 {
+NS_OBJECT_ENSURE_REGISTERED(FlowStatTag);
+
 FlowStatTag::FlowStatTag() : flow_stat(FLOW_NOTEND) {}
 
 TypeId FlowStatTag::GetTypeId(void) {
@@ -0,0 +1,344 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CAVER-LB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "ns3/fluid-model.h"
+
+#include <assert.h>
+#include <math.h>
+
+#include <queue>
+
+#include "ns3/broadcom-egress-queue.h"
+#include "ns3/qbb-channel.h"
+#include "ns3/qbb-net-device.h"
+#include "ns3/simulator.h"
+#include "ns3/switch-node.h"
+
+namespace ns3 {
+
+FluidModel::FluidModel()
+    : m_tick(NanoSeconds(1000)),
+      m_capacityFactor(0.95),
+      m_pathPolicy(PATH_ECMP),
+      m_standalone(false),
+      m_incremental(true),
+      m_nFluidFlows(0),
+      m_nFinished(0),
+      m_nRateUpdates(0),
+      m_epoch(0) {
+    m_completion.SetExpireCallback(MakeCallback(&FluidModel::Complete, this));
+}
+
+uint32_t FluidModel::GetLink(Ptr<Node> node, Ptr<QbbNetDevice> dev) {
+    uint64_t key = ((uint64_t)node->GetId() << 32) | dev->GetIfIndex();
+    auto it = m_linkIndex.find(key);
+    if (it != m_linkIndex.end()) return it->second;
+    Link link;
+    link.dev = dev;
+    link.sw = node->GetNodeType() > 0 ? PeekPointer(DynamicCast<SwitchNode>(node)) : NULL;
+    link.port = dev->GetIfIndex();
+    link.capacity = dev->GetDataRate().GetBitRate() * m_capacityFactor;
+    link.fluidRate = 0;
+    link.fluidBytes = 0;
+    link.lastNs = Simulator::Now().GetTimeStep();
+    link.mark = 0;
+    link.residual = 0;
+    link.unfixed = 0;
+    m_links.push_back(link);
+    m_linkIndex[key] = m_links.size() - 1;
+    return m_links.size() - 1;
+}
+
+int FluidModel::ChoosePort(Ptr<SwitchNode> sw, uint32_t sip, uint32_t dip, uint16_t sport,
+                           uint16_t dport) {
+    int port = sw->GetFlowEcmpPort(sip, dip, sport, dport);
+    if (m_pathPolicy != PATH_LEAST_FLOWS || port < 0) return port;
+    // the candidate with the fewest flows, the ECMP choice on ties
+    uint32_t best = GetLink(sw, DynamicCast<QbbNetDevice>(sw->GetDevice(port)));
+    for (int p : sw->m_rtTable[dip]) {
+        uint32_t l = GetLink(sw, DynamicCast<QbbNetDevice>(sw->GetDevice(p)));
+        if (m_links[l].flows.size() < m_links[best].flows.size()) {
+            best = l;
+            port = p;
+        }
+    }
+    return port;
+}
+
+bool FluidModel::Route(Flow& f, Ptr<Node> src, Ptr<Node> dst, uint32_t sip, uint32_t dip) {
+    Ptr<QbbNetDevice> dev;
+    for (uint32_t i = 0; i < src->GetNDevices() && dev == 0; i++) {
+        dev = DynamicCast<QbbNetDevice>(src->GetDevice(i));
+    }
+    if (dev == 0) return false;
+    Ptr<Node> node = src;
+    uint32_t inPort = 0;
+    for (uint32_t hop = 0; hop < 64; hop++) {
+        f.links.push_back(GetLink(node, dev));
+        f.inPorts.push_back(inPort);
+        Ptr<QbbChannel> ch = DynamicCast<QbbChannel>(dev->GetChannel());
+        Ptr<QbbNetDevice> peer = ch->GetQbbDevice(0) == dev ? ch->GetQbbDevice(1) : ch->GetQbbDevice(0);
+        node = peer->GetNode();
+        if (node == dst) return true;
+        if (node->GetNodeType() == 0) return false;
+        inPort = peer->GetIfIndex();
+        int port = ChoosePort(DynamicCast<SwitchNode>(node), sip, dip, f.sport, f.dport);
+        if (port < 0) return false;
+        dev = DynamicCast<QbbNetDevice>(node->GetDevice(port));
+    }
+    return false;
+}
+
+void FluidModel::AddFlow(uint32_t flowId, Ptr<Node> src, Ptr<Node> dst, uint32_t sip, uint32_t dip,
+                         uint16_t sport, uint16_t dport, uint32_t pg, uint64_t bytes) {
+    assert(m_flows.find(flowId) == m_flows.end() && "FluidModel: flow id already active");
+    Flow& f = m_flows[flowId];
+    f.id = flowId;
+    f.src = src->GetId();
+    f.dst = dst->GetId();
+    f.sport = sport;
+    f.dport = dport;
+    f.pg = pg;
+    f.bytes = bytes;
+    f.remaining = bytes;
+    f.rate = 0;
+    f.newRate = 0;
+    f.startNs = Simulator::Now().GetTimeStep();
+    f.lastNs = f.startNs;
+    f.mark = 0;
+    bool routed = Route(f, src, dst, sip, dip);
+    assert(routed && "FluidModel: no route between the hosts of a flow");
+    Attach(&f);
+    m_nFluidFlows++;
+    if (!m_standalone && !m_tickEvent.IsRunning()) {
+        m_tickEvent = Simulator::Schedule(m_tick, &FluidModel::Tick, this);
+    }
+}
+
+void FluidModel::Attach(Flow* f) {
+    f->slots.resize(f->links.size());
+    for (uint32_t i = 0; i < f->links.size(); i++) {
+        Link& link = m_links[f->links[i]];
+        f->slots[i] = link.flows.size();
+        link.flows.push_back(f);
+        Touch(f->links[i]);
+    }
+}
+
+void FluidModel::Detach(Flow* f) {
+    for (uint32_t i = 0; i < f->links.size(); i++) {
+        uint32_t l = f->links[i];
+        std::vector<Flow*>& flows = m_links[l].flows;
+        Flow* last = flows.back();
+        flows[f->slots[i]] = last;
+        flows.pop_back();
+        if (last != f) {
+            for (uint32_t j = 0; j < last->links.size(); j++) {
+                if (last->links[j] == l) last->slots[j] = f->slots[i];
+            }
+        }
+        Touch(l);
+    }
+}
+
+void FluidModel::Touch(uint32_t link) {
+    m_touched.push_back(link);
+    // arrivals/departures of the same time step are reallocated together
+    if (!m_reallocEvent.IsRunning()) {
+        m_reallocEvent = Simulator::ScheduleNow(&FluidModel::Reallocate, this);
+    }
+}
+
+void FluidModel::AccountLink(Link& link, uint64_t now) {
+    link.fluidBytes += link.fluidRate * (now - link.lastNs) / 8e9;
+    link.lastNs = now;
+}
+
+void FluidModel::Reallocate() {
+    uint64_t now = Simulator::Now().GetTimeStep();
+    // the max-min rates of a flow only depend on the flows sharing links with it, transitively:
+    // only the components of the touched links are refilled
+    m_epoch++;
+    std::vector<uint32_t>& links = m_walkLinks;
+    std::vector<Flow*>& flows = m_walkFlows;
+    links.clear();
+    flows.clear();
+    if (!m_incremental) {
+        for (uint32_t l = 0; l < m_links.size(); l++) m_touched.push_back(l);
+    }
+    for (uint32_t l : m_touched) {
+        if (m_links[l].mark == m_epoch) continue;
+        m_links[l].mark = m_epoch;
+        links.push_back(l);
+    }
+    m_touched.clear();
+    for (uint32_t i = 0; i < links.size(); i++) {
+        for (Flow* f : m_links[links[i]].flows) {
+            if (f->mark == m_epoch) continue;
+            f->mark = m_epoch;
+            f->newRate = -1;
+            flows.push_back(f);
+            for (uint32_t l : f->links) {
+                if (m_links[l].mark == m_epoch) continue;
+                m_links[l].mark = m_epoch;
+                links.push_back(l);
+            }
+        }
+    }
+
+    // progressive filling: the link of the smallest fair share fixes the rate of its flows.
+    // Fixing flows never lowers the share of the other links: an entry whose share went up since
+    // it was pushed is pushed again with the current share when it reaches the top (lazy min-heap)
+    std::vector<Share>& heap = m_heap;
+    heap.clear();
+    for (uint32_t l : links) {
+        Link& link = m_links[l];
+        link.residual = link.capacity;
+        link.unfixed = link.flows.size();
+        if (link.unfixed > 0) heap.push_back(Share(link.residual / link.unfixed, l));
+    }
+    std::make_heap(heap.begin(), heap.end(), std::greater<Share>());
+    while (!heap.empty()) {
+        Share top = heap.front();
+        std::pop_heap(heap.begin(), heap.end(), std::greater<Share>());
+        heap.pop_back();
+        Link& link = m_links[top.second];
+        if (link.unfixed == 0) continue;
+        double share = std::max(0.0, link.residual) / link.unfixed;
+        if (share != top.first) {
+            heap.push_back(Share(share, top.second));
+            std::push_heap(heap.begin(), heap.end(), std::greater<Share>());
+            continue;
+        }
+        for (Flow* f : link.flows) {
+            if (f->newRate >= 0) continue;
+            f->newRate = share;
+            for (uint32_t l : f->links) {
+                m_links[l].residual -= share;
+                m_links[l].unfixed--;
+            }
+        }
+    }
+
+    for (Flow* f : flows) {
+        if (f->newRate == f->rate) continue;
+        f->remaining = std::max(0.0, f->remaining - f->rate * (now - f->lastNs) / 8e9);
+        f->lastNs = now;
+        f->rate = f->newRate;
+        m_nRateUpdates++;
+        if (f->rate > 0) {
+            uint64_t left = (uint64_t)ceil(f->remaining * 8e9 / f->rate);
+            m_completion.Schedule(f->id, NanoSeconds(now + left));
+        } else {
+            m_completion.Cancel(f->id);
+        }
+    }
+    if (m_standalone) return;  // nothing reads the per-link rates
+
+    for (uint32_t l : links) {
+        Link& link = m_links[l];
+        AccountLink(link, now);
+        link.fluidRate = 0;
+        link.fluidIn.clear();
+        for (uint32_t i = 0; i < link.flows.size(); i++) {
+            Flow* f = link.flows[i];
+            link.fluidRate += f->rate;
+            if (!link.sw) continue;
+            for (uint32_t j = 0; j < f->links.size(); j++) {
+                if (f->links[j] == l) link.fluidIn[std::make_pair(f->inPorts[j], f->pg)] += f->rate;
+            }
+        }
+        // packets compete like one more flow: the fluid flows back off to n/(n+1) of the link
+        double line = link.dev->GetDataRate().GetBitRate();
+        uint32_t n = link.flows.size();
+        uint64_t rate = (uint64_t)std::min(link.fluidRate, line * n / (n + 1));
+        if (link.dev->GetFluidRate() != rate) link.dev->SetFluidRate(rate);
+    }
+}
+
+void FluidModel::Complete(uint32_t flowId) {
+    auto it = m_flows.find(flowId);
+    assert(it != m_flows.end());
+    Flow& f = it->second;
+    Finished fin;
+    fin.flowId = flowId;
+    fin.src = f.src;
+    fin.dst = f.dst;
+    fin.sport = f.sport;
+    fin.dport = f.dport;
+    fin.bytes = f.bytes;
+    fin.startNs = f.startNs;
+    fin.fctNs = Simulator::Now().GetTimeStep() - f.startNs;
+    Detach(&f);
+    m_flows.erase(it);
+    m_nFluidFlows--;
+    m_nFinished++;
+    if (!m_finish.IsNull()) m_finish(fin);
+}
+
+void FluidModel::Tick() {
+    uint64_t now = Simulator::Now().GetTimeStep();
+    std::map<uint64_t, uint32_t> backlog;
+    for (uint32_t l = 0; l < m_links.size(); l++) {
+        Link& link = m_links[l];
+        AccountLink(link, now);
+        if (!link.sw) {
+            link.fluidBytes = 0;
+            continue;
+        }
+        if (link.fluidBytes >= 1) {
+            uint64_t bytes = (uint64_t)link.fluidBytes;
+            link.sw->AddFluidTx(link.port, bytes);
+            link.fluidBytes -= bytes;
+        }
+        if (link.fluidRate <= 0) continue;
+        // Little's law: fluid waits as long as the packets, Q_pkt / (C - f), f as applied to the port
+        double applied = link.dev->GetFluidRate();
+        double drain = link.dev->GetDataRate().GetBitRate() - applied;
+        for (auto& in : link.fluidIn) {
+            uint32_t q = in.first.second;
+            double share = in.second / link.fluidRate;
+            uint32_t bytes = (uint32_t)(share * applied * link.dev->GetQueue()->GetNBytes(q) / drain);
+            if (bytes == 0) continue;
+            backlog[((uint64_t)l << 32) | (in.first.first << 8) | q] = bytes;
+        }
+    }
+    for (auto& old : m_backlog) {
+        if (backlog.count(old.first)) continue;
+        Link& link = m_links[old.first >> 32];
+        link.sw->SetFluidBacklog((old.first >> 8) & 0xffffff, link.port, old.first & 0xff, 0);
+    }
+    for (auto& cur : backlog) {
+        Link& link = m_links[cur.first >> 32];
+        link.sw->SetFluidBacklog((cur.first >> 8) & 0xffffff, link.port, cur.first & 0xff, cur.second);
+    }
+    m_backlog.swap(backlog);
+    if (m_nFluidFlows > 0 || !m_backlog.empty()) {
+        m_tickEvent = Simulator::Schedule(m_tick, &FluidModel::Tick, this);
+    }
+}
+
+}  // namespace ns3
@@ -43,6 +43,9 @@ NS_LOG_COMPONENT_DEFINE("HulaRouting");
 namespace ns3 {
     uint32_t HulaRouting::nFlowletTimeout = 0;
     std::vector<HulaRouting*> HulaRouting::hulaModules;
+    bool HulaRouting::probeBatching = false;
+    std::vector<HulaRouting*> HulaRouting::probeBatchModules;
+    EventId HulaRouting::probeBatchEvent;
 
     /*----- Hula-Route ------*/
     HulaRouting::HulaRouting() {
@@ -54,6 +57,14 @@ namespace ns3 {
     }
 
     void HulaRouting::active(int time) {
+        if (probeBatching) {
+            // all switches share the same start time and interval, so a single event drives them all
+            probeBatchModules.push_back(this);
+            if (!probeBatchEvent.IsRunning()) {
+                probeBatchEvent = Simulator::Schedule(Seconds(time) - MicroSeconds(500), &HulaRouting::GenerateProbeBatch);
+            }
+            return;
+        }
         sendProbeEvent = Simulator::Schedule(Seconds(time) - MicroSeconds(500), &HulaRouting::generateProbe, this);
     }
 
@@ -64,7 +75,7 @@ namespace ns3 {
 
     TypeId HulaRouting::GetTypeId(void) {
         static TypeId tid =
-            TypeId("ns3::CongaRouting").SetParent<Object>().AddConstructor<HulaRouting>();
+            TypeId("ns3::HulaRouting").SetParent<LoadBalancer>().AddConstructor<HulaRouting>();
 
         return tid;
     }
@@ -83,13 +94,7 @@ namespace ns3 {
         probeSendNum++;
     }
 
-    void HulaRouting::SetSwitchSendCallback(SwitchSendCallback switchSendCallback) {
-        m_switchSendCallback = switchSendCallback;
-    }
 
-    void HulaRouting::SetSwitchSendToDevCallback(SwitchSendToDevCallback switchSendToDevCallback) {
-        m_switchSendToDevCallback = switchSendToDevCallback;
-    }
 
     void HulaRouting::SetSwitchSendHulaProbeCallback(SwitchSendHulaProbeCallback switchSendHulaProbeCallback) {
         m_switchSendHulaProbeCallback = switchSendHulaProbeCallback;
@@ -101,14 +106,28 @@ namespace ns3 {
     }
 
     void HulaRouting::SetLinkCapacity(uint32_t outPort, uint64_t bitRate) {
-        auto it = devInfo.find(outPort);
-        if (it != devInfo.end()) {
+        LinkInfo& info = GetLinkInfo(outPort);
+        if (info.maxBitRate != 0) {
             // already exists, then check matching
-            NS_ASSERT_MSG(it->second.maxBitRate == bitRate,
+            NS_ASSERT_MSG(info.maxBitRate == bitRate,
                         "bitrate already exists, but inconsistent with new input");
         } else {
-            devInfo[outPort].maxBitRate = bitRate;
+            info.maxBitRate = bitRate;
+        }
+    }
+
+    HulaRouting::NextHopItem& HulaRouting::GetNextHopItem(uint32_t torID) {
+        if (torID >= target2nextHop.size()) {
+            target2nextHop.resize(torID + 1);
+        }
+        return target2nextHop[torID];
+    }
+
+    HulaRouting::LinkInfo& HulaRouting::GetLinkInfo(uint32_t dev) {
+        if (dev >= devInfo.size()) {
+            devInfo.resize(dev + 1);
         }
+        return devInfo[dev];
     }
 
     void HulaRouting::SetConstants(Time keepAliveThresh,
@@ -123,7 +142,25 @@ namespace ns3 {
         this->tau = tau;
     }
 
-    /* CongaRouting's main function */
+    bool HulaRouting::Ingress(Ptr<Packet> p, CustomHeader& ch) {
+        RouteInput(p, ch);
+        return true;
+    }
+
+    void HulaRouting::OnSend(Ptr<Packet> p, uint32_t outDev) { updateLink(outDev, p->GetSize()); }
+    void HulaRouting::OnFluidTx(uint32_t outDev, uint64_t bytes) { updateLink(outDev, bytes); }
+    void HulaRouting::ReportMemory(MemoryAccounting::Report& report) {
+        report.Add("hula.flowlet", flowletTable.size(), MemoryAccounting::HashBytes(flowletTable));
+        report.Add("hula.next_hop", target2nextHop.size(),
+                   MemoryAccounting::VectorBytes(target2nextHop) + MemoryAccounting::VectorBytes(devInfo));
+    }
+
+    bool HulaRouting::ReceiveControl(uint32_t ifIndex, Ptr<Packet> p, CustomHeader& ch) {
+        processProbe(ifIndex, p, ch);
+        return true;
+    }
+
+    /* HulaRouting's main function */
     void HulaRouting::RouteInput(Ptr<Packet> p, CustomHeader ch) {
     // Packet arrival time
         Time now = Simulator::Now();
@@ -154,7 +191,7 @@ namespace ns3 {
             return;
         }
         // 如果当前表项还没有初始化，就使用ECMP，特别是到达目标tor的时候
-        if (target2nextHop.find(dstToRId) == target2nextHop.end()) {
+        if (dstToRId >= target2nextHop.size() || !target2nextHop[dstToRId].valid) {
             DoSwitchSendToDev(p, ch);
             if (Simulator::Now() > Seconds(2.0001)) {
                 //printf("[%ld]路由表未初始化，node:%d, dst:%d\n", Simulator::Now().GetNanoSeconds(), m_switch_id, Settings::hostIp2IdMap[ch.dip]);
@@ -167,19 +204,21 @@ namespace ns3 {
 
         // get QpKey to find flowlet
         //uint64_t qpkey = GetQpKey(ch.dip, ch.udp.sport, ch.udp.dport, ch.udp.pg);
-        if (flowletTable.find(flow_id) != flowletTable.end()              //如果已经有了这个flowlet
-            && now - flowletTable[flow_id].activeTime < flowletInterval) {
-            flowletTable[flow_id].activeTime = now;
-            flowletTable[flow_id].nPackets++;
-            DoSwitchSend(p, ch, flowletTable[flow_id].nextHopDev, ch.udp.pg);
+        auto flowletItr = flowletTable.find(flow_id);
+        if (flowletItr != flowletTable.end()              //如果已经有了这个flowlet
+            && now - flowletItr->second.activeTime < flowletInterval) {
+            flowletItr->second.activeTime = now;
+            flowletItr->second.nPackets++;
+            DoSwitchSend(p, ch, flowletItr->second.nextHopDev, ch.udp.pg);
         } else {
-            if (flowletTable.find(flow_id) != flowletTable.end()) { //分片
+            if (flowletItr != flowletTable.end()) { //分片
                 HulaRouting::nFlowletTimeout++;
-                printf("Switch %u: Flow:%u, flowlet timeout, Now:%ld, Previous:%ld\n", m_switch_id, flow_id, Simulator::Now().GetNanoSeconds(), flowletTable[flow_id].activeTime.GetNanoSeconds());
+                printf("Switch %u: Flow:%u, flowlet timeout, Now:%ld, Previous:%ld\n", m_switch_id, flow_id, Simulator::Now().GetNanoSeconds(), flowletItr->second.activeTime.GetNanoSeconds());
             }
             //printf("Switch %u: Flow:%u, choose path\n", m_switch_id, flow_id);
-            flowletTable[flow_id] = FlowletInfo(now, target2nextHop[dstToRId].nextHopDev);
-            DoSwitchSend(p, ch, flowletTable[flow_id].nextHopDev, ch.udp.pg);
+            FlowletInfo& flowlet = flowletTable[flow_id];
+            flowlet = FlowletInfo(now, target2nextHop[dstToRId].nextHopDev);
+            DoSwitchSend(p, ch, flowlet.nextHopDev, ch.udp.pg);
             //printf("Switch:%d, flow id:%d, routed to %d\n", m_switch_id, flow_id, flowletTable[qpkey].nextHopDev);
         }
         if (now - lastFlowletAgingTime > flowletInterval * 3) {
@@ -191,24 +230,27 @@ namespace ns3 {
         assert(ch.l3Prot == 0xFB);
         uint32_t torID = ch.hula.data.torID;
         uint8_t  util = ch.hula.data.minUtil;
-        uint8_t  minUtil  = std::max(util, (uint8_t)(devInfo[inDev].curUtil / (devInfo[inDev].maxBitRate * tau.GetSeconds()) * 256));
+        LinkInfo& link = GetLinkInfo(inDev);
+        uint8_t  minUtil  = std::max(util, (uint8_t)(link.curUtil / (link.maxBitRate * tau.GetSeconds()) * 256));
         //printf("minUtil:%d\n", minUtil);
         Time now = Simulator::Now();
-        if (target2nextHop[torID].nextHopDev == inDev                       //如果输入源与当前下一跳一致
-            || now - target2nextHop[torID].lastUpdateTime > keepAliveThresh //如果当前下一条已经老化
-            || target2nextHop[torID].pathUtil > minUtil) {                  //如果当前链路状态大于之前的
-            if (now - target2nextHop[torID].lastUpdateTime > keepAliveThresh) {
+        NextHopItem& item = GetNextHopItem(torID);
+        item.valid = true;
+        if (item.nextHopDev == inDev                       //如果输入源与当前下一跳一致
+            || now - item.lastUpdateTime > keepAliveThresh //如果当前下一条已经老化
+            || item.pathUtil > minUtil) {                  //如果当前链路状态大于之前的
+            if (now - item.lastUpdateTime > keepAliveThresh) {
                 probeAgedNum++;
             }
-            if (target2nextHop[torID].pathUtil > minUtil && inDev != target2nextHop[torID].nextHopDev) {
+            if (item.pathUtil > minUtil && inDev != item.nextHopDev) {
                 probeUpdateHopNum++;
             }
-            target2nextHop[torID].nextHopDev = inDev;
-            target2nextHop[torID].pathUtil = minUtil;
-            target2nextHop[torID].lastUpdateTime = now;
+            item.nextHopDev = inDev;
+            item.pathUtil = minUtil;
+            item.lastUpdateTime = now;
         }
         ch.hula.data.minUtil = minUtil;
-        if (now - target2nextHop[torID].lastProbeSendTime > probeTransmitInterval && !m_isToR) { //如果需要转发
+        if (now - item.lastProbeSendTime > probeTransmitInterval && !m_isToR) { //如果需要转发
             for (auto dev : downLayerDevs) { //先将原探针转发到下层
                 if (dev == inDev) {
                     continue;
@@ -220,7 +262,7 @@ namespace ns3 {
                     DoSwitchSendHulaProbe(dev, torID, minUtil);
                 }
             }
-            target2nextHop[torID].lastProbeSendTime = now;
+            item.lastProbeSendTime = now;
         }
         probeReceiveNum++;
     }
@@ -239,25 +281,47 @@ namespace ns3 {
 
     void HulaRouting::updateLink(uint32_t dev, uint32_t packetSize) {
         Time now = Simulator::Now();
-        devInfo[dev].curUtil = packetSize + (devInfo[dev].curUtil * (1 - (now - devInfo[dev].lastUpdateTime) / tau)).GetDouble();
-        devInfo[dev].lastUpdateTime = now;
+        LinkInfo& link = GetLinkInfo(dev);
+        link.curUtil = packetSize + (link.curUtil * (1 - (now - link.lastUpdateTime) / tau)).GetDouble();
+        link.lastUpdateTime = now;
     }
 
-    void HulaRouting::generateProbe() {
+    void HulaRouting::sendProbes() {
         for (auto dev : upLayerDevs) {
             //std::cout<<Simulator::Now()<<m_switch_id<<"send a probe on "<<dev<<std::endl;
             DoSwitchSendHulaProbe(dev, m_switch_id, 0);
         }
+    }
+
+    void HulaRouting::generateProbe() {
+        sendProbes();
         sendProbeEvent = Simulator::Schedule(probeGenerationInterval, &HulaRouting::generateProbe, this);
     }
 
+    // probe-batching mode: same timing as per-switch generateProbe, but one event per interval in total
+    void HulaRouting::GenerateProbeBatch() {
+        if (probeBatchModules.empty()) {
+            return;
+        }
+        for (auto module : probeBatchModules) {
+            module->sendProbes();
+        }
+        probeBatchEvent = Simulator::Schedule(probeBatchModules[0]->probeGenerationInterval, &HulaRouting::GenerateProbeBatch);
+    }
+
     void HulaRouting::Print() {
         std::cout<<"===============Switch "<<m_switch_id<<"====================\n";
-        for (auto& pair : target2nextHop) {
-            printf("dst %d: %d %d\n", pair.first, pair.second.nextHopDev, (int)pair.second.pathUtil);
+        for (uint32_t torID = 0; torID < target2nextHop.size(); torID++) {
+            if (!target2nextHop[torID].valid) {
+                continue;
+            }
+            printf("dst %d: %d %d\n", torID, target2nextHop[torID].nextHopDev, (int)target2nextHop[torID].pathUtil);
         }
-        for (auto& pair : devInfo) {
-            printf("link %d: %ld\n", pair.first, pair.second.curUtil);
+        for (uint32_t dev = 0; dev < devInfo.size(); dev++) {
+            if (devInfo[dev].maxBitRate == 0) {
+                continue;
+            }
+            printf("link %d: %ld\n", dev, devInfo[dev].curUtil);
         }
     }
 }  // namespace ns3
\ No newline at end of file
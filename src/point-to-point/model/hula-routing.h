@@ -36,6 +36,7 @@
 #include "ns3/address.h"
 #include "ns3/callback.h"
 #include "ns3/event-id.h"
+#include "ns3/load-balancer.h"
 #include "ns3/net-device.h"
 #include "ns3/object.h"
 #include "ns3/packet.h"
@@ -48,7 +49,7 @@ namespace ns3 {
 /**
  * @brief Conga object is created for each ToR Switch
  */
-class HulaRouting : public Object {
+class HulaRouting : public LoadBalancer {
     friend class SwitchMmu;
     friend class SwitchNode;
 
@@ -59,9 +60,18 @@ class HulaRouting : public Object {
     static uint64_t GetQpKey(uint32_t dip, uint16_t sport, uint16_t dport, uint16_t pg);              // same as in rdma_hw.cc
     static uint32_t nFlowletTimeout;
     static std::vector<HulaRouting*> hulaModules;
+    static bool probeBatching;                          // one timer event generates probes of all switches
+    static std::vector<HulaRouting*> probeBatchModules; // activated switches, in activation order
+    static EventId probeBatchEvent;
+    static void GenerateProbeBatch();
 
     /* main function */
     void RouteInput(Ptr<Packet> p, CustomHeader ch);
+    virtual bool Ingress(Ptr<Packet> p, CustomHeader& ch);  // takes every packet: RouteInput
+    virtual void OnSend(Ptr<Packet> p, uint32_t outDev);    // updateLink
+    virtual void OnFluidTx(uint32_t outDev, uint64_t bytes);  // updateLink with the fluid bytes
+    virtual void ReportMemory(MemoryAccounting::Report& report);  // flowlet table
+    virtual bool ReceiveControl(uint32_t ifIndex, Ptr<Packet> p, CustomHeader& ch);  // processProbe
     void processProbe(uint32_t inDev, Ptr<Packet> p, CustomHeader ch);
     void updateLink(uint32_t dev, uint32_t packetSize);
     void active(int time);
@@ -81,12 +91,7 @@ class HulaRouting : public Object {
                       uint32_t qIndex);  // TxToR and Agg/CoreSw
     void DoSwitchSendToDev(Ptr<Packet> p, CustomHeader& ch);  // only at RxToR
     void DoSwitchSendHulaProbe(uint32_t dev, uint32_t torID, uint8_t minUtil);
-    typedef Callback<void, Ptr<Packet>, CustomHeader&, uint32_t, uint32_t> SwitchSendCallback;
-    typedef Callback<void, Ptr<Packet>, CustomHeader&> SwitchSendToDevCallback;
     typedef Callback<void, uint32_t, uint32_t, uint8_t> SwitchSendHulaProbeCallback;
-    void SetSwitchSendCallback(SwitchSendCallback switchSendCallback);  // set callback
-    void SetSwitchSendToDevCallback(
-        SwitchSendToDevCallback switchSendToDevCallback);  // set callback
     void SetSwitchSendHulaProbeCallback(SwitchSendHulaProbeCallback switchSendHulaProbeCallback);
     /*-----------*/
     
@@ -97,18 +102,18 @@ class HulaRouting : public Object {
 
    private:
     // callback
-    SwitchSendCallback m_switchSendCallback;  // bound to SwitchNode::SwitchSend (for Request/UDP)
-    SwitchSendToDevCallback m_switchSendToDevCallback;  // bound to SwitchNode::SendToDevContinue (for Probe, Reply)
     SwitchSendHulaProbeCallback m_switchSendHulaProbeCallback;
 
     struct NextHopItem {
         uint32_t    nextHopDev;       //下一跳
         uint8_t     pathUtil;          //链路利用率
+        bool        valid;             //是否已经收到过该ToR的探针
         Time        lastUpdateTime;   //上次更新时间
         Time        lastProbeSendTime;
         NextHopItem() :
             nextHopDev(0), 
             pathUtil(255), 
+            valid(false),
             lastUpdateTime(Seconds(0)),
             lastProbeSendTime(Seconds(-1)) {}
     };
@@ -130,9 +135,9 @@ class HulaRouting : public Object {
             activeTime(now), createTime(now), nextHopDev(nextHopDev), nPackets(1) {};
     };
 
-    std::map<uint32_t, NextHopItem> target2nextHop;  //target ToRID->nextHop
-    std::map<uint32_t, FlowletInfo> flowletTable;  // QpKey -> Flowlet (at SrcToR)
-    std::map<uint32_t, LinkInfo> devInfo;           //dev->linkInfo
+    std::vector<NextHopItem> target2nextHop;  //target ToRID->nextHop (dense, indexed by ToR's nodeID)
+    std::unordered_map<uint32_t, FlowletInfo> flowletTable;  // flowId -> Flowlet (at SrcToR)
+    std::vector<LinkInfo> devInfo;           //dev->linkInfo (dense, indexed by port)
     Time lastFlowletAgingTime;   //上次清除flowlet表中过期项的时间
     EventId sendProbeEvent;
 
@@ -145,7 +150,10 @@ class HulaRouting : public Object {
     Time tau;                    //计算链路利用率使用，至少是探针的生成间隔的两倍
 
     void generateProbe();
-    void clearInvalidFlowletItem();             
+    void sendProbes();
+    void clearInvalidFlowletItem();
+    NextHopItem& GetNextHopItem(uint32_t torID);
+    LinkInfo& GetLinkInfo(uint32_t dev);
 
    public:
     bool m_isToR;          // is ToR (leaf)
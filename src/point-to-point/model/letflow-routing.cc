@@ -31,6 +31,7 @@
 #include "ns3/packet.h"
 #include "ns3/settings.h"
 #include "ns3/simulator.h"
+#include "ns3/switch-node.h"
 
 NS_LOG_COMPONENT_DEFINE("LetflowRouting");
 
@@ -96,7 +97,7 @@ uint64_t LetflowRouting::GetQpKey(uint32_t dip, uint16_t sport, uint16_t dport,
 
 TypeId LetflowRouting::GetTypeId(void) {
     static TypeId tid = TypeId("ns3::LetflowRouting")
-                            .SetParent<Object>()
+                            .SetParent<LoadBalancer>()
                             .AddConstructor<LetflowRouting>();
     return tid;
 }
@@ -106,6 +107,28 @@ void LetflowRouting::SetSwitchInfo(bool isToR, uint32_t switch_id) {
     m_switch_id = switch_id;
 }
 
+uint32_t LetflowRouting::SelectPort(Ptr<Packet> p, CustomHeader& ch,
+                                    const std::vector<int>& nexthops) {
+    if (m_isToR && nexthops.size() == 1) {
+        const std::unordered_set<uint32_t>& localHosts =
+            static_cast<SwitchNode*>(m_node)->m_isToR_hostIP;
+        if (localHosts.find(ch.sip) != localHosts.end() &&
+            localHosts.find(ch.dip) != localHosts.end()) {
+            return nexthops[0];  // intra-pod traffic
+        }
+    }
+
+    /* ONLY called for inter-Pod traffic */
+    uint32_t outPort = RouteInput(p, ch);
+    if (outPort == LETFLOW_NULL) {
+        assert(nexthops.size() == 1);  // Receiver's TOR has only one interface to receiver-server
+        outPort = nexthops[0];         // has only one option
+    }
+    assert(std::find(nexthops.begin(), nexthops.end(), outPort) !=
+           nexthops.end());  // Result of Letflow cannot be found in nexthops
+    return outPort;
+}
+
 /* LetflowRouting's main function */
 uint32_t LetflowRouting::RouteInput(Ptr<Packet> p, CustomHeader ch) {
     // Packet arrival time
@@ -142,15 +165,11 @@ uint32_t LetflowRouting::RouteInput(Ptr<Packet> p, CustomHeader ch) {
     if (m_isToR) {     // ToR switch
         if (!found) {  // sender-side
             /*---- choosing outPort ----*/
-            struct Flowlet* flowlet = NULL;
-            auto flowletItr = m_flowletTable.find(qpkey);
+            struct Flowlet* flowlet = m_flowletTable.Find(qpkey);
             uint32_t selectedPath;
 
             // 1) when flowlet already exists
-            if (flowletItr != m_flowletTable.end()) {
-                flowlet = flowletItr->second;
-                NS_ASSERT_MSG(flowlet != NULL, "Impossible in normal cases - flowlet is not correctly registered");
-
+            if (flowlet != NULL) {
                 if (now - flowlet->_activeTime <= m_flowletTimeout) {  // no timeout
                     // update flowlet info
                     flowlet->_activeTime = now;
@@ -195,12 +214,12 @@ uint32_t LetflowRouting::RouteInput(Ptr<Packet> p, CustomHeader ch) {
             }
             // 2) flowlet does not exist, e.g., first packet of flow
             selectedPath = GetRandomPath(dstToRId);
-            struct Flowlet* newFlowlet = new Flowlet;
-            newFlowlet->_activeTime = now;
-            newFlowlet->_activatedTime = now;
-            newFlowlet->_nPackets = 1;
-            newFlowlet->_PathId = selectedPath;
-            m_flowletTable[qpkey] = newFlowlet;
+            struct Flowlet newFlowlet;
+            newFlowlet._activeTime = now;
+            newFlowlet._activatedTime = now;
+            newFlowlet._nPackets = 1;
+            newFlowlet._PathId = selectedPath;
+            m_flowletTable.Insert(qpkey, newFlowlet);
 
             // update/add letflowTag
             uint32_t outPort = GetOutPortFromPath(selectedPath, 0);
@@ -245,20 +264,17 @@ uint32_t LetflowRouting::RouteInput(Ptr<Packet> p, CustomHeader ch) {
 
 // random selection
 uint32_t LetflowRouting::GetRandomPath(uint32_t dstToRId) {
-    auto pathItr = m_letflowRoutingTable.find(dstToRId);
-    assert(pathItr != m_letflowRoutingTable.end());  // Cannot find dstToRId from ToLeafTable
+    if (!m_pathTable.IsFrozen()) {
+        m_pathTable.Freeze(m_letflowRoutingTable);
+    }
+    uint32_t ord = m_pathTable.GetOrdinal(dstToRId);
+    assert(ord != FlatPathTable::INVALID);  // Cannot find dstToRId from ToLeafTable
 
-    auto innerPathItr = pathItr->second.begin();
-    std::advance(innerPathItr, rand() % pathItr->second.size());
-    return *innerPathItr;
+    return m_pathTable.PathId(m_pathTable.Begin(ord) + rand() % m_pathTable.Size(ord));
 }
 
 uint32_t LetflowRouting::GetOutPortFromPath(const uint32_t& path, const uint32_t& hopCount) {
-    return ((uint8_t*)&path)[hopCount];
-}
-
-void LetflowRouting::SetOutPortToPath(uint32_t& path, const uint32_t& hopCount, const uint32_t& outPort) {
-    ((uint8_t*)&path)[hopCount] = outPort;
+    return PathCodec::GetPort(path, hopCount);
 }
 
 void LetflowRouting::SetConstants(Time agingTime, Time flowletTimeout) {
@@ -267,9 +283,7 @@ void LetflowRouting::SetConstants(Time agingTime, Time flowletTimeout) {
 }
 
 void LetflowRouting::DoDispose() {
-    for (auto i : m_flowletTable) {
-        delete (i.second);
-    }
+    m_flowletTable.Clear();
     m_agingEvent.Cancel();
 }
 
@@ -279,15 +293,14 @@ void LetflowRouting::AgingEvent() {
      */
     NS_LOG_FUNCTION(Simulator::Now());
     auto now = Simulator::Now();
-    auto itr = m_flowletTable.begin();
-    while (itr != m_flowletTable.end()) {
-        if (now - ((itr->second)->_activeTime) > m_agingTime) {
-            itr = m_flowletTable.erase(itr);
-        } else {
-            ++itr;
-        }
-    }
+    Time agingTime = m_agingTime;
+    m_flowletTable.EraseIf(
+        [now, agingTime](const Flowlet& f) { return now - f._activeTime > agingTime; });
     m_agingEvent = Simulator::Schedule(m_agingTime, &LetflowRouting::AgingEvent, this);
 }
 
+void LetflowRouting::ReportMemory(MemoryAccounting::Report& report) {
+    report.Add("letflow.flowlet", m_flowletTable.Size(), m_flowletTable.GetMemoryBytes());
+}
+
 }  // namespace ns3
\ No newline at end of file
@@ -31,7 +31,10 @@
 #include "ns3/address.h"
 #include "ns3/callback.h"
 #include "ns3/event-id.h"
+#include "ns3/lb-flat-table.h"
+#include "ns3/load-balancer.h"
 #include "ns3/net-device.h"
+#include "ns3/path-codec.h"
 #include "ns3/object.h"
 #include "ns3/packet.h"
 #include "ns3/ptr.h"
@@ -66,27 +69,25 @@ class LetflowTag : public Tag {
 /**
  * @brief Conga object is created for each ToR Switch
  */
-class LetflowRouting : public Object {
+class LetflowRouting : public LoadBalancer {
     friend class SwitchMmu;
     friend class SwitchNode;
 
    public:
     LetflowRouting();
 
-    /** path <-> outPort **/
-    // uint8_t pathp[4] = {uint8_t[port0], uint8_t[port1], uint8_t[port2], uint8_t[port3]}
-    // uint32_t path = *((uint32_t*) pathp);
-    // (uint8_t*)&path[0] -> port0
+    /** path <-> outPort: pathId of PathCodec (variable length) **/
 
     /* static */
     static TypeId GetTypeId(void);
     static uint64_t GetQpKey(uint32_t dip, uint16_t sport, uint16_t dport, uint16_t pg);              // same as in rdma_hw.cc
     static uint32_t GetOutPortFromPath(const uint32_t& path, const uint32_t& hopCount);               // decode outPort from path, given a hop's order
-    static void SetOutPortToPath(uint32_t& path, const uint32_t& hopCount, const uint32_t& outPort);  // encode outPort to path
     static uint32_t nFlowletTimeout;                                                                  // number of flowlet's timeout
 
     /* main function */
     uint32_t RouteInput(Ptr<Packet> p, CustomHeader ch);
+    virtual uint32_t SelectPort(Ptr<Packet> p, CustomHeader& ch, const std::vector<int>& nexthops);
+    virtual void ReportMemory(MemoryAccounting::Report& report);  // flowlet table
     uint32_t GetRandomPath(uint32_t dstTorId);
     virtual void DoDispose();
 
@@ -99,7 +100,7 @@ class LetflowRouting : public Object {
     void AgingEvent();
 
     // topological info (should be initialized in the beginning)
-    std::map<uint32_t, std::set<uint32_t> > m_letflowRoutingTable;  // routing table (ToRId -> pathId) (stable)
+    std::map<uint32_t, std::set<uint32_t> > m_letflowRoutingTable;  // routing table (ToRId -> pathId) (stable, setup only)
 
     /*-----------*/
 
@@ -113,7 +114,8 @@ class LetflowRouting : public Object {
     Time m_flowletTimeout;  // flowlet timeout (e.g., 100us)
 
     // local
-    std::map<uint64_t, Flowlet*> m_flowletTable;  // QpKey -> Flowlet (at SrcToR)
+    FlatPathTable m_pathTable;                 // frozen m_letflowRoutingTable (built on the first packet)
+    FlowletHashTable<Flowlet> m_flowletTable;  // QpKey -> Flowlet (at SrcToR)
 };
 
 }  // namespace ns3
\ No newline at end of file
@@ -0,0 +1,191 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CAVER-LB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "ns3/link-telemetry.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include "ns3/broadcom-egress-queue.h"
+#include "ns3/qbb-net-device.h"
+#include "ns3/switch-node.h"
+
+namespace ns3 {
+
+LinkTelemetry::LinkTelemetry()
+    : m_startNs(0),
+      m_sampleNs(10000),
+      m_downsample(10),
+      m_primed(false),
+      m_nSamples(0),
+      m_nPoints(0) {}
+
+void LinkTelemetry::SetInterval(uint64_t sampleNs, uint32_t downsample) {
+    assert(sampleNs > 0 && downsample > 0);
+    m_sampleNs = sampleNs;
+    m_downsample = downsample;
+}
+
+void LinkTelemetry::AddLink(Ptr<SwitchNode> sw, uint32_t port, uint32_t peerId,
+                            uint32_t uplinkOfToR) {
+    Ptr<QbbNetDevice> dev = DynamicCast<QbbNetDevice>(sw->GetDevice(port));
+    assert(dev != NULL);
+
+    Link link;
+    link.sw = sw;
+    link.queue = dev->GetQueue();
+    link.nodeId = sw->GetId();
+    link.port = port;
+    link.peerId = peerId;
+    link.torId = uplinkOfToR;
+    link.bitRate = dev->GetDataRate().GetBitRate();
+    link.lastTxBytes = 0;
+    link.maxQueueBytes = 0;
+    memset(link.queueHist, 0, sizeof(link.queueHist));
+    m_links.push_back(link);
+
+    if (uplinkOfToR != NO_TOR) {
+        auto it = std::find_if(m_tors.begin(), m_tors.end(),
+                               [uplinkOfToR](const ToR& t) { return t.torId == uplinkOfToR; });
+        if (it == m_tors.end()) {
+            ToR tor;
+            tor.torId = uplinkOfToR;
+            m_tors.push_back(tor);
+            it = m_tors.end() - 1;
+        }
+        it->uplinks.push_back(m_links.size() - 1);
+    }
+}
+
+uint32_t LinkTelemetry::QueueBin(uint32_t bytes) {
+    if (bytes == 0) return 0;
+    uint32_t bin = 32 - __builtin_clz(bytes);  // floor(log2(bytes)) + 1
+    return std::min(bin, (uint32_t)QUEUE_BINS - 1);
+}
+
+void LinkTelemetry::Sample() {
+    if (!m_primed) {
+        for (auto& link : m_links) {
+            link.lastTxBytes = link.sw->GetTxBytesOutDev(link.port);
+        }
+        m_primed = true;
+        return;
+    }
+    for (auto& link : m_links) {
+        uint32_t qBytes = link.queue->GetOccupancy();
+        link.queueHist[QueueBin(qBytes)]++;
+        link.maxQueueBytes = std::max(link.maxQueueBytes, qBytes);
+    }
+    if (++m_nSamples == m_downsample) {
+        EmitPoint();
+        m_nSamples = 0;
+    }
+}
+
+void LinkTelemetry::EmitPoint() {
+    double windowSec = (double)m_sampleNs * m_downsample / 1e9;
+    m_pointUtil.resize(m_links.size());
+    for (uint32_t i = 0; i < m_links.size(); i++) {
+        Link& link = m_links[i];
+        uint64_t txBytes = link.sw->GetTxBytesOutDev(link.port);
+        double util = (txBytes - link.lastTxBytes) * 8.0 / (link.bitRate * windowSec);
+        link.lastTxBytes = txBytes;
+        m_pointUtil[i] = util;
+        link.util.push_back((uint16_t)std::min(std::lround(util * 10000), 65535L));
+    }
+
+    // imbalance over the uplinks of each ToR; an idle ToR reports max/mean = 1, CV = 0
+    for (auto& tor : m_tors) {
+        double sum = 0, sumSq = 0, maxUtil = 0;
+        for (auto i : tor.uplinks) {
+            sum += m_pointUtil[i];
+            sumSq += m_pointUtil[i] * m_pointUtil[i];
+            maxUtil = std::max(maxUtil, m_pointUtil[i]);
+        }
+        double n = tor.uplinks.size();
+        double mean = sum / n;
+        if (mean > 0) {
+            double var = std::max(sumSq / n - mean * mean, 0.0);
+            tor.maxMean.push_back(maxUtil / mean);
+            tor.cv.push_back(std::sqrt(var) / mean);
+        } else {
+            tor.maxMean.push_back(1);
+            tor.cv.push_back(0);
+        }
+    }
+    m_nPoints++;
+}
+
+/**
+ * File layout (native little-endian, no padding):
+ *   char[4] "LTEL", u32 version(1)
+ *   u64 startNs, u64 sampleNs, u32 downsample, u32 nPoints, u32 nLinks, u32 nQueueBins
+ *   nLinks x { u32 nodeId, port, peerId, torId, u64 bitRate, u32 maxQueueBytes,
+ *              u64 queueHist[nQueueBins], u16 util[nPoints] }
+ *   u32 nToRs
+ *   nToRs x { u32 torId, u32 nUplinks, f32 maxMean[nPoints], f32 cv[nPoints] }
+ */
+bool LinkTelemetry::Write(const char* filename) const {
+    FILE* fout = fopen(filename, "wb");
+    if (fout == NULL) {
+        return false;
+    }
+    const uint32_t version = 1, nQueueBins = QUEUE_BINS;
+    uint32_t nLinks = m_links.size(), nToRs = m_tors.size();
+    fwrite("LTEL", 1, 4, fout);
+    fwrite(&version, sizeof(version), 1, fout);
+    fwrite(&m_startNs, sizeof(m_startNs), 1, fout);
+    fwrite(&m_sampleNs, sizeof(m_sampleNs), 1, fout);
+    fwrite(&m_downsample, sizeof(m_downsample), 1, fout);
+    fwrite(&m_nPoints, sizeof(m_nPoints), 1, fout);
+    fwrite(&nLinks, sizeof(nLinks), 1, fout);
+    fwrite(&nQueueBins, sizeof(nQueueBins), 1, fout);
+    for (auto& link : m_links) {
+        fwrite(&link.nodeId, sizeof(uint32_t), 1, fout);
+        fwrite(&link.port, sizeof(uint32_t), 1, fout);
+        fwrite(&link.peerId, sizeof(uint32_t), 1, fout);
+        fwrite(&link.torId, sizeof(uint32_t), 1, fout);
+        fwrite(&link.bitRate, sizeof(uint64_t), 1, fout);
+        fwrite(&link.maxQueueBytes, sizeof(uint32_t), 1, fout);
+        fwrite(link.queueHist, sizeof(uint64_t), QUEUE_BINS, fout);
+        fwrite(link.util.data(), sizeof(uint16_t), m_nPoints, fout);
+    }
+    fwrite(&nToRs, sizeof(nToRs), 1, fout);
+    for (auto& tor : m_tors) {
+        uint32_t nUplinks = tor.uplinks.size();
+        fwrite(&tor.torId, sizeof(uint32_t), 1, fout);
+        fwrite(&nUplinks, sizeof(uint32_t), 1, fout);
+        fwrite(tor.maxMean.data(), sizeof(float), m_nPoints, fout);
+        fwrite(tor.cv.data(), sizeof(float), m_nPoints, fout);
+    }
+    fclose(fout);
+    return true;
+}
+
+}  // namespace ns3
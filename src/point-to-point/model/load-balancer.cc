@@ -0,0 +1,168 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CAVER-LB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "ns3/load-balancer.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "ns3/assert.h"
+#include "ns3/caver-routing.h"
+#include "ns3/conga-routing.h"
+#include "ns3/conweave-routing.h"
+#include "ns3/dv-routing.h"
+#include "ns3/hula-routing.h"
+#include "ns3/letflow-routing.h"
+#include "ns3/node.h"
+#include "ns3/noshare-routing.h"
+#include "ns3/qbb-net-device.h"
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED(LoadBalancer);
+
+TypeId LoadBalancer::GetTypeId(void) {
+    static TypeId tid =
+        TypeId("ns3::LoadBalancer").SetParent<Object>().AddConstructor<LoadBalancer>();
+    return tid;
+}
+
+LoadBalancer::LoadBalancer() : m_node(NULL) {}
+
+LoadBalancer::~LoadBalancer() {}
+
+void LoadBalancer::SetNode(Ptr<Node> node) { m_node = PeekPointer(node); }
+
+void LoadBalancer::SetSwitchSendCallback(SwitchSendCallback switchSendCallback) {
+    m_switchSendCallback = switchSendCallback;
+}
+
+void LoadBalancer::SetSwitchSendToDevCallback(SwitchSendToDevCallback switchSendToDevCallback) {
+    m_switchSendToDevCallback = switchSendToDevCallback;
+}
+
+std::map<uint32_t, LoadBalancer::Entry>& LoadBalancer::Registry() {
+    static std::map<uint32_t, Entry> registry;
+    if (registry.empty()) {
+        registry[0] = Entry{"fecmp", &Make<LoadBalancer>};
+        registry[2] = Entry{"drill", &Make<DrillLoadBalancer>};
+        registry[3] = Entry{"conga", &Make<CongaRouting>};
+        registry[6] = Entry{"letflow", &Make<LetflowRouting>};
+        registry[9] = Entry{"conweave", &Make<ConWeaveRouting>};
+        registry[10] = Entry{"dv", &Make<DVRouting>};
+        registry[12] = Entry{"hula", &Make<HulaRouting>};
+        registry[20] = Entry{"caver", &Make<CaverRouting>};
+        registry[21] = Entry{"noshare", &Make<NoshareRouting>};
+    }
+    return registry;
+}
+
+void LoadBalancer::Register(const std::string& name, uint32_t mode, Factory factory) {
+    Registry()[mode] = Entry{name, factory};
+}
+
+bool LoadBalancer::LookupMode(const std::string& name, uint32_t& mode) {
+    for (auto& it : Registry()) {
+        if (it.second.name == name) {
+            mode = it.first;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string LoadBalancer::GetName(uint32_t mode) {
+    auto it = Registry().find(mode);
+    return it == Registry().end() ? "" : it->second.name;
+}
+
+std::string LoadBalancer::ListModes(void) {
+    std::string list;
+    for (auto& it : Registry()) {
+        if (!list.empty()) list += ", ";
+        list += it.second.name + " (" + std::to_string(it.first) + ")";
+    }
+    return list;
+}
+
+Ptr<LoadBalancer> LoadBalancer::CreateByMode(uint32_t mode) {
+    auto it = Registry().find(mode);
+    if (it == Registry().end()) return NULL;
+    return it->second.factory();
+}
+
+/*-----------------DRILL-----------------*/
+NS_OBJECT_ENSURE_REGISTERED(DrillLoadBalancer);
+
+TypeId DrillLoadBalancer::GetTypeId(void) {
+    static TypeId tid = TypeId("ns3::DrillLoadBalancer")
+                            .SetParent<LoadBalancer>()
+                            .AddConstructor<DrillLoadBalancer>();
+    return tid;
+}
+
+DrillLoadBalancer::DrillLoadBalancer() : m_candidates(2) {}
+
+uint32_t DrillLoadBalancer::CalculateInterfaceLoad(uint32_t interface) {
+    Ptr<QbbNetDevice> device = DynamicCast<QbbNetDevice>(m_node->GetDevice(interface));
+    NS_ASSERT_MSG(!!device && !!device->GetQueue(),
+                  "Error of getting a egress queue for calculating interface load");
+    return device->GetQueue()->GetOccupancy();  // also used in HPCC
+}
+
+void DrillLoadBalancer::ReportMemory(MemoryAccounting::Report& report) {
+    report.Add("drill.best_port", m_previousBestInterfaceMap.size(),
+               MemoryAccounting::TreeBytes(m_previousBestInterfaceMap));
+}
+
+uint32_t DrillLoadBalancer::SelectPort(Ptr<Packet> p, CustomHeader& ch,
+                                       const std::vector<int>& nexthops) {
+    // find the Egress (output) link with the smallest local Egress Queue length
+    uint32_t leastLoadInterface = 0;
+    uint32_t leastLoad = std::numeric_limits<uint32_t>::max();
+    auto rand_nexthops = nexthops;
+    std::random_shuffle(rand_nexthops.begin(), rand_nexthops.end());
+
+    std::map<uint32_t, uint32_t>::iterator itr = m_previousBestInterfaceMap.find(ch.dip);
+    if (itr != m_previousBestInterfaceMap.end()) {
+        leastLoadInterface = itr->second;
+        leastLoad = CalculateInterfaceLoad(itr->second);
+    }
+
+    uint32_t sampleNum =
+        m_candidates < rand_nexthops.size() ? m_candidates : rand_nexthops.size();
+    for (uint32_t samplePort = 0; samplePort < sampleNum; samplePort++) {
+        uint32_t sampleLoad = CalculateInterfaceLoad(rand_nexthops[samplePort]);
+        if (sampleLoad < leastLoad) {
+            leastLoad = sampleLoad;
+            leastLoadInterface = rand_nexthops[samplePort];
+        }
+    }
+    m_previousBestInterfaceMap[ch.dip] = leastLoadInterface;
+    return leastLoadInterface;
+}
+
+}  // namespace ns3
@@ -0,0 +1,112 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CAVER-LB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "ns3/memory-accounting.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+
+namespace ns3 {
+
+void MemoryAccounting::Report::Add(const std::string& subsystem, uint64_t entries, uint64_t bytes) {
+    Usage& u = m_usage[subsystem];
+    u.entries += entries;
+    u.bytes += bytes;
+}
+
+uint64_t MemoryAccounting::Report::GetTotalBytes() const {
+    uint64_t total = 0;
+    for (auto& it : m_usage) total += it.second.bytes;
+    return total;
+}
+
+std::vector<MemoryAccounting::Probe>& MemoryAccounting::Probes() {
+    static std::vector<Probe> probes;
+    return probes;
+}
+
+uint32_t MemoryAccounting::Register(Probe probe) {
+    Probes().push_back(probe);
+    return Probes().size() - 1;
+}
+
+void MemoryAccounting::Unregister(uint32_t id) {
+    if (id < Probes().size()) Probes()[id] = Probe();
+}
+
+void MemoryAccounting::Collect(Report& report) {
+    for (Probe& probe : Probes()) {
+        if (!probe.IsNull()) probe(report);
+    }
+}
+
+uint64_t MemoryAccounting::GetRss() {
+    FILE* f = fopen("/proc/self/statm", "r");
+    if (f == NULL) return 0;
+    unsigned long size = 0, resident = 0;
+    int n = fscanf(f, "%lu %lu", &size, &resident);
+    fclose(f);
+    return n == 2 ? (uint64_t)resident * sysconf(_SC_PAGESIZE) : 0;
+}
+
+uint64_t MemoryAccounting::GetPeakRss() {
+    FILE* f = fopen("/proc/self/status", "r");
+    if (f == NULL) return 0;
+    char line[256];
+    unsigned long kb = 0;
+    while (fgets(line, sizeof(line), f) != NULL) {
+        if (sscanf(line, "VmHWM: %lu kB", &kb) == 1) break;
+    }
+    fclose(f);
+    return (uint64_t)kb * 1024;
+}
+
+void MemoryAccounting::WriteSample(FILE* fout, uint64_t nowNs, const Report& report, uint64_t rss) {
+    for (auto& it : report.GetUsage()) {
+        fprintf(fout, "%lu %s %lu %lu\n", nowNs, it.first.c_str(), it.second.entries, it.second.bytes);
+    }
+    fprintf(fout, "%lu rss 0 %lu\n", nowNs, rss);
+    fflush(fout);
+}
+
+void MemoryAccounting::WriteReport(FILE* fout, const Report& report, uint64_t rss) {
+    std::vector<std::pair<uint64_t, std::string> > order;
+    for (auto& it : report.GetUsage()) order.push_back(std::make_pair(it.second.bytes, it.first));
+    std::sort(order.rbegin(), order.rend());
+    uint64_t total = std::max<uint64_t>(report.GetTotalBytes(), 1);
+    fprintf(fout, "# %-32s %14s %16s %7s\n", "subsystem", "entries", "bytes", "share");
+    for (auto& it : order) {
+        const Usage& u = report.GetUsage().at(it.second);
+        fprintf(fout, "# %-32s %14lu %16lu %6.1f%%\n", it.second.c_str(), u.entries, u.bytes,
+                100.0 * u.bytes / total);
+    }
+    fprintf(fout, "# %-32s %14s %16lu\n", "accounted", "", report.GetTotalBytes());
+    fprintf(fout, "# %-32s %14s %16lu\n", "rss", "", rss);
+    fprintf(fout, "# %-32s %14s %16lu\n", "peak rss", "", GetPeakRss());
+}
+
+}  // namespace ns3
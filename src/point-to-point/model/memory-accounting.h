@@ -0,0 +1,100 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CAVER-LB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ns3/callback.h"
+
+namespace ns3 {
+
+/**
+ * @brief Memory accounting: per-subsystem entries/bytes of the big containers, and the RSS.
+ * 各模块为自己的主要容器注册一个探针（Register），探针把每个子系统（如 "rdma.qp"、
+ * "conweave.voq"、"settings.PacketId2FlowId"）的条目数和估算字节数加到 Report 里；
+ * 同名子系统在所有节点上累加。字节数按 libstdc++ 的节点布局估算（HashBytes/TreeBytes/
+ * VectorBytes，加上每次分配的 malloc 开销），指针指向的对象由探针自己加上。
+ * 采样时读 /proc/self/statm 得到进程 RSS；超过预算（MEM_BUDGET_MB）时写出按字节排序的
+ * 报告后退出，而不是等到被 OOM killer 杀掉。
+ */
+class MemoryAccounting {
+   public:
+    struct Usage {
+        uint64_t entries;
+        uint64_t bytes;
+    };
+    class Report {
+       public:
+        void Add(const std::string& subsystem, uint64_t entries, uint64_t bytes);
+        const std::map<std::string, Usage>& GetUsage() const { return m_usage; }
+        uint64_t GetTotalBytes() const;
+
+       private:
+        std::map<std::string, Usage> m_usage;
+    };
+    typedef Callback<void, Report&> Probe;
+
+    /* the probe must be unregistered before its object dies */
+    static uint32_t Register(Probe probe);
+    static void Unregister(uint32_t id);
+    /* runs every registered probe */
+    static void Collect(Report& report);
+
+    static uint64_t GetRss();      // resident bytes, 0 if unknown
+    static uint64_t GetPeakRss();  // VmHWM, 0 if unknown
+
+    /* one line per subsystem: "timeNs subsystem entries bytes", then "timeNs rss 0 bytes" */
+    static void WriteSample(FILE* fout, uint64_t nowNs, const Report& report, uint64_t rss);
+    /* subsystems by decreasing bytes, with the share of the accounted total ("# " lines) */
+    static void WriteReport(FILE* fout, const Report& report, uint64_t rss);
+
+    /* estimates of the heap bytes of a container (not counting the container object itself) */
+    enum : uint64_t { MALLOC_OVERHEAD = 16 };
+    template <typename M>
+    static uint64_t HashBytes(const M& m) {
+        return m.bucket_count() * sizeof(void*) +
+               m.size() * (sizeof(void*) + sizeof(typename M::value_type) + MALLOC_OVERHEAD);
+    }
+    template <typename M>
+    static uint64_t TreeBytes(const M& m) {
+        return m.size() * (32 + sizeof(typename M::value_type) + MALLOC_OVERHEAD);  // rb node
+    }
+    template <typename V>
+    static uint64_t VectorBytes(const V& v) {
+        return v.capacity() * sizeof(typename V::value_type);
+    }
+
+   private:
+    static std::vector<Probe>& Probes();  // id -> probe, null once unregistered
+};
+
+}  // namespace ns3
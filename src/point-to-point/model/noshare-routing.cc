@@ -40,6 +40,7 @@ namespace ns3 {
     NoshareRouting::NoshareRouting() {
         m_isToR = false;
         m_switch_id = (uint32_t)-1;
+        SetRandomSeed(std::random_device()());
 
         // set constants
         m_dreTime = Time(MicroSeconds(200));
@@ -60,18 +61,13 @@ namespace ns3 {
 
     TypeId NoshareRouting::GetTypeId(void) {
         static TypeId tid =
-            TypeId("ns3::NoshareRouting").SetParent<Object>().AddConstructor<NoshareRouting>();
+            TypeId("ns3::NoshareRouting").SetParent<LoadBalancer>().AddConstructor<NoshareRouting>();
 
         return tid;
     }
 
     uint32_t NoshareRouting::GetOutPortFromPath(const uint32_t& path, const uint32_t& hopCount) {
-        std::vector<uint8_t> bytes(4);
-        bytes[0] = (path >> 24) & 0xFF; // 获取高位字节
-        bytes[1] = (path >> 16) & 0xFF;
-        bytes[2] = (path >> 8) & 0xFF;
-        bytes[3] = path & 0xFF; // 获取低位字节
-        return bytes[hopCount];
+        return PathCodec::GetPort(path, hopCount);
     }
 
     // void CaverRouting::SetOutPortToPath(uint32_t& path, const uint32_t& hopCount,
@@ -87,13 +83,7 @@ namespace ns3 {
         m_switchSendToDevCallback(p, ch);
     }
 
-    void NoshareRouting::SetSwitchSendCallback(SwitchSendCallback switchSendCallback) {
-        m_switchSendCallback = switchSendCallback;
-    }
 
-    void NoshareRouting::SetSwitchSendToDevCallback(SwitchSendToDevCallback switchSendToDevCallback) {
-        m_switchSendToDevCallback = switchSendToDevCallback;
-    }
 
     void NoshareRouting::SetSwitchInfo(bool isToR, uint32_t switch_id) {
         m_isToR = isToR;
@@ -115,18 +105,27 @@ namespace ns3 {
         }
     }
 
+    void NoshareRouting::SetRandomSeed(uint32_t seed) {
+        m_randomSeed = seed;
+        m_rng.seed(seed);
+    }
+
     uint32_t NoshareRouting::UpdateLocalDre(Ptr<Packet> p, CustomHeader ch, uint32_t outPort) {
+        return AddLocalDre(outPort, p->GetSize());
+    }
+
+    uint32_t NoshareRouting::AddLocalDre(uint32_t outPort, uint32_t bytes) {
         if (useEWMA) {
             uint32_t X = m_DreMap[outPort];
             Time deltaT = Simulator::Now() - m_Port2UpdateTime[outPort];
             double decayFactor = std::max(0.0, (1.0 - deltaT / tau).GetDouble());
-            uint32_t newX = p->GetSize() + X * decayFactor;
+            uint32_t newX = bytes + X * decayFactor;
             m_Port2UpdateTime[outPort] = Simulator::Now();
             m_DreMap[outPort] = newX;
             return newX;
         } else {
             uint32_t X = m_DreMap[outPort];
-            uint32_t newX = X + p->GetSize();
+            uint32_t newX = X + bytes;
             // NS_LOG_FUNCTION("Old X" << X << "New X" << newX << "outPort" << outPort << "Switch" <<
             // m_switch_id << Simulator::Now());
             m_DreMap[outPort] = newX;
@@ -169,13 +168,53 @@ namespace ns3 {
         }
         return quantX;
     }
-    std::vector<uint8_t> NoshareRouting::uint32_to_uint8(uint32_t number) {
-        std::vector<uint8_t> bytes(4);
-        bytes[0] = (number >> 24) & 0xFF; // 获取高位字节
-        bytes[1] = (number >> 16) & 0xFF;
-        bytes[2] = (number >> 8) & 0xFF;
-        bytes[3] = number & 0xFF; // 获取低位字节
-        return bytes;
+    PathCodec::Ports NoshareRouting::PathId2Ports(uint32_t pathId) { return PathCodec::GetPorts(pathId); }
+    bool NoshareRouting::Ingress(Ptr<Packet> p, CustomHeader& ch) {
+        RouteInput(p, ch);
+        return true;
+    }
+    // 按路由表（ECMP）转发的UDP包也要计入本地Dre
+    void NoshareRouting::OnRouted(Ptr<Packet> p, CustomHeader& ch, uint32_t outDev) {
+        if (ch.l3Prot != 0x11) return;
+        UpdateLocalDre(p, ch, outDev);
+        if (DreTable_log) {
+            if (m_isToR)
+                printf("Dre Table: ToR switch %d\n", m_switch_id);
+            else
+                printf("Dre Table: Mid switch %d\n", m_switch_id);
+            for (auto it = m_DreMap.begin(); it != m_DreMap.end(); ++it) {
+                uint32_t ce = it->second;
+                uint32_t localce = QuantizingX(it->first, ce);
+                std::cout << "Port: " << it->first << ", CE: " << it->second << ",localCE: " << localce << std::endl;
+            }
+        }
+    }
+    // 混合模式：流体背景流在出端口上的字节也计入本地Dre
+    void NoshareRouting::OnFluidTx(uint32_t outDev, uint64_t bytes) {
+        AddLocalDre(outDev, bytes);
+        if (!m_dreEvent.IsRunning() && !useEWMA) {
+            m_dreEvent = Simulator::Schedule(m_dreTime, &NoshareRouting::DreEvent, this);
+        }
+    }
+    void NoshareRouting::ReportMemory(MemoryAccounting::Report& report) {
+        const uint64_t o = MemoryAccounting::MALLOC_OVERHEAD;
+        uint64_t bytes = MemoryAccounting::TreeBytes(best_pathCE_Table) + MemoryAccounting::TreeBytes(acceptable_path_table);
+        for (auto& it : best_pathCE_Table) bytes += MemoryAccounting::VectorBytes(it.second._path) + o;
+        for (auto& it : acceptable_path_table) bytes += MemoryAccounting::VectorBytes(it.second._path) + o;
+        report.Add("noshare.best_path", best_pathCE_Table.size() + acceptable_path_table.size(), bytes);
+
+        uint64_t paths = 0;
+        bytes = MemoryAccounting::HashBytes(PathChoiceTable) + MemoryAccounting::HashBytes(PathChoiceFlagMap);
+        for (auto& it : PathChoiceTable) {
+            paths += it.second.size();
+            bytes += MemoryAccounting::VectorBytes(it.second) + o;
+            for (auto& pc : it.second) bytes += MemoryAccounting::VectorBytes(pc._path) + o;
+        }
+        report.Add("noshare.path_choice", paths, bytes);
+
+        // 表项是指针，Caver_Flowlet 对象另算
+        report.Add("noshare.flowlet", m_flowletTable.size(),
+                   MemoryAccounting::TreeBytes(m_flowletTable) + m_flowletTable.size() * (sizeof(Caver_Flowlet) + o));
     }
     void NoshareRouting::RouteInput(Ptr<Packet> p, CustomHeader ch){
         // Packet arrival time
@@ -456,6 +495,18 @@ namespace ns3 {
             if (m_isToR){
                 if (!found)// sender-side
                 {
+                    if (AckFeedbackSampler::Enabled()) {
+                        // an ACK without feedback coming from the fabric is not ours to tag
+                        auto sender = Settings::hostIp2IdMap.find(ch.sip);
+                        if (sender == Settings::hostIp2IdMap.end() || id2Port.find(sender->second) == id2Port.end()) {
+                            DoSwitchSendToDev(p, ch);
+                            return;
+                        }
+                    }
+                    if (!m_ackSampler.Sample(ch.dip, now.GetTimeStep())) {
+                        DoSwitchSendToDev(p, ch);  // sampled out: no feedback on this ACK
+                        return;
+                    }
                     uint32_t sid;
                     if(ToR_Rouding){
                         uint32_t choose_host_ip = Settings::TorSwitch_nodelist[m_switch_id][host_round_index];
@@ -476,6 +527,7 @@ namespace ns3 {
                     ackTag.SetLastSwitchId(m_switch_id);
                     ackTag.SetHostId(sid);
                     p->AddPacketTag(ackTag);
+                    AckFeedbackSampler::CountHop(ackTag.GetSerializedSize());
 
                     if (ACK_log){
                         printf("ACK info: current: Src switch %d \n", m_switch_id);
@@ -546,12 +598,10 @@ namespace ns3 {
                     best_pathCE_Table[host_ip]._updateTime = now;
                     best_pathCE_Table[host_ip]._ce = remoteBestCE;
                     best_pathCE_Table[host_ip]._inPort = inPort;
-                    std::vector<uint8_t> path;
-                    path.push_back((uint8_t(inPort)));
-                    std::vector<uint8_t> fullpath = uint32_to_uint8(ackTag.GetBestPathId());
-                    for (int i = 0; i < ackTag.GetLength(); i++) {
-                        path.push_back(fullpath [i]);
-                    }  
+                    PathCodec::Ports path;
+                    path.push_back((uint16_t(inPort)));
+                    PathCodec::Ports fullpath = PathId2Ports(ackTag.GetBestPathId());
+                    path.insert(path.end(), fullpath.begin(), fullpath.end());
                     best_pathCE_Table[host_ip]._path = path;
                 }
                 if(BestTable_log){
@@ -583,12 +633,10 @@ namespace ns3 {
                 uint32_t flag = PathChoiceFlagMap[host_ip];
                 PathChoiceInfo newPathChoice;
                 if (M_is_usable){
-                    std::vector<uint8_t> path;
-                    path.push_back((uint8_t(inPort)));
-                    std::vector<uint8_t> fullpath = uint32_to_uint8(ackTag.GetMPathId());
-                    for (int i = 0; i < ackTag.GetLength(); i++) {
-                        path.push_back(fullpath [i]);
-                    }  
+                    PathCodec::Ports path;
+                    path.push_back((uint16_t(inPort)));
+                    PathCodec::Ports fullpath = PathId2Ports(ackTag.GetMPathId());
+                    path.insert(path.end(), fullpath.begin(), fullpath.end());
                     newPathChoice._path = path;
                     newPathChoice._updateTime = now;
                     newPathChoice._is_used = false;
@@ -630,6 +678,7 @@ namespace ns3 {
                     printf("after update PathChoiceMapTable\n");
                     printPathChoiceFlagMap_Entry(host_ip);
                 }
+                AckFeedbackSampler::CountHop(0);  // feedback consumed here
                 p->RemovePacketTag(ackTag);
                 DoSwitchSendToDev(p, ch);
                 if(Packet_begin_end_flag){
@@ -639,6 +688,10 @@ namespace ns3 {
             }
             // Agg/Core switch
             // *******************************数据包携带的最优信息**********************//
+            if (!found && AckFeedbackSampler::Enabled()) {
+                DoSwitchSendToDev(p, ch);  // ACK sampled out at its source ToR
+                return;
+            }
             assert(found && "If not ToR (leaf), CaverTag should be found");
             uint32_t last_swtich = ackTag.GetLastSwitchId();
             uint32_t inPort = id2Port[last_swtich];
@@ -650,19 +703,15 @@ namespace ns3 {
             uint32_t totalGoodCE = std::max(localCE, remoteGoodCE);
             uint32_t host_id = ackTag.GetHostId();
             uint32_t host_ip = Settings::hostId2IpMap[host_id];
-            std::vector<uint8_t> new_best_path;
-                new_best_path.push_back((uint8_t(inPort)));
-                std::vector<uint8_t> fullpath = uint32_to_uint8(ackTag.GetBestPathId());
-                for (int i = 0; i < ackTag.GetLength(); i++) {
-                    new_best_path.push_back(fullpath [i]);
-            }  
+            PathCodec::Ports new_best_path;
+                new_best_path.push_back((uint16_t(inPort)));
+                PathCodec::Ports fullpath = PathId2Ports(ackTag.GetBestPathId());
+                new_best_path.insert(new_best_path.end(), fullpath.begin(), fullpath.end());
             ackTag.SetBestPathId(Vector2PathId(new_best_path));
-            std::vector<uint8_t> new_good_path;
-                new_good_path.push_back((uint8_t(inPort)));
-                std::vector<uint8_t> fullMpath = uint32_to_uint8(ackTag.GetMPathId());
-                for (int i = 0; i < ackTag.GetLength(); i++) {
-                    new_good_path.push_back(fullMpath [i]);
-            }  
+            PathCodec::Ports new_good_path;
+                new_good_path.push_back((uint16_t(inPort)));
+                PathCodec::Ports fullMpath = PathId2Ports(ackTag.GetMPathId());
+                new_good_path.insert(new_good_path.end(), fullMpath.begin(), fullMpath.end());
             ackTag.SetMPathId(Vector2PathId(new_good_path));
             // *******************************BestPathId的部分**********************//
             ackTag.SetBestCE(totalBestCE);
@@ -671,6 +720,7 @@ namespace ns3 {
             ackTag.SetLastSwitchId(m_switch_id);
             ackTag.SetHostId(host_id);
             p->AddPacketTag(ackTag);
+            AckFeedbackSampler::CountHop(ackTag.GetSerializedSize());
             if (ACK_log){
                 printf("Send ACK with CAVER Tag\n");
                 showCaverAck_info(ackTag, ch);
@@ -737,43 +787,10 @@ namespace ns3 {
         }
     }
 
-    uint32_t NoshareRouting::Vector2PathId(std::vector<uint8_t> vec) {
-        uint32_t result = 0; // 先将 port 存入结果中
-        result |= vec[0];
-
-        // 将 vector 中的元素逐个存入结果中
-        for (size_t i = 1; i < vec.size(); ++i) {
-            result <<= 8; // 左移 8 位，腾出一个字节的空间
-            result |= vec[i]; // 将 vector 中的元素放入结果中
-        }
-
-        // 如果 vector 的大小不足 4 个字节，补充 0
-        size_t remainingBytes = 4 - vec.size();
-        while (remainingBytes > 0) {
-            result <<= 8; // 左移 8 位
-            --remainingBytes;
-        }
-
-        return result;
-    }
+    uint32_t NoshareRouting::Vector2PathId(const PathCodec::Ports& vec) { return PathCodec::Intern(vec); }
     // *******************************Add end**********************//
-    uint32_t NoshareRouting::mergePortAndVector(uint8_t port, std::vector<uint8_t> vec) {
-        uint32_t result = port; // 先将 port 存入结果中
-
-        // 将 vector 中的元素逐个存入结果中
-        for (size_t i = 0; i < vec.size(); ++i) {
-            result <<= 8; // 左移 8 位，腾出一个字节的空间
-            result |= vec[i]; // 将 vector 中的元素放入结果中
-        }
-
-        // 如果 vector 的大小不足 4 个字节，补充 0
-        size_t remainingBytes = 3 - vec.size();
-        while (remainingBytes > 0) {
-            result <<= 8; // 左移 8 位
-            --remainingBytes;
-        }
-
-        return result;
+    uint32_t NoshareRouting::mergePortAndVector(uint32_t port, const PathCodec::Ports& vec) {
+        return PathCodec::Prepend(port, vec);
     }
     void NoshareRouting::SetConstants(Time dreTime, Time agingTime, Time flowletTimeout,
                                     uint32_t quantizeBit, double alpha, double ce_threshold, Time patchoiceTimeout, uint32_t pathChoice_num,
@@ -966,16 +983,12 @@ namespace ns3 {
         // ACK固有的信息
         printf("ACK of flow id: %d, Ack from host %d to host %d\n", flowid, ack_src_id, ack_dst_id);
         // ACK携带的信息
-        std::vector<uint8_t> fullMPath = uint32_to_uint8(ackTag.GetMPathId());
-        std::vector<uint8_t> showMPath;
-        for (int i = 0; i < ackTag.GetLength(); i++) {
-            showMPath.push_back(fullMPath[i]);
-        }
-        std::vector<uint8_t> fullBestPath = uint32_to_uint8(ackTag.GetBestPathId());
-        std::vector<uint8_t> showBestPath;
-        for (int i = 0; i < ackTag.GetLength(); i++) {
-            showBestPath.push_back(fullBestPath[i]);
-        }
+        PathCodec::Ports fullMPath = PathId2Ports(ackTag.GetMPathId());
+        PathCodec::Ports showMPath;
+        showMPath.insert(showMPath.end(), fullMPath.begin(), fullMPath.end());
+        PathCodec::Ports fullBestPath = PathId2Ports(ackTag.GetBestPathId());
+        PathCodec::Ports showBestPath;
+        showBestPath.insert(showBestPath.end(), fullBestPath.begin(), fullBestPath.end());
         std::cout << "m_last_switch_id" << ackTag.GetLastSwitchId() << std::endl;
         std::cout << "m_host_id: " << ackTag.GetHostId() << std::endl;
         std::cout << "m_length: " << static_cast<unsigned int>(ackTag.GetLength())<<std::endl;
@@ -1011,7 +1024,7 @@ namespace ns3 {
         std::cout << "SrcRoute: " << (rc.SrcRoute ? "true" : "false") << "\n";
         std::cout << "outPort: " << rc.outPort << "\n";
         if(rc.SrcRoute){
-            std::vector<uint8_t> Path = rc.pathVec;
+            PathCodec::Ports Path = rc.pathVec;
             std::cout << "path_id: ";
             for (int i = 0; i < Path.size(); i++) {
                 std::cout << static_cast<int>(Path[i]) << "->";
@@ -1023,8 +1036,8 @@ namespace ns3 {
         std::cout << "SrcRoute: " << (udpTag.GetSrcRouteEnable() == 1 ? "true" : "false") << "\n";
         std::cout << "hopCount: " << udpTag.GetHopCount() << "\n";
         std::cout << "pathId: " ;
-        std::vector<uint8_t> showpath = uint32_to_uint8(udpTag.GetPathId());
-        for (int i = 0; i < 4; i++) {
+        PathCodec::Ports showpath = PathId2Ports(udpTag.GetPathId());
+        for (int i = 0; i < showpath.size(); i++) {
             std::cout << static_cast<int>(showpath[i]) << "->";
         }
         std::cout << std::endl;
@@ -1045,21 +1058,21 @@ namespace ns3 {
             std::cout << "Port: " << outPort << ",global_localCE: " << localce << ",global_CE_store" << Settings::global_CE_map[{m_switch_id, neighbor_id}]<< std::endl;
         }
     }
-    void NoshareRouting::showPathVec(std::vector<uint8_t> path){
+    void NoshareRouting::showPathVec(PathCodec::Ports path){
         for (int i = 0; i < path.size(); i++) {
             std::cout << static_cast<int>(path[i]) << "->";
         }
         std::cout << std::endl;
     }
 
-    std::vector<uint32_t> NoshareRouting::getPathNodeIds(const std::vector<uint8_t>& pathVec, uint32_t currentNodeId) {
+    std::vector<uint32_t> NoshareRouting::getPathNodeIds(const PathCodec::Ports& pathVec, uint32_t currentNodeId) {
         std::vector<uint32_t> nodePath;
         uint32_t currentNode = currentNodeId;
 
         // 将当前节点加入路径
         nodePath.push_back(currentNode);
 
-        for (uint8_t outPortId : pathVec) {
+        for (uint16_t outPortId : pathVec) {
             // 检查当前节点是否存在于 m_nodeInterfaceMap 中
             assert(Settings::m_nodeInterfaceMap.find(currentNode) != Settings::m_nodeInterfaceMap.end() &&
                "Current node ID not found in m_nodeInterfaceMap.");
@@ -1124,13 +1137,11 @@ namespace ns3 {
             throw std::runtime_error("List is empty");
         }
 
-        // 使用随机数生成器
-        std::random_device rd;
-        std::mt19937 gen(rd());
+        // 使用本交换机的随机数生成器（SetRandomSeed）
         std::uniform_int_distribution<> dis(0, myList.size() - 1);
 
         // 生成一个随机索引
-        int randomIndex = dis(gen);
+        int randomIndex = dis(m_rng);
 
         // 迭代到随机索引位置
         auto it = myList.begin();
@@ -9,13 +9,17 @@
 #include <unordered_map>
 #include <vector>
 #include <list>
+#include <random>
 
+#include "ns3/ack-feedback-sampler.h"
 #include "ns3/address.h"
 #include "ns3/callback.h"
 #include "ns3/event-id.h"
+#include "ns3/load-balancer.h"
 #include "ns3/net-device.h"
 #include "ns3/object.h"
 #include "ns3/packet.h"
+#include "ns3/path-codec.h"
 #include "ns3/ptr.h"
 #include "ns3/settings.h"
 #include "ns3/simulator.h"
@@ -24,7 +28,7 @@
 
 namespace ns3 {
 
-class NoshareRouting : public Object {
+class NoshareRouting : public LoadBalancer {
 
     friend class SwitchMmu;
     friend class SwitchNode;
@@ -41,12 +45,17 @@ class NoshareRouting : public Object {
 
     /* main function */
     void RouteInput(Ptr<Packet> p, CustomHeader ch);
+    virtual bool Ingress(Ptr<Packet> p, CustomHeader& ch);  // takes every packet: RouteInput
+    virtual void OnRouted(Ptr<Packet> p, CustomHeader& ch, uint32_t outDev);  // local DRE of table-routed data
     uint32_t UpdateLocalDre(Ptr<Packet> p, CustomHeader ch, uint32_t outPort);
+    uint32_t AddLocalDre(uint32_t outPort, uint32_t bytes);
+    virtual void OnFluidTx(uint32_t outDev, uint64_t bytes);  // fluid bytes into the local DRE
+    virtual void ReportMemory(MemoryAccounting::Report& report);  // path tables, flowlet table
     uint32_t QuantizingX(uint32_t outPort, uint32_t X);  // X is bytes here and we quantizing it to 0 - 2^Q
     virtual void DoDispose();
-    uint32_t mergePortAndVector(uint8_t port, const std::vector<uint8_t> vec);
-    uint32_t Vector2PathId(std::vector<uint8_t> vec);
-    std::vector<uint8_t> uint32_to_uint8(uint32_t number);
+    uint32_t mergePortAndVector(uint32_t port, const PathCodec::Ports& vec);
+    uint32_t Vector2PathId(const PathCodec::Ports& vec);
+    PathCodec::Ports PathId2Ports(uint32_t pathId);
 
     std::map<uint32_t, uint32_t> id2Port;//维护一个交换机的邻居id到端口的id的映射
 
@@ -56,17 +65,15 @@ class NoshareRouting : public Object {
     void DoSwitchSend(Ptr<Packet> p, CustomHeader& ch, uint32_t outDev,
                       uint32_t qIndex);  // TxToR and Agg/CoreSw
     void DoSwitchSendToDev(Ptr<Packet> p, CustomHeader& ch);  // only at RxToR
-    typedef Callback<void, Ptr<Packet>, CustomHeader&, uint32_t, uint32_t> SwitchSendCallback;
-    typedef Callback<void, Ptr<Packet>, CustomHeader&> SwitchSendToDevCallback;
-    void SetSwitchSendCallback(SwitchSendCallback switchSendCallback);  // set callback
-    void SetSwitchSendToDevCallback(
-        SwitchSendToDevCallback switchSendToDevCallback);  // set callback
     /*-----------*/
 
     /* SET functions */
     void SetConstants(Time dreTime, Time agingTime, Time flowletTimeout, uint32_t quantizeBit, double alpha, double ce_threshold, Time patchoiceTimeout, uint32_t pathChoice_num, Time tau, bool useEWMA);
     void SetSwitchInfo(bool isToR, uint32_t switch_id);
     void SetLinkCapacity(uint32_t outPort, uint64_t bitRate);
+    /* seed of the choice among equally good paths (getRandomElement), drawn at construction */
+    void SetRandomSeed(uint32_t seed);
+    uint32_t GetRandomSeed(void) const { return m_randomSeed; }
 
     // periodic events
     EventId m_dreEvent;
@@ -98,12 +105,12 @@ class NoshareRouting : public Object {
     void showDreTable();
     void showglobalDreTable();
     void showPortCE(uint32_t port);
-    void showPathVec(std::vector<uint8_t>path);
+    void showPathVec(PathCodec::Ports path);
     void showOptimalvsCaver(CustomHeader ch, CaverRouteChoice caver);
     int getRandomElement(const std::list<int>& myList);
 
     //性能监控相关的函数
-    std::vector<uint32_t> getPathNodeIds(const std::vector<uint8_t>& pathVec, uint32_t currentNodeId);//将pathVec转化为nodeIdVec
+    std::vector<uint32_t> getPathNodeIds(const PathCodec::Ports& pathVec, uint32_t currentNodeId);//将pathVec转化为nodeIdVec
 
     //性能分析监控的log
     bool Dive_optimal_log = false;//每个流到来的时候计算最优路径的CE以及选择路径的CE值
@@ -129,12 +136,12 @@ class NoshareRouting : public Object {
     uint32_t m_pathChoice_num; //pathCHoiceTable每个目的地存放的路径数量
 
     private:
-        SwitchSendCallback m_switchSendCallback;  // bound to SwitchNode::SwitchSend (for Request/UDP)
-        SwitchSendToDevCallback m_switchSendToDevCallback;  // bound to SwitchNode::SendToDevContinue (for Probe, Reply)
 
         // topology parameters
         bool m_isToR;          // is ToR (leaf)
         uint32_t m_switch_id;  // switch's nodeID      
+        uint32_t m_randomSeed;
+        std::mt19937 m_rng;    // getRandomElement
 
         // dv constants  
         Time m_dreTime;          // dre alogrithm (e.g., 200us)
@@ -152,6 +159,7 @@ class NoshareRouting : public Object {
         std::map<uint32_t, uint32_t> m_DreMap;        // outPort -> DRE (at SrcToR)
         std::map<uint64_t, Caver_Flowlet*> m_flowletTable;  // QpKey -> Flowlet (at SrcToR)
 
+        AckFeedbackSampler m_ackSampler;  // ACK feedback sampling (at SrcToR)
         uint32_t host_round_index;
         uint32_t ToR_host_num;
 
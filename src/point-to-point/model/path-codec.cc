@@ -0,0 +1,132 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CAVER-LB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "ns3/path-codec.h"
+
+#include <deque>
+
+#include "ns3/assert.h"
+#include "ns3/fatal-error.h"
+
+namespace ns3 {
+
+std::vector<uint32_t> PathCodec::s_begin(2, 0);  // id 0: the empty path
+std::vector<uint16_t> PathCodec::s_ports;
+std::unordered_map<std::u16string, uint32_t> PathCodec::s_index{{std::u16string(), 0}};
+bool PathCodec::s_frozen = false;
+
+uint32_t PathCodec::Intern(const Ports& ports) {
+    std::u16string key(ports.begin(), ports.end());
+    auto it = s_index.find(key);
+    if (it != s_index.end()) return it->second;
+    if (s_frozen) {
+        NS_FATAL_ERROR("path of " << ports.size() << " hops was not interned at setup, its id would differ between MPI ranks");
+    }
+    uint32_t id = GetNumPaths();
+    s_ports.insert(s_ports.end(), ports.begin(), ports.end());
+    s_begin.push_back(s_ports.size());
+    s_index.emplace(std::move(key), id);
+    return id;
+}
+
+uint32_t PathCodec::Prepend(uint32_t port, const Ports& rest) {
+    Ports ports;
+    ports.reserve(rest.size() + 1);
+    ports.push_back(port);
+    ports.insert(ports.end(), rest.begin(), rest.end());
+    return Intern(ports);
+}
+
+void PathCodec::AddSuffixes() {
+    uint32_t nPaths = GetNumPaths();  // the suffixes added here have their suffixes already
+    for (uint32_t id = 1; id < nPaths; id++) {
+        Ports ports = GetPorts(id);
+        for (uint32_t i = 1; i < ports.size(); i++) {
+            Intern(Ports(ports.begin() + i, ports.end()));
+        }
+    }
+}
+
+PathCodec::Ports PathCodec::GetPorts(uint32_t pathId) {
+    NS_ASSERT_MSG(pathId < GetNumPaths(), "unknown path id " << pathId);
+    return Ports(s_ports.begin() + s_begin[pathId], s_ports.begin() + s_begin[pathId + 1]);
+}
+
+void PathSetBuilder::AddSwitch(uint32_t id, bool isToR) {
+    if (id >= m_links.size()) {
+        m_links.resize(id + 1);
+        m_isToR.resize(id + 1, false);
+    }
+    m_isToR[id] = isToR;
+}
+
+void PathSetBuilder::AddLink(uint32_t from, uint32_t to, uint32_t port) {
+    NS_ASSERT_MSG(from < m_links.size() && to < m_links.size(), "AddSwitch() both ends first");
+    NS_ASSERT_MSG(port <= 0xffff, "port " << port << " does not fit in a path");
+    std::vector<Link>& links = m_links[from];
+    auto it = links.begin();  // kept in port order so that path ids do not depend on the caller
+    while (it != links.end() && it->port < port) ++it;
+    links.insert(it, Link{to, port});
+}
+
+std::vector<uint32_t> PathSetBuilder::Build(uint32_t srcToR, uint32_t dstToR) {
+    // BFS from dstToR (links are bidirectional), never through another ToR
+    m_dist.assign(m_links.size(), UINT32_MAX);
+    m_dist[dstToR] = 0;
+    std::deque<uint32_t> q(1, dstToR);
+    while (!q.empty()) {
+        uint32_t u = q.front();
+        q.pop_front();
+        if (u != dstToR && m_isToR[u]) continue;
+        for (const Link& l : m_links[u]) {
+            if (m_dist[l.peer] != UINT32_MAX) continue;
+            m_dist[l.peer] = m_dist[u] + 1;
+            q.push_back(l.peer);
+        }
+    }
+    std::vector<uint32_t> out;
+    if (m_dist[srcToR] == UINT32_MAX) return out;
+    PathCodec::Ports ports;
+    Expand(srcToR, dstToR, ports, out);
+    return out;
+}
+
+void PathSetBuilder::Expand(uint32_t node, uint32_t dstToR, PathCodec::Ports& ports,
+                            std::vector<uint32_t>& out) {
+    if (node == dstToR) {
+        out.push_back(PathCodec::Intern(ports));
+        return;
+    }
+    for (const Link& l : m_links[node]) {
+        if (m_dist[l.peer] + 1 != m_dist[node]) continue;
+        if (l.peer != dstToR && m_isToR[l.peer]) continue;
+        ports.push_back(l.port);
+        Expand(l.peer, dstToR, ports, out);
+        ports.pop_back();
+    }
+}
+
+}  // namespace ns3
@@ -0,0 +1,97 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CAVER-LB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdint.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * @brief Variable-length source routes shared by all LB modules and their tags.
+ * 路径 = 从源 ToR 起每一跳的出端口序列（uint16_t 端口，不限跳数）。
+ * 所有路径在进程内全局去重，用稠密的 32 位 PathId 表示：tag 里仍只带 4 字节，
+ * 逐跳取端口是两次数组下标。PathId 0 永远是空路径。
+ * 取代原先把最多 4 个 8 位端口塞进 uint32_t 的编码（4 跳 / 255 端口上限）。
+ */
+class PathCodec {
+   public:
+    typedef std::vector<uint16_t> Ports;
+    enum : uint32_t { EMPTY = 0 };
+
+    static uint32_t Intern(const Ports& ports);                 // id of the path (new id if unseen)
+    static uint32_t Prepend(uint32_t port, const Ports& rest);  // id of [port] + rest
+    static Ports GetPorts(uint32_t pathId);
+    static uint32_t GetLength(uint32_t pathId) { return s_begin[pathId + 1] - s_begin[pathId]; }
+    /* out port at the hop-th switch of the path, 0 beyond its end */
+    static uint32_t GetPort(uint32_t pathId, uint32_t hop) {
+        uint32_t i = s_begin[pathId] + hop;
+        return i < s_begin[pathId + 1] ? s_ports[i] : 0;
+    }
+    static uint32_t GetNumPaths() { return s_begin.size() - 1; }
+
+    /* MPI: ids are per process, so all ranks intern the same paths in the same order at setup.
+     * 运行时 CAVER/DV 在 ACK 上逐跳 Prepend 出的路径都是 ToR 间路径的后缀，
+     * AddSuffixes() 预先登记它们；Freeze() 之后再出现新路径直接报错，而不是在各 rank
+     * 上得到不同的 id。 */
+    static void AddSuffixes();
+    static void Freeze() { s_frozen = true; }
+
+   private:
+    static std::vector<uint32_t> s_begin;  // pathId -> first port in s_ports (size = #paths + 1)
+    static std::vector<uint16_t> s_ports;
+    static std::unordered_map<std::u16string, uint32_t> s_index;
+    static bool s_frozen;
+};
+
+/**
+ * @brief Enumerates the shortest paths between ToR pairs over the switch graph.
+ * 每个 (源 ToR, 目的 ToR) 只算一次：从目的 ToR 反向 BFS 得到距离，再沿距离递减的
+ * 邻居 DFS 展开所有最短路径（其他 ToR 不作为中转）。结果是 PathCodec 的 PathId。
+ */
+class PathSetBuilder {
+   public:
+    void AddSwitch(uint32_t id, bool isToR);
+    void AddLink(uint32_t from, uint32_t to, uint32_t port);  // port of `from` towards `to`
+    std::vector<uint32_t> Build(uint32_t srcToR, uint32_t dstToR);
+
+   private:
+    struct Link {
+        uint32_t peer;
+        uint32_t port;
+    };
+    void Expand(uint32_t node, uint32_t dstToR, PathCodec::Ports& ports, std::vector<uint32_t>& out);
+
+    std::vector<std::vector<Link> > m_links;  // switch id -> links to other switches
+    std::vector<bool> m_isToR;
+    std::vector<uint32_t> m_dist;  // hops to the current dstToR
+};
+
+}  // namespace ns3
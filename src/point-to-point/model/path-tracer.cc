@@ -0,0 +1,102 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CAVER-LB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "ns3/path-tracer.h"
+
+#include <stdio.h>
+
+#include "ns3/assert.h"
+
+namespace ns3 {
+
+bool PathTracer::enabled = false;
+std::vector<PathTracer::SwitchTrace> PathTracer::m_switches;
+std::vector<uint32_t> PathTracer::m_flowlet;
+
+void PathTracer::AddSwitch(uint32_t node, const std::vector<uint32_t>& peerOfPort) {
+    if (m_switches.size() <= node) m_switches.resize(node + 1);
+    NS_ASSERT_MSG(peerOfPort.size() <= 0x10000, "PathTracer stores ports as u16");
+    m_switches[node].registered = true;
+    m_switches[node].peerOfPort = peerOfPort;
+}
+
+void PathTracer::OnForward(uint32_t node, int32_t flow, uint32_t port, bool sourceToR,
+                           uint64_t nowNs) {
+    if (flow < 0 || node >= m_switches.size() || !m_switches[node].registered) return;
+    SwitchTrace& sw = m_switches[node];
+    auto it = sw.lastPort.find(flow);
+    bool first = (it == sw.lastPort.end());
+    if (!first && it->second == port) return;  // same path: nothing to record
+
+    if ((uint32_t)flow >= m_flowlet.size()) m_flowlet.resize(flow + 1, 0);
+    if (sourceToR && !first) m_flowlet[flow]++;  // a new flowlet leaves the source ToR
+    if (first) {
+        sw.lastPort.emplace(flow, port);
+    } else {
+        it->second = port;
+    }
+    sw.flow.push_back(flow);
+    sw.flowlet.push_back(m_flowlet[flow]);
+    sw.port.push_back(port);
+    sw.timeNs.push_back(nowNs);
+}
+
+uint64_t PathTracer::GetNumRecords() {
+    uint64_t n = 0;
+    for (auto& sw : m_switches) n += sw.flow.size();
+    return n;
+}
+
+bool PathTracer::Write(const char* filename) {
+    FILE* fout = fopen(filename, "wb");
+    if (fout == NULL) {
+        return false;
+    }
+    const uint32_t version = 1;
+    uint32_t nSwitches = 0;
+    for (auto& sw : m_switches) nSwitches += sw.registered;
+    fwrite("PTRC", 1, 4, fout);
+    fwrite(&version, sizeof(version), 1, fout);
+    fwrite(&nSwitches, sizeof(nSwitches), 1, fout);
+    for (uint32_t node = 0; node < m_switches.size(); node++) {
+        SwitchTrace& sw = m_switches[node];
+        if (!sw.registered) continue;
+        uint32_t nPorts = sw.peerOfPort.size();
+        uint64_t n = sw.flow.size();
+        fwrite(&node, sizeof(node), 1, fout);
+        fwrite(&nPorts, sizeof(nPorts), 1, fout);
+        fwrite(sw.peerOfPort.data(), sizeof(uint32_t), nPorts, fout);
+        fwrite(&n, sizeof(n), 1, fout);
+        fwrite(sw.flow.data(), sizeof(uint32_t), n, fout);
+        fwrite(sw.flowlet.data(), sizeof(uint32_t), n, fout);
+        fwrite(sw.port.data(), sizeof(uint16_t), n, fout);
+        fwrite(sw.timeNs.data(), sizeof(uint64_t), n, fout);
+    }
+    fclose(fout);
+    return true;
+}
+
+}  // namespace ns3
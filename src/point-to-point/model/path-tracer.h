@@ -0,0 +1,85 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CAVER-LB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdint.h>
+
+#include <unordered_map>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * @brief Per-flow path tracer (replaces RouteLogger and Settings::record_flow_distribution).
+ * 每个交换机记住每条流上一次的出端口，只有出端口变化（含第一次经过）时才追加一条记录
+ * (flow, flowlet, port, timeNs)，按列存放在该交换机的内存缓冲里。
+ * flowlet 序号在流的源 ToR 上计数：源 ToR 出端口每变化一次加一，其他交换机的记录沿用当前序号。
+ * 端口到邻居节点的映射一并写出，读取端（analysis/path_trace_reader.py）从源 ToR 沿
+ * 各交换机的最新出端口走一遍即可还原任意时刻、任意 flowlet 的完整路径。
+ * 仿真结束时一次性写出二进制文件。未启用时每个包只多一次分支判断。
+ */
+class PathTracer {
+   public:
+    static bool enabled;
+
+    /* register switch `node`; peerOfPort[port] is the node id behind that port */
+    static void AddSwitch(uint32_t node, const std::vector<uint32_t>& peerOfPort);
+    /**
+     * @brief one data packet of `flow` leaving switch `node` through `port`.
+     * sourceToR: `node` is the ToR of the flow's sender
+     */
+    static void OnForward(uint32_t node, int32_t flow, uint32_t port, bool sourceToR,
+                          uint64_t nowNs);
+
+    /**
+     * @brief binary trace:
+     *   char magic[4] = "PTRC", u32 version = 1, u32 nSwitches
+     *   nSwitches x { u32 node, u32 nPorts, u32 peer[nPorts], u64 n,
+     *                 u32 flow[n], u32 flowlet[n], u16 port[n], u64 timeNs[n] }
+     */
+    static bool Write(const char* filename);
+
+    static uint64_t GetNumRecords();
+    static uint32_t GetNumFlows() { return m_flowlet.size(); }
+
+   private:
+    struct SwitchTrace {
+        bool registered = false;
+        std::vector<uint32_t> peerOfPort;
+        std::unordered_map<int32_t, uint16_t> lastPort;  // flow -> egress port
+        // columns
+        std::vector<uint32_t> flow;
+        std::vector<uint32_t> flowlet;
+        std::vector<uint16_t> port;
+        std::vector<uint64_t> timeNs;
+    };
+
+    static std::vector<SwitchTrace> m_switches;  // by node id
+    static std::vector<uint32_t> m_flowlet;      // by flow id: current flowlet index
+};
+
+}  // namespace ns3
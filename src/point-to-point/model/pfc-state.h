@@ -0,0 +1,86 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CAVER-LB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+/**
+ * @brief PAUSE state of one egress port, per priority.
+ * 出队路径只需要检查一个 bitmap；每个优先级记录当前 PAUSE 的开始时间和累计
+ * PAUSE 时长。流级别的 PAUSE 时间不再在每次出队时查 tag / 哈希表，而是在流
+ * 开始和结束时各取一次 GetPausedTime(pg)，二者之差即为该流所在优先级在这段
+ * 时间内被 PAUSE 的总时长。
+ */
+class PfcPortState {
+   public:
+    enum : uint32_t { MAX_PRIO = 8 };
+
+    PfcPortState() : m_pausedMask(0) {
+        for (uint32_t i = 0; i < MAX_PRIO; i++) {
+            m_nPause[i] = 0;
+        }
+    }
+
+    uint32_t GetPausedMask() const { return m_pausedMask; }
+    bool IsPaused(uint32_t q) const { return (m_pausedMask >> q) & 1; }
+
+    /** @brief mark q paused; a refresh of an ongoing PAUSE keeps the original start */
+    void Pause(uint32_t q, Time now) {
+        if (!IsPaused(q)) {
+            m_pausedMask |= 1u << q;
+            m_pauseStart[q] = now;
+            m_nPause[q]++;
+        }
+    }
+    void Resume(uint32_t q, Time now) {
+        if (IsPaused(q)) {
+            m_pausedMask &= ~(1u << q);
+            m_pausedTotal[q] += now - m_pauseStart[q];
+        }
+    }
+    /* resume all priorities without accounting (link down) */
+    void Clear() { m_pausedMask = 0; }
+
+    /** @brief total time q has been paused up to now (including an ongoing PAUSE) */
+    Time GetPausedTime(uint32_t q, Time now) const {
+        return IsPaused(q) ? m_pausedTotal[q] + (now - m_pauseStart[q]) : m_pausedTotal[q];
+    }
+    uint64_t GetNumPause(uint32_t q) const { return m_nPause[q]; }
+    /** @brief start of the ongoing PAUSE of q (refreshes keep it), only valid while IsPaused(q) */
+    Time GetPauseStart(uint32_t q) const { return m_pauseStart[q]; }
+
+   private:
+    uint32_t m_pausedMask;
+    Time m_pauseStart[MAX_PRIO];
+    Time m_pausedTotal[MAX_PRIO];
+    uint64_t m_nPause[MAX_PRIO];
+};
+
+}  // namespace ns3
@@ -0,0 +1,111 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CAVER-LB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "ns3/pfc-tracer.h"
+
+#include <algorithm>
+#include <set>
+
+namespace ns3 {
+
+bool PfcTracer::enabled = false;
+std::vector<PfcTracer::Event> PfcTracer::m_events;
+std::unordered_map<uint64_t, uint32_t> PfcTracer::m_active;
+std::unordered_map<uint32_t, std::vector<uint32_t> > PfcTracer::m_activeByNode;
+
+void PfcTracer::OnPauseSent(uint64_t nowNs, uint32_t node, uint32_t port, uint32_t peer,
+                            uint32_t peerPort, uint32_t qIndex) {
+    uint64_t key = Key(peer, peerPort, qIndex);
+    auto it = m_active.find(key);
+    if (it != m_active.end()) {  // refresh of an ongoing PAUSE
+        m_events[it->second].refreshes++;
+        return;
+    }
+
+    // parent: the latest still-active PAUSE of the sender at the same priority
+    uint32_t parent = NONE;
+    auto byNode = m_activeByNode.find(node);
+    if (byNode != m_activeByNode.end()) {
+        for (auto id : byNode->second) {
+            if (m_events[id].qIndex != qIndex) continue;
+            if (parent == NONE || m_events[id].startNs >= m_events[parent].startNs) parent = id;
+        }
+    }
+
+    Event e;
+    e.parent = parent;
+    e.depth = (parent == NONE) ? 0 : m_events[parent].depth + 1;
+    e.startNs = nowNs;
+    e.endNs = 0;
+    e.node = node;
+    e.port = port;
+    e.peer = peer;
+    e.peerPort = peerPort;
+    e.qIndex = qIndex;
+    e.refreshes = 0;
+    uint32_t id = m_events.size();
+    m_events.push_back(e);
+    m_active[key] = id;
+    m_activeByNode[peer].push_back(id);
+}
+
+void PfcTracer::OnResume(uint64_t nowNs, uint32_t node, uint32_t port, uint32_t qIndex) {
+    auto it = m_active.find(Key(node, port, qIndex));
+    if (it == m_active.end()) return;
+    uint32_t id = it->second;
+    m_events[id].endNs = nowNs;
+    m_active.erase(it);
+    auto& v = m_activeByNode[node];
+    v.erase(std::find(v.begin(), v.end(), id));
+}
+
+void PfcTracer::Write(FILE* fout) {
+    for (uint32_t id = 0; id < m_events.size(); id++) {
+        const Event& e = m_events[id];
+        fprintf(fout, "EVENT %u %d %u %lu %lu %u %u %u %u %u %u\n", id,
+                e.parent == NONE ? -1 : (int)e.parent, e.depth, e.startNs, e.endNs, e.node, e.port,
+                e.peer, e.peerPort, e.qIndex, e.refreshes);
+    }
+
+    // events are created in time order, so a parent always precedes its children
+    std::vector<uint32_t> root(m_events.size());
+    for (uint32_t id = 0; id < m_events.size(); id++) {
+        root[id] = (m_events[id].parent == NONE) ? id : root[m_events[id].parent];
+    }
+    std::vector<uint32_t> size(m_events.size(), 0), maxDepth(m_events.size(), 0);
+    std::vector<std::set<uint32_t> > nodes(m_events.size());
+    for (uint32_t id = 0; id < m_events.size(); id++) {
+        uint32_t r = root[id];
+        size[r]++;
+        maxDepth[r] = std::max(maxDepth[r], m_events[id].depth);
+        nodes[r].insert(m_events[id].peer);
+    }
+    for (uint32_t id = 0; id < m_events.size(); id++) {
+        if (m_events[id].parent != NONE) continue;
+        fprintf(fout, "TREE %u %u %u %u\n", id, size[id], maxDepth[id], (uint32_t)nodes[id].size());
+    }
+}
+
+}  // namespace ns3
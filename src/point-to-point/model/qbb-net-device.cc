@@ -42,6 +42,7 @@
 #include "ns3/log.h"
 #include "ns3/object-vector.h"
 #include "ns3/pause-header.h"
+#include "ns3/pfc-tracer.h"
 #include "ns3/point-to-point-channel.h"
 #include "ns3/pointer.h"
 #include "ns3/ppp-header.h"
@@ -56,14 +57,10 @@
 #include "ns3/uinteger.h"
 #include "ns3/hula-header.h"
 
-#define MAP_KEY_EXISTS(map, key) (((map).find(key) != (map).end()))
-
 NS_LOG_COMPONENT_DEFINE("QbbNetDevice");
 
 namespace ns3 {
 
-extern std::unordered_map<unsigned, Time> acc_pause_time;
-
 // uint32_t RdmaEgressQueue::ack_q_idx = 3; // 3: Middle priority
 uint32_t RdmaEgressQueue::ack_q_idx = 0; // 0: high priority
 // RdmaEgressQueue
@@ -103,17 +100,17 @@ Ptr<Packet> RdmaEgressQueue::DequeueQindex(int qIndex) {
     }
     return 0;
 }
-int RdmaEgressQueue::GetNextQindex(bool paused[]) {
+int RdmaEgressQueue::GetNextQindex(uint32_t pausedMask) {
     bool found = false;
     uint32_t qIndex;
-    if (!paused[ack_q_idx] && m_ackQ->GetNPackets() > 0) return -1;
+    if (!((pausedMask >> ack_q_idx) & 1) && m_ackQ->GetNPackets() > 0) return -1;
 
     // no pkt in highest priority queue, do rr for each qp
     uint32_t fcount = m_qpGrp->GetN();
     for (qIndex = 1; qIndex <= fcount; qIndex++) {
         if (m_qpGrp->IsQpFinished((qIndex + m_rrlast) % fcount)) continue;
         Ptr<RdmaQueuePair> qp = m_qpGrp->Get((qIndex + m_rrlast) % fcount);
-        bool cond1 = !paused[qp->m_pg];
+        bool cond1 = !((pausedMask >> qp->m_pg) & 1);
         bool cond_window_allowed =
             (!qp->IsWinBound() && (!qp->irn.m_enabled || qp->CanIrnTransmit(m_mtu)));
         bool cond2 = (qp->GetBytesLeft() > 0 && cond_window_allowed);
@@ -123,31 +120,9 @@ int RdmaEgressQueue::GetNextQindex(bool paused[]) {
                 m_qpGrp->SetQpFinished((qIndex + m_rrlast) % fcount);
             }
         }
-        if (!cond1 && cond2) {
-            if (m_qpGrp->Get((qIndex + m_rrlast) % fcount)->m_nextAvail.GetTimeStep() >
-                Simulator::Now().GetTimeStep()) {
-                // not available now
-            } else {
-                // blocked by PFC
-                int32_t flowid = m_qpGrp->Get((qIndex + m_rrlast) % fcount)->m_flow_id;
-                if (!MAP_KEY_EXISTS(current_pause_time, flowid))
-                    current_pause_time[flowid] = Simulator::Now();
-            }
-        } else if (cond1 && cond2) {
-            if (m_qpGrp->Get((qIndex + m_rrlast) % fcount)->m_nextAvail.GetTimeStep() >
-                Simulator::Now().GetTimeStep())  // not available now
+        if (cond1 && cond2) {
+            if (qp->m_nextAvail.GetTimeStep() > Simulator::Now().GetTimeStep())  // not available now
                 continue;
-            // Check if the flow has been blocked by PFC
-            {
-                int32_t flowid = m_qpGrp->Get((qIndex + m_rrlast) % fcount)->m_flow_id;
-                if (MAP_KEY_EXISTS(current_pause_time, flowid)) {
-                    Time tdiff = Simulator::Now() - current_pause_time[flowid];
-                    if (!MAP_KEY_EXISTS(acc_pause_time, flowid))
-                        acc_pause_time[flowid] = Seconds(0);
-                    acc_pause_time[flowid] = acc_pause_time[flowid] + tdiff;
-                    current_pause_time.erase(flowid);
-                }
-            }
             return (qIndex + m_rrlast) % fcount;
         }
     }
@@ -228,9 +203,7 @@ TypeId QbbNetDevice::GetTypeId(void) {
 QbbNetDevice::QbbNetDevice() {
     NS_LOG_FUNCTION(this);
     m_ecn_source = new std::vector<ECNAccount>;
-    for (uint32_t i = 0; i < qCnt; i++) {
-        m_paused[i] = false;
-    }
+    m_fluidBps = 0;
 
     m_rdmaEQ = CreateObject<RdmaEgressQueue>();
 }
@@ -259,13 +232,8 @@ void QbbNetDevice::DequeueAndTransmit(void) {
     if (!m_linkUp) return;                 // if link is down, return
     if (m_txMachineState == BUSY) return;  // Quit if channel busy
     Ptr<Packet> p;
-    for (int i = 0; i < qCnt; ++i) {
-        if (m_paused[i]) {
-            //std::cout << "node: " << m_node->GetId() << ",端口paused:" << i << ",at" << Simulator::Now() <<std::endl;
-        }
-    }
     if (m_node->GetNodeType() == 0) {  // server
-        int qIndex = m_rdmaEQ->GetNextQindex(m_paused);
+        int qIndex = m_rdmaEQ->GetNextQindex(m_pfc.GetPausedMask());
         if (qIndex != -1024) {
             if (qIndex == -1) {  // high prio
                 p = m_rdmaEQ->DequeueQindex(qIndex);
@@ -279,7 +247,7 @@ void QbbNetDevice::DequeueAndTransmit(void) {
 
             // transmit
             m_traceQpDequeue(p, lastQp);
-            TransmitStart(p);
+            TransmitStart(p, true);
 
             // update for the next avail time
             m_rdmaPktSent(lastQp, p, m_tInterframeGap);
@@ -302,15 +270,10 @@ void QbbNetDevice::DequeueAndTransmit(void) {
         return;
     } else {                               // switch, doesn't care about qcn, just send
         // std::cout << "switch id" << m_node->GetId() << ",m_queue:" << m_queue->GetNBytesTotal()<<", at" << Simulator::Now() << std::endl;
-        p = m_queue->DequeueRR(m_paused);  // this is round-robin
+        p = m_queue->DequeueRR(m_pfc.GetPausedMask());  // this is round-robin
         if (p != 0) {
             m_snifferTrace(p);
             m_promiscSnifferTrace(p);
-            Ipv4Header h;
-            Ptr<Packet> packet = p->Copy();
-            uint16_t protocol = 0;
-            ProcessHeader(packet, protocol);
-            packet->RemoveHeader(h);
             FlowIdTag t;
             uint32_t qIndex = m_queue->GetLastQueue();
             if (qIndex == 0) {  // this is a pause or cnp, send it immediately!
@@ -321,7 +284,7 @@ void QbbNetDevice::DequeueAndTransmit(void) {
                 p->RemovePacketTag(t);
             }
             m_traceDequeue(p, qIndex);
-            TransmitStart(p);
+            TransmitStart(p, qIndex != 0);
             return;
         } else {  // No queue can deliver any packet
             // NS_LOG_INFO("PAUSE prohibits send at node " << m_node->GetId());
@@ -349,8 +312,10 @@ void QbbNetDevice::DequeueAndTransmit(void) {
 
 void QbbNetDevice::Resume(unsigned qIndex) {
     NS_LOG_FUNCTION(this << qIndex);
-    NS_ASSERT_MSG(m_paused[qIndex], "Must be PAUSEd");
-    m_paused[qIndex] = false;
+    NS_ASSERT_MSG(m_pfc.IsPaused(qIndex), "Must be PAUSEd");
+    m_pfc.Resume(qIndex, Simulator::Now());
+    if (PfcTracer::enabled)
+        PfcTracer::OnResume(Simulator::Now().GetTimeStep(), m_node->GetId(), m_ifIndex, qIndex);
     NS_LOG_INFO("Node " << m_node->GetId() << " dev " << m_ifIndex << " queue " << qIndex
                         << " resumed at " << Simulator::Now().GetSeconds());
     DequeueAndTransmit();
@@ -383,7 +348,7 @@ void QbbNetDevice::Receive(Ptr<Packet> packet) {
         unsigned qIndex = ch.pfc.qIndex;
         if (ch.pfc.time > 0) {
             m_tracePfc(1);
-            m_paused[qIndex] = true;
+            m_pfc.Pause(qIndex, Simulator::Now());
             Simulator::Cancel(m_resumeEvt[qIndex]);
             m_resumeEvt[qIndex] =
                 Simulator::Schedule(MicroSeconds(ch.pfc.time), &QbbNetDevice::Resume, this, qIndex);
@@ -424,8 +389,33 @@ bool QbbNetDevice::SwitchSend(uint32_t qIndex, Ptr<Packet> packet, CustomHeader
 uint32_t QbbNetDevice::SendPfc(uint32_t qIndex, uint32_t type) {
     //std::cout << "SendPfc" << std::endl;
     if (!m_qbbEnabled) return 0;
+    uint32_t time = (type == 0 ? m_pausetime : 0);
+    Ptr<Packet> p = AllocPfcFrame();
+    CustomHeader::PatchPfc(p, time, m_queue->GetNBytes(qIndex), qIndex);
+    if (PfcTracer::enabled && type == 0) {
+        Ptr<QbbNetDevice> peer = DynamicCast<QbbNetDevice>(
+            m_channel->GetDevice(m_channel->GetDevice(0) == this ? 1 : 0));
+        PfcTracer::OnPauseSent(Simulator::Now().GetTimeStep(), m_node->GetId(), m_ifIndex,
+                               peer->GetNode()->GetId(), peer->GetIfIndex(), qIndex);
+    }
+    // SwitchSend only uses the header for the queue index, which is always 0 here
+    CustomHeader ch(CustomHeader::L2_Header | CustomHeader::L3_Header | CustomHeader::L4_Header);
+    SwitchSend(0, p, ch);
+    return time;
+}
+
+Ptr<Packet> QbbNetDevice::AllocPfcFrame() {
+    // like the hula probes, a PFC frame is consumed by the peer, so a pooled frame is
+    // free again once only the pool references it; only the PAUSE fields are re-written
+    for (auto &pooled : m_pfcFramePool) {
+        if (pooled->GetReferenceCount() == 1) {
+            pooled->RemoveAllPacketTags();
+            pooled->RemoveAllByteTags();
+            return pooled;
+        }
+    }
     Ptr<Packet> p = Create<Packet>(0);
-    PauseHeader pauseh((type == 0 ? m_pausetime : 0), m_queue->GetNBytes(qIndex), qIndex);
+    PauseHeader pauseh(0, 0, 0);
     p->AddHeader(pauseh);
     Ipv4Header ipv4h;  // Prepare IPv4 header
     ipv4h.SetProtocol(0xFE);
@@ -436,15 +426,24 @@ uint32_t QbbNetDevice::SendPfc(uint32_t qIndex, uint32_t type) {
     ipv4h.SetIdentification(UniformVariable(0, 65536).GetValue());
     p->AddHeader(ipv4h);
     AddHeader(p, 0x800);
-    CustomHeader ch(CustomHeader::L2_Header | CustomHeader::L3_Header | CustomHeader::L4_Header);
-    p->PeekHeader(ch);
-    SwitchSend(0, p, ch);
-    return (type == 0 ? m_pausetime : 0);
+    if (m_pfcFramePool.size() < pfcFramePoolSize) {
+        m_pfcFramePool.push_back(p);
+    }
+    return p;
 }
 
-void QbbNetDevice::SendHulaProbe(uint32_t torID, uint8_t minUtil) {
+Ptr<Packet> QbbNetDevice::AllocHulaProbe() {
+    // a probe is consumed at the next hop (never forwarded), so once only the pool
+    // references it, it can be re-sent with its headers patched in place
+    for (auto &pooled : m_hulaProbePool) {
+        if (pooled->GetReferenceCount() == 1) {
+            pooled->RemoveAllPacketTags();
+            pooled->RemoveAllByteTags();
+            return pooled;
+        }
+    }
     Ptr<Packet> p = Create<Packet>(0);
-    HulaHeader hulah(torID, minUtil);
+    HulaHeader hulah(0, 0);
     p->AddHeader(hulah);
     Ipv4Header ipv4h;  // Prepare IPv4 header
     ipv4h.SetProtocol(0xFB);
@@ -455,8 +454,22 @@ void QbbNetDevice::SendHulaProbe(uint32_t torID, uint8_t minUtil) {
     ipv4h.SetIdentification(UniformVariable(0, 65536).GetValue());
     p->AddHeader(ipv4h);
     AddHeader(p, 0x800);
-    CustomHeader ch(CustomHeader::L2_Header | CustomHeader::L3_Header | CustomHeader::L4_Header);
-    p->PeekHeader(ch);
+    if (m_hulaProbePool.empty()) {
+        m_hulaProbeHeader = CustomHeader(CustomHeader::L2_Header | CustomHeader::L3_Header | CustomHeader::L4_Header);
+        p->PeekHeader(m_hulaProbeHeader);
+    }
+    if (m_hulaProbePool.size() < hulaProbePoolSize) {
+        m_hulaProbePool.push_back(p);
+    }
+    return p;
+}
+
+void QbbNetDevice::SendHulaProbe(uint32_t torID, uint8_t minUtil) {
+    Ptr<Packet> p = AllocHulaProbe();
+    CustomHeader::PatchHulaProbe(p, torID, minUtil);
+    CustomHeader ch = m_hulaProbeHeader;
+    ch.hula.data.torID = torID;
+    ch.hula.data.minUtil = minUtil;
     SwitchSend(0, p, ch);
 }
 
@@ -468,7 +481,7 @@ bool QbbNetDevice::Attach(Ptr<QbbChannel> ch) {
     return true;
 }
 
-bool QbbNetDevice::TransmitStart(Ptr<Packet> p) {
+bool QbbNetDevice::TransmitStart(Ptr<Packet> p, bool fluidShared) {
     NS_LOG_FUNCTION(this << p);
     NS_LOG_LOGIC("UID is " << p->GetUid() << ")");
     //
@@ -482,6 +495,12 @@ bool QbbNetDevice::TransmitStart(Ptr<Packet> p) {
     m_phyTxBeginTrace(m_currentPkt);
     Time txTime = Seconds(m_bps.CalculateTxTime(p->GetSize()));
     Time txCompleteTime = txTime + m_tInterframeGap;
+    if (fluidShared && m_fluidBps > 0) {
+        // the port is busy with fluid bytes for f/(C-f) of the packet's time on the wire
+        uint64_t c = m_bps.GetBitRate();
+        NS_ASSERT_MSG(m_fluidBps < c, "fluid flows take the whole link");
+        txCompleteTime += Time(txTime.GetDouble() * m_fluidBps / (c - m_fluidBps));
+    }
     NS_LOG_LOGIC("Schedule TransmitCompleteEvent in " << txCompleteTime.GetSeconds() << "sec");
     Simulator::Schedule(txCompleteTime, &QbbNetDevice::TransmitComplete, this);
     
@@ -498,6 +517,7 @@ bool QbbNetDevice::IsQbb(void) const { return true; }
 
 void QbbNetDevice::NewQp(Ptr<RdmaQueuePair> qp) {
     qp->m_nextAvail = Simulator::Now();
+    qp->m_pausedAtStart = m_pfc.GetPausedTime(qp->m_pg, Simulator::Now());
     DequeueAndTransmit();
 }
 void QbbNetDevice::ReassignedQp(Ptr<RdmaQueuePair> qp) { DequeueAndTransmit(); }
@@ -526,9 +546,9 @@ void QbbNetDevice::TakeDown() {
         m_rdmaLinkDownCb(this);
     } else {  // switch
         // clean the queue
-        for (uint32_t i = 0; i < qCnt; i++) m_paused[i] = false;
+        m_pfc.Clear();
         while (1) {
-            Ptr<Packet> p = m_queue->DequeueRR(m_paused);
+            Ptr<Packet> p = m_queue->DequeueRR(0);
             if (p == 0) break;
             m_traceDrop(p, m_queue->GetLastQueue());
         }
@@ -30,6 +30,7 @@
 #include "ns3/ipv4-header.h"
 #include "ns3/udp-header.h"
 #include "ns3/rdma-queue-pair.h"
+#include "ns3/pfc-state.h"
 #include <vector>
 #include<map>
 #include <unordered_map>
@@ -46,7 +47,6 @@ public:
 	uint32_t m_rrlast;
 	Ptr<DropTailQueue> m_ackQ; // highest priority queue
 	Ptr<RdmaQueuePairGroup> m_qpGrp; // queue pairs
-	std::unordered_map<int32_t, Time> current_pause_time;
 
 	// callback for get next packet
 	typedef Callback<Ptr<Packet>, Ptr<RdmaQueuePair> > RdmaGetNxtPkt;
@@ -55,7 +55,7 @@ public:
 	static TypeId GetTypeId (void);
 	RdmaEgressQueue();
 	Ptr<Packet> DequeueQindex(int qIndex);
-	int GetNextQindex(bool paused[]);
+	int GetNextQindex(uint32_t pausedMask);
 	int GetLastQueue();
 	uint32_t GetNBytes(uint32_t qIndex);
 	uint32_t GetFlowCount(void);
@@ -137,6 +137,11 @@ public:
    uint32_t SendPfc(uint32_t qIndex, uint32_t type); // type: 0 = pause, 1 = resume
    void SendHulaProbe(uint32_t torID, uint8_t minUtil);
 
+   /* hybrid fluid mode: rate (bps) the fluid flows take on this port; data packets
+    * get the rest of the link, control packets (qIndex 0) keep strict priority */
+   void SetFluidRate(uint64_t bps) { m_fluidBps = bps; }
+   uint64_t GetFluidRate(void) const { return m_fluidBps; }
+
    TracedCallback<Ptr<const Packet>, uint32_t> m_traceEnqueue;
    TracedCallback<Ptr<const Packet>, uint32_t> m_traceDequeue;
    TracedCallback<Ptr<const Packet>, uint32_t> m_traceDrop;
@@ -145,7 +150,8 @@ public:
 
    //Ptr<Node> m_node;
 
-   bool TransmitStart (Ptr<Packet> p);
+   /* fluidShared: a data packet, sent in the share of the link left by the fluid flows */
+   bool TransmitStart (Ptr<Packet> p, bool fluidShared = false);
 
    virtual void DoDispose(void);
 
@@ -172,9 +178,11 @@ public:
    bool m_qcnEnabled;
    bool m_dynamicth;
    uint32_t m_pausetime;	//< Time for each Pause
-   bool m_paused[qCnt];	//< Whether a queue paused
+   PfcPortState m_pfc;	//< which queues are paused, and for how long
    EventId m_resumeEvt[qCnt];
 
+   uint64_t m_fluidBps;	//< SetFluidRate
+
    //qcn
 
    /* RP parameters */
@@ -194,6 +202,17 @@ public:
 
   std::vector<ECNAccount> *m_ecn_source;
 
+   //hula
+   static const uint32_t hulaProbePoolSize = 16;
+   std::vector<Ptr<Packet> > m_hulaProbePool;	//< recycled probes, reusable once the pool holds the only reference
+   CustomHeader m_hulaProbeHeader;	//< parsed header of the pooled probes
+   Ptr<Packet> AllocHulaProbe();
+
+   //pfc frames, consumed by the peer like the hula probes
+   static const uint32_t pfcFramePoolSize = 16;
+   std::vector<Ptr<Packet> > m_pfcFramePool;
+   Ptr<Packet> AllocPfcFrame();
+
 public:
 	Ptr<RdmaEgressQueue> m_rdmaEQ;
 	void RdmaEnqueueHighPrioQ(Ptr<Packet> p);
@@ -209,6 +228,7 @@ public:
 	RdmaPktSent m_rdmaPktSent;
 
 	Ptr<RdmaEgressQueue> GetRdmaQueue();
+	const PfcPortState& GetPfcState() const { return m_pfc; }
 	void TakeDown(); // take down this device
 	void UpdateNextAvail(Time t);
 
@@ -15,10 +15,12 @@
 #include "ns3/flow-id-num-tag.h"
 #include "ns3/pointer.h"
 #include "ns3/ppp-header.h"
+#include "ns3/reorder-analytics.h"
 #include "ns3/settings.h"
 #include "ns3/switch-node.h"
 #include "ns3/uinteger.h"
 #include "ppp-header.h"
+#include "qbb-channel.h"
 #include "qbb-header.h"
 #include <assert.h>
 
@@ -27,7 +29,10 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE("RdmaHw");
 
 std::unordered_map<unsigned, unsigned> acc_timeout_count;
+// flow id -> total time its priority was PAUSEd on the sender NIC port while the flow was active
+std::unordered_map<unsigned, Time> acc_nic_pause_time;
 uint64_t RdmaHw::nAllPkts = 0;
+uint64_t RdmaHw::nGoodputBytes = 0;
 
 TypeId RdmaHw::GetTypeId(void) {
     static TypeId tid =
@@ -136,6 +141,28 @@ RdmaHw::RdmaHw() {
     cnp_total = 0;
     cnp_by_ecn = 0;
     cnp_by_ooo = 0;
+    m_memProbe = UINT32_MAX;
+}
+
+RdmaHw::~RdmaHw() {
+    if (m_memProbe != UINT32_MAX) MemoryAccounting::Unregister(m_memProbe);
+}
+
+void RdmaHw::ReportMemory(MemoryAccounting::Report &report) {
+    const uint64_t o = MemoryAccounting::MALLOC_OVERHEAD;
+    report.Add("rdma.qp", m_qpMap.size(),
+               MemoryAccounting::HashBytes(m_qpMap) + m_qpMap.size() * (sizeof(RdmaQueuePair) + o));
+    report.Add("rdma.rxqp", m_rxQpMap.size(),
+               MemoryAccounting::HashBytes(m_rxQpMap) +
+                   m_rxQpMap.size() * (sizeof(RdmaRxQueuePair) + o));
+    report.Add("rdma.tombstone", akashic_Qp.size() + akashic_RxQp.size(),
+               MemoryAccounting::HashBytes(akashic_Qp) + MemoryAccounting::HashBytes(akashic_RxQp));
+    report.Add("rdma.timer", m_timers.GetSize(),
+               m_timers.GetMemoryBytes() + MemoryAccounting::VectorBytes(m_timerQp) +
+                   MemoryAccounting::VectorBytes(m_freeTimerSlots));
+    uint64_t routeBytes = MemoryAccounting::HashBytes(m_rtTable) + MemoryAccounting::VectorBytes(Hashlist);
+    for (auto &it : m_rtTable) routeBytes += MemoryAccounting::VectorBytes(it.second);
+    report.Add("rdma.route", m_rtTable.size(), routeBytes);
 }
 
 void RdmaHw::SetNode(Ptr<Node> node) { m_node = node; }
@@ -155,6 +182,10 @@ void RdmaHw::Setup(QpCompleteCallback cb) {
     }
     // setup qp complete callback
     m_qpCompleteCallback = cb;
+    m_timers.SetExpireCallback(MakeCallback(&RdmaHw::QpTimerExpired, this));
+    if (m_memProbe == UINT32_MAX) {
+        m_memProbe = MemoryAccounting::Register(MakeCallback(&RdmaHw::ReportMemory, this));
+    }
 }
 
 uint32_t RdmaHw::GetNicIdxOfQp(Ptr<RdmaQueuePair> qp) {
@@ -215,6 +246,16 @@ void RdmaHw::AddQueuePair(uint64_t size, uint16_t pg, Ipv4Address sip, Ipv4Addre
         qp->irn.m_rtoHigh = m_irn_rtoHigh;
     }
 
+    // timer slot
+    if (m_freeTimerSlots.empty()) {
+        qp->m_timerSlot = m_timerQp.size();
+        m_timerQp.push_back(qp);
+    } else {
+        qp->m_timerSlot = m_freeTimerSlots.back();
+        m_freeTimerSlots.pop_back();
+        m_timerQp[qp->m_timerSlot] = qp;
+    }
+
     // add qp
     uint32_t nic_idx = GetNicIdxOfQp(qp);
     //std::cout << "node: " << m_node->GetId() << " flow id : " << qp->m_flow_id <<" nic_idx: " << nic_idx << std::endl;
@@ -345,18 +386,20 @@ int RdmaHw::ReceiveUdp(Ptr<Packet> p, CustomHeader &ch) {
     }
 
     bool cnp_check = false;
+    uint32_t expected = rxQp->ReceiverNextExpectedSeq;
     int x = ReceiverCheckSeq(ch.udp.seq, rxQp, payload_size, cnp_check);
+    if (rxQp->ReceiverNextExpectedSeq > expected) nGoodputBytes += rxQp->ReceiverNextExpectedSeq - expected;
+    if (ReorderAnalytics::enabled) {
+        ReorderAnalytics::OnArrival(rxQp->m_flow_id, ch.udp.seq, payload_size, expected,
+                                    rxQp->ReceiverNextExpectedSeq,
+                                    Simulator::Now().GetTimeStep());
+    }
 
     uint32_t glb_flow_id = Settings::PacketId2FlowId[std::make_tuple(Settings::hostIp2IdMap[ch.sip], Settings::hostIp2IdMap[ch.dip], ch.udp.sport, ch.udp.dport)];
     if (rxQp->ReceiverNextExpectedSeq >= Settings::FlowId2Length[glb_flow_id] && x == 5) { //已经全部发完
         //printf("Receive Last Packet, FlowId:%d, Length:%u, x=%d\n", rxQp->m_flow_id, Settings::FlowId2Length[glb_flow_id], x);
         x = 1;
     }
-    if (x == 2 || x == 4) {
-        printf("[%ld]超序，Flow:%u, 期待Seq：%u，当前Seq:%u\n", Simulator::Now().GetNanoSeconds(), glb_flow_id, rxQp->ReceiverNextExpectedSeq, ch.udp.seq);
-        fflush(stdout);
-        //exit(-1);
-    }
     rxQp->send_cnp = (ecnbits || cnp_check);
     if (x == 1 || x == 2 || x == 6) {  // generate ACK or NACK
         qbbHeader seqh;
@@ -504,6 +547,15 @@ int RdmaHw::ReceiveAck(Ptr<Packet> p, CustomHeader &ch) {
     uint32_t nic_idx = GetNicIdxOfQp(qp);
     Ptr<QbbNetDevice> dev = m_nic[nic_idx].dev;
 
+    // this ACK's event was scheduled when the peer started to transmit it, at the peer's rate
+    Ptr<QbbChannel> channel = DynamicCast<QbbChannel>(dev->GetChannel());
+    Ptr<QbbNetDevice> peer =
+        DynamicCast<QbbNetDevice>(channel->GetDevice(channel->GetDevice(0) == dev ? 1 : 0));
+    Time ackArmedAt = Simulator::Now() -
+                      Seconds(peer->GetDataRate().CalculateTxTime(p->GetSize())) -
+                      channel->GetDelay();
+    ExpireDueQpTimers(qp, ackArmedAt);
+
     if (m_ack_interval == 0)
         std::cout << "ERROR: shouldn't receive ack\n";
     else {
@@ -562,9 +614,7 @@ int RdmaHw::ReceiveAck(Ptr<Packet> p, CustomHeader &ch) {
      * packets.
      * */
     if (!qp->IsFinished() && qp->GetOnTheFly() > 0) {
-        if (qp->m_retransmit.IsRunning()) qp->m_retransmit.Cancel();
-        qp->m_retransmit = Simulator::Schedule(qp->GetRto(m_mtu), &RdmaHw::HandleTimeout, this, qp,
-                                               qp->GetRto(m_mtu));
+        SetQpTimer(qp, TIMER_RTO, Simulator::Now() + qp->GetRto(m_mtu));
     }
     //if (seq > qp->m_size) {
     //    uint32_t flow_id = Settings::PacketId2FlowId[std::make_tuple(Settings::hostIp2IdMap[ch.dip], Settings::hostIp2IdMap[ch.sip], ch.udp.dport, ch.udp.sport)];
@@ -591,7 +641,7 @@ int RdmaHw::ReceiveAck(Ptr<Packet> p, CustomHeader &ch) {
     // handle cnp
     if (!qp->IsFinished() && cnp) {
         if (m_cc_mode == 1) {  // mlx version
-            cnp_received_mlx(qp);
+            cnp_received_mlx(qp, ackArmedAt);
         }
     }
 
@@ -760,12 +810,11 @@ void RdmaHw::RecoverQueue(Ptr<RdmaQueuePair> qp) { qp->snd_nxt = qp->snd_una; }
 
 void RdmaHw::QpComplete(Ptr<RdmaQueuePair> qp) {
     NS_ASSERT(!m_qpCompleteCallback.IsNull());
-    if (m_cc_mode == 1) {
-        Simulator::Cancel(qp->mlx.m_eventUpdateAlpha);
-        Simulator::Cancel(qp->mlx.m_eventDecreaseRate);
-        Simulator::Cancel(qp->mlx.m_rpTimer);
-    }
-    if (qp->m_retransmit.IsRunning()) qp->m_retransmit.Cancel();
+    ReleaseQpTimers(qp);
+
+    Ptr<QbbNetDevice> dev = m_nic[GetNicIdxOfQp(qp)].dev;
+    Time paused = dev->GetPfcState().GetPausedTime(qp->m_pg, Simulator::Now()) - qp->m_pausedAtStart;
+    if (paused.IsStrictlyPositive()) acc_nic_pause_time[qp->m_flow_id] += paused;
 
     // This callback will log info. It also calls deletetion the rxQp on the receiver
     m_qpCompleteCallback(qp);
@@ -878,6 +927,7 @@ Ptr<Packet> RdmaHw::GetNxtPacket(Ptr<RdmaQueuePair> qp) {
 }
 
 void RdmaHw::PktSent(Ptr<RdmaQueuePair> qp, Ptr<Packet> pkt, Time interframeGap) {
+    ExpireDueQpTimers(qp, Simulator::Now());  // a rate change due now applies to this packet
     qp->lastPktSize = pkt->GetSize();
     UpdateNextAvail(qp, interframeGap, pkt->GetSize());
 
@@ -892,16 +942,14 @@ void RdmaHw::PktSent(Ptr<RdmaQueuePair> qp, Ptr<Packet> pkt, Time interframeGap)
         RdmaHw::nAllPkts += 1;
         if (ch.l3Prot == 0x11) {  // UDP
             // Update Timer
-            if (qp->m_retransmit.IsRunning()) qp->m_retransmit.Cancel();
-            qp->m_retransmit = Simulator::Schedule(qp->GetRto(m_mtu), &RdmaHw::HandleTimeout, this,
-                                                   qp, qp->GetRto(m_mtu));
+            SetQpTimer(qp, TIMER_RTO, Simulator::Now() + qp->GetRto(m_mtu));
         } else if (ch.l3Prot == 0xFC || ch.l3Prot == 0xFD || ch.l3Prot == 0xFF) {  // ACK, NACK, CNP
         } else if (ch.l3Prot == 0xFE) {                                            // PFC
         }
     }
 }
 
-void RdmaHw::HandleTimeout(Ptr<RdmaQueuePair> qp, Time rto) {
+void RdmaHw::HandleTimeout(Ptr<RdmaQueuePair> qp) {
     // Assume Outstanding Packets are lost
     // std::cerr << "Timeout on qp=" << qp << std::endl;
     if (qp->IsFinished()) {
@@ -924,6 +972,42 @@ void RdmaHw::HandleTimeout(Ptr<RdmaQueuePair> qp, Time rto) {
     dev->TriggerTransmit();
 }
 
+void RdmaHw::SetQpTimer(Ptr<RdmaQueuePair> qp, uint32_t timer, Time at, Time armedAt) {
+    if (qp->m_timerSlot == UINT32_MAX) return;  // completed: its timers would find it finished
+    m_timers.Schedule(qp->m_timerSlot * N_QP_TIMERS + timer, at, armedAt);
+}
+
+void RdmaHw::SetQpTimer(Ptr<RdmaQueuePair> qp, uint32_t timer, Time at) {
+    SetQpTimer(qp, timer, at, Simulator::Now());
+}
+
+void RdmaHw::ExpireDueQpTimers(Ptr<RdmaQueuePair> qp, Time eventArmedAt) {
+    if (qp->m_timerSlot == UINT32_MAX) return;
+    m_timers.ExpireDue(qp->m_timerSlot * N_QP_TIMERS, N_QP_TIMERS, eventArmedAt);
+}
+
+void RdmaHw::ReleaseQpTimers(Ptr<RdmaQueuePair> qp) {
+    for (uint32_t i = 0; i < N_QP_TIMERS; i++) m_timers.Cancel(qp->m_timerSlot * N_QP_TIMERS + i);
+    m_timerQp[qp->m_timerSlot] = NULL;
+    m_freeTimerSlots.push_back(qp->m_timerSlot);
+    qp->m_timerSlot = UINT32_MAX;
+}
+
+void RdmaHw::QpTimerExpired(uint32_t key) {
+    Ptr<RdmaQueuePair> qp = m_timerQp[key / N_QP_TIMERS];
+    switch (key % N_QP_TIMERS) {
+        case TIMER_RTO:
+            HandleTimeout(qp);
+            break;
+        case TIMER_MLX_DECREASE:
+            CheckRateDecreaseMlx(qp);
+            break;
+        case TIMER_MLX_RATE_INC:
+            RateIncEventTimerMlx(qp);
+            break;
+    }
+}
+
 void RdmaHw::UpdateNextAvail(Ptr<RdmaQueuePair> qp, Time interframeGap, uint32_t pkt_size) {
     Time sendingTime;
     if (m_rateBound)
@@ -951,26 +1035,26 @@ void RdmaHw::ChangeRate(Ptr<RdmaQueuePair> qp, DataRate new_rate) {
 /******************************
  * Mellanox's version of DCQCN
  *****************************/
-void RdmaHw::UpdateAlphaMlx(Ptr<RdmaQueuePair> q) {
-// std::cout << Simulator::Now() << " alpha update:" << m_node->GetId() << ' ' << q->mlx.m_alpha <<
-// ' ' << (int)q->mlx.m_alpha_cnp_arrived << '\n'; printf("%lu alpha update: %08x %08x %u %u %.6lf->", Simulator::Now().GetTimeStep(), q->sip.Get(), q->dip.Get(), q->sport, q->dport,q->mlx.m_alpha);
-    if (q->mlx.m_alpha_cnp_arrived) {                       // cnp -> increase
-        q->mlx.m_alpha = (1 - m_g) * q->mlx.m_alpha + m_g;  // binary feedback
-    } else {                                                // no cnp -> decrease
-        q->mlx.m_alpha = (1 - m_g) * q->mlx.m_alpha;        // binary feedback
+void RdmaHw::UpdateAlphaMlx(Ptr<RdmaQueuePair> q, Time eventArmedAt) {
+    Time now = Simulator::Now();
+    Time interval = MicroSeconds(m_alpha_resume_interval);
+    // a slot of this very time step goes first if its event would have been scheduled first
+    while (q->mlx.m_nextAlphaUpdate < now ||
+           (q->mlx.m_nextAlphaUpdate == now && now - interval <= eventArmedAt)) {
+// std::cout << q->mlx.m_nextAlphaUpdate << " alpha update:" << m_node->GetId() << ' ' << q->mlx.m_alpha <<
+// ' ' << (int)q->mlx.m_alpha_cnp_arrived << '\n';
+        if (q->mlx.m_alpha_cnp_arrived) {                       // cnp -> increase
+            q->mlx.m_alpha = (1 - m_g) * q->mlx.m_alpha + m_g;  // binary feedback
+        } else {                                                // no cnp -> decrease
+            q->mlx.m_alpha = (1 - m_g) * q->mlx.m_alpha;        // binary feedback
+        }
+        q->mlx.m_alpha_cnp_arrived = false;  // clear the CNP_arrived bit
+        q->mlx.m_nextAlphaUpdate += interval;
     }
-#if PRINT_LOG
-// printf("%.6lf\n", q->mlx.m_alpha);
-#endif
-    q->mlx.m_alpha_cnp_arrived = false;  // clear the CNP_arrived bit
-    ScheduleUpdateAlphaMlx(q);
-}
-void RdmaHw::ScheduleUpdateAlphaMlx(Ptr<RdmaQueuePair> q) {
-    q->mlx.m_eventUpdateAlpha = Simulator::Schedule(MicroSeconds(m_alpha_resume_interval),
-                                                    &RdmaHw::UpdateAlphaMlx, this, q);
 }
 
-void RdmaHw::cnp_received_mlx(Ptr<RdmaQueuePair> q) {
+void RdmaHw::cnp_received_mlx(Ptr<RdmaQueuePair> q, Time ackArmedAt) {
+    if (!q->mlx.m_first_cnp) UpdateAlphaMlx(q, ackArmedAt);  // slots before this CNP
     q->mlx.m_alpha_cnp_arrived = true;     // set CNP_arrived bit for alpha update
     q->mlx.m_decrease_cnp_arrived = true;  // set CNP_arrived bit for rate decrease
     //std::cout << "ID: " << m_node->GetId() << ",Receive cnp " << q->m_flow_id <<  ",m_first_cnp:" <<q->mlx.m_first_cnp << ",at" << Simulator::Now() << std::endl;
@@ -978,24 +1062,28 @@ void RdmaHw::cnp_received_mlx(Ptr<RdmaQueuePair> q) {
         // init alpha
         q->mlx.m_alpha = 1;
         q->mlx.m_alpha_cnp_arrived = false;
-        // schedule alpha update
-        ScheduleUpdateAlphaMlx(q);
-        // schedule rate decrease
-        ScheduleDecreaseRateMlx(q, 1);  // add 1 ns to make sure rate decrease is after alpha update
+        // start alpha update slots
+        q->mlx.m_nextAlphaUpdate = Simulator::Now() + MicroSeconds(m_alpha_resume_interval);
+        // start rate decrease checks
+        // add 1 ns to make sure rate decrease is after alpha update
+        q->mlx.m_nextDecrease =
+            Simulator::Now() + MicroSeconds(m_rateDecreaseInterval) + NanoSeconds(1);
         // set rate on first CNP
         q->mlx.m_targetRate = q->m_rate = m_rateOnFirstCNP * q->m_rate;
         //std::cout << "ID: " << m_node->GetId() <<  ",First cnp target rate:" << q->mlx.m_targetRate << ",at" << Simulator::Now() << std::endl;
         q->mlx.m_first_cnp = false;
     }
+    ScheduleDecreaseRateMlx(q, ackArmedAt);
 }
 
 void RdmaHw::CheckRateDecreaseMlx(Ptr<RdmaQueuePair> q) {
-    ScheduleDecreaseRateMlx(q, 0);
     if (q->mlx.m_decrease_cnp_arrived) {
         //printf("%lu rate dec: %08x %08x %u %u (%0.3lf %.3lf)\n", Simulator::Now().GetTimeStep(),
         //       q->sip.Get(), q->dip.Get(), q->sport, q->dport,
         //       q->mlx.m_targetRate.GetBitRate() * 1e-9, q->m_rate.GetBitRate() * 1e-9);
         //std::cout  << "m_EcnClampTgtRate:" << m_EcnClampTgtRate << std::endl; 
+        // this check would have been scheduled one interval earlier
+        UpdateAlphaMlx(q, Simulator::Now() - MicroSeconds(m_rateDecreaseInterval));
         bool clamp = true;
         if (!m_EcnClampTgtRate) {
             if (q->mlx.m_rpTimeStage == 0) clamp = false;
@@ -1007,26 +1095,32 @@ void RdmaHw::CheckRateDecreaseMlx(Ptr<RdmaQueuePair> q) {
         // reset rate increase related things
         q->mlx.m_rpTimeStage = 0;
         q->mlx.m_decrease_cnp_arrived = false;
-        Simulator::Cancel(q->mlx.m_rpTimer);
         // std::cout << "m_rpgTimeReset: " << m_rpgTimeReset << std::endl;
-        q->mlx.m_rpTimer = Simulator::Schedule(MicroSeconds(m_rpgTimeReset),
-                                               &RdmaHw::RateIncEventTimerMlx, this, q);
+        SetQpTimer(q, TIMER_MLX_RATE_INC, Simulator::Now() + MicroSeconds(m_rpgTimeReset));
 #if PRINT_LOG
         printf("(%.3lf %.3lf)\n", q->mlx.m_targetRate.GetBitRate() * 1e-9,
                q->m_rate.GetBitRate() * 1e-9);
 #endif
     }
 }
-void RdmaHw::ScheduleDecreaseRateMlx(Ptr<RdmaQueuePair> q, uint32_t delta) {
-    q->mlx.m_eventDecreaseRate =
-        Simulator::Schedule(MicroSeconds(m_rateDecreaseInterval) + NanoSeconds(delta),
-                            &RdmaHw::CheckRateDecreaseMlx, this, q);
+void RdmaHw::ScheduleDecreaseRateMlx(Ptr<RdmaQueuePair> q, Time cnpArmedAt) {
+    if (q->m_timerSlot == UINT32_MAX) return;
+    if (m_timers.IsPending(q->m_timerSlot * N_QP_TIMERS + TIMER_MLX_DECREASE)) return;
+    // skip the checks that found no CNP
+    int64_t now = Simulator::Now().GetTimeStep();
+    int64_t next = q->mlx.m_nextDecrease.GetTimeStep();
+    int64_t interval = MicroSeconds(m_rateDecreaseInterval).GetTimeStep();
+    if (next < now) next += (now - next + interval - 1) / interval * interval;
+    // the check of this very time step runs after the CNP only if it was scheduled later
+    if (next == now && next - interval <= cnpArmedAt.GetTimeStep()) next += interval;
+    q->mlx.m_nextDecrease = TimeStep(next);
+    // the periodic check would have been scheduled one interval earlier
+    SetQpTimer(q, TIMER_MLX_DECREASE, q->mlx.m_nextDecrease, TimeStep(next - interval));
 }
 
 void RdmaHw::RateIncEventTimerMlx(Ptr<RdmaQueuePair> q) {
     // std::cout << "ID: " << m_node->GetId() << ",RateIncEventTimerMlx " << q->m_flow_id << ",at" << Simulator::Now() << std::endl;
-    q->mlx.m_rpTimer =
-        Simulator::Schedule(MicroSeconds(m_rpgTimeReset), &RdmaHw::RateIncEventTimerMlx, this, q);
+    SetQpTimer(q, TIMER_MLX_RATE_INC, Simulator::Now() + MicroSeconds(m_rpgTimeReset));
     RateIncEventMlx(q);
     q->mlx.m_rpTimeStage++;
 }
@@ -2,6 +2,8 @@
 #define RDMA_HW_H
 
 #include <ns3/custom-header.h>
+#include <ns3/deadline-timer.h>
+#include <ns3/memory-accounting.h>
 #include <ns3/node.h>
 #include <ns3/rdma.h>
 #include <ns3/selective-packet-queue.h>
@@ -26,6 +28,7 @@ class RdmaHw : public Object {
    public:
     static TypeId GetTypeId(void);
     RdmaHw();
+    virtual ~RdmaHw();
 
     Ptr<Node> m_node;
     DataRate m_minRate;  //< Min sending rate
@@ -54,6 +57,7 @@ class RdmaHw : public Object {
     std::unordered_set<uint64_t> akashic_Qp;    // instance for each src
     std::unordered_set<uint64_t> akashic_RxQp;  // instance for each dst
     static uint64_t nAllPkts;                   // number of total packets
+    static uint64_t nGoodputBytes;              // in-order payload bytes delivered to the receivers
 
     /* TxQpeueuPair */
     static uint64_t GetQpKey(uint32_t dip, uint16_t sport, uint16_t dport,
@@ -105,13 +109,29 @@ class RdmaHw : public Object {
     void UpdateNextAvail(Ptr<RdmaQueuePair> qp, Time interframeGap, uint32_t pkt_size);
     void ChangeRate(Ptr<RdmaQueuePair> qp, DataRate new_rate);
 
-    void HandleTimeout(Ptr<RdmaQueuePair> qp, Time rto);
+    void HandleTimeout(Ptr<RdmaQueuePair> qp);
+
+    /* per-QP timers (retransmission, DCQCN) of all QPs share one DeadlineTimer */
+    enum : uint32_t { TIMER_RTO = 0, TIMER_MLX_DECREASE, TIMER_MLX_RATE_INC, N_QP_TIMERS };
+    DeadlineTimer m_timers;                      // key = qp->m_timerSlot * N_QP_TIMERS + timer
+    std::vector<Ptr<RdmaQueuePair>> m_timerQp;  // timer slot -> qp
+    std::vector<uint32_t> m_freeTimerSlots;
+    void SetQpTimer(Ptr<RdmaQueuePair> qp, uint32_t timer, Time at, Time armedAt);
+    void SetQpTimer(Ptr<RdmaQueuePair> qp, uint32_t timer, Time at);
+    // timers of `qp` due now whose events would have been scheduled before the current
+    // event (scheduled at eventArmedAt) fire first, as they did with one event per timer
+    void ExpireDueQpTimers(Ptr<RdmaQueuePair> qp, Time eventArmedAt);
+    void ReleaseQpTimers(Ptr<RdmaQueuePair> qp);
+    void QpTimerExpired(uint32_t key);
 
     /* statistics */
     uint32_t cnp_by_ecn;
     uint32_t cnp_by_ooo;
     uint32_t cnp_total;
     size_t getIrnBufferOverhead();  // get buffer overhead for IRN
+    /* memory probe (registered by Setup): QPs, RxQPs, tombstones, timers, routes */
+    void ReportMemory(MemoryAccounting::Report &report);
+    uint32_t m_memProbe;
 
     /******************************
      * Mellanox's version of DCQCN
@@ -128,17 +148,19 @@ class RdmaHw : public Object {
 
     // the Mellanox's version of alpha update:
     // every fixed time slot, update alpha.
-    void UpdateAlphaMlx(Ptr<RdmaQueuePair> q);
-    void ScheduleUpdateAlphaMlx(Ptr<RdmaQueuePair> q);
+    // Alpha is only read by the rate decrease, so the slots elapsed up to now are applied one
+    // by one when a CNP arrives or before a decrease, instead of one event per slot.
+    void UpdateAlphaMlx(Ptr<RdmaQueuePair> q, Time eventArmedAt);
 
     // Mellanox's version of CNP receive
-    void cnp_received_mlx(Ptr<RdmaQueuePair> q);
+    void cnp_received_mlx(Ptr<RdmaQueuePair> q, Time ackArmedAt);
 
     // Mellanox's version of rate decrease
     // It checks every m_rateDecreaseInterval if CNP arrived (m_decrease_cnp_arrived).
     // If so, decrease rate, and reset all rate increase related things
+    // A check without CNP does nothing, so only the first check after a CNP is armed.
     void CheckRateDecreaseMlx(Ptr<RdmaQueuePair> q);
-    void ScheduleDecreaseRateMlx(Ptr<RdmaQueuePair> q, uint32_t delta);
+    void ScheduleDecreaseRateMlx(Ptr<RdmaQueuePair> q, Time cnpArmedAt);
 
     // Mellanox's version of rate increase
     void RateIncEventTimerMlx(Ptr<RdmaQueuePair> q);
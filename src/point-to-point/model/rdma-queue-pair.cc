@@ -46,6 +46,7 @@ RdmaQueuePair::RdmaQueuePair(uint16_t pg, Ipv4Address _sip, Ipv4Address _dip, ui
     mlx.m_first_cnp = true;
     mlx.m_decrease_cnp_arrived = false;
     mlx.m_rpTimeStage = 0;
+    m_timerSlot = UINT32_MAX;
     hp.m_lastUpdateSeq = 0;
     for (uint32_t i = 0; i < sizeof(hp.keep) / sizeof(hp.keep[0]); i++) hp.keep[i] = 0;
     hp.m_incStage = 0;
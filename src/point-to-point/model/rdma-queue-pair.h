@@ -54,6 +54,7 @@ class IrnSackManager {
 class RdmaQueuePair : public Object {
    public:
     Time startTime;
+    Time m_pausedAtStart;  // paused time of m_pg on the NIC port when the qp started
     Ipv4Address sip, dip;
     uint16_t sport, dport;
     uint64_t m_size;
@@ -76,14 +77,13 @@ class RdmaQueuePair : public Object {
     DataRate m_rate;  //< Current rate
     struct {
         DataRate m_targetRate;  //< Target rate
-        EventId m_eventUpdateAlpha;
+        Time m_nextAlphaUpdate;  // next alpha update slot, applied lazily by UpdateAlphaMlx
         double m_alpha;
         bool m_alpha_cnp_arrived;  // indicate if CNP arrived in the last slot
         bool m_first_cnp;          // indicate if the current CNP is the first CNP
-        EventId m_eventDecreaseRate;
+        Time m_nextDecrease;          // next rate decrease check
         bool m_decrease_cnp_arrived;  // indicate if CNP arrived in the last slot
         uint32_t m_rpTimeStage;
-        EventId m_rpTimer;
     } mlx;
     struct {
         uint32_t m_lastUpdateSeq;
@@ -135,7 +135,8 @@ class RdmaQueuePair : public Object {
     // Implement Timeout according to IB Spec Vol. 1 C9-139.
     // For an HCA requester using Reliable Connection service, to detect missing responses,
     // every Send queue is required to implement a Transport Timer to time outstanding requests.
-    EventId m_retransmit;
+    // The retransmission and DCQCN timers live in RdmaHw::m_timers under this slot.
+    uint32_t m_timerSlot;
 
     /***********
      * methods
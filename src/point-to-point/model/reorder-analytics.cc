@@ -0,0 +1,193 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CAVER-LB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "ns3/reorder-analytics.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+bool ReorderAnalytics::enabled = false;
+std::vector<ReorderAnalytics::FlowRecord> ReorderAnalytics::m_flows;
+uint64_t ReorderAnalytics::m_distanceHist[BINS];
+uint64_t ReorderAnalytics::m_bufferHist[BINS];
+uint64_t ReorderAnalytics::m_episodeNsHist[BINS];
+
+uint32_t ReorderAnalytics::Bin(uint64_t v) {
+    if (v == 0) return 0;
+    uint32_t bin = 64 - __builtin_clzll(v);  // floor(log2(v)) + 1
+    return std::min(bin, (uint32_t)BINS - 1);
+}
+
+ReorderAnalytics::FlowRecord& ReorderAnalytics::Get(int32_t flow) {
+    if ((uint32_t)flow >= m_flows.size()) {
+        FlowRecord empty;
+        memset(&empty, 0, sizeof(empty));
+        empty.lastPort = NO_PORT;
+        m_flows.resize(flow + 1, empty);
+    }
+    return m_flows[flow];
+}
+
+void ReorderAnalytics::CloseEpisode(FlowRecord& r, uint64_t nowNs) {
+    uint64_t duration = nowNs - r.episodeStartNs;
+    r.episodeNs += duration;
+    m_episodeNsHist[Bin(duration)]++;
+    m_bufferHist[Bin(r.episodeBuffer)]++;
+    r.episodeBuffer = 0;
+}
+
+void ReorderAnalytics::OnArrival(int32_t flow, uint32_t seq, uint32_t size,
+                                 uint32_t expectedBefore, uint32_t expectedAfter, uint64_t nowNs) {
+    if (flow < 0) return;
+    FlowRecord& r = Get(flow);
+    r.packets++;
+    if (seq > expectedBefore) {
+        uint32_t distance = seq - expectedBefore;
+        r.oooPackets++;
+        r.oooBytes += size;
+        r.maxDistance = std::max(r.maxDistance, distance);
+        m_distanceHist[Bin(distance)]++;
+        if (r.episodeBuffer == 0) {  // a new hole opens
+            r.episodes++;
+            r.episodeStartNs = nowNs;
+            r.holeEnd = 0;
+        }
+        r.holeEnd = std::max(r.holeEnd, seq + size);
+        uint32_t buffer = r.holeEnd - expectedBefore;
+        r.episodeBuffer = std::max(r.episodeBuffer, buffer);
+        r.maxBuffer = std::max(r.maxBuffer, buffer);
+    }
+    if (r.episodeBuffer > 0 && expectedAfter >= r.holeEnd) {
+        CloseEpisode(r, nowNs);
+    }
+}
+
+void ReorderAnalytics::OnSourceToR(int32_t flow, uint32_t port) {
+    if (flow < 0) return;
+    FlowRecord& r = Get(flow);
+    if (r.lastPort != port) {
+        if (r.lastPort != NO_PORT) r.pathSwitches++;
+        r.lastPort = port;
+    }
+}
+
+void ReorderAnalytics::CloseOpenEpisodes(uint64_t nowNs) {
+    for (auto& r : m_flows) {
+        if (r.episodeBuffer > 0) CloseEpisode(r, nowNs);
+    }
+}
+
+uint32_t ReorderAnalytics::GetNumFlows() {
+    uint32_t n = 0;
+    for (auto& r : m_flows) {
+        if (r.packets > 0) n++;
+    }
+    return n;
+}
+
+bool ReorderAnalytics::Write(const char* filename) {
+    FILE* fout = fopen(filename, "wb");
+    if (fout == NULL) {
+        return false;
+    }
+    const uint32_t version = 1, nBins = BINS;
+    uint32_t nFlows = GetNumFlows();
+    fwrite("RORD", 1, 4, fout);
+    fwrite(&version, sizeof(version), 1, fout);
+    fwrite(&nBins, sizeof(nBins), 1, fout);
+    fwrite(&nFlows, sizeof(nFlows), 1, fout);
+    fwrite(m_distanceHist, sizeof(uint64_t), BINS, fout);
+    fwrite(m_bufferHist, sizeof(uint64_t), BINS, fout);
+    fwrite(m_episodeNsHist, sizeof(uint64_t), BINS, fout);
+    for (int32_t flow = 0; flow < (int32_t)m_flows.size(); flow++) {
+        const FlowRecord& r = m_flows[flow];
+        if (r.packets == 0) continue;
+        fwrite(&flow, sizeof(int32_t), 1, fout);
+        fwrite(&r.packets, sizeof(uint64_t), 1, fout);
+        fwrite(&r.oooBytes, sizeof(uint64_t), 1, fout);
+        fwrite(&r.episodeNs, sizeof(uint64_t), 1, fout);
+        fwrite(&r.oooPackets, sizeof(uint32_t), 1, fout);
+        fwrite(&r.episodes, sizeof(uint32_t), 1, fout);
+        fwrite(&r.maxDistance, sizeof(uint32_t), 1, fout);
+        fwrite(&r.maxBuffer, sizeof(uint32_t), 1, fout);
+        fwrite(&r.pathSwitches, sizeof(uint32_t), 1, fout);
+    }
+    fclose(fout);
+    return true;
+}
+
+static void WriteTail(FILE* fout, const char* name, std::vector<uint64_t>& v) {
+    std::sort(v.begin(), v.end());
+    auto q = [&v](double p) -> uint64_t {
+        return v.empty() ? 0 : v[std::min((size_t)(p * v.size()), v.size() - 1)];
+    };
+    fprintf(fout, "TAIL %s p50 %lu p90 %lu p99 %lu p999 %lu max %lu\n", name, q(0.5), q(0.9),
+            q(0.99), q(0.999), v.empty() ? 0 : v.back());
+}
+
+void ReorderAnalytics::WriteTails(FILE* fout) {
+    std::vector<uint64_t> distance, buffer, episodes, episodeNs;
+    uint64_t packets = 0, oooPackets = 0, reordered = 0, sumFlowlets = 0, sumEpisodes = 0;
+    double sx = 0, sy = 0, sxx = 0, syy = 0, sxy = 0;
+    for (auto& r : m_flows) {
+        if (r.packets == 0) continue;
+        distance.push_back(r.maxDistance);
+        buffer.push_back(r.maxBuffer);
+        episodes.push_back(r.episodes);
+        episodeNs.push_back(r.episodeNs);
+        packets += r.packets;
+        oooPackets += r.oooPackets;
+        if (r.episodes > 0) reordered++;
+        sumFlowlets += r.pathSwitches + 1;
+        sumEpisodes += r.episodes;
+        double x = r.pathSwitches, y = r.episodes;
+        sx += x;
+        sy += y;
+        sxx += x * x;
+        syy += y * y;
+        sxy += x * y;
+    }
+    double n = distance.size();
+    double cov = n > 0 ? sxy / n - (sx / n) * (sy / n) : 0;
+    double varX = n > 0 ? sxx / n - (sx / n) * (sx / n) : 0;
+    double varY = n > 0 ? syy / n - (sy / n) * (sy / n) : 0;
+    double corr = (varX > 0 && varY > 0) ? cov / std::sqrt(varX * varY) : 0;
+
+    fprintf(fout, "REORDER flows %lu reordered %lu packets %lu oooPackets %lu\n",
+            (uint64_t)distance.size(), reordered, packets, oooPackets);
+    WriteTail(fout, "maxDistance", distance);
+    WriteTail(fout, "maxBuffer", buffer);
+    WriteTail(fout, "episodes", episodes);
+    WriteTail(fout, "episodeNs", episodeNs);
+    // flowlets are counted as path switches + 1 (a flowlet kept on the same port is not visible)
+    fprintf(fout, "CORR pathSwitches-episodes %.4f episodesPerFlowlet %.4f\n", corr,
+            sumFlowlets > 0 ? (double)sumEpisodes / sumFlowlets : 0.0);
+}
+
+}  // namespace ns3
@@ -0,0 +1,312 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CAVER-LB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "ns3/route-tracer.h"
+
+#include <string.h>
+
+#include "ns3/object-base.h"
+#include "ns3/path-codec.h"
+#include "ns3/tag.h"
+
+namespace ns3 {
+
+uint32_t RouteTracer::m_switchId = RouteTracer::NONE;
+FILE* RouteTracer::m_file = NULL;
+uint64_t RouteTracer::m_nRecords = 0;
+uint32_t RouteTracer::m_nPaths = 1;  // PathCodec::EMPTY is implicit
+std::unordered_map<std::string, uint16_t> RouteTracer::m_tagTypes;
+std::vector<uint8_t> RouteTracer::m_buf;
+
+namespace {
+
+template <typename T>
+void Put(FILE* f, T v) {
+    fwrite(&v, sizeof(T), 1, f);
+}
+
+template <typename T>
+bool Get(FILE* f, T& v) {
+    return fread(&v, sizeof(T), 1, f) == 1;
+}
+
+}  // namespace
+
+bool RouteTracer::Open(const char* filename, const Config& config) {
+    m_file = fopen(filename, "wb");
+    if (m_file == NULL) return false;
+    m_switchId = config.switchId;
+
+    fwrite("RTRC", 1, 4, m_file);
+    Put<uint32_t>(m_file, VERSION);
+    Put<uint32_t>(m_file, config.lbMode);
+    Put<uint32_t>(m_file, config.switchId);
+    Put<uint8_t>(m_file, config.isToR);
+    Put<uint32_t>(m_file, config.ecmpSeed);
+    Put<uint32_t>(m_file, config.lbSeed);
+    Put<uint32_t>(m_file, config.params.size());
+    for (double v : config.params) Put<double>(m_file, v);
+    Put<uint32_t>(m_file, config.id2Port.size());
+    for (auto& it : config.id2Port) {
+        Put<uint32_t>(m_file, it.first);
+        Put<uint32_t>(m_file, it.second);
+    }
+    Put<uint32_t>(m_file, config.portRate.size());
+    for (auto& it : config.portRate) {
+        Put<uint32_t>(m_file, it.first);
+        Put<uint64_t>(m_file, it.second);
+    }
+    Put<uint32_t>(m_file, config.routes.size());
+    for (auto& it : config.routes) {
+        Put<uint32_t>(m_file, it.first);
+        Put<uint32_t>(m_file, it.second.size());
+        for (uint32_t port : it.second) Put<uint32_t>(m_file, port);
+    }
+    Put<uint32_t>(m_file, config.hostIp2Id.size());
+    for (auto& it : config.hostIp2Id) {
+        Put<uint32_t>(m_file, it.first);
+        Put<uint32_t>(m_file, it.second);
+    }
+    Put<uint32_t>(m_file, config.torHosts.size());
+    for (uint32_t ip : config.torHosts) Put<uint32_t>(m_file, ip);
+    Put<uint32_t>(m_file, config.interfaces.size());
+    for (auto& it : config.interfaces) {
+        Put<uint32_t>(m_file, it.first);
+        Put<uint32_t>(m_file, it.second.size());
+        for (auto& port : it.second) {
+            Put<uint32_t>(m_file, port.first);
+            Put<uint32_t>(m_file, port.second);
+        }
+    }
+    return true;
+}
+
+void RouteTracer::OnRouteInput(Ptr<const Packet> p, uint64_t nowNs) {
+    if (m_file == NULL) return;
+    uint32_t size = p->GetSize();
+    uint16_t len = size < HEADER_BYTES ? size : HEADER_BYTES;
+    m_buf.resize(HEADER_BYTES);
+    p->CopyData(m_buf.data(), len);
+
+    // tag types first (a definition record the first time a type is seen), then the packet
+    std::vector<std::pair<uint16_t, Tag*> > tags;
+    PacketTagIterator it = p->GetPacketTagIterator();
+    while (it.HasNext()) {
+        PacketTagIterator::Item item = it.Next();
+        TypeId tid = item.GetTypeId();
+        Callback<ObjectBase*> ctor = tid.GetConstructor();
+        if (ctor.IsNull()) continue;  // cannot be rebuilt
+        Tag* tag = dynamic_cast<Tag*>(ctor());
+        if (tag == NULL) continue;
+        item.GetTag(*tag);
+        auto type = m_tagTypes.find(tid.GetName());
+        if (type == m_tagTypes.end()) {
+            type = m_tagTypes.insert(std::make_pair(tid.GetName(), (uint16_t)m_tagTypes.size())).first;
+            Put<uint8_t>(m_file, 0);
+            Put<uint16_t>(m_file, type->second);
+            Put<uint8_t>(m_file, tid.GetName().size());
+            fwrite(tid.GetName().data(), 1, tid.GetName().size(), m_file);
+        }
+        tags.push_back(std::make_pair(type->second, tag));
+    }
+
+    // paths interned since the last packet, before the tags that may refer to them
+    uint32_t nPaths = PathCodec::GetNumPaths();
+    if (nPaths > m_nPaths) {
+        Put<uint8_t>(m_file, 2);
+        Put<uint32_t>(m_file, m_nPaths);
+        Put<uint32_t>(m_file, nPaths - m_nPaths);
+        for (uint32_t id = m_nPaths; id < nPaths; id++) {
+            PathCodec::Ports ports = PathCodec::GetPorts(id);
+            Put<uint16_t>(m_file, ports.size());
+            fwrite(ports.data(), sizeof(uint16_t), ports.size(), m_file);
+        }
+        m_nPaths = nPaths;
+    }
+
+    Put<uint8_t>(m_file, 1);
+    Put<uint64_t>(m_file, nowNs);
+    Put<uint32_t>(m_file, size);
+    Put<uint16_t>(m_file, len);
+    fwrite(m_buf.data(), 1, len, m_file);
+    Put<uint8_t>(m_file, tags.size());
+    for (auto& t : tags) {
+        uint32_t n = t.second->GetSerializedSize();
+        m_buf.resize(n);
+        TagBuffer tb(m_buf.data(), m_buf.data() + n);
+        t.second->Serialize(tb);
+        Put<uint16_t>(m_file, t.first);
+        Put<uint16_t>(m_file, n);
+        fwrite(m_buf.data(), 1, n, m_file);
+        delete t.second;
+    }
+    m_nRecords++;
+}
+
+void RouteTracer::Close() {
+    if (m_file != NULL) fclose(m_file);
+    m_file = NULL;
+    m_switchId = NONE;
+}
+
+bool RouteTracer::Load(const char* filename, Config& config, std::vector<Record>& records,
+                       std::vector<std::string>& tagNames) {
+    FILE* f = fopen(filename, "rb");
+    if (f == NULL) return false;
+    char magic[4];
+    uint32_t version = 0, n = 0;
+    uint8_t isToR = 0;
+    if (fread(magic, 1, 4, f) != 4 || memcmp(magic, "RTRC", 4) != 0 || !Get(f, version) ||
+        version != VERSION || !Get(f, config.lbMode) || !Get(f, config.switchId) || !Get(f, isToR) ||
+        !Get(f, config.ecmpSeed) || !Get(f, config.lbSeed)) {
+        fclose(f);
+        return false;
+    }
+    config.isToR = isToR;
+    bool ok = Get(f, n);
+    config.params.resize(ok ? n : 0);
+    for (uint32_t i = 0; ok && i < n; i++) ok = Get(f, config.params[i]);
+    ok = ok && Get(f, n);
+    for (uint32_t i = 0; ok && i < n; i++) {
+        uint32_t id, port;
+        ok = Get(f, id) && Get(f, port);
+        config.id2Port[id] = port;
+    }
+    ok = ok && Get(f, n);
+    for (uint32_t i = 0; ok && i < n; i++) {
+        uint32_t port;
+        uint64_t bps;
+        ok = Get(f, port) && Get(f, bps);
+        config.portRate[port] = bps;
+    }
+    ok = ok && Get(f, n);
+    for (uint32_t i = 0; ok && i < n; i++) {
+        uint32_t ip, m;
+        ok = Get(f, ip) && Get(f, m);
+        std::vector<uint32_t>& ports = config.routes[ip];
+        ports.resize(ok ? m : 0);
+        for (uint32_t j = 0; ok && j < m; j++) ok = Get(f, ports[j]);
+    }
+    ok = ok && Get(f, n);
+    for (uint32_t i = 0; ok && i < n; i++) {
+        uint32_t ip, id;
+        ok = Get(f, ip) && Get(f, id);
+        config.hostIp2Id[ip] = id;
+    }
+    ok = ok && Get(f, n);
+    config.torHosts.resize(ok ? n : 0);
+    for (uint32_t i = 0; ok && i < n; i++) ok = Get(f, config.torHosts[i]);
+    ok = ok && Get(f, n);
+    for (uint32_t i = 0; ok && i < n; i++) {
+        uint32_t node, m;
+        ok = Get(f, node) && Get(f, m);
+        for (uint32_t j = 0; ok && j < m; j++) {
+            uint32_t port, peer;
+            ok = Get(f, port) && Get(f, peer);
+            config.interfaces[node][port] = peer;
+        }
+    }
+
+    if (!ok) {
+        fclose(f);
+        return false;
+    }
+
+    // records up to the end, or up to a record cut short by an aborted run
+    uint8_t kind;
+    while (ok && Get(f, kind)) {
+        if (kind == 0) {
+            uint16_t type;
+            uint8_t len;
+            char name[256];
+            ok = Get(f, type) && Get(f, len) && fread(name, 1, len, f) == len;
+            if (tagNames.size() <= type) tagNames.resize(type + 1);
+            tagNames[type] = std::string(name, len);
+            continue;
+        }
+        if (kind == 2) {
+            // same ids as in the traced run, as long as this process has interned nothing else
+            uint32_t firstId, n;
+            ok = Get(f, firstId) && Get(f, n);
+            if (ok && firstId != PathCodec::GetNumPaths()) {
+                fclose(f);
+                return false;
+            }
+            for (uint32_t i = 0; ok && i < n; i++) {
+                uint16_t len;
+                ok = Get(f, len);
+                PathCodec::Ports ports(ok ? len : 0);
+                ok = ok && fread(ports.data(), sizeof(uint16_t), len, f) == len;
+                if (ok) PathCodec::Intern(ports);
+            }
+            continue;
+        }
+        Record r;
+        uint16_t len;
+        uint8_t nTags;
+        ok = Get(f, r.timeNs) && Get(f, r.size) && Get(f, len);
+        r.header.resize(len);
+        ok = ok && fread(r.header.data(), 1, len, f) == len && Get(f, nTags);
+        for (uint32_t i = 0; ok && i < nTags; i++) {
+            uint16_t type, n;
+            ok = Get(f, type) && Get(f, n);
+            r.tags.push_back(std::make_pair(type, std::vector<uint8_t>(n)));
+            ok = ok && fread(r.tags.back().second.data(), 1, n, f) == n;
+        }
+        if (ok) records.push_back(r);
+    }
+    fclose(f);
+    return true;
+}
+
+Ptr<Packet> RouteTracer::Rebuild(const Record& r, const std::vector<std::string>& tagNames,
+                                 CustomHeader& ch) {
+    Ptr<Packet> p = Create<Packet>(r.header.data(), r.header.size());
+    if (r.size > r.header.size()) p->AddPaddingAtEnd(r.size - r.header.size());
+    // the iterator went from the most recently added tag on: add them back oldest first, so that
+    // PeekPacketTag() finds the same one when a tag type is on the packet more than once
+    for (auto it = r.tags.rbegin(); it != r.tags.rend(); ++it) {
+        const std::pair<uint16_t, std::vector<uint8_t> >& t = *it;
+        TypeId tid;
+        if (t.first >= tagNames.size() || !TypeId::LookupByNameFailSafe(tagNames[t.first], &tid)) {
+            continue;  // tag type not registered in this build
+        }
+        Callback<ObjectBase*> ctor = tid.GetConstructor();
+        if (ctor.IsNull()) continue;  // registered without a constructor in this build
+        Tag* tag = dynamic_cast<Tag*>(ctor());
+        if (tag == NULL) continue;
+        std::vector<uint8_t> bytes(t.second);
+        TagBuffer tb(bytes.data(), bytes.data() + bytes.size());
+        tag->Deserialize(tb);
+        p->AddPacketTag(*tag);
+        delete tag;
+    }
+    ch = CustomHeader(CustomHeader::L2_Header | CustomHeader::L3_Header | CustomHeader::L4_Header);
+    ch.getInt = 1;
+    p->PeekHeader(ch);
+    return p;
+}
+
+}  // namespace ns3
@@ -0,0 +1,263 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CAVER-LB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "ns3/run-health.h"
+
+#include <assert.h>
+
+#include <algorithm>
+
+#include "ns3/broadcom-egress-queue.h"
+#include "ns3/qbb-net-device.h"
+#include "ns3/rdma-hw.h"
+#include "ns3/simulator.h"
+#include "ns3/switch-mmu.h"
+#include "ns3/switch-node.h"
+
+namespace ns3 {
+
+RunHealth::RunHealth()
+    : m_stallWindowNs(0),
+      m_deadlockWindowNs(0),
+      m_wallBudget(0),
+      m_started(false),
+      m_nowNs(0),
+      m_activeQps(0),
+      m_pausedPorts(0),
+      m_finishedFlows(0),
+      m_targetFlows(0),
+      m_goodputBytes(0),
+      m_lastProgressNs(0),
+      m_wallLast(0),
+      m_simNsLast(0),
+      m_eventsLast(0),
+      m_goodputLast(0),
+      m_simWallRatio(0),
+      m_eventsPerSec(0),
+      m_goodputGbps(0) {}
+
+void RunHealth::AddHost(Ptr<RdmaHw> hw) { m_hosts.push_back(hw); }
+
+void RunHealth::AddPort(Ptr<Node> node, uint32_t port, Ptr<Node> peer, uint32_t peerPort) {
+    Ptr<QbbNetDevice> dev = DynamicCast<QbbNetDevice>(node->GetDevice(port));
+    assert(dev != NULL);
+
+    Port p;
+    p.dev = dev;
+    p.node = node->GetId();
+    p.port = port;
+    p.peer = peer->GetId();
+    p.peerPort = peerPort;
+    p.isSwitch = node->GetNodeType() == 1;
+    if (p.isSwitch) {
+        p.mmu = DynamicCast<SwitchNode>(node)->m_mmu;
+        p.mmu->TrackInOutBytes();
+        if (m_nodePorts.size() <= p.node) m_nodePorts.resize(p.node + 1);
+        m_nodePorts[p.node].push_back(m_ports.size());
+    }
+    m_ports.push_back(p);
+}
+
+RunHealth::Verdict RunHealth::Sample(uint64_t finishedFlows, uint64_t targetFlows) {
+    Time now = Simulator::Now();
+    m_nowNs = now.GetTimeStep();
+    double wall = std::chrono::duration<double>(Clock::now() - m_wallStart).count();
+    if (!m_started) {
+        m_started = true;
+        m_wallStart = Clock::now();
+        wall = 0;
+        m_simNsLast = m_nowNs;
+        m_eventsLast = Simulator::GetEventCount();
+        m_goodputLast = RdmaHw::nGoodputBytes;
+        m_lastProgressNs = m_nowNs;
+    }
+
+    m_activeQps = 0;
+    for (auto& hw : m_hosts) m_activeQps += hw->m_qpMap.size();
+    m_pausedPorts = 0;
+    for (auto& p : m_ports) {
+        uint32_t mask = p.dev->GetPfcState().GetPausedMask();
+        for (; mask; mask &= mask - 1) m_pausedPorts++;
+    }
+    if (finishedFlows != m_finishedFlows || RdmaHw::nGoodputBytes != m_goodputBytes) {
+        m_lastProgressNs = m_nowNs;
+    }
+    m_finishedFlows = finishedFlows;
+    m_targetFlows = targetFlows;
+    m_goodputBytes = RdmaHw::nGoodputBytes;
+    m_cycle = m_pausedPorts > 1 ? FindPfcCycle(m_deadlockWindowNs) : std::vector<uint32_t>();
+
+    // status at most once per wall second, rates over that period
+    if (wall - m_wallLast >= 1.0 || m_wallLast == 0) {
+        double dt = std::max(wall - m_wallLast, 1e-9);
+        uint64_t events = Simulator::GetEventCount();
+        m_simWallRatio = (m_nowNs - m_simNsLast) * 1e-9 / dt;
+        m_eventsPerSec = (events - m_eventsLast) / dt;
+        m_goodputGbps = m_nowNs > m_simNsLast
+                            ? (m_goodputBytes - m_goodputLast) * 8.0 / (m_nowNs - m_simNsLast)
+                            : 0;
+        m_wallLast = std::max(wall, 1e-9);
+        m_simNsLast = m_nowNs;
+        m_eventsLast = events;
+        m_goodputLast = m_goodputBytes;
+        if (!m_statusFile.empty()) WriteStatus("running");
+    }
+
+    if (m_wallBudget > 0 && wall > m_wallBudget) return WALL_BUDGET;
+    if (m_deadlockWindowNs > 0 && !m_cycle.empty()) return DEADLOCK;
+    if (m_stallWindowNs > 0 && m_activeQps > 0 && m_nowNs - m_lastProgressNs >= m_stallWindowNs) {
+        return STALL;
+    }
+    return OK;
+}
+
+std::vector<uint32_t> RunHealth::FindPfcCycle(uint64_t minPausedNs) const {
+    // vertices: switch (port, q) paused for at least minPausedNs with data queued behind the PAUSE
+    Time now = Simulator::Now();
+    std::vector<uint8_t> color(m_ports.size() * PfcPortState::MAX_PRIO, 0);  // 0 none, 1 new, 2 on stack, 3 done
+    for (uint32_t i = 0; i < m_ports.size(); i++) {
+        const Port& p = m_ports[i];
+        if (!p.isSwitch) continue;
+        const PfcPortState& pfc = p.dev->GetPfcState();
+        for (uint32_t mask = pfc.GetPausedMask(); mask; mask &= mask - 1) {
+            uint32_t q = __builtin_ctz(mask);
+            if ((uint64_t)(now - pfc.GetPauseStart(q)).GetTimeStep() < minPausedNs) continue;
+            if (p.dev->GetQueue()->GetNBytes(q) == 0) continue;
+            color[i << 3 | q] = 1;
+        }
+    }
+
+    // iterative DFS, edges (port, q) -> (port of the peer switch, q) queuing bytes that came in
+    // over the link of (port, q), not back to the switch of (port, q)
+    struct Frame {
+        uint32_t v;
+        uint32_t next;  // index into the ports of the peer
+    };
+    std::vector<Frame> stack;
+    static const std::vector<uint32_t> none;
+    for (uint32_t root = 0; root < color.size(); root++) {
+        if (color[root] != 1) continue;
+        stack.push_back(Frame{root, 0});
+        color[root] = 2;
+        while (!stack.empty()) {
+            Frame& f = stack.back();
+            const Port& from = m_ports[f.v >> 3];
+            uint32_t q = f.v & 7;
+            const std::vector<uint32_t>& succ =
+                from.peer < m_nodePorts.size() ? m_nodePorts[from.peer] : none;
+            if (f.next == succ.size()) {
+                color[f.v] = 3;
+                stack.pop_back();
+                continue;
+            }
+            const Port& to = m_ports[succ[f.next]];
+            uint32_t w = succ[f.next++] << 3 | q;
+            if (to.peer == from.node || to.mmu->GetInOutBytes(from.peerPort, to.port, q) == 0) {
+                continue;
+            }
+            if (color[w] == 2) {  // back edge: the cycle is the stack from w
+                std::vector<uint32_t> cycle;
+                uint32_t k = stack.size();
+                while (stack[k - 1].v != w) k--;
+                for (k--; k < stack.size(); k++) cycle.push_back(stack[k].v);
+                return cycle;
+            }
+            if (color[w] == 1) {
+                color[w] = 2;
+                stack.push_back(Frame{w, 0});
+            }
+        }
+    }
+    return std::vector<uint32_t>();
+}
+
+const char* RunHealth::GetVerdictName(Verdict v) {
+    switch (v) {
+        case WALL_BUDGET:
+            return "wall-clock budget exceeded";
+        case STALL:
+            return "no goodput within the stall window";
+        case DEADLOCK:
+            return "PFC deadlock";
+        default:
+            return "ok";
+    }
+}
+
+void RunHealth::WriteState(FILE* fout, const char* state) const {
+    fprintf(fout, "state %s\n", state);
+    fprintf(fout, "sim_time_ns %lu\n", (uint64_t)Simulator::Now().GetTimeStep());
+    fprintf(fout, "wall_time_s %.1f\n", std::chrono::duration<double>(Clock::now() - m_wallStart).count());
+    fprintf(fout, "sim_wall_ratio %.3g\n", m_simWallRatio);
+    fprintf(fout, "events %lu\n", Simulator::GetEventCount());
+    fprintf(fout, "events_per_sec %.0f\n", m_eventsPerSec);
+    fprintf(fout, "active_qps %lu\n", m_activeQps);
+    fprintf(fout, "paused_ports %u\n", m_pausedPorts);
+    fprintf(fout, "finished_flows %lu/%lu\n", m_finishedFlows, m_targetFlows);
+    fprintf(fout, "goodput_gbps %.2f\n", m_goodputGbps);
+    fprintf(fout, "no_progress_ns %lu\n", m_nowNs - m_lastProgressNs);
+    fprintf(fout, "pfc_cycle %zu\n", m_cycle.size());
+}
+
+void RunHealth::WriteStatus(const char* state, bool withDump) {
+    std::string tmp = m_statusFile + ".tmp";
+    FILE* fout = fopen(tmp.c_str(), "w");
+    if (fout == NULL) return;
+    WriteState(fout, state);
+    if (withDump) WriteDump(fout);
+    fclose(fout);
+    rename(tmp.c_str(), m_statusFile.c_str());  // readers never see a partial file
+}
+
+void RunHealth::WriteDump(FILE* fout) const {
+    Time now = Simulator::Now();
+    fprintf(fout, "# PFC cycle (node port -> peer peerPort q queued_bytes paused_ns):\n");
+    for (uint32_t v : m_cycle) {
+        const Port& p = m_ports[v >> 3];
+        uint32_t q = v & 7;
+        fprintf(fout, "#   %u %u -> %u %u %u %u %lu\n", p.node, p.port, p.peer, p.peerPort, q,
+                p.dev->GetQueue()->GetNBytes(q), (uint64_t)(now - p.dev->GetPfcState().GetPauseStart(q)).GetTimeStep());
+    }
+
+    // longest PAUSEs first
+    std::vector<std::pair<uint64_t, uint32_t> > paused;
+    for (uint32_t i = 0; i < m_ports.size(); i++) {
+        const PfcPortState& pfc = m_ports[i].dev->GetPfcState();
+        for (uint32_t mask = pfc.GetPausedMask(); mask; mask &= mask - 1) {
+            uint32_t q = __builtin_ctz(mask);
+            paused.push_back(std::make_pair((now - pfc.GetPauseStart(q)).GetTimeStep(), i << 3 | q));
+        }
+    }
+    std::sort(paused.rbegin(), paused.rend());
+    fprintf(fout, "# paused ports (node port -> peer peerPort q queued_bytes paused_ns), %zu total:\n", paused.size());
+    for (uint32_t k = 0; k < paused.size() && k < 32; k++) {
+        const Port& p = m_ports[paused[k].second >> 3];
+        uint32_t q = paused[k].second & 7;
+        fprintf(fout, "#   %u %u -> %u %u %u %u %lu\n", p.node, p.port, p.peer, p.peerPort, q,
+                p.dev->GetQueue()->GetNBytes(q), paused[k].first);
+    }
+}
+
+}  // namespace ns3
@@ -192,73 +192,9 @@ std::map<uint32_t, std::vector<uint32_t>>Settings::TorSwitch_nodelist;
 
 std::map<Ptr<Node>, std::map<uint32_t, uint32_t> > Settings::if2id;
 
-std::unordered_map<uint64_t, std::unordered_map<uint32_t, Time>> Settings::flowRecorder;
-std::unordered_map<uint64_t, Settings::LinkRecord> Settings::linkRecorder; 
-void Settings::record_flow_distribution(Ptr<Packet> p, CustomHeader &ch, Ptr<Node> srcNode, uint32_t outDev) {
-    return;
-    if (ch.l3Prot != 0x11) {
-        return;
-    }
-    uint32_t srcId = srcNode->GetId();
-    uint32_t dstId = Settings::if2id[srcNode][outDev];
-    uint64_t linkKey = (static_cast<uint64_t>(srcId) << 32) | static_cast<uint64_t>(dstId);
-    if (dstId == Settings::hostIp2IdMap[ch.dip]) {
-        return;
-    }
-    uint32_t flowId = Settings::PacketId2FlowId[std::make_tuple(Settings::hostIp2IdMap[ch.sip], Settings::hostIp2IdMap[ch.dip], ch.udp.sport, ch.udp.dport)];
-    //printf("[%ld]%u -> %u, Flow:%u, Seq:%u\n", Simulator::Now().GetNanoSeconds(), srcId, dstId, flowId, ch.udp.seq);
-    //flowRecorder[linkKey][flowId] = Simulator::Now();
-    linkRecorder[linkKey].total_size += p->GetSize();
-    linkRecorder[linkKey].flowRecorder.emplace(flowId, ch.udp.seq);
-    linkRecorder[linkKey].flowRecorder[flowId].seq_end = ch.udp.seq + p->GetSize() - ch.GetSerializedSize();
-}
-
 uint32_t Settings::dropped_flow_id = -1;
 
 
-void Settings::print_flow_distribution(FILE *out, Time nextTime) {
-    return;
-    for (auto& [linkKey, linkRecord] : linkRecorder) {
-        uint32_t srcId = static_cast<uint32_t>(linkKey >> 32);
-        uint32_t dstId = static_cast<uint32_t>(linkKey & 0xFFFFFFFF);
-        fprintf(out, "%ld#%u->%u:%u#", Simulator::Now().GetNanoSeconds(), srcId, dstId, linkRecord.total_size);
-        for (auto& [flowId, flowRecord] : linkRecord.flowRecorder) {
-            fprintf(out, "%u:%u-%u, ", flowId, flowRecord.seq_start, flowRecord.seq_end);
-        }
-        fprintf(out, "\n");
-    }
-    fprintf(out, "\n");
-    linkRecorder.clear();
-    /*fprintf(out, "#####Time[%ld]#####\n", Simulator::Now().GetNanoSeconds());
-
-    for (auto linkEntry = flowRecorder.begin(); linkEntry != flowRecorder.end(); ++linkEntry) {
-        uint64_t linkKey = linkEntry->first;
-        auto& flowMap = linkEntry->second;
-        uint32_t srcId = static_cast<uint32_t>(linkKey >> 32);
-        uint32_t dstId = static_cast<uint32_t>(linkKey & 0xFFFFFFFF);
-        //去除不活跃的流
-        for (auto flowEntry = flowMap.begin(); flowEntry != flowMap.end();) {
-            Time flowTime = flowEntry->second;
-            if (Simulator::Now() - flowTime > nextTime) {
-                flowEntry = flowMap.erase(flowEntry); 
-                continue;
-            }
-            ++flowEntry;
-        }
-
-        fprintf(out, "Link: srcId=%u, dstId=%u, flowNum=%zu, active flow:", srcId, dstId, flowMap.size());
-
-        for (auto flowEntry = flowMap.begin(); flowEntry != flowMap.end();) {
-            uint32_t flowId = flowEntry->first;
-            fprintf(out, "%d, ", flowId);
-            ++flowEntry;
-        }
-        fprintf(out, "\n");
-    }
-    fprintf(out, "\n");*/
-    Simulator::Schedule(nextTime, &Settings::print_flow_distribution, out, nextTime);
-}
-
 // 辅助函数：计算路径的PathCE
 uint32_t Settings::calculatePathCE(const std::vector<uint32_t>& path) {
     uint32_t maxCE = 0;
@@ -380,6 +316,15 @@ void Settings::writeCEMapSnapshot(FILE* ofs) {
     }
     fprintf(ofs, "]\n");
 }
+void Settings::ReportMemory(MemoryAccounting::Report& report) {
+    report.Add("settings.PacketId2FlowId", PacketId2FlowId.size(), MemoryAccounting::HashBytes(PacketId2FlowId));
+    report.Add("settings.flow_maps",
+               flowId2SrcDst.size() + flowId2Port2Src.size() + QPPair_info2FlowId.size() + FlowId2SrcId.size() +
+                   FlowId2Length.size(),
+               MemoryAccounting::HashBytes(flowId2SrcDst) + MemoryAccounting::HashBytes(flowId2Port2Src) +
+                   MemoryAccounting::TreeBytes(QPPair_info2FlowId) + MemoryAccounting::HashBytes(FlowId2SrcId) +
+                   MemoryAccounting::HashBytes(FlowId2Length));
+}
 void Settings::read_static_path(std::string path){
     std::ifstream infile(path);
     if (!infile.is_open()) {
@@ -24,6 +24,7 @@
 #include "ns3/custom-header.h"
 #include "ns3/double.h"
 #include "ns3/ipv4-address.h"
+#include "ns3/memory-accounting.h"
 #include "ns3/net-device.h"
 #include "ns3/nstime.h"
 #include "ns3/object.h"
@@ -156,6 +157,7 @@ class Settings {
     static void SetCaverQuantizeBit(uint32_t quantizeBit);//设置Caver的量化位数
     static void SetCaverAlpha(double alpha);//设置Caver的alpha值
     static void ShowInit();//显示初始化的信息
+    static void ReportMemory(MemoryAccounting::Report& report);//全局的流表（PacketId2FlowId 等）的内存占用
     virtual ~Settings() {}
 
     /* helper function */
@@ -240,26 +242,8 @@ class Settings {
     static bool set_fixed_routing;//选择固定的路由；
     static void read_static_path(std::string path);//读取固定的路由表
     static std::vector<std::vector<uint32_t>> static_paths;
-    
-    static void record_flow_distribution(Ptr<Packet> p, CustomHeader &ch, Ptr<Node> srcNode, uint32_t outDev);
-    static void print_flow_distribution(FILE *out, Time nextTime);
 
     static uint32_t dropped_flow_id;
-
-   private:
-    
-    static std::unordered_map<uint64_t, std::unordered_map<uint32_t, Time>> flowRecorder; //(src,dst)->(flow_id, active_time)
-    struct LinkRecord {
-        uint32_t total_size=0;
-        struct FlowRecord {
-            uint32_t seq_start;
-            uint32_t seq_end;
-            FlowRecord(uint32_t seq): seq_start(seq), seq_end(seq) {};
-            FlowRecord() = default;
-        };
-        std::unordered_map<uint32_t, FlowRecord> flowRecorder;
-    };
-    static std::unordered_map<uint64_t, struct LinkRecord> linkRecorder; 
 };
 
 }  // namespace ns3
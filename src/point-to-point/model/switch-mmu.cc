@@ -77,20 +77,31 @@ void SwitchMmu::InitSwitch(void) {
         m_port_max_shared_cell = 4800 * MTU;  // max buffer for an ingress port
     }
 
-    for (uint32_t i = 0; i < pCnt; i++)  // port 0 is not used
-    {
-        m_usedIngressPortBytes[i] = 0;
-        m_usedEgressPortBytes[i] = 0;
-        for (uint32_t j = 0; j < qCnt; j++) {
-            m_usedIngressPGBytes[i][j] = 0;
-            m_usedIngressPGHeadroomBytes[i][j] = 0;
-            m_usedEgressQMinBytes[i][j] = 0;
-            m_usedEgressQSharedBytes[i][j] = 0;
-        }
-    }
+    // per-port state for ports 0..m_activePortCnt (port 0 is not used); configured values
+    // are kept when resizing, new ports take the headroom of port 0
+    uint32_t nPort = m_activePortCnt + 1;
+    kmin.resize(nPort, 0);
+    kmax.resize(nPort, 0);
+    pmax.resize(nPort, 0);
+    m_pg_hdrm_limit.resize(nPort, m_pg_hdrm_limit.empty() ? 0 : m_pg_hdrm_limit[0]);
+    paused.resize(nPort * qCnt, 0);
+    resumeEvt.resize(nPort * qCnt);
+    m_pause_remote.resize(nPort * qCnt, 0);
+
+    m_usedIngressPortBytes.assign(nPort, 0);
+    m_usedEgressPortBytes.assign(nPort, 0);
+    m_usedIngressPGBytes.assign(nPort * qCnt, 0);
+    m_usedIngressPGHeadroomBytes.assign(nPort * qCnt, 0);
+    m_usedEgressQMinBytes.assign(nPort * qCnt, 0);
+    m_usedEgressQSharedBytes.assign(nPort * qCnt, 0);
+    m_fluidIngressPGBytes.assign(nPort * qCnt, 0);
+    m_fluidIngressPortBytes.assign(nPort, 0);
+    m_fluidEgressQBytes.assign(nPort * qCnt, 0);
+    if (m_trackInOut) m_inOutBytes.assign(nPort * nPort * qCnt, 0);
     for (int i = 0; i < 4; i++) {
         m_usedIngressSPBytes[i] = 0;
         m_usedEgressSPBytes[i] = 0;
+        m_fluidIngressSPBytes[i] = 0;
     }
     // ingress params
     m_buffer_cell_limit_sp = 4000 * MTU;  // ingress sp buffer threshold
@@ -145,21 +156,21 @@ bool SwitchMmu::CheckIngressAdmission(uint32_t port, uint32_t qIndex, uint32_t p
         std::cerr << "WARNING: Drop because ingress buffer full\n";
         return false;
     }
-    if (m_usedIngressPGBytes[port][qIndex] + psize > m_pg_min_cell &&
+    if (m_usedIngressPGBytes[PortQ(port, qIndex)] + psize > m_pg_min_cell &&
         m_usedIngressPortBytes[port] + psize >
             m_port_min_cell)  // exceed guaranteed, use share buffer
     {
         if (m_usedIngressSPBytes[GetIngressSP(port, qIndex)] >
             m_buffer_cell_limit_sp)  // check if headroom is already being used
         {
-            if (m_usedIngressPGHeadroomBytes[port][qIndex] + psize >
+            if (m_usedIngressPGHeadroomBytes[PortQ(port, qIndex)] + psize >
                 m_pg_hdrm_limit[port])  // exceed headroom space
             {
                 std::cout << "pfc event:" << std::endl;
                 if (m_PFCenabled) {
                     std::cerr << "WARNING: Drop because ingress headroom full:"
-                              << m_usedIngressPGHeadroomBytes[port][qIndex] << "\t"
-                              << m_pg_hdrm_limit << "\n";
+                              << m_usedIngressPGHeadroomBytes[PortQ(port, qIndex)] << "\t"
+                              << m_pg_hdrm_limit[port] << "\n";
                 }
                 return false;
             }
@@ -186,7 +197,7 @@ bool SwitchMmu::CheckEgressAdmission(uint32_t port, uint32_t qIndex, uint32_t ps
                   << Simulator::Now() << std::endl;
         return false;
     }
-    if (m_usedEgressQSharedBytes[port][qIndex] + psize >
+    if (m_usedEgressQSharedBytes[PortQ(port, qIndex)] + psize >
         m_op_uc_port_config1_cell)  // exceed the queue limit
     {
         std::cerr << "WARNING: Drop because egress Q buffer full (exceed the queue limit), "
@@ -194,7 +205,7 @@ bool SwitchMmu::CheckEgressAdmission(uint32_t port, uint32_t qIndex, uint32_t ps
         return false;
     }
 
-    if ((double)m_usedEgressQSharedBytes[port][qIndex] + psize >
+    if ((double)m_usedEgressQSharedBytes[PortQ(port, qIndex)] + psize >
         m_pg_shared_alpha_cell_egress * ((double)m_op_buffer_shared_limit_cell -
                                          m_usedEgressSPBytes[GetEgressSP(port, qIndex)])) {
 // #if (SLB_DEBUG == true)
@@ -203,7 +214,7 @@ bool SwitchMmu::CheckEgressAdmission(uint32_t port, uint32_t qIndex, uint32_t ps
                   << ", Port:" << port
                   << ", Queue:" << qIndex
                   << ", QlenInfo:"
-                  << ((double)m_usedEgressQSharedBytes[port][qIndex] + psize) << " > "
+                  << ((double)m_usedEgressQSharedBytes[PortQ(port, qIndex)] + psize) << " > "
                   << (m_pg_shared_alpha_cell_egress * ((double)m_op_buffer_shared_limit_cell -
                   m_usedEgressSPBytes[GetEgressSP(port, qIndex)]))
                   << ". Natural if not using PFC"
@@ -218,18 +229,18 @@ void SwitchMmu::UpdateIngressAdmission(uint32_t port, uint32_t qIndex, uint32_t
     m_usedTotalBytes += psize;  // count total buffer usage
     m_usedIngressSPBytes[GetIngressSP(port, qIndex)] += psize;
     m_usedIngressPortBytes[port] += psize;
-    m_usedIngressPGBytes[port][qIndex] += psize;
+    m_usedIngressPGBytes[PortQ(port, qIndex)] += psize;
     if (m_usedIngressSPBytes[GetIngressSP(port, qIndex)] >
         m_buffer_cell_limit_sp)  // begin to use headroom buffer
     {
-        m_usedIngressPGHeadroomBytes[port][qIndex] += psize;
+        m_usedIngressPGHeadroomBytes[PortQ(port, qIndex)] += psize;
     }
 }
 
 void SwitchMmu::UpdateEgressAdmission(uint32_t port, uint32_t qIndex, uint32_t psize) {
-    if (m_usedEgressQMinBytes[port][qIndex] + psize < m_q_min_cell)  // guaranteed
+    if (m_usedEgressQMinBytes[PortQ(port, qIndex)] + psize < m_q_min_cell)  // guaranteed
     {
-        m_usedEgressQMinBytes[port][qIndex] += psize;
+        m_usedEgressQMinBytes[PortQ(port, qIndex)] += psize;
         m_usedEgressPortBytes[port] = m_usedEgressPortBytes[port] + psize;
         return;
     } else {
@@ -238,20 +249,20 @@ void SwitchMmu::UpdateEgressAdmission(uint32_t port, uint32_t qIndex, uint32_t p
         First, when there is left space in q_min_cell, and we should use remaining space in
         q_min_cell and add rest to the shared_pool Second, just adding to shared pool
         */
-        if (m_usedEgressQMinBytes[port][qIndex] != m_q_min_cell) {
-            m_usedEgressQSharedBytes[port][qIndex] = m_usedEgressQSharedBytes[port][qIndex] +
-                                                     psize + m_usedEgressQMinBytes[port][qIndex] -
+        if (m_usedEgressQMinBytes[PortQ(port, qIndex)] != m_q_min_cell) {
+            m_usedEgressQSharedBytes[PortQ(port, qIndex)] = m_usedEgressQSharedBytes[PortQ(port, qIndex)] +
+                                                     psize + m_usedEgressQMinBytes[PortQ(port, qIndex)] -
                                                      m_q_min_cell;
             m_usedEgressPortBytes[port] =
                 m_usedEgressPortBytes[port] +
-                psize;  //+ m_usedEgressQMinBytes[port][qIndex] - m_q_min_cell ;
+                psize;  //+ m_usedEgressQMinBytes[PortQ(port, qIndex)] - m_q_min_cell ;
             m_usedEgressSPBytes[GetEgressSP(port, qIndex)] =
                 m_usedEgressSPBytes[GetEgressSP(port, qIndex)] + psize +
-                m_usedEgressQMinBytes[port][qIndex] - m_q_min_cell;
-            m_usedEgressQMinBytes[port][qIndex] = m_q_min_cell;
+                m_usedEgressQMinBytes[PortQ(port, qIndex)] - m_q_min_cell;
+            m_usedEgressQMinBytes[PortQ(port, qIndex)] = m_q_min_cell;
 
         } else {
-            m_usedEgressQSharedBytes[port][qIndex] += psize;
+            m_usedEgressQSharedBytes[PortQ(port, qIndex)] += psize;
             m_usedEgressPortBytes[port] += psize;
             m_usedEgressSPBytes[GetEgressSP(port, qIndex)] += psize;
         }
@@ -274,27 +285,27 @@ void SwitchMmu::RemoveFromIngressAdmission(uint32_t port, uint32_t qIndex, uint3
         m_usedIngressPortBytes[port] = psize;
         std::cerr << "Warning : Illegal Remove" << std::endl;
     }
-    if (m_usedIngressPGBytes[port][qIndex] < psize) {
-        m_usedIngressPGBytes[port][qIndex] = psize;
+    if (m_usedIngressPGBytes[PortQ(port, qIndex)] < psize) {
+        m_usedIngressPGBytes[PortQ(port, qIndex)] = psize;
         std::cerr << "Warning : Illegal Remove" << std::endl;
     }
     m_usedTotalBytes -= psize;
     m_usedIngressSPBytes[GetIngressSP(port, qIndex)] -= psize;
     m_usedIngressPortBytes[port] -= psize;
-    m_usedIngressPGBytes[port][qIndex] -= psize;
-    if ((double)m_usedIngressPGHeadroomBytes[port][qIndex] - psize > 0)
-        m_usedIngressPGHeadroomBytes[port][qIndex] -= psize;
+    m_usedIngressPGBytes[PortQ(port, qIndex)] -= psize;
+    if ((double)m_usedIngressPGHeadroomBytes[PortQ(port, qIndex)] - psize > 0)
+        m_usedIngressPGHeadroomBytes[PortQ(port, qIndex)] -= psize;
     else
-        m_usedIngressPGHeadroomBytes[port][qIndex] = 0;
+        m_usedIngressPGHeadroomBytes[PortQ(port, qIndex)] = 0;
 }
 void SwitchMmu::RemoveFromEgressAdmission(uint32_t port, uint32_t qIndex, uint32_t psize) {
-    //维护m_usedEgressQMinBytes[port][qIndex], m_usedEgressQSharedBytes[port][qIndex], m_usedEgressSPBytes
-    if (m_usedEgressQMinBytes[port][qIndex] < m_q_min_cell)  // guaranteed
+    //维护m_usedEgressQMinBytes[PortQ(port, qIndex)], m_usedEgressQSharedBytes[PortQ(port, qIndex)], m_usedEgressSPBytes
+    if (m_usedEgressQMinBytes[PortQ(port, qIndex)] < m_q_min_cell)  // guaranteed
     {
-        if (m_usedEgressQMinBytes[port][qIndex] < psize) {
+        if (m_usedEgressQMinBytes[PortQ(port, qIndex)] < psize) {
             std::cerr << "STOP overflow\n";
         }
-        m_usedEgressQMinBytes[port][qIndex] -= psize;
+        m_usedEgressQMinBytes[PortQ(port, qIndex)] -= psize;
         m_usedEgressPortBytes[port] -= psize;
         return;
     } else {
@@ -305,26 +316,26 @@ void SwitchMmu::RemoveFromEgressAdmission(uint32_t port, uint32_t qIndex, uint32
         */
 
         // first case
-        if (m_usedEgressQMinBytes[port][qIndex] == m_q_min_cell &&
-            m_usedEgressQSharedBytes[port][qIndex] < psize) {
-            m_usedEgressQMinBytes[port][qIndex] = m_usedEgressQMinBytes[port][qIndex] +
-                                                  m_usedEgressQSharedBytes[port][qIndex] - psize;
+        if (m_usedEgressQMinBytes[PortQ(port, qIndex)] == m_q_min_cell &&
+            m_usedEgressQSharedBytes[PortQ(port, qIndex)] < psize) {
+            m_usedEgressQMinBytes[PortQ(port, qIndex)] = m_usedEgressQMinBytes[PortQ(port, qIndex)] +
+                                                  m_usedEgressQSharedBytes[PortQ(port, qIndex)] - psize;
             m_usedEgressSPBytes[GetEgressSP(port, qIndex)] =
                 m_usedEgressSPBytes[GetEgressSP(port, qIndex)] -
-                m_usedEgressQSharedBytes[port][qIndex];
-            m_usedEgressQSharedBytes[port][qIndex] = 0;
+                m_usedEgressQSharedBytes[PortQ(port, qIndex)];
+            m_usedEgressQSharedBytes[PortQ(port, qIndex)] = 0;
             if (m_usedEgressPortBytes[port] < psize) {
                 std::cerr << "STOP overflow\n";
             }
             m_usedEgressPortBytes[port] -= psize;
 
         } else {
-            if (m_usedEgressQSharedBytes[port][qIndex] < psize ||
+            if (m_usedEgressQSharedBytes[PortQ(port, qIndex)] < psize ||
                 m_usedEgressPortBytes[port] < psize ||
                 m_usedEgressSPBytes[GetEgressSP(port, qIndex)] < psize) {
                 std::cerr << "STOP overflow\n";
             }
-            m_usedEgressQSharedBytes[port][qIndex] -= psize;
+            m_usedEgressQSharedBytes[PortQ(port, qIndex)] -= psize;
             m_usedEgressPortBytes[port] -= psize;
             m_usedEgressSPBytes[GetEgressSP(port, qIndex)] -= psize;
         }
@@ -340,23 +351,24 @@ void SwitchMmu::GetPauseClasses(uint32_t port, uint32_t qIndex, bool pClasses[])
     if (m_dynamicth) {
         for (uint32_t i = 0; i < qCnt; i++) {
             pClasses[i] = false;
-            if (m_usedIngressPGBytes[port][i] <= m_pg_min_cell + m_port_min_cell) continue;
+            if (IngressPGBytes(port, i) <= m_pg_min_cell + m_port_min_cell) continue;
 
-            // std::cerr << "BCM : Used=" << m_usedIngressPGBytes[port][i] << ", thresh=" <<
+            // std::cerr << "BCM : Used=" << m_usedIngressPGBytes[PortQ(port, i)] << ", thresh=" <<
             // m_pg_shared_alpha_cell*((double)m_buffer_cell_limit_sp -
             // m_usedIngressSPBytes[GetIngressSP(port, qIndex)]) + m_pg_min_cell+m_port_min_cell <<
             // std::endl;
 
-            if ((double)m_usedIngressPGBytes[port][i] - m_pg_min_cell - m_port_min_cell >
+            if ((double)IngressPGBytes(port, i) - m_pg_min_cell - m_port_min_cell >
                     m_pg_shared_alpha_cell * ((double)m_buffer_cell_limit_sp -
-                                              m_usedIngressSPBytes[GetIngressSP(port, qIndex)]) ||
-                m_usedIngressPGHeadroomBytes[port][qIndex] != 0) {
+                                              IngressSPBytes(GetIngressSP(port, qIndex))) ||
+                m_usedIngressPGHeadroomBytes[PortQ(port, qIndex)] != 0) {
                 pClasses[i] = true;
             }
             // std:: cout << "threold:" << m_pg_min_cell + m_port_min_cell+m_pg_shared_alpha_cell * ((double)m_buffer_cell_limit_sp -m_usedIngressSPBytes[GetIngressSP(port, qIndex)]) << std::endl;
         }
     } else {
-        if (m_usedIngressPortBytes[port] > m_port_max_shared_cell)  // pause the whole port
+        if (m_usedIngressPortBytes[port] + m_fluidIngressPortBytes[port] >
+            m_port_max_shared_cell)  // pause the whole port
         {
             for (uint32_t i = 0; i < qCnt; i++) {
                 pClasses[i] = true;
@@ -368,8 +380,8 @@ void SwitchMmu::GetPauseClasses(uint32_t port, uint32_t qIndex, bool pClasses[])
                 pClasses[i] = false;
             }
         }
-        std::cout << "m_usedIngressPGBytes[port][qIndex]:" << m_usedIngressPGBytes[port][qIndex] << ",m_pg_shared_limit_cell" << m_pg_shared_limit_cell<< std::endl;
-        if (m_usedIngressPGBytes[port][qIndex] > m_pg_shared_limit_cell) {
+        std::cout << "m_usedIngressPGBytes[PortQ(port, qIndex)]:" << m_usedIngressPGBytes[PortQ(port, qIndex)] << ",m_pg_shared_limit_cell" << m_pg_shared_limit_cell<< std::endl;
+        if (IngressPGBytes(port, qIndex) > m_pg_shared_limit_cell) {
             pClasses[qIndex] = true;
             std:: cout << "Pause port:" << port << " qIndex:" << qIndex << std::endl;
         }
@@ -378,18 +390,18 @@ void SwitchMmu::GetPauseClasses(uint32_t port, uint32_t qIndex, bool pClasses[])
 }
 
 bool SwitchMmu::GetResumeClasses(uint32_t port, uint32_t qIndex) {
-    if (!paused[port][qIndex]) return false;
+    if (!paused[PortQ(port, qIndex)]) return false;
     if (m_dynamicth) {
-        if ((double)m_usedIngressPGBytes[port][qIndex] - m_pg_min_cell - m_port_min_cell <
+        if ((double)IngressPGBytes(port, qIndex) - m_pg_min_cell - m_port_min_cell <
                 m_pg_shared_alpha_cell * ((double)m_buffer_cell_limit_sp -
-                                          m_usedIngressSPBytes[GetIngressSP(port, qIndex)] -
+                                          IngressSPBytes(GetIngressSP(port, qIndex)) -
                                           m_pg_shared_alpha_cell_off_diff) &&
-            m_usedIngressPGHeadroomBytes[port][qIndex] == 0) {
+            m_usedIngressPGHeadroomBytes[PortQ(port, qIndex)] == 0) {
             return true;
         }
     } else {
-        if (m_usedIngressPGBytes[port][qIndex] < m_pg_shared_limit_cell_off &&
-            m_usedIngressPortBytes[port] < m_port_min_cell_off) {
+        if (IngressPGBytes(port, qIndex) < m_pg_shared_limit_cell_off &&
+            m_usedIngressPortBytes[port] + m_fluidIngressPortBytes[port] < m_port_min_cell_off) {
             return true;
         }
     }
@@ -417,7 +429,7 @@ uint32_t SwitchMmu::GetusedIngressSPBytes(){
 
 }
 uint32_t SwitchMmu::GetusedEgressQSharedBytes(uint32_t port, uint32_t qIndex){
-    return m_usedEgressQSharedBytes[port][qIndex];
+    return m_usedEgressQSharedBytes[PortQ(port, qIndex)];
 
 }
 
@@ -425,17 +437,35 @@ bool SwitchMmu::ShouldSendCN(uint32_t ifindex, uint32_t qIndex) {
     if (qIndex == 0)  // qidx=0 as highest priority
         return false;
 
-    if (m_usedEgressQSharedBytes[ifindex][qIndex] > kmax[ifindex]) {
+    uint32_t used = m_usedEgressQSharedBytes[PortQ(ifindex, qIndex)] +
+                    m_fluidEgressQBytes[PortQ(ifindex, qIndex)];
+    if (used > kmax[ifindex]) {
         return true;
-    } else if (m_usedEgressQSharedBytes[ifindex][qIndex] > kmin[ifindex] &&
-               kmin[ifindex] != kmax[ifindex]) {
-        double p = 1.0 * (m_usedEgressQSharedBytes[ifindex][qIndex] - kmin[ifindex]) /
+    } else if (used > kmin[ifindex] && kmin[ifindex] != kmax[ifindex]) {
+        double p = 1.0 * (used - kmin[ifindex]) /
                    (kmax[ifindex] - kmin[ifindex]) * pmax[ifindex];
         if (m_uniform_random_var.GetValue(0, 1) < p) return true;
     }
     return false;
 }
 
+void SwitchMmu::AddFluidBytes(uint32_t inPort, uint32_t outPort, uint32_t qIndex, uint32_t bytes) {
+    m_fluidIngressPGBytes[PortQ(inPort, qIndex)] += bytes;
+    m_fluidIngressPortBytes[inPort] += bytes;
+    m_fluidIngressSPBytes[GetIngressSP(inPort, qIndex)] += bytes;
+    m_fluidEgressQBytes[PortQ(outPort, qIndex)] += bytes;
+    UpdateInOutBytes(inPort, outPort, qIndex, bytes);
+}
+
+void SwitchMmu::RemoveFluidBytes(uint32_t inPort, uint32_t outPort, uint32_t qIndex, uint32_t bytes) {
+    NS_ASSERT(m_fluidEgressQBytes[PortQ(outPort, qIndex)] >= bytes);
+    m_fluidIngressPGBytes[PortQ(inPort, qIndex)] -= bytes;
+    m_fluidIngressPortBytes[inPort] -= bytes;
+    m_fluidIngressSPBytes[GetIngressSP(inPort, qIndex)] -= bytes;
+    m_fluidEgressQBytes[PortQ(outPort, qIndex)] -= bytes;
+    RemoveInOutBytes(inPort, outPort, qIndex, bytes);
+}
+
 void SwitchMmu::SetBroadcomParams(
     uint32_t buffer_cell_limit_sp,  // ingress sp buffer threshold p.120
     uint32_t
@@ -457,7 +487,7 @@ void SwitchMmu::SetBroadcomParams(
     m_port_min_cell = port_min_cell;
     m_pg_shared_limit_cell = pg_shared_limit_cell;
     m_port_max_shared_cell = port_max_shared_cell;
-    for (int i = 0; i < pCnt; i++) m_pg_hdrm_limit[i] = pg_hdrm_limit;
+    m_pg_hdrm_limit.assign(m_pg_hdrm_limit.size(), pg_hdrm_limit);
     m_port_max_pkt_size = port_max_pkt_size;
     m_q_min_cell = q_min_cell;
     m_op_uc_port_config1_cell = op_uc_port_config1_cell;
@@ -476,23 +506,25 @@ void SwitchMmu::SetDynamicThreshold(bool v) {
 }
 
 void SwitchMmu::ConfigEcn(uint32_t port, uint32_t _kmin, uint32_t _kmax, double _pmax) {
+    NS_ASSERT_MSG(port < kmin.size(), "ConfigEcn: port " << port << " beyond ConfigNPort");
     kmin[port] = _kmin * 1000;
     kmax[port] = _kmax * 1000;
     pmax[port] = _pmax;
 }
 
 void SwitchMmu::SetPause(uint32_t port, uint32_t qIndex, uint32_t pause_time) {
-    paused[port][qIndex] = true;
-    Simulator::Cancel(resumeEvt[port][qIndex]);
-    resumeEvt[port][qIndex] =
+    paused[PortQ(port, qIndex)] = true;
+    Simulator::Cancel(resumeEvt[PortQ(port, qIndex)]);
+    resumeEvt[PortQ(port, qIndex)] =
         Simulator::Schedule(MicroSeconds(pause_time), &SwitchMmu::SetResume, this, port, qIndex);
 }
 void SwitchMmu::SetResume(uint32_t port, uint32_t qIndex) {
-    paused[port][qIndex] = false;
-    Simulator::Cancel(resumeEvt[port][qIndex]);
+    paused[PortQ(port, qIndex)] = false;
+    Simulator::Cancel(resumeEvt[PortQ(port, qIndex)]);
 }
 
 void SwitchMmu::ConfigHdrm(uint32_t port, uint32_t size) {
+    NS_ASSERT_MSG(port < m_pg_hdrm_limit.size(), "ConfigHdrm: port " << port << " beyond ConfigNPort");
     m_pg_hdrm_limit[port] = size;
     InitSwitch();
 }
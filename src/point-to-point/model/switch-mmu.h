@@ -2,20 +2,14 @@
 #define SWITCH_MMU_H
 
 #include <ns3/node.h>
+#include <ns3/event-id.h>
 #include <ns3/random-variable-stream.h>
 
 #include <list>
 #include <unordered_map>
+#include <vector>
 
-#include "ns3/conga-routing.h"
-#include "ns3/conweave-routing.h"
-#include "ns3/letflow-routing.h"
 #include "ns3/settings.h"
-#include "ns3/dv-routing.h"
-#include "ns3/caver-routing.h"
-#include "ns3/hula-routing.h"
-#include "ns3/dv-routing.h"
-#include "ns3/noshare-routing.h"
 
 
 namespace ns3 {
@@ -25,9 +19,11 @@ class Packet;
 class SwitchMmu : public Object {
    public:
     static const unsigned qCnt = 8;    // Number of queues/priorities used
-    static const unsigned pCnt = 128;  // port 0 is not used so + 1	// Number of ports used
     static const unsigned MTU = 1048;  // 1000 + headers
 
+    /* index of (port, queue) in the flat per-queue arrays */
+    static uint32_t PortQ(uint32_t port, uint32_t qIndex) { return port * qCnt + qIndex; }
+
     static TypeId GetTypeId(void);
 
     SwitchMmu(void);
@@ -65,6 +61,33 @@ class SwitchMmu : public Object {
 
     bool ShouldSendCN(uint32_t ifindex, uint32_t qIndex);
 
+    /**
+     * 混合模式（FluidModel）：从 inPort 进入、排在 (outPort, qIndex) 的 fluid 流的虚拟占用。
+     * 不经过准入检查也不会被丢弃，只计入 ECN 标记和 PFC PAUSE/RESUME 的判断（和排队包的
+     * 字节一样），单独记账，不和包的计数混在一起。
+     */
+    void AddFluidBytes(uint32_t inPort, uint32_t outPort, uint32_t qIndex, uint32_t bytes);
+    void RemoveFluidBytes(uint32_t inPort, uint32_t outPort, uint32_t qIndex, uint32_t bytes);
+
+    /**
+     * 从 inPort 进入、排在 (outPort, qIndex) 的字节（包和 fluid），RunHealth 判断 PAUSE 依赖用。
+     * TrackInOutBytes() 之后才统计，每交换机 (端口数 + 1)^2 * qCnt 个计数。
+     */
+    void TrackInOutBytes() {
+        if (m_trackInOut) return;
+        m_trackInOut = true;
+        m_inOutBytes.assign((m_activePortCnt + 1) * (m_activePortCnt + 1) * qCnt, 0);
+    }
+    void UpdateInOutBytes(uint32_t inPort, uint32_t outPort, uint32_t qIndex, uint32_t psize) {
+        if (m_trackInOut) m_inOutBytes[InOutQ(inPort, outPort, qIndex)] += psize;
+    }
+    void RemoveInOutBytes(uint32_t inPort, uint32_t outPort, uint32_t qIndex, uint32_t psize) {
+        if (m_trackInOut) m_inOutBytes[InOutQ(inPort, outPort, qIndex)] -= psize;
+    }
+    uint32_t GetInOutBytes(uint32_t inPort, uint32_t outPort, uint32_t qIndex) const {
+        return m_trackInOut ? m_inOutBytes[InOutQ(inPort, outPort, qIndex)] : 0;
+    }
+
     uint32_t GetUsedBufferTotal();
 
     void SetDynamicThreshold(bool value);
@@ -76,7 +99,7 @@ class SwitchMmu : public Object {
     void ConfigBufferSize(uint32_t size);
 
     void ConfigHdrm(uint32_t port, uint32_t size);
-    void ConfigNPort(uint32_t n_port);
+    void ConfigNPort(uint32_t n_port);  // call before ConfigEcn / ConfigHdrm
 
     uint32_t GetIngressSP(uint32_t port, uint32_t pgIndex);
     uint32_t GetEgressSP(uint32_t port, uint32_t qIndex);
@@ -91,14 +114,16 @@ class SwitchMmu : public Object {
     // config
     uint32_t node_id;
 
-    uint32_t kmin[pCnt], kmax[pCnt];
-    double pmax[pCnt];
-    uint32_t paused[pCnt][qCnt];
-    EventId resumeEvt[pCnt][qCnt];
-    bool m_pause_remote[pCnt][qCnt];
-
-    uint32_t pfc_a_shift[pCnt];         // legacy: not used anymore
-    uint32_t egress_bytes[pCnt][qCnt];  // legacy: not used anymore
+    /**
+     * 每端口 / 每 (端口, 队列) 的状态按实际端口数（ActivePortCnt + 1，端口 0 不用）在
+     * InitSwitch 中分配，端口数没有上限；每个量各自一个连续数组（SoA），
+     * (端口, 队列) 数组按 PortQ(port, qIndex) 展平。
+     */
+    std::vector<uint32_t> kmin, kmax;
+    std::vector<double> pmax;
+    std::vector<uint8_t> paused;          // [PortQ]
+    std::vector<EventId> resumeEvt;       // [PortQ]
+    std::vector<uint8_t> m_pause_remote;  // [PortQ]
 
     uint32_t GetActivePortCnt(void) const { return m_activePortCnt; }
     void SetActivePortCnt(uint32_t v) {
@@ -115,26 +140,10 @@ class SwitchMmu : public Object {
 
     uint32_t GetPgHdrmLimit(void) const { return m_pg_hdrm_limit[0]; }
     void SetPgHdrmLimit(uint32_t v) {
-        for (int i = 0; i < pCnt; i++) m_pg_hdrm_limit[i] = v;
+        m_pg_hdrm_limit.assign(m_pg_hdrm_limit.size(), v);
         InitSwitch();
     }
 
-    /*------------ Conga Objects-------------*/
-    CongaRouting m_congaRouting;
-
-    /*------------ Letflow Objects-------------*/
-    LetflowRouting m_letflowRouting;
-
-    /*------------ ConWeave Objects-------------*/
-    ConWeaveRouting m_conweaveRouting;
-
-    /*------------ DVObjects-------------*/
-    DVRouting m_dvRouting;
-    
-    CaverRouting m_caverRouting;
-    HulaRouting m_hulaRouting;
-    NoshareRouting m_noshareRouting;
-
    private:
     bool m_PFCenabled;
 
@@ -145,16 +154,31 @@ class SwitchMmu : public Object {
     uint32_t m_maxBufferBytesPerPort{0};  // use this to calculate m_maxBufferBytes 每个端口的最大缓冲区大小
     uint32_t m_staticMaxBufferBytes{0};   // use this to calculate m_maxBufferBytes 静态配置的总缓冲区大小
 
-    uint32_t m_usedIngressPGBytes[pCnt][qCnt]; //每个端口/优先级组（PG）的入端口已用缓冲区字节数。
-    uint32_t m_usedIngressPortBytes[pCnt];     //每个端口的入端口已用缓冲区字节数。
-    uint32_t m_usedIngressSPBytes[4];          //服务池（Service Pool）的入端口已用缓冲区字节数。
-    uint32_t m_usedIngressPGHeadroomBytes[pCnt][qCnt];
+    std::vector<uint32_t> m_usedIngressPGBytes;   // [PortQ] 每个端口/优先级组（PG）的入端口已用缓冲区字节数。
+    std::vector<uint32_t> m_usedIngressPortBytes; //每个端口的入端口已用缓冲区字节数。
+    uint32_t m_usedIngressSPBytes[4];             //服务池（Service Pool）的入端口已用缓冲区字节数。
+    std::vector<uint32_t> m_usedIngressPGHeadroomBytes;  // [PortQ]
 
-    uint32_t m_usedEgressQMinBytes[pCnt][qCnt];
-    uint32_t m_usedEgressQSharedBytes[pCnt][qCnt];
-    uint32_t m_usedEgressPortBytes[pCnt];
+    std::vector<uint32_t> m_usedEgressQMinBytes;     // [PortQ]
+    std::vector<uint32_t> m_usedEgressQSharedBytes;  // [PortQ]
+    std::vector<uint32_t> m_usedEgressPortBytes;
     uint32_t m_usedEgressSPBytes[4];
 
+    // fluid occupancy (AddFluidBytes), added to the packet counters where PFC and ECN decide
+    std::vector<uint32_t> m_fluidIngressPGBytes;  // [PortQ]
+    std::vector<uint32_t> m_fluidIngressPortBytes;
+    std::vector<uint32_t> m_fluidEgressQBytes;    // [PortQ]
+    uint32_t m_fluidIngressSPBytes[4];
+    bool m_trackInOut{false};
+    std::vector<uint32_t> m_inOutBytes;  // [InOutQ], empty unless m_trackInOut
+    uint32_t InOutQ(uint32_t inPort, uint32_t outPort, uint32_t qIndex) const {
+        return PortQ(inPort * (m_activePortCnt + 1) + outPort, qIndex);
+    }
+    uint32_t IngressPGBytes(uint32_t port, uint32_t qIndex) const {
+        return m_usedIngressPGBytes[PortQ(port, qIndex)] + m_fluidIngressPGBytes[PortQ(port, qIndex)];
+    }
+    uint32_t IngressSPBytes(uint32_t sp) const { return m_usedIngressSPBytes[sp] + m_fluidIngressSPBytes[sp]; }
+
     // ingress params
     uint32_t m_buffer_cell_limit_sp;  // ingress sp buffer threshold p.120
     uint32_t
@@ -163,7 +187,7 @@ class SwitchMmu : public Object {
     uint32_t m_port_min_cell;           // ingress port guarantee
     uint32_t m_pg_shared_limit_cell;    // max buffer for an ingress pg
     uint32_t m_port_max_shared_cell;    // max buffer for an ingress port
-    uint32_t m_pg_hdrm_limit[pCnt];     // ingress pg headroom
+    std::vector<uint32_t> m_pg_hdrm_limit;  // ingress pg headroom
     uint32_t m_port_max_pkt_size;       // ingress global headroom
     // still needs reset limits..
     uint32_t m_port_min_cell_off;  // PAUSE off threshold
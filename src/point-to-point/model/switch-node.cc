@@ -2,15 +2,22 @@
 
 #include "assert.h"
 #include "ns3/boolean.h"
+#include "ns3/caver-routing.h"
 #include "ns3/conweave-routing.h"
 #include "ns3/double.h"
+#include "ns3/dv-routing.h"
+#include "ns3/flow-id-num-tag.h"
 #include "ns3/flow-id-tag.h"
+#include "ns3/hula-routing.h"
 #include "ns3/int-header.h"
 #include "ns3/ipv4-header.h"
 #include "ns3/ipv4.h"
-#include "ns3/letflow-routing.h"
+#include "ns3/noshare-routing.h"
 #include "ns3/packet.h"
+#include "ns3/path-tracer.h"
 #include "ns3/pause-header.h"
+#include "ns3/reorder-analytics.h"
+#include "ns3/route-tracer.h"
 #include "ns3/settings.h"
 #include "ns3/uinteger.h"
 #include "ppp-header.h"
@@ -37,7 +44,9 @@ TypeId SwitchNode::GetTypeId(void) {
     return tid;
 }
 
-SwitchNode::SwitchNode() {
+SwitchNode::SwitchNode() : SwitchNode(0) {}
+
+SwitchNode::SwitchNode(uint32_t systemId) : Node(systemId) {
     std::random_device rd;
     std::mt19937 gen(rd());
     std::uniform_int_distribution<uint32_t> dis(0, std::numeric_limits<uint32_t>::max());
@@ -50,48 +59,24 @@ SwitchNode::SwitchNode() {
     m_isToR = false;
     m_node_type = 1;
     m_isToR = false;
-    m_drill_candidate = 2;
     m_mmu = CreateObject<SwitchMmu>();
-    
-    // //DV's Callback for switch functions
-    // m_mmu->m_dvRouting.SetSwitchSendCallback(MakeCallback(&SwitchNode::DoSwitchSend, this));
-    // m_mmu->m_dvRouting.SetSwitchSendToDevCallback(
-    //     MakeCallback(&SwitchNode::SendToDevContinue, this));
-
-
-    // Conga's Callback for switch functions
-    m_mmu->m_congaRouting.SetSwitchSendCallback(MakeCallback(&SwitchNode::DoSwitchSend, this));
-    m_mmu->m_congaRouting.SetSwitchSendToDevCallback(
-        MakeCallback(&SwitchNode::SendToDevContinue, this));
-    // ConWeave's Callback for switch functions
-    m_mmu->m_conweaveRouting.SetSwitchSendCallback(MakeCallback(&SwitchNode::DoSwitchSend, this));
-    m_mmu->m_conweaveRouting.SetSwitchSendToDevCallback(
-        MakeCallback(&SwitchNode::SendToDevContinue, this));
-    // Hula's Callback for switch function
-    m_mmu->m_hulaRouting.SetSwitchSendCallback(MakeCallback(&SwitchNode::DoSwitchSend, this));
-    m_mmu->m_hulaRouting.SetSwitchSendToDevCallback(
-        MakeCallback(&SwitchNode::SendToDevContinue, this));
-    m_mmu->m_hulaRouting.SetSwitchSendHulaProbeCallback(MakeCallback(&SwitchNode::SendHulaProbe, this));
-
-    //DV's Callback for switch functions
-    m_mmu->m_dvRouting.SetSwitchSendCallback(MakeCallback(&SwitchNode::DoSwitchSend, this));
-    m_mmu->m_dvRouting.SetSwitchSendToDevCallback(
-        MakeCallback(&SwitchNode::SendToDevContinue, this));
-    //Caver's Callback for switch functions
-    m_mmu->m_caverRouting.SetSwitchSendCallback(MakeCallback(&SwitchNode::DoSwitchSend, this));
-    m_mmu->m_caverRouting.SetSwitchSendToDevCallback(
-        MakeCallback(&SwitchNode::SendToDevContinue, this));
-        //Noshare's Callback for switch functions
-    m_mmu->m_noshareRouting.SetSwitchSendCallback(MakeCallback(&SwitchNode::DoSwitchSend, this));
-    m_mmu->m_noshareRouting.SetSwitchSendToDevCallback(
-        MakeCallback(&SwitchNode::SendToDevContinue, this));
-    // pCnt:端口数量
-    for (uint32_t i = 0; i < pCnt; i++) {
-        m_txBytes[i] = 0;
-    }
-    for (uint32_t i = 0; i < pCnt; i++) {
-        m_rxBytes[i] = 0;
-    }
+    SetLoadBalancer(CreateObject<LoadBalancer>());
+    m_memProbe = MemoryAccounting::Register(MakeCallback(&SwitchNode::ReportMemory, this));
+}
+
+void SwitchNode::SetLoadBalancer(Ptr<LoadBalancer> lb) {
+    m_lb = lb;
+    m_lb->SetNode(this);
+    m_lb->SetSwitchSendCallback(MakeCallback(&SwitchNode::DoSwitchSend, this));
+    m_lb->SetSwitchSendToDevCallback(MakeCallback(&SwitchNode::SendToDevContinue, this));
+    Ptr<HulaRouting> hula = DynamicCast<HulaRouting>(m_lb);
+    if (hula) hula->SetSwitchSendHulaProbeCallback(MakeCallback(&SwitchNode::SendHulaProbe, this));
+}
+
+void SwitchNode::ConfigNPort(uint32_t n_port) {
+    m_txBytes.assign(n_port + 1, 0);
+    m_rxBytes.assign(n_port + 1, 0);
+    m_mmu->ConfigNPort(n_port);
 }
 
 /**
@@ -124,90 +109,43 @@ uint32_t SwitchNode::DoLbFlowECMP(Ptr<const Packet> p, const CustomHeader &ch,
     return nexthops[idx];
 }
 
-/*-----------------CONGA-----------------*/
-uint32_t SwitchNode::DoLbConga(Ptr<Packet> p, CustomHeader &ch, const std::vector<int> &nexthops) {
-    return DoLbFlowECMP(p, ch, nexthops);  // flow ECMP (dummy)
-}
-/*-----------------DV-----------------*/
-uint32_t SwitchNode::DoLbDV(Ptr<Packet> p, CustomHeader &ch, const std::vector<int> &nexthops) {
-    return DoLbFlowECMP(p, ch, nexthops);  // flow ECMP (dummy)
-}
-/*-----------------Caver-----------------*/
-uint32_t SwitchNode::DoLbCaver(Ptr<Packet> p, CustomHeader &ch, const std::vector<int> &nexthops) {
-    return DoLbFlowECMP(p, ch, nexthops);  // flow ECMP (dummy)
-}
-/*-----------------Noshare-----------------*/
-uint32_t SwitchNode::DoLbNoshare(Ptr<Packet> p, CustomHeader &ch, const std::vector<int> &nexthops) {
-    return DoLbFlowECMP(p, ch, nexthops);  // flow ECMP (dummy)
-}
-/*-----------------Letflow-----------------*/
-uint32_t SwitchNode::DoLbLetflow(Ptr<Packet> p, CustomHeader &ch,
-                                 const std::vector<int> &nexthops) {
-    if (m_isToR && nexthops.size() == 1) {
-        if (m_isToR_hostIP.find(ch.sip) != m_isToR_hostIP.end() &&
-            m_isToR_hostIP.find(ch.dip) != m_isToR_hostIP.end()) {
-            return nexthops[0];  // intra-pod traffic
-        }
-    }
-
-    /* ONLY called for inter-Pod traffic */
-    uint32_t outPort = m_mmu->m_letflowRouting.RouteInput(p, ch);
-    if (outPort == LETFLOW_NULL) {
-        assert(nexthops.size() == 1);  // Receiver's TOR has only one interface to receiver-server
-        outPort = nexthops[0];         // has only one option
-    }
-    assert(std::find(nexthops.begin(), nexthops.end(), outPort) !=
-           nexthops.end());  // Result of Letflow cannot be found in nexthops
-    return outPort;
-}
-
-/*-----------------DRILL-----------------*/
-uint32_t SwitchNode::CalculateInterfaceLoad(uint32_t interface) {
-    Ptr<QbbNetDevice> device = DynamicCast<QbbNetDevice>(m_devices[interface]);
-    NS_ASSERT_MSG(!!device && !!device->GetQueue(),
-                  "Error of getting a egress queue for calculating interface load");
-    return device->GetQueue()->GetNBytesTotal();  // also used in HPCC
-}
-
-uint32_t SwitchNode::DoLbDrill(Ptr<const Packet> p, const CustomHeader &ch,
-                               const std::vector<int> &nexthops) {
-    // find the Egress (output) link with the smallest local Egress Queue length
-    uint32_t leastLoadInterface = 0;
-    uint32_t leastLoad = std::numeric_limits<uint32_t>::max();
-    auto rand_nexthops = nexthops;
-    std::random_shuffle(rand_nexthops.begin(), rand_nexthops.end());
-
-    std::map<uint32_t, uint32_t>::iterator itr = m_previousBestInterfaceMap.find(ch.dip);
-    if (itr != m_previousBestInterfaceMap.end()) {
-        leastLoadInterface = itr->second;
-        leastLoad = CalculateInterfaceLoad(itr->second);
-    }
-
-    uint32_t sampleNum =
-        m_drill_candidate < rand_nexthops.size() ? m_drill_candidate : rand_nexthops.size();
-    for (uint32_t samplePort = 0; samplePort < sampleNum; samplePort++) {
-        uint32_t sampleLoad = CalculateInterfaceLoad(rand_nexthops[samplePort]);
-        if (sampleLoad < leastLoad) {
-            leastLoad = sampleLoad;
-            leastLoadInterface = rand_nexthops[samplePort];
-        }
+int SwitchNode::GetFlowEcmpPort(uint32_t sip, uint32_t dip, uint16_t sport, uint16_t dport) {
+    auto entry = m_rtTable.find(dip);
+    if (entry == m_rtTable.end() || entry->second.empty()) return -1;
+    // same key as DoLbFlowECMP for a data packet of the flow
+    union {
+        uint8_t u8[4 + 4 + 2 + 2];
+        uint32_t u32[3];
+    } buf;
+    buf.u32[0] = sip;
+    buf.u32[1] = dip;
+    buf.u32[2] = sport | ((uint32_t)dport << 16);
+    const std::vector<int> &nexthops = entry->second;
+    return nexthops[EcmpHash(buf.u8, 12, m_ecmpSeed) % nexthops.size()];
+}
+
+void SwitchNode::AddFluidTx(uint32_t outDev, uint64_t bytes) {
+    m_txBytes[outDev] += bytes;
+    m_lb->OnFluidTx(outDev, bytes);
+}
+
+void SwitchNode::SetFluidBacklog(uint32_t inDev, uint32_t outDev, uint32_t qIndex, uint32_t bytes) {
+    uint64_t key = ((uint64_t)inDev << 32) | (outDev << 8) | qIndex;
+    uint32_t &cur = m_fluidBacklog[key];
+    if (cur == bytes) return;
+    uint32_t &queued = m_fluidQueueBytes[(outDev << 8) | qIndex];
+    queued = queued - cur + bytes;
+    DynamicCast<QbbNetDevice>(m_devices[outDev])->GetQueue()->SetFluidBytes(qIndex, queued);
+    if (bytes > cur) {
+        m_mmu->AddFluidBytes(inDev, outDev, qIndex, bytes - cur);
+        cur = bytes;
+        CheckAndSendPfc(inDev, qIndex);
+    } else {
+        m_mmu->RemoveFluidBytes(inDev, outDev, qIndex, cur - bytes);
+        cur = bytes;
+        CheckAndSendResume(inDev, qIndex);
     }
-    m_previousBestInterfaceMap[ch.dip] = leastLoadInterface;
-    return leastLoadInterface;
-}
-
-/*------------------ConWeave Dummy ----------------*/
-uint32_t SwitchNode::DoLbConWeave(Ptr<const Packet> p, const CustomHeader &ch,
-                                  const std::vector<int> &nexthops) {
-    return DoLbFlowECMP(p, ch, nexthops);  // flow ECMP (dummy)
-}
-/*----------------------------------*/
-
-/*------------------Hula Dummy ----------------*/
-uint32_t SwitchNode::DoLbHula(Ptr<Packet> p, CustomHeader &ch, const std::vector<int> &nexthops) {
-    return DoLbFlowECMP(p, ch, nexthops);  // flow ECMP (dummy)
 }
-/*----------------------------------*/
 
 void SwitchNode::CheckAndSendPfc(uint32_t inDev, uint32_t qIndex) {
     Ptr<QbbNetDevice> device = DynamicCast<QbbNetDevice>(m_devices[inDev]);
@@ -218,19 +156,19 @@ void SwitchNode::CheckAndSendPfc(uint32_t inDev, uint32_t qIndex) {
             uint32_t paused_time = device->SendPfc(j, 0);
             m_mmu->SetPause(inDev, j, paused_time);
             //std::cout << "PFC event: " << std::endl; 
-            m_mmu->m_pause_remote[inDev][j] = true;
+            m_mmu->m_pause_remote[SwitchMmu::PortQ(inDev, j)] = true;
             /** PAUSE SEND COUNT ++ */
         }
     }
 
     for (int j = 0; j < qCnt; j++) {
-        if (!m_mmu->m_pause_remote[inDev][j]) continue;
+        if (!m_mmu->m_pause_remote[SwitchMmu::PortQ(inDev, j)]) continue;
 
         if (m_mmu->GetResumeClasses(inDev, j)) {
             device->SendPfc(j, 1);
             //std::cout << "PFC event: " << std::endl; 
             m_mmu->SetResume(inDev, j);
-            m_mmu->m_pause_remote[inDev][j] = false;
+            m_mmu->m_pause_remote[SwitchMmu::PortQ(inDev, j)] = false;
         }
     }
 }
@@ -262,10 +200,9 @@ std::string convertToSpaceSeparatedString(uint32_t id, CustomHeader &ch) {
 // This function can only be called in switch mode
 bool SwitchNode::SwitchReceiveFromDevice(Ptr<NetDevice> device, Ptr<Packet> packet,
                                          CustomHeader &ch) {
-    if (ch.l3Prot == 0xFB && Settings::lb_mode == 12) {
-        m_mmu->m_hulaRouting.processProbe(device->GetIfIndex(), packet, ch);
+    if (ch.l3Prot == 0xFB && m_lb->ReceiveControl(device->GetIfIndex(), packet, ch)) {
         return true;
-    }                                            
+    }
     //TODO: my code to  visualize the packet header
     if (ch.l3Prot == 0x11)  // XXX RDMA traffic on UDP
     {
@@ -312,45 +249,19 @@ bool SwitchNode::SwitchReceiveFromDevice(Ptr<NetDevice> device, Ptr<Packet> pack
 }
 
 void SwitchNode::SendToDev(Ptr<Packet> p, CustomHeader &ch) {
-    /** HIJACK: hijack the packet and run DoSwitchSend internally for Conga and ConWeave.
-     * Note that DoLbConWeave() and DoLbConga() are flow-ECMP function for control packets
-     * or intra-ToR traffic.
+    /** HIJACK: the load balancer may take the packet and run DoSwitchSend internally
+     * (Conga, ConWeave, DV, CAVER, HULA, Noshare); it hands back control packets and
+     * intra-ToR traffic through SendToDevContinue(), which routes them by flow ECMP.
      */
     if (!m_GlobaldreEvent.IsRunning()){
         m_GlobaldreEvent = Simulator::Schedule(Settings::Dre_time_map[GetId()], &SwitchNode::GlobalDreEvent, this);
     }
-    // Conga
-    if (Settings::lb_mode == 3) {
-        m_mmu->m_congaRouting.RouteInput(p, ch);
-        return;
-    }
-
-    // ConWeave
-    if (Settings::lb_mode == 9) {
-        m_mmu->m_conweaveRouting.RouteInput(p, ch);
-        return;
-    }
-
-    if (Settings::lb_mode == 10) {
-        m_mmu->m_dvRouting.RouteInput(p, ch);
-        return;
-    }
-
-    if(Settings::lb_mode == 20){
-        m_mmu->m_caverRouting.RouteInput(p, ch);
-        return;
-    }
-    //hula
-    if (Settings::lb_mode == 12) {
-        m_mmu->m_hulaRouting.RouteInput(p, ch);
-        return;
+    if (RouteTracer::IsTraced(m_id)) {
+        RouteTracer::OnRouteInput(p, Simulator::Now().GetTimeStep());
     }
-    if(Settings::lb_mode == 21){
-        m_mmu->m_noshareRouting.RouteInput(p, ch);
+    if (m_lb->Ingress(p, ch)) {
         return;
     }
-
-    // Others
     SendToDevContinue(p, ch);
 }
 
@@ -366,50 +277,7 @@ void SwitchNode::SendToDevContinue(Ptr<Packet> p, CustomHeader &ch) {
     if (idx >= 0) {
         NS_ASSERT_MSG(m_devices[idx]->IsLinkUp(),
                       "The routing table look up should return link that is up");
-        // 如果时采用DV的方法，且是UdP包的话，则应该更新一下Dre，这部分是采用ECMP或者直接发送的方法
-        if (Settings::lb_mode == 10 and ch.l3Prot == 0x11) {
-            m_mmu->m_dvRouting.UpdateLocalDre(p, ch, idx);
-            if (m_mmu->m_dvRouting.DreTable_log){
-                if (m_isToR)
-                    printf("Dre Table: ToR switch %d\n", m_mmu->m_dvRouting.m_switch_id);
-                else
-                    printf("Dre Table: Mid switch %d\n", m_mmu->m_dvRouting.m_switch_id);
-                for (auto it = m_mmu->m_dvRouting.m_DreMap.begin(); it != m_mmu->m_dvRouting.m_DreMap.end(); ++it) {
-                    uint32_t ce = it->second;
-                    uint32_t localce = m_mmu->m_dvRouting.QuantizingX(it->first, ce);
-                    std::cout << "Port: " << it->first << ", CE: " << it->second << ",localCE: " << localce << std::endl;
-                }
-            }
-        }
-        // 如果是采用Caver的方法，且是UdP包的话，则应该更新一下Dre
-        if (Settings::lb_mode == 20 and ch.l3Prot == 0x11) {
-            m_mmu->m_caverRouting.UpdateLocalDre(p, ch, idx);
-            if (m_mmu->m_caverRouting.DreTable_log){
-                if (m_isToR)
-                    printf("Dre Table: ToR switch %d\n", m_mmu->m_caverRouting.m_switch_id);
-                else
-                    printf("Dre Table: Mid switch %d\n", m_mmu->m_caverRouting.m_switch_id);
-                for (auto it = m_mmu->m_caverRouting.m_DreMap.begin(); it != m_mmu->m_caverRouting.m_DreMap.end(); ++it) {
-                    uint32_t ce = it->second;
-                    uint32_t localce = m_mmu->m_caverRouting.QuantizingX(it->first, ce);
-                    std::cout << "Port: " << it->first << ", CE: " << it->second << ",localCE: " << localce << std::endl;
-                }
-            }
-        }
-        if (Settings::lb_mode == 21 and ch.l3Prot == 0x11) {
-            m_mmu->m_noshareRouting.UpdateLocalDre(p, ch, idx);
-            if (m_mmu->m_noshareRouting.DreTable_log){
-                if (m_isToR)
-                    printf("Dre Table: ToR switch %d\n", m_mmu->m_noshareRouting.m_switch_id);
-                else
-                    printf("Dre Table: Mid switch %d\n", m_mmu->m_noshareRouting.m_switch_id);
-                for (auto it = m_mmu->m_noshareRouting.m_DreMap.begin(); it != m_mmu->m_noshareRouting.m_DreMap.end(); ++it) {
-                    uint32_t ce = it->second;
-                    uint32_t localce = m_mmu->m_noshareRouting.QuantizingX(it->first, ce);
-                    std::cout << "Port: " << it->first << ", CE: " << it->second << ",localCE: " << localce << std::endl;
-                }
-            } 
-        }
+        m_lb->OnRouted(p, ch, idx);  // e.g., local DRE of DV/CAVER/Noshare
         // determine the qIndex
         uint32_t qIndex;
         if (ch.l3Prot == 0xFF || ch.l3Prot == 0xFE ||
@@ -487,31 +355,11 @@ int SwitchNode::GetOutDev(Ptr<Packet> p, CustomHeader &ch) {
     bool control_pkt =
         (ch.l3Prot == 0xFF || ch.l3Prot == 0xFE || ch.l3Prot == 0xFD || ch.l3Prot == 0xFC);
 
-    if (Settings::lb_mode == 0 || control_pkt) {  // control packet (ACK, NACK, PFC, QCN)
-        return DoLbFlowECMP(p, ch, nexthops);     // ECMP routing path decision (4-tuple)
-    }
-
-    switch (Settings::lb_mode) {
-        case 2:
-            return DoLbDrill(p, ch, nexthops);
-        case 3:
-            return DoLbConga(p, ch, nexthops); /** DUMMY: Do ECMP */
-        case 6:
-            return DoLbLetflow(p, ch, nexthops);
-        case 9:
-            return DoLbConWeave(p, ch, nexthops); /** DUMMY: Do ECMP */
-        case 10:
-            return DoLbDV(p, ch, nexthops); /** DUMMY: Do ECMP */
-        case 20:
-            return DoLbCaver(p, ch, nexthops); /** DUMMY: Do ECMP */
-        case 21:
-            return DoLbNoshare(p, ch, nexthops); /** DUMMY: Do ECMP */
-        case 12:
-            return DoLbHula(p, ch, nexthops);
-        default:
-            std::cout << "Unknown lb_mode(" << Settings::lb_mode << ")" << std::endl;
-            assert(false);
+    if (!control_pkt) {
+        uint32_t port = m_lb->SelectPort(p, ch, nexthops);  // e.g., DRILL, LetFlow
+        if (port != LoadBalancer::NO_PORT) return port;
     }
+    return DoLbFlowECMP(p, ch, nexthops);  // ECMP routing path decision (4-tuple)
 }
 
 /*
@@ -531,10 +379,14 @@ void SwitchNode::DoSwitchSend(Ptr<Packet> p, CustomHeader &ch, uint32_t outDev,
         assert(qIndex == 0 && m_ackHighPrio == 1 && "ConWeave's reply packet follows ACK, so its qIndex should be 0");
     }
 
-    if (Settings::lb_mode == 12) {
-        m_mmu->m_hulaRouting.updateLink(outDev, p->GetSize());
+    if (ReorderAnalytics::enabled && m_isToR && ch.l3Prot == 0x11 &&
+        m_isToR_hostIP.find(ch.sip) != m_isToR_hostIP.end()) {  // source ToR: record path switches
+        FlowIDNUMTag fit;
+        if (p->PeekPacketTag(fit)) ReorderAnalytics::OnSourceToR(fit.GetId(), outDev);
     }
-    
+
+    m_lb->OnSend(p, outDev);
+
     if (qIndex != 0) {  // not highest priority
         if (m_mmu->CheckEgressAdmission(outDev, qIndex,
                                         p->GetSize())) {  // Egress Admission control
@@ -542,6 +394,7 @@ void SwitchNode::DoSwitchSend(Ptr<Packet> p, CustomHeader &ch, uint32_t outDev,
                                              p->GetSize())) {  // Ingress Admission control
                 m_mmu->UpdateIngressAdmission(inDev, qIndex, p->GetSize());
                 m_mmu->UpdateEgressAdmission(outDev, qIndex, p->GetSize());
+                m_mmu->UpdateInOutBytes(inDev, outDev, qIndex, p->GetSize());
             } else { /** DROP: At Ingress */
 #if (0)
                 /** NOTE: logging dropped pkts */
@@ -552,7 +405,7 @@ void SwitchNode::DoSwitchSend(Ptr<Packet> p, CustomHeader &ch, uint32_t outDev,
 #endif
                 if (ch.l3Prot == 0x11) {
                     printf("An UDP packet dropped because ingress admission check false: Node:%u, Flow:%u, Seq=%u\n", 
-                        m_mmu->m_noshareRouting.m_switch_id, 
+                        m_id,
                         Settings::PacketId2FlowId[std::make_tuple(Settings::hostIp2IdMap[ch.sip], Settings::hostIp2IdMap[ch.dip], ch.udp.sport, ch.udp.dport)],
                         ch.udp.seq);
                 }
@@ -581,7 +434,13 @@ void SwitchNode::DoSwitchSend(Ptr<Packet> p, CustomHeader &ch, uint32_t outDev,
     if(Dive_optimal_log){
         UpdateGlobalDre(p, outDev);
     }
-    Settings::record_flow_distribution(p, ch, this, outDev);
+    if (PathTracer::enabled && ch.l3Prot == 0x11) {
+        FlowIDNUMTag fit;
+        if (p->PeekPacketTag(fit)) {
+            bool sourceToR = m_isToR && m_isToR_hostIP.find(ch.sip) != m_isToR_hostIP.end();
+            PathTracer::OnForward(m_id, fit.GetId(), outDev, sourceToR, Simulator::Now().GetTimeStep());
+        }
+    }
     m_devices[outDev]->SwitchSend(qIndex, p, ch);
 }
 
@@ -601,18 +460,13 @@ void SwitchNode::SwitchNotifyDequeue(uint32_t ifIndex, uint32_t qIndex, Ptr<Pack
             // NOTE: ConWeave's probe/reply does not need to pass inDev interface,
             // so skip for conweave's queued packets
             m_mmu->RemoveFromIngressAdmission(inDev, qIndex, p->GetSize());
+            m_mmu->RemoveInOutBytes(inDev, ifIndex, qIndex, p->GetSize());
         }
         m_mmu->RemoveFromEgressAdmission(ifIndex, qIndex, p->GetSize());
         if (m_ecnEnabled) {
             bool egressCongested = m_mmu->ShouldSendCN(ifIndex, qIndex);
             if (egressCongested) {
-                PppHeader ppp;
-                Ipv4Header h;
-                p->RemoveHeader(ppp);
-                p->RemoveHeader(h);
-                h.SetEcn((Ipv4Header::EcnType)0x03);
-                p->AddHeader(h);
-                p->AddHeader(ppp);
+                CustomHeader::PatchIpv4Ecn(p, CustomHeader::ECN_CE);
             }
         }
         // NOTE: ConWeave's probe/reply does not need to pass inDev interface
@@ -621,18 +475,13 @@ void SwitchNode::SwitchNotifyDequeue(uint32_t ifIndex, uint32_t qIndex, Ptr<Pack
         }
     }
 
+    m_lb->OnDequeue(ifIndex, qIndex, p);
+
     // HPCC's INT
-    if (1) {
-        uint8_t *buf = p->GetBuffer();
-        if (buf[PppHeader::GetStaticSize() + 9] == 0x11) {  // udp packet
-            IntHeader *ih = (IntHeader *)&buf[PppHeader::GetStaticSize() + 20 + 8 +
-                                              6];  // ppp, ip, udp, SeqTs, INT
-            Ptr<QbbNetDevice> dev = DynamicCast<QbbNetDevice>(m_devices[ifIndex]);
-            if (m_ccMode == 3) {  // HPCC
-                ih->PushHop(Simulator::Now().GetTimeStep(), m_txBytes[ifIndex],
-                            dev->GetQueue()->GetNBytesTotal(), dev->GetDataRate().GetBitRate());
-            }
-        }
+    if (m_ccMode == 3 && CustomHeader::PeekL3Prot(p) == 0x11) {  // udp packet
+        Ptr<QbbNetDevice> dev = DynamicCast<QbbNetDevice>(m_devices[ifIndex]);
+        CustomHeader::PushIntHop(p, Simulator::Now().GetTimeStep(), m_txBytes[ifIndex],
+                                 dev->GetQueue()->GetOccupancy(), dev->GetDataRate().GetBitRate());
     }
     m_txBytes[ifIndex] += p->GetSize();
 }
@@ -682,158 +531,157 @@ void SwitchNode::AddTableEntry(Ipv4Address &dstAddr, uint32_t intf_idx) {
     m_rtTable[dip].push_back(intf_idx);
 }
 void SwitchNode::AddDVTableEntry(Ipv4Address &dstAddr, uint32_t intf_idx, Time now) {
+    Ptr<DVRouting> dv = GetLoadBalancer<DVRouting>();
     uint32_t dip = dstAddr.Get();
-    auto dstIter = m_mmu->m_dvRouting.m_DVTable.find(dip);
-    if (dstIter == m_mmu->m_dvRouting.m_DVTable.end()) {
+    auto dstIter = dv->m_DVTable.find(dip);
+    if (dstIter == dv->m_DVTable.end()) {
         // 如果不存在，则创建一个新的条目
-        m_mmu->m_dvRouting.m_DVTable[dip] = std::map<uint32_t, DVInfo>();
+        dv->m_DVTable[dip] = std::map<uint32_t, DVInfo>();
     }
     DVInfo dvInfo;
     dvInfo._ce = 0;
     dvInfo._updateTime = now;
     dvInfo._valid = false;
-    m_mmu->m_dvRouting.m_DVTable[dip][intf_idx] = dvInfo;
+    dv->m_DVTable[dip][intf_idx] = dvInfo;
     
 }
 // *******************************Add begin**********************//
 void SwitchNode::AddPathCETableEntry(Ipv4Address &dstAddr, Time now){
+    Ptr<DVRouting> dv = GetLoadBalancer<DVRouting>();
     std::cout << dstAddr;
-    uint32_t dip = dstAddr.Get();
-    auto dstIter = m_mmu->m_dvRouting.PathCE_Table.find(dip);
-    if (dstIter == m_mmu->m_dvRouting.PathCE_Table.end()) {
-        // 如果不存在，则创建一个新的条目
-        singleDVInfo dvInfo;
+    singleDVInfo& dvInfo = dv->PathCEEntry(Settings::ip_to_node_id(dstAddr));
+    if (dvInfo._updateTime.IsZero() && !dvInfo._valid) {
+        // 如果不存在，则初始化该条目
         dvInfo._ce = 0;
         dvInfo._updateTime = now;
         dvInfo._valid = false;
         dvInfo._inPort = 0;
-        m_mmu->m_dvRouting.PathCE_Table[dip] = dvInfo;
     }
 }
 
 void SwitchNode::AddPathChoiceTableEntry(Ipv4Address &dstAddr, Time now){
+    Ptr<CaverRouting> caver = GetLoadBalancer<CaverRouting>();
     Time t1 = Seconds (0.0);
     uint32_t dip = dstAddr.Get();
-    auto dstIter = m_mmu->m_caverRouting.PathChoiceTable.find(dip);
-    if (dstIter == m_mmu->m_caverRouting.PathChoiceTable.end()) {
+    auto dstIter = caver->PathChoiceTable.find(dip);
+    if (dstIter == caver->PathChoiceTable.end()) {
         // 如果不存在，则创建一个新的条目
-        for (int i = 0; i < m_mmu->m_caverRouting.m_pathChoice_num; ++i) {
+        for (int i = 0; i < caver->m_pathChoice_num; ++i) {
             PathChoiceInfo pathChoiceInfo;
             // TODO:这里不确定初始化的时候设置成为now会不会让这些路径都是invalid
             pathChoiceInfo._updateTime = t1;
             pathChoiceInfo._is_used = false;
-            m_mmu->m_caverRouting.PathChoiceTable[dip].push_back(pathChoiceInfo); 
+            caver->PathChoiceTable[dip].push_back(pathChoiceInfo); 
         }
     }
 
-    auto dstMapIter = m_mmu->m_caverRouting.PathChoiceFlagMap.find(dip);
-    if (dstMapIter == m_mmu->m_caverRouting.PathChoiceFlagMap.end()) {
+    auto dstMapIter = caver->PathChoiceFlagMap.find(dip);
+    if (dstMapIter == caver->PathChoiceFlagMap.end()) {
         // 如果不存在，则创建一个新的条目
-        m_mmu->m_caverRouting.PathChoiceFlagMap[dip] = 0;
+        caver->PathChoiceFlagMap[dip] = 0;
     }
 }
 void SwitchNode::AddPathChoiceTableEntry_noshare(Ipv4Address &dstAddr, Time now){
+    Ptr<NoshareRouting> noshare = GetLoadBalancer<NoshareRouting>();
     Time t1 = Seconds (0.0);
     uint32_t dip = dstAddr.Get();
-    auto dstIter = m_mmu->m_noshareRouting.PathChoiceTable.find(dip);
-    if (dstIter == m_mmu->m_noshareRouting.PathChoiceTable.end()) {
+    auto dstIter = noshare->PathChoiceTable.find(dip);
+    if (dstIter == noshare->PathChoiceTable.end()) {
         // 如果不存在，则创建一个新的条目
-        for (int i = 0; i < m_mmu->m_noshareRouting.m_pathChoice_num; ++i) {
+        for (int i = 0; i < noshare->m_pathChoice_num; ++i) {
             PathChoiceInfo pathChoiceInfo;
             // TODO:这里不确定初始化的时候设置成为now会不会让这些路径都是invalid
             pathChoiceInfo._updateTime = t1;
             pathChoiceInfo._is_used = false;
-            m_mmu->m_noshareRouting.PathChoiceTable[dip].push_back(pathChoiceInfo); 
+            noshare->PathChoiceTable[dip].push_back(pathChoiceInfo); 
         }
     }
-    auto dstMapIter = m_mmu->m_noshareRouting.PathChoiceFlagMap.find(dip);
-    if (dstMapIter == m_mmu->m_noshareRouting.PathChoiceFlagMap.end()) {
+    auto dstMapIter = noshare->PathChoiceFlagMap.find(dip);
+    if (dstMapIter == noshare->PathChoiceFlagMap.end()) {
         // 如果不存在，则创建一个新的条目
-        m_mmu->m_noshareRouting.PathChoiceFlagMap[dip] = 0;
+        noshare->PathChoiceFlagMap[dip] = 0;
     }
 }
 
 void SwitchNode::AddBestPathCETableEntry(Ipv4Address &dstAddr, Time now){
+    Ptr<CaverRouting> caver = GetLoadBalancer<CaverRouting>();
     // std::cout << dstAddr;
     uint32_t dip = dstAddr.Get();
-    auto dstIter = m_mmu->m_caverRouting.best_pathCE_Table.find(dip);
-    if (dstIter == m_mmu->m_caverRouting.best_pathCE_Table.end()) {
+    auto dstIter = caver->best_pathCE_Table.find(dip);
+    if (dstIter == caver->best_pathCE_Table.end()) {
         // 如果不存在，则创建一个新的条目
         bestCaverInfo caverInfo;
         caverInfo._ce = 0;
         caverInfo._updateTime = now;
         caverInfo._valid = false;
         caverInfo._inPort = 0;
-        m_mmu->m_caverRouting.best_pathCE_Table[dip] = caverInfo;
+        caver->best_pathCE_Table[dip] = caverInfo;
     }
 }
 
 void SwitchNode::AddBestPathCETableEntry_noshare(Ipv4Address &dstAddr, Time now){
+    Ptr<NoshareRouting> noshare = GetLoadBalancer<NoshareRouting>();
     // std::cout << dstAddr;
     uint32_t dip = dstAddr.Get();
-    auto dstIter = m_mmu->m_noshareRouting.best_pathCE_Table.find(dip);
-    if (dstIter == m_mmu->m_noshareRouting.best_pathCE_Table.end()) {
+    auto dstIter = noshare->best_pathCE_Table.find(dip);
+    if (dstIter == noshare->best_pathCE_Table.end()) {
         // 如果不存在，则创建一个新的条目
         bestCaverInfo caverInfo;
         caverInfo._ce = 0;
         caverInfo._updateTime = now;
         caverInfo._valid = false;
         caverInfo._inPort = 0;
-        m_mmu->m_noshareRouting.best_pathCE_Table[dip] = caverInfo;
+        noshare->best_pathCE_Table[dip] = caverInfo;
     }
 }
 void SwitchNode::AddACCPathCETableEntry(Ipv4Address &dstAddr, Time now){
+    Ptr<CaverRouting> caver = GetLoadBalancer<CaverRouting>();
     // std::cout << dstAddr;
     uint32_t dip = dstAddr.Get();
-    auto dstIter = m_mmu->m_caverRouting.acceptable_path_table.find(dip);
-    if (dstIter == m_mmu->m_caverRouting.acceptable_path_table.end()) {
+    auto dstIter = caver->acceptable_path_table.find(dip);
+    if (dstIter == caver->acceptable_path_table.end()) {
         // 如果不存在，则创建一个新的条目
         bestCaverInfo caverInfo;
         caverInfo._ce = 0;
         caverInfo._updateTime = now;
         caverInfo._valid = false;
         caverInfo._inPort = 0;
-        m_mmu->m_caverRouting.acceptable_path_table[dip] = caverInfo;
+        caver->acceptable_path_table[dip] = caverInfo;
     }
 }
 
 void SwitchNode::AddACCPathCETableEntry_noshare(Ipv4Address &dstAddr, Time now){
+    Ptr<NoshareRouting> noshare = GetLoadBalancer<NoshareRouting>();
     // std::cout << dstAddr;
     uint32_t dip = dstAddr.Get();
-    auto dstIter = m_mmu->m_noshareRouting.acceptable_path_table.find(dip);
-    if (dstIter == m_mmu->m_noshareRouting.acceptable_path_table.end()) {
+    auto dstIter = noshare->acceptable_path_table.find(dip);
+    if (dstIter == noshare->acceptable_path_table.end()) {
         // 如果不存在，则创建一个新的条目
         bestCaverInfo caverInfo;
         caverInfo._ce = 0;
         caverInfo._updateTime = now;
         caverInfo._valid = false;
         caverInfo._inPort = 0;
-        m_mmu->m_noshareRouting.acceptable_path_table[dip] = caverInfo;
+        noshare->acceptable_path_table[dip] = caverInfo;
     }
 }
 void SwitchNode::AddPathCE_port_TableEntry(Ipv4Address &dstAddr, uint32_t intf_idx, Time now){
-    uint32_t dip = dstAddr.Get();
-    auto dstIter = m_mmu->m_dvRouting.PathCE_port_Table.find(dip);
-    if (dstIter == m_mmu->m_dvRouting.PathCE_port_Table.end()) {
-        // 如果不存在，则创建一个新的条目
-        m_mmu->m_dvRouting.PathCE_port_Table[dip] = std::map<uint32_t, DVInfo>();
-    }
-    DVInfo dvInfo;
+    Ptr<DVRouting> dv = GetLoadBalancer<DVRouting>();
+    DVInfo& dvInfo = dv->PathCEPortEntry(Settings::ip_to_node_id(dstAddr), intf_idx);
     dvInfo._ce = 0;
     dvInfo._updateTime = now;
     dvInfo._valid = false;
-    m_mmu->m_dvRouting.PathCE_port_Table[dip][intf_idx] = dvInfo;
 }
 
 // *******************************Add end**********************//
 void SwitchNode::ClearTable() { m_rtTable.clear(); }
 
 uint64_t SwitchNode::GetTxBytesOutDev(uint32_t outdev) {
-    assert(outdev < pCnt);
+    assert(outdev < m_txBytes.size());
     return m_txBytes[outdev];
 }
 uint64_t SwitchNode::GetRxBytesOutDev(uint32_t outdev) {
-    assert(outdev < pCnt);
+    assert(outdev < m_rxBytes.size());
     return m_rxBytes[outdev];
 } /* namespace ns3 */
 void SwitchNode::DecreaseGlobalDre(){
@@ -864,6 +712,32 @@ void SwitchNode::DoDispose(){
     if(Dive_optimal_log){
         m_GlobaldreEvent.Cancel();
     }
+    if (m_memProbe != UINT32_MAX) {
+        MemoryAccounting::Unregister(m_memProbe);
+        m_memProbe = UINT32_MAX;
+    }
+}
+
+void SwitchNode::ReportMemory(MemoryAccounting::Report &report) {
+    const uint64_t o = MemoryAccounting::MALLOC_OVERHEAD;
+    report.Add("switch.flow_bytes", flow_bytes.size(), MemoryAccounting::HashBytes(flow_bytes));
+    report.Add("switch.easy_flowtable", easy_flowtable.size(),
+               MemoryAccounting::HashBytes(easy_flowtable));
+    uint64_t routeBytes = MemoryAccounting::HashBytes(m_rtTable);
+    for (auto &it : m_rtTable) routeBytes += MemoryAccounting::VectorBytes(it.second);
+    report.Add("switch.route", m_rtTable.size(), routeBytes);
+    report.Add("switch.fluid", m_fluidBacklog.size() + m_fluidQueueBytes.size(),
+               MemoryAccounting::HashBytes(m_fluidBacklog) +
+                   MemoryAccounting::HashBytes(m_fluidQueueBytes));
+    uint64_t packets = 0, bytes = 0;
+    for (uint32_t i = 0; i < GetNDevices(); i++) {
+        Ptr<QbbNetDevice> dev = DynamicCast<QbbNetDevice>(GetDevice(i));
+        if (dev == 0) continue;
+        packets += dev->GetQueue()->GetNPackets();
+        bytes += dev->GetQueue()->GetNBytesTotal();
+    }
+    report.Add("network.egress_queue", packets, bytes + packets * (sizeof(Packet) + 2 * o));
+    m_lb->ReportMemory(report);
 }
 
 uint64_t SwitchNode::GetQpKey(uint32_t dip, uint16_t sport, uint16_t dport, uint16_t pg) {
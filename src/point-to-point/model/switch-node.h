@@ -8,10 +8,9 @@
 #include <tuple>
 #include "qbb-net-device.h"
 #include "switch-mmu.h"
+#include "ns3/load-balancer.h"
+#include "ns3/memory-accounting.h"
 #include "ns3/settings.h"
-#include "ns3/dv-routing.h"
-#include"ns3/caver-routing.h"
-#include "ns3/noshare-routing.h"
 
 namespace ns3 {
 
@@ -22,15 +21,25 @@ class Packet;
 class SwitchNode : public Node {
    public:
     static const unsigned qCnt = 8;    // Number of queues/priorities used
-    static const unsigned pCnt = 128;  // port 0 is not used so + 1	// Number of ports used
     uint32_t m_ecmpSeed;
     std::unordered_map<uint32_t, std::vector<int> >
         m_rtTable;  // map from ip address (u32) to possible ECMP port (index of dev)
 
     // monitor uplinks
-    uint64_t m_txBytes[pCnt];  // counter of tx bytes, for HPCC
-    uint64_t m_rxBytes[pCnt];  // counter of rx bytes, for HPCC
+    std::vector<uint64_t> m_txBytes;  // counter of tx bytes, for HPCC (sized by ConfigNPort)
+    std::vector<uint64_t> m_rxBytes;  // counter of rx bytes, for HPCC
     std::unordered_map<uint32_t, uint64_t> flow_bytes; 
+
+    /*----- hybrid fluid mode (FluidModel) -----*/
+    /* egress port of flow ECMP for a 4-tuple, -1 if dip is not routable here */
+    int GetFlowEcmpPort(uint32_t sip, uint32_t dip, uint16_t sport, uint16_t dport);
+    /* fluid bytes sent on outDev: tx counter (INT/telemetry) and the load balancer's DRE */
+    void AddFluidTx(uint32_t outDev, uint64_t bytes);
+    /* synthetic backlog of the fluid flows entering at inDev and queued at (outDev, qIndex):
+     * buffer occupancy for ECN/PFC and the queue length; packets are only delayed by the
+     * port's fluid rate (QbbNetDevice::SetFluidRate), which already includes this backlog */
+    void SetFluidBacklog(uint32_t inDev, uint32_t outDev, uint32_t qIndex, uint32_t bytes);
+
    protected:
     bool m_ecnEnabled;
     uint32_t m_ccMode;
@@ -49,29 +58,12 @@ class SwitchNode : public Node {
     void DoSwitchSend(Ptr<Packet> p, CustomHeader &ch, uint32_t outDev, uint32_t qIndex);
 
     /*----- Load balancer -----*/
-    // Flow ECMP (lb_mode = 0)
+    // Flow ECMP (lb_mode = 0), also used for control packets and when m_lb has no choice
     uint32_t DoLbFlowECMP(Ptr<const Packet> p, const CustomHeader &ch,
                           const std::vector<int> &nexthops);
-    // DRILL (lb_mode = 2)
-    uint32_t DoLbDrill(Ptr<const Packet> p, const CustomHeader &ch,
-                       const std::vector<int> &nexthops);     // choose egress port
-    uint32_t m_drill_candidate;                               // always 2 (power of two)
-    std::map<uint32_t, uint32_t> m_previousBestInterfaceMap;  // <dip, previousBestInterface>
-    uint32_t CalculateInterfaceLoad(uint32_t interface);      // Get the load of a interface
-    // Conga (lb_mode = 3)
-    uint32_t DoLbConga(Ptr<Packet> p, CustomHeader &ch, const std::vector<int> &nexthops);
-    // Conga (lb_mode = 6)
-    uint32_t DoLbDV(Ptr<Packet> p, CustomHeader &ch, const std::vector<int> &nexthops);
-    uint32_t DoLbCaver(Ptr<Packet> p, CustomHeader &ch, const std::vector<int> &nexthops);
-    uint32_t DoLbLetflow(Ptr<Packet> p, CustomHeader &ch, const std::vector<int> &nexthops);
-    // ConWeave (lb_mode = 9)
-    uint32_t DoLbConWeave(Ptr<const Packet> p, const CustomHeader &ch,
-                           const std::vector<int> &nexthops);  // dummy
-    uint32_t DoLbNoshare(Ptr<Packet> p, CustomHeader &ch, const std::vector<int> &nexthops);
-    
-    // Hula (lb_mode = 12)
-    uint32_t DoLbHula(Ptr<Packet> p, CustomHeader &ch, const std::vector<int> &nexthops);
-
+    Ptr<LoadBalancer> m_lb;  // the module of Settings::lb_mode (flow ECMP by default)
+    std::unordered_map<uint64_t, uint32_t> m_fluidBacklog;  // (inDev, outDev, qIndex) -> bytes
+    std::unordered_map<uint32_t, uint32_t> m_fluidQueueBytes;  // (outDev, qIndex) -> bytes
 
    public:
     // Ptr<BroadcomNode> m_broadcom;
@@ -96,7 +88,18 @@ class SwitchNode : public Node {
 
     static TypeId GetTypeId(void);
     SwitchNode();
+    SwitchNode(uint32_t systemId);  // MPI rank that simulates this switch
     void SetEcmpSeed(uint32_t seed);
+    uint32_t GetEcmpSeed(void) const { return m_ecmpSeed; }
+    /* installs the load balancer (one per switch) and wires its callbacks to this switch */
+    void SetLoadBalancer(Ptr<LoadBalancer> lb);
+    Ptr<LoadBalancer> GetLoadBalancer(void) const { return m_lb; }
+    template <typename T>
+    Ptr<T> GetLoadBalancer(void) const {  // NULL if the installed one is not a T
+        return DynamicCast<T>(m_lb);
+    }
+    /* sizes the per-port state of the switch and its MMU: ports 1..n_port (0 is not used) */
+    void ConfigNPort(uint32_t n_port);
     void AddTableEntry(Ipv4Address &dstAddr, uint32_t intf_idx);
     void AddDVTableEntry(Ipv4Address &dstAddr, uint32_t intf_idx, Time now);
     void AddCaverTableEntry(Ipv4Address &dstAddr, uint32_t intf_idx, Time now);
@@ -128,6 +131,10 @@ class SwitchNode : public Node {
     
     std::unordered_set<uint64_t> easy_flowtable;
     uint64_t GetQpKey(uint32_t dip, uint16_t sport, uint16_t dport, uint16_t pg);
+
+    /* memory probe: switch tables, egress queues and the load balancer's tables */
+    void ReportMemory(MemoryAccounting::Report &report);
+    uint32_t m_memProbe;
 };
 
 } /* namespace ns3 */
@@ -0,0 +1,131 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CAVER-LB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "ns3/cdf-flow-generator.h"
+#include "ns3/test.h"
+
+using namespace ns3;
+
+/* the goldens' "%.9f" seconds back to ns, without going through a double */
+static uint64_t
+ParseSeconds (const std::string &s)
+{
+  std::string::size_type dot = s.find ('.');
+  uint64_t ns = std::stoull (s.substr (0, dot)) * 1000000000;
+  std::string frac = dot == std::string::npos ? "" : s.substr (dot + 1);
+  frac.resize (9, '0');
+  return ns + std::stoull (frac);
+}
+
+/**
+ * CdfFlowGenerator yields the flows of the Python script it replaces, in the same
+ * order. The goldens under test/ were written by the scripts, with the options
+ *   -c cdf-flow-generator-test.cdf -n 8 -l 0.6 -b 100G -t 0.004 -s 2
+ * and, for traffic_gen_incast.py / traffic_gen_mix.py, -m 0.8 -p 4.
+ */
+class CdfFlowGeneratorGoldenTestCase : public TestCase
+{
+public:
+  CdfFlowGeneratorGoldenTestCase (std::string script, CdfFlowGenerator::Pattern pattern,
+                                  uint32_t sectionFlows, double flowInterval, std::string golden);
+  virtual void DoRun (void);
+
+private:
+  CdfFlowGenerator::Pattern m_pattern;
+  uint32_t m_sectionFlows;
+  double m_flowInterval;
+  std::string m_golden;
+};
+
+CdfFlowGeneratorGoldenTestCase::CdfFlowGeneratorGoldenTestCase (std::string script,
+                                                                CdfFlowGenerator::Pattern pattern,
+                                                                uint32_t sectionFlows,
+                                                                double flowInterval,
+                                                                std::string golden)
+  : TestCase ("Flows equal the output of " + script),
+    m_pattern (pattern),
+    m_sectionFlows (sectionFlows),
+    m_flowInterval (flowInterval),
+    m_golden (golden)
+{
+}
+
+void
+CdfFlowGeneratorGoldenTestCase::DoRun (void)
+{
+  CdfFlowGenerator gen;
+  NS_TEST_ASSERT_MSG_EQ (gen.SetCdf (CreateDataDirFilename ("cdf-flow-generator-test.cdf")), true,
+                         "read the CDF");
+  gen.SetParams (8, 0.6, 100e9, 0.004, 2);
+  gen.SetPattern (m_pattern, 0.8, 4, m_sectionFlows, m_flowInterval);
+
+  std::ifstream golden (CreateDataDirFilename (m_golden).c_str ());
+  NS_TEST_ASSERT_MSG_EQ (golden.is_open (), true, "open " << m_golden);
+  uint64_t n = 0;
+  golden >> n;
+  NS_TEST_ASSERT_MSG_EQ (gen.CountFlows (), n, "flow count");
+
+  CdfFlowGenerator::Flow f;
+  for (uint64_t i = 0; i < n; i++)
+    {
+      uint32_t src, dst, pg, size;
+      std::string t;
+      golden >> src >> dst >> pg >> size >> t;
+      NS_TEST_ASSERT_MSG_EQ (golden.fail (), false, "golden line " << i + 2);
+      NS_TEST_ASSERT_MSG_EQ (gen.Next (f), true, "flow " << i);
+      NS_TEST_ASSERT_MSG_EQ (f.src, src, "src of flow " << i);
+      NS_TEST_ASSERT_MSG_EQ (f.dst, dst, "dst of flow " << i);
+      NS_TEST_ASSERT_MSG_EQ (f.size, size, "size of flow " << i);
+      NS_TEST_ASSERT_MSG_EQ (f.startNs, ParseSeconds (t), "start of flow " << i);
+    }
+  NS_TEST_EXPECT_MSG_EQ (gen.Next (f), false, "no flow past the count");
+}
+
+class CdfFlowGeneratorTestSuite : public TestSuite
+{
+public:
+  CdfFlowGeneratorTestSuite ();
+};
+
+CdfFlowGeneratorTestSuite::CdfFlowGeneratorTestSuite ()
+  : TestSuite ("cdf-flow-generator", UNIT)
+{
+  SetDataDir (NS_TEST_SOURCEDIR);
+  /* flow_num and flow_interval(_coefficient) are the scripts' constants */
+  AddTestCase (new CdfFlowGeneratorGoldenTestCase ("traffic_gen.py", CdfFlowGenerator::POISSON,
+                                                   0, 0, "cdf-flow-generator-poisson.txt"));
+  AddTestCase (new CdfFlowGeneratorGoldenTestCase ("traffic_gen_incast.py",
+                                                   CdfFlowGenerator::INCAST, 200, 0.01,
+                                                   "cdf-flow-generator-incast.txt"));
+  AddTestCase (new CdfFlowGeneratorGoldenTestCase ("traffic_gen_mix.py",
+                                                   CdfFlowGenerator::ALLTOALL, 300, 0.05,
+                                                   "cdf-flow-generator-mix.txt"));
+}
+
+static CdfFlowGeneratorTestSuite g_cdfFlowGeneratorTestSuite;
@@ -0,0 +1,315 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CAVER-LB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include "ns3/custom-header.h"
+#include "ns3/hula-header.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/pause-header.h"
+#include "ns3/ppp-header.h"
+#include "ns3/qbb-header.h"
+#include "ns3/seq-ts-header.h"
+#include "ns3/test.h"
+#include "ns3/udp-header.h"
+
+namespace ns3 {
+
+namespace {
+
+struct Hop {
+  uint64_t time, bytes;
+  uint32_t qlen;
+  uint64_t rate;
+};
+
+std::vector<uint8_t>
+GetBytes (Ptr<const Packet> p)
+{
+  std::vector<uint8_t> buf (p->GetSize ());
+  p->CopyData (buf.data (), buf.size ());
+  return buf;
+}
+
+void
+AddL2L3 (Ptr<Packet> p, uint8_t prot, Ipv4Header::EcnType ecn, bool checksum)
+{
+  Ipv4Header ipHeader;
+  ipHeader.SetSource (Ipv4Address ("11.0.0.1"));
+  ipHeader.SetDestination (Ipv4Address ("11.0.5.1"));
+  ipHeader.SetProtocol (prot);
+  ipHeader.SetPayloadSize (p->GetSize ());
+  ipHeader.SetTtl (64);
+  ipHeader.SetTos (0);
+  ipHeader.SetEcn (ecn);
+  ipHeader.SetIdentification (4321);
+  if (checksum)
+    ipHeader.EnableChecksum ();
+  p->AddHeader (ipHeader);
+  PppHeader ppp;
+  ppp.SetProtocol (0x0021);
+  p->AddHeader (ppp);
+}
+
+/* a data packet as RdmaHw::GetNxtPacket builds it, with `hops` already in its INT header */
+Ptr<Packet>
+BuildData (Ipv4Header::EcnType ecn, const std::vector<Hop> &hops, uint32_t seq, bool checksum)
+{
+  Ptr<Packet> p = Create<Packet> (1000);
+  SeqTsHeader seqTs;
+  seqTs.SetSeq (seq);
+  seqTs.SetPG (3);
+  for (uint32_t i = 0; i < hops.size (); i++)
+    seqTs.ih.PushHop (hops[i].time, hops[i].bytes, hops[i].qlen, hops[i].rate);
+  p->AddHeader (seqTs);
+  UdpHeader udpHeader;
+  udpHeader.SetDestinationPort (100);
+  udpHeader.SetSourcePort (10000);
+  if (checksum)
+    {
+      udpHeader.EnableChecksums ();
+      udpHeader.InitializeChecksum (Ipv4Address ("11.0.0.1"), Ipv4Address ("11.0.5.1"), 0x11);
+    }
+  p->AddHeader (udpHeader);
+  AddL2L3 (p, 0x11, ecn, checksum);
+  return p;
+}
+
+/* an ACK as RdmaHw::ReceiveUdp builds it */
+Ptr<Packet>
+BuildAck (uint32_t seq)
+{
+  qbbHeader seqh;
+  seqh.SetSeq (seq);
+  seqh.SetPG (3);
+  seqh.SetSport (100);
+  seqh.SetDport (10000);
+  seqh.SetIrnNack (0);  // not set by the constructor
+  seqh.SetIrnNackSize (0);
+  Ptr<Packet> p = Create<Packet> (std::max (60 - 14 - 20 - (int)seqh.GetSerializedSize (), 0));
+  p->AddHeader (seqh);
+  AddL2L3 (p, 0xFC, Ipv4Header::NotECT, false);
+  return p;
+}
+
+} // namespace
+
+/**
+ * The in-place patches of a data packet (ECN mark, INT hops, sequence number) give the same bytes,
+ * checksums included, as building the packet with those fields from the start,
+ * and PeekHeader reads the patched fields back.
+ */
+class CustomHeaderDataPatchTestCase : public TestCase
+{
+public:
+  CustomHeaderDataPatchTestCase (bool checksum);
+  virtual void DoRun (void);
+
+private:
+  bool m_checksum;
+};
+
+CustomHeaderDataPatchTestCase::CustomHeaderDataPatchTestCase (bool checksum)
+  : TestCase (checksum ? "Data packet patch, with checksums" : "Data packet patch, no checksums"),
+    m_checksum (checksum)
+{
+}
+
+void
+CustomHeaderDataPatchTestCase::DoRun (void)
+{
+  std::vector<Hop> hops;
+  // one more hop than IntHeader::maxHop, so the ring wraps
+  for (uint32_t i = 0; i <= IntHeader::maxHop; i++)
+    {
+      Hop h = {1000 + 77 * i, IntHop::byteUnit * (5 + 9 * i), IntHop::qlenUnit * (3 + i),
+               i % 2 ? 100000000000lu : 400000000000lu};
+      hops.push_back (h);
+    }
+
+  Ptr<Packet> p = BuildData (Ipv4Header::NotECT, std::vector<Hop> (), 1, m_checksum);
+  NS_TEST_ASSERT_MSG_EQ ((uint32_t)CustomHeader::PeekL3Prot (p), 0x11, "L3 protocol");
+  CustomHeader::PatchUdpSeq (p, 123456789);
+  CustomHeader::PatchIpv4Ecn (p, CustomHeader::ECN_CE);
+  for (uint32_t i = 0; i < hops.size (); i++)
+    CustomHeader::PushIntHop (p, hops[i].time, hops[i].bytes, hops[i].qlen, hops[i].rate);
+
+  Ptr<Packet> expected = BuildData (Ipv4Header::CE, hops, 123456789, m_checksum);
+  std::vector<uint8_t> got = GetBytes (p), want = GetBytes (expected);
+  NS_TEST_ASSERT_MSG_EQ (got.size (), want.size (), "packet size changed");
+  for (uint32_t i = 0; i < got.size (); i++)
+    NS_TEST_ASSERT_MSG_EQ ((uint32_t)got[i], (uint32_t)want[i], "byte " << i << " differs");
+
+  CustomHeader ch (CustomHeader::L2_Header | CustomHeader::L3_Header | CustomHeader::L4_Header);
+  ch.getInt = 1;
+  p->PeekHeader (ch);
+  NS_TEST_ASSERT_MSG_EQ ((uint32_t)ch.GetIpv4EcnBits (), (uint32_t)CustomHeader::ECN_CE, "ECN");
+  NS_TEST_ASSERT_MSG_EQ ((uint32_t)ch.l3Prot, 0x11, "L3 protocol");
+  NS_TEST_ASSERT_MSG_EQ (ch.udp.sport, 10000, "source port");
+  NS_TEST_ASSERT_MSG_EQ (ch.udp.dport, 100, "destination port");
+  NS_TEST_ASSERT_MSG_EQ (ch.udp.seq, 123456789, "sequence number");
+  NS_TEST_ASSERT_MSG_EQ (ch.udp.pg, 3, "priority group");
+  NS_TEST_ASSERT_MSG_EQ (ch.udp.ih.nhop, hops.size (), "number of INT hops");
+  for (uint32_t i = 0; i < hops.size (); i++)
+    {
+      IntHop &hop = ch.udp.ih.hop[i % IntHeader::maxHop];
+      if (i + IntHeader::maxHop < hops.size ())
+        continue;  // overwritten by a later hop
+      NS_TEST_ASSERT_MSG_EQ (hop.GetTime (), hops[i].time, "INT hop " << i << " time");
+      NS_TEST_ASSERT_MSG_EQ (hop.GetBytes (), hops[i].bytes, "INT hop " << i << " bytes");
+      NS_TEST_ASSERT_MSG_EQ (hop.GetQlen (), hops[i].qlen, "INT hop " << i << " qlen");
+      NS_TEST_ASSERT_MSG_EQ (hop.GetLineRate (), hops[i].rate, "INT hop " << i << " rate");
+    }
+
+  if (m_checksum)
+    {
+      PppHeader ppp;
+      Ipv4Header ipHeader;
+      ipHeader.EnableChecksum ();
+      UdpHeader udpHeader;
+      udpHeader.EnableChecksums ();
+      udpHeader.InitializeChecksum (Ipv4Address ("11.0.0.1"), Ipv4Address ("11.0.5.1"), 0x11);
+      Ptr<Packet> q = p->Copy ();
+      q->RemoveHeader (ppp);
+      q->RemoveHeader (ipHeader);
+      q->RemoveHeader (udpHeader);
+      NS_TEST_ASSERT_MSG_EQ (ipHeader.IsChecksumOk (), true, "IPv4 checksum");
+      NS_TEST_ASSERT_MSG_EQ (udpHeader.IsChecksumOk (), true, "UDP checksum");
+    }
+}
+
+/**
+ * PatchPfc / PatchHulaProbe on a pooled control frame give the same bytes as a frame
+ * built with those fields, and PeekHeader reads them back.
+ */
+class CustomHeaderControlPatchTestCase : public TestCase
+{
+public:
+  CustomHeaderControlPatchTestCase ();
+  virtual void DoRun (void);
+};
+
+CustomHeaderControlPatchTestCase::CustomHeaderControlPatchTestCase ()
+  : TestCase ("PFC and HULA probe patch")
+{
+}
+
+void
+CustomHeaderControlPatchTestCase::DoRun (void)
+{
+  CustomHeader ch (CustomHeader::L2_Header | CustomHeader::L3_Header | CustomHeader::L4_Header);
+
+  // PFC, as QbbNetDevice::AllocPfcFrame/SendPfc
+  Ptr<Packet> p = Create<Packet> (0);
+  p->AddHeader (PauseHeader (0, 0, 0));
+  AddL2L3 (p, 0xFE, Ipv4Header::NotECT, false);
+  for (uint32_t round = 0; round < 2; round++)
+    {
+      uint32_t time = round ? 0 : 65535, qlen = 123456 + round;
+      uint8_t qIndex = 3 + round;
+      CustomHeader::PatchPfc (p, time, qlen, qIndex);
+      Ptr<Packet> expected = Create<Packet> (0);
+      expected->AddHeader (PauseHeader (time, qlen, qIndex));
+      AddL2L3 (expected, 0xFE, Ipv4Header::NotECT, false);
+      NS_TEST_ASSERT_MSG_EQ ((GetBytes (p) == GetBytes (expected)), true, "PFC frame bytes differ");
+      p->PeekHeader (ch);
+      NS_TEST_ASSERT_MSG_EQ ((uint32_t)ch.l3Prot, 0xFE, "L3 protocol");
+      NS_TEST_ASSERT_MSG_EQ (ch.pfc.time, time, "PFC time");
+      NS_TEST_ASSERT_MSG_EQ (ch.pfc.qlen, qlen, "PFC qlen");
+      NS_TEST_ASSERT_MSG_EQ ((uint32_t)ch.pfc.qIndex, (uint32_t)qIndex, "PFC qIndex");
+    }
+
+  // HULA probe, as QbbNetDevice::AllocHulaProbe/SendHulaProbe
+  p = Create<Packet> (0);
+  p->AddHeader (HulaHeader (0, 0));
+  AddL2L3 (p, 0xFB, Ipv4Header::NotECT, false);
+  for (uint32_t round = 0; round < 2; round++)
+    {
+      uint32_t torID = round ? 7 : 0xabcdef;
+      uint8_t minUtil = round ? 0 : 200;
+      CustomHeader::PatchHulaProbe (p, torID, minUtil);
+      Ptr<Packet> expected = Create<Packet> (0);
+      expected->AddHeader (HulaHeader (torID, minUtil));
+      AddL2L3 (expected, 0xFB, Ipv4Header::NotECT, false);
+      NS_TEST_ASSERT_MSG_EQ ((GetBytes (p) == GetBytes (expected)), true, "HULA probe bytes differ");
+      p->PeekHeader (ch);
+      NS_TEST_ASSERT_MSG_EQ ((uint32_t)ch.l3Prot, 0xFB, "L3 protocol");
+      NS_TEST_ASSERT_MSG_EQ ((uint32_t)ch.hula.data.torID, torID, "HULA torID");
+      NS_TEST_ASSERT_MSG_EQ ((uint32_t)ch.hula.data.minUtil, (uint32_t)minUtil, "HULA minUtil");
+    }
+}
+
+/**
+ * PatchAckSeq gives the same bytes as an ACK built with that sequence number.
+ */
+class CustomHeaderAckPatchTestCase : public TestCase
+{
+public:
+  CustomHeaderAckPatchTestCase ();
+  virtual void DoRun (void);
+};
+
+CustomHeaderAckPatchTestCase::CustomHeaderAckPatchTestCase ()
+  : TestCase ("ACK seq patch")
+{
+}
+
+void
+CustomHeaderAckPatchTestCase::DoRun (void)
+{
+  CustomHeader ch (CustomHeader::L2_Header | CustomHeader::L3_Header | CustomHeader::L4_Header);
+  Ptr<Packet> p = BuildAck (0);
+  uint32_t seqs[] = {0x01020304, 0xfffffffe, 5000};
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      CustomHeader::PatchAckSeq (p, seqs[i]);
+      NS_TEST_ASSERT_MSG_EQ ((GetBytes (p) == GetBytes (BuildAck (seqs[i]))), true,
+                             "ACK bytes differ for seq " << seqs[i]);
+      p->PeekHeader (ch);
+      NS_TEST_ASSERT_MSG_EQ ((uint32_t)ch.l3Prot, 0xFC, "L3 protocol");
+      NS_TEST_ASSERT_MSG_EQ (ch.ack.seq, seqs[i], "ACK seq");
+      NS_TEST_ASSERT_MSG_EQ (ch.ack.sport, 100, "ACK source port");
+    }
+}
+
+class CustomHeaderPatchTestSuite : public TestSuite
+{
+public:
+  CustomHeaderPatchTestSuite ();
+};
+
+CustomHeaderPatchTestSuite::CustomHeaderPatchTestSuite ()
+  : TestSuite ("custom-header-patch", UNIT)
+{
+  AddTestCase (new CustomHeaderDataPatchTestCase (false));
+  AddTestCase (new CustomHeaderDataPatchTestCase (true));
+  AddTestCase (new CustomHeaderControlPatchTestCase);
+  AddTestCase (new CustomHeaderAckPatchTestCase);
+}
+
+static CustomHeaderPatchTestSuite g_customHeaderPatchTestSuite;
+
+} // namespace ns3
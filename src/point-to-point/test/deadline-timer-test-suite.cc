@@ -0,0 +1,485 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CAVER-LB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "ns3/data-rate.h"
+#include "ns3/deadline-timer.h"
+#include "ns3/nstime.h"
+#include "ns3/rdma-hw.h"
+#include "ns3/rdma-queue-pair.h"
+#include "ns3/settings.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+#include "rdma-test-network.h"
+
+using namespace ns3;
+
+/* (what fired, when): deadline keys, and 100 + i for the plain event i */
+static std::vector<std::pair<uint32_t, int64_t> > g_fired;
+static DeadlineTimer *g_timer;
+
+static void
+Fired (uint32_t what)
+{
+  g_fired.push_back (std::make_pair (what, Simulator::Now ().GetTimeStep ()));
+}
+
+static void
+Rearm3 (uint32_t key)
+{
+  Fired (key);
+  // a key re-armed from its own expiry, three times
+  if (key == 3 && Simulator::Now () < NanoSeconds (40))
+    {
+      g_timer->Schedule (3, Simulator::Now () + NanoSeconds (10));
+    }
+}
+
+static void
+ExpireDueAt (uint32_t first, int64_t armedAtNs)
+{
+  Fired (100 + first);
+  g_timer->ExpireDue (first, 1, TimeStep (armedAtNs));
+}
+
+class DeadlineTimerOrderTestCase : public TestCase
+{
+public:
+  DeadlineTimerOrderTestCase ();
+  virtual void DoRun (void);
+};
+
+DeadlineTimerOrderTestCase::DeadlineTimerOrderTestCase ()
+  : TestCase ("Deadlines fire in (at, armedAt, seq) order, in place among the other events")
+{
+}
+
+void
+DeadlineTimerOrderTestCase::DoRun (void)
+{
+  NS_TEST_ASSERT_MSG_EQ (Simulator::CanReserve (), true, "default simulator cannot reserve");
+  DeadlineTimer timer;
+  timer.SetExpireCallback (MakeCallback (&Fired));
+  g_fired.clear ();
+
+  Time at = NanoSeconds (10);
+  timer.Schedule (0, at);
+  timer.Schedule (1, NanoSeconds (5));
+  timer.Schedule (2, at, NanoSeconds (-5));  // as if armed before key 0
+  timer.Schedule (3, at);
+  Simulator::Schedule (at, &Fired, 100);
+  timer.Schedule (4, at);
+  Simulator::Schedule (at, &Fired, 101);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  uint32_t expected[] = { 1, 2, 0, 3, 100, 4, 101 };
+  uint32_t n = sizeof (expected) / sizeof (expected[0]);
+  NS_TEST_ASSERT_MSG_EQ (g_fired.size (), n, "wrong number of expiries");
+  for (uint32_t i = 0; i < n && i < g_fired.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (g_fired[i].first, expected[i], "wrong order at " << i);
+      NS_TEST_ASSERT_MSG_EQ (g_fired[i].second, (i == 0 ? 5 : 10), "wrong time at " << i);
+    }
+  NS_TEST_ASSERT_MSG_EQ (timer.GetSize (), 0, "deadlines left");
+}
+
+class DeadlineTimerRearmTestCase : public TestCase
+{
+public:
+  DeadlineTimerRearmTestCase ();
+  virtual void DoRun (void);
+};
+
+DeadlineTimerRearmTestCase::DeadlineTimerRearmTestCase ()
+  : TestCase ("Cancel, re-arm earlier and later, re-arm on expiry, ExpireDue")
+{
+}
+
+void
+DeadlineTimerRearmTestCase::DoRun (void)
+{
+  DeadlineTimer timer;
+  timer.SetExpireCallback (MakeCallback (&Rearm3));
+  g_timer = &timer;
+  g_fired.clear ();
+
+  timer.Schedule (0, NanoSeconds (10));
+  timer.Schedule (1, NanoSeconds (20));
+  timer.Cancel (0);
+  NS_TEST_ASSERT_MSG_EQ (timer.IsPending (0), false, "cancelled key still pending");
+  timer.Schedule (1, NanoSeconds (5));  // earlier
+  timer.Schedule (2, NanoSeconds (30));
+  timer.Schedule (2, NanoSeconds (45));  // later
+  NS_TEST_ASSERT_MSG_EQ (timer.GetDeadline (2), NanoSeconds (45), "re-arm not applied");
+  timer.Schedule (3, NanoSeconds (10));
+  // the shared event moves to key 6 and back to the slot of key 5 once key 6 is cancelled
+  timer.Schedule (5, NanoSeconds (50));
+  timer.Schedule (6, NanoSeconds (48));
+  timer.Cancel (6);
+  // events at 60, ahead of keys 7 and 8 in the scheduler, armed (at 1ns) before key 7 and
+  // after key 8: only key 8 is expired early
+  Simulator::Schedule (NanoSeconds (60), &ExpireDueAt, 7, 1);
+  Simulator::Schedule (NanoSeconds (60), &ExpireDueAt, 8, 1);
+  timer.Schedule (7, NanoSeconds (60), NanoSeconds (2));
+  timer.Schedule (8, NanoSeconds (60), NanoSeconds (0));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  uint32_t expected[][2] = { { 1, 5 }, { 3, 10 }, { 3, 20 }, { 3, 30 }, { 3, 40 }, { 2, 45 },
+                             { 5, 50 }, { 107, 60 }, { 108, 60 }, { 8, 60 }, { 7, 60 } };
+  uint32_t n = sizeof (expected) / sizeof (expected[0]);
+  NS_TEST_ASSERT_MSG_EQ (g_fired.size (), n, "wrong number of expiries");
+  for (uint32_t i = 0; i < n && i < g_fired.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (g_fired[i].first, expected[i][0], "wrong key at " << i);
+      NS_TEST_ASSERT_MSG_EQ (g_fired[i].second, expected[i][1], "wrong time at " << i);
+    }
+  NS_TEST_ASSERT_MSG_EQ (timer.GetSize (), 0, "deadlines left");
+}
+
+/*
+ * Mellanox DCQCN with one event per timer, as RdmaHw had it before the
+ * timers were moved to a DeadlineTimer: the reference for the rate
+ * trajectory.
+ */
+class LegacyDcqcn
+{
+public:
+  LegacyDcqcn (Ptr<RdmaHw> hw, DataRate lineRate)
+    : m_rate (lineRate),
+      m_targetRate (lineRate),
+      m_hw (hw),
+      m_lineRate (lineRate),
+      m_alpha (1),
+      m_alphaCnpArrived (false),
+      m_decreaseCnpArrived (false),
+      m_firstCnp (true),
+      m_rpTimeStage (0)
+  {
+  }
+
+  void CnpReceived (void)
+  {
+    m_alphaCnpArrived = true;
+    m_decreaseCnpArrived = true;
+    if (m_firstCnp)
+      {
+        m_alpha = 1;
+        m_alphaCnpArrived = false;
+        ScheduleUpdateAlpha ();
+        ScheduleDecreaseRate (1);
+        m_targetRate = m_rate = m_hw->m_rateOnFirstCNP * m_rate;
+        m_firstCnp = false;
+      }
+  }
+
+  DataRate m_rate;
+  DataRate m_targetRate;
+
+private:
+  void UpdateAlpha (void)
+  {
+    if (m_alphaCnpArrived)
+      {
+        m_alpha = (1 - m_hw->m_g) * m_alpha + m_hw->m_g;
+      }
+    else
+      {
+        m_alpha = (1 - m_hw->m_g) * m_alpha;
+      }
+    m_alphaCnpArrived = false;
+    ScheduleUpdateAlpha ();
+  }
+  void ScheduleUpdateAlpha (void)
+  {
+    Simulator::Schedule (MicroSeconds (m_hw->m_alpha_resume_interval), &LegacyDcqcn::UpdateAlpha,
+                         this);
+  }
+  void CheckRateDecrease (void)
+  {
+    ScheduleDecreaseRate (0);
+    if (m_decreaseCnpArrived)
+      {
+        bool clamp = true;
+        if (!m_hw->m_EcnClampTgtRate)
+          {
+            if (m_rpTimeStage == 0)
+              {
+                clamp = false;
+              }
+          }
+        if (clamp)
+          {
+            m_targetRate = m_rate;
+          }
+        m_rate = std::max (m_hw->m_minRate, m_rate * (1 - m_alpha / 2));
+        m_rpTimeStage = 0;
+        m_decreaseCnpArrived = false;
+        Simulator::Cancel (m_rpTimer);
+        m_rpTimer = Simulator::Schedule (MicroSeconds (m_hw->m_rpgTimeReset),
+                                         &LegacyDcqcn::RateIncEventTimer, this);
+      }
+  }
+  void ScheduleDecreaseRate (uint32_t delta)
+  {
+    Simulator::Schedule (MicroSeconds (m_hw->m_rateDecreaseInterval) + NanoSeconds (delta),
+                         &LegacyDcqcn::CheckRateDecrease, this);
+  }
+  void RateIncEventTimer (void)
+  {
+    m_rpTimer = Simulator::Schedule (MicroSeconds (m_hw->m_rpgTimeReset),
+                                     &LegacyDcqcn::RateIncEventTimer, this);
+    if (m_rpTimeStage < m_hw->m_rpgThreshold)
+      {
+        m_rate = (m_rate / 2) + (m_targetRate / 2);
+      }
+    else
+      {
+        m_targetRate += m_rpTimeStage == m_hw->m_rpgThreshold ? m_hw->m_rai : m_hw->m_rhai;
+        if (m_targetRate > m_lineRate)
+          {
+            m_targetRate = m_lineRate;
+          }
+        m_rate = (m_rate / 2) + (m_targetRate / 2);
+      }
+    m_rpTimeStage++;
+  }
+
+  Ptr<RdmaHw> m_hw;  // parameters only
+  DataRate m_lineRate;
+  double m_alpha;
+  bool m_alphaCnpArrived;
+  bool m_decreaseCnpArrived;
+  bool m_firstCnp;
+  uint32_t m_rpTimeStage;
+  EventId m_rpTimer;
+};
+
+/* a CNP whose ACK event was scheduled at armedNs and runs at atNs */
+struct Cnp
+{
+  int64_t armedNs, atNs;
+};
+
+static const int64_t T0 = 10000;    // first CNP; alpha slots at T0 + k us
+static const int64_t TICK = 4000;   // decrease checks at T0 + 1 + k * TICK
+static const int64_t SAMPLE = 500;  // samples at T0 + SAMPLE + k us, never on a grid
+
+/*
+ * Bursts of CNPs and quiet periods long enough for the rate to recover
+ * through all increase stages, plus CNPs exactly on a decrease check and on
+ * an alpha slot whose ACK event was scheduled before and after that check
+ * or slot (exact ties are left out: armedAt cannot order those).
+ */
+static std::vector<Cnp>
+MakeCnps (void)
+{
+  std::vector<Cnp> cnps;
+  Cnp first = { T0 - 3000, T0 };
+  cnps.push_back (first);
+  uint64_t lcg = 12345;
+  int64_t t = T0;
+  for (uint32_t i = 0; i < 400; i++)
+    {
+      lcg = lcg * 6364136223846793005ULL + 1442695040888963407ULL;
+      uint32_t r = lcg >> 33;
+      int64_t gap = r % 10 < 8 ? 1 + r % 6000 : 300000 + r % 900000;
+      t += gap;
+      Cnp c = { 0, t };
+      switch (i % 8)
+        {
+        case 1:  // on a decrease check
+        case 2:
+          c.atNs = t = T0 + 1 + ((t - T0 - 1) / TICK + 1) * TICK;
+          break;
+        case 3:  // on an alpha slot
+          c.atNs = t = T0 + ((t - T0) / 1000 + 1) * 1000;
+          break;
+        }
+      if ((c.atNs - T0) % 1000 == SAMPLE)
+        {
+          c.atNs = ++t;
+        }
+      int64_t delay = 100 + (r >> 8) % 9000;
+      if (i % 8 == 1)
+        {
+          delay = TICK + 700;  // armed before the check
+        }
+      else if (i % 8 == 2)
+        {
+          delay = 1500;  // armed after it
+        }
+      c.armedNs = c.atNs - delay;
+      if (c.armedNs == c.atNs - TICK || c.armedNs == c.atNs - 1000)
+        {
+          c.armedNs--;
+        }
+      cnps.push_back (c);
+    }
+  return cnps;
+}
+
+static std::vector<std::pair<uint64_t, uint64_t> > g_rates;
+
+static void
+DeliverLegacy (LegacyDcqcn *ref)
+{
+  ref->CnpReceived ();
+}
+
+static void
+ArmLegacy (LegacyDcqcn *ref, int64_t atNs)
+{
+  Simulator::Schedule (NanoSeconds (atNs) - Simulator::Now (), &DeliverLegacy, ref);
+}
+
+static void
+SampleLegacy (LegacyDcqcn *ref)
+{
+  g_rates.push_back (std::make_pair (ref->m_rate.GetBitRate (), ref->m_targetRate.GetBitRate ()));
+}
+
+/* what RdmaHw::ReceiveAck does with a CNP */
+static void
+Deliver (Ptr<RdmaHw> hw, Ptr<RdmaQueuePair> qp, Time armedAt)
+{
+  hw->ExpireDueQpTimers (qp, armedAt);
+  hw->cnp_received_mlx (qp, armedAt);
+}
+
+static void
+Arm (Ptr<RdmaHw> hw, Ptr<RdmaQueuePair> qp, int64_t atNs)
+{
+  Simulator::Schedule (NanoSeconds (atNs) - Simulator::Now (), &Deliver, hw, qp,
+                       Simulator::Now ());
+}
+
+static void
+Sample (Ptr<RdmaQueuePair> qp)
+{
+  g_rates.push_back (std::make_pair (qp->m_rate.GetBitRate (),
+                                     qp->mlx.m_targetRate.GetBitRate ()));
+}
+
+class DcqcnTimerTrajectoryTestCase : public TestCase
+{
+public:
+  DcqcnTimerTrajectoryTestCase ();
+  virtual void DoRun (void);
+};
+
+DcqcnTimerTrajectoryTestCase::DcqcnTimerTrajectoryTestCase ()
+  : TestCase ("DCQCN rates with the shared timer match one event per timer")
+{
+}
+
+void
+DcqcnTimerTrajectoryTestCase::DoRun (void)
+{
+  std::vector<Cnp> cnps = MakeCnps ();
+  int64_t end = 0;
+  for (uint32_t i = 0; i < cnps.size (); i++)
+    {
+      end = std::max (end, cnps[i].atNs);
+    }
+  end += 3000000;  // through hyper increase
+
+  RdmaTestNetwork net;
+  uint32_t a = net.AddHost ();
+  uint32_t b = net.AddHost ();
+  net.AddLink (a, b);
+  net.Build ();
+  Ptr<RdmaHw> hw = net.GetRdmaHw (a);
+  DataRate lineRate = net.GetDevice (a, b)->GetDataRate ();
+
+  // a QP that sends nothing: its timer slot is taken by hand
+  Ptr<RdmaQueuePair> qp = CreateObject<RdmaQueuePair> (3, Settings::node_id_to_ip (a),
+                                                       Settings::node_id_to_ip (b), 10000, 100);
+  qp->m_rate = qp->m_max_rate = qp->mlx.m_targetRate = lineRate;
+  qp->m_timerSlot = hw->m_timerQp.size ();
+  hw->m_timerQp.push_back (qp);
+  for (uint32_t i = 0; i < cnps.size (); i++)
+    {
+      Simulator::Schedule (NanoSeconds (cnps[i].armedNs), &Arm, hw, qp, cnps[i].atNs);
+    }
+  for (int64_t s = T0 + SAMPLE; s < end; s += 1000)
+    {
+      Simulator::Schedule (NanoSeconds (s), &Sample, qp);
+    }
+  g_rates.clear ();
+  net.Run (NanoSeconds (end));
+  std::vector<std::pair<uint64_t, uint64_t> > rates = g_rates;
+  hw->ReleaseQpTimers (qp);
+  Simulator::Destroy ();
+
+  LegacyDcqcn ref (hw, lineRate);
+  for (uint32_t i = 0; i < cnps.size (); i++)
+    {
+      Simulator::Schedule (NanoSeconds (cnps[i].armedNs), &ArmLegacy, &ref, cnps[i].atNs);
+    }
+  for (int64_t s = T0 + SAMPLE; s < end; s += 1000)
+    {
+      Simulator::Schedule (NanoSeconds (s), &SampleLegacy, &ref);
+    }
+  g_rates.clear ();
+  Simulator::Stop (NanoSeconds (end));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (rates.size (), g_rates.size (), "different number of samples");
+  bool decreased = false, increased = false;
+  for (uint32_t i = 0; i < rates.size () && i < g_rates.size (); i++)
+    {
+      int64_t t = T0 + SAMPLE + i * 1000;
+      NS_TEST_ASSERT_MSG_EQ (rates[i].first, g_rates[i].first, "rate differs at " << t << "ns");
+      NS_TEST_ASSERT_MSG_EQ (rates[i].second, g_rates[i].second,
+                             "target rate differs at " << t << "ns");
+      decreased = decreased || rates[i].first < lineRate.GetBitRate () / 2;
+      increased = increased || (i > 0 && rates[i].first > rates[i - 1].first);
+    }
+  NS_TEST_ASSERT_MSG_EQ (decreased, true, "the CNPs did not decrease the rate");
+  NS_TEST_ASSERT_MSG_EQ (increased, true, "the rate never increased");
+}
+
+class DeadlineTimerTestSuite : public TestSuite
+{
+public:
+  DeadlineTimerTestSuite ();
+};
+
+DeadlineTimerTestSuite::DeadlineTimerTestSuite ()
+  : TestSuite ("deadline-timer", UNIT)
+{
+  AddTestCase (new DeadlineTimerOrderTestCase);
+  AddTestCase (new DeadlineTimerRearmTestCase);
+  AddTestCase (new DcqcnTimerTrajectoryTestCase);
+}
+
+static DeadlineTimerTestSuite g_deadlineTimerTestSuite;
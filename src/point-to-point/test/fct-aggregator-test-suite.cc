@@ -0,0 +1,313 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CAVER-LB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "ns3/fct-aggregator.h"
+#include "ns3/test.h"
+
+using namespace ns3;
+
+/* deterministic samples spread over five decades, with a few zeros */
+static std::vector<double>
+MakeSamples (uint32_t n)
+{
+  std::vector<double> v;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      v.push_back (i % 97 == 0 ? 0 : 1000 * std::exp ((i * 7919 % 10007) / 10007.0 * 11.5));
+    }
+  return v;
+}
+
+static std::vector<uint8_t>
+SaveSketch (const QuantileSketch &s)
+{
+  std::vector<uint8_t> buf;
+  s.Save (buf);
+  return buf;
+}
+
+static std::vector<uint8_t>
+SaveAggregator (const FctAggregator &a)
+{
+  std::vector<uint8_t> buf;
+  a.Save (buf);
+  return buf;
+}
+
+/**
+ * Every quantile is within the relative error of the exact quantile, with the
+ * rank convention of plot_fct.py (sorted[int(n * q)]).
+ */
+class QuantileSketchErrorTestCase : public TestCase
+{
+public:
+  QuantileSketchErrorTestCase ();
+  virtual void DoRun (void);
+};
+
+QuantileSketchErrorTestCase::QuantileSketchErrorTestCase ()
+  : TestCase ("QuantileSketch relative error bound")
+{
+}
+
+void
+QuantileSketchErrorTestCase::DoRun (void)
+{
+  double relErrs[] = {0.01, 0.05};
+  for (uint32_t r = 0; r < 2; r++)
+    {
+      QuantileSketch sketch (relErrs[r]);
+      std::vector<double> v = MakeSamples (20000);
+      for (uint32_t i = 0; i < v.size (); i++)
+        {
+          sketch.Add (v[i]);
+        }
+      NS_TEST_ASSERT_MSG_EQ (sketch.Count (), v.size (), "count");
+      std::sort (v.begin (), v.end ());
+      for (uint32_t k = 0; k <= 1000; k++)
+        {
+          double q = k / 1000.0;
+          double exact = v[std::min ((size_t)(v.size () * q), v.size () - 1)];
+          double est = sketch.Quantile (q);
+          NS_TEST_ASSERT_MSG_EQ_TOL (est, exact, relErrs[r] * exact * (1 + 1e-9),
+                                     "quantile " << q << " with relErr " << relErrs[r]);
+        }
+    }
+  QuantileSketch empty;
+  NS_TEST_EXPECT_MSG_EQ (empty.Quantile (0.5), 0, "empty sketch");
+}
+
+/**
+ * Merging sketches gives the same sketch, byte for byte, as adding all the
+ * samples to one sketch, in any split and order.
+ */
+class QuantileSketchMergeTestCase : public TestCase
+{
+public:
+  QuantileSketchMergeTestCase ();
+  virtual void DoRun (void);
+};
+
+QuantileSketchMergeTestCase::QuantileSketchMergeTestCase ()
+  : TestCase ("QuantileSketch merge equals one sketch")
+{
+}
+
+void
+QuantileSketchMergeTestCase::DoRun (void)
+{
+  std::vector<double> v = MakeSamples (5000);
+  QuantileSketch all (0.02), low (0.02), high (0.02), odd (0.02), empty (0.02);
+  for (uint32_t i = 0; i < v.size (); i++)
+    {
+      all.Add (v[i]);
+      (v[i] < 20000 ? low : high).Add (v[i]);  // disjoint bucket ranges
+      if (i % 2)
+        {
+          odd.Add (v[i]);
+        }
+    }
+  QuantileSketch merged = high;
+  merged.Merge (low);  // extends the buckets downwards
+  merged.Merge (empty);
+  NS_TEST_EXPECT_MSG_EQ ((SaveSketch (merged) == SaveSketch (all)), true, "high + low");
+
+  QuantileSketch even (0.02);
+  for (uint32_t i = 0; i < v.size (); i += 2)
+    {
+      even.Add (v[i]);
+    }
+  QuantileSketch interleaved = empty;
+  interleaved.Merge (odd);
+  interleaved.Merge (even);
+  NS_TEST_EXPECT_MSG_EQ ((SaveSketch (interleaved) == SaveSketch (all)), true, "odd + even");
+  for (uint32_t k = 0; k <= 100; k++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (interleaved.Quantile (k / 100.0), all.Quantile (k / 100.0), "quantile " << k);
+    }
+}
+
+/**
+ * Save/Load round-trips a sketch and an aggregator, and a malformed image
+ * (truncated, trailing bytes, another accuracy, a bucket count past the end)
+ * is rejected.
+ */
+class FctAggregatorImageTestCase : public TestCase
+{
+public:
+  FctAggregatorImageTestCase ();
+  virtual void DoRun (void);
+};
+
+FctAggregatorImageTestCase::FctAggregatorImageTestCase ()
+  : TestCase ("Save and Load round trip, malformed images")
+{
+}
+
+void
+FctAggregatorImageTestCase::DoRun (void)
+{
+  std::vector<double> v = MakeSamples (3000);
+  QuantileSketch sketch (0.01);
+  for (uint32_t i = 0; i < v.size (); i++)
+    {
+      sketch.Add (v[i]);
+    }
+  std::vector<uint8_t> image = SaveSketch (sketch);
+  QuantileSketch loaded (0.01);
+  const uint8_t *p = image.data ();
+  NS_TEST_ASSERT_MSG_EQ (loaded.Load (p, image.data () + image.size ()), true, "load");
+  NS_TEST_EXPECT_MSG_EQ ((p == image.data () + image.size ()), true, "whole image read");
+  NS_TEST_EXPECT_MSG_EQ ((SaveSketch (loaded) == image), true, "sketch round trip");
+
+  for (size_t n = 0; n < image.size (); n += 7)
+    {
+      QuantileSketch s (0.01);
+      p = image.data ();
+      NS_TEST_EXPECT_MSG_EQ (s.Load (p, image.data () + n), false, "sketch truncated to " << n);
+    }
+  QuantileSketch other (0.05);
+  p = image.data ();
+  NS_TEST_EXPECT_MSG_EQ (other.Load (p, image.data () + image.size ()), false, "other accuracy");
+  std::vector<uint8_t> bad = image;
+  uint32_t nBins = 0xffffff;
+  memcpy (&bad[8 + 8 + 8 + 4], &nBins, 4);  // relErr, count, zeroCount, offset, nBins
+  QuantileSketch s (0.01);
+  p = bad.data ();
+  NS_TEST_EXPECT_MSG_EQ (s.Load (p, bad.data () + bad.size ()), false, "bucket count past the end");
+
+  FctAggregator agg;
+  agg.SetLbMode (20);
+  agg.SetCcMode (1);
+  agg.SetWindow (2000000000, 1000000);
+  for (uint32_t i = 0; i < v.size (); i++)
+    {
+      agg.Record (1000 + i * 997 % 3000000, 2000000000 + i * 1000, 10000 + v[i], 10000);
+    }
+  std::vector<uint8_t> aggImage = SaveAggregator (agg);
+  FctAggregator copy;
+  copy.SetLbMode (20);
+  copy.SetCcMode (1);
+  copy.SetWindow (2000000000, 1000000);
+  NS_TEST_ASSERT_MSG_EQ (copy.MergeSaved (aggImage.data (), aggImage.size ()), true, "merge into empty");
+  NS_TEST_EXPECT_MSG_EQ (copy.GetNumFlows (), v.size (), "flows");
+  NS_TEST_EXPECT_MSG_EQ ((SaveAggregator (copy) == aggImage), true, "aggregator round trip");
+
+  for (size_t n = 0; n < aggImage.size (); n += 13)
+    {
+      NS_TEST_EXPECT_MSG_EQ (copy.MergeSaved (aggImage.data (), n), false, "image truncated to " << n);
+    }
+  std::vector<uint8_t> trailing = aggImage;
+  trailing.push_back (0);
+  NS_TEST_EXPECT_MSG_EQ (copy.MergeSaved (trailing.data (), trailing.size ()), false, "trailing byte");
+  NS_TEST_EXPECT_MSG_EQ (copy.GetNumFlows (), v.size (), "a rejected image adds nothing");
+}
+
+/**
+ * MergeSaved gives the same result as Merge, and refuses an image of another
+ * configuration (size bins, accuracy, window) without changing the aggregator.
+ */
+class FctAggregatorMergeTestCase : public TestCase
+{
+public:
+  FctAggregatorMergeTestCase ();
+  virtual void DoRun (void);
+};
+
+FctAggregatorMergeTestCase::FctAggregatorMergeTestCase ()
+  : TestCase ("MergeSaved merges and checks the configuration")
+{
+}
+
+static void
+Fill (FctAggregator &a, uint32_t first, uint32_t n)
+{
+  std::vector<double> v = MakeSamples (first + n);
+  for (uint32_t i = first; i < first + n; i++)
+    {
+      a.Record (500 + i * 7919 % 5000000, 2000000000 + i * 300, 8000 + v[i], 8000);
+    }
+}
+
+void
+FctAggregatorMergeTestCase::DoRun (void)
+{
+  FctAggregator rank0, rank1, direct;
+  rank0.SetWindow (2000000000, 100000);
+  rank1.SetWindow (2000000000, 100000);
+  direct.SetWindow (2000000000, 100000);
+  Fill (rank0, 0, 2000);
+  Fill (rank1, 2000, 1500);
+  direct.Merge (rank0);
+  direct.Merge (rank1);
+
+  FctAggregator viaImage;
+  viaImage.SetWindow (2000000000, 100000);
+  std::vector<uint8_t> image0 = SaveAggregator (rank0), image1 = SaveAggregator (rank1);
+  NS_TEST_ASSERT_MSG_EQ (viaImage.MergeSaved (image0.data (), image0.size ()), true, "rank 0");
+  NS_TEST_ASSERT_MSG_EQ (viaImage.MergeSaved (image1.data (), image1.size ()), true, "rank 1");
+  NS_TEST_EXPECT_MSG_EQ ((SaveAggregator (viaImage) == SaveAggregator (direct)), true, "MergeSaved == Merge");
+  NS_TEST_EXPECT_MSG_EQ (viaImage.GetNumFlows (), 3500, "flows");
+
+  std::vector<uint64_t> bins = FctAggregator::DefaultSizeBins ();
+  bins.pop_back ();
+  FctAggregator otherBins, otherErr, otherWindow, otherStart;
+  otherBins.SetSizeBins (bins);
+  otherErr.SetRelErr (0.02);
+  otherWindow.SetWindow (2000000000, 200000);
+  otherStart.SetWindow (1000000000, 100000);
+  FctAggregator *others[] = {&otherBins, &otherErr, &otherWindow, &otherStart};
+  const char *what[] = {"size bins", "relative error", "window length", "window start"};
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      Fill (*others[i], 0, 10);
+      std::vector<uint8_t> image = SaveAggregator (*others[i]);
+      std::vector<uint8_t> before = SaveAggregator (viaImage);
+      NS_TEST_EXPECT_MSG_EQ (viaImage.MergeSaved (image.data (), image.size ()), false, what[i]);
+      NS_TEST_EXPECT_MSG_EQ ((SaveAggregator (viaImage) == before), true, what[i] << " left unchanged");
+    }
+}
+
+class FctAggregatorTestSuite : public TestSuite
+{
+public:
+  FctAggregatorTestSuite ();
+};
+
+FctAggregatorTestSuite::FctAggregatorTestSuite ()
+  : TestSuite ("fct-aggregator", UNIT)
+{
+  AddTestCase (new QuantileSketchErrorTestCase);
+  AddTestCase (new QuantileSketchMergeTestCase);
+  AddTestCase (new FctAggregatorImageTestCase);
+  AddTestCase (new FctAggregatorMergeTestCase);
+}
+
+static FctAggregatorTestSuite g_fctAggregatorTestSuite;
@@ -0,0 +1,248 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CAVER-LB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "ns3/fluid-model.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+#include "rdma-test-network.h"
+
+using namespace ns3;
+
+/*
+ * FluidModel in the flow-level mode: the max-min rates of a hand-checked
+ * case, and the incremental refill (only the components of the touched
+ * links) against a full progressive filling of every flow at every
+ * arrival and departure, on random topologies.
+ */
+
+struct FluidFlow
+{
+  uint32_t src, dst;
+  uint64_t bytes;
+  uint64_t startNs;
+};
+
+static FluidModel *g_fluid;
+static RdmaTestNetwork *g_net;
+static std::vector<FluidFlow> g_fluidFlows;
+static std::vector<FluidModel::Finished> g_finished;
+static uint32_t g_nHosts, g_nSwitches;
+static std::vector<std::vector<uint32_t> > g_links;  // (a, b, Gbps)
+static bool g_incremental;
+
+static void
+StartFluidFlow (uint32_t id)
+{
+  const FluidFlow &f = g_fluidFlows[id];
+  g_fluid->AddFlow (id, g_net->GetNode (f.src), g_net->GetNode (f.dst),
+                    Settings::node_id_to_ip (f.src).Get (), Settings::node_id_to_ip (f.dst).Get (),
+                    10000 + id, 100 + id, 3, f.bytes);
+}
+
+static void
+OnFluidFinish (const FluidModel::Finished &fin)
+{
+  g_finished.push_back (fin);
+}
+
+static bool
+ByFlowId (const FluidModel::Finished &a, const FluidModel::Finished &b)
+{
+  return a.flowId < b.flowId;
+}
+
+/* runs g_fluidFlows over g_links to completion, finished flows by id */
+static void
+FluidScenario (std::vector<FluidModel::Finished> &out)
+{
+  RdmaTestNetwork net;
+  for (uint32_t i = 0; i < g_nHosts; i++)
+    {
+      net.AddHost ();
+    }
+  for (uint32_t i = 0; i < g_nSwitches; i++)
+    {
+      net.AddSwitch (i + 1);  // the same ECMP paths in every run
+    }
+  for (uint32_t i = 0; i < g_links.size (); i++)
+    {
+      net.AddLink (g_links[i][0], g_links[i][1], std::to_string (g_links[i][2]) + "Gbps");
+    }
+  net.Build ();
+
+  FluidModel fluid;
+  fluid.SetStandalone (true);
+  fluid.SetCapacityFactor (1.0);
+  fluid.SetIncremental (g_incremental);
+  fluid.SetFinishCallback (MakeCallback (&OnFluidFinish));
+  g_fluid = &fluid;
+  g_net = &net;
+  g_finished.clear ();
+  for (uint32_t i = 0; i < g_fluidFlows.size (); i++)
+    {
+      Simulator::Schedule (NanoSeconds (g_fluidFlows[i].startNs), &StartFluidFlow, i);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+  g_fluid = NULL;
+  g_net = NULL;
+  std::sort (g_finished.begin (), g_finished.end (), &ByFlowId);
+  out = g_finished;
+}
+
+class FluidMaxMinTestCase : public TestCase
+{
+public:
+  FluidMaxMinTestCase ()
+    : TestCase ("FluidModel: max-min rates of a shared bottleneck")
+  {
+  }
+
+private:
+  virtual void DoRun (void);
+};
+
+void
+FluidMaxMinTestCase::DoRun (void)
+{
+  /*
+   * Hosts 0 and 1 send 1MB to host 2 over a 40G port: 20G each. Host 0
+   * also sends 1MB to host 3 with the 80G left on its NIC, done in 100us.
+   */
+  g_nHosts = 4;
+  g_nSwitches = 1;
+  g_links.clear ();
+  g_links.push_back ({ 0, 4, 100 });
+  g_links.push_back ({ 1, 4, 100 });
+  g_links.push_back ({ 2, 4, 40 });
+  g_links.push_back ({ 3, 4, 100 });
+  g_fluidFlows.clear ();
+  g_fluidFlows.push_back ({ 0, 2, 1000000, 0 });
+  g_fluidFlows.push_back ({ 1, 2, 1000000, 0 });
+  g_fluidFlows.push_back ({ 0, 3, 1000000, 0 });
+  g_incremental = true;
+  std::vector<FluidModel::Finished> fin;
+  NS_TEST_ASSERT_MSG_EQ (RdmaTestNetwork::RunIsolated (&FluidScenario, fin), true,
+                         "fluid run failed");
+  NS_TEST_ASSERT_MSG_EQ (fin.size (), 3, "all the flows complete");
+  NS_TEST_EXPECT_MSG_EQ (fin[0].fctNs, 400000, "1MB at 20G");
+  NS_TEST_EXPECT_MSG_EQ (fin[1].fctNs, 400000, "1MB at 20G");
+  NS_TEST_EXPECT_MSG_EQ (fin[2].fctNs, 100000, "1MB at 80G");
+}
+
+class FluidIncrementalTestCase : public TestCase
+{
+public:
+  FluidIncrementalTestCase ()
+    : TestCase ("FluidModel: incremental refill equals full progressive filling")
+  {
+  }
+
+private:
+  virtual void DoRun (void);
+};
+
+void
+FluidIncrementalTestCase::DoRun (void)
+{
+  const uint32_t gbps[] = { 25, 40, 100 };
+  for (uint32_t seed = 1; seed <= 12; seed++)
+    {
+      std::mt19937 rng (seed);
+      uint32_t nHosts = 4 + rng () % 9, nSwitches = 2 + rng () % 5;
+      g_nHosts = nHosts;
+      g_nSwitches = nSwitches;
+      g_links.clear ();
+      std::set<std::pair<uint32_t, uint32_t> > used;
+      for (uint32_t s = 1; s < nSwitches; s++)  // a random tree over the switches...
+        {
+          uint32_t p = rng () % s;
+          g_links.push_back ({ nHosts + p, nHosts + s, gbps[rng () % 3] });
+          used.insert (std::make_pair (p, s));
+        }
+      for (uint32_t k = 0; k < nSwitches; k++)  // ...with a few more links: several paths
+        {
+          uint32_t a = rng () % nSwitches, b = rng () % nSwitches;
+          if (a == b || used.count (std::make_pair (std::min (a, b), std::max (a, b))))
+            {
+              continue;
+            }
+          used.insert (std::make_pair (std::min (a, b), std::max (a, b)));
+          g_links.push_back ({ nHosts + a, nHosts + b, gbps[rng () % 3] });
+        }
+      for (uint32_t h = 0; h < nHosts; h++)
+        {
+          g_links.push_back ({ h, nHosts + (uint32_t) (rng () % nSwitches), gbps[rng () % 3] });
+        }
+      g_fluidFlows.clear ();
+      for (uint32_t i = 0; i < 60; i++)
+        {
+          FluidFlow f;
+          f.src = rng () % nHosts;
+          f.dst = (f.src + 1 + rng () % (nHosts - 1)) % nHosts;
+          f.bytes = 1000 + rng () % 2000000;
+          f.startNs = rng () % 300000;
+          g_fluidFlows.push_back (f);
+        }
+
+      std::vector<FluidModel::Finished> inc, full;
+      g_incremental = true;
+      NS_TEST_ASSERT_MSG_EQ (RdmaTestNetwork::RunIsolated (&FluidScenario, inc), true,
+                             "seed " << seed << ": incremental run failed");
+      g_incremental = false;
+      NS_TEST_ASSERT_MSG_EQ (RdmaTestNetwork::RunIsolated (&FluidScenario, full), true,
+                             "seed " << seed << ": full run failed");
+      NS_TEST_ASSERT_MSG_EQ (inc.size (), g_fluidFlows.size (), "seed " << seed);
+      NS_TEST_ASSERT_MSG_EQ (full.size (), g_fluidFlows.size (), "seed " << seed);
+      for (uint32_t i = 0; i < inc.size (); i++)
+        {
+          // the same rates up to rounding: completion times within a few ns
+          NS_TEST_EXPECT_MSG_EQ_TOL ((double) inc[i].fctNs, (double) full[i].fctNs,
+                                     (4 + 1e-6 * full[i].fctNs),
+                                     "seed " << seed << " flow " << inc[i].flowId);
+        }
+    }
+}
+
+class FluidModelTestSuite : public TestSuite
+{
+public:
+  FluidModelTestSuite ();
+};
+
+FluidModelTestSuite::FluidModelTestSuite ()
+  : TestSuite ("fluid-model", UNIT)
+{
+  AddTestCase (new FluidMaxMinTestCase);
+  AddTestCase (new FluidIncrementalTestCase);
+}
+
+static FluidModelTestSuite g_fluidModelTestSuite;
@@ -0,0 +1,241 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CAVER-LB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include "ns3/custom-header.h"
+#include "ns3/hula-routing.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+#include "rdma-test-network.h"
+
+using namespace ns3;
+
+struct ReceivedProbe
+{
+  uint32_t torID;
+  uint8_t minUtil;
+  uint64_t uid;
+};
+
+static std::vector<ReceivedProbe> g_received;
+
+static void
+ProbeReceived (Ptr<const Packet> p)
+{
+  CustomHeader ch (CustomHeader::L2_Header | CustomHeader::L3_Header | CustomHeader::L4_Header);
+  p->PeekHeader (ch);
+  if (ch.l3Prot != 0xFB)
+    {
+      return;
+    }
+  ReceivedProbe r;
+  r.torID = ch.hula.data.torID;
+  r.minUtil = ch.hula.data.minUtil;
+  r.uid = p->GetUid ();
+  g_received.push_back (r);
+}
+
+/* `n` probes back to back on `dev`: all but the first wait in its queue */
+static void
+SendProbes (Ptr<QbbNetDevice> dev, uint32_t firstTorID, uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      dev->SendHulaProbe (firstTorID + i, (uint8_t) i);
+    }
+}
+
+/**
+ * QbbNetDevice recycles a pooled probe only once nothing else references
+ * it: a burst longer than the pool, still queued behind the first probe,
+ * arrives with every torID/minUtil intact, and a later burst re-sends the
+ * pooled packets (same uid) with the new values patched in.
+ */
+class HulaProbePoolTestCase : public TestCase
+{
+public:
+  HulaProbePoolTestCase ();
+  virtual void DoRun (void);
+};
+
+HulaProbePoolTestCase::HulaProbePoolTestCase ()
+  : TestCase ("Pooled HULA probes are not overwritten while queued")
+{
+}
+
+void
+HulaProbePoolTestCase::DoRun (void)
+{
+  const uint32_t burst = 40;  // more than the pool holds
+  RdmaTestNetwork net;
+  uint32_t a = net.AddSwitch ();
+  uint32_t b = net.AddSwitch ();
+  net.AddLink (a, b);
+  net.Build ();
+  // the receiver consumes the probes as a HULA switch does
+  Ptr<HulaRouting> hula = CreateObject<HulaRouting> ();
+  hula->SetConstants (MicroSeconds (350), MicroSeconds (70), MicroSeconds (100),
+                      MicroSeconds (70), MicroSeconds (210));
+  hula->SetLinkCapacity (net.GetDevice (b, a)->GetIfIndex (), 100000000000lu);
+  DynamicCast<SwitchNode> (net.GetNode (b))->SetLoadBalancer (hula);
+  net.GetDevice (b, a)->TraceConnectWithoutContext ("MacRx", MakeCallback (&ProbeReceived));
+
+  g_received.clear ();
+  Simulator::Schedule (MicroSeconds (1), &SendProbes, net.GetDevice (a, b), 1000, burst);
+  Simulator::Schedule (MicroSeconds (100), &SendProbes, net.GetDevice (a, b), 2000, burst);
+  net.Run (MicroSeconds (200));
+  std::vector<ReceivedProbe> received = g_received;
+  Simulator::Destroy ();
+  hula = 0;
+  HulaRouting::hulaModules.clear ();
+
+  NS_TEST_ASSERT_MSG_EQ (received.size (), 2 * burst, "every probe arrives");
+  for (uint32_t i = 0; i < 2 * burst; i++)
+    {
+      uint32_t k = i % burst;
+      NS_TEST_EXPECT_MSG_EQ (received[i].torID, (i < burst ? 1000 : 2000) + k, "torID of probe " << i);
+      NS_TEST_EXPECT_MSG_EQ ((uint32_t) received[i].minUtil, k, "minUtil of probe " << i);
+    }
+  std::vector<uint64_t> firstUids;
+  for (uint32_t i = 0; i < burst; i++)
+    {
+      firstUids.push_back (received[i].uid);
+    }
+  std::sort (firstUids.begin (), firstUids.end ());
+  NS_TEST_EXPECT_MSG_EQ ((std::unique (firstUids.begin (), firstUids.end ()) == firstUids.end ()),
+                         true, "no packet sent twice within the first burst");
+  for (uint32_t k = 0; k < 16; k++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (received[burst + k].uid, received[k].uid,
+                             "probe " << k << " of the second burst reuses the pooled packet");
+    }
+}
+
+struct SentProbe
+{
+  uint64_t timeNs;
+  uint32_t torID;
+  uint32_t dev;
+  bool operator== (const SentProbe &o) const
+  {
+    return timeNs == o.timeNs && torID == o.torID && dev == o.dev;
+  }
+};
+
+static std::vector<SentProbe> g_sent;
+
+static void
+ProbeSent (uint32_t dev, uint32_t torID, uint8_t minUtil)
+{
+  SentProbe s;
+  s.timeNs = Simulator::Now ().GetNanoSeconds ();
+  s.torID = torID;
+  s.dev = dev;
+  g_sent.push_back (s);
+}
+
+/* probes generated by switches activated out of id order, with 1 to 3 uplinks each */
+static std::vector<SentProbe>
+GenerateProbes (bool batching)
+{
+  const uint32_t ids[] = {5, 2, 9, 7};
+  HulaRouting::probeBatching = batching;
+  g_sent.clear ();
+  std::vector<Ptr<HulaRouting> > modules;
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      Ptr<HulaRouting> hula = CreateObject<HulaRouting> ();
+      hula->SetSwitchInfo (false, ids[i]);
+      hula->SetConstants (MicroSeconds (350), MicroSeconds (70), MicroSeconds (100),
+                          MicroSeconds (70), MicroSeconds (210));
+      for (uint32_t dev = 1; dev <= i % 3 + 1; dev++)
+        {
+          hula->upLayerDevs.insert (dev * 10 + i);
+        }
+      hula->SetSwitchSendHulaProbeCallback (MakeCallback (&ProbeSent));
+      hula->active (1);
+      modules.push_back (hula);
+    }
+  Simulator::Stop (Seconds (1) + MicroSeconds (10));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  HulaRouting::probeBatching = false;
+  HulaRouting::probeBatchModules.clear ();
+  HulaRouting::probeBatchEvent = EventId ();
+  HulaRouting::hulaModules.clear ();
+  return g_sent;
+}
+
+/**
+ * HULA_PROBE_BATCHING: the single timer event emits the probes at the same
+ * times and in the same order as one generateProbe event per switch.
+ */
+class HulaProbeBatchingTestCase : public TestCase
+{
+public:
+  HulaProbeBatchingTestCase ();
+  virtual void DoRun (void);
+};
+
+HulaProbeBatchingTestCase::HulaProbeBatchingTestCase ()
+  : TestCase ("HULA probe batching keeps the per-switch order")
+{
+}
+
+void
+HulaProbeBatchingTestCase::DoRun (void)
+{
+  std::vector<SentProbe> perSwitch = GenerateProbes (false);
+  std::vector<SentProbe> batched = GenerateProbes (true);
+  // start 500us before 1s, every 70us: 8 rounds of 1 + 2 + 3 + 1 probes
+  NS_TEST_ASSERT_MSG_EQ (perSwitch.size (), 8 * 7u, "probes per switch");
+  NS_TEST_ASSERT_MSG_EQ (batched.size (), perSwitch.size (), "probes batched");
+  for (uint32_t i = 0; i < perSwitch.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ ((batched[i] == perSwitch[i]), true,
+                             "probe " << i << ": " << batched[i].timeNs << "ns " << batched[i].torID
+                                      << "/" << batched[i].dev << " instead of "
+                                      << perSwitch[i].timeNs << "ns " << perSwitch[i].torID << "/"
+                                      << perSwitch[i].dev);
+    }
+}
+
+class HulaProbeTestSuite : public TestSuite
+{
+public:
+  HulaProbeTestSuite ();
+};
+
+HulaProbeTestSuite::HulaProbeTestSuite ()
+  : TestSuite ("hula-probe", UNIT)
+{
+  AddTestCase (new HulaProbePoolTestCase);
+  AddTestCase (new HulaProbeBatchingTestCase);
+}
+
+static HulaProbeTestSuite g_hulaProbeTestSuite;
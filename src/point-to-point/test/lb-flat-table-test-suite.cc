@@ -0,0 +1,413 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CAVER-LB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <signal.h>
+#include <stdio.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <map>
+#include <set>
+#include <vector>
+
+#include "ns3/conga-routing.h"
+#include "ns3/lb-flat-table.h"
+#include "ns3/path-codec.h"
+#include "ns3/settings.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+namespace ns3 {
+
+/**
+ * FlatPathTable keeps the ToR -> {pathId} map as CSR arrays: ordinals follow the ToR
+ * order, slots of a ToR follow the std::set order, and a re-Freeze forgets old ToRs.
+ */
+class FlatPathTableTestCase : public TestCase
+{
+public:
+  FlatPathTableTestCase ();
+  virtual void DoRun (void);
+};
+
+FlatPathTableTestCase::FlatPathTableTestCase ()
+  : TestCase ("FlatPathTable lookup")
+{
+}
+
+void
+FlatPathTableTestCase::DoRun (void)
+{
+  FlatPathTable table;
+  NS_TEST_ASSERT_MSG_EQ (table.IsFrozen (), false, "frozen before Freeze");
+  NS_TEST_ASSERT_MSG_EQ (table.GetOrdinal (0), FlatPathTable::INVALID, "empty table");
+
+  std::map<uint32_t, std::set<uint32_t> > m;
+  m[1].insert (2);
+  m[3].insert (10);
+  m[3].insert (5);
+  m[3].insert (7);
+  m[9];  // a ToR without paths
+  table.Freeze (m);
+  NS_TEST_ASSERT_MSG_EQ (table.IsFrozen (), true, "not frozen");
+  NS_TEST_ASSERT_MSG_EQ (table.GetNumToRs (), 3, "number of ToRs");
+  NS_TEST_ASSERT_MSG_EQ (table.GetNumSlots (), 4, "number of slots");
+  NS_TEST_ASSERT_MSG_EQ (table.GetOrdinal (1), 0, "ordinal of ToR 1");
+  NS_TEST_ASSERT_MSG_EQ (table.GetOrdinal (3), 1, "ordinal of ToR 3");
+  NS_TEST_ASSERT_MSG_EQ (table.GetOrdinal (9), 2, "ordinal of ToR 9");
+  NS_TEST_ASSERT_MSG_EQ (table.GetOrdinal (2), FlatPathTable::INVALID, "ToR 2 has no entry");
+  NS_TEST_ASSERT_MSG_EQ (table.GetOrdinal (1000), FlatPathTable::INVALID, "ToR beyond the table");
+  for (uint32_t ord = 0; ord < table.GetNumToRs (); ord++)
+    {
+      const std::set<uint32_t> &paths = m[table.GetToRId (ord)];
+      NS_TEST_ASSERT_MSG_EQ (table.Size (ord), paths.size (), "size of ordinal " << ord);
+      NS_TEST_ASSERT_MSG_EQ (table.End (ord) - table.Begin (ord), table.Size (ord), "slot range");
+      uint32_t slot = table.Begin (ord);
+      for (std::set<uint32_t>::const_iterator it = paths.begin (); it != paths.end (); ++it, ++slot)
+        {
+          NS_TEST_ASSERT_MSG_EQ (table.PathId (slot), *it, "slot order differs from the set");
+          NS_TEST_ASSERT_MSG_EQ (table.FindSlot (ord, *it), slot, "FindSlot");
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (table.FindSlot (1, 2), FlatPathTable::INVALID, "path of another ToR");
+  NS_TEST_ASSERT_MSG_EQ (table.FindSlot (2, 5), FlatPathTable::INVALID, "ToR without paths");
+
+  std::map<uint32_t, std::set<uint32_t> > m2;
+  m2[5].insert (1);
+  table.Freeze (m2);
+  NS_TEST_ASSERT_MSG_EQ (table.GetNumToRs (), 1, "re-Freeze keeps old ToRs");
+  NS_TEST_ASSERT_MSG_EQ (table.GetOrdinal (3), FlatPathTable::INVALID, "stale ordinal after re-Freeze");
+  NS_TEST_ASSERT_MSG_EQ (table.GetOrdinal (5), 0, "ordinal after re-Freeze");
+  NS_TEST_ASSERT_MSG_EQ (table.PathId (table.Begin (0)), 1, "path after re-Freeze");
+}
+
+/**
+ * FlowletHashTable against a std::map: insert/overwrite, lookups across rehashes,
+ * value pointers (distinct per key, writes through them visible to Find), EraseIf, Clear.
+ */
+class FlowletHashTableTestCase : public TestCase
+{
+public:
+  FlowletHashTableTestCase ();
+  virtual void DoRun (void);
+
+private:
+  bool Matches (FlowletHashTable<uint32_t> &table, const std::map<uint64_t, uint32_t> &ref);
+};
+
+FlowletHashTableTestCase::FlowletHashTableTestCase ()
+  : TestCase ("FlowletHashTable insert and lookup")
+{
+}
+
+bool
+FlowletHashTableTestCase::Matches (FlowletHashTable<uint32_t> &table,
+                                   const std::map<uint64_t, uint32_t> &ref)
+{
+  if (table.Size () != ref.size ())
+    return false;
+  for (std::map<uint64_t, uint32_t>::const_iterator it = ref.begin (); it != ref.end (); ++it)
+    {
+      uint32_t *v = table.Find (it->first);
+      if (v == NULL || *v != it->second)
+        return false;
+    }
+  return true;
+}
+
+static bool
+IsOdd (const uint32_t &v)
+{
+  return v & 1;
+}
+
+void
+FlowletHashTableTestCase::DoRun (void)
+{
+  FlowletHashTable<uint32_t> table;
+  std::map<uint64_t, uint32_t> ref;
+  NS_TEST_ASSERT_MSG_EQ (table.Size (), 0, "new table not empty");
+  NS_TEST_ASSERT_MSG_EQ ((table.Find (0) == NULL), true, "found a key in an empty table");
+
+  // QpKey-like keys (dip << 32 | sport << 16 | pg), key 0, and keys differing only in the
+  // high bits; 3000 keys go through several rehashes from the initial 64 slots
+  std::vector<uint64_t> keys;
+  keys.push_back (0);
+  for (uint64_t i = 1; i < 1000; i++)
+    {
+      keys.push_back (((0x0b000001ULL + i % 32) << 32) | ((10000 + i) << 16) | 3);
+      keys.push_back (i << 40);
+      keys.push_back (i);
+    }
+  for (uint32_t i = 0; i < keys.size (); i++)
+    {
+      uint32_t *v = table.Insert (keys[i], i);
+      ref[keys[i]] = i;
+      NS_TEST_ASSERT_MSG_EQ (*v, i, "Insert returns the stored value");
+      NS_TEST_ASSERT_MSG_EQ ((table.Find (keys[i]) == v), true, "Find and Insert disagree");
+    }
+  NS_TEST_ASSERT_MSG_EQ (Matches (table, ref), true, "contents after inserts");
+  NS_TEST_ASSERT_MSG_EQ ((table.Find (1ULL << 63) == NULL), true, "found an absent key");
+
+  // overwrite: same slot, size unchanged
+  uint32_t *old = table.Find (keys[7]);
+  uint32_t *v = table.Insert (keys[7], 424242);
+  ref[keys[7]] = 424242;
+  NS_TEST_ASSERT_MSG_EQ ((v == old), true, "overwrite moved the value");
+  NS_TEST_ASSERT_MSG_EQ (table.Size (), ref.size (), "overwrite changed the size");
+
+  // value pointers alias the slot of their key only
+  uint32_t *a = table.Find (keys[1]);
+  uint32_t *b = table.Find (keys[2]);
+  NS_TEST_ASSERT_MSG_EQ ((a != b), true, "two keys share a value");
+  *a = 77;
+  ref[keys[1]] = 77;
+  NS_TEST_ASSERT_MSG_EQ (*table.Find (keys[1]), 77, "write through the value pointer lost");
+  NS_TEST_ASSERT_MSG_EQ (*b, ref[keys[2]], "write through another key's pointer");
+  NS_TEST_ASSERT_MSG_EQ (Matches (table, ref), true, "contents after writes");
+
+  // aging: drop odd values, then the table is rebuilt smaller and keeps the rest
+  table.EraseIf (IsOdd);
+  for (std::map<uint64_t, uint32_t>::iterator it = ref.begin (); it != ref.end ();)
+    {
+      if (it->second & 1)
+        ref.erase (it++);
+      else
+        ++it;
+    }
+  NS_TEST_ASSERT_MSG_EQ (Matches (table, ref), true, "contents after EraseIf");
+  NS_TEST_ASSERT_MSG_EQ ((table.Find (keys[1]) == NULL), true, "erased key still found");
+  table.EraseIf (IsOdd);  // nothing to erase
+  NS_TEST_ASSERT_MSG_EQ (Matches (table, ref), true, "contents after an empty EraseIf");
+
+  // re-insert erased keys
+  for (uint32_t i = 1; i < keys.size (); i += 2)
+    {
+      table.Insert (keys[i], i + 1);
+      ref[keys[i]] = i + 1;
+    }
+  NS_TEST_ASSERT_MSG_EQ (Matches (table, ref), true, "contents after re-inserting");
+
+  uint64_t bytes = table.GetMemoryBytes ();
+  table.Clear ();
+  NS_TEST_ASSERT_MSG_EQ (table.Size (), 0, "Clear left entries");
+  NS_TEST_ASSERT_MSG_EQ ((table.Find (keys[0]) == NULL), true, "key found after Clear");
+  NS_TEST_ASSERT_MSG_LT (table.GetMemoryBytes (), bytes, "Clear did not shrink the table");
+}
+
+/*
+ * A source ToR (switch 32) running CONGA towards ToR 33; the host ids/flow ids it reads
+ * from Settings are set up per flow.
+ */
+class CongaTestBase : public TestCase
+{
+public:
+  CongaTestBase (std::string name) : TestCase (name) {}
+
+protected:
+  Ptr<CongaRouting> CreateConga (uint32_t nPorts);
+  /* a data packet (or an ACK) of a flow from host 0 under ToR 32 to host 1 under dstToR */
+  void SendFlow (Ptr<CongaRouting> conga, uint16_t sport, uint32_t dstToR, uint8_t l3Prot);
+  void ClearSettings (void);
+
+  void OnSend (Ptr<Packet> p, CustomHeader &ch, uint32_t outDev, uint32_t qIndex)
+  {
+    m_outDev.push_back (outDev);
+  }
+  void OnSendToDev (Ptr<Packet> p, CustomHeader &ch)
+  {
+    m_nToDev++;
+  }
+
+  std::vector<uint32_t> m_outDev;
+  uint32_t m_nToDev;
+  std::vector<uint32_t> m_flowIds;
+};
+
+Ptr<CongaRouting>
+CongaTestBase::CreateConga (uint32_t nPorts)
+{
+  m_outDev.clear ();
+  m_nToDev = 0;
+  Ptr<CongaRouting> conga = CreateObject<CongaRouting> ();
+  conga->SetSwitchInfo (true, 32);
+  for (uint32_t port = 1; port <= nPorts; port++)
+    conga->SetLinkCapacity (port, 100000000000lu);
+  conga->SetSwitchSendCallback (MakeCallback (&CongaTestBase::OnSend, this));
+  conga->SetSwitchSendToDevCallback (MakeCallback (&CongaTestBase::OnSendToDev, this));
+  return conga;
+}
+
+void
+CongaTestBase::SendFlow (Ptr<CongaRouting> conga, uint16_t sport, uint32_t dstToR, uint8_t l3Prot)
+{
+  CustomHeader ch (CustomHeader::L2_Header | CustomHeader::L3_Header | CustomHeader::L4_Header);
+  ch.l3Prot = l3Prot;
+  ch.sip = 0x0b000001;
+  ch.dip = 0x0b000101;
+  ch.udp.sport = sport;
+  ch.udp.dport = 100;
+  ch.udp.pg = 3;
+  Settings::hostIp2IdMap[ch.sip] = 0;
+  Settings::hostIp2IdMap[ch.dip] = 1;
+  uint32_t flowId = 1000000 + sport;
+  Settings::PacketId2FlowId[std::make_tuple (0u, 1u, (uint32_t)sport, 100u)] = flowId;
+  Settings::flowId2SrcDst[flowId] = std::make_pair (32u, dstToR);
+  m_flowIds.push_back (flowId);
+  conga->RouteInput (Create<Packet> (1000), ch);
+}
+
+void
+CongaTestBase::ClearSettings (void)
+{
+  for (uint32_t i = 0; i < m_flowIds.size (); i++)
+    {
+      Settings::PacketId2FlowId.erase (
+          std::make_tuple (0u, 1u, (uint32_t)(m_flowIds[i] - 1000000), 100u));
+      Settings::flowId2SrcDst.erase (m_flowIds[i]);
+    }
+  Settings::hostIp2IdMap.erase (0x0b000001);
+  Settings::hostIp2IdMap.erase (0x0b000101);
+  m_flowIds.clear ();
+}
+
+/**
+ * CONGA freezes m_congaRoutingTable into its flat tables at the first data packet:
+ * routes changed before (control packets do not freeze) are used, routes changed
+ * after are not.
+ */
+class CongaLazyFreezeTestCase : public CongaTestBase
+{
+public:
+  CongaLazyFreezeTestCase () : CongaTestBase ("CONGA freezes its tables at the first data packet") {}
+  virtual void DoRun (void);
+};
+
+void
+CongaLazyFreezeTestCase::DoRun (void)
+{
+  Ptr<CongaRouting> conga = CreateConga (2);
+  uint16_t viaPort1[] = {1, 5, 6};
+  uint16_t viaPort2[] = {2, 5, 6};
+  uint32_t path1 = PathCodec::Intern (PathCodec::Ports (viaPort1, viaPort1 + 3));
+  uint32_t path2 = PathCodec::Intern (PathCodec::Ports (viaPort2, viaPort2 + 3));
+
+  conga->m_congaRoutingTable[33].insert (path1);
+  SendFlow (conga, 10000, 33, 0xFC);  // an ACK: passed to the device, tables not built
+  NS_TEST_ASSERT_MSG_EQ (m_nToDev, 1, "ACK not passed through");
+
+  conga->m_congaRoutingTable[33].clear ();
+  conga->m_congaRoutingTable[33].insert (path2);
+  SendFlow (conga, 10001, 33, 0x11);
+  NS_TEST_ASSERT_MSG_EQ (m_outDev.size (), 1, "data packet not sent");
+  NS_TEST_ASSERT_MSG_EQ (m_outDev[0], 2, "route set before the first data packet not used");
+
+  conga->m_congaRoutingTable[33].clear ();
+  conga->m_congaRoutingTable[33].insert (path1);
+  SendFlow (conga, 10002, 33, 0x11);
+  NS_TEST_ASSERT_MSG_EQ (m_outDev.size (), 2, "data packet not sent");
+  NS_TEST_ASSERT_MSG_EQ (m_outDev[1], 2, "route changed after the freeze was used");
+
+  ClearSettings ();
+  conga->Dispose ();
+  Simulator::Destroy ();
+}
+
+/**
+ * GetBestPath samples at most CONGA_MAX_SAMPLE consecutive slots: more paths than that
+ * are fine, fewer than nSample clamp nSample, and asking for more aborts.
+ */
+class CongaMaxSampleTestCase : public CongaTestBase
+{
+public:
+  CongaMaxSampleTestCase () : CongaTestBase ("CONGA path sampling bound") {}
+  virtual void DoRun (void);
+};
+
+void
+CongaMaxSampleTestCase::DoRun (void)
+{
+  const uint32_t nPaths = CONGA_MAX_SAMPLE + 4;
+  Ptr<CongaRouting> conga = CreateConga (nPaths);
+  for (uint16_t port = 1; port <= nPaths; port++)
+    {
+      uint16_t ports[] = {port, 100, 101};
+      uint32_t pathId = PathCodec::Intern (PathCodec::Ports (ports, ports + 3));
+      conga->m_congaRoutingTable[33].insert (pathId);
+      if (port <= CONGA_MAX_SAMPLE / 2)
+        conga->m_congaRoutingTable[34].insert (pathId);
+    }
+  SendFlow (conga, 20000, 33, 0x11);  // builds the flat tables
+  NS_TEST_ASSERT_MSG_EQ (m_outDev.size (), 1, "data packet not sent");
+
+  const std::set<uint32_t> &paths33 = conga->m_congaRoutingTable[33];
+  const std::set<uint32_t> &paths34 = conga->m_congaRoutingTable[34];
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      uint32_t pathId = conga->GetBestPath (33, CONGA_MAX_SAMPLE);
+      NS_TEST_ASSERT_MSG_EQ (paths33.count (pathId), 1, "best path not a path to ToR 33");
+      // fewer paths than nSample: nSample is clamped, no assert
+      pathId = conga->GetBestPath (34, CONGA_MAX_SAMPLE + 1);
+      NS_TEST_ASSERT_MSG_EQ (paths34.count (pathId), 1, "best path not a path to ToR 34");
+    }
+
+#ifndef NDEBUG
+  fflush (NULL);
+  pid_t pid = fork ();
+  if (pid == 0)
+    {
+      freopen ("/dev/null", "w", stderr);
+      conga->GetBestPath (33, CONGA_MAX_SAMPLE + 1);
+      _exit (0);
+    }
+  int status = 0;
+  NS_TEST_ASSERT_MSG_EQ (waitpid (pid, &status, 0), pid, "waitpid");
+  NS_TEST_ASSERT_MSG_EQ ((WIFSIGNALED (status) && WTERMSIG (status) == SIGABRT), true,
+                         "sampling more than CONGA_MAX_SAMPLE paths did not abort");
+#endif
+
+  ClearSettings ();
+  conga->Dispose ();
+  Simulator::Destroy ();
+}
+
+class LbFlatTableTestSuite : public TestSuite
+{
+public:
+  LbFlatTableTestSuite ();
+};
+
+LbFlatTableTestSuite::LbFlatTableTestSuite ()
+  : TestSuite ("lb-flat-table", UNIT)
+{
+  AddTestCase (new FlatPathTableTestCase);
+  AddTestCase (new FlowletHashTableTestCase);
+  AddTestCase (new CongaLazyFreezeTestCase);
+  AddTestCase (new CongaMaxSampleTestCase);
+}
+
+static LbFlatTableTestSuite g_lbFlatTableTestSuite;
+
+} // namespace ns3
@@ -0,0 +1,378 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CAVER-LB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+
+#include <map>
+#include <set>
+#include <vector>
+
+#include "ns3/path-codec.h"
+#include "ns3/test.h"
+
+#include "rdma-test-network.h"
+
+using namespace ns3;
+
+/*
+ * PathCodec ids are process-wide, so the cases below only rely on what
+ * interning guarantees (same ports, same id) and never on absolute ids;
+ * Freeze() is only ever called in a child process.
+ */
+
+/* a switch graph built through PathSetBuilder, with (switch, port) -> peer to walk the paths */
+class PathTopology
+{
+public:
+  void AddSwitch (uint32_t id, bool isToR)
+  {
+    m_builder.AddSwitch (id, isToR);
+    m_isToR[id] = isToR;
+  }
+  void AddLink (uint32_t a, uint32_t portA, uint32_t b, uint32_t portB)
+  {
+    m_builder.AddLink (a, b, portA);
+    m_builder.AddLink (b, a, portB);
+    m_peer[std::make_pair (a, portA)] = b;
+    m_peer[std::make_pair (b, portB)] = a;
+  }
+  std::vector<uint32_t> Build (uint32_t srcToR, uint32_t dstToR)
+  {
+    return m_builder.Build (srcToR, dstToR);
+  }
+  /* the switch the path ends at, or UINT32_MAX if a port leads nowhere or through another ToR */
+  uint32_t Walk (uint32_t srcToR, uint32_t pathId) const
+  {
+    uint32_t node = srcToR;
+    PathCodec::Ports ports = PathCodec::GetPorts (pathId);
+    for (uint32_t i = 0; i < ports.size (); i++)
+      {
+        if (i > 0 && m_isToR.at (node))
+          {
+            return UINT32_MAX;
+          }
+        std::map<std::pair<uint32_t, uint32_t>, uint32_t>::const_iterator it =
+            m_peer.find (std::make_pair (node, (uint32_t) ports[i]));
+        if (it == m_peer.end ())
+          {
+            return UINT32_MAX;
+          }
+        node = it->second;
+      }
+    return node;
+  }
+
+private:
+  PathSetBuilder m_builder;
+  std::map<uint32_t, bool> m_isToR;
+  std::map<std::pair<uint32_t, uint32_t>, uint32_t> m_peer;
+};
+
+/*
+ * 3-tier fat-tree (5-stage folded Clos) of radix 4: ToR 0..7 (pod = id / 2),
+ * aggregation 8..15, core 16..19. ToR up ports 3, 4; aggregation down ports
+ * 1, 2 and up ports 3, 4; core port p + 1 to pod p. `reversed` adds the
+ * switches and links in the opposite order.
+ */
+static void
+BuildFatTree (PathTopology &t, bool reversed)
+{
+  std::vector<uint32_t> ids;
+  for (uint32_t i = 0; i < 20; i++)
+    {
+      ids.push_back (reversed ? 19 - i : i);
+    }
+  for (uint32_t i = 0; i < ids.size (); i++)
+    {
+      t.AddSwitch (ids[i], ids[i] < 8);
+    }
+  std::vector<std::vector<uint32_t> > links;  // (a, port of a, b, port of b)
+  for (uint32_t pod = 0; pod < 4; pod++)
+    {
+      for (uint32_t e = 0; e < 2; e++)
+        {
+          for (uint32_t a = 0; a < 2; a++)
+            {
+              links.push_back ({pod * 2 + e, 3 + a, 8 + pod * 2 + a, 1 + e});
+            }
+        }
+      for (uint32_t a = 0; a < 2; a++)
+        {
+          for (uint32_t c = 0; c < 2; c++)
+            {
+              links.push_back ({8 + pod * 2 + a, 3 + c, 16 + a * 2 + c, 1 + pod});
+            }
+        }
+    }
+  for (uint32_t i = 0; i < links.size (); i++)
+    {
+      const std::vector<uint32_t> &l = links[reversed ? links.size () - 1 - i : i];
+      t.AddLink (l[0], l[1], l[2], l[3]);
+    }
+}
+
+/**
+ * On a 3-tier fat-tree every ToR pair gets all its shortest paths: 2 of 2
+ * hops within a pod, 4 of 4 hops across pods, distinct, each one walking
+ * from the source ToR to the destination ToR.
+ */
+class PathSetFatTreeTestCase : public TestCase
+{
+public:
+  PathSetFatTreeTestCase ();
+  virtual void DoRun (void);
+};
+
+PathSetFatTreeTestCase::PathSetFatTreeTestCase ()
+  : TestCase ("PathSetBuilder on a 3-tier fat-tree")
+{
+}
+
+void
+PathSetFatTreeTestCase::DoRun (void)
+{
+  PathTopology t;
+  BuildFatTree (t, false);
+  for (uint32_t src = 0; src < 8; src++)
+    {
+      for (uint32_t dst = 0; dst < 8; dst++)
+        {
+          if (src == dst)
+            {
+              continue;
+            }
+          bool samePod = src / 2 == dst / 2;
+          std::vector<uint32_t> paths = t.Build (src, dst);
+          NS_TEST_ASSERT_MSG_EQ (paths.size (), samePod ? 2u : 4u, src << " -> " << dst);
+          std::set<uint32_t> distinct (paths.begin (), paths.end ());
+          NS_TEST_EXPECT_MSG_EQ (distinct.size (), paths.size (), src << " -> " << dst);
+          for (uint32_t i = 0; i < paths.size (); i++)
+            {
+              NS_TEST_EXPECT_MSG_EQ (PathCodec::GetLength (paths[i]), samePod ? 2u : 4u,
+                                     src << " -> " << dst);
+              NS_TEST_EXPECT_MSG_EQ (t.Walk (src, paths[i]), dst, src << " -> " << dst);
+            }
+        }
+    }
+}
+
+/**
+ * Ports above 255 (up to 0xffff) and paths longer than 4 hops, which the
+ * former 4 x 8-bit encoding could not hold, come back unchanged.
+ */
+class PathSetLongPathTestCase : public TestCase
+{
+public:
+  PathSetLongPathTestCase ();
+  virtual void DoRun (void);
+};
+
+PathSetLongPathTestCase::PathSetLongPathTestCase ()
+  : TestCase ("Ports above 255 and paths longer than 4 hops")
+{
+}
+
+void
+PathSetLongPathTestCase::DoRun (void)
+{
+  // ToR 0 - 1 - 2 - ... - 8 - ToR 9, with two parallel links between 4 and 5
+  PathTopology t;
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      t.AddSwitch (i, i == 0 || i == 9);
+    }
+  for (uint32_t i = 0; i < 9; i++)
+    {
+      t.AddLink (i, 300 + i, i + 1, 1000 + i);
+    }
+  t.AddLink (4, 0xffff, 5, 256);
+  std::vector<uint32_t> paths = t.Build (0, 9);
+  NS_TEST_ASSERT_MSG_EQ (paths.size (), 2u, "one path per parallel link");
+  for (uint32_t k = 0; k < 2; k++)
+    {
+      PathCodec::Ports ports = PathCodec::GetPorts (paths[k]);
+      NS_TEST_ASSERT_MSG_EQ (ports.size (), 9u, "hops");
+      NS_TEST_EXPECT_MSG_EQ (PathCodec::GetLength (paths[k]), 9u, "GetLength");
+      for (uint32_t h = 0; h < 9; h++)
+        {
+          uint32_t expected = h == 4 && k == 1 ? 0xffff : 300 + h;
+          NS_TEST_EXPECT_MSG_EQ (ports[h], expected, "port at hop " << h);
+          NS_TEST_EXPECT_MSG_EQ (PathCodec::GetPort (paths[k], h), expected, "GetPort at hop " << h);
+        }
+      NS_TEST_EXPECT_MSG_EQ (PathCodec::GetPort (paths[k], 9), 0u, "beyond the end");
+      NS_TEST_EXPECT_MSG_EQ (t.Walk (0, paths[k]), 9u, "walk");
+    }
+
+  // the reverse direction: down ports 1000.., and 256 on the parallel link
+  paths = t.Build (9, 0);
+  NS_TEST_ASSERT_MSG_EQ (paths.size (), 2u, "reverse");
+  NS_TEST_EXPECT_MSG_EQ (PathCodec::GetPort (paths[0], 4), 256u, "port order");
+  NS_TEST_EXPECT_MSG_EQ (PathCodec::GetPort (paths[1], 4), 1004u, "port order");
+  NS_TEST_EXPECT_MSG_EQ (t.Walk (9, paths[0]), 0u, "walk");
+  NS_TEST_EXPECT_MSG_EQ (t.Walk (9, paths[1]), 0u, "walk");
+
+  // Prepend is Intern of the longer path
+  PathCodec::Ports rest = PathCodec::GetPorts (paths[0]);
+  PathCodec::Ports longer (1, 4000);
+  longer.insert (longer.end (), rest.begin (), rest.end ());
+  NS_TEST_EXPECT_MSG_EQ (PathCodec::Prepend (4000, rest), PathCodec::Intern (longer), "Prepend");
+}
+
+/**
+ * Paths are listed in port order at every hop, whatever order the switches
+ * and links were added in, so all MPI ranks intern them in the same order.
+ */
+class PathSetCanonicalOrderTestCase : public TestCase
+{
+public:
+  PathSetCanonicalOrderTestCase ();
+  virtual void DoRun (void);
+};
+
+PathSetCanonicalOrderTestCase::PathSetCanonicalOrderTestCase ()
+  : TestCase ("PathSetBuilder path order does not depend on the link order")
+{
+}
+
+void
+PathSetCanonicalOrderTestCase::DoRun (void)
+{
+  PathTopology forward, reversed;
+  BuildFatTree (forward, false);
+  BuildFatTree (reversed, true);
+  for (uint32_t src = 0; src < 8; src++)
+    {
+      for (uint32_t dst = 0; dst < 8; dst++)
+        {
+          if (src == dst)
+            {
+              continue;
+            }
+          std::vector<uint32_t> a = forward.Build (src, dst);
+          std::vector<uint32_t> b = reversed.Build (src, dst);
+          NS_TEST_EXPECT_MSG_EQ ((a == b), true, src << " -> " << dst);
+          for (uint32_t i = 1; i < a.size (); i++)
+            {
+              NS_TEST_EXPECT_MSG_EQ ((PathCodec::GetPorts (a[i - 1]) < PathCodec::GetPorts (a[i])),
+                                     true, src << " -> " << dst << " in port order");
+            }
+        }
+    }
+}
+
+/* every path of the fat-tree, their suffixes, then Freeze(); out: the number of paths */
+static void
+FreezeScenario (std::vector<uint32_t> &out)
+{
+  PathTopology t;
+  BuildFatTree (t, false);
+  std::vector<uint32_t> paths;
+  for (uint32_t src = 0; src < 8; src++)
+    {
+      for (uint32_t dst = 0; dst < 8; dst++)
+        {
+          if (src != dst)
+            {
+              std::vector<uint32_t> p = t.Build (src, dst);
+              paths.insert (paths.end (), p.begin (), p.end ());
+            }
+        }
+    }
+  PathCodec::AddSuffixes ();
+  PathCodec::Freeze ();
+  out.push_back (PathCodec::GetNumPaths ());
+  // what CAVER/DV build hop by hop on the ACKs: every suffix, by Prepend
+  for (uint32_t i = 0; i < paths.size (); i++)
+    {
+      PathCodec::Ports ports = PathCodec::GetPorts (paths[i]);
+      PathCodec::Ports rest;
+      for (uint32_t h = ports.size (); h-- > 0;)
+        {
+          uint32_t id = PathCodec::Prepend (ports[h], rest);
+          rest = PathCodec::GetPorts (id);
+        }
+      if (rest != ports)
+        {
+          out.clear ();
+          return;
+        }
+    }
+  out.push_back (PathCodec::GetNumPaths ());
+}
+
+static void
+FreezeNewPathScenario (std::vector<uint32_t> &out)
+{
+  FreezeScenario (out);
+  freopen ("/dev/null", "w", stderr);  // the expected fatal error
+  PathCodec::Intern (PathCodec::Ports (5, 0xfffe));
+  out.clear ();
+}
+
+/**
+ * After AddSuffixes() and Freeze(), every suffix Prepend builds on the ACK
+ * path is already interned, and a path not interned at setup is a fatal
+ * error (run in a child process, where the freeze and the abort stay).
+ */
+class PathCodecFreezeTestCase : public TestCase
+{
+public:
+  PathCodecFreezeTestCase ();
+  virtual void DoRun (void);
+};
+
+PathCodecFreezeTestCase::PathCodecFreezeTestCase ()
+  : TestCase ("PathCodec AddSuffixes and Freeze")
+{
+}
+
+void
+PathCodecFreezeTestCase::DoRun (void)
+{
+  std::vector<uint32_t> n;
+  NS_TEST_ASSERT_MSG_EQ (RdmaTestNetwork::RunIsolated (&FreezeScenario, n), true,
+                         "interned suffixes after Freeze()");
+  NS_TEST_ASSERT_MSG_EQ (n.size (), 2u, "Prepend rebuilt every path");
+  NS_TEST_EXPECT_MSG_EQ (n[1], n[0], "no path added after Freeze()");
+  NS_TEST_EXPECT_MSG_EQ (RdmaTestNetwork::RunIsolated (&FreezeNewPathScenario, n), false,
+                         "a new path after Freeze() is fatal");
+}
+
+class PathCodecTestSuite : public TestSuite
+{
+public:
+  PathCodecTestSuite ();
+};
+
+PathCodecTestSuite::PathCodecTestSuite ()
+  : TestSuite ("path-codec", UNIT)
+{
+  AddTestCase (new PathSetFatTreeTestCase);
+  AddTestCase (new PathSetLongPathTestCase);
+  AddTestCase (new PathSetCanonicalOrderTestCase);
+  AddTestCase (new PathCodecFreezeTestCase);
+}
+
+static PathCodecTestSuite g_pathCodecTestSuite;
@@ -0,0 +1,420 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CAVER-LB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef RDMA_TEST_NETWORK_H
+#define RDMA_TEST_NETWORK_H
+
+#include <stdio.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ns3/boolean.h"
+#include "ns3/data-rate.h"
+#include "ns3/double.h"
+#include "ns3/assert.h"
+#include "ns3/int-header.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4.h"
+#include "ns3/load-balancer.h"
+#include "ns3/qbb-channel.h"
+#include "ns3/qbb-helper.h"
+#include "ns3/qbb-net-device.h"
+#include "ns3/rdma-driver.h"
+#include "ns3/rdma-hw.h"
+#include "ns3/settings.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/switch-node.h"
+#include "ns3/uinteger.h"
+
+namespace ns3 {
+
+/**
+ * \brief A small RDMA network for the point-to-point tests, set up the way
+ * scratch/network-load-balance.cc sets up its topologies: hosts with
+ * RdmaHw/RdmaDriver (DCQCN by default, Mellanox parameters of run.py),
+ * switches with the MMU (ECN 100KB/400KB/0.2, PFC headroom) and
+ * flow-ECMP routing over the shortest paths. Flows are queue pairs added
+ * directly to the drivers; their FCTs are recorded as the scenario's
+ * qp_finish does.
+ *
+ * Usage: AddHost/AddSwitch, AddLink, Build, AddFlow, Run, GetFcts, then
+ * Simulator::Destroy. One network per simulation.
+ */
+class RdmaTestNetwork
+{
+public:
+  struct Fct
+  {
+    uint32_t src, dst;
+    uint16_t sport, dport;
+    uint64_t size, startNs, fctNs;
+    bool operator== (const Fct &o) const
+    {
+      return src == o.src && dst == o.dst && sport == o.sport && dport == o.dport
+             && size == o.size && startNs == o.startNs && fctNs == o.fctNs;
+    }
+  };
+
+  explicit RdmaTestNetwork (uint32_t ccMode = 1)
+    : m_ccMode (ccMode)
+  {
+    Settings::lb_mode = 0;
+    Settings::packet_payload = MTU;
+    Settings::hostIp2IdMap.clear ();
+    Settings::hostId2IpMap.clear ();
+    Settings::PacketId2FlowId.clear ();
+    Settings::QPPair_info2FlowId.clear ();
+    Settings::FlowId2Length.clear ();
+    IntHop::multi = 1;
+    IntHeader::mode = ccMode == 3 ? 0 : (ccMode == 7 ? 1 : 5);
+  }
+
+  uint32_t AddHost (void)
+  {
+    Ptr<Node> node = CreateObject<Node> ();
+    NS_ASSERT_MSG (node->GetId () == m_nodes.size (), "one network per simulation");
+    m_internet.Install (node);
+    Settings::hostId2IpMap[node->GetId ()] = Settings::node_id_to_ip (node->GetId ()).Get ();
+    Settings::hostIp2IdMap[Settings::node_id_to_ip (node->GetId ()).Get ()] = node->GetId ();
+    m_nodes.push_back (node);
+    return node->GetId ();
+  }
+
+  uint32_t AddSwitch (uint32_t ecmpSeed = 0)
+  {
+    Ptr<SwitchNode> sw = CreateObject<SwitchNode> ();
+    NS_ASSERT_MSG (sw->GetId () == m_nodes.size (), "one network per simulation");
+    sw->SetAttribute ("EcnEnabled", BooleanValue (true));
+    if (ecmpSeed != 0)
+      {
+        sw->SetEcmpSeed (ecmpSeed);
+      }
+    sw->SetLoadBalancer (LoadBalancer::CreateByMode (0));
+    m_internet.Install (sw);
+    m_nodes.push_back (sw);
+    return sw->GetId ();
+  }
+
+  /* a link a <-> b; a host's first link is its NIC */
+  void AddLink (uint32_t a, uint32_t b, std::string rate = "100Gbps",
+                std::string delay = "1000ns")
+  {
+    QbbHelper qbb;
+    qbb.SetDeviceAttribute ("DataRate", StringValue (rate));
+    qbb.SetChannelAttribute ("Delay", StringValue (delay));
+    NetDeviceContainer d = qbb.Install (m_nodes[a], m_nodes[b]);
+    uint32_t ends[2] = { a, b };
+    for (uint32_t k = 0; k < 2; k++)
+      {
+        Ptr<Node> node = m_nodes[ends[k]];
+        if (node->GetNodeType () == 0)
+          {
+            Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+            ipv4->AddInterface (d.Get (k));
+            ipv4->AddAddress (1, Ipv4InterfaceAddress (Settings::node_id_to_ip (node->GetId ()),
+                                                       Ipv4Mask (0xff000000)));
+          }
+        Ptr<QbbNetDevice> dev = DynamicCast<QbbNetDevice> (d.Get (k));
+        m_port[ends[k]][ends[1 - k]] = dev->GetIfIndex ();
+      }
+    char base[16];
+    snprintf (base, sizeof (base), "10.%u.%u.0", m_nLinks / 254 + 1, m_nLinks % 254 + 1);
+    m_nLinks++;
+    Ipv4AddressHelper ipv4;
+    ipv4.SetBase (base, "255.255.255.0");
+    ipv4.Assign (d);
+  }
+
+  /* switch MMUs, NICs and routes; after the last AddLink */
+  void Build (uint32_t bufferBytes = 9 * 1024 * 1024)
+  {
+    for (uint32_t i = 0; i < m_nodes.size (); i++)
+      {
+        if (m_nodes[i]->GetNodeType () == 1)
+          {
+            BuildSwitch (DynamicCast<SwitchNode> (m_nodes[i]), bufferBytes);
+          }
+        else
+          {
+            BuildHost (m_nodes[i]);
+          }
+      }
+    for (uint32_t i = 0; i < m_nodes.size (); i++)
+      {
+        if (m_nodes[i]->GetNodeType () == 0)
+          {
+            AddRoutesTo (i);
+          }
+      }
+  }
+
+  /* a flow src -> dst of `size` bytes starting at `start`; returns its flow id */
+  uint32_t AddFlow (uint32_t src, uint32_t dst, uint64_t size, Time start, uint16_t pg = 3)
+  {
+    Flow f;
+    f.src = src;
+    f.dst = dst;
+    f.sport = m_nextSport[src]++ + 10000;
+    f.dport = m_nextDport[dst]++ + 100;
+    f.size = size;
+    f.pg = pg;
+    uint32_t flowId = m_flows.size ();
+    Settings::PacketId2FlowId[std::make_tuple (src, dst, f.sport, f.dport)] = flowId;
+    Settings::QPPair_info2FlowId[std::make_tuple (Settings::node_id_to_ip (src),
+                                                  Settings::node_id_to_ip (dst), f.sport,
+                                                  f.dport)] = flowId;
+    Settings::FlowId2Length[flowId] = size;
+    m_flows.push_back (f);
+    Simulator::Schedule (start, &RdmaTestNetwork::StartFlow, this, flowId);
+    return flowId;
+  }
+
+  void Run (Time stop)
+  {
+    Simulator::Stop (stop);
+    Simulator::Run ();
+  }
+
+  Ptr<Node> GetNode (uint32_t id) const
+  {
+    return m_nodes[id];
+  }
+  /* the device of `node` on its link to `peer` */
+  Ptr<QbbNetDevice> GetDevice (uint32_t node, uint32_t peer) const
+  {
+    return DynamicCast<QbbNetDevice> (m_nodes[node]->GetDevice (m_port.at (node).at (peer)));
+  }
+  Ptr<RdmaHw> GetRdmaHw (uint32_t host) const
+  {
+    return m_nodes[host]->GetObject<RdmaDriver> ()->m_rdma;
+  }
+  /* completed flows, in completion order */
+  const std::vector<Fct> &GetFcts (void) const
+  {
+    return m_fcts;
+  }
+
+  /**
+   * Runs `scenario` in a child process and returns what it produced (FCTs,
+   * counters: any plain records). Every run then starts from the same
+   * random streams (the MMU's ECN marking draws from streams numbered
+   * process-wide) and the same Settings, so that two runs compare exactly.
+   * False if the child failed.
+   */
+  template <typename T>
+  static bool RunIsolated (void (*scenario)(std::vector<T> &), std::vector<T> &out)
+  {
+    int fd[2];
+    if (pipe (fd) != 0)
+      {
+        return false;
+      }
+    fflush (NULL);
+    pid_t pid = fork ();
+    if (pid < 0)
+      {
+        return false;
+      }
+    if (pid == 0)
+      {
+        close (fd[0]);
+        std::vector<T> res;
+        scenario (res);
+        const char *p = (const char *) res.data ();
+        size_t left = res.size () * sizeof (T);
+        while (left > 0)
+          {
+            ssize_t n = write (fd[1], p, left);
+            if (n <= 0)
+              {
+                _exit (1);
+              }
+            p += n;
+            left -= n;
+          }
+        _exit (0);
+      }
+    close (fd[1]);
+    std::vector<char> buf;
+    char chunk[4096];
+    ssize_t n;
+    while ((n = read (fd[0], chunk, sizeof (chunk))) > 0)
+      {
+        buf.insert (buf.end (), chunk, chunk + n);
+      }
+    close (fd[0]);
+    int status = 0;
+    if (waitpid (pid, &status, 0) != pid || !WIFEXITED (status) || WEXITSTATUS (status) != 0
+        || buf.size () % sizeof (T) != 0)
+      {
+        return false;
+      }
+    out.assign ((const T *) buf.data (), (const T *) (buf.data () + buf.size ()));
+    return true;
+  }
+
+  enum { MTU = 1000 };
+
+private:
+  struct Flow
+  {
+    uint32_t src, dst;
+    uint16_t sport, dport;
+    uint64_t size;
+    uint16_t pg;
+  };
+
+  void BuildSwitch (Ptr<SwitchNode> sw, uint32_t bufferBytes)
+  {
+    sw->ConfigNPort (sw->GetNDevices () - 1);
+    for (uint32_t j = 1; j < sw->GetNDevices (); j++)
+      {
+        Ptr<QbbNetDevice> dev = DynamicCast<QbbNetDevice> (sw->GetDevice (j));
+        uint64_t rate = dev->GetDataRate ().GetBitRate ();
+        sw->m_mmu->ConfigEcn (j, 100, 400, 0.2);  // run.py's DCQCN thresholds, any rate
+        uint64_t delay = DynamicCast<QbbChannel> (dev->GetChannel ())->GetDelay ().GetTimeStep ();
+        sw->m_mmu->ConfigHdrm (j, rate * delay / 8 / 1000000000 * 2 + 2 * sw->m_mmu->MTU);
+      }
+    sw->m_mmu->ConfigBufferSize (bufferBytes);
+    sw->m_mmu->node_id = sw->GetId ();
+    sw->SetAttribute ("CcMode", UintegerValue (m_ccMode));
+    sw->SetAttribute ("AckHighPrio", UintegerValue (1));
+  }
+
+  void BuildHost (Ptr<Node> node)
+  {
+    Ptr<RdmaHw> rdmaHw = CreateObject<RdmaHw> ();
+    rdmaHw->SetAttribute ("ClampTargetRate", BooleanValue (false));
+    rdmaHw->SetAttribute ("AlphaResumInterval", DoubleValue (1));
+    rdmaHw->SetAttribute ("RPTimer", DoubleValue (300));
+    rdmaHw->SetAttribute ("FastRecoveryTimes", UintegerValue (1));
+    rdmaHw->SetAttribute ("EwmaGain", DoubleValue (0.00390625));
+    rdmaHw->SetAttribute ("RateAI", DataRateValue (DataRate ("50Mb/s")));
+    rdmaHw->SetAttribute ("RateHAI", DataRateValue (DataRate ("100Mb/s")));
+    rdmaHw->SetAttribute ("L2BackToZero", BooleanValue (false));
+    rdmaHw->SetAttribute ("L2ChunkSize", UintegerValue (4000));
+    rdmaHw->SetAttribute ("L2AckInterval", UintegerValue (1));
+    rdmaHw->SetAttribute ("CcMode", UintegerValue (m_ccMode));
+    rdmaHw->SetAttribute ("RateDecreaseInterval", DoubleValue (4));
+    rdmaHw->SetAttribute ("MinRate", DataRateValue (DataRate ("100Mb/s")));
+    rdmaHw->SetAttribute ("Mtu", UintegerValue (MTU));
+    Ptr<RdmaDriver> rdma = CreateObject<RdmaDriver> ();
+    rdma->SetNode (node);
+    rdma->SetRdmaHw (rdmaHw);
+    node->AggregateObject (rdma);
+    rdma->Init ();
+    rdma->TraceConnectWithoutContext ("QpComplete",
+                                      MakeCallback (&RdmaTestNetwork::OnQpComplete, this));
+  }
+
+  /* BFS from `host` over the switches, as CalculateRoute; fills the hop counts too */
+  void AddRoutesTo (uint32_t host)
+  {
+    Ipv4Address dstAddr = Settings::node_id_to_ip (host);
+    std::map<uint32_t, uint32_t> dis;
+    std::vector<uint32_t> q (1, host);
+    dis[host] = 0;
+    for (uint32_t i = 0; i < q.size (); i++)
+      {
+        uint32_t now = q[i];
+        for (std::map<uint32_t, uint32_t>::const_iterator it = m_port[now].begin ();
+             it != m_port[now].end (); ++it)
+          {
+            uint32_t next = it->first;
+            if (dis.find (next) == dis.end ())
+              {
+                dis[next] = dis[now] + 1;
+                if (m_nodes[next]->GetNodeType () == 1)
+                  {
+                    q.push_back (next);
+                  }
+              }
+            if (dis[now] + 1 == dis[next])
+              {
+                uint32_t intf = m_port[next][now];
+                if (m_nodes[next]->GetNodeType () == 1)
+                  {
+                    DynamicCast<SwitchNode> (m_nodes[next])->AddTableEntry (dstAddr, intf);
+                  }
+                else
+                  {
+                    m_nodes[next]->GetObject<RdmaDriver> ()->m_rdma->AddTableEntry (dstAddr,
+                                                                                    intf);
+                  }
+              }
+          }
+      }
+    for (std::map<uint32_t, uint32_t>::const_iterator it = dis.begin (); it != dis.end (); ++it)
+      {
+        m_hops[it->first][host] = it->second;
+      }
+  }
+
+  void StartFlow (uint32_t flowId)
+  {
+    const Flow &f = m_flows[flowId];
+    // base RTT as the scenario's pairRtt on uniform 100G/1us links: 2 * delay + one MTU per hop
+    uint32_t hops = m_hops[f.src][f.dst];
+    uint64_t baseRtt = hops * (2 * 1000 + MTU * 8 / 100);
+    m_nodes[f.src]->GetObject<RdmaDriver> ()->AddQueuePair (
+        f.size, f.pg, Settings::node_id_to_ip (f.src), Settings::node_id_to_ip (f.dst), f.sport,
+        f.dport, 0, baseRtt, flowId);
+  }
+
+  void OnQpComplete (Ptr<RdmaQueuePair> q)
+  {
+    Fct r;
+    r.src = Settings::ip_to_node_id (q->sip);
+    r.dst = Settings::ip_to_node_id (q->dip);
+    r.sport = q->sport;
+    r.dport = q->dport;
+    r.size = q->m_size;
+    r.startNs = q->startTime.GetTimeStep ();
+    r.fctNs = (Simulator::Now () - q->startTime).GetTimeStep ();
+    m_fcts.push_back (r);
+    m_nodes[r.dst]->GetObject<RdmaDriver> ()->m_rdma->DeleteRxQp (q->sip.Get (), q->sport,
+                                                                 q->dport, q->m_pg);
+  }
+
+  uint32_t m_ccMode;
+  InternetStackHelper m_internet;
+  std::vector<Ptr<Node> > m_nodes;
+  std::map<uint32_t, std::map<uint32_t, uint32_t> > m_port;  // node -> peer -> ifIndex
+  std::map<uint32_t, std::map<uint32_t, uint32_t> > m_hops;  // node -> host -> hops
+  uint32_t m_nLinks = 0;
+  std::map<uint32_t, uint16_t> m_nextSport, m_nextDport;
+  std::vector<Flow> m_flows;
+  std::vector<Fct> m_fcts;
+};
+
+} // namespace ns3
+
+#endif /* RDMA_TEST_NETWORK_H */
@@ -0,0 +1,133 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CAVER-LB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include "ns3/reorder-analytics.h"
+#include "ns3/test.h"
+
+using namespace ns3;
+
+/* the summary written by ReorderAnalytics::Write */
+struct ReorderSummary
+{
+  std::vector<uint64_t> bufferHist, episodeNsHist;
+  uint64_t episodeNs[2];
+  uint32_t episodes[2];
+};
+
+static bool
+ReadSummary (const char *filename, ReorderSummary &s)
+{
+  FILE *fin = fopen (filename, "rb");
+  if (fin == NULL)
+    {
+      return false;
+    }
+  char magic[4];
+  uint32_t version, nBins, nFlows;
+  bool ok = fread (magic, 1, 4, fin) == 4 && fread (&version, 4, 1, fin) == 1
+            && fread (&nBins, 4, 1, fin) == 1 && fread (&nFlows, 4, 1, fin) == 1 && nFlows == 2;
+  std::vector<uint64_t> distanceHist (nBins);
+  s.bufferHist.resize (nBins);
+  s.episodeNsHist.resize (nBins);
+  ok = ok && fread (distanceHist.data (), 8, nBins, fin) == nBins
+       && fread (s.bufferHist.data (), 8, nBins, fin) == nBins
+       && fread (s.episodeNsHist.data (), 8, nBins, fin) == nBins;
+  for (uint32_t i = 0; ok && i < nFlows; i++)
+    {
+      int32_t flow;
+      uint64_t packets, oooBytes;
+      uint32_t oooPackets, rest[3];
+      ok = fread (&flow, 4, 1, fin) == 1 && flow == (int32_t) i && fread (&packets, 8, 1, fin) == 1
+           && fread (&oooBytes, 8, 1, fin) == 1 && fread (&s.episodeNs[i], 8, 1, fin) == 1
+           && fread (&oooPackets, 4, 1, fin) == 1 && fread (&s.episodes[i], 4, 1, fin) == 1
+           && fread (rest, 4, 3, fin) == 3;
+    }
+  fclose (fin);
+  return ok;
+}
+
+class ReorderOpenEpisodeTestCase : public TestCase
+{
+public:
+  ReorderOpenEpisodeTestCase ();
+  virtual void DoRun (void);
+};
+
+ReorderOpenEpisodeTestCase::ReorderOpenEpisodeTestCase ()
+  : TestCase ("An episode still open at the end is closed at the end time")
+{
+}
+
+void
+ReorderOpenEpisodeTestCase::DoRun (void)
+{
+  ReorderAnalytics::enabled = true;
+  // flow 0: a hole [0, 1000) opens at 100ns and is filled at 300ns
+  ReorderAnalytics::OnArrival (0, 1000, 1000, 0, 0, 100);
+  ReorderAnalytics::OnArrival (0, 0, 1000, 0, 2000, 300);
+  // flow 1: a hole [0, 1000) opens at 200ns and is never filled
+  ReorderAnalytics::OnArrival (1, 1000, 1000, 0, 0, 200);
+  ReorderAnalytics::CloseOpenEpisodes (1200);
+  ReorderAnalytics::CloseOpenEpisodes (5000);  // nothing left open
+
+  char filename[] = "/tmp/reorder-analytics-test-XXXXXX";
+  int fd = mkstemp (filename);
+  NS_TEST_ASSERT_MSG_NE (fd, -1, "cannot create a temporary file");
+  close (fd);
+  NS_TEST_ASSERT_MSG_EQ (ReorderAnalytics::Write (filename), true, "Write failed");
+  ReorderSummary s;
+  bool read = ReadSummary (filename, s);
+  unlink (filename);
+  NS_TEST_ASSERT_MSG_EQ (read, true, "malformed summary");
+
+  NS_TEST_ASSERT_MSG_EQ (s.episodes[0], 1, "flow 0 episodes");
+  NS_TEST_ASSERT_MSG_EQ (s.episodeNs[0], 200, "flow 0 episode time");
+  NS_TEST_ASSERT_MSG_EQ (s.episodes[1], 1, "flow 1 episodes");
+  NS_TEST_ASSERT_MSG_EQ (s.episodeNs[1], 1000, "flow 1 episode not closed at the end time");
+  // both episodes are in the histograms: 200ns -> bin 8, 1000ns -> bin 10, 2000B -> bin 11
+  NS_TEST_ASSERT_MSG_EQ (s.episodeNsHist[8], 1, "200ns episode not in the histogram");
+  NS_TEST_ASSERT_MSG_EQ (s.episodeNsHist[10], 1, "1000ns episode not in the histogram");
+  NS_TEST_ASSERT_MSG_EQ (s.bufferHist[11], 2, "episode buffers not in the histogram");
+  ReorderAnalytics::enabled = false;
+}
+
+class ReorderAnalyticsTestSuite : public TestSuite
+{
+public:
+  ReorderAnalyticsTestSuite ();
+};
+
+ReorderAnalyticsTestSuite::ReorderAnalyticsTestSuite ()
+  : TestSuite ("reorder-analytics", UNIT)
+{
+  AddTestCase (new ReorderOpenEpisodeTestCase);
+}
+
+static ReorderAnalyticsTestSuite g_reorderAnalyticsTestSuite;
@@ -0,0 +1,206 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CAVER-LB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "ns3/custom-header.h"
+#include "ns3/packet.h"
+#include "ns3/qbb-net-device.h"
+#include "ns3/run-health.h"
+#include "ns3/simulator.h"
+#include "ns3/switch-mmu.h"
+#include "ns3/switch-node.h"
+#include "ns3/test.h"
+
+#include "rdma-test-network.h"
+
+using namespace ns3;
+
+/*
+ * RunHealth PFC deadlock detection on hand-made PAUSE states: the
+ * switches send real PAUSE frames, a packet waits behind each PAUSE and
+ * the MMU is told which ingress it came from.
+ */
+
+static const uint32_t QINDEX = 3;
+
+static RdmaTestNetwork *g_net;
+static RunHealth *g_health;
+static RunHealth::Verdict g_verdict;
+
+/* egress a -> b paused (by b) with one packet queued that came in from `from` */
+struct PausedEgress
+{
+  uint32_t a, b, from;
+};
+
+static void
+SendPause (uint32_t a, uint32_t b)
+{
+  g_net->GetDevice (b, a)->SendPfc (QINDEX, 0);
+}
+
+static void
+QueueBehindPause (PausedEgress e)
+{
+  Ptr<QbbNetDevice> out = g_net->GetDevice (e.a, e.b);
+  uint32_t in = g_net->GetDevice (e.a, e.from)->GetIfIndex ();
+  CustomHeader ch (CustomHeader::L2_Header | CustomHeader::L3_Header | CustomHeader::L4_Header);
+  out->SwitchSend (QINDEX, Create<Packet> (1000), ch);
+  DynamicCast<SwitchNode> (g_net->GetNode (e.a))
+      ->m_mmu->UpdateInOutBytes (in, out->GetIfIndex (), QINDEX, 1000);
+}
+
+static void
+SampleHealth (void)
+{
+  g_verdict = g_health->Sample (0, 1);
+}
+
+/* links are (a, b); returns the verdict 50us after the PAUSEs, deadlock window 10us */
+static RunHealth::Verdict
+RunPauses (uint32_t nHosts, uint32_t nSwitches, const std::vector<std::vector<uint32_t> > &links,
+           const std::vector<PausedEgress> &paused)
+{
+  RdmaTestNetwork net;
+  for (uint32_t i = 0; i < nHosts; i++)
+    {
+      net.AddHost ();
+    }
+  for (uint32_t i = 0; i < nSwitches; i++)
+    {
+      net.AddSwitch ();
+    }
+  for (uint32_t i = 0; i < links.size (); i++)
+    {
+      net.AddLink (links[i][0], links[i][1], "100Gbps");
+    }
+  net.Build ();
+
+  RunHealth health;
+  health.SetDeadlockWindow (10000);
+  for (uint32_t i = 0; i < links.size (); i++)  // every port, as the scenario registers them
+    {
+      uint32_t a = links[i][0], b = links[i][1];
+      health.AddPort (net.GetNode (a), net.GetDevice (a, b)->GetIfIndex (), net.GetNode (b),
+                      net.GetDevice (b, a)->GetIfIndex ());
+      health.AddPort (net.GetNode (b), net.GetDevice (b, a)->GetIfIndex (), net.GetNode (a),
+                      net.GetDevice (a, b)->GetIfIndex ());
+    }
+  g_net = &net;
+  g_health = &health;
+  g_verdict = RunHealth::OK;
+  for (uint32_t i = 0; i < paused.size (); i++)
+    {
+      Simulator::Schedule (NanoSeconds (0), &SendPause, paused[i].a, paused[i].b);
+      Simulator::Schedule (MicroSeconds (10), &QueueBehindPause, paused[i]);
+    }
+  Simulator::Schedule (MicroSeconds (50), &SampleHealth);
+  net.Run (MicroSeconds (60));
+  Simulator::Destroy ();
+  g_net = NULL;
+  g_health = NULL;
+  return g_verdict;
+}
+
+class RunHealthMutualPauseTestCase : public TestCase
+{
+public:
+  RunHealthMutualPauseTestCase ()
+    : TestCase ("RunHealth: two switches pausing each other is not a cycle")
+  {
+  }
+
+private:
+  virtual void DoRun (void);
+};
+
+void
+RunHealthMutualPauseTestCase::DoRun (void)
+{
+  /*
+   * Switches 2 and 3 pause each other; what waits at 2 came from host 0
+   * and what waits at 3 from host 1: both drain once the hosts stop.
+   */
+  std::vector<std::vector<uint32_t> > links;
+  links.push_back ({ 0, 2 });
+  links.push_back ({ 1, 3 });
+  links.push_back ({ 2, 3 });
+  std::vector<PausedEgress> paused;
+  paused.push_back ({ 2, 3, 0 });
+  paused.push_back ({ 3, 2, 1 });
+  NS_TEST_EXPECT_MSG_EQ (RunPauses (2, 2, links, paused), RunHealth::OK, "no deadlock");
+}
+
+class RunHealthRingTestCase : public TestCase
+{
+public:
+  RunHealthRingTestCase ()
+    : TestCase ("RunHealth: a ring of three paused switches is a cycle")
+  {
+  }
+
+private:
+  virtual void DoRun (void);
+};
+
+void
+RunHealthRingTestCase::DoRun (void)
+{
+  // switches 3 -> 4 -> 5 -> 3, each waiting on bytes from the previous one
+  std::vector<std::vector<uint32_t> > links;
+  links.push_back ({ 0, 3 });
+  links.push_back ({ 1, 4 });
+  links.push_back ({ 2, 5 });
+  links.push_back ({ 3, 4 });
+  links.push_back ({ 4, 5 });
+  links.push_back ({ 5, 3 });
+  std::vector<PausedEgress> paused;
+  paused.push_back ({ 3, 4, 5 });
+  paused.push_back ({ 4, 5, 3 });
+  paused.push_back ({ 5, 3, 4 });
+  NS_TEST_EXPECT_MSG_EQ (RunPauses (3, 3, links, paused), RunHealth::DEADLOCK, "deadlock");
+
+  // the same PAUSEs, but 5 -> 3 waits on bytes from host 2: the ring drains from there
+  paused[2].from = 2;
+  NS_TEST_EXPECT_MSG_EQ (RunPauses (3, 3, links, paused), RunHealth::OK, "no deadlock");
+}
+
+class RunHealthTestSuite : public TestSuite
+{
+public:
+  RunHealthTestSuite ();
+};
+
+RunHealthTestSuite::RunHealthTestSuite ()
+  : TestSuite ("run-health", UNIT)
+{
+  AddTestCase (new RunHealthMutualPauseTestCase);
+  AddTestCase (new RunHealthRingTestCase);
+}
+
+static RunHealthTestSuite g_runHealthTestSuite;
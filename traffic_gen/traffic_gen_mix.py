@@ -49,12 +49,16 @@ if __name__ == "__main__":
 	parser.add_option("-l", "--load", dest = "load", help = "the percentage of the traffic load to the network capacity, by default 0.3", default = "0.3")
 	parser.add_option("-b", "--bandwidth", dest = "bandwidth", help = "the bandwidth of host link (G/M/K), by default 10G", default = "100G")
 	parser.add_option("-t", "--time", dest = "time", help = "the total run time (s), by default 10", default = "0.03")
+	parser.add_option("-s", "--seed", dest = "seed", help = "the random seed, by default unseeded; the simulator's FLOW_GEN with the same seed generates the same flows", default = None)
 	parser.add_option("-o", "--output", dest = "output", help = "the output file", default = f"../config/alltoall{flow_interval_coefficient}-{flow_num}.txt")
 	
 	parser.add_option("-m", "--mix", dest = "mix", help = "the ratio of all-to-all", default = "0.4")
 	parser.add_option("-p", "--podsize", dest = "podsize", help = "the pod-size in all-to-all", default = "16")
 	
 	options,args = parser.parse_args()
+	if options.seed != None:
+		random.seed(int(options.seed))
+		np.random.seed(int(options.seed))
 
 	base_t = 2000000000 # 2000000000
 
@@ -0,0 +1,676 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CAVER-LB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Micro-benchmark of the sender-ToR RouteInput() of the flowlet-based load
+ * balancers (Conga, Letflow, DV). A single ToR with --paths uplinks routes
+ * --n packets of --flows flows towards --tors remote ToRs. Packets are issued
+ * in batches of --batch per simulator event, --gap microseconds apart, so
+ * flowlet timeouts, DRE decay and aging run as they do in a full simulation.
+ *
+ *   ./waf --run "bench-lb-route --n=1000000 --tors=64 --paths=16 --flows=4096"
+ *
+ * With --trace the packets are instead a RouteInput trace recorded by a full
+ * simulation (ROUTE_TRACE_FILE / ROUTE_TRACE_SWITCH, see route-tracer.h): the
+ * traced switch's load balancer (DV, CAVER or Noshare) is rebuilt from the
+ * trace header and every packet is fed to Ingress() at its recorded time.
+ * Reported per packet: wall time of Ingress() (clock overhead subtracted),
+ * heap allocations, cache misses (when the hardware counter is available) and
+ * a hash of the routing decisions, to compare two builds on the same trace.
+ * The switch's ECMP seed and the seed of CAVER/Noshare's choice among equally
+ * good paths are restored from the trace, so the hash is the same from run to
+ * run.
+ * --as=20|21 replays a CAVER trace with Noshare (or the other way round).
+ *
+ *   ./waf --run "bench-lb-route --trace=mix/output/{id}/{id}_out_route_trace.bin"
+ */
+
+#include "ns3/caver-routing.h"
+#include "ns3/conga-routing.h"
+#include "ns3/custom-header.h"
+#include "ns3/dv-routing.h"
+#include "ns3/letflow-routing.h"
+#include "ns3/noshare-routing.h"
+#include "ns3/packet.h"
+#include "ns3/path-codec.h"
+#include "ns3/route-tracer.h"
+#include "ns3/settings.h"
+#include "ns3/simulator.h"
+#include "ns3/switch-node.h"
+#include "ns3/system-wall-clock-ms.h"
+
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+using namespace ns3;
+
+static const uint32_t hostsPerToR = 16;
+static const uint32_t localToRId = 10000;  // switch ids do not collide with host ids
+static const uint64_t linkRate = 100000000000lu;
+
+static uint32_t g_nTors = 64;
+static uint32_t g_nPaths = 16;
+static uint32_t g_nFlows = 4096;
+static uint32_t g_batch = 1000;
+static uint32_t g_gapUs = 10;
+static uint64_t g_routed = 0;
+
+static std::vector<CustomHeader> g_headers;  // one per flow
+static Ptr<Packet> g_packet;
+
+/* every heap allocation of the process, read around Ingress() in the trace replay */
+static uint64_t g_nAlloc = 0;
+
+void *
+operator new (size_t size)
+{
+  g_nAlloc++;
+  void *p = malloc (size ? size : 1);
+  if (p == NULL)
+    {
+      throw std::bad_alloc ();
+    }
+  return p;
+}
+
+void
+operator delete (void *p) noexcept
+{
+  free (p);
+}
+
+static uint32_t
+RemoteToRId (uint32_t t)
+{
+  return localToRId + 1 + t;
+}
+
+static void
+SinkSend (Ptr<Packet> p, CustomHeader &ch, uint32_t outDev, uint32_t qIndex)
+{
+  g_routed++;
+}
+
+static void
+SinkSendToDev (Ptr<Packet> p, CustomHeader &ch)
+{
+  g_routed++;
+}
+
+/* flows: host 0 (under the local ToR) -> a host under one of the remote ToRs */
+static void
+SetupFlows (void)
+{
+  uint32_t nHosts = (g_nTors + 1) * hostsPerToR;
+  for (uint32_t id = 0; id < nHosts; id++)
+    {
+      uint32_t ip = Settings::node_id_to_ip (id).Get ();
+      Settings::hostIp2IdMap[ip] = id;
+      Settings::hostId2IpMap[id] = ip;
+    }
+  Settings::TorSwitch_nodelist[localToRId].clear ();
+  for (uint32_t id = 0; id < hostsPerToR; id++)
+    {
+      Settings::TorSwitch_nodelist[localToRId].push_back (Settings::hostId2IpMap[id]);
+    }
+
+  g_headers.clear ();
+  for (uint32_t f = 0; f < g_nFlows; f++)
+    {
+      uint32_t t = f % g_nTors;
+      uint32_t dstId = (t + 1) * hostsPerToR + (f / g_nTors) % hostsPerToR;
+      CustomHeader ch;
+      ch.sip = Settings::hostId2IpMap[0];
+      ch.dip = Settings::hostId2IpMap[dstId];
+      ch.l3Prot = 0x11;
+      ch.udp.sport = 10000 + f;
+      ch.udp.dport = 100;
+      ch.udp.pg = 3;
+      g_headers.push_back (ch);
+      Settings::PacketId2FlowId[std::make_tuple (0u, dstId, (uint32_t)ch.udp.sport, (uint32_t)ch.udp.dport)] = f;
+      Settings::flowId2SrcDst[f] = std::make_pair (localToRId, RemoteToRId (t));
+    }
+  g_packet = Create<Packet> (1000);
+}
+
+/* path i towards ToR t leaves through uplink port i + 1 */
+static uint32_t
+MakePathId (uint32_t t, uint32_t i)
+{
+  PathCodec::Ports ports;
+  ports.push_back (i + 1);
+  ports.push_back (1 + t % 8);
+  ports.push_back (1);
+  return PathCodec::Intern (ports);
+}
+
+static void
+CongaBatch (Ptr<CongaRouting> r, uint32_t first, uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      r->RouteInput (g_packet, g_headers[(first + i) % g_nFlows]);
+      g_packet->RemoveAllPacketTags ();
+    }
+}
+
+static void
+LetflowBatch (Ptr<LetflowRouting> r, uint32_t first, uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      r->RouteInput (g_packet, g_headers[(first + i) % g_nFlows]);
+      g_routed++;
+      g_packet->RemoveAllPacketTags ();
+    }
+}
+
+static void
+DVBatch (Ptr<DVRouting> r, uint32_t first, uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      r->RouteInput (g_packet, g_headers[(first + i) % g_nFlows]);
+      g_packet->RemoveAllPacketTags ();
+    }
+}
+
+template <typename T>
+static void
+RunBench (void (*batch)(Ptr<T>, uint32_t, uint32_t), Ptr<T> r, uint32_t n, const char *name)
+{
+  uint32_t nBatch = (n + g_batch - 1) / g_batch;
+  for (uint32_t b = 0; b < nBatch; b++)
+    {
+      uint32_t first = b * g_batch;
+      uint32_t count = std::min (g_batch, n - first);
+      Simulator::Schedule (MicroSeconds (g_gapUs * b), batch, r, first, count);
+    }
+  Simulator::Stop (MicroSeconds (g_gapUs * nBatch));
+
+  g_routed = 0;
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Run ();
+  uint64_t ms = clock.End ();
+  Simulator::Destroy ();
+
+  double nsPerPkt = ms * 1e6 / (g_routed ? g_routed : 1);
+  std::cout << name << "\t" << g_routed << " pkts\t" << ms << " ms\t" << nsPerPkt << " ns/pkt" << std::endl;
+}
+
+/* trace replay (--trace) */
+static std::vector<RouteTracer::Record> g_records;
+static std::vector<std::string> g_tagNames;
+static Ptr<LoadBalancer> g_lb;
+static uint64_t g_nSend = 0;   // routed by the load balancer
+static uint64_t g_nTable = 0;  // handed back to the switch (routing table / ECMP)
+static uint64_t g_decisionHash = 14695981039346656037lu;  // FNV-1a of (record, port)
+static uint32_t g_current = 0;
+static uint64_t g_ingressNs = 0;
+static uint64_t g_ingressAlloc = 0;
+static double g_clockNs = 0;
+static int g_perfFd = -1;
+static uint64_t g_cacheMisses = 0;
+
+static void
+HashDecision (uint32_t port)
+{
+  uint32_t v[2] = { g_current, port };
+  const uint8_t *b = (const uint8_t *) v;
+  for (uint32_t i = 0; i < sizeof (v); i++)
+    {
+      g_decisionHash = (g_decisionHash ^ b[i]) * 1099511628211lu;
+    }
+}
+
+static void
+ReplaySend (Ptr<Packet> p, CustomHeader &ch, uint32_t outDev, uint32_t qIndex)
+{
+  g_nSend++;
+  HashDecision (outDev);
+  g_lb->OnSend (p, outDev);  // as SwitchNode::DoSwitchSend does
+}
+
+static void
+ReplaySendToDev (Ptr<Packet> p, CustomHeader &ch)
+{
+  g_nTable++;
+  HashDecision (RouteTracer::NONE);
+}
+
+static uint64_t
+NowNs (void)
+{
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000lu + ts.tv_nsec;
+}
+
+/* mean cost of the two clock reads around Ingress() */
+static double
+CalibrateClock (void)
+{
+  const uint32_t n = 100000;
+  uint64_t total = 0;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      uint64_t t0 = NowNs ();
+      total += NowNs () - t0;
+    }
+  return (double) total / n;
+}
+
+/* user-space cache misses, -1 if the hardware counter is not available */
+static int
+OpenCacheMissCounter (void)
+{
+#ifdef __linux__
+  struct perf_event_attr attr;
+  memset (&attr, 0, sizeof (attr));
+  attr.size = sizeof (attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = PERF_COUNT_HW_CACHE_MISSES;
+  attr.disabled = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return syscall (__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#else
+  return -1;
+#endif
+}
+
+static void
+ReplayOne (uint32_t i)
+{
+  const RouteTracer::Record &rec = g_records[i];
+  CustomHeader ch;
+  Ptr<Packet> p = RouteTracer::Rebuild (rec, g_tagNames, ch);
+  g_current = i;
+
+#ifdef __linux__
+  if (g_perfFd >= 0)
+    {
+      ioctl (g_perfFd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+  uint64_t nAlloc = g_nAlloc;
+  uint64_t t0 = NowNs ();
+  if (!g_lb->Ingress (p, ch))
+    {
+      ReplaySendToDev (p, ch);
+    }
+  uint64_t t1 = NowNs ();
+  g_ingressAlloc += g_nAlloc - nAlloc;
+  g_ingressNs += t1 - t0;
+#ifdef __linux__
+  if (g_perfFd >= 0)
+    {
+      ioctl (g_perfFd, PERF_EVENT_IOC_DISABLE, 0);
+    }
+#endif
+
+  if (i + 1 < g_records.size ())
+    {
+      uint64_t next = g_records[i + 1].timeNs;
+      Simulator::Schedule (NanoSeconds (next > rec.timeNs ? next - rec.timeNs : 0), &ReplayOne, i + 1);
+    }
+}
+
+/* the traced switch, configured as network-load-balance.cc does; its per-destination tables
+ * are filled by the same SwitchNode::Add*Entry() as in the scenario */
+template <typename T>
+static Ptr<SwitchNode>
+SetupReplayLb (Ptr<T> r, const RouteTracer::Config &c)
+{
+  Ptr<SwitchNode> sw = CreateObject<SwitchNode> ();
+  sw->m_isToR = c.isToR;
+  sw->SetEcmpSeed (c.ecmpSeed);
+  sw->SetLoadBalancer (r);
+  r->SetSwitchInfo (c.isToR, c.switchId);
+  r->id2Port.insert (c.id2Port.begin (), c.id2Port.end ());
+  for (auto &it : c.portRate)
+    {
+      r->SetLinkCapacity (it.first, it.second);
+    }
+  r->SetSwitchSendCallback (MakeCallback (&ReplaySend));
+  r->SetSwitchSendToDevCallback (MakeCallback (&ReplaySendToDev));
+  return sw;
+}
+
+static void
+SetupDestinations (Ptr<SwitchNode> sw, uint32_t mode, const RouteTracer::Config &c)
+{
+  for (auto &it : c.routes)
+    {
+      Ipv4Address dst (it.first);
+      if (mode == 10)
+        {
+          sw->AddPathCETableEntry (dst, Seconds (0));
+          for (uint32_t port : it.second)
+            {
+              sw->AddPathCE_port_TableEntry (dst, port, Seconds (0));
+            }
+        }
+      else if (mode == 20)
+        {
+          if (c.isToR)
+            {
+              sw->AddPathChoiceTableEntry (dst, Seconds (0));
+            }
+          sw->AddBestPathCETableEntry (dst, Seconds (0));
+          if (!c.isToR)
+            {
+              sw->AddACCPathCETableEntry (dst, Seconds (0));
+            }
+        }
+      else
+        {
+          if (c.isToR)
+            {
+              sw->AddPathChoiceTableEntry_noshare (dst, Seconds (0));
+            }
+          sw->AddBestPathCETableEntry_noshare (dst, Seconds (0));
+          if (!c.isToR)
+            {
+              sw->AddACCPathCETableEntry_noshare (dst, Seconds (0));
+            }
+        }
+    }
+  if (mode == 10)
+    {
+      std::cout << std::endl;  // AddPathCETableEntry() prints the addresses
+    }
+}
+
+static int
+ReplayTrace (const std::string &filename, uint32_t as)
+{
+  RouteTracer::Config c;
+  if (!RouteTracer::Load (filename.c_str (), c, g_records, g_tagNames))
+    {
+      std::cerr << "cannot read route trace " << filename << std::endl;
+      return 1;
+    }
+  if (g_records.empty ())
+    {
+      std::cerr << filename << ": no packets" << std::endl;
+      return 1;
+    }
+  for (auto &it : c.hostIp2Id)
+    {
+      Settings::hostIp2IdMap[it.first] = it.second;
+      Settings::hostId2IpMap[it.second] = it.first;
+    }
+  Settings::TorSwitch_nodelist[c.switchId] = c.torHosts;
+  Settings::m_nodeInterfaceMap = c.interfaces;
+  Settings::caverLog = fopen ("/dev/null", "w");  // CAVER logs every best-path update
+
+  uint32_t mode = c.lbMode;
+  if (as != 0)
+    {
+      if (!((mode == 20 || mode == 21) && (as == 20 || as == 21)))
+        {
+          std::cerr << "--as swaps CAVER(20) and Noshare(21) only" << std::endl;
+          return 1;
+        }
+      mode = as;
+    }
+  const std::vector<double> &v = c.params;
+  const char *name = NULL;
+  Ptr<SwitchNode> sw;
+  if (c.lbMode == 10 && v.size () == 5)
+    {
+      Ptr<DVRouting> r = CreateObject<DVRouting> ();
+      r->SetConstants (NanoSeconds (v[0]), NanoSeconds (v[1]), NanoSeconds (v[2]), v[3], v[4]);
+      sw = SetupReplayLb (r, c);
+      g_lb = r;
+      name = "DV(10)";
+    }
+  else if ((c.lbMode == 20 || c.lbMode == 21) && v.size () == 10 && mode == 20)
+    {
+      Ptr<CaverRouting> r = CreateObject<CaverRouting> ();
+      r->SetConstants (NanoSeconds (v[0]), NanoSeconds (v[1]), NanoSeconds (v[2]), v[3], v[4],
+                       v[5], NanoSeconds (v[6]), v[7], NanoSeconds (v[8]), v[9] != 0);
+      r->SetRandomSeed (c.lbSeed);
+      sw = SetupReplayLb (r, c);
+      g_lb = r;
+      name = "CAVER(20)";
+    }
+  else if ((c.lbMode == 20 || c.lbMode == 21) && v.size () == 10 && mode == 21)
+    {
+      Ptr<NoshareRouting> r = CreateObject<NoshareRouting> ();
+      r->SetConstants (NanoSeconds (v[0]), NanoSeconds (v[1]), NanoSeconds (v[2]), v[3], v[4],
+                       v[5], NanoSeconds (v[6]), v[7], NanoSeconds (v[8]), v[9] != 0);
+      r->SetRandomSeed (c.lbSeed);
+      sw = SetupReplayLb (r, c);
+      g_lb = r;
+      name = "Noshare(21)";
+    }
+  else
+    {
+      std::cerr << filename << ": lb mode " << c.lbMode
+                << " cannot be replayed (DV(10), CAVER(20) and Noshare(21) only)" << std::endl;
+      return 1;
+    }
+  SetupDestinations (sw, mode, c);
+
+  uint64_t n = g_records.size ();
+  std::cout << "bench-lb-route: trace " << filename << " switch " << c.switchId
+            << (c.isToR ? " (ToR)" : "") << " " << n << " pkts, "
+            << (g_records.back ().timeNs - g_records.front ().timeNs) / 1000 << " us, replayed by "
+            << name << std::endl;
+
+  g_clockNs = CalibrateClock ();
+  g_perfFd = OpenCacheMissCounter ();
+  Simulator::Schedule (NanoSeconds (g_records.front ().timeNs), &ReplayOne, 0);
+  Simulator::Stop (NanoSeconds (g_records.back ().timeNs + 1));
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Run ();
+  uint64_t ms = clock.End ();
+  Simulator::Destroy ();
+
+  double nsPerPkt = (double) g_ingressNs / n - g_clockNs;
+  std::cout << name << "\t" << n << " pkts\t" << ms << " ms total\t" << nsPerPkt << " ns/pkt in Ingress"
+            << " (clock " << g_clockNs << " ns subtracted)\t" << (double) g_ingressAlloc / n
+            << " allocs/pkt\t";
+  if (g_perfFd >= 0 && read (g_perfFd, &g_cacheMisses, sizeof (g_cacheMisses)) == sizeof (g_cacheMisses))
+    {
+      std::cout << (double) g_cacheMisses / n << " cache misses/pkt" << std::endl;
+    }
+  else
+    {
+      std::cout << "cache misses n/a" << std::endl;
+    }
+  if (g_perfFd >= 0)
+    {
+      close (g_perfFd);
+    }
+  std::cout << "decisions: " << g_nSend << " routed, " << g_nTable << " to the routing table, "
+            << n - g_nSend - g_nTable << " absorbed, hash " << std::hex << g_decisionHash << std::dec
+            << std::endl;
+  g_lb = 0;  // the switch went with Simulator::Destroy ()
+  return 0;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 1000000;
+  std::string modes = "3,6,10";
+  std::string trace;
+  uint32_t as = 0;
+  argc--;
+  argv++;
+  while (argc > 0)
+    {
+      std::istringstream iss;
+      if (strncmp ("--n=", argv[0], strlen ("--n=")) == 0)
+        {
+          iss.str (argv[0] + strlen ("--n="));
+          iss >> n;
+        }
+      else if (strncmp ("--tors=", argv[0], strlen ("--tors=")) == 0)
+        {
+          iss.str (argv[0] + strlen ("--tors="));
+          iss >> g_nTors;
+        }
+      else if (strncmp ("--paths=", argv[0], strlen ("--paths=")) == 0)
+        {
+          iss.str (argv[0] + strlen ("--paths="));
+          iss >> g_nPaths;
+        }
+      else if (strncmp ("--flows=", argv[0], strlen ("--flows=")) == 0)
+        {
+          iss.str (argv[0] + strlen ("--flows="));
+          iss >> g_nFlows;
+        }
+      else if (strncmp ("--batch=", argv[0], strlen ("--batch=")) == 0)
+        {
+          iss.str (argv[0] + strlen ("--batch="));
+          iss >> g_batch;
+        }
+      else if (strncmp ("--gap=", argv[0], strlen ("--gap=")) == 0)
+        {
+          iss.str (argv[0] + strlen ("--gap="));
+          iss >> g_gapUs;
+        }
+      else if (strncmp ("--modes=", argv[0], strlen ("--modes=")) == 0)
+        {
+          modes = argv[0] + strlen ("--modes=");
+        }
+      else if (strncmp ("--trace=", argv[0], strlen ("--trace=")) == 0)
+        {
+          trace = argv[0] + strlen ("--trace=");
+        }
+      else if (strncmp ("--as=", argv[0], strlen ("--as=")) == 0)
+        {
+          iss.str (argv[0] + strlen ("--as="));
+          iss >> as;
+        }
+      argc--;
+      argv++;
+    }
+  if (n == 0 || g_nTors == 0 || g_nPaths == 0 || g_nPaths > 250 || g_nFlows == 0 || g_batch == 0)
+    {
+      std::cerr << "usage: bench-lb-route [--n=pkts] [--tors=T] [--paths=P(<=250)] [--flows=F]"
+                << " [--batch=B] [--gap=us] [--modes=3,6,10]" << std::endl;
+      std::cerr << "       bench-lb-route --trace=route_trace.bin [--as=20|21]" << std::endl;
+      exit (1);
+    }
+  if (!trace.empty ())
+    {
+      return ReplayTrace (trace, as);
+    }
+  std::cout << "bench-lb-route: n=" << n << " tors=" << g_nTors << " paths=" << g_nPaths
+            << " flows=" << g_nFlows << " batch=" << g_batch << " gap=" << g_gapUs << "us" << std::endl;
+
+  SetupFlows ();
+  std::stringstream ss (modes);
+  std::string mode;
+  while (std::getline (ss, mode, ','))
+    {
+      if (mode == "3")
+        {
+          Ptr<CongaRouting> r = CreateObject<CongaRouting> ();
+          r->SetConstants (MicroSeconds (50), MicroSeconds (500), MicroSeconds (100), 3, 0.2);
+          r->SetSwitchInfo (true, localToRId);
+          r->SetSwitchSendCallback (MakeCallback (&SinkSend));
+          r->SetSwitchSendToDevCallback (MakeCallback (&SinkSendToDev));
+          for (uint32_t i = 0; i < g_nPaths; i++)
+            {
+              r->SetLinkCapacity (i + 1, linkRate);
+            }
+          for (uint32_t t = 0; t < g_nTors; t++)
+            {
+              for (uint32_t i = 0; i < g_nPaths; i++)
+                {
+                  r->m_congaRoutingTable[RemoteToRId (t)].insert (MakePathId (t, i));
+                }
+            }
+          RunBench<CongaRouting> (&CongaBatch, r, n, "Conga(3)");
+          r->Dispose ();
+        }
+      else if (mode == "6")
+        {
+          Ptr<LetflowRouting> r = CreateObject<LetflowRouting> ();
+          r->SetConstants (MilliSeconds (2), MicroSeconds (100));
+          r->SetSwitchInfo (true, localToRId);
+          for (uint32_t t = 0; t < g_nTors; t++)
+            {
+              for (uint32_t i = 0; i < g_nPaths; i++)
+                {
+                  r->m_letflowRoutingTable[RemoteToRId (t)].insert (MakePathId (t, i));
+                }
+            }
+          RunBench<LetflowRouting> (&LetflowBatch, r, n, "Letflow(6)");
+          r->Dispose ();
+        }
+      else if (mode == "10")
+        {
+          Ptr<DVRouting> r = CreateObject<DVRouting> ();
+          r->SetConstants (MicroSeconds (50), MicroSeconds (500), MilliSeconds (2), 8, 0.2);
+          r->SetSwitchInfo (true, localToRId);
+          r->SetSwitchSendCallback (MakeCallback (&SinkSend));
+          r->SetSwitchSendToDevCallback (MakeCallback (&SinkSendToDev));
+          for (uint32_t i = 0; i < g_nPaths; i++)
+            {
+              r->SetLinkCapacity (i + 1, linkRate);
+            }
+          // every uplink has a (never aged) path towards every remote host
+          uint32_t nHosts = (g_nTors + 1) * hostsPerToR;
+          for (uint32_t id = hostsPerToR; id < nHosts; id++)
+            {
+              for (uint32_t i = 0; i < g_nPaths; i++)
+                {
+                  DVInfo &info = r->PathCEPortEntry (id, i + 1);
+                  info._ce = i % 4;
+                  info._path = PathCodec::Ports (1, 1 + id % 8);
+                  info._valid = true;
+                  info._updateTime = Seconds (1000);
+                }
+            }
+          RunBench<DVRouting> (&DVBatch, r, n, "DV(10)");
+          r->Dispose ();
+        }
+      else
+        {
+          std::cerr << "unknown mode " << mode << std::endl;
+        }
+    }
+  return 0;
+}
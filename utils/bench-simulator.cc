@@ -80,6 +80,8 @@ Bench::RunBench (void)
   double init, simu;
 
   DEB ("initializing");
+  m_count = 0;
+  EventAllocator::Stats before = EventAllocator::GetStats ();
 
   time.Start ();
   for (uint32_t i = 0; i < m_population; ++i)
@@ -105,6 +107,12 @@ Bench::RunBench (void)
        std::setw (g_fwidth) << (m_count / simu) <<
        std::setw (g_fwidth) << (simu / m_count));
 
+  EventAllocator::Stats after = EventAllocator::GetStats ();
+  LOG (std::setw (g_fwidth) << "" << "events: " << (after.allocations - before.allocations) <<
+       ", system allocations: " << (after.chunks - before.chunks + after.unpooled - before.unpooled) <<
+       " (" << (after.chunks - before.chunks) << " chunks, " <<
+       (after.unpooled - before.unpooled) << " unpooled)");
+
   // Clean up scheduler
   Simulator::Destroy ();
 }